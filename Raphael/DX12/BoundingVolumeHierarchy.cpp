@@ -0,0 +1,836 @@
+#include "BoundingVolumeHierarchy.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+namespace raphael
+{
+    namespace
+    {
+        constexpr uint32_t SahBinCount = 16;
+        // Past this depth splits fall back to object medians, which add at most log2(n) more levels
+        constexpr uint32_t SahMaxDepth = 64;
+        // Cost of visiting a node relative to testing one object
+        constexpr float TraversalCost = 1.0f;
+
+        BvhBounds emptyBounds()
+        {
+            return { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+        }
+
+        void growBounds(BvhBounds& bounds, const BvhBounds& other)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                bounds.min[axis] = std::min(bounds.min[axis], other.min[axis]);
+                bounds.max[axis] = std::max(bounds.max[axis], other.max[axis]);
+            }
+        }
+
+        BvhBounds unionBounds(const BvhBounds& a, const BvhBounds& b)
+        {
+            BvhBounds result = a;
+            growBounds(result, b);
+            return result;
+        }
+
+        // Half the surface area, the SAH only compares ratios
+        float halfArea(const BvhBounds& bounds)
+        {
+            const float x = bounds.max[0] - bounds.min[0];
+            const float y = bounds.max[1] - bounds.min[1];
+            const float z = bounds.max[2] - bounds.min[2];
+            return x * y + y * z + z * x;
+        }
+
+        bool overlaps(const BvhBounds& a, const BvhBounds& b)
+        {
+            return a.min[0] <= b.max[0] && a.max[0] >= b.min[0]
+                && a.min[1] <= b.max[1] && a.max[1] >= b.min[1]
+                && a.min[2] <= b.max[2] && a.max[2] >= b.min[2];
+        }
+
+        // Same center and extents, and the same test, as FrustumCuller uses for a box, so a tree cull and a
+        // flat cull of the same objects agree
+        enum class PlaneSide
+        {
+            Outside,
+            Intersecting,
+            Inside
+        };
+
+        PlaneSide classifyBox(const float* plane, const BvhBounds& bounds)
+        {
+            const float centerX = (bounds.min[0] + bounds.max[0]) * 0.5f;
+            const float centerY = (bounds.min[1] + bounds.max[1]) * 0.5f;
+            const float centerZ = (bounds.min[2] + bounds.max[2]) * 0.5f;
+            const float extentX = (bounds.max[0] - bounds.min[0]) * 0.5f;
+            const float extentY = (bounds.max[1] - bounds.min[1]) * 0.5f;
+            const float extentZ = (bounds.max[2] - bounds.min[2]) * 0.5f;
+            const float distance = plane[0] * centerX + plane[1] * centerY + plane[2] * centerZ + plane[3];
+            const float reach = std::fabs(plane[0]) * extentX + std::fabs(plane[1]) * extentY + std::fabs(plane[2]) * extentZ;
+            if (distance + reach < 0.0f)
+            {
+                return PlaneSide::Outside;
+            }
+            return distance - reach >= 0.0f ? PlaneSide::Inside : PlaneSide::Intersecting;
+        }
+
+        // Entry parameter of the ray into bounds, or a negative value on a miss. fmin and fmax drop the NaN a
+        // zero direction component gives on a slab boundary, a ray inside that plane is not constrained by it.
+        float intersectRay(const BvhBounds& bounds, const float* origin, const float* inverseDirection, float maxDistance)
+        {
+            float entry = 0.0f;
+            float exit = maxDistance;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float t0 = (bounds.min[axis] - origin[axis]) * inverseDirection[axis];
+                const float t1 = (bounds.max[axis] - origin[axis]) * inverseDirection[axis];
+                entry = std::fmax(entry, std::fmin(t0, t1));
+                exit = std::fmin(exit, std::fmax(t0, t1));
+            }
+            return entry <= exit ? entry : -1.0f;
+        }
+
+        float distanceSquared(const BvhBounds& bounds, const float* point)
+        {
+            float result = 0.0f;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float below = bounds.min[axis] - point[axis];
+                const float above = point[axis] - bounds.max[axis];
+                const float gap = std::max({ below, above, 0.0f });
+                result += gap * gap;
+            }
+            return result;
+        }
+
+        // Objects are partitioned as copies of their bounds rather than through indices, so every pass over a
+        // node's range reads memory in order
+        struct BuildPrimitive
+        {
+            BvhBounds bounds;
+            uint32_t object = 0;
+        };
+
+        struct BuildContext
+        {
+            BuildPrimitive* primitives = nullptr;
+            BvhNode* nodes = nullptr;
+            std::atomic<uint32_t> nodeCount{ 0 };
+            JobSystem* jobSystem = nullptr;
+        };
+
+        struct SahBin
+        {
+            BvhBounds bounds = emptyBounds();
+            uint32_t count = 0;
+        };
+
+        float centroidOf(const BvhBounds& bounds, uint32_t axis)
+        {
+            return (bounds.min[axis] + bounds.max[axis]) * 0.5f;
+        }
+
+        void growPoint(BvhBounds& bounds, const BvhBounds& box)
+        {
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                const float centroid = centroidOf(box, axis);
+                bounds.min[axis] = std::min(bounds.min[axis], centroid);
+                bounds.max[axis] = std::max(bounds.max[axis], centroid);
+            }
+        }
+
+        void measureRange(const BuildPrimitive* primitives, uint32_t begin, uint32_t end, BvhBounds& outBounds, BvhBounds& outCentroidBounds)
+        {
+            outBounds = emptyBounds();
+            outCentroidBounds = emptyBounds();
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                growBounds(outBounds, primitives[i].bounds);
+                growPoint(outCentroidBounds, primitives[i].bounds);
+            }
+        }
+
+        uint32_t computeBin(float centroid, float centroidMin, float binScale, uint32_t binCount)
+        {
+            const int32_t bin = static_cast<int32_t>((centroid - centroidMin) * binScale);
+            return static_cast<uint32_t>(std::clamp<int32_t>(bin, 0, static_cast<int32_t>(binCount) - 1));
+        }
+
+        // bounds and centroidBounds cover the range, the parent's bins already hold them.
+        // Returns the node's height.
+        uint32_t buildNode(BuildContext& context, uint32_t nodeIndex, uint32_t parent, uint32_t begin, uint32_t end, uint32_t depth,
+            const BvhBounds& bounds, const BvhBounds& centroidBounds)
+        {
+            // Nodes are preallocated, the reference stays valid while other jobs fill in their own nodes
+            BvhNode& node = context.nodes[nodeIndex];
+            node.bounds = bounds;
+            node.parent = parent;
+
+            const uint32_t count = end - begin;
+            auto makeLeaf = [&]
+            {
+                node.objectCount = count;
+                node.left = begin;
+                node.right = 0;
+                node.height = 0;
+                return 0u;
+            };
+            if (count == 1)
+            {
+                return makeLeaf();
+            }
+
+            // Binned SAH on all three axes in one pass: cost of a split = traversal + sum of child area * child
+            // count, relative to this node's area. Small ranges use fewer bins, there are few candidates to tell
+            // apart and sweeping 16 bins per node would dominate the bottom of the tree.
+            const uint32_t binCount = std::min(SahBinCount, count);
+            uint32_t splitAxis = 0;
+            uint32_t splitBin = SahBinCount;
+            float splitCost = FLT_MAX;
+            SahBin bins[3][SahBinCount];
+            float binScales[3] = {};
+            const float area = halfArea(bounds);
+            if (depth < SahMaxDepth && area > 0.0f)
+            {
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+                    binScales[axis] = extent > 0.0f ? binCount / extent : 0.0f;
+                }
+
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    const BvhBounds& primitiveBounds = context.primitives[i].bounds;
+                    for (uint32_t axis = 0; axis < 3; ++axis)
+                    {
+                        SahBin& bin = bins[axis][computeBin(centroidOf(primitiveBounds, axis), centroidBounds.min[axis], binScales[axis], binCount)];
+                        growBounds(bin.bounds, primitiveBounds);
+                        bin.count++;
+                    }
+                }
+
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    if (binScales[axis] == 0.0f)
+                    {
+                        continue;
+                    }
+
+                    // Right side costs for a split after each bin, then sweep from the left
+                    float rightCost[SahBinCount];
+                    BvhBounds rightBounds = emptyBounds();
+                    uint32_t rightCount = 0;
+                    for (uint32_t bin = binCount - 1; bin > 0; --bin)
+                    {
+                        growBounds(rightBounds, bins[axis][bin].bounds);
+                        rightCount += bins[axis][bin].count;
+                        rightCost[bin - 1] = rightCount > 0 ? halfArea(rightBounds) * rightCount : 0.0f;
+                    }
+
+                    BvhBounds leftBounds = emptyBounds();
+                    uint32_t leftCount = 0;
+                    for (uint32_t bin = 0; bin + 1 < binCount; ++bin)
+                    {
+                        growBounds(leftBounds, bins[axis][bin].bounds);
+                        leftCount += bins[axis][bin].count;
+                        if (leftCount == 0 || leftCount == count)
+                        {
+                            continue;
+                        }
+                        const float cost = TraversalCost + (halfArea(leftBounds) * leftCount + rightCost[bin]) / area;
+                        if (cost < splitCost)
+                        {
+                            splitCost = cost;
+                            splitAxis = axis;
+                            splitBin = bin;
+                        }
+                    }
+                }
+            }
+
+            // A leaf costs one test per object
+            if (count <= BvhMaxLeafObjects && (splitBin == SahBinCount || static_cast<float>(count) <= splitCost))
+            {
+                return makeLeaf();
+            }
+
+            uint32_t middle = begin;
+            BvhBounds childBounds[2];
+            BvhBounds childCentroidBounds[2];
+            if (splitBin < SahBinCount)
+            {
+                // The same bin computation as the counting pass, so both sides are non-empty. The children's
+                // centroid bounds are gathered while partitioning, their bounds come from the bins.
+                const float centroidMin = centroidBounds.min[splitAxis];
+                const float binScale = binScales[splitAxis];
+                childBounds[0] = emptyBounds();
+                childBounds[1] = emptyBounds();
+                for (uint32_t bin = 0; bin < binCount; ++bin)
+                {
+                    growBounds(childBounds[bin <= splitBin ? 0 : 1], bins[splitAxis][bin].bounds);
+                }
+                childCentroidBounds[0] = emptyBounds();
+                childCentroidBounds[1] = emptyBounds();
+
+                uint32_t left = begin;
+                uint32_t right = end;
+                while (left < right)
+                {
+                    const BvhBounds& primitiveBounds = context.primitives[left].bounds;
+                    if (computeBin(centroidOf(primitiveBounds, splitAxis), centroidMin, binScale, binCount) <= splitBin)
+                    {
+                        growPoint(childCentroidBounds[0], primitiveBounds);
+                        left++;
+                    }
+                    else
+                    {
+                        growPoint(childCentroidBounds[1], primitiveBounds);
+                        std::swap(context.primitives[left], context.primitives[--right]);
+                    }
+                }
+                middle = left;
+            }
+            else
+            {
+                // Too deep or no usable SAH split: object median along the widest centroid axis
+                uint32_t axis = 0;
+                for (uint32_t i = 1; i < 3; ++i)
+                {
+                    if (centroidBounds.max[i] - centroidBounds.min[i] > centroidBounds.max[axis] - centroidBounds.min[axis])
+                    {
+                        axis = i;
+                    }
+                }
+                middle = begin + count / 2;
+                std::nth_element(context.primitives + begin, context.primitives + middle, context.primitives + end,
+                    [axis](const BuildPrimitive& a, const BuildPrimitive& b)
+                {
+                    return centroidOf(a.bounds, axis) < centroidOf(b.bounds, axis);
+                });
+                measureRange(context.primitives, begin, middle, childBounds[0], childCentroidBounds[0]);
+                measureRange(context.primitives, middle, end, childBounds[1], childCentroidBounds[1]);
+            }
+
+            // Children are allocated as a pair, after their parent
+            const uint32_t left = context.nodeCount.fetch_add(2, std::memory_order_relaxed);
+            node.objectCount = 0;
+            node.left = left;
+            node.right = left + 1;
+
+            uint32_t heights[2] = {};
+            if (context.jobSystem != nullptr && count >= BvhParallelBuildThreshold)
+            {
+                struct LeftBuild
+                {
+                    BuildContext* context;
+                    uint32_t* height;
+                    const BvhBounds* bounds;
+                    const BvhBounds* centroidBounds;
+                    uint32_t node, parent, begin, end, depth;
+                };
+                const LeftBuild job = { &context, &heights[0], &childBounds[0], &childCentroidBounds[0], left, nodeIndex, begin, middle, depth + 1 };
+                JobCounter counter;
+                const LeftBuild* leftBuild = &job;
+                context.jobSystem->run([leftBuild]
+                {
+                    *leftBuild->height = buildNode(*leftBuild->context, leftBuild->node, leftBuild->parent, leftBuild->begin, leftBuild->end,
+                        leftBuild->depth, *leftBuild->bounds, *leftBuild->centroidBounds);
+                }, &counter);
+                heights[1] = buildNode(context, left + 1, nodeIndex, middle, end, depth + 1, childBounds[1], childCentroidBounds[1]);
+                context.jobSystem->wait(counter);
+            }
+            else
+            {
+                heights[0] = buildNode(context, left, nodeIndex, begin, middle, depth + 1, childBounds[0], childCentroidBounds[0]);
+                heights[1] = buildNode(context, left + 1, nodeIndex, middle, end, depth + 1, childBounds[1], childCentroidBounds[1]);
+            }
+
+            node.height = 1 + std::max(heights[0], heights[1]);
+            return node.height;
+        }
+    } // namespace
+
+    void BoundingVolumeHierarchy::build(const BvhBounds* bounds, uint32_t count)
+    {
+        m_objectBounds.assign(bounds, bounds + count);
+        buildTree(nullptr);
+    }
+
+    void BoundingVolumeHierarchy::build(JobSystem& jobSystem, const BvhBounds* bounds, uint32_t count)
+    {
+        m_objectBounds.assign(bounds, bounds + count);
+        buildTree(&jobSystem);
+    }
+
+    void BoundingVolumeHierarchy::rebuild()
+    {
+        buildTree(nullptr);
+    }
+
+    void BoundingVolumeHierarchy::clear()
+    {
+        m_objectBounds.clear();
+        m_nodes.clear();
+        m_leafObjects.clear();
+        m_root = InvalidIndex;
+        m_builtCount = 0;
+        m_insertedCount = 0;
+    }
+
+    void BoundingVolumeHierarchy::buildTree(JobSystem* jobSystem)
+    {
+        const uint32_t count = getObjectCount();
+        m_builtCount = count;
+        m_insertedCount = 0;
+        m_buildCount++;
+
+        m_leafObjects.resize(count);
+        if (count == 0)
+        {
+            m_nodes.clear();
+            m_root = InvalidIndex;
+            return;
+        }
+
+        std::vector<BuildPrimitive> primitives(count);
+        auto gatherPrimitives = [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                primitives[i].bounds = m_objectBounds[i];
+                primitives[i].object = i;
+            }
+        };
+        if (jobSystem != nullptr)
+        {
+            jobSystem->parallelFor(count, BvhParallelBuildThreshold, gatherPrimitives);
+        }
+        else
+        {
+            gatherPrimitives(0, count);
+        }
+
+        // Every leaf holds at least one object, so 2n - 1 nodes always suffice
+        m_nodes.resize(2 * static_cast<size_t>(count) - 1);
+        BuildContext context;
+        context.primitives = primitives.data();
+        context.nodes = m_nodes.data();
+        context.nodeCount.store(1, std::memory_order_relaxed);
+        context.jobSystem = jobSystem;
+
+        BvhBounds bounds;
+        BvhBounds centroidBounds;
+        measureRange(primitives.data(), 0, count, bounds, centroidBounds);
+        m_root = 0;
+        buildNode(context, m_root, InvalidIndex, 0, count, 1, bounds, centroidBounds);
+        m_nodes.resize(context.nodeCount.load(std::memory_order_relaxed));
+
+        // Leaves index the partitioned order
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_leafObjects[i] = primitives[i].object;
+        }
+    }
+
+    uint32_t BoundingVolumeHierarchy::insert(const BvhBounds& bounds)
+    {
+        const uint32_t objectIndex = getObjectCount();
+        m_objectBounds.push_back(bounds);
+
+        // Rebuilding each time the object count doubles costs O(log n) per insertion, amortized
+        m_insertedCount++;
+        if (m_insertedCount > m_builtCount)
+        {
+            buildTree(nullptr);
+            return objectIndex;
+        }
+
+        BvhNode leaf;
+        leaf.bounds = bounds;
+        leaf.objectCount = 1;
+        leaf.left = static_cast<uint32_t>(m_leafObjects.size());
+        m_leafObjects.push_back(objectIndex);
+        m_nodes.push_back(leaf);
+        insertLeaf(static_cast<uint32_t>(m_nodes.size()) - 1);
+
+        if (m_nodes[m_root].height + 1 > BvhMaxDepth)
+        {
+            buildTree(nullptr);
+        }
+        return objectIndex;
+    }
+
+    void BoundingVolumeHierarchy::insertLeaf(uint32_t leafIndex)
+    {
+        const BvhBounds bounds = m_nodes[leafIndex].bounds;
+
+        // Walk down to the sibling whose new parent adds the least surface area. Descending a level is only
+        // worth it while the area the path above grows by, the inherited cost, leaves room to save.
+        uint32_t sibling = m_root;
+        while (m_nodes[sibling].objectCount == 0)
+        {
+            const BvhNode& node = m_nodes[sibling];
+            const float area = halfArea(node.bounds);
+            const float combinedArea = halfArea(unionBounds(node.bounds, bounds));
+            const float cost = 2.0f * combinedArea;
+            const float inheritedCost = 2.0f * (combinedArea - area);
+
+            auto descendCost = [&](uint32_t childIndex)
+            {
+                const BvhNode& child = m_nodes[childIndex];
+                const float grownArea = halfArea(unionBounds(child.bounds, bounds));
+                return (child.objectCount > 0 ? grownArea : grownArea - halfArea(child.bounds)) + inheritedCost;
+            };
+            const float leftCost = descendCost(node.left);
+            const float rightCost = descendCost(node.right);
+            if (cost < leftCost && cost < rightCost)
+            {
+                break;
+            }
+            sibling = leftCost < rightCost ? node.left : node.right;
+        }
+
+        // New parent takes the sibling's place
+        const uint32_t oldParent = m_nodes[sibling].parent;
+        BvhNode parent;
+        parent.bounds = unionBounds(m_nodes[sibling].bounds, bounds);
+        parent.parent = oldParent;
+        parent.left = sibling;
+        parent.right = leafIndex;
+        parent.height = m_nodes[sibling].height + 1;
+        m_nodes.push_back(parent);
+        const uint32_t parentIndex = static_cast<uint32_t>(m_nodes.size()) - 1;
+
+        m_nodes[sibling].parent = parentIndex;
+        m_nodes[leafIndex].parent = parentIndex;
+        if (oldParent == InvalidIndex)
+        {
+            m_root = parentIndex;
+            return;
+        }
+        BvhNode& grandparent = m_nodes[oldParent];
+        (grandparent.left == sibling ? grandparent.left : grandparent.right) = parentIndex;
+
+        // Refit the path up to the root
+        for (uint32_t index = oldParent; index != InvalidIndex; index = m_nodes[index].parent)
+        {
+            BvhNode& node = m_nodes[index];
+            node.bounds = unionBounds(m_nodes[node.left].bounds, m_nodes[node.right].bounds);
+            node.height = 1 + std::max(m_nodes[node.left].height, m_nodes[node.right].height);
+        }
+    }
+
+    void BoundingVolumeHierarchy::setBounds(uint32_t objectIndex, const BvhBounds& bounds)
+    {
+        if (objectIndex >= getObjectCount())
+        {
+            throw std::runtime_error("BVH object index out of range");
+        }
+        m_objectBounds[objectIndex] = bounds;
+    }
+
+    void BoundingVolumeHierarchy::refit()
+    {
+        if (m_root != InvalidIndex)
+        {
+            refitNode(m_root);
+        }
+    }
+
+    void BoundingVolumeHierarchy::refitNode(uint32_t nodeIndex)
+    {
+        // Recursion depth is bounded by BvhMaxDepth
+        BvhNode& node = m_nodes[nodeIndex];
+        if (node.objectCount > 0)
+        {
+            node.bounds = emptyBounds();
+            for (uint32_t i = 0; i < node.objectCount; ++i)
+            {
+                growBounds(node.bounds, m_objectBounds[m_leafObjects[node.left + i]]);
+            }
+            return;
+        }
+        refitNode(node.left);
+        refitNode(node.right);
+        node.bounds = unionBounds(m_nodes[node.left].bounds, m_nodes[node.right].bounds);
+    }
+
+    uint32_t BoundingVolumeHierarchy::cullFrustum(const Frustum& frustum, uint32_t* outObjectIndices) const
+    {
+        if (m_root == InvalidIndex)
+        {
+            return 0;
+        }
+
+        // Each entry carries the planes its node still straddles. Once a node is inside a plane its whole
+        // subtree is, so children skip that plane; with no planes left objects are emitted untested.
+        constexpr uint32_t AllPlanes = 0x3F;
+        uint32_t stackNodes[BvhMaxDepth];
+        uint8_t stackPlanes[BvhMaxDepth];
+        uint32_t stackSize = 0;
+        stackNodes[stackSize] = m_root;
+        stackPlanes[stackSize++] = AllPlanes;
+
+        uint32_t visibleCount = 0;
+        while (stackSize > 0)
+        {
+            stackSize--;
+            const BvhNode& node = m_nodes[stackNodes[stackSize]];
+            uint32_t planes = stackPlanes[stackSize];
+
+            bool outside = false;
+            for (uint32_t plane = 0; plane < 6 && !outside; ++plane)
+            {
+                if ((planes & (1u << plane)) == 0)
+                {
+                    continue;
+                }
+                const PlaneSide side = classifyBox(frustum.planes[plane], node.bounds);
+                outside = side == PlaneSide::Outside;
+                if (side == PlaneSide::Inside)
+                {
+                    planes &= ~(1u << plane);
+                }
+            }
+            if (outside)
+            {
+                continue;
+            }
+
+            if (node.objectCount == 0)
+            {
+                stackNodes[stackSize] = node.right;
+                stackPlanes[stackSize++] = static_cast<uint8_t>(planes);
+                stackNodes[stackSize] = node.left;
+                stackPlanes[stackSize++] = static_cast<uint8_t>(planes);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < node.objectCount; ++i)
+            {
+                const uint32_t object = m_leafObjects[node.left + i];
+                bool visible = true;
+                for (uint32_t plane = 0; plane < 6 && visible; ++plane)
+                {
+                    if ((planes & (1u << plane)) != 0)
+                    {
+                        visible = classifyBox(frustum.planes[plane], m_objectBounds[object]) != PlaneSide::Outside;
+                    }
+                }
+                if (visible)
+                {
+                    outObjectIndices[visibleCount++] = object;
+                }
+            }
+        }
+        return visibleCount;
+    }
+
+    uint32_t BoundingVolumeHierarchy::queryBox(const BvhBounds& box, uint32_t* outObjectIndices) const
+    {
+        if (m_root == InvalidIndex)
+        {
+            return 0;
+        }
+
+        uint32_t stack[BvhMaxDepth];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = m_root;
+
+        uint32_t foundCount = 0;
+        while (stackSize > 0)
+        {
+            const BvhNode& node = m_nodes[stack[--stackSize]];
+            if (!overlaps(node.bounds, box))
+            {
+                continue;
+            }
+            if (node.objectCount == 0)
+            {
+                stack[stackSize++] = node.right;
+                stack[stackSize++] = node.left;
+                continue;
+            }
+            for (uint32_t i = 0; i < node.objectCount; ++i)
+            {
+                const uint32_t object = m_leafObjects[node.left + i];
+                if (overlaps(m_objectBounds[object], box))
+                {
+                    outObjectIndices[foundCount++] = object;
+                }
+            }
+        }
+        return foundCount;
+    }
+
+    bool BoundingVolumeHierarchy::raycast(const float origin[3], const float direction[3], float maxDistance, BvhRayHit& outHit) const
+    {
+        if (m_root == InvalidIndex)
+        {
+            return false;
+        }
+
+        // Division by zero gives the infinities the slab test wants
+        const float inverseDirection[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+
+        float closest = maxDistance;
+        uint32_t hitObject = InvalidIndex;
+        const float rootEntry = intersectRay(m_nodes[m_root].bounds, origin, inverseDirection, closest);
+        if (rootEntry < 0.0f)
+        {
+            return false;
+        }
+
+        // Nearer child on top, entries whose box starts beyond the closest hit so far are dropped
+        uint32_t stackNodes[BvhMaxDepth];
+        float stackEntries[BvhMaxDepth];
+        uint32_t stackSize = 0;
+        stackNodes[stackSize] = m_root;
+        stackEntries[stackSize++] = rootEntry;
+
+        while (stackSize > 0)
+        {
+            stackSize--;
+            if (stackEntries[stackSize] > closest)
+            {
+                continue;
+            }
+            const BvhNode& node = m_nodes[stackNodes[stackSize]];
+
+            if (node.objectCount > 0)
+            {
+                for (uint32_t i = 0; i < node.objectCount; ++i)
+                {
+                    const uint32_t object = m_leafObjects[node.left + i];
+                    const float entry = intersectRay(m_objectBounds[object], origin, inverseDirection, closest);
+                    if (entry >= 0.0f && (hitObject == InvalidIndex || entry < closest))
+                    {
+                        closest = entry;
+                        hitObject = object;
+                    }
+                }
+                continue;
+            }
+
+            const float leftEntry = intersectRay(m_nodes[node.left].bounds, origin, inverseDirection, closest);
+            const float rightEntry = intersectRay(m_nodes[node.right].bounds, origin, inverseDirection, closest);
+            const bool leftFirst = leftEntry <= rightEntry || rightEntry < 0.0f;
+            const uint32_t nearNode = leftFirst ? node.left : node.right;
+            const uint32_t farNode = leftFirst ? node.right : node.left;
+            const float nearEntry = leftFirst ? leftEntry : rightEntry;
+            const float farEntry = leftFirst ? rightEntry : leftEntry;
+            if (farEntry >= 0.0f)
+            {
+                stackNodes[stackSize] = farNode;
+                stackEntries[stackSize++] = farEntry;
+            }
+            if (nearEntry >= 0.0f)
+            {
+                stackNodes[stackSize] = nearNode;
+                stackEntries[stackSize++] = nearEntry;
+            }
+        }
+
+        if (hitObject == InvalidIndex)
+        {
+            return false;
+        }
+        outHit.objectIndex = hitObject;
+        outHit.distance = closest;
+        return true;
+    }
+
+    uint32_t BoundingVolumeHierarchy::findNearest(const float point[3], float maxDistance, float* outDistance) const
+    {
+        if (m_root == InvalidIndex)
+        {
+            return InvalidIndex;
+        }
+
+        float closestSquared = maxDistance * maxDistance;
+        uint32_t nearestObject = InvalidIndex;
+
+        uint32_t stackNodes[BvhMaxDepth];
+        float stackDistances[BvhMaxDepth];
+        uint32_t stackSize = 0;
+        stackNodes[stackSize] = m_root;
+        stackDistances[stackSize++] = distanceSquared(m_nodes[m_root].bounds, point);
+
+        while (stackSize > 0)
+        {
+            stackSize--;
+            if (stackDistances[stackSize] > closestSquared)
+            {
+                continue;
+            }
+            const BvhNode& node = m_nodes[stackNodes[stackSize]];
+
+            if (node.objectCount > 0)
+            {
+                for (uint32_t i = 0; i < node.objectCount; ++i)
+                {
+                    const uint32_t object = m_leafObjects[node.left + i];
+                    const float distance = distanceSquared(m_objectBounds[object], point);
+                    if (distance < closestSquared || (nearestObject == InvalidIndex && distance <= closestSquared))
+                    {
+                        closestSquared = distance;
+                        nearestObject = object;
+                    }
+                }
+                continue;
+            }
+
+            // Nearer child on top
+            const float leftDistance = distanceSquared(m_nodes[node.left].bounds, point);
+            const float rightDistance = distanceSquared(m_nodes[node.right].bounds, point);
+            const bool leftFirst = leftDistance <= rightDistance;
+            stackNodes[stackSize] = leftFirst ? node.right : node.left;
+            stackDistances[stackSize++] = leftFirst ? rightDistance : leftDistance;
+            stackNodes[stackSize] = leftFirst ? node.left : node.right;
+            stackDistances[stackSize++] = leftFirst ? leftDistance : rightDistance;
+        }
+
+        if (nearestObject != InvalidIndex && outDistance != nullptr)
+        {
+            *outDistance = std::sqrt(closestSquared);
+        }
+        return nearestObject;
+    }
+
+    BvhStats BoundingVolumeHierarchy::getStats() const
+    {
+        BvhStats stats;
+        stats.nodeCount = static_cast<uint32_t>(m_nodes.size());
+        stats.insertedCount = m_insertedCount;
+        stats.buildCount = m_buildCount;
+        if (m_root == InvalidIndex)
+        {
+            return stats;
+        }
+
+        stats.depth = m_nodes[m_root].height + 1;
+        const float rootArea = halfArea(m_nodes[m_root].bounds);
+        float cost = 0.0f;
+        for (const BvhNode& node : m_nodes)
+        {
+            const float areaRatio = rootArea > 0.0f ? halfArea(node.bounds) / rootArea : 1.0f;
+            if (node.objectCount > 0)
+            {
+                stats.leafCount++;
+                cost += areaRatio * node.objectCount;
+            }
+            else
+            {
+                cost += areaRatio * TraversalCost;
+            }
+        }
+        stats.sahCost = cost;
+        return stats;
+    }
+} // namespace raphael
@@ -0,0 +1,115 @@
+#pragma once
+#include "FrustumCulling.h"
+#include <cstdint>
+#include <vector>
+
+namespace raphael
+{
+    class JobSystem;
+
+    // Longest root to leaf path. Builds switch from SAH to median splits deep down to stay under it,
+    // insertions that would exceed it trigger a rebuild. Queries traverse with a stack of this size.
+    constexpr uint32_t BvhMaxDepth = 96;
+    // Objects a built leaf holds at most
+    constexpr uint32_t BvhMaxLeafObjects = 4;
+    // Ranges at least this large build their subtrees as separate jobs
+    constexpr uint32_t BvhParallelBuildThreshold = 2048;
+
+    struct BvhBounds
+    {
+        float min[3] = {};
+        float max[3] = {};
+    };
+
+    struct BvhNode
+    {
+        BvhBounds bounds;
+        uint32_t parent = UINT32_MAX;
+        uint32_t objectCount = 0; // 0 for interior nodes
+        uint32_t left = 0;        // Interior: first child. Leaf: first entry in the leaf object list
+        uint32_t right = 0;       // Interior: second child
+        uint32_t height = 0;      // Levels below this node, 0 for leaves
+    };
+
+    struct BvhRayHit
+    {
+        uint32_t objectIndex = UINT32_MAX;
+        float distance = 0.0f;    // Ray parameter where it enters the object's bounds, 0 when it starts inside
+    };
+
+    struct BvhStats
+    {
+        uint32_t nodeCount = 0;
+        uint32_t leafCount = 0;
+        uint32_t depth = 0;         // Longest root to leaf path, 1 for a single leaf
+        uint32_t insertedCount = 0; // Objects inserted since the last build
+        uint32_t buildCount = 0;    // Full builds, explicit or triggered by insertions
+        float sahCost = 0.0f;       // Expected node and object tests for a random ray through the root
+    };
+
+    // Static bounding volume hierarchy over object bounds, for culling and spatial queries in O(log n).
+    // build() splits top-down with a 16-bin surface area heuristic; the job system overload builds large
+    // subtrees as parallel jobs. insert() adds one object by walking down to the sibling that grows the
+    // surface area the least and refitting the path above it, so objects can be added as they spawn. The tree
+    // rebuilds itself once the inserted objects outnumber the ones it was built from, which keeps insertions
+    // amortized O(log n) without letting the quality drift. setBounds() and refit() handle objects that move
+    // a little without changing the topology.
+    // Queries are const, allocation free and safe to run from several threads at once. Results are written
+    // in traversal order to arrays the caller sizes to getObjectCount().
+    // Backend independent.
+    class BoundingVolumeHierarchy
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+        BoundingVolumeHierarchy() = default;
+        ~BoundingVolumeHierarchy() = default;
+
+        BoundingVolumeHierarchy(const BoundingVolumeHierarchy& rhs) = delete;
+        BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy& rhs) = delete;
+
+        // Replace every object, object i gets bounds[i]
+        void build(const BvhBounds* bounds, uint32_t count);
+        void build(JobSystem& jobSystem, const BvhBounds* bounds, uint32_t count);
+        // Rebuilds from the current object bounds
+        void rebuild();
+        void clear();
+
+        // Returns the new object's index, objects are numbered in the order they are added
+        uint32_t insert(const BvhBounds& bounds);
+        // Moves an object, the node bounds catch up on the next refit()
+        void setBounds(uint32_t objectIndex, const BvhBounds& bounds);
+        void refit();
+
+        // Objects whose bounds intersect the frustum. Subtrees entirely inside skip the plane tests.
+        uint32_t cullFrustum(const Frustum& frustum, uint32_t* outObjectIndices) const;
+        // Objects whose bounds overlap box, touching counts
+        uint32_t queryBox(const BvhBounds& box, uint32_t* outObjectIndices) const;
+        // Closest object bounds hit by origin + t * direction for t in [0, maxDistance]. direction need not
+        // be normalized, the hit distance is in units of it. Returns false when nothing is hit.
+        bool raycast(const float origin[3], const float direction[3], float maxDistance, BvhRayHit& outHit) const;
+        // Object whose bounds are closest to point, InvalidIndex when none is within maxDistance.
+        // Distances are to the bounds, 0 for objects containing the point.
+        uint32_t findNearest(const float point[3], float maxDistance, float* outDistance = nullptr) const;
+
+        uint32_t getObjectCount() const { return static_cast<uint32_t>(m_objectBounds.size()); }
+        const BvhBounds& getObjectBounds(uint32_t objectIndex) const { return m_objectBounds[objectIndex]; }
+        const std::vector<BvhNode>& getNodes() const { return m_nodes; }
+        uint32_t getRoot() const { return m_root; }
+        BvhStats getStats() const;
+
+    private:
+        void buildTree(JobSystem* jobSystem);
+        void insertLeaf(uint32_t leafIndex);
+        void refitNode(uint32_t nodeIndex);
+
+    private:
+        std::vector<BvhBounds> m_objectBounds;
+        std::vector<BvhNode> m_nodes;
+        std::vector<uint32_t> m_leafObjects; // Object indices, each leaf owns a contiguous range
+        uint32_t m_root = InvalidIndex;
+        uint32_t m_builtCount = 0;
+        uint32_t m_insertedCount = 0;
+        uint32_t m_buildCount = 0;
+    };
+} // namespace raphael
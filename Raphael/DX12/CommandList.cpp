@@ -4,6 +4,7 @@
 #include "DescriptorHeapDx12.h"
 #include "RootSignatureDx12.h"
 #include "RootSignatureTableDx12.h"
+#include "UtilDx12.h"
 
 namespace raphael
 {
@@ -17,7 +18,7 @@ namespace raphael
         // Create command list
         if (FAILED(m_device->getNativeDevice()->CreateCommandList(
             0,
-            D3D12_COMMAND_LIST_TYPE_DIRECT,
+            convertCommandListTypeToD3D12(m_desc.type),
             allocator,
             nullptr,
             IID_PPV_ARGS(&m_commandList))))
@@ -47,6 +48,8 @@ namespace raphael
         {
             throw std::runtime_error("Failed to reset command list");
         }
+        m_stateTracker.reset();
+        m_stateCache.reset();
         m_isRecording = true;
     }
 
@@ -57,6 +60,10 @@ namespace raphael
             throw std::runtime_error("Command list is not recording");
         }
 
+        // Split barriers left open end here, the state the list leaves behind must be settled at submit
+        m_stateTracker.finish();
+        flushBarriers();
+
         if (FAILED(m_commandList->Close()))
         {
             throw std::runtime_error("Failed to close command list");
@@ -65,7 +72,7 @@ namespace raphael
         m_isRecording = false;
     }
     
-    void CommandList::copyResource(ResourceDx12* dst, ResourceDx12* src, const void* data, const UINT buffersize)
+    void CommandList::copyResource(ResourceDx12* dst, ResourceDx12* src, const void* data, const UINT buffersize, ResourceState finalState)
     {
         // Describe the data we want to copy into the default buffer.
         D3D12_SUBRESOURCE_DATA subResourceData = {};
@@ -76,53 +83,76 @@ namespace raphael
         // Schedule to copy the data to the default buffer resource.  At a high level, the helper function UpdateSubresources
         // will copy the CPU memory into the intermediate upload heap.  Then, using ID3D12CommandList::CopySubresourceRegion,
         // the intermediate upload heap data will be copied to mBuffer.
-        CD3DX12_RESOURCE_BARRIER rbDescDest = CD3DX12_RESOURCE_BARRIER::Transition(dst->getNativeResource(),
-            D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
-        CD3DX12_RESOURCE_BARRIER rbDescRead = CD3DX12_RESOURCE_BARRIER::Transition(dst->getNativeResource(),
-            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
-        m_commandList->ResourceBarrier(1, &rbDescDest);
+        // The upload buffer stays in GENERIC_READ for its whole life, only the destination is tracked
+        transitionResource(dst, ResourceState::CopyDest);
+        flushBarriers();
         UpdateSubresources<1>(m_commandList.Get(), dst->getNativeResource(), src->getNativeResource(), 0, 0, 1, &subResourceData);
-        m_commandList->ResourceBarrier(1, &rbDescRead);
+        transitionResource(dst, finalState);
     }
 
-    void CommandList::copyTextureResource(ResourceDx12* dst, ResourceDx12* src, D3D12_SUBRESOURCE_DATA* subresource)
+    void CommandList::copyTextureResource(ResourceDx12* dst, ResourceDx12* src, D3D12_SUBRESOURCE_DATA* subresource, ResourceState finalState)
     {
-        CD3DX12_RESOURCE_BARRIER rbDescRead = CD3DX12_RESOURCE_BARRIER::Transition(dst->getNativeResource(),
-            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        transitionResource(dst, ResourceState::CopyDest);
+        flushBarriers();
         UpdateSubresources(m_commandList.Get(), dst->getNativeResource(), src->getNativeResource(), 0, 0, 1, subresource);
-		m_commandList->ResourceBarrier(1, &rbDescRead);
+        transitionResource(dst, finalState);
     }
 
     void CommandList::setPipeline(PipelineDx12* pipeline)
     {
         ID3D12PipelineState* pipelineState = pipeline->getNativePipelineState();
-        m_commandList->SetPipelineState(pipelineState);
+        if (m_stateCache.setPipeline(pipelineState))
+        {
+            m_commandList->SetPipelineState(pipelineState);
+        }
     }
 
     void CommandList::setDescriptorHeaps(DescriptorHeapDx12* heap, uint32_t count)
     {
         ID3D12DescriptorHeap* descriptorHeap = heap->getNativeHeap();
-        m_commandList->SetDescriptorHeaps(count, &descriptorHeap);
+        const void* heaps[] = { descriptorHeap };
+        if (m_stateCache.setDescriptorHeaps(heaps, count))
+        {
+            m_commandList->SetDescriptorHeaps(count, &descriptorHeap);
+        }
     }
 
     void CommandList::setGraphicsRootSignature(RootSignatureDx12* rootSignature)
     {
-        m_commandList->SetGraphicsRootSignature(rootSignature->getNativeDevice());
+        ID3D12RootSignature* nativeRootSignature = rootSignature->getNativeDevice();
+        if (m_stateCache.setRootSignature(nativeRootSignature))
+        {
+            m_commandList->SetGraphicsRootSignature(nativeRootSignature);
+        }
     }
 
     void CommandList::setGraphicsRootDescriptorTable(UINT rootParameterIndex, const RootSignatureTableDx12* rootSignatureTable)
     {
-        m_commandList->SetGraphicsRootDescriptorTable(rootParameterIndex, rootSignatureTable->getGpuHandle());
+        setGraphicsRootDescriptorTable(rootParameterIndex, rootSignatureTable->getGpuHandle());
     }
 
     void CommandList::setGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle)
     {
-        m_commandList->SetGraphicsRootDescriptorTable(rootParameterIndex, gpuHandle);
+        if (m_stateCache.setRootDescriptorTable(rootParameterIndex, gpuHandle.ptr))
+        {
+            m_commandList->SetGraphicsRootDescriptorTable(rootParameterIndex, gpuHandle);
+        }
     }
 
     void CommandList::setConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS gpuAddress)
     {
-        m_commandList->SetGraphicsRootConstantBufferView(rootParameterIndex, gpuAddress);
+        if (m_stateCache.setRootConstantBuffer(rootParameterIndex, gpuAddress))
+        {
+            m_commandList->SetGraphicsRootConstantBufferView(rootParameterIndex, gpuAddress);
+        }
+    }
+
+    UploadAllocation CommandList::allocConstants(UINT64 sizeInBytes)
+    {
+        // Constant buffer views must start at and span multiples of 256 bytes
+        const UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+        const UINT64 alignedSize = (sizeInBytes + alignment - 1) & ~(alignment - 1);
+        return m_device->getUploadRing()->allocate(alignedSize, alignment);
     }
 
     void CommandList::setViewports(const D3D12_VIEWPORT* viewports, uint32_t numViewports)
@@ -137,45 +167,108 @@ namespace raphael
 
     void CommandList::resourceBarrier(const D3D12_RESOURCE_BARRIER* barriers, uint32_t numBarriers)
     {
+        flushBarriers();
         m_commandList->ResourceBarrier(numBarriers, barriers);
     }
 
+    void CommandList::transitionResource(ResourceDx12* resource, ResourceState state)
+    {
+        m_stateTracker.require(resource->getTrackedState(), state);
+    }
+
+    void CommandList::assumeResourceState(ResourceDx12* resource, ResourceState state)
+    {
+        m_stateTracker.assume(resource->getTrackedState(), state);
+    }
+
+    void CommandList::beginResourceTransition(ResourceDx12* resource, ResourceState state)
+    {
+        m_stateTracker.beginSplit(resource->getTrackedState(), state);
+    }
+
+    void CommandList::flushBarriers()
+    {
+        const std::span<const ResourceTransition> pending = m_stateTracker.getPendingBarriers();
+        if (pending.empty())
+        {
+            return;
+        }
+
+        recordTransitions(pending.data(), static_cast<uint32_t>(pending.size()));
+        m_stateTracker.clearPendingBarriers();
+    }
+
+    void CommandList::recordTransitions(const ResourceTransition* transitions, uint32_t count)
+    {
+        // One ResourceBarrier call per batch, split only to bound the stack array
+        constexpr uint32_t MaxBatchedBarriers = 32;
+        D3D12_RESOURCE_BARRIER barriers[MaxBatchedBarriers];
+        for (uint32_t first = 0; first < count; first += MaxBatchedBarriers)
+        {
+            const uint32_t batchCount = std::min(count - first, MaxBatchedBarriers);
+            for (uint32_t i = 0; i < batchCount; ++i)
+            {
+                const ResourceTransition& transition = transitions[first + i];
+                ResourceDx12* resource = static_cast<ResourceDx12*>(transition.resource->owner);
+                barriers[i] = convertTransitionToD3D12(transition, resource->getNativeResource());
+            }
+            m_commandList->ResourceBarrier(batchCount, barriers);
+        }
+    }
+
     void CommandList::clearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle, const FLOAT clearColor[4])
     {
+        flushBarriers();
         m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
     }
 
     void CommandList::clearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle, float depth, UINT8 stencil)
     {
+        flushBarriers();
         m_commandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, depth, stencil, 0, nullptr);
     }
 
     void CommandList::setRenderTargets(uint32_t numRenderTargets, const D3D12_CPU_DESCRIPTOR_HANDLE* rtvHandles, D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle)
     {
+        flushBarriers();
         m_commandList->OMSetRenderTargets(numRenderTargets, rtvHandles, true, &dsvHandle);
     }
 
     void CommandList::setVertexBuffer(UINT slot, const ResourceView& vertexBufferView)
     {
         D3D12_VERTEX_BUFFER_VIEW vbv = vertexBufferView.toVertexBufferView();
-        m_commandList->IASetVertexBuffers(slot, 1, &vbv);
+        if (m_stateCache.setVertexBuffer(slot, { vbv.BufferLocation, vbv.SizeInBytes, vbv.StrideInBytes }))
+        {
+            m_commandList->IASetVertexBuffers(slot, 1, &vbv);
+        }
     }
 
     void CommandList::setIndexBuffer(const ResourceView& indexBufferView)
     {
         D3D12_INDEX_BUFFER_VIEW ibv = indexBufferView.toIndexBufferView();
-        m_commandList->IASetIndexBuffer(&ibv);
+        if (m_stateCache.setIndexBuffer({ ibv.BufferLocation, ibv.SizeInBytes, static_cast<uint32_t>(ibv.Format) }))
+        {
+            m_commandList->IASetIndexBuffer(&ibv);
+        }
     }
 
     void CommandList::drawInstanced(UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation, UINT startInstanceLocation)
     {
-        m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        flushBarriers();
+        if (m_stateCache.setPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST))
+        {
+            m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        }
         m_commandList->DrawInstanced(vertexCountPerInstance, instanceCount, startVertexLocation, startInstanceLocation);
     }
 
     void CommandList::drawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation)
     {
-        m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        flushBarriers();
+        if (m_stateCache.setPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST))
+        {
+            m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        }
         m_commandList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
     }
 
@@ -189,17 +282,51 @@ namespace raphael
         m_currentRenderPassDesc = renderPassDesc;
         m_isInRenderPass = true;
 
-        // Transition render targets to the appropriate states for rendering: PRESENT -> RENDER_TARGET
+        // Whatever state the targets are in, binding them records the transitions in one batch
         for (UINT i = 0; i < renderPassDesc.numRenderTargets; ++i)
         {
-            D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-                renderPassDesc.renderTargetResources[i],
-                D3D12_RESOURCE_STATE_PRESENT, 
-                D3D12_RESOURCE_STATE_RENDER_TARGET
-            );
-            m_commandList->ResourceBarrier(1, &barrier);
+            transitionResource(renderPassDesc.renderTargetResources[i], ResourceState::RenderTarget);
+        }
+
+        bindRenderPassTargets(renderPassDesc, true);
+    }
+
+    void CommandList::suspendRenderPass()
+    {
+        if (!m_isInRenderPass)
+        {
+            throw std::runtime_error("Not currently in a render pass");
         }
 
+        // Targets stay in RENDER_TARGET, the list that ends the pass transitions them back
+        m_isInRenderPass = false;
+        m_currentRenderPassDesc = {};
+    }
+
+    void CommandList::resumeRenderPass(const RenderPassDesc& renderPassDesc)
+    {
+        if (m_isInRenderPass)
+        {
+            throw std::runtime_error("Already in a render pass");
+        }
+
+        m_currentRenderPassDesc = renderPassDesc;
+        m_isInRenderPass = true;
+
+        // Command lists do not inherit state, only the clears belong to the list that began the pass.
+        // The targets are normally already in RENDER_TARGET, which the submit-time check confirms without a barrier.
+        for (UINT i = 0; i < renderPassDesc.numRenderTargets; ++i)
+        {
+            transitionResource(renderPassDesc.renderTargetResources[i], ResourceState::RenderTarget);
+        }
+
+        bindRenderPassTargets(renderPassDesc, false);
+    }
+
+    void CommandList::bindRenderPassTargets(const RenderPassDesc& renderPassDesc, bool clear)
+    {
+        flushBarriers();
+
         // Set render targets and clear them based on the render pass description
         // Set viewport and scissor rect to cover the entire render target
         D3D12_VIEWPORT viewport = {};
@@ -219,13 +346,17 @@ namespace raphael
         for (UINT i = 0; i < renderPassDesc.numRenderTargets; ++i)
         {
             rtvHandles[i] = renderPassDesc.rtvHandles[i].cpuHandle;
+            if (!clear)
+            {
+                continue;
+            }
             m_commandList->ClearRenderTargetView(
                 rtvHandles[i], 
                 renderPassDesc.clearColor, 
                 0, 
                 nullptr);
         }
-        if (renderPassDesc.hasDepthStencil)
+        if (clear && renderPassDesc.hasDepthStencil)
         {
             m_commandList->ClearDepthStencilView(
                 renderPassDesc.dsvHandle.cpuHandle, 
@@ -251,15 +382,10 @@ namespace raphael
             throw std::runtime_error("Not currently in a render pass");
         }
 
-        // Transition render targets back to PRESENT state
+        // Back to PRESENT, queued until the next command or end() so the targets leave in one batch
         for (UINT i = 0; i < m_currentRenderPassDesc.numRenderTargets; ++i)
         {
-            D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-                m_currentRenderPassDesc.renderTargetResources[i],
-                D3D12_RESOURCE_STATE_RENDER_TARGET,
-                D3D12_RESOURCE_STATE_PRESENT
-            );
-            m_commandList->ResourceBarrier(1, &barrier);
+            transitionResource(m_currentRenderPassDesc.renderTargetResources[i], ResourceState::Present);
         }
 
         m_isInRenderPass = false;
@@ -1,6 +1,9 @@
 #pragma once
 #include "ObjectDescriptors.h"
 #include "D3D12CommonHeaders.h"
+#include "UploadRingBufferDx12.h"
+#include "ResourceStateTracker.h"
+#include "CommandStateCache.h"
 
 namespace raphael
 {
@@ -22,11 +25,18 @@ namespace raphael
         void begin(ID3D12CommandAllocator* allocator);
         void end();
         void reset();
-        void copyResource(ResourceDx12* dst, ResourceDx12* src, const void* data, const UINT buffersize); // record full resource GPU to GPU copy
-		void copyTextureResource(ResourceDx12* dst, ResourceDx12* src, D3D12_SUBRESOURCE_DATA* subresource);
+        // Record full resource GPU to GPU copy, dst is left in finalState
+        void copyResource(ResourceDx12* dst, ResourceDx12* src, const void* data, const UINT buffersize,
+            ResourceState finalState = ResourceState::GenericRead);
+        void copyTextureResource(ResourceDx12* dst, ResourceDx12* src, D3D12_SUBRESOURCE_DATA* subresource,
+            ResourceState finalState = ResourceState::PixelShaderResource);
         // void copyBufferRegion(IResource* dst, UINT64 dstOffset, IResource* src, UINT64 srcOffset, UINT64 numBytes);
 
         ID3D12GraphicsCommandList* getNativeCommandList() const { return m_commandList.Get(); }
+        // Forgets the bound state the list skips redundant calls against, needed after setting state on
+        // getNativeCommandList() directly
+        void invalidateState() { m_stateCache.reset(); }
+        const CommandStateCacheStats& getStateCacheStats() const { return m_stateCache.getStats(); }
 
         void setPipeline(PipelineDx12* pipeline);
         void setDescriptorHeaps(DescriptorHeapDx12* heap, uint32_t count);
@@ -35,9 +45,45 @@ namespace raphael
         void setGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle);
         void setConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS gpuAddress);
 
+        // Per-draw constant data sub-allocated from the device upload ring (256-byte aligned).
+        // The memory stays valid until the next fence signaled after this command list is executed.
+        UploadAllocation allocConstants(UINT64 sizeInBytes);
+
+        template<typename T>
+        UploadAllocation allocConstants()
+        {
+            return allocConstants(sizeof(T));
+        }
+
+        template<typename T>
+        UploadAllocation allocConstants(const T& data)
+        {
+            UploadAllocation allocation = allocConstants(sizeof(T));
+            memcpy(allocation.cpuAddress, &data, sizeof(T));
+            return allocation;
+        }
+
         void setViewports(const D3D12_VIEWPORT* viewports, uint32_t numViewports);
         void setScissorRects(const D3D12_RECT* rects, uint32_t numRects);
+        // Untracked barriers such as aliasing barriers, recorded after the pending transitions
         void resourceBarrier(const D3D12_RESOURCE_BARRIER* barriers, uint32_t numBarriers);
+
+        // Tracked state changes. Transitions are queued and recorded together right before the next command
+        // that needs them; a resource's state before its first use in the list is resolved at submit.
+        void transitionResource(ResourceDx12* resource, ResourceState state);
+        // Declares the state a resource is known to be in before the list first uses it, see ResourceStateTracker::assume()
+        void assumeResourceState(ResourceDx12* resource, ResourceState state);
+        // Split barrier: starts moving the resource now, the next transitionResource() to the same state ends it.
+        // Do not use the resource in between.
+        void beginResourceTransition(ResourceDx12* resource, ResourceState state);
+        // Records the queued transitions, needed before recording on getNativeCommandList() directly
+        void flushBarriers();
+        // Records ready made transitions in one barrier call, used for the submit-time fix-ups
+        void recordTransitions(const ResourceTransition* transitions, uint32_t count);
+        // Submit time, in queue order: see ResourceStateTracker::resolve()
+        uint32_t resolveResourceStates(std::vector<ResourceTransition>& fixups) { return m_stateTracker.resolve(fixups); }
+        const ResourceStateTrackerStats& getStateTrackerStats() const { return m_stateTracker.getStats(); }
+
         void clearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle, const FLOAT clearColor[4]);
         void clearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle, float depth, UINT8 stencil);
         void setRenderTargets(uint32_t numRenderTargets, const D3D12_CPU_DESCRIPTOR_HANDLE* rtvHandles, D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle);
@@ -48,7 +94,17 @@ namespace raphael
 
         void beginRenderPass(const RenderPassDesc& renderPassDesc);
         void endRenderPass();
+        // Split a render pass across command lists executed back to back: the list that begins the pass
+        // suspends it, every following list resumes it (targets, viewport and scissor without clears, the
+        // target states are confirmed at submit) and the last one ends it
+        void suspendRenderPass();
+        void resumeRenderPass(const RenderPassDesc& renderPassDesc);
 
+        bool isRecording() const { return m_isRecording; }
+
+
+    private:
+        void bindRenderPassTargets(const RenderPassDesc& renderPassDesc, bool clear);
 
     private:
         CommandListDesc m_desc = {};
@@ -56,6 +112,9 @@ namespace raphael
         ComPtr<ID3D12GraphicsCommandList> m_commandList;
         bool m_isRecording = false; // Track recording state
 
+        ResourceStateTracker m_stateTracker;
+        CommandStateCache m_stateCache; // Pipeline, root and input assembler state bound so far
+
         RenderPassDesc m_currentRenderPassDesc = {};
         bool m_isInRenderPass = false; // Track if we are currently inside a render pass
 
@@ -0,0 +1,162 @@
+#include "CommandStateCache.h"
+
+namespace raphael
+{
+    void CommandStateCache::reset()
+    {
+        m_pipeline = nullptr;
+        m_rootSignature = nullptr;
+        m_descriptorHeapCount = 0;
+        m_descriptorHeapsKnown = false;
+        m_vertexBufferMask = 0;
+        m_indexBufferKnown = false;
+        m_topologyKnown = false;
+        for (RootArgument& argument : m_rootArguments)
+        {
+            argument.kind = RootArgumentKind::Unknown;
+        }
+    }
+
+    bool CommandStateCache::setPipeline(const void* pipeline)
+    {
+        if (pipeline != nullptr && pipeline == m_pipeline)
+        {
+            return tally(false);
+        }
+        m_pipeline = pipeline;
+        return tally(true);
+    }
+
+    bool CommandStateCache::setRootSignature(const void* rootSignature)
+    {
+        if (rootSignature != nullptr && rootSignature == m_rootSignature)
+        {
+            return tally(false);
+        }
+
+        // A different layout makes every root argument stale
+        m_rootSignature = rootSignature;
+        for (RootArgument& argument : m_rootArguments)
+        {
+            argument.kind = RootArgumentKind::Unknown;
+        }
+        return tally(true);
+    }
+
+    bool CommandStateCache::setDescriptorHeaps(const void* const* heaps, uint32_t count)
+    {
+        bool same = m_descriptorHeapsKnown && count == m_descriptorHeapCount && count <= MaxDescriptorHeaps;
+        for (uint32_t i = 0; same && i < count; ++i)
+        {
+            same = heaps[i] == m_descriptorHeaps[i];
+        }
+        if (same)
+        {
+            return tally(false);
+        }
+
+        m_descriptorHeapsKnown = count <= MaxDescriptorHeaps;
+        m_descriptorHeapCount = m_descriptorHeapsKnown ? count : 0;
+        for (uint32_t i = 0; i < m_descriptorHeapCount; ++i)
+        {
+            m_descriptorHeaps[i] = heaps[i];
+        }
+
+        // Tables point into the heaps, they have to be set again
+        for (RootArgument& argument : m_rootArguments)
+        {
+            if (argument.kind == RootArgumentKind::DescriptorTable)
+            {
+                argument.kind = RootArgumentKind::Unknown;
+            }
+        }
+        return tally(true);
+    }
+
+    bool CommandStateCache::setVertexBuffer(uint32_t slot, const VertexBufferBinding& binding)
+    {
+        if (slot >= MaxVertexBufferSlots)
+        {
+            return tally(true);
+        }
+
+        const uint32_t bit = 1u << slot;
+        const VertexBufferBinding& bound = m_vertexBuffers[slot];
+        if ((m_vertexBufferMask & bit) != 0 && bound.address == binding.address &&
+            bound.sizeInBytes == binding.sizeInBytes && bound.strideInBytes == binding.strideInBytes)
+        {
+            return tally(false);
+        }
+
+        m_vertexBuffers[slot] = binding;
+        m_vertexBufferMask |= bit;
+        return tally(true);
+    }
+
+    bool CommandStateCache::setIndexBuffer(const IndexBufferBinding& binding)
+    {
+        if (m_indexBufferKnown && m_indexBuffer.address == binding.address &&
+            m_indexBuffer.sizeInBytes == binding.sizeInBytes && m_indexBuffer.format == binding.format)
+        {
+            return tally(false);
+        }
+
+        m_indexBuffer = binding;
+        m_indexBufferKnown = true;
+        return tally(true);
+    }
+
+    bool CommandStateCache::setPrimitiveTopology(uint32_t topology)
+    {
+        if (m_topologyKnown && m_topology == topology)
+        {
+            return tally(false);
+        }
+
+        m_topology = topology;
+        m_topologyKnown = true;
+        return tally(true);
+    }
+
+    bool CommandStateCache::setRootConstantBuffer(uint32_t parameter, uint64_t address)
+    {
+        return setRootArgument(parameter, RootArgumentKind::ConstantBuffer, address);
+    }
+
+    bool CommandStateCache::setRootDescriptorTable(uint32_t parameter, uint64_t gpuHandle)
+    {
+        return setRootArgument(parameter, RootArgumentKind::DescriptorTable, gpuHandle);
+    }
+
+    bool CommandStateCache::setRootArgument(uint32_t parameter, RootArgumentKind kind, uint64_t value)
+    {
+        // Root arguments only make sense against a known root signature
+        if (parameter >= MaxRootParameters || m_rootSignature == nullptr)
+        {
+            return tally(true);
+        }
+
+        RootArgument& argument = m_rootArguments[parameter];
+        if (argument.kind == kind && argument.value == value)
+        {
+            return tally(false);
+        }
+
+        argument.kind = kind;
+        argument.value = value;
+        return tally(true);
+    }
+
+    bool CommandStateCache::tally(bool issue)
+    {
+        if (issue)
+        {
+            m_stats.issuedCount++;
+        }
+        else
+        {
+            m_stats.elidedCount++;
+        }
+        return issue;
+    }
+} // namespace raphael
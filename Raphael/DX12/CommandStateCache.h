@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+
+namespace raphael
+{
+    struct VertexBufferBinding
+    {
+        uint64_t address = 0;
+        uint32_t sizeInBytes = 0;
+        uint32_t strideInBytes = 0;
+    };
+
+    struct IndexBufferBinding
+    {
+        uint64_t address = 0;
+        uint32_t sizeInBytes = 0;
+        uint32_t format = 0;
+    };
+
+    struct CommandStateCacheStats
+    {
+        uint64_t issuedCount = 0; // State calls that reached the command list
+        uint64_t elidedCount = 0; // State calls dropped because the value was already bound
+    };
+
+    // Last bound pipeline state of a command list, so setting a value that is already bound can be skipped.
+    // Every set function records the new value and returns true when the call has to be issued. Nothing is
+    // known after reset(), so the first call of each kind is always issued. Changing the root signature
+    // forgets the root arguments and changing the descriptor heaps forgets the descriptor tables, as the
+    // API does. Root parameters and vertex buffer slots past the cached ranges are always issued.
+    // Call reset() when the list starts recording and after anything records on the native list directly.
+    // Backend independent.
+    class CommandStateCache
+    {
+    public:
+        static constexpr uint32_t MaxRootParameters = 32;
+        static constexpr uint32_t MaxVertexBufferSlots = 16;
+        static constexpr uint32_t MaxDescriptorHeaps = 2;
+
+        CommandStateCache() = default;
+        ~CommandStateCache() = default;
+
+        CommandStateCache(const CommandStateCache& rhs) = delete;
+        CommandStateCache& operator=(const CommandStateCache& rhs) = delete;
+
+        void reset();
+
+        bool setPipeline(const void* pipeline);
+        bool setRootSignature(const void* rootSignature);
+        bool setDescriptorHeaps(const void* const* heaps, uint32_t count);
+        bool setVertexBuffer(uint32_t slot, const VertexBufferBinding& binding);
+        bool setIndexBuffer(const IndexBufferBinding& binding);
+        bool setPrimitiveTopology(uint32_t topology);
+        bool setRootConstantBuffer(uint32_t parameter, uint64_t address);
+        bool setRootDescriptorTable(uint32_t parameter, uint64_t gpuHandle);
+
+        const CommandStateCacheStats& getStats() const { return m_stats; }
+
+    private:
+        enum class RootArgumentKind : uint8_t
+        {
+            Unknown,
+            ConstantBuffer,
+            DescriptorTable,
+        };
+
+        struct RootArgument
+        {
+            RootArgumentKind kind = RootArgumentKind::Unknown;
+            uint64_t value = 0;
+        };
+
+        bool setRootArgument(uint32_t parameter, RootArgumentKind kind, uint64_t value);
+        bool tally(bool issue); // Counts the call, returns issue
+
+    private:
+        const void* m_pipeline = nullptr;
+        const void* m_rootSignature = nullptr;
+        const void* m_descriptorHeaps[MaxDescriptorHeaps] = {};
+        uint32_t m_descriptorHeapCount = 0;
+        bool m_descriptorHeapsKnown = false;
+        VertexBufferBinding m_vertexBuffers[MaxVertexBufferSlots] = {};
+        uint32_t m_vertexBufferMask = 0; // Slots with a known binding
+        IndexBufferBinding m_indexBuffer = {};
+        bool m_indexBufferKnown = false;
+        uint32_t m_topology = 0;
+        bool m_topologyKnown = false;
+        RootArgument m_rootArguments[MaxRootParameters] = {};
+        CommandStateCacheStats m_stats;
+    };
+} // namespace raphael
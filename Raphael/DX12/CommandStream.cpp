@@ -0,0 +1,38 @@
+#include "CommandStream.h"
+
+namespace raphael
+{
+    void CommandStream::clear()
+    {
+        m_bytes.clear();
+        m_commandCount = 0;
+    }
+
+    void CommandStream::append(const CommandStream& stream)
+    {
+        m_bytes.insert(m_bytes.end(), stream.m_bytes.begin(), stream.m_bytes.end());
+        m_commandCount += stream.m_commandCount;
+    }
+
+    void CommandStream::setRootConstantBuffer(uint32_t parameter, uint64_t gpuAddress)
+    {
+        push(CommandType::SetRootConstantBuffer,
+            CommandSetRootArgument{ parameter, static_cast<uint32_t>(gpuAddress), static_cast<uint32_t>(gpuAddress >> 32) });
+    }
+
+    void CommandStream::setRootDescriptorTable(uint32_t parameter, uint64_t gpuHandle)
+    {
+        push(CommandType::SetRootDescriptorTable,
+            CommandSetRootArgument{ parameter, static_cast<uint32_t>(gpuHandle), static_cast<uint32_t>(gpuHandle >> 32) });
+    }
+
+    void CommandStream::draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance)
+    {
+        push(CommandType::Draw, CommandDraw{ vertexCount, instanceCount, startVertex, startInstance });
+    }
+
+    void CommandStream::drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+    {
+        push(CommandType::DrawIndexed, CommandDrawIndexed{ indexCount, instanceCount, startIndex, baseVertex, startInstance });
+    }
+} // namespace raphael
@@ -0,0 +1,225 @@
+#pragma once
+#include "ResourceStateTracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace raphael
+{
+    // Index into a translator's object table (pipelines, root signatures, heaps, buffer views, resources)
+    using CommandHandle = uint32_t;
+
+    enum class CommandType : uint8_t
+    {
+        SetPipeline,
+        SetRootSignature,
+        SetDescriptorHeap,
+        SetVertexBuffer,
+        SetIndexBuffer,
+        SetRootConstantBuffer,
+        SetRootDescriptorTable,
+        Transition,
+        Draw,
+        DrawIndexed,
+        Count,
+    };
+
+    // Every command is a header followed by its payload, packed at 4-byte granularity
+    struct CommandHeader
+    {
+        CommandType type = CommandType::Count;
+        uint8_t reserved = 0;
+        uint16_t size = 0; // Header included
+    };
+
+    struct CommandSetObject
+    {
+        CommandHandle object = 0;
+    };
+
+    struct CommandSetVertexBuffer
+    {
+        uint32_t slot = 0;
+        CommandHandle view = 0;
+    };
+
+    struct CommandSetRootArgument
+    {
+        uint32_t parameter = 0;
+        uint32_t valueLow = 0; // GPU address or descriptor handle, split to keep the payload 4-byte packed
+        uint32_t valueHigh = 0;
+
+        uint64_t getValue() const { return (static_cast<uint64_t>(valueHigh) << 32) | valueLow; }
+    };
+
+    struct CommandTransition
+    {
+        CommandHandle resource = 0;
+        ResourceState state = ResourceState::Common;
+    };
+
+    struct CommandDraw
+    {
+        uint32_t vertexCount = 0;
+        uint32_t instanceCount = 0;
+        uint32_t startVertex = 0;
+        uint32_t startInstance = 0;
+    };
+
+    struct CommandDrawIndexed
+    {
+        uint32_t indexCount = 0;
+        uint32_t instanceCount = 0;
+        uint32_t startIndex = 0;
+        int32_t baseVertex = 0;
+        uint32_t startInstance = 0;
+    };
+
+    // Recorded commands as a linear byte buffer, with handles where the API takes objects.
+    // Recording only appends bytes, so any thread can fill its own stream ahead of time without a device, and
+    // a stream that does not change is recorded once and replayed every frame. replayCommandStream() decodes
+    // the bytes in order into a translator, the D3D12 one is CommandStreamDx12. clear() keeps the capacity.
+    // Backend independent.
+    class CommandStream
+    {
+    public:
+        CommandStream() = default;
+        ~CommandStream() = default;
+
+        CommandStream(const CommandStream& rhs) = delete;
+        CommandStream& operator=(const CommandStream& rhs) = delete;
+
+        void reserve(size_t sizeInBytes) { m_bytes.reserve(sizeInBytes); }
+        void clear();
+        // Appends the commands of another stream, e.g. to join streams recorded on different threads
+        void append(const CommandStream& stream);
+
+        void setPipeline(CommandHandle pipeline) { push(CommandType::SetPipeline, CommandSetObject{ pipeline }); }
+        void setRootSignature(CommandHandle rootSignature) { push(CommandType::SetRootSignature, CommandSetObject{ rootSignature }); }
+        void setDescriptorHeap(CommandHandle heap) { push(CommandType::SetDescriptorHeap, CommandSetObject{ heap }); }
+        void setVertexBuffer(uint32_t slot, CommandHandle view) { push(CommandType::SetVertexBuffer, CommandSetVertexBuffer{ slot, view }); }
+        void setIndexBuffer(CommandHandle view) { push(CommandType::SetIndexBuffer, CommandSetObject{ view }); }
+        void setRootConstantBuffer(uint32_t parameter, uint64_t gpuAddress);
+        void setRootDescriptorTable(uint32_t parameter, uint64_t gpuHandle);
+        void transition(CommandHandle resource, ResourceState state) { push(CommandType::Transition, CommandTransition{ resource, state }); }
+        void draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance);
+        void drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance);
+
+        std::span<const std::byte> getBytes() const { return m_bytes; }
+        size_t getSize() const { return m_bytes.size(); }
+        uint32_t getCommandCount() const { return m_commandCount; }
+        bool isEmpty() const { return m_commandCount == 0; }
+
+    private:
+        template<typename Payload>
+        void push(CommandType type, const Payload& payload)
+        {
+            static_assert(sizeof(Payload) % 4 == 0 && alignof(Payload) <= 4, "Command payloads are 4-byte packed");
+
+            CommandHeader header = {};
+            header.type = type;
+            header.size = static_cast<uint16_t>(sizeof(CommandHeader) + sizeof(Payload));
+
+            const size_t offset = m_bytes.size();
+            m_bytes.resize(offset + header.size);
+            std::memcpy(m_bytes.data() + offset, &header, sizeof(CommandHeader));
+            std::memcpy(m_bytes.data() + offset + sizeof(CommandHeader), &payload, sizeof(Payload));
+            m_commandCount++;
+        }
+
+    private:
+        std::vector<std::byte> m_bytes;
+        uint32_t m_commandCount = 0;
+    };
+
+    // Payload of the command at cursor, checked against the size recorded in its header
+    template<typename Command>
+    Command readCommand(const std::byte* cursor, const CommandHeader& header)
+    {
+        if (header.size != sizeof(CommandHeader) + sizeof(Command))
+        {
+            throw std::runtime_error("Corrupt command stream");
+        }
+
+        Command command;
+        std::memcpy(&command, cursor + sizeof(CommandHeader), sizeof(Command));
+        return command;
+    }
+
+    // Decodes a stream into translator calls, in recording order. The translator provides setPipeline(h),
+    // setRootSignature(h), setDescriptorHeap(h), setVertexBuffer(slot, h), setIndexBuffer(h),
+    // setRootConstantBuffer(parameter, address), setRootDescriptorTable(parameter, handle),
+    // transition(h, state), draw(const CommandDraw&) and drawIndexed(const CommandDrawIndexed&).
+    template<typename Translator>
+    void replayCommandStream(std::span<const std::byte> bytes, Translator& translator)
+    {
+        const std::byte* cursor = bytes.data();
+        const std::byte* end = cursor + bytes.size();
+        while (cursor < end)
+        {
+            CommandHeader header;
+            if (end - cursor < static_cast<ptrdiff_t>(sizeof(CommandHeader)))
+            {
+                throw std::runtime_error("Corrupt command stream");
+            }
+            std::memcpy(&header, cursor, sizeof(CommandHeader));
+            if (header.size > end - cursor)
+            {
+                throw std::runtime_error("Corrupt command stream");
+            }
+
+            switch (header.type)
+            {
+            case CommandType::SetPipeline:
+                translator.setPipeline(readCommand<CommandSetObject>(cursor, header).object);
+                break;
+            case CommandType::SetRootSignature:
+                translator.setRootSignature(readCommand<CommandSetObject>(cursor, header).object);
+                break;
+            case CommandType::SetDescriptorHeap:
+                translator.setDescriptorHeap(readCommand<CommandSetObject>(cursor, header).object);
+                break;
+            case CommandType::SetVertexBuffer:
+            {
+                const CommandSetVertexBuffer command = readCommand<CommandSetVertexBuffer>(cursor, header);
+                translator.setVertexBuffer(command.slot, command.view);
+                break;
+            }
+            case CommandType::SetIndexBuffer:
+                translator.setIndexBuffer(readCommand<CommandSetObject>(cursor, header).object);
+                break;
+            case CommandType::SetRootConstantBuffer:
+            {
+                const CommandSetRootArgument command = readCommand<CommandSetRootArgument>(cursor, header);
+                translator.setRootConstantBuffer(command.parameter, command.getValue());
+                break;
+            }
+            case CommandType::SetRootDescriptorTable:
+            {
+                const CommandSetRootArgument command = readCommand<CommandSetRootArgument>(cursor, header);
+                translator.setRootDescriptorTable(command.parameter, command.getValue());
+                break;
+            }
+            case CommandType::Transition:
+            {
+                const CommandTransition command = readCommand<CommandTransition>(cursor, header);
+                translator.transition(command.resource, command.state);
+                break;
+            }
+            case CommandType::Draw:
+                translator.draw(readCommand<CommandDraw>(cursor, header));
+                break;
+            case CommandType::DrawIndexed:
+                translator.drawIndexed(readCommand<CommandDrawIndexed>(cursor, header));
+                break;
+            default:
+                throw std::runtime_error("Corrupt command stream");
+            }
+
+            cursor += header.size;
+        }
+    }
+} // namespace raphael
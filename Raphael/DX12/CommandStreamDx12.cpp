@@ -0,0 +1,103 @@
+#include "CommandStreamDx12.h"
+#include "CommandList.h"
+#include <stdexcept>
+
+namespace raphael
+{
+    namespace
+    {
+        template<typename T>
+        CommandHandle addObject(std::vector<T>& table, const T& object)
+        {
+            table.push_back(object);
+            return static_cast<CommandHandle>(table.size() - 1);
+        }
+
+        template<typename T>
+        const T& getObject(const std::vector<T>& table, CommandHandle handle)
+        {
+            if (handle >= table.size())
+            {
+                throw std::runtime_error("Command stream handle out of range");
+            }
+            return table[handle];
+        }
+
+        // Forwards decoded commands to a command list
+        struct CommandListTranslator
+        {
+            const std::vector<PipelineDx12*>& pipelines;
+            const std::vector<RootSignatureDx12*>& rootSignatures;
+            const std::vector<DescriptorHeapDx12*>& descriptorHeaps;
+            const std::vector<ResourceView>& bufferViews;
+            const std::vector<ResourceDx12*>& resources;
+            CommandList* commandList;
+
+            void setPipeline(CommandHandle pipeline) { commandList->setPipeline(getObject(pipelines, pipeline)); }
+            void setRootSignature(CommandHandle rootSignature) { commandList->setGraphicsRootSignature(getObject(rootSignatures, rootSignature)); }
+            void setDescriptorHeap(CommandHandle heap) { commandList->setDescriptorHeaps(getObject(descriptorHeaps, heap), 1); }
+            void setVertexBuffer(uint32_t slot, CommandHandle view) { commandList->setVertexBuffer(slot, getObject(bufferViews, view)); }
+            void setIndexBuffer(CommandHandle view) { commandList->setIndexBuffer(getObject(bufferViews, view)); }
+            void setRootConstantBuffer(uint32_t parameter, uint64_t gpuAddress) { commandList->setConstantBufferView(parameter, gpuAddress); }
+
+            void setRootDescriptorTable(uint32_t parameter, uint64_t gpuHandle)
+            {
+                D3D12_GPU_DESCRIPTOR_HANDLE handle = {};
+                handle.ptr = gpuHandle;
+                commandList->setGraphicsRootDescriptorTable(parameter, handle);
+            }
+
+            void transition(CommandHandle resource, ResourceState state) { commandList->transitionResource(getObject(resources, resource), state); }
+
+            void draw(const CommandDraw& command)
+            {
+                commandList->drawInstanced(command.vertexCount, command.instanceCount, command.startVertex, command.startInstance);
+            }
+
+            void drawIndexed(const CommandDrawIndexed& command)
+            {
+                commandList->drawIndexedInstanced(command.indexCount, command.instanceCount, command.startIndex, command.baseVertex, command.startInstance);
+            }
+        };
+    } // namespace
+
+    CommandHandle CommandStreamDx12::addPipeline(PipelineDx12* pipeline)
+    {
+        return addObject(m_pipelines, pipeline);
+    }
+
+    CommandHandle CommandStreamDx12::addRootSignature(RootSignatureDx12* rootSignature)
+    {
+        return addObject(m_rootSignatures, rootSignature);
+    }
+
+    CommandHandle CommandStreamDx12::addDescriptorHeap(DescriptorHeapDx12* heap)
+    {
+        return addObject(m_descriptorHeaps, heap);
+    }
+
+    CommandHandle CommandStreamDx12::addBufferView(const ResourceView& view)
+    {
+        return addObject(m_bufferViews, view);
+    }
+
+    CommandHandle CommandStreamDx12::addResource(ResourceDx12* resource)
+    {
+        return addObject(m_resources, resource);
+    }
+
+    void CommandStreamDx12::clear()
+    {
+        m_pipelines.clear();
+        m_rootSignatures.clear();
+        m_descriptorHeaps.clear();
+        m_bufferViews.clear();
+        m_resources.clear();
+    }
+
+    void CommandStreamDx12::replay(const CommandStream& stream, CommandList* commandList) const
+    {
+        CommandListTranslator translator = { m_pipelines, m_rootSignatures, m_descriptorHeaps, m_bufferViews, m_resources, commandList };
+        replayCommandStream(stream.getBytes(), translator);
+    }
+} // namespace raphael
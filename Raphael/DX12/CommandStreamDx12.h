@@ -0,0 +1,47 @@
+#pragma once
+#include "CommandStream.h"
+#include "ObjectDescriptors.h"
+#include <vector>
+
+namespace raphael
+{
+    class CommandList;
+    class PipelineDx12;
+    class RootSignatureDx12;
+    class DescriptorHeapDx12;
+    class ResourceDx12;
+
+    // Replays CommandStreams into a CommandList.
+    // Owns the tables the stream handles index: register each object once and record its handle, replay
+    // translates every command into the matching CommandList call, so redundant state filtering and resource
+    // state tracking apply as if the commands had been recorded directly. Registered objects must outlive
+    // every replay of a stream that references them. Replay reads the tables only, any number of threads
+    // may replay into their own command lists at once.
+    class CommandStreamDx12
+    {
+    public:
+        CommandStreamDx12() = default;
+        ~CommandStreamDx12() = default;
+
+        CommandStreamDx12(const CommandStreamDx12& rhs) = delete;
+        CommandStreamDx12& operator=(const CommandStreamDx12& rhs) = delete;
+
+        CommandHandle addPipeline(PipelineDx12* pipeline);
+        CommandHandle addRootSignature(RootSignatureDx12* rootSignature);
+        CommandHandle addDescriptorHeap(DescriptorHeapDx12* heap);
+        // Vertex or index buffer view
+        CommandHandle addBufferView(const ResourceView& view);
+        CommandHandle addResource(ResourceDx12* resource);
+        // Drops every registered object, streams recorded with the old handles must be recorded again
+        void clear();
+
+        void replay(const CommandStream& stream, CommandList* commandList) const;
+
+    private:
+        std::vector<PipelineDx12*> m_pipelines;
+        std::vector<RootSignatureDx12*> m_rootSignatures;
+        std::vector<DescriptorHeapDx12*> m_descriptorHeaps;
+        std::vector<ResourceView> m_bufferViews;
+        std::vector<ResourceDx12*> m_resources;
+    };
+} // namespace raphael
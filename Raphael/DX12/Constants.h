@@ -25,7 +25,8 @@ namespace raphael
 
     enum CommandListType
     {
-        Direct
+        Direct,
+        Copy
     };
 
     enum class InputElementSemantic
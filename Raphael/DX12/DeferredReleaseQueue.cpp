@@ -0,0 +1,33 @@
+#include "DeferredReleaseQueue.h"
+#include <algorithm>
+
+namespace raphael
+{
+    void DeferredReleaseQueue::retire(std::shared_ptr<void> object, uint64_t fenceValue)
+    {
+        if (object == nullptr)
+        {
+            return;
+        }
+
+        // Fence values only grow in practice, so this is an append; keep the order if a caller tags an older value
+        auto position = std::upper_bound(m_entries.begin(), m_entries.end(), fenceValue,
+            [](uint64_t value, const Entry& entry) { return value < entry.fenceValue; });
+        m_entries.insert(position, Entry{ fenceValue, std::move(object) });
+    }
+
+    void DeferredReleaseQueue::releaseCompleted(uint64_t completedFenceValue)
+    {
+        while (!m_entries.empty() && m_entries.front().fenceValue <= completedFenceValue)
+        {
+            m_entries.pop_front();
+            m_releasedCount++;
+        }
+    }
+
+    void DeferredReleaseQueue::releaseAll()
+    {
+        m_releasedCount += m_entries.size();
+        m_entries.clear();
+    }
+} // namespace raphael
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace raphael
+{
+    // Keeps retired objects alive until the GPU has passed the fence value they were tagged with.
+    // Replaces "wait for every frame, then destroy" with "destroy a few frames later", so swapping a
+    // pipeline or dropping an upload buffer never stalls the CPU.
+    // Backend independent: it only compares fence values, the owner feeds it the completed value.
+    class DeferredReleaseQueue
+    {
+    public:
+        DeferredReleaseQueue() = default;
+        ~DeferredReleaseQueue() = default;
+
+        DeferredReleaseQueue(const DeferredReleaseQueue& rhs) = delete;
+        DeferredReleaseQueue& operator=(const DeferredReleaseQueue& rhs) = delete;
+
+        // Takes ownership of object and destroys it once releaseCompleted() sees fenceValue
+        template<typename T>
+        void retire(std::unique_ptr<T> object, uint64_t fenceValue)
+        {
+            if (object != nullptr)
+            {
+                retire(std::shared_ptr<void>(std::move(object)), fenceValue);
+            }
+        }
+
+        // Type-erased overload, the shared_ptr's deleter runs on release
+        void retire(std::shared_ptr<void> object, uint64_t fenceValue);
+
+        // Destroy every object whose fence value is less than or equal to completedFenceValue
+        void releaseCompleted(uint64_t completedFenceValue);
+
+        // Destroy everything regardless of fence, only valid once the GPU is idle
+        void releaseAll();
+
+        size_t getPendingCount() const { return m_entries.size(); }
+        uint64_t getReleasedCount() const { return m_releasedCount; }
+
+    private:
+        struct Entry
+        {
+            uint64_t fenceValue = 0;
+            std::shared_ptr<void> object;
+        };
+
+        std::deque<Entry> m_entries; // Sorted by fence value
+        uint64_t m_releasedCount = 0;
+    };
+} // namespace raphael
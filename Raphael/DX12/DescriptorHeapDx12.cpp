@@ -4,7 +4,7 @@
 namespace raphael
 {
     DescriptorHeapDx12::DescriptorHeapDx12(DeviceDx12* device, const DescriptorHeapDesc& desc)
-        :m_device(device), m_desc(desc)
+        :m_device(device), m_desc(desc), m_rangeAllocator(desc.numDescriptors)
     {
         switch (m_desc.type)
         {
@@ -21,17 +21,13 @@ namespace raphael
             m_heapType = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
             break;
         }
-
-        m_freeIndices.reserve(m_desc.numDescriptors);
-        for (UINT i = m_desc.numDescriptors; i > 0; i--)
-        {
-            m_freeIndices.push_back(i - 1);
-        }
-
     }
     DescriptorHeapDx12::~DescriptorHeapDx12()
     {
-        m_freeIndices.clear();
+        if (m_memoryHandle != MemoryTracker::InvalidHandle)
+        {
+            m_device->getMemoryTracker().untrack(m_memoryHandle);
+        }
     }
 
     void DescriptorHeapDx12::createDescriptorHeap()
@@ -47,6 +43,8 @@ namespace raphael
         }
 
         m_descriptorSize = m_device->getNativeDevice()->GetDescriptorHandleIncrementSize(m_heapType);
+        m_memoryHandle = m_device->getMemoryTracker().track(MemoryCategory::DescriptorHeap,
+            static_cast<uint64_t>(m_desc.numDescriptors) * m_descriptorSize, m_desc.debugName);
         m_descriptorHandle.cpuHandle = m_heap->GetCPUDescriptorHandleForHeapStart();
         if (m_desc.shaderVisible)
             m_descriptorHandle.gpuHandle = m_heap->GetGPUDescriptorHandleForHeapStart();
@@ -68,14 +66,18 @@ namespace raphael
 
     void DescriptorHeapDx12::AllocateHeap(DescriptorHandle* outHandle)
     {
-        assert(!m_freeIndices.empty() && "No more descriptors available in the heap!");
-        UINT index = m_freeIndices.back();
-        m_freeIndices.pop_back();
-        outHandle->cpuHandle.ptr = m_descriptorHandle.cpuHandle.ptr + (index * m_descriptorSize);
-        if (m_desc.shaderVisible)
-            outHandle->gpuHandle.ptr = m_descriptorHandle.gpuHandle.ptr + (index * m_descriptorSize);
-        else
-            outHandle->gpuHandle.ptr = 0;
+        AllocateRange(1, outHandle);
+    }
+
+    void DescriptorHeapDx12::AllocateRange(UINT count, DescriptorHandle* outHandle)
+    {
+        UINT index = m_rangeAllocator.allocate(count);
+        assert(index != DescriptorRangeAllocator::InvalidIndex && "No more descriptors available in the heap!");
+        if (index == DescriptorRangeAllocator::InvalidIndex)
+        {
+            throw std::runtime_error("Descriptor heap is out of contiguous descriptors");
+        }
+        getDescriptorHandle(index, outHandle);
     }
 
     void DescriptorHeapDx12::FreeHeap(const DescriptorHandle& handle)
@@ -86,6 +88,17 @@ namespace raphael
             UINT gpuIndex = static_cast<UINT>((handle.gpuHandle.ptr - m_descriptorHandle.gpuHandle.ptr) / m_descriptorSize);
             assert(cpuIndex == gpuIndex && "CPU and GPU descriptor indices do not match!");
         }
-        m_freeIndices.push_back(cpuIndex);
+        m_rangeAllocator.free(cpuIndex);
+    }
+
+    DescriptorHandle DescriptorHeapDx12::offsetHandle(const DescriptorHandle& handle, UINT offset) const
+    {
+        DescriptorHandle result = {};
+        result.cpuHandle.ptr = handle.cpuHandle.ptr + (offset * m_descriptorSize);
+        if (m_desc.shaderVisible)
+            result.gpuHandle.ptr = handle.gpuHandle.ptr + (offset * m_descriptorSize);
+        else
+            result.gpuHandle.ptr = 0;
+        return result;
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "ObjectDescriptors.h"
+#include "DescriptorRangeAllocator.h"
 
 namespace raphael
 {
@@ -20,10 +21,18 @@ namespace raphael
         void createDescriptorHeap();
         void getDescriptorHandle(UINT index, DescriptorHandle* outHandle) const;
         ID3D12DescriptorHeap* getNativeHeap() const { return m_heap.Get(); }
+        D3D12_DESCRIPTOR_HEAP_TYPE getNativeHeapType() const { return m_heapType; }
 
         void AllocateHeap(DescriptorHandle* outHandle);
+        // Allocates count contiguous descriptors (e.g. a descriptor table), outHandle points at the first one
+        void AllocateRange(UINT count, DescriptorHandle* outHandle);
+        // Frees a single descriptor or the whole range starting at handle
         void FreeHeap(const DescriptorHandle& handle);
 
+        // Handle of the descriptor offset entries after handle, used to walk a range
+        DescriptorHandle offsetHandle(const DescriptorHandle& handle, UINT offset) const;
+        UINT getDescriptorSize() const { return m_descriptorSize; }
+        TlsfAllocator::Stats getAllocationStats() const { return m_rangeAllocator.getStats(); }
 
         const DescriptorHeapDesc& getDesc() const { return m_desc; }
     private:
@@ -33,6 +42,7 @@ namespace raphael
         D3D12_DESCRIPTOR_HEAP_TYPE m_heapType = D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES;
         DescriptorHandle m_descriptorHandle = {};
         UINT m_descriptorSize = 0;
-        std::vector<UINT> m_freeIndices; // Track available descriptor indices for allocation
+        DescriptorRangeAllocator m_rangeAllocator; // Track available descriptor ranges for allocation
+        uint32_t m_memoryHandle = MemoryTracker::InvalidHandle;
     };
 }
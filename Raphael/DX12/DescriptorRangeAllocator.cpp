@@ -0,0 +1,47 @@
+#include "DescriptorRangeAllocator.h"
+#include <cassert>
+
+namespace raphael
+{
+    DescriptorRangeAllocator::DescriptorRangeAllocator(uint32_t numDescriptors)
+        : m_capacity(numDescriptors), m_allocator(numDescriptors), m_rangeNodes(numDescriptors, TlsfAllocator::InvalidNode)
+    {
+    }
+
+    uint32_t DescriptorRangeAllocator::allocate(uint32_t count)
+    {
+        TlsfAllocator::Allocation allocation = m_allocator.allocate(count);
+        if (!allocation.isValid())
+        {
+            return InvalidIndex;
+        }
+
+        const uint32_t firstIndex = static_cast<uint32_t>(allocation.offset);
+        m_rangeNodes[firstIndex] = allocation.node;
+        return firstIndex;
+    }
+
+    void DescriptorRangeAllocator::free(uint32_t firstIndex)
+    {
+        assert(firstIndex < m_capacity && m_rangeNodes[firstIndex] != TlsfAllocator::InvalidNode && "Freeing a descriptor range that is not allocated");
+
+        TlsfAllocator::Allocation allocation = {};
+        allocation.offset = firstIndex;
+        allocation.node = m_rangeNodes[firstIndex];
+        m_allocator.free(allocation);
+        m_rangeNodes[firstIndex] = TlsfAllocator::InvalidNode;
+    }
+
+    uint32_t DescriptorRangeAllocator::getRangeSize(uint32_t firstIndex) const
+    {
+        if (firstIndex >= m_capacity || m_rangeNodes[firstIndex] == TlsfAllocator::InvalidNode)
+        {
+            return 0;
+        }
+
+        TlsfAllocator::Allocation allocation = {};
+        allocation.offset = firstIndex;
+        allocation.node = m_rangeNodes[firstIndex];
+        return static_cast<uint32_t>(m_allocator.getAllocationSize(allocation));
+    }
+} // namespace raphael
@@ -0,0 +1,33 @@
+#pragma once
+#include "TlsfAllocator.h"
+
+namespace raphael
+{
+    // Hands out contiguous ranges of descriptor indices so descriptor tables can be allocated in one piece.
+    // Backed by a TLSF allocator, so both allocate and free are O(1) and freed ranges coalesce with their
+    // neighbours. Single descriptors are just ranges of one. Knows nothing about D3D12, callers turn
+    // indices into handles.
+    class DescriptorRangeAllocator
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = ~0u;
+
+        explicit DescriptorRangeAllocator(uint32_t numDescriptors);
+        ~DescriptorRangeAllocator() = default;
+
+        // Returns the first index of the range, or InvalidIndex if no contiguous range of that size is free
+        uint32_t allocate(uint32_t count);
+        // Frees the whole range that starts at firstIndex
+        void free(uint32_t firstIndex);
+
+        uint32_t getRangeSize(uint32_t firstIndex) const;
+        uint32_t getCapacity() const { return m_capacity; }
+        uint32_t getUsedCount() const { return static_cast<uint32_t>(m_allocator.getUsedSize()); }
+        TlsfAllocator::Stats getStats() const { return m_allocator.getStats(); }
+
+    private:
+        uint32_t m_capacity = 0;
+        TlsfAllocator m_allocator;
+        std::vector<uint32_t> m_rangeNodes; // TLSF node of the range starting at each index, needed to free by index
+    };
+} // namespace raphael
@@ -0,0 +1,59 @@
+#pragma once
+#include "RingAllocator.h"
+#include <cstdint>
+#include <stdexcept>
+
+namespace raphael
+{
+    // Allocation and recycling policy of a transient descriptor ring: tables are contiguous descriptor
+    // ranges handed out from a RingAllocator, tagged per frame with a fence and recycled once it completes.
+    // When the ring is exhausted allocate() waits for the oldest frame in flight. Device is anything with
+    // getCompletedFenceValue() and waitForFence(value), DeviceDx12 on the GPU and NullDevice headless.
+    // Backend independent.
+    class DescriptorRingAllocator
+    {
+    public:
+        static constexpr uint32_t InvalidOffset = ~0u;
+
+        explicit DescriptorRingAllocator(uint32_t numDescriptors) : m_ring(numDescriptors) {}
+        ~DescriptorRingAllocator() = default;
+
+        DescriptorRingAllocator(const DescriptorRingAllocator& rhs) = delete;
+        DescriptorRingAllocator& operator=(const DescriptorRingAllocator& rhs) = delete;
+
+        // Offset of count contiguous descriptors, blocks on device only when the ring is exhausted
+        template<typename Device>
+        uint32_t allocate(Device& device, uint32_t count)
+        {
+            m_ring.releaseCompleted(device.getCompletedFenceValue());
+
+            uint64_t offset = m_ring.allocate(count, 1);
+            while (offset == RingAllocator::InvalidOffset)
+            {
+                if (!m_ring.hasPendingFrames())
+                {
+                    throw std::runtime_error("Descriptor ring is too small for the requested table");
+                }
+
+                // Ring is exhausted: wait for the oldest in-flight frame and try again
+                const uint64_t oldestFence = m_ring.getOldestPendingFence();
+                device.waitForFence(oldestFence);
+                m_ring.releaseCompleted(oldestFence);
+                m_waitCount++;
+                offset = m_ring.allocate(count, 1);
+            }
+            return static_cast<uint32_t>(offset);
+        }
+
+        // Tag the tables allocated since the previous call with the fence signaled for this frame
+        void finishFrame(uint64_t fenceValue) { m_ring.finishFrame(fenceValue); }
+
+        const RingAllocator& getRing() const { return m_ring; }
+        // Times allocate() had to wait for the GPU
+        uint64_t getWaitCount() const { return m_waitCount; }
+
+    private:
+        RingAllocator m_ring;
+        uint64_t m_waitCount = 0;
+    };
+} // namespace raphael
@@ -0,0 +1,61 @@
+#include "DescriptorRingDx12.h"
+#include "DeviceDx12.h"
+
+namespace raphael
+{
+    DescriptorRingDx12::DescriptorRingDx12(DeviceDx12* device, DescriptorHeapDx12* shaderVisibleHeap, UINT numDescriptors)
+        : m_device(device), m_heap(shaderVisibleHeap), m_allocator(numDescriptors)
+    {
+        if (!shaderVisibleHeap->getDesc().shaderVisible)
+        {
+            throw std::runtime_error("Descriptor ring must live in a shader visible heap");
+        }
+
+        m_heap->AllocateRange(numDescriptors, &m_rangeStart);
+    }
+
+    DescriptorRingDx12::~DescriptorRingDx12()
+    {
+        m_heap->FreeHeap(m_rangeStart);
+    }
+
+    DescriptorHandle DescriptorRingDx12::allocateTable(UINT count)
+    {
+        const uint32_t offset = m_allocator.allocate(*m_device, count);
+        return m_heap->offsetHandle(m_rangeStart, offset);
+    }
+
+    DescriptorHandle DescriptorRingDx12::copyTable(const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, UINT count)
+    {
+        DescriptorHandle table = {};
+        copyTables(srcHandles, &count, 1, &table);
+        return table;
+    }
+
+    void DescriptorRingDx12::copyTables(const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, const UINT* tableSizes, UINT tableCount, DescriptorHandle* outTables)
+    {
+        if (tableCount == 0)
+        {
+            return;
+        }
+
+        m_dstRangeStarts.clear();
+        m_srcRangeSizes.clear();
+
+        UINT srcCount = 0;
+        for (UINT i = 0; i < tableCount; ++i)
+        {
+            outTables[i] = allocateTable(tableSizes[i]);
+            m_dstRangeStarts.push_back(outTables[i].cpuHandle);
+            srcCount += tableSizes[i];
+        }
+
+        // Staging descriptors are scattered, so each source range is a single descriptor
+        m_srcRangeSizes.resize(srcCount, 1);
+
+        m_device->getNativeDevice()->CopyDescriptors(
+            tableCount, m_dstRangeStarts.data(), tableSizes,
+            srcCount, srcHandles, m_srcRangeSizes.data(),
+            m_heap->getNativeHeapType());
+    }
+} // namespace raphael
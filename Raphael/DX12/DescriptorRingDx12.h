@@ -0,0 +1,49 @@
+#pragma once
+#include "D3D12CommonHeaders.h"
+#include "DescriptorHeapDx12.h"
+#include "DescriptorRingAllocator.h"
+
+namespace raphael
+{
+    class DeviceDx12;
+
+    // Transient descriptor tables carved out of a range of a shader-visible heap.
+    // Persistent descriptors live in CPU-only staging heaps; every frame the tables a draw needs are
+    // assembled in the ring with CopyDescriptors. Tables allocated between two finishFrame() calls are
+    // recycled together once their fence completes, so the ring never overwrites tables still in flight.
+    class DescriptorRingDx12
+    {
+    public:
+        // Reserves numDescriptors contiguous descriptors from shaderVisibleHeap for the lifetime of the ring
+        DescriptorRingDx12(DeviceDx12* device, DescriptorHeapDx12* shaderVisibleHeap, UINT numDescriptors);
+        ~DescriptorRingDx12();
+
+        DescriptorRingDx12(const DescriptorRingDx12& rhs) = delete;
+        DescriptorRingDx12& operator=(const DescriptorRingDx12& rhs) = delete;
+
+        // Uninitialized table of count contiguous descriptors, blocks only when the ring is exhausted
+        DescriptorHandle allocateTable(UINT count);
+
+        // Builds one table from count staging descriptors
+        DescriptorHandle copyTable(const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, UINT count);
+
+        // Builds tableCount tables with a single CopyDescriptors call. srcHandles holds the staging
+        // descriptors of all tables back to back, tableSizes the descriptor count of each table.
+        void copyTables(const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, const UINT* tableSizes, UINT tableCount, DescriptorHandle* outTables);
+
+        // Tag the tables built since the previous call with the fence signaled for this frame
+        void finishFrame(UINT64 fenceValue) { m_allocator.finishFrame(fenceValue); }
+
+        const RingAllocator& getRing() const { return m_allocator.getRing(); }
+
+    private:
+        DeviceDx12* m_device = nullptr;
+        DescriptorHeapDx12* m_heap = nullptr;
+        DescriptorHandle m_rangeStart = {};
+        DescriptorRingAllocator m_allocator;
+
+        // Scratch arrays reused by copyTables to avoid per-frame allocations
+        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_dstRangeStarts;
+        std::vector<UINT> m_srcRangeSizes;
+    };
+} // namespace raphael
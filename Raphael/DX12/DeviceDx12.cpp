@@ -1,4 +1,5 @@
 #include "DeviceDx12.h"
+#include "UtilDx12.h"
 
 namespace raphael
 {
@@ -8,11 +9,17 @@ namespace raphael
         initializeDevice(desc);
         createCommandQueue();
         createFence();
+
+        m_memoryAllocator = std::make_unique<GpuMemoryAllocatorDx12>(this, desc.heapBlockSize);
+        m_uploadRing = std::make_unique<UploadRingBufferDx12>(this, desc.uploadRingSize);
+        m_fixupTransitions.reserve(64);
     }
 
     DeviceDx12::~DeviceDx12()
     {
         waitForGpu();
+        waitForCopyFence(m_copyFenceLastSignaled);
+        m_releaseQueue.releaseAll();
         
         // Release fence event
         if (m_fenceEvent) 
@@ -41,6 +48,13 @@ namespace raphael
             throw std::runtime_error("Failed to create D3D12 device");
         }
 
+        // The adapter reports the process budget for local video memory
+        ComPtr<IDXGIFactory4> factory;
+        if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))))
+        {
+            factory->EnumAdapterByLuid(m_nativeDevice->GetAdapterLuid(), IID_PPV_ARGS(&m_adapter));
+        }
+
         // Setup debug interface to break on errors
         if (m_desc.enableDebugLayer)
         {
@@ -66,6 +80,16 @@ namespace raphael
         {
             throw std::runtime_error("Failed to create command queue");
         }
+
+        // Dedicated copy queue so uploads run alongside rendering on the copy engine
+        D3D12_COMMAND_QUEUE_DESC copyQueueDesc = {};
+        copyQueueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+        copyQueueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        copyQueueDesc.NodeMask = 1;
+        if (FAILED(m_nativeDevice->CreateCommandQueue(&copyQueueDesc, IID_PPV_ARGS(&m_copyQueue))))
+        {
+            throw std::runtime_error("Failed to create copy command queue");
+        }
     }
 
     void DeviceDx12::createFence()
@@ -75,6 +99,11 @@ namespace raphael
             throw std::runtime_error("Failed to create fence");
         }
 
+        if (FAILED(m_nativeDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_copyFence))))
+        {
+            throw std::runtime_error("Failed to create copy fence");
+        }
+
         m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 
         if (m_fenceEvent == nullptr)
@@ -83,6 +112,21 @@ namespace raphael
         }
 
         m_fenceLastSignaled = 0;
+        m_copyFenceLastSignaled = 0;
+    }
+
+    void DeviceDx12::updateMemoryTelemetry()
+    {
+        if (m_adapter != nullptr)
+        {
+            DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo = {};
+            if (SUCCEEDED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo)))
+            {
+                m_memoryTracker.setBudget(memoryInfo.Budget, memoryInfo.CurrentUsage);
+            }
+        }
+
+        m_memoryTracker.endFrame();
     }
 
     std::unique_ptr<ResourceDx12> DeviceDx12::createResource(const ResourceDesc& desc)
@@ -124,8 +168,52 @@ namespace raphael
 
     void DeviceDx12::executeCommandList(CommandList* commandList)
     {
-        ID3D12CommandList* cmdLists[] = { commandList->getNativeCommandList() };
-        getCommandQueue()->ExecuteCommandLists(1, cmdLists);
+        executeCommandLists(&commandList, 1);
+    }
+
+    void DeviceDx12::executeCommandLists(CommandList* const* commandLists, uint32_t count)
+    {
+        constexpr uint32_t MaxCommandLists = 64;
+        if (count > MaxCommandLists)
+        {
+            throw std::runtime_error("Too many command lists in one submission");
+        }
+
+        // Resolved in queue order, so each list is checked against the states the lists before it leave behind
+        ID3D12CommandList* cmdLists[MaxCommandLists * 2] = {};
+        uint32_t nativeCount = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_fixupTransitions.clear();
+            if (commandLists[i]->resolveResourceStates(m_fixupTransitions) > 0)
+            {
+                cmdLists[nativeCount++] = recordStateFixups(m_fixupTransitions);
+            }
+            cmdLists[nativeCount++] = commandLists[i]->getNativeCommandList();
+        }
+        getCommandQueue()->ExecuteCommandLists(nativeCount, cmdLists);
+    }
+
+    ID3D12CommandList* DeviceDx12::recordStateFixups(const std::vector<ResourceTransition>& transitions)
+    {
+        std::unique_ptr<FixupCommandList> fixupList = m_fixupLists.acquire(getCompletedFenceValue(), [this]
+        {
+            auto created = std::make_unique<FixupCommandList>();
+            created->allocator = createCommandAllocator(CommandListType::Direct);
+            created->commandList = createCommandList(CommandListDesc{});
+            created->commandList->createCommandList(created->allocator.Get());
+            return created;
+        });
+
+        CommandList* commandList = fixupList->commandList.get();
+        commandList->begin(fixupList->allocator.Get());
+        commandList->recordTransitions(transitions.data(), static_cast<uint32_t>(transitions.size()));
+        commandList->end();
+        ID3D12CommandList* nativeList = commandList->getNativeCommandList();
+
+        // Reusable once the GPU passes the fence signaled after this submission
+        m_fixupLists.release(std::move(fixupList), m_fenceLastSignaled + 1);
+        return nativeList;
     }
 
     void DeviceDx12::waitForGpu()
@@ -138,10 +226,10 @@ namespace raphael
         }
     }
 
-    ComPtr<ID3D12CommandAllocator> DeviceDx12::createCommandAllocator()
+    ComPtr<ID3D12CommandAllocator> DeviceDx12::createCommandAllocator(CommandListType type)
     {
         ComPtr<ID3D12CommandAllocator> commandAllocator;
-        if (FAILED(m_nativeDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator))))
+        if (FAILED(m_nativeDevice->CreateCommandAllocator(convertCommandListTypeToD3D12(type), IID_PPV_ARGS(&commandAllocator))))
         {
             throw std::runtime_error("Failed to create command allocator");
         }
@@ -151,6 +239,10 @@ namespace raphael
     void DeviceDx12::signalFence(UINT64 value)
     {
         m_commandQueue->Signal(m_fence.Get(), value);
+        // Everything sub-allocated from the upload ring so far is consumed by work preceding this signal
+        m_uploadRing->finishFrame(value);
+        // Opportunistically destroy retired objects the GPU is done with, never blocks
+        m_releaseQueue.releaseCompleted(getCompletedFenceValue());
     }
 
     void DeviceDx12::waitForFence(UINT64 value)
@@ -161,4 +253,39 @@ namespace raphael
             ::WaitForSingleObject(m_fenceEvent, INFINITE);
         }
     }
+
+    UploadToken DeviceDx12::executeCopyCommandList(CommandList* commandList)
+    {
+        ID3D12CommandList* cmdLists[] = { commandList->getNativeCommandList() };
+        m_copyQueue->ExecuteCommandLists(1, cmdLists);
+
+        UploadToken token = {};
+        token.copyFenceValue = ++m_copyFenceLastSignaled;
+        m_copyQueue->Signal(m_copyFence.Get(), token.copyFenceValue);
+        return token;
+    }
+
+    void DeviceDx12::waitForUpload(const UploadToken& token)
+    {
+        if (!token.isValid() || token.copyFenceValue <= m_copyFenceWaited)
+        {
+            return;
+        }
+
+        // GPU-side wait: only work submitted to the direct queue after this call is held back
+        if (m_copyFence->GetCompletedValue() < token.copyFenceValue)
+        {
+            m_commandQueue->Wait(m_copyFence.Get(), token.copyFenceValue);
+        }
+        m_copyFenceWaited = token.copyFenceValue;
+    }
+
+    void DeviceDx12::waitForCopyFence(UINT64 value)
+    {
+        if (m_copyFence->GetCompletedValue() < value)
+        {
+            m_copyFence->SetEventOnCompletion(value, m_fenceEvent);
+            ::WaitForSingleObject(m_fenceEvent, INFINITE);
+        }
+    }
 } // namespace raphael
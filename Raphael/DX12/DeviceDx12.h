@@ -6,6 +6,12 @@
 #include "SwapChainDx12.h"
 #include "RootSignatureDx12.h"
 #include "RootSignatureTableDx12.h"
+#include "UploadRingBufferDx12.h"
+#include "GpuMemoryAllocatorDx12.h"
+#include "DeferredReleaseQueue.h"
+#include "UploadBatchDx12.h"
+#include "MemoryTracker.h"
+#include "FencedObjectPool.h"
 
 namespace raphael
 {
@@ -26,28 +32,74 @@ namespace raphael
         std::unique_ptr<SwapChainDx12> createSwapChain(DescriptorHeapDx12* rtvHeap, const SwapChainDesc& desc);
         std::unique_ptr<RootSignatureTableDx12> createRootSignatureTable(DescriptorHeapDx12* srvHeap, const RootSignatureTableDesc& desc);
         void executeCommandList(CommandList* commandList);
+        // Submits the lists in order with a single ExecuteCommandLists call. Each list's resource states are
+        // resolved first, a list whose first uses do not match gets a small barrier list inserted before it.
+        void executeCommandLists(CommandList* const* commandLists, uint32_t count);
         void waitForGpu(); // TODO: Probably don't need this method
-        ComPtr<ID3D12CommandAllocator> createCommandAllocator();
+        ComPtr<ID3D12CommandAllocator> createCommandAllocator(CommandListType type = CommandListType::Direct);
         void signalFence(UINT64 value);
         void waitForFence(UINT64 value);
         UINT64 getNextFenceValue() { return ++m_fenceLastSignaled; }
+        UINT64 getCompletedFenceValue() const { return m_fence->GetCompletedValue(); }
+
+        // Copy queue: executes a COPY command list and signals the copy fence
+        UploadToken executeCopyCommandList(CommandList* commandList);
+        // Makes the direct queue wait (on the GPU) for an upload batch, no-op once already waited for or completed
+        void waitForUpload(const UploadToken& token);
+        void waitForCopyFence(UINT64 value);
+        UINT64 getCompletedCopyFenceValue() const { return m_copyFence->GetCompletedValue(); }
+        UploadRingBufferDx12* getUploadRing() const { return m_uploadRing.get(); }
+        GpuMemoryAllocatorDx12* getMemoryAllocator() const { return m_memoryAllocator.get(); }
+        MemoryTracker& getMemoryTracker() { return m_memoryTracker; }
+        const MemoryTracker& getMemoryTracker() const { return m_memoryTracker; }
+        // Refreshes the OS video memory budget and closes the tracker's frame, called once per present
+        void updateMemoryTelemetry();
+
+        // Destroys object once the GPU finishes all work submitted up to the next fence signal,
+        // use instead of waiting on every frame before replacing a resource or pipeline
+        template<typename T>
+        void retire(std::unique_ptr<T> object)
+        {
+            m_releaseQueue.retire(std::move(object), m_fenceLastSignaled + 1);
+        }
+        const DeferredReleaseQueue& getReleaseQueue() const { return m_releaseQueue; }
 
         // DX12 specific methods
         ID3D12Device* getNativeDevice() const { return m_nativeDevice.Get(); }
         ID3D12CommandQueue* getCommandQueue() const { return m_commandQueue.Get(); }
+        ID3D12CommandQueue* getCopyQueue() const { return m_copyQueue.Get(); }
 
     private:
         void initializeDevice(const DeviceDesc& desc);
         void createCommandQueue();
         void createFence();
+        ID3D12CommandList* recordStateFixups(const std::vector<ResourceTransition>& transitions);
+
+    private:
+        struct FixupCommandList
+        {
+            ComPtr<ID3D12CommandAllocator> allocator;
+            std::unique_ptr<CommandList> commandList;
+        };
 
     private:
         DeviceDesc m_desc = {};
         ComPtr<ID3D12Device> m_nativeDevice;
+        ComPtr<IDXGIAdapter3> m_adapter; // Only used to query the video memory budget, may be null
         ComPtr<ID3D12CommandQueue> m_commandQueue;
         ComPtr<ID3D12Fence> m_fence;
         HANDLE m_fenceEvent = nullptr;
         UINT64 m_fenceLastSignaled = 0;
+        ComPtr<ID3D12CommandQueue> m_copyQueue;
+        ComPtr<ID3D12Fence> m_copyFence;
+        UINT64 m_copyFenceLastSignaled = 0;
+        UINT64 m_copyFenceWaited = 0; // Highest copy fence value the direct queue already waits on
+        MemoryTracker m_memoryTracker; // Declared first so it outlives every tracked object the device owns
+        std::unique_ptr<GpuMemoryAllocatorDx12> m_memoryAllocator; // Must outlive every resource placed in its heaps
+        DeferredReleaseQueue m_releaseQueue;
+        std::unique_ptr<UploadRingBufferDx12> m_uploadRing;
+        FencedObjectPool<std::unique_ptr<FixupCommandList>> m_fixupLists; // Barrier lists resolving states at submit
+        std::vector<ResourceTransition> m_fixupTransitions;
 
     };
 } // namespace raphael
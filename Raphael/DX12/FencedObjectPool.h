@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace raphael
+{
+    // Recycles objects the GPU reads while executing, such as command allocators.
+    // An object is released with the fence value of the submission that uses it and is only handed out
+    // again once acquire() is given a completed value at or past that fence; otherwise a new one is created.
+    // Not thread safe: give every recording thread its own pool so the hot path needs no lock.
+    // Both lists only grow to the number of objects ever in flight, steady state acquire/release do not allocate.
+    // Backend independent: the owner supplies the factory and the completed fence value.
+    template<typename T>
+    class FencedObjectPool
+    {
+    public:
+        FencedObjectPool() = default;
+        ~FencedObjectPool() = default;
+
+        FencedObjectPool(const FencedObjectPool& rhs) = delete;
+        FencedObjectPool& operator=(const FencedObjectPool& rhs) = delete;
+        FencedObjectPool(FencedObjectPool&& rhs) = default;
+        FencedObjectPool& operator=(FencedObjectPool&& rhs) = default;
+
+        // Returns an idle object, or create() if every pooled one may still be in use by the GPU
+        template<typename Factory>
+        T acquire(uint64_t completedFenceValue, Factory&& create)
+        {
+            releaseCompleted(completedFenceValue);
+            if (m_free.empty())
+            {
+                ++m_createdCount;
+                return create();
+            }
+
+            ++m_reusedCount;
+            T object = std::move(m_free.back());
+            m_free.pop_back();
+            return object;
+        }
+
+        // Hand an object back, it becomes reusable once the GPU has passed fenceValue
+        void release(T object, uint64_t fenceValue)
+        {
+            m_pending.push_back({ fenceValue, std::move(object) });
+        }
+
+        // Move every object whose fence value is less than or equal to completedFenceValue to the free list
+        void releaseCompleted(uint64_t completedFenceValue)
+        {
+            for (size_t i = 0; i < m_pending.size();)
+            {
+                if (m_pending[i].fenceValue <= completedFenceValue)
+                {
+                    m_free.push_back(std::move(m_pending[i].object));
+                    m_pending[i] = std::move(m_pending.back());
+                    m_pending.pop_back();
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+        size_t getFreeCount() const { return m_free.size(); }
+        size_t getPendingCount() const { return m_pending.size(); }
+        uint64_t getCreatedCount() const { return m_createdCount; }
+        uint64_t getReusedCount() const { return m_reusedCount; }
+
+    private:
+        struct Entry
+        {
+            uint64_t fenceValue = 0;
+            T object = {};
+        };
+
+        std::vector<Entry> m_pending; // Unordered, only a handful of entries per thread
+        std::vector<T> m_free;
+        uint64_t m_createdCount = 0;
+        uint64_t m_reusedCount = 0;
+    };
+} // namespace raphael
@@ -0,0 +1,107 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace raphael
+{
+    static size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    FrameArena::FrameArena(size_t capacity)
+        : m_block(new std::byte[capacity]), m_capacity(capacity)
+    {
+    }
+
+    void* FrameArena::allocate(size_t size, size_t alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+        m_allocationCount++;
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(m_block.get());
+        const size_t offset = alignUp(base + m_offset, alignment) - base;
+        if (offset + size <= m_capacity)
+        {
+            m_usedSize += (offset - m_offset) + size;
+            m_offset = offset + size;
+            m_peakUsedSize = std::max(m_peakUsedSize, m_usedSize);
+            return m_block.get() + offset;
+        }
+
+        // Frame is bigger than the block: serve it from a dedicated block, reset() grows the main one
+        m_overflowCount++;
+        m_overflowBlocks.push_back(std::unique_ptr<std::byte[]>(new std::byte[size + alignment]));
+        m_usedSize += size + alignment;
+        m_peakUsedSize = std::max(m_peakUsedSize, m_usedSize);
+
+        std::byte* overflowBlock = m_overflowBlocks.back().get();
+        const uintptr_t overflowBase = reinterpret_cast<uintptr_t>(overflowBlock);
+        return overflowBlock + (alignUp(overflowBase, alignment) - overflowBase);
+    }
+
+    void FrameArena::reset()
+    {
+        if (!m_overflowBlocks.empty())
+        {
+            // Size for the peak plus some headroom so the next similar frame stays in one block
+            m_capacity = alignUp(m_peakUsedSize + m_peakUsedSize / 4, alignof(std::max_align_t));
+            m_block.reset(new std::byte[m_capacity]);
+            m_overflowBlocks.clear();
+        }
+
+        m_offset = 0;
+        m_usedSize = 0;
+        m_allocationCount = 0;
+    }
+
+    FrameArenaPool::FrameArenaPool(uint32_t frameCount, uint32_t threadCount, size_t capacity)
+        : m_frameCount(frameCount), m_threadCount(threadCount)
+    {
+        if (frameCount == 0 || threadCount == 0)
+        {
+            throw std::runtime_error("Frame arena pool needs at least one frame and one thread");
+        }
+
+        m_slots.reserve(static_cast<size_t>(frameCount) * threadCount);
+        for (uint32_t i = 0; i < frameCount * threadCount; ++i)
+        {
+            m_slots.push_back(std::make_unique<Slot>(capacity));
+        }
+    }
+
+    void FrameArenaPool::beginFrame(uint32_t frameIndex)
+    {
+        assert(frameIndex < m_frameCount && "Frame index out of range");
+
+        m_frameIndex = frameIndex;
+        for (uint32_t thread = 0; thread < m_threadCount; ++thread)
+        {
+            m_slots[m_frameIndex * m_threadCount + thread]->arena.reset();
+        }
+    }
+
+    FrameArena& FrameArenaPool::getArena(uint32_t threadIndex)
+    {
+        assert(threadIndex < m_threadCount && "Thread index out of range");
+        return m_slots[m_frameIndex * m_threadCount + threadIndex]->arena;
+    }
+
+    FrameArenaResource& FrameArenaPool::getResource(uint32_t threadIndex)
+    {
+        assert(threadIndex < m_threadCount && "Thread index out of range");
+        return m_slots[m_frameIndex * m_threadCount + threadIndex]->resource;
+    }
+
+    size_t FrameArenaPool::getUsedSize() const
+    {
+        size_t usedSize = 0;
+        for (uint32_t thread = 0; thread < m_threadCount; ++thread)
+        {
+            usedSize += m_slots[m_frameIndex * m_threadCount + thread]->arena.getUsedSize();
+        }
+        return usedSize;
+    }
+} // namespace raphael
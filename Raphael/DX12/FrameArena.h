@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace raphael
+{
+    // Linear CPU allocator for data that only lives for one frame: draw lists, descriptor tables, scratch arrays.
+    // Allocation is a pointer bump and nothing is freed individually, reset() drops everything at once.
+    // When a frame outgrows the block the extra requests go to overflow blocks, and the next reset() replaces
+    // the block with one large enough for that peak, so a steady-state frame never touches the global heap.
+    class FrameArena
+    {
+    public:
+        explicit FrameArena(size_t capacity = 256 * 1024);
+        ~FrameArena() = default;
+
+        FrameArena(const FrameArena& rhs) = delete;
+        FrameArena& operator=(const FrameArena& rhs) = delete;
+
+        // Alignment must be a power of two
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        // Uninitialized storage for count objects of type T
+        template<typename T>
+        T* allocateArray(size_t count)
+        {
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        void reset();
+
+        size_t getCapacity() const { return m_capacity; }
+        size_t getUsedSize() const { return m_usedSize; }
+        size_t getPeakUsedSize() const { return m_peakUsedSize; }
+        uint64_t getAllocationCount() const { return m_allocationCount; } // Since the last reset
+        uint64_t getOverflowCount() const { return m_overflowCount; }     // Allocations that missed the block, lifetime total
+
+    private:
+        std::unique_ptr<std::byte[]> m_block;
+        size_t m_capacity = 0;
+        size_t m_offset = 0;
+        size_t m_usedSize = 0; // Includes overflow allocations
+        size_t m_peakUsedSize = 0;
+        uint64_t m_allocationCount = 0;
+        uint64_t m_overflowCount = 0;
+        std::vector<std::unique_ptr<std::byte[]>> m_overflowBlocks;
+    };
+
+    // std::pmr adaptor so standard containers can live in a FrameArena:
+    //   FrameArenaResource resource(arena);
+    //   std::pmr::vector<DrawItem> drawList(&resource);
+    // Deallocation is a no-op, memory comes back on FrameArena::reset(). Containers must not outlive the frame.
+    class FrameArenaResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit FrameArenaResource(FrameArena& arena) : m_arena(arena) {}
+
+        FrameArena& getArena() const { return m_arena; }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override { return m_arena.allocate(bytes, alignment); }
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    private:
+        FrameArena& m_arena;
+    };
+
+    // One arena per frame in flight and per recording thread. beginFrame() resets the arenas of the frame
+    // being started, call it only once the GPU has finished that frame so nothing still points into them.
+    class FrameArenaPool
+    {
+    public:
+        FrameArenaPool(uint32_t frameCount, uint32_t threadCount, size_t capacity = 256 * 1024);
+        ~FrameArenaPool() = default;
+
+        FrameArenaPool(const FrameArenaPool& rhs) = delete;
+        FrameArenaPool& operator=(const FrameArenaPool& rhs) = delete;
+
+        void beginFrame(uint32_t frameIndex);
+
+        FrameArena& getArena(uint32_t threadIndex = 0);
+        FrameArenaResource& getResource(uint32_t threadIndex = 0);
+
+        uint32_t getFrameCount() const { return m_frameCount; }
+        uint32_t getThreadCount() const { return m_threadCount; }
+        size_t getUsedSize() const; // Current frame, every thread
+
+    private:
+        struct Slot
+        {
+            FrameArena arena;
+            FrameArenaResource resource;
+
+            explicit Slot(size_t capacity) : arena(capacity), resource(arena) {}
+        };
+
+        uint32_t m_frameCount = 0;
+        uint32_t m_threadCount = 0;
+        uint32_t m_frameIndex = 0;
+        std::vector<std::unique_ptr<Slot>> m_slots; // frameIndex * threadCount + threadIndex
+    };
+} // namespace raphael
@@ -0,0 +1,217 @@
+#pragma once
+#include "TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace raphael
+{
+    struct FramePipelineStats
+    {
+        uint64_t simulatedCount = 0; // Snapshots produced
+        uint64_t renderedCount = 0;  // Fresh snapshots picked up by the render thread
+        uint64_t repeatedCount = 0;  // Frames that rendered the previous snapshot again
+        double simulateMs = 0.0;     // Cost of the last simulation step
+        double latencyMs = 0.0;      // From the start of the last rendered snapshot's simulation to its pickup
+    };
+
+    // Two-stage frame pipeline: a simulation thread produces immutable Snapshots (camera, visible objects,
+    // constants) while the render thread records the previous one, so simulation and submission overlap.
+    // Snapshots travel through a lock-free TripleBuffer. The simulation runs at most one snapshot ahead of
+    // the render thread, which bounds the added latency to one frame and keeps it from burning a core on
+    // snapshots nobody draws. When the thread is stopped acquire() simulates inline, the serial loop.
+    // Backend independent.
+    template<typename Snapshot>
+    class FramePipeline
+    {
+    public:
+        // Called with the snapshot to overwrite and the seconds since the previous step
+        using SimulateFunction = std::function<void(Snapshot& snapshot, double deltaSeconds)>;
+
+        // prepare runs once on each of the three snapshots up front, reserve their containers there so
+        // the simulation never allocates
+        explicit FramePipeline(SimulateFunction simulate, const std::function<void(Snapshot& snapshot)>& prepare = nullptr)
+            : m_simulate(std::move(simulate))
+        {
+            if (prepare)
+            {
+                m_buffer.initialize([&](Slot& slot) { prepare(slot.snapshot); });
+            }
+        }
+
+        ~FramePipeline() { stop(); }
+
+        FramePipeline(const FramePipeline& rhs) = delete;
+        FramePipeline& operator=(const FramePipeline& rhs) = delete;
+
+        // Render thread only
+        void start()
+        {
+            if (m_thread.joinable())
+            {
+                return;
+            }
+
+            m_consumedSequence.store(m_publishedSequence.load());
+            m_running.store(true);
+            m_thread = std::thread([this] { simulationLoop(); });
+        }
+
+        // Render thread only, returns once the simulation thread has finished its current step
+        void stop()
+        {
+            if (!m_thread.joinable())
+            {
+                return;
+            }
+
+            m_running.store(false);
+            // Wake the simulation thread if it is waiting for the render thread to catch up
+            m_consumedSequence.fetch_add(1);
+            m_consumedSequence.notify_all();
+            m_thread.join();
+        }
+
+        bool isThreaded() const { return m_thread.joinable(); }
+
+        // Render thread only: the newest snapshot. With waitForNew it blocks until the simulation published
+        // one the render thread has not drawn yet, otherwise it may return the previous snapshot again.
+        // Rethrows an exception thrown by the simulation.
+        const Snapshot& acquire(bool waitForNew = true)
+        {
+            if (!m_thread.joinable())
+            {
+                step();
+            }
+            else if (waitForNew)
+            {
+                uint64_t published = m_publishedSequence.load(std::memory_order_acquire);
+                while (published <= m_renderedSequence && m_running.load())
+                {
+                    m_publishedSequence.wait(published);
+                    published = m_publishedSequence.load(std::memory_order_acquire);
+                }
+            }
+
+            // Acquire pairs with the release in simulationLoop, which makes m_error visible here
+            if (m_hasError.load(std::memory_order_acquire))
+            {
+                stop();
+                m_hasError.store(false, std::memory_order_relaxed);
+                std::exception_ptr error = std::exchange(m_error, nullptr);
+                std::rethrow_exception(error);
+            }
+
+            if (m_buffer.acquire())
+            {
+                const Slot& slot = m_buffer.getReadBuffer();
+                m_renderedSequence = slot.sequence;
+                m_stats.renderedCount++;
+                m_stats.latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - slot.startTime).count();
+
+                // Lets the simulation start on the next snapshot while this one is recorded
+                m_consumedSequence.store(slot.sequence, std::memory_order_release);
+                m_consumedSequence.notify_one();
+            }
+            else
+            {
+                m_stats.repeatedCount++;
+            }
+            return m_buffer.getReadBuffer().snapshot;
+        }
+
+        // Render thread only
+        FramePipelineStats getStats() const
+        {
+            FramePipelineStats stats = m_stats;
+            stats.simulatedCount = m_publishedSequence.load(std::memory_order_relaxed);
+            stats.simulateMs = m_simulateNanoseconds.load(std::memory_order_relaxed) * 1e-6;
+            return stats;
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Slot
+        {
+            Snapshot snapshot;
+            uint64_t sequence = 0;
+            Clock::time_point startTime = {};
+        };
+
+        // Writer side, on whichever thread currently owns the simulation
+        void step()
+        {
+            const Clock::time_point startTime = Clock::now();
+            const double deltaSeconds = m_lastStepTime == Clock::time_point{}
+                ? 0.0
+                : std::chrono::duration<double>(startTime - m_lastStepTime).count();
+            m_lastStepTime = startTime;
+
+            Slot& slot = m_buffer.getWriteBuffer();
+            m_simulate(slot.snapshot, deltaSeconds);
+            slot.sequence = m_publishedSequence.load(std::memory_order_relaxed) + 1;
+            slot.startTime = startTime;
+            m_simulateNanoseconds.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count(),
+                std::memory_order_relaxed);
+
+            m_buffer.publish();
+            m_publishedSequence.store(slot.sequence, std::memory_order_release);
+            m_publishedSequence.notify_one();
+        }
+
+        void simulationLoop()
+        {
+            while (m_running.load())
+            {
+                try
+                {
+                    step();
+                }
+                catch (...)
+                {
+                    // Handed to the render thread, the bumped sequence wakes it up to see it
+                    m_error = std::current_exception();
+                    m_hasError.store(true, std::memory_order_release);
+                    m_running.store(false);
+                    m_publishedSequence.fetch_add(1);
+                    m_publishedSequence.notify_all();
+                    return;
+                }
+
+                // Stay at most one snapshot ahead of the render thread
+                const uint64_t published = m_publishedSequence.load(std::memory_order_relaxed);
+                uint64_t consumed = m_consumedSequence.load(std::memory_order_acquire);
+                while (consumed < published && m_running.load())
+                {
+                    m_consumedSequence.wait(consumed);
+                    consumed = m_consumedSequence.load(std::memory_order_acquire);
+                }
+            }
+        }
+
+    private:
+        SimulateFunction m_simulate;
+        TripleBuffer<Slot> m_buffer;
+        std::thread m_thread;
+        std::atomic<bool> m_running{ false };
+        // Written by the simulation thread before m_hasError is released, read by the render thread only
+        // after it acquired the flag
+        std::exception_ptr m_error;
+        std::atomic<bool> m_hasError{ false };
+
+        // Simulation side
+        Clock::time_point m_lastStepTime = {};
+        std::atomic<uint64_t> m_publishedSequence{ 0 };
+        std::atomic<int64_t> m_simulateNanoseconds{ 0 };
+
+        // Render side
+        std::atomic<uint64_t> m_consumedSequence{ 0 };
+        uint64_t m_renderedSequence = 0;
+        FramePipelineStats m_stats;
+    };
+} // namespace raphael
@@ -0,0 +1,69 @@
+#pragma once
+#include "FrameScheduler.h"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+namespace raphael
+{
+    // One T per frame slot, for data the CPU writes while the GPU may still read an earlier frame's copy:
+    // upload buffers, command allocators, per-frame descriptor tables. Holds up to MaxFramesInFlight copies,
+    // create() builds the first count of them and get() picks the scheduler's current slot.
+    // Backend independent.
+    template<typename T>
+    class FrameResource
+    {
+    public:
+        FrameResource() = default;
+        ~FrameResource() = default;
+
+        FrameResource(const FrameResource& rhs) = delete;
+        FrameResource& operator=(const FrameResource& rhs) = delete;
+
+        // Replaces every copy with factory(slot) for slot in [0, count), the rest are reset to T{}.
+        // Only while the GPU no longer uses the old copies.
+        template<typename Factory>
+        void create(uint32_t count, Factory&& factory)
+        {
+            if (count == 0 || count > MaxFramesInFlight)
+            {
+                throw std::runtime_error("Frame resource count must be between 1 and MaxFramesInFlight");
+            }
+
+            for (uint32_t slot = 0; slot < MaxFramesInFlight; ++slot)
+            {
+                m_copies[slot] = slot < count ? factory(slot) : T{};
+            }
+            m_count = count;
+        }
+
+        T& get(const FrameScheduler& scheduler) { return (*this)[scheduler.getCurrentSlot()]; }
+        const T& get(const FrameScheduler& scheduler) const { return (*this)[scheduler.getCurrentSlot()]; }
+
+        T& operator[](uint32_t slot)
+        {
+            if (slot >= m_count)
+            {
+                throw std::runtime_error("Frame slot without a frame resource");
+            }
+            return m_copies[slot];
+        }
+
+        const T& operator[](uint32_t slot) const
+        {
+            if (slot >= m_count)
+            {
+                throw std::runtime_error("Frame slot without a frame resource");
+            }
+            return m_copies[slot];
+        }
+
+        uint32_t getCount() const { return m_count; }
+        std::span<T> getAll() { return std::span<T>(m_copies.data(), m_count); }
+
+    private:
+        std::array<T, MaxFramesInFlight> m_copies = {};
+        uint32_t m_count = 0;
+    };
+} // namespace raphael
@@ -0,0 +1,70 @@
+#include "FrameScheduler.h"
+#include <stdexcept>
+
+namespace raphael
+{
+    FrameScheduler::FrameScheduler(uint32_t framesInFlight)
+    {
+        setFramesInFlight(framesInFlight, 0);
+        // The first beginFrame() moves to slot 0
+        m_currentSlot = m_framesInFlight - 1;
+    }
+
+    uint64_t FrameScheduler::beginFrame(uint64_t completedFenceValue)
+    {
+        if (m_inFrame)
+        {
+            throw std::runtime_error("Frame begun twice without endFrame()");
+        }
+
+        m_currentSlot = (m_currentSlot + 1) % m_framesInFlight;
+        m_inFrame = true;
+        m_stats.frameCount++;
+
+        const uint64_t slotFenceValue = m_slotFenceValues[m_currentSlot];
+        if (slotFenceValue <= completedFenceValue)
+        {
+            return 0;
+        }
+
+        m_stats.waitCount++;
+        return slotFenceValue;
+    }
+
+    void FrameScheduler::endFrame(uint64_t fenceValue)
+    {
+        if (!m_inFrame)
+        {
+            throw std::runtime_error("endFrame() without beginFrame()");
+        }
+        if (fenceValue < m_lastFenceValue)
+        {
+            throw std::runtime_error("Frame fence values must not go backwards");
+        }
+
+        m_slotFenceValues[m_currentSlot] = fenceValue;
+        m_lastFenceValue = fenceValue;
+        m_inFrame = false;
+    }
+
+    void FrameScheduler::setFramesInFlight(uint32_t framesInFlight, uint64_t completedFenceValue)
+    {
+        if (framesInFlight == 0 || framesInFlight > MaxFramesInFlight)
+        {
+            throw std::runtime_error("Frames in flight must be between 1 and MaxFramesInFlight");
+        }
+        if (m_inFrame)
+        {
+            throw std::runtime_error("Frames in flight changed inside a frame");
+        }
+        if (completedFenceValue < m_lastFenceValue)
+        {
+            throw std::runtime_error("Frames in flight changed while the GPU is still busy");
+        }
+
+        // Every slot is free, start the new cycle at slot 0
+        m_framesInFlight = framesInFlight;
+        m_currentSlot = framesInFlight - 1;
+        m_slotFenceValues.fill(0);
+    }
+} // namespace raphael
@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace raphael
+{
+    constexpr uint32_t MaxFramesInFlight = 4;
+
+    struct FrameSchedulerStats
+    {
+        uint64_t frameCount = 0;
+        uint64_t waitCount = 0; // Frames whose slot was still in use by the GPU, the CPU had to wait
+    };
+
+    // Decides which frame slot the CPU records into and when it has to wait for the GPU.
+    // Frames cycle through framesInFlight slots; each slot remembers the fence signaled after the last frame
+    // recorded into it. beginFrame() returns that fence only when the GPU has not passed it yet, so a CPU
+    // that is not ahead of the GPU by framesInFlight frames never waits. More frames in flight trade latency
+    // for throughput, the count can change at runtime once the GPU is idle.
+    // Backend independent: the owner passes in the completed fence value and performs the wait.
+    class FrameScheduler
+    {
+    public:
+        explicit FrameScheduler(uint32_t framesInFlight = 2);
+        ~FrameScheduler() = default;
+
+        FrameScheduler(const FrameScheduler& rhs) = delete;
+        FrameScheduler& operator=(const FrameScheduler& rhs) = delete;
+
+        // Moves to the next slot. Returns the fence value to wait for before reusing it, 0 when it is free.
+        uint64_t beginFrame(uint64_t completedFenceValue);
+        // Call with the fence value signaled after the frame's last submission
+        void endFrame(uint64_t fenceValue);
+
+        // Between 1 and MaxFramesInFlight. Every frame must be finished and the GPU idle, i.e.
+        // completedFenceValue must have reached getLastFenceValue().
+        void setFramesInFlight(uint32_t framesInFlight, uint64_t completedFenceValue);
+
+        uint32_t getFramesInFlight() const { return m_framesInFlight; }
+        uint32_t getCurrentSlot() const { return m_currentSlot; }
+        bool isInFrame() const { return m_inFrame; }
+        // Highest fence value signaled by any slot, waiting for it drains every frame in flight
+        uint64_t getLastFenceValue() const { return m_lastFenceValue; }
+        uint64_t getSlotFenceValue(uint32_t slot) const { return m_slotFenceValues[slot]; }
+        const FrameSchedulerStats& getStats() const { return m_stats; }
+
+    private:
+        uint32_t m_framesInFlight = 2;
+        uint32_t m_currentSlot = 0;
+        bool m_inFrame = false;
+        std::array<uint64_t, MaxFramesInFlight> m_slotFenceValues = {};
+        uint64_t m_lastFenceValue = 0;
+        FrameSchedulerStats m_stats;
+    };
+} // namespace raphael
@@ -0,0 +1,320 @@
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC accepts AVX2 intrinsics in any function, the path only runs after the CPU check
+#define RAPHAEL_TARGET_AVX2
+#else
+#define RAPHAEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#define RAPHAEL_CULLING_AVX2 1
+#endif
+
+namespace raphael
+{
+    namespace
+    {
+        // Padding lanes: no plane distance makes up for this radius
+        constexpr float NeverVisibleRadius = -FLT_MAX;
+
+        // Computed in double: the far plane is a difference of nearly equal columns and loses most of its bits in float
+        void storeNormalizedPlane(const double* plane, float* outPlane)
+        {
+            const double length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            for (int i = 0; i < 4; ++i)
+            {
+                outPlane[i] = static_cast<float>(length > 0.0 ? plane[i] / length : plane[i]);
+            }
+        }
+
+        uint32_t cullRangeScalar(const Frustum& frustum, const CullingBounds& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices)
+        {
+            const float* centerX = bounds.getCenterX();
+            const float* centerY = bounds.getCenterY();
+            const float* centerZ = bounds.getCenterZ();
+            const float* extentX = bounds.getExtentX();
+            const float* extentY = bounds.getExtentY();
+            const float* extentZ = bounds.getExtentZ();
+            const float* radius = bounds.getRadius();
+
+            uint32_t visibleCount = 0;
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                bool visible = true;
+                for (const float* plane : frustum.planes)
+                {
+                    // Same operation order as the SIMD path, so both round alike
+                    const float distance = plane[0] * centerX[i] + plane[1] * centerY[i] + plane[2] * centerZ[i] + plane[3];
+                    const float reach = std::fabs(plane[0]) * extentX[i] + std::fabs(plane[1]) * extentY[i] + std::fabs(plane[2]) * extentZ[i] + radius[i];
+                    visible &= distance + reach >= 0.0f;
+                }
+                outVisibleIndices[visibleCount] = i;
+                visibleCount += visible ? 1 : 0;
+            }
+            return visibleCount;
+        }
+
+#if RAPHAEL_CULLING_AVX2
+        // Lane numbers of the set bits of each 8-bit mask, packed one per byte from the lowest byte up
+        constexpr std::array<uint64_t, 256> buildCompactionTable()
+        {
+            std::array<uint64_t, 256> table = {};
+            for (uint32_t mask = 0; mask < 256; ++mask)
+            {
+                uint32_t slot = 0;
+                for (uint32_t lane = 0; lane < 8; ++lane)
+                {
+                    if ((mask >> lane) & 1)
+                    {
+                        table[mask] |= static_cast<uint64_t>(lane) << (slot++ * 8);
+                    }
+                }
+            }
+            return table;
+        }
+        constexpr std::array<uint64_t, 256> CompactionTable = buildCompactionTable();
+
+        RAPHAEL_TARGET_AVX2
+        uint32_t cullRangeAvx2(const Frustum& frustum, const CullingBounds& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices)
+        {
+            const __m256 signMask = _mm256_set1_ps(-0.0f);
+            __m256 planeA[6], planeB[6], planeC[6], planeD[6], absA[6], absB[6], absC[6];
+            for (int p = 0; p < 6; ++p)
+            {
+                planeA[p] = _mm256_set1_ps(frustum.planes[p][0]);
+                planeB[p] = _mm256_set1_ps(frustum.planes[p][1]);
+                planeC[p] = _mm256_set1_ps(frustum.planes[p][2]);
+                planeD[p] = _mm256_set1_ps(frustum.planes[p][3]);
+                absA[p] = _mm256_andnot_ps(signMask, planeA[p]);
+                absB[p] = _mm256_andnot_ps(signMask, planeB[p]);
+                absC[p] = _mm256_andnot_ps(signMask, planeC[p]);
+            }
+
+            const __m256 zero = _mm256_setzero_ps();
+            uint32_t visibleCount = 0;
+            for (uint32_t i = begin; i < end; i += 8)
+            {
+                const __m256 centerX = _mm256_loadu_ps(bounds.getCenterX() + i);
+                const __m256 centerY = _mm256_loadu_ps(bounds.getCenterY() + i);
+                const __m256 centerZ = _mm256_loadu_ps(bounds.getCenterZ() + i);
+                const __m256 extentX = _mm256_loadu_ps(bounds.getExtentX() + i);
+                const __m256 extentY = _mm256_loadu_ps(bounds.getExtentY() + i);
+                const __m256 extentZ = _mm256_loadu_ps(bounds.getExtentZ() + i);
+                const __m256 radius = _mm256_loadu_ps(bounds.getRadius() + i);
+
+                __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int p = 0; p < 6; ++p)
+                {
+                    __m256 distance = _mm256_add_ps(_mm256_mul_ps(planeA[p], centerX), _mm256_mul_ps(planeB[p], centerY));
+                    distance = _mm256_add_ps(_mm256_add_ps(distance, _mm256_mul_ps(planeC[p], centerZ)), planeD[p]);
+                    __m256 reach = _mm256_add_ps(_mm256_mul_ps(absA[p], extentX), _mm256_mul_ps(absB[p], extentY));
+                    reach = _mm256_add_ps(_mm256_add_ps(reach, _mm256_mul_ps(absC[p], extentZ)), radius);
+                    visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_GE_OQ));
+                }
+
+                // Compact the visible lanes to the front and store all eight, the next store overwrites the rest
+                const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(visible));
+                const __m256i lanes = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(CompactionTable[mask])));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(outVisibleIndices + visibleCount), _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), lanes));
+                visibleCount += static_cast<uint32_t>(std::popcount(mask));
+            }
+            return visibleCount;
+        }
+#endif
+    } // namespace
+
+    Frustum extractFrustum(const float* viewProjection)
+    {
+        // Row vectors: clip = v * M, so each clip coordinate is a dot product with a column of M
+        const auto column = [viewProjection](int c, int r) { return static_cast<double>(viewProjection[r * 4 + c]); };
+
+        double planes[6][4] = {};
+        for (int r = 0; r < 4; ++r)
+        {
+            planes[0][r] = column(3, r) + column(0, r); // Left:   x >= -w
+            planes[1][r] = column(3, r) - column(0, r); // Right:  x <= w
+            planes[2][r] = column(3, r) + column(1, r); // Bottom: y >= -w
+            planes[3][r] = column(3, r) - column(1, r); // Top:    y <= w
+            planes[4][r] = column(2, r);                // Near:   z >= 0
+            planes[5][r] = column(3, r) - column(2, r); // Far:    z <= w
+        }
+
+        Frustum frustum;
+        for (int p = 0; p < 6; ++p)
+        {
+            storeNormalizedPlane(planes[p], frustum.planes[p]);
+        }
+        return frustum;
+    }
+
+    void CullingBounds::reserve(uint32_t count)
+    {
+        const size_t padded = (static_cast<size_t>(count) + 7) & ~size_t(7);
+        for (std::vector<float>* array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius })
+        {
+            array->reserve(padded);
+        }
+    }
+
+    void CullingBounds::clear()
+    {
+        for (std::vector<float>* array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius })
+        {
+            array->clear();
+        }
+        m_count = 0;
+    }
+
+    uint32_t CullingBounds::addSphere(const float center[3], float radius)
+    {
+        const float noExtents[3] = {};
+        return add(center, noExtents, radius);
+    }
+
+    uint32_t CullingBounds::addBox(const float center[3], const float extents[3])
+    {
+        return add(center, extents, 0.0f);
+    }
+
+    void CullingBounds::setSphere(uint32_t index, const float center[3], float radius)
+    {
+        const float noExtents[3] = {};
+        set(index, center, noExtents, radius);
+    }
+
+    void CullingBounds::setBox(uint32_t index, const float center[3], const float extents[3])
+    {
+        set(index, center, extents, 0.0f);
+    }
+
+    uint32_t CullingBounds::add(const float center[3], const float extents[3], float radius)
+    {
+        // A new group of 8 starts out as padding, objects then take its lanes one by one
+        if (m_count == m_radius.size())
+        {
+            const size_t padded = m_radius.size() + 8;
+            for (std::vector<float>* array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ })
+            {
+                array->resize(padded, 0.0f);
+            }
+            m_radius.resize(padded, NeverVisibleRadius);
+        }
+
+        const uint32_t index = m_count++;
+        set(index, center, extents, radius);
+        return index;
+    }
+
+    void CullingBounds::set(uint32_t index, const float center[3], const float extents[3], float radius)
+    {
+        if (index >= m_count)
+        {
+            throw std::runtime_error("Culling bounds index out of range");
+        }
+
+        m_centerX[index] = center[0];
+        m_centerY[index] = center[1];
+        m_centerZ[index] = center[2];
+        m_extentX[index] = extents[0];
+        m_extentY[index] = extents[1];
+        m_extentZ[index] = extents[2];
+        m_radius[index] = radius;
+    }
+
+    bool cpuSupportsAvx2()
+    {
+#if RAPHAEL_CULLING_AVX2 && defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return osSavesAvx && (info[1] & (1 << 5)) != 0;
+#elif RAPHAEL_CULLING_AVX2
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+
+    FrustumCuller::FrustumCuller()
+    {
+        m_hasAvx2 = cpuSupportsAvx2();
+        m_useAvx2 = m_hasAvx2;
+    }
+
+    uint32_t FrustumCuller::cull(const Frustum& frustum, const CullingBounds& bounds, uint32_t* outVisibleIndices)
+    {
+        m_stats.testedCount = bounds.getCount();
+        m_stats.visibleCount = cullRange(frustum, bounds, 0, bounds.getPaddedCount(), outVisibleIndices);
+        return m_stats.visibleCount;
+    }
+
+    uint32_t FrustumCuller::cull(JobSystem& jobSystem, const Frustum& frustum, const CullingBounds& bounds, uint32_t* outVisibleIndices)
+    {
+        const uint32_t paddedCount = bounds.getPaddedCount();
+        const uint32_t blockCount = (paddedCount + CullingBlockSize - 1) / CullingBlockSize;
+        if (blockCount <= 1)
+        {
+            return cull(frustum, bounds, outVisibleIndices);
+        }
+
+        // Grows to the largest block count seen, then stays
+        if (m_blockVisibleCounts.size() < blockCount)
+        {
+            m_blockVisibleCounts.resize(blockCount);
+        }
+
+        uint32_t* blockVisibleCounts = m_blockVisibleCounts.data();
+        jobSystem.parallelFor(blockCount, 1, [&](uint32_t firstBlock, uint32_t lastBlock)
+        {
+            for (uint32_t block = firstBlock; block < lastBlock; ++block)
+            {
+                const uint32_t begin = block * CullingBlockSize;
+                const uint32_t end = std::min(begin + CullingBlockSize, paddedCount);
+                blockVisibleCounts[block] = cullRange(frustum, bounds, begin, end, outVisibleIndices + begin);
+            }
+        });
+
+        // Every block starts at or after the compacted end, moving them down in order never overlaps a later one
+        uint32_t visibleCount = 0;
+        for (uint32_t block = 0; block < blockCount; ++block)
+        {
+            const uint32_t begin = block * CullingBlockSize;
+            if (visibleCount != begin)
+            {
+                std::memmove(outVisibleIndices + visibleCount, outVisibleIndices + begin, blockVisibleCounts[block] * sizeof(uint32_t));
+            }
+            visibleCount += blockVisibleCounts[block];
+        }
+
+        m_stats.testedCount = bounds.getCount();
+        m_stats.visibleCount = visibleCount;
+        return visibleCount;
+    }
+
+    uint32_t FrustumCuller::cullRange(const Frustum& frustum, const CullingBounds& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices) const
+    {
+#if RAPHAEL_CULLING_AVX2
+        if (m_useAvx2)
+        {
+            return cullRangeAvx2(frustum, bounds, begin, end, outVisibleIndices);
+        }
+#endif
+        return cullRangeScalar(frustum, bounds, begin, end, outVisibleIndices);
+    }
+} // namespace raphael
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace raphael
+{
+    class JobSystem;
+
+    // Objects one parallel cull job tests, a multiple of the 8-wide SIMD step
+    constexpr uint32_t CullingBlockSize = 4096;
+
+    // Left, right, bottom, top, near and far planes as (a, b, c, d), normals normalized and pointing inside
+    struct Frustum
+    {
+        float planes[6][4] = {};
+    };
+
+    // Planes of a row-vector view-projection matrix (DirectXMath convention, depth in [0, 1]) given as 16 floats
+    // in XMFLOAT4X4 order. Pass world * viewProj instead to get the planes in that object space.
+    Frustum extractFrustum(const float* viewProjection);
+
+    // True when the CPU has AVX2 and the OS saves its registers, the check the SIMD paths run before using it
+    bool cpuSupportsAvx2();
+
+    // Bounding volumes of the objects to cull, in SoA arrays so the culler tests 8 objects per instruction.
+    // A volume is a box (center, half extents) grown by a radius: spheres have zero extents, boxes zero radius.
+    // The arrays are padded to a multiple of 8 with volumes that are never visible.
+    // Backend independent.
+    class CullingBounds
+    {
+    public:
+        CullingBounds() = default;
+        ~CullingBounds() = default;
+
+        CullingBounds(const CullingBounds& rhs) = delete;
+        CullingBounds& operator=(const CullingBounds& rhs) = delete;
+
+        void reserve(uint32_t count);
+        void clear();
+
+        // Return the object index, objects are numbered in the order they are added
+        uint32_t addSphere(const float center[3], float radius);
+        uint32_t addBox(const float center[3], const float extents[3]);
+        void setSphere(uint32_t index, const float center[3], float radius);
+        void setBox(uint32_t index, const float center[3], const float extents[3]);
+
+        uint32_t getCount() const { return m_count; }
+        // Count rounded up to the SIMD width, the size a visible index list passed to FrustumCuller needs
+        uint32_t getPaddedCount() const { return static_cast<uint32_t>(m_radius.size()); }
+
+        const float* getCenterX() const { return m_centerX.data(); }
+        const float* getCenterY() const { return m_centerY.data(); }
+        const float* getCenterZ() const { return m_centerZ.data(); }
+        const float* getExtentX() const { return m_extentX.data(); }
+        const float* getExtentY() const { return m_extentY.data(); }
+        const float* getExtentZ() const { return m_extentZ.data(); }
+        const float* getRadius() const { return m_radius.data(); }
+
+    private:
+        uint32_t add(const float center[3], const float extents[3], float radius);
+        void set(uint32_t index, const float center[3], const float extents[3], float radius);
+
+    private:
+        std::vector<float> m_centerX;
+        std::vector<float> m_centerY;
+        std::vector<float> m_centerZ;
+        std::vector<float> m_extentX;
+        std::vector<float> m_extentY;
+        std::vector<float> m_extentZ;
+        std::vector<float> m_radius;
+        uint32_t m_count = 0;
+    };
+
+    struct FrustumCullerStats
+    {
+        uint32_t testedCount = 0;  // Last cull
+        uint32_t visibleCount = 0;
+    };
+
+    // Tests CullingBounds against a frustum and writes the indices of the visible objects, in ascending order,
+    // to outVisibleIndices, which must hold bounds.getPaddedCount() entries. Returns the visible count.
+    // Uses AVX2 when the CPU supports it, 8 objects per iteration, and a scalar loop with identical results
+    // otherwise. The job system overload culls CullingBlockSize blocks in parallel, each into its own slice of
+    // the output, then compacts the slices in order. Steady-state culls do not allocate.
+    // Backend independent.
+    class FrustumCuller
+    {
+    public:
+        FrustumCuller();
+        ~FrustumCuller() = default;
+
+        FrustumCuller(const FrustumCuller& rhs) = delete;
+        FrustumCuller& operator=(const FrustumCuller& rhs) = delete;
+
+        uint32_t cull(const Frustum& frustum, const CullingBounds& bounds, uint32_t* outVisibleIndices);
+        uint32_t cull(JobSystem& jobSystem, const Frustum& frustum, const CullingBounds& bounds, uint32_t* outVisibleIndices);
+
+        // Falls back to the scalar loop even on AVX2 hardware, to compare the two
+        void setSimdEnabled(bool enabled) { m_useAvx2 = enabled && m_hasAvx2; }
+        bool isUsingSimd() const { return m_useAvx2; }
+        const FrustumCullerStats& getStats() const { return m_stats; }
+
+    private:
+        uint32_t cullRange(const Frustum& frustum, const CullingBounds& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices) const;
+
+    private:
+        bool m_hasAvx2 = false;
+        bool m_useAvx2 = false;
+        std::vector<uint32_t> m_blockVisibleCounts;
+        FrustumCullerStats m_stats;
+    };
+} // namespace raphael
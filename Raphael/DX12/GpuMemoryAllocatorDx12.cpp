@@ -0,0 +1,207 @@
+#include "GpuMemoryAllocatorDx12.h"
+#include "DeviceDx12.h"
+
+namespace raphael
+{
+    static const char* getCategoryName(GpuHeapCategory category)
+    {
+        switch (category)
+        {
+        case GpuHeapCategory::Buffer:
+            return "Buffer";
+        case GpuHeapCategory::Texture:
+            return "Texture";
+        case GpuHeapCategory::RenderTarget:
+            return "RenderTarget";
+        default:
+            return "Unknown";
+        }
+    }
+
+    static D3D12_HEAP_FLAGS getHeapFlags(GpuHeapCategory category)
+    {
+        switch (category)
+        {
+        case GpuHeapCategory::Buffer:
+            return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+        case GpuHeapCategory::Texture:
+            return D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+        case GpuHeapCategory::RenderTarget:
+            return D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        default:
+            return D3D12_HEAP_FLAG_NONE;
+        }
+    }
+
+    GpuMemoryAllocatorDx12::GpuMemoryAllocatorDx12(DeviceDx12* device, UINT64 heapBlockSize)
+        : m_device(device), m_heapBlockSize(heapBlockSize)
+    {
+        // Heaps must be a multiple of the 64KB placement alignment
+        const UINT64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        m_heapBlockSize = (heapBlockSize + alignment - 1) & ~(alignment - 1);
+
+        const D3D12_HEAP_TYPE heapTypes[HeapTypeCount] = { D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_TYPE_UPLOAD };
+        for (D3D12_HEAP_TYPE heapType : heapTypes)
+        {
+            for (uint32_t category = 0; category < static_cast<uint32_t>(GpuHeapCategory::Count); ++category)
+            {
+                HeapPool& pool = m_pools[getPoolIndex(heapType, static_cast<GpuHeapCategory>(category))];
+                pool.heapType = heapType;
+                pool.category = static_cast<GpuHeapCategory>(category);
+            }
+        }
+    }
+
+    uint32_t GpuMemoryAllocatorDx12::getPoolIndex(D3D12_HEAP_TYPE heapType, GpuHeapCategory category)
+    {
+        const uint32_t heapTypeIndex = (heapType == D3D12_HEAP_TYPE_UPLOAD) ? 1 : 0;
+        return heapTypeIndex * static_cast<uint32_t>(GpuHeapCategory::Count) + static_cast<uint32_t>(category);
+    }
+
+    void GpuMemoryAllocatorDx12::createHeapBlock(HeapPool& pool)
+    {
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = m_heapBlockSize;
+        heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(pool.heapType);
+        heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        heapDesc.Flags = getHeapFlags(pool.category);
+
+        HeapBlock block = {};
+        if (FAILED(m_device->getNativeDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&block.heap))))
+        {
+            throw std::runtime_error("Failed to create resource heap");
+        }
+        block.allocator = std::make_unique<TlsfAllocator>(m_heapBlockSize);
+
+        // Reuse a slot released by an emptied block so existing block indices stay valid
+        for (HeapBlock& slot : pool.blocks)
+        {
+            if (slot.heap == nullptr)
+            {
+                slot = std::move(block);
+                return;
+            }
+        }
+        pool.blocks.push_back(std::move(block));
+    }
+
+    bool GpuMemoryAllocatorDx12::allocate(D3D12_HEAP_TYPE heapType, GpuHeapCategory category, const D3D12_RESOURCE_ALLOCATION_INFO& allocationInfo, GpuAllocation* outAllocation)
+    {
+        if (allocationInfo.SizeInBytes > m_heapBlockSize)
+        {
+            return false;
+        }
+
+        const uint32_t poolIndex = getPoolIndex(heapType, category);
+        HeapPool& pool = m_pools[poolIndex];
+
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            for (uint32_t blockIndex = 0; blockIndex < pool.blocks.size(); ++blockIndex)
+            {
+                HeapBlock& block = pool.blocks[blockIndex];
+                if (block.heap == nullptr)
+                {
+                    continue;
+                }
+
+                TlsfAllocator::Allocation allocation = block.allocator->allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+                if (allocation.isValid())
+                {
+                    outAllocation->heap = block.heap.Get();
+                    outAllocation->offset = allocation.offset;
+                    outAllocation->size = allocationInfo.SizeInBytes;
+                    outAllocation->poolIndex = poolIndex;
+                    outAllocation->blockIndex = blockIndex;
+                    outAllocation->allocation = allocation;
+                    return true;
+                }
+            }
+
+            // Every block is full or too fragmented, reserve a new one and retry
+            createHeapBlock(pool);
+        }
+
+        return false;
+    }
+
+    void GpuMemoryAllocatorDx12::free(const GpuAllocation& allocation)
+    {
+        if (!allocation.isValid())
+        {
+            return;
+        }
+
+        HeapPool& pool = m_pools[allocation.poolIndex];
+        HeapBlock& block = pool.blocks[allocation.blockIndex];
+        block.allocator->free(allocation.allocation);
+
+        // Give emptied heaps back to the OS, but keep at least one block per pool warm
+        if (block.allocator->isEmpty())
+        {
+            size_t liveBlocks = 0;
+            for (const HeapBlock& other : pool.blocks)
+            {
+                liveBlocks += (other.heap != nullptr) ? 1 : 0;
+            }
+            if (liveBlocks > 1)
+            {
+                block.heap.Reset();
+                block.allocator.reset();
+            }
+        }
+    }
+
+    GpuMemoryStats GpuMemoryAllocatorDx12::getStats() const
+    {
+        GpuMemoryStats stats = {};
+        for (const HeapPool& pool : m_pools)
+        {
+            for (const HeapBlock& block : pool.blocks)
+            {
+                if (block.heap == nullptr)
+                {
+                    continue;
+                }
+
+                TlsfAllocator::Stats blockStats = block.allocator->getStats();
+                stats.reservedBytes += blockStats.capacity;
+                stats.usedBytes += blockStats.usedSize;
+                stats.largestFreeBlock = std::max(stats.largestFreeBlock, blockStats.largestFreeBlock);
+                stats.heapCount++;
+                stats.allocationCount += blockStats.allocationCount;
+                stats.freeBlockCount += blockStats.freeBlockCount;
+                stats.fragmentation = std::max(stats.fragmentation, blockStats.fragmentation());
+            }
+        }
+        return stats;
+    }
+
+    std::string GpuMemoryAllocatorDx12::buildReport() const
+    {
+        std::ostringstream report;
+        report << "GPU heap allocator: block size " << (m_heapBlockSize >> 20) << " MB\n";
+
+        for (const HeapPool& pool : m_pools)
+        {
+            for (uint32_t blockIndex = 0; blockIndex < pool.blocks.size(); ++blockIndex)
+            {
+                const HeapBlock& block = pool.blocks[blockIndex];
+                if (block.heap == nullptr)
+                {
+                    continue;
+                }
+
+                TlsfAllocator::Stats blockStats = block.allocator->getStats();
+                report << (pool.heapType == D3D12_HEAP_TYPE_UPLOAD ? "Upload " : "Default ")
+                    << getCategoryName(pool.category) << " #" << blockIndex
+                    << ": used " << (blockStats.usedSize >> 10) << " KB / " << (blockStats.capacity >> 10) << " KB"
+                    << ", allocations " << blockStats.allocationCount
+                    << ", free blocks " << blockStats.freeBlockCount
+                    << ", largest free " << (blockStats.largestFreeBlock >> 10) << " KB"
+                    << ", fragmentation " << static_cast<int>(blockStats.fragmentation() * 100.0f) << "%\n";
+            }
+        }
+        return report.str();
+    }
+} // namespace raphael
@@ -0,0 +1,85 @@
+#pragma once
+#include "D3D12CommonHeaders.h"
+#include "TlsfAllocator.h"
+
+namespace raphael
+{
+    class DeviceDx12;
+
+    // Resource heap tier 1 hardware cannot mix these in one heap, so each gets its own pool
+    enum class GpuHeapCategory
+    {
+        Buffer,
+        Texture,
+        RenderTarget, // Render target and depth stencil textures
+        Count
+    };
+
+    // Region of a placed-resource heap owned by one resource
+    struct GpuAllocation
+    {
+        ID3D12Heap* heap = nullptr;
+        UINT64 offset = 0;
+        UINT64 size = 0;
+        uint32_t poolIndex = 0;
+        uint32_t blockIndex = 0;
+        TlsfAllocator::Allocation allocation = {};
+
+        bool isValid() const { return heap != nullptr; }
+    };
+
+    struct GpuMemoryStats
+    {
+        UINT64 reservedBytes = 0;  // Sum of all heap blocks
+        UINT64 usedBytes = 0;      // Bytes handed out to resources
+        UINT64 largestFreeBlock = 0;
+        uint32_t heapCount = 0;
+        uint32_t allocationCount = 0;
+        uint32_t freeBlockCount = 0;
+        float fragmentation = 0.0f; // Worst block, see TlsfAllocator::Stats::fragmentation
+    };
+
+    // Reserves large ID3D12Heaps and sub-allocates placed resources from them with a TLSF allocator,
+    // replacing one committed resource (and one kernel allocation) per buffer or texture.
+    class GpuMemoryAllocatorDx12
+    {
+    public:
+        GpuMemoryAllocatorDx12(DeviceDx12* device, UINT64 heapBlockSize);
+        ~GpuMemoryAllocatorDx12() = default;
+
+        GpuMemoryAllocatorDx12(const GpuMemoryAllocatorDx12& rhs) = delete;
+        GpuMemoryAllocatorDx12& operator=(const GpuMemoryAllocatorDx12& rhs) = delete;
+
+        // Returns false when the resource is larger than a heap block, the caller should then create a committed resource
+        bool allocate(D3D12_HEAP_TYPE heapType, GpuHeapCategory category, const D3D12_RESOURCE_ALLOCATION_INFO& allocationInfo, GpuAllocation* outAllocation);
+        void free(const GpuAllocation& allocation);
+
+        GpuMemoryStats getStats() const;
+        std::string buildReport() const;
+
+    private:
+        struct HeapBlock
+        {
+            ComPtr<ID3D12Heap> heap;
+            std::unique_ptr<TlsfAllocator> allocator;
+        };
+
+        struct HeapPool
+        {
+            D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+            GpuHeapCategory category = GpuHeapCategory::Buffer;
+            std::vector<HeapBlock> blocks;
+        };
+
+        static uint32_t getPoolIndex(D3D12_HEAP_TYPE heapType, GpuHeapCategory category);
+        void createHeapBlock(HeapPool& pool);
+
+    private:
+        static constexpr uint32_t HeapTypeCount = 2; // Default and Upload
+        static constexpr uint32_t PoolCount = HeapTypeCount * static_cast<uint32_t>(GpuHeapCategory::Count);
+
+        DeviceDx12* m_device = nullptr;
+        UINT64 m_heapBlockSize = 0;
+        std::array<HeapPool, PoolCount> m_pools;
+    };
+} // namespace raphael
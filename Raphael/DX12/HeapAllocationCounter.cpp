@@ -0,0 +1,76 @@
+#include "HeapAllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef RAPHAEL_COUNT_HEAP_ALLOCATIONS
+namespace
+{
+    std::atomic<uint64_t> g_allocationCount = 0;
+    std::atomic<uint64_t> g_freeCount = 0;
+    std::atomic<uint64_t> g_allocatedBytes = 0;
+    thread_local uint64_t t_allocationCount = 0;
+
+    void* countedAllocate(size_t size)
+    {
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        t_allocationCount++;
+        return std::malloc(size != 0 ? size : 1);
+    }
+
+    void countedFree(void* pointer)
+    {
+        if (pointer != nullptr)
+        {
+            g_freeCount.fetch_add(1, std::memory_order_relaxed);
+            std::free(pointer);
+        }
+    }
+}
+
+// Replacements of the global allocation functions. Array and nothrow forms forward to these by default.
+// Over-aligned new keeps the library implementation and is not counted.
+void* operator new(size_t size)
+{
+    void* pointer = countedAllocate(size);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    countedFree(pointer);
+}
+#endif
+
+namespace raphael
+{
+    HeapAllocationStats getGlobalHeapAllocationStats()
+    {
+        HeapAllocationStats stats = {};
+#ifdef RAPHAEL_COUNT_HEAP_ALLOCATIONS
+        stats.allocationCount = g_allocationCount.load(std::memory_order_relaxed);
+        stats.freeCount = g_freeCount.load(std::memory_order_relaxed);
+        stats.allocatedBytes = g_allocatedBytes.load(std::memory_order_relaxed);
+#endif
+        return stats;
+    }
+
+    uint64_t getThreadHeapAllocationCount()
+    {
+#ifdef RAPHAEL_COUNT_HEAP_ALLOCATIONS
+        return t_allocationCount;
+#else
+        return 0;
+#endif
+    }
+} // namespace raphael
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+namespace raphael
+{
+    struct HeapAllocationStats
+    {
+        uint64_t allocationCount = 0;
+        uint64_t freeCount = 0;
+        uint64_t allocatedBytes = 0;
+    };
+
+    // Counts every global operator new / delete made by this module when built with
+    // RAPHAEL_COUNT_HEAP_ALLOCATIONS, which replaces the global allocation functions. Without it
+    // nothing is replaced and every counter stays at zero. Totals are process wide, the thread
+    // counter only sees the calling thread.
+    constexpr bool isHeapAllocationCountingEnabled()
+    {
+#ifdef RAPHAEL_COUNT_HEAP_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    HeapAllocationStats getGlobalHeapAllocationStats();
+    uint64_t getThreadHeapAllocationCount();
+
+    enum class HeapAllocationSource
+    {
+        Process,      // Every thread, for work spread over job system workers
+        CurrentThread // Only the constructing thread, ignores what other threads allocate meanwhile
+    };
+
+    // Heap allocations made between construction and getAllocationCount()
+    class HeapAllocationScope
+    {
+    public:
+        explicit HeapAllocationScope(HeapAllocationSource source = HeapAllocationSource::Process)
+            : m_source(source), m_startCount(readCount(source)) {}
+
+        uint64_t getAllocationCount() const { return readCount(m_source) - m_startCount; }
+
+    private:
+        static uint64_t readCount(HeapAllocationSource source)
+        {
+            return source == HeapAllocationSource::Process ? getGlobalHeapAllocationStats().allocationCount : getThreadHeapAllocationCount();
+        }
+
+    private:
+        HeapAllocationSource m_source = HeapAllocationSource::Process;
+        uint64_t m_startCount = 0;
+    };
+} // namespace raphael
@@ -0,0 +1,157 @@
+#include "InstancePacking.h"
+#include "JobSystem.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RAPHAEL_INSTANCE_PACKING_SSE 1
+#endif
+
+namespace raphael
+{
+    namespace
+    {
+#if RAPHAEL_INSTANCE_PACKING_SSE
+        template<bool Stream>
+        void storeRow(float* destination, __m128 row)
+        {
+            if constexpr (Stream)
+            {
+                _mm_stream_ps(destination, row);
+            }
+            else
+            {
+                _mm_storeu_ps(destination, row);
+            }
+        }
+
+        // Without indices instance i reads position i
+        template<bool Stream>
+        void packTranslations(const float* positions, const uint32_t* indices, uint32_t count, float scale, InstanceTransform* outTransforms)
+        {
+            // Each row is its scale diagonal with the position component broadcast into w
+            const __m128 row0 = _mm_setr_ps(scale, 0.0f, 0.0f, 0.0f);
+            const __m128 row1 = _mm_setr_ps(0.0f, scale, 0.0f, 0.0f);
+            const __m128 row2 = _mm_setr_ps(0.0f, 0.0f, scale, 0.0f);
+            const __m128 wMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t source = indices != nullptr ? indices[i] : i;
+                const __m128 position = _mm_loadu_ps(positions + static_cast<size_t>(source) * 4);
+                float* destination = &outTransforms[i].rows[0][0];
+                storeRow<Stream>(destination + 0, _mm_or_ps(row0, _mm_and_ps(wMask, _mm_shuffle_ps(position, position, _MM_SHUFFLE(0, 0, 0, 0)))));
+                storeRow<Stream>(destination + 4, _mm_or_ps(row1, _mm_and_ps(wMask, _mm_shuffle_ps(position, position, _MM_SHUFFLE(1, 1, 1, 1)))));
+                storeRow<Stream>(destination + 8, _mm_or_ps(row2, _mm_and_ps(wMask, _mm_shuffle_ps(position, position, _MM_SHUFFLE(2, 2, 2, 2)))));
+            }
+        }
+
+        template<bool Stream>
+        void packMatrices(const float* worldMatrices, uint32_t count, InstanceTransform* outTransforms)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const float* matrix = worldMatrices + i * 16;
+                __m128 r0 = _mm_loadu_ps(matrix + 0);
+                __m128 r1 = _mm_loadu_ps(matrix + 4);
+                __m128 r2 = _mm_loadu_ps(matrix + 8);
+                __m128 r3 = _mm_loadu_ps(matrix + 12);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                float* destination = &outTransforms[i].rows[0][0];
+                storeRow<Stream>(destination + 0, r0);
+                storeRow<Stream>(destination + 4, r1);
+                storeRow<Stream>(destination + 8, r2);
+            }
+        }
+
+        bool isStreamable(const InstanceTransform* outTransforms)
+        {
+            return (reinterpret_cast<uintptr_t>(outTransforms) & 15) == 0;
+        }
+#endif
+    } // namespace
+
+    void packInstanceTranslations(const float* positions, uint32_t count, float scale, InstanceTransform* outTransforms)
+    {
+        packInstanceTranslations(positions, nullptr, count, scale, outTransforms);
+    }
+
+    void packInstanceTranslations(JobSystem& jobSystem, const float* positions, uint32_t count, float scale, InstanceTransform* outTransforms)
+    {
+        packInstanceTranslations(jobSystem, positions, nullptr, count, scale, outTransforms);
+    }
+
+    void packInstanceTranslations(const float* positions, const uint32_t* indices, uint32_t count, float scale, InstanceTransform* outTransforms)
+    {
+#if RAPHAEL_INSTANCE_PACKING_SSE
+        if (isStreamable(outTransforms))
+        {
+            packTranslations<true>(positions, indices, count, scale, outTransforms);
+            // Streaming stores are weakly ordered, make them visible before the list is submitted
+            _mm_sfence();
+        }
+        else
+        {
+            packTranslations<false>(positions, indices, count, scale, outTransforms);
+        }
+#else
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float* position = positions + static_cast<size_t>(indices != nullptr ? indices[i] : i) * 4;
+            outTransforms[i] = { { { scale, 0.0f, 0.0f, position[0] },
+                                   { 0.0f, scale, 0.0f, position[1] },
+                                   { 0.0f, 0.0f, scale, position[2] } } };
+        }
+#endif
+    }
+
+    void packInstanceTranslations(JobSystem& jobSystem, const float* positions, const uint32_t* indices, uint32_t count, float scale, InstanceTransform* outTransforms)
+    {
+        jobSystem.parallelFor(count, InstancePackingGrain, [=](uint32_t begin, uint32_t end)
+        {
+            if (indices != nullptr)
+            {
+                packInstanceTranslations(positions, indices + begin, end - begin, scale, outTransforms + begin);
+            }
+            else
+            {
+                packInstanceTranslations(positions + static_cast<size_t>(begin) * 4, nullptr, end - begin, scale, outTransforms + begin);
+            }
+        });
+    }
+
+    void packInstanceMatrices(const float* worldMatrices, uint32_t count, InstanceTransform* outTransforms)
+    {
+#if RAPHAEL_INSTANCE_PACKING_SSE
+        if (isStreamable(outTransforms))
+        {
+            packMatrices<true>(worldMatrices, count, outTransforms);
+            _mm_sfence();
+        }
+        else
+        {
+            packMatrices<false>(worldMatrices, count, outTransforms);
+        }
+#else
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float* matrix = worldMatrices + i * 16;
+            for (uint32_t row = 0; row < 3; ++row)
+            {
+                for (uint32_t column = 0; column < 4; ++column)
+                {
+                    outTransforms[i].rows[row][column] = matrix[column * 4 + row];
+                }
+            }
+        }
+#endif
+    }
+
+    void packInstanceMatrices(JobSystem& jobSystem, const float* worldMatrices, uint32_t count, InstanceTransform* outTransforms)
+    {
+        jobSystem.parallelFor(count, InstancePackingGrain, [=](uint32_t begin, uint32_t end)
+        {
+            packInstanceMatrices(worldMatrices + begin * 16, end - begin, outTransforms + begin);
+        });
+    }
+} // namespace raphael
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+namespace raphael
+{
+    class JobSystem;
+
+    // Per-instance world transform as the instanced shaders read it from a structured buffer: the first three
+    // rows of the transposed world matrix, so worldPos = float3(dot(rows[0], p), dot(rows[1], p), dot(rows[2], p))
+    // with p = float4(localPos, 1). 48 bytes against 256 for a constant buffer slot per object.
+    struct InstanceTransform
+    {
+        float rows[3][4] = {};
+    };
+    static_assert(sizeof(InstanceTransform) == 48, "Instance transforms are packed as three float4 rows");
+
+    // Instances packed by one job, 192 KB of output
+    constexpr uint32_t InstancePackingGrain = 4096;
+
+    // Writes the transform of a uniformly scaled, translated instance for each position. positions holds
+    // x, y, z, w per instance (an XMVECTOR array), w is ignored.
+    // Uses SSE where available. Output that is 16-byte aligned, such as a mapped upload heap, is written with
+    // streaming stores that bypass the cache, the GPU is the only reader.
+    void packInstanceTranslations(const float* positions, uint32_t count, float scale, InstanceTransform* outTransforms);
+    // Same, split over the job system in InstancePackingGrain pieces
+    void packInstanceTranslations(JobSystem& jobSystem, const float* positions, uint32_t count, float scale, InstanceTransform* outTransforms);
+    // Gathering variants, instance i is placed at positions[indices[i]], for packing only what survived culling
+    void packInstanceTranslations(const float* positions, const uint32_t* indices, uint32_t count, float scale, InstanceTransform* outTransforms);
+    void packInstanceTranslations(JobSystem& jobSystem, const float* positions, const uint32_t* indices, uint32_t count, float scale, InstanceTransform* outTransforms);
+
+    // Converts row-vector 4x4 world matrices (an XMFLOAT4X4 array, translation in the last row) to instance transforms
+    void packInstanceMatrices(const float* worldMatrices, uint32_t count, InstanceTransform* outTransforms);
+    void packInstanceMatrices(JobSystem& jobSystem, const float* worldMatrices, uint32_t count, InstanceTransform* outTransforms);
+} // namespace raphael
@@ -0,0 +1,312 @@
+#include "JobSystem.h"
+#include <iterator>
+#include <stdexcept>
+
+namespace raphael
+{
+    namespace
+    {
+        thread_local const JobSystem* t_jobSystem = nullptr;
+        thread_local uint32_t t_threadIndex = 0;
+
+        // Failed searches before an idle worker blocks
+        constexpr uint32_t IdleSpinCount = 64;
+
+        uint32_t nextRandom(uint32_t& state)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+    } // namespace
+
+    JobSystem::ThreadState::ThreadState(uint32_t capacity)
+        : deque(capacity), jobs(std::make_unique<Job[]>(capacity))
+    {
+    }
+
+    JobSystem::JobSystem(uint32_t workerCount, uint32_t jobsPerThread)
+        : m_jobsPerThread(jobsPerThread)
+    {
+        if (jobsPerThread == 0 || (jobsPerThread & (jobsPerThread - 1)) != 0)
+        {
+            throw std::runtime_error("Jobs per thread must be a power of two");
+        }
+
+        if (workerCount == 0)
+        {
+            workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+
+        m_threads.reserve(workerCount + 1);
+        for (uint32_t i = 0; i <= workerCount; ++i)
+        {
+            m_threads.push_back(std::make_unique<ThreadState>(jobsPerThread));
+            m_threads.back()->randomState = 0x9E3779B9u * (i + 1);
+        }
+
+        t_jobSystem = this;
+        t_threadIndex = 0;
+
+        m_workers.reserve(workerCount);
+        for (uint32_t i = 1; i <= workerCount; ++i)
+        {
+            m_workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stop.store(true);
+        }
+        m_wakeCondition.notify_all();
+
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+
+        if (t_jobSystem == this)
+        {
+            t_jobSystem = nullptr;
+        }
+    }
+
+    void JobSystem::wait(const JobCounter& counter)
+    {
+        ThreadState& thread = getCurrentThread();
+        while (!counter.isDone())
+        {
+            if (Job* job = findJob(thread))
+            {
+                execute(job, thread);
+            }
+            else
+            {
+                // The jobs left are running on other threads
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    uint32_t JobSystem::getCurrentThreadIndex() const
+    {
+        getCurrentThread();
+        return t_threadIndex;
+    }
+
+    JobSystemStats JobSystem::getStats() const
+    {
+        JobSystemStats stats = {};
+        for (const auto& thread : m_threads)
+        {
+            stats.executedCount += thread->executedCount.load(std::memory_order_relaxed);
+            stats.stolenCount += thread->stolenCount.load(std::memory_order_relaxed);
+            stats.inlineCount += thread->inlineCount.load(std::memory_order_relaxed);
+            stats.sleepCount += thread->sleepCount.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    JobSystem::ThreadState& JobSystem::getCurrentThread() const
+    {
+        if (t_jobSystem != this)
+        {
+            throw std::runtime_error("Job system used from a thread it does not own");
+        }
+        return *m_threads[t_threadIndex];
+    }
+
+    Job* JobSystem::allocateJob()
+    {
+        ThreadState& thread = getCurrentThread();
+        Job& job = thread.jobs[thread.nextJob++ & (m_jobsPerThread - 1)];
+
+        // A full lap around the ring caught up with a job that has not started yet, help until it has
+        while (job.inUse.load(std::memory_order_acquire))
+        {
+            if (Job* other = findJob(thread))
+            {
+                execute(other, thread);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        job.inUse.store(true, std::memory_order_relaxed);
+        return &job;
+    }
+
+    void JobSystem::push(Job* job)
+    {
+        ThreadState& thread = getCurrentThread();
+        if (!thread.deque.push(job))
+        {
+            thread.inlineCount.fetch_add(1, std::memory_order_relaxed);
+            execute(job, thread);
+            return;
+        }
+
+        // Pairs with the sleeping count increment in workerLoop: either this sees the sleeper or the
+        // sleeper sees the job, a wake-up cannot be lost in between
+        m_queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_wakeCondition.notify_one();
+        }
+    }
+
+    bool JobSystem::park(const JobCounter& dependency, Job* job)
+    {
+        // finish() makes the last decrement under the same lock, so the counter cannot reach zero in between
+        std::lock_guard<std::mutex> lock(m_parkedMutex);
+        if (dependency.m_value.load(std::memory_order_acquire) == 0)
+        {
+            return false;
+        }
+
+        m_parkedJobs.push_back({ &dependency, job });
+        return true;
+    }
+
+    Job* JobSystem::findJob(ThreadState& thread)
+    {
+        Job* job = thread.deque.pop();
+        if (job == nullptr && m_threads.size() > 1)
+        {
+            // Start at a random victim so thieves do not all line up on the same deque
+            const uint32_t threadCount = static_cast<uint32_t>(m_threads.size());
+            const uint32_t first = nextRandom(thread.randomState) % threadCount;
+            for (uint32_t i = 0; i < threadCount && job == nullptr; ++i)
+            {
+                ThreadState& victim = *m_threads[(first + i) % threadCount];
+                if (&victim != &thread)
+                {
+                    job = victim.deque.steal();
+                }
+            }
+            if (job != nullptr)
+            {
+                thread.stolenCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (job != nullptr)
+        {
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    void JobSystem::execute(Job* job, ThreadState& thread)
+    {
+        // Read before running, the slot can be reused as soon as the job starts
+        JobCounter* counter = job->counter;
+        job->function(*job);
+        thread.executedCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (counter != nullptr)
+        {
+            finish(counter);
+        }
+    }
+
+    void JobSystem::finish(JobCounter* counter)
+    {
+        // Decrements that leave jobs behind need no lock
+        uint32_t value = counter->m_value.load(std::memory_order_relaxed);
+        while (value > 1)
+        {
+            if (counter->m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+
+        // The last decrement and the scan for its dependents share the lock park() checks counters under. A waiter
+        // may destroy or reuse the counter as soon as it reaches zero, but nothing can park on that address again
+        // until the scan is over, so every job matched by address depends on this counter.
+        // Dependents are launched outside the lock, in batches so a counter with many needs no allocation. The ones
+        // past the first batch are retagged with the batch array, an address no counter can take while this runs.
+        Job* ready[64];
+        const void* dependency = counter;
+        uint32_t readyCount = 0;
+        do
+        {
+            readyCount = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_parkedMutex);
+                if (dependency == counter && counter->m_value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                {
+                    return;
+                }
+
+                for (size_t i = 0; i < m_parkedJobs.size();)
+                {
+                    ParkedJob& parked = m_parkedJobs[i];
+                    if (parked.dependency != dependency)
+                    {
+                        ++i;
+                    }
+                    else if (readyCount == std::size(ready))
+                    {
+                        parked.dependency = ready;
+                        ++i;
+                    }
+                    else
+                    {
+                        ready[readyCount++] = parked.job;
+                        parked = m_parkedJobs.back();
+                        m_parkedJobs.pop_back();
+                    }
+                }
+            }
+
+            for (uint32_t i = 0; i < readyCount; ++i)
+            {
+                push(ready[i]);
+            }
+            dependency = ready;
+        } while (readyCount == std::size(ready));
+    }
+
+    void JobSystem::workerLoop(uint32_t threadIndex)
+    {
+        t_jobSystem = this;
+        t_threadIndex = threadIndex;
+        ThreadState& thread = *m_threads[threadIndex];
+
+        uint32_t idleCount = 0;
+        while (!m_stop.load(std::memory_order_relaxed))
+        {
+            if (Job* job = findJob(thread))
+            {
+                execute(job, thread);
+                idleCount = 0;
+                continue;
+            }
+
+            if (++idleCount < IdleSpinCount)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            thread.sleepCount.fetch_add(1, std::memory_order_relaxed);
+            m_wakeCondition.wait(lock, [this]
+            {
+                return m_stop.load(std::memory_order_relaxed) || m_queuedJobs.load(std::memory_order_seq_cst) > 0;
+            });
+            m_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+            idleCount = 0;
+        }
+    }
+} // namespace raphael
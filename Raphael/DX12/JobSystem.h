@@ -0,0 +1,216 @@
+#pragma once
+#include "WorkStealingDeque.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace raphael
+{
+    class JobSystem;
+
+    // Bytes of lambda capture a job stores inline. Capture by reference or pointer to stay under it.
+    constexpr size_t JobPayloadSize = 48;
+
+    // Unit of work owned by the job system. Jobs live in per-thread rings, creating one never allocates.
+    struct Job
+    {
+        void (*function)(Job& job) = nullptr; // Releases the slot and runs the payload
+        class JobCounter* counter = nullptr;  // Decremented once the job has run
+        std::atomic<bool> inUse{ false };     // Slot is taken until the job starts running
+        alignas(std::max_align_t) unsigned char payload[JobPayloadSize] = {};
+    };
+
+    // Number of unfinished jobs attached to it. wait() on a counter runs other jobs until it drops to zero,
+    // runAfter() starts a job at that moment. A counter can be reused once it is back at zero, and one
+    // used as a dependency must outlive the jobs that depend on it.
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter& rhs) = delete;
+        JobCounter& operator=(const JobCounter& rhs) = delete;
+
+        bool isDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+        uint32_t getValue() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        friend class JobSystem;
+        std::atomic<uint32_t> m_value{ 0 };
+    };
+
+    struct JobSystemStats
+    {
+        uint64_t executedCount = 0;
+        uint64_t stolenCount = 0; // Jobs a thread took from another thread's deque
+        uint64_t inlineCount = 0; // Jobs run on submission because the submitting thread's deque was full
+        uint64_t sleepCount = 0;  // Times a worker ran out of work and blocked
+    };
+
+    // Work-stealing job scheduler shared by the engine.
+    // Every thread (the creating thread is index 0, workers follow) owns a Chase-Lev deque: it pushes and
+    // pops its own jobs LIFO and idle threads steal the oldest jobs FIFO from the others. Waiting is never
+    // passive, wait() keeps running jobs until its counter is done, so nested fork-join is deadlock free.
+    // Idle workers spin briefly and then sleep until work is pushed.
+    // Jobs may only be created from the thread that constructed the system or from inside jobs.
+    // Backend independent.
+    class JobSystem
+    {
+    public:
+        // workerCount 0 picks one worker per hardware thread besides the caller.
+        // jobsPerThread bounds the jobs a single thread can have pending at once, must be a power of two.
+        explicit JobSystem(uint32_t workerCount = 0, uint32_t jobsPerThread = 4096);
+        ~JobSystem();
+
+        JobSystem(const JobSystem& rhs) = delete;
+        JobSystem& operator=(const JobSystem& rhs) = delete;
+
+        template<typename Function>
+        void run(Function&& function, JobCounter* counter = nullptr)
+        {
+            Job* job = createJob(std::forward<Function>(function), counter);
+            push(job);
+        }
+
+        // Starts the job once dependency reaches zero, right away if it already has
+        template<typename Function>
+        void runAfter(const JobCounter& dependency, Function&& function, JobCounter* counter = nullptr)
+        {
+            Job* job = createJob(std::forward<Function>(function), counter);
+            if (!park(dependency, job))
+            {
+                push(job);
+            }
+        }
+
+        // Runs other jobs on this thread until counter is done
+        void wait(const JobCounter& counter);
+
+        // Calls function(begin, end) over sub-ranges covering [0, count) in parallel and returns when all are done.
+        // The grain adapts to the range: about eight pieces per thread, never fewer than minGrain items each.
+        // Ranges are split in halves, so a thief always takes the largest piece left.
+        template<typename Function>
+        void parallelFor(uint32_t count, uint32_t minGrain, Function&& function)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            const uint32_t grain = std::max({ minGrain, 1u, count / (getThreadCount() * 8) });
+            if (count <= grain)
+            {
+                function(0u, count);
+                return;
+            }
+
+            JobCounter counter;
+            splitRange(0, count, grain, function, counter);
+            wait(counter);
+        }
+
+        uint32_t getThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+        uint32_t getWorkerCount() const { return getThreadCount() - 1; }
+        // 0 for the creating thread, 1..getWorkerCount() for workers. Use it to index per-thread scratch state.
+        uint32_t getCurrentThreadIndex() const;
+        JobSystemStats getStats() const;
+
+    private:
+        struct alignas(64) ThreadState
+        {
+            explicit ThreadState(uint32_t capacity);
+
+            WorkStealingDeque<Job*> deque;
+            std::unique_ptr<Job[]> jobs;
+            uint32_t nextJob = 0;
+            uint32_t randomState = 0;
+            std::atomic<uint64_t> executedCount{ 0 };
+            std::atomic<uint64_t> stolenCount{ 0 };
+            std::atomic<uint64_t> inlineCount{ 0 };
+            std::atomic<uint64_t> sleepCount{ 0 };
+        };
+
+        struct ParkedJob
+        {
+            const void* dependency = nullptr; // The counter, or a finish() call's batch once retagged
+            Job* job = nullptr;
+        };
+
+        template<typename Function>
+        Job* createJob(Function&& function, JobCounter* counter)
+        {
+            using Payload = std::decay_t<Function>;
+            static_assert(sizeof(Payload) <= JobPayloadSize, "Job capture too large, capture by reference or pointer");
+            static_assert(alignof(Payload) <= alignof(std::max_align_t), "Job capture over-aligned");
+
+            Job* job = allocateJob();
+            new (job->payload) Payload(std::forward<Function>(function));
+            job->function = [](Job& self)
+            {
+                // Move the capture out and free the slot before running, so a job that waits on nested work
+                // can never end up waiting for its own slot when the ring wraps around
+                Payload* stored = std::launder(reinterpret_cast<Payload*>(self.payload));
+                Payload payload(std::move(*stored));
+                stored->~Payload();
+                self.inUse.store(false, std::memory_order_release);
+                payload();
+            };
+            job->counter = counter;
+            if (counter != nullptr)
+            {
+                counter->m_value.fetch_add(1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        template<typename Function>
+        void splitRange(uint32_t begin, uint32_t end, uint32_t grain, Function& function, JobCounter& counter)
+        {
+            // Peel the upper half off as a job until the piece left is small enough to run here
+            while (end - begin > grain)
+            {
+                const uint32_t middle = begin + (end - begin) / 2;
+                run([this, middle, end, grain, &function, &counter]
+                {
+                    splitRange(middle, end, grain, function, counter);
+                }, &counter);
+                end = middle;
+            }
+            function(begin, end);
+        }
+
+        ThreadState& getCurrentThread() const;
+        Job* allocateJob();
+        void push(Job* job);
+        // Returns false when the dependency is already done and the caller should push the job itself
+        bool park(const JobCounter& dependency, Job* job);
+        Job* findJob(ThreadState& thread);
+        void execute(Job* job, ThreadState& thread);
+        void finish(JobCounter* counter);
+        void workerLoop(uint32_t threadIndex);
+
+    private:
+        uint32_t m_jobsPerThread = 0;
+        std::vector<std::unique_ptr<ThreadState>> m_threads;
+        std::vector<std::thread> m_workers;
+
+        // Work available to steal, lets sleeping workers know when to wake up
+        std::atomic<int64_t> m_queuedJobs{ 0 };
+        std::atomic<uint32_t> m_sleepingWorkers{ 0 };
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeCondition;
+        std::atomic<bool> m_stop{ false };
+
+        // Jobs waiting on a counter. Kept here rather than in the counter, so finishing the last job of a
+        // counter never touches it again after the waiting thread may have seen zero and destroyed it.
+        std::mutex m_parkedMutex;
+        std::vector<ParkedJob> m_parkedJobs;
+    };
+} // namespace raphael
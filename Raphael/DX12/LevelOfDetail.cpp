@@ -0,0 +1,442 @@
+#include "LevelOfDetail.h"
+#include "JobSystem.h"
+#include "FrustumCulling.h"
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+// MSVC accepts AVX2 intrinsics in any function, the path only runs after the CPU check
+#define RAPHAEL_TARGET_AVX2
+#else
+#define RAPHAEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#define RAPHAEL_LOD_AVX2 1
+#endif
+
+namespace raphael
+{
+    namespace
+    {
+        // Level of an instance that has not been through a select yet
+        constexpr uint8_t NewInstanceLevel = 0xFF;
+        // Distances are clamped to this, so a camera inside the bounds asks for full detail instead of dividing by zero
+        constexpr float MinLodDistance = 1e-4f;
+
+        struct CellKey
+        {
+            int32_t x, y, z;
+
+            bool operator==(const CellKey& rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
+        };
+
+        struct CellKeyHash
+        {
+            size_t operator()(const CellKey& key) const
+            {
+                return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(key.x)) * 0x9E3779B97F4A7C15ull)
+                    ^ (static_cast<uint64_t>(static_cast<uint32_t>(key.y)) * 0xC2B2AE3D27D4EB4Full)
+                    ^ (static_cast<uint64_t>(static_cast<uint32_t>(key.z)) * 0x165667B19E3779F9ull));
+            }
+        };
+
+#if RAPHAEL_LOD_AVX2
+        RAPHAEL_TARGET_AVX2
+        void store8Levels(uint8_t* destination, __m256i levels)
+        {
+            const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(levels), _mm256_extracti128_si256(levels, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(words, words));
+        }
+
+        // Selects [begin, end), a multiple of 8 long. Mirrors the scalar loop in LodSelector::selectRange.
+        RAPHAEL_TARGET_AVX2
+        void selectRangeAvx2(const float* eye, float errorPerDistance, float coarsenErrorPerDistance, float fadeStep, uint32_t levelCount,
+            const float* tableErrors, const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+            const int32_t* tableOffset, uint8_t* levels, uint8_t* previousLevels, float* fades, uint32_t begin, uint32_t end,
+            LodSelectorStats& stats)
+        {
+            const __m256 eyeX = _mm256_set1_ps(eye[0]);
+            const __m256 eyeY = _mm256_set1_ps(eye[1]);
+            const __m256 eyeZ = _mm256_set1_ps(eye[2]);
+            const __m256 minDistance = _mm256_set1_ps(MinLodDistance);
+            const __m256 maxErrorScale = _mm256_set1_ps(errorPerDistance);
+            const __m256 coarsenErrorScale = _mm256_set1_ps(coarsenErrorPerDistance);
+            const __m256 step = _mm256_set1_ps(fadeStep);
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256i newInstance = _mm256_set1_epi32(NewInstanceLevel);
+
+            for (uint32_t i = begin; i < end; i += 8)
+            {
+                const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(centerX + i), eyeX);
+                const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(centerY + i), eyeY);
+                const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(centerZ + i), eyeZ);
+                const __m256 lengthSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+                const __m256 distance = _mm256_max_ps(_mm256_sub_ps(_mm256_sqrt_ps(lengthSq), _mm256_loadu_ps(radius + i)), minDistance);
+                const __m256 maxError = _mm256_mul_ps(distance, maxErrorScale);
+                const __m256 coarsenError = _mm256_mul_ps(distance, coarsenErrorScale);
+
+                // Errors never decrease, so the coarsest level that fits is the number of coarser levels that do
+                const __m256i offset = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tableOffset + i));
+                __m256i desired = _mm256_setzero_si256();
+                __m256i coarse = _mm256_setzero_si256();
+                for (uint32_t level = 1; level < levelCount; ++level)
+                {
+                    const __m256 error = _mm256_i32gather_ps(tableErrors, _mm256_add_epi32(offset, _mm256_set1_epi32(static_cast<int>(level))), 4);
+                    desired = _mm256_sub_epi32(desired, _mm256_castps_si256(_mm256_cmp_ps(error, maxError, _CMP_LE_OQ)));
+                    coarse = _mm256_sub_epi32(coarse, _mm256_castps_si256(_mm256_cmp_ps(error, coarsenError, _CMP_LE_OQ)));
+                }
+
+                const __m256i current = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(levels + i)));
+                const __m256i fresh = _mm256_cmpeq_epi32(current, newInstance);
+                const __m256i kept = _mm256_andnot_si256(fresh, current);
+                const __m256 keptError = _mm256_i32gather_ps(tableErrors, _mm256_add_epi32(offset, kept), 4);
+                const __m256i refine = _mm256_castps_si256(_mm256_cmp_ps(keptError, maxError, _CMP_GT_OQ));
+                const __m256i coarsen = _mm256_cmpgt_epi32(coarse, kept);
+                __m256i level = _mm256_blendv_epi8(kept, coarse, coarsen);
+                level = _mm256_blendv_epi8(level, desired, _mm256_or_si256(refine, fresh));
+
+                const __m256i previous = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(previousLevels + i)));
+                const __m256 fade = _mm256_loadu_ps(fades + i);
+                const __m256i switched = _mm256_andnot_si256(_mm256_or_si256(fresh, _mm256_cmpeq_epi32(level, current)), _mm256_set1_epi32(-1));
+                const __m256i reversing = _mm256_and_si256(switched, _mm256_cmpeq_epi32(level, previous));
+                __m256 base = _mm256_blendv_ps(zero, _mm256_sub_ps(one, fade), _mm256_castsi256_ps(reversing));
+                base = _mm256_blendv_ps(fade, base, _mm256_castsi256_ps(switched));
+                __m256 newFade = _mm256_min_ps(_mm256_add_ps(base, step), one);
+                newFade = _mm256_blendv_ps(newFade, one, _mm256_castsi256_ps(fresh));
+                const __m256i faded = _mm256_castps_si256(_mm256_cmp_ps(newFade, one, _CMP_GE_OQ));
+                __m256i newPrevious = _mm256_blendv_epi8(previous, current, switched);
+                newPrevious = _mm256_blendv_epi8(newPrevious, level, faded);
+
+                store8Levels(levels + i, level);
+                store8Levels(previousLevels + i, newPrevious);
+                _mm256_storeu_ps(fades + i, newFade);
+                stats.switchCount += std::popcount(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(switched))));
+                stats.fadingCount += std::popcount(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(newFade, one, _CMP_LT_OQ))));
+            }
+        }
+#endif
+    } // namespace
+
+    struct LodSelector::SelectionParameters
+    {
+        float eye[3];
+        float errorPerDistance;        // pixelError / projectionScale: the error that fits at distance 1
+        float coarsenErrorPerDistance; // The same with the hysteresis margin taken off
+        float fadeStep;
+        uint32_t levelCount;
+    };
+
+    LodView makeLodView(const float eye[3], const float* projection, float viewportHeight)
+    {
+        // _22 is cot(fovY / 2): an object of height h at distance d covers h * _22 / d of the half-height in NDC
+        LodView view;
+        view.eye[0] = eye[0];
+        view.eye[1] = eye[1];
+        view.eye[2] = eye[2];
+        view.projectionScale = projection[5] * viewportHeight * 0.5f;
+        return view;
+    }
+
+    LodSelector::LodSelector()
+    {
+        m_hasAvx2 = cpuSupportsAvx2();
+        m_useAvx2 = m_hasAvx2;
+    }
+
+    uint32_t LodSelector::addTable(const LodTable& table)
+    {
+        if (table.levelCount == 0 || table.levelCount > MaxLodLevels)
+        {
+            throw std::runtime_error("LOD table level count out of range");
+        }
+        for (uint32_t level = 1; level < table.levelCount; ++level)
+        {
+            if (table.geometricError[level] < table.geometricError[level - 1])
+            {
+                throw std::runtime_error("LOD table errors must not decrease");
+            }
+        }
+
+        const uint32_t tableIndex = static_cast<uint32_t>(m_tableErrors.size() / MaxLodLevels);
+        for (uint32_t level = 0; level < MaxLodLevels; ++level)
+        {
+            m_tableErrors.push_back(level < table.levelCount ? table.geometricError[level] : INFINITY);
+        }
+        m_maxLevelCount = std::max(m_maxLevelCount, table.levelCount);
+        return tableIndex;
+    }
+
+    void LodSelector::reserve(uint32_t instanceCount)
+    {
+        m_centerX.reserve(instanceCount);
+        m_centerY.reserve(instanceCount);
+        m_centerZ.reserve(instanceCount);
+        m_radius.reserve(instanceCount);
+        m_tableOffset.reserve(instanceCount);
+        m_level.reserve(instanceCount);
+        m_previousLevel.reserve(instanceCount);
+        m_fade.reserve(instanceCount);
+    }
+
+    void LodSelector::clear()
+    {
+        m_centerX.clear();
+        m_centerY.clear();
+        m_centerZ.clear();
+        m_radius.clear();
+        m_tableOffset.clear();
+        m_level.clear();
+        m_previousLevel.clear();
+        m_fade.clear();
+        m_stats = {};
+    }
+
+    uint32_t LodSelector::addInstance(uint32_t tableIndex, const float center[3], float radius)
+    {
+        if (tableIndex >= m_tableErrors.size() / MaxLodLevels)
+        {
+            throw std::runtime_error("LOD table index out of range");
+        }
+
+        m_centerX.push_back(center[0]);
+        m_centerY.push_back(center[1]);
+        m_centerZ.push_back(center[2]);
+        m_radius.push_back(radius);
+        m_tableOffset.push_back(static_cast<int32_t>(tableIndex * MaxLodLevels));
+        m_level.push_back(NewInstanceLevel);
+        m_previousLevel.push_back(NewInstanceLevel);
+        m_fade.push_back(1.0f);
+        return static_cast<uint32_t>(m_radius.size()) - 1;
+    }
+
+    void LodSelector::setInstance(uint32_t index, const float center[3], float radius)
+    {
+        if (index >= m_radius.size())
+        {
+            throw std::runtime_error("LOD instance index out of range");
+        }
+
+        m_centerX[index] = center[0];
+        m_centerY[index] = center[1];
+        m_centerZ[index] = center[2];
+        m_radius[index] = radius;
+    }
+
+    void LodSelector::select(const LodView& view, float deltaSeconds)
+    {
+        selectAll(nullptr, view, deltaSeconds);
+    }
+
+    void LodSelector::select(JobSystem& jobSystem, const LodView& view, float deltaSeconds)
+    {
+        selectAll(&jobSystem, view, deltaSeconds);
+    }
+
+    void LodSelector::selectAll(JobSystem* jobSystem, const LodView& view, float deltaSeconds)
+    {
+        SelectionParameters parameters;
+        parameters.eye[0] = view.eye[0];
+        parameters.eye[1] = view.eye[1];
+        parameters.eye[2] = view.eye[2];
+        parameters.errorPerDistance = m_settings.pixelError / view.projectionScale;
+        parameters.coarsenErrorPerDistance = parameters.errorPerDistance * (1.0f - m_settings.hysteresis);
+        parameters.fadeStep = m_settings.fadeSeconds > 0.0f ? deltaSeconds / m_settings.fadeSeconds : FLT_MAX;
+        parameters.levelCount = m_maxLevelCount;
+
+        const uint32_t instanceCount = getInstanceCount();
+        const uint32_t blockCount = (instanceCount + LodBlockSize - 1) / LodBlockSize;
+        if (!jobSystem || blockCount <= 1)
+        {
+            m_stats = selectRange(parameters, 0, instanceCount);
+            return;
+        }
+
+        // Grows to the largest block count seen, then stays
+        if (m_blockStats.size() < blockCount)
+        {
+            m_blockStats.resize(blockCount);
+        }
+
+        LodSelectorStats* blockStats = m_blockStats.data();
+        jobSystem->parallelFor(blockCount, 1, [&](uint32_t firstBlock, uint32_t lastBlock)
+        {
+            for (uint32_t block = firstBlock; block < lastBlock; ++block)
+            {
+                const uint32_t begin = block * LodBlockSize;
+                blockStats[block] = selectRange(parameters, begin, std::min(begin + LodBlockSize, instanceCount));
+            }
+        });
+
+        m_stats = {};
+        for (uint32_t block = 0; block < blockCount; ++block)
+        {
+            m_stats.instanceCount += blockStats[block].instanceCount;
+            m_stats.switchCount += blockStats[block].switchCount;
+            m_stats.fadingCount += blockStats[block].fadingCount;
+        }
+    }
+
+    LodSelectorStats LodSelector::selectRange(const SelectionParameters& parameters, uint32_t begin, uint32_t end)
+    {
+        LodSelectorStats stats;
+        stats.instanceCount = end - begin;
+
+        uint32_t i = begin;
+#if RAPHAEL_LOD_AVX2
+        if (m_useAvx2)
+        {
+            const uint32_t simdEnd = begin + (end - begin) / 8 * 8;
+            selectRangeAvx2(parameters.eye, parameters.errorPerDistance, parameters.coarsenErrorPerDistance, parameters.fadeStep,
+                parameters.levelCount, m_tableErrors.data(), m_centerX.data(), m_centerY.data(), m_centerZ.data(), m_radius.data(),
+                m_tableOffset.data(), m_level.data(), m_previousLevel.data(), m_fade.data(), begin, simdEnd, stats);
+            i = simdEnd;
+        }
+#endif
+
+        for (; i < end; ++i)
+        {
+            // Same operation order as the SIMD path, so both round alike
+            const float dx = m_centerX[i] - parameters.eye[0];
+            const float dy = m_centerY[i] - parameters.eye[1];
+            const float dz = m_centerZ[i] - parameters.eye[2];
+            const float distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz) - m_radius[i], MinLodDistance);
+            const float maxError = distance * parameters.errorPerDistance;
+            const float coarsenError = distance * parameters.coarsenErrorPerDistance;
+
+            const float* errors = m_tableErrors.data() + m_tableOffset[i];
+            uint32_t desired = 0;
+            uint32_t coarse = 0;
+            for (uint32_t level = 1; level < parameters.levelCount; ++level)
+            {
+                desired += errors[level] <= maxError ? 1 : 0;
+                coarse += errors[level] <= coarsenError ? 1 : 0;
+            }
+
+            const uint32_t current = m_level[i];
+            const bool fresh = current == NewInstanceLevel;
+            const uint32_t kept = fresh ? 0 : current;
+            uint32_t level = coarse > kept ? coarse : kept;
+            if (errors[kept] > maxError || fresh)
+            {
+                level = desired;
+            }
+
+            const bool switched = !fresh && level != current;
+            const bool reversing = switched && level == m_previousLevel[i];
+            const float base = switched ? (reversing ? 1.0f - m_fade[i] : 0.0f) : m_fade[i];
+            const float fade = fresh ? 1.0f : std::min(base + parameters.fadeStep, 1.0f);
+            uint32_t previous = switched ? current : m_previousLevel[i];
+            if (fade >= 1.0f)
+            {
+                previous = level;
+            }
+
+            m_level[i] = static_cast<uint8_t>(level);
+            m_previousLevel[i] = static_cast<uint8_t>(previous);
+            m_fade[i] = fade;
+            stats.switchCount += switched ? 1 : 0;
+            stats.fadingCount += fade < 1.0f ? 1 : 0;
+        }
+        return stats;
+    }
+
+    float simplifyByClustering(const float* positions, uint32_t positionStride, uint32_t vertexCount, const uint32_t* indices,
+        uint32_t indexCount, float cellSize, std::vector<uint32_t>& outIndices)
+    {
+        if (!(cellSize > 0.0f))
+        {
+            throw std::runtime_error("Cluster cell size must be positive");
+        }
+        if (indexCount % 3 != 0)
+        {
+            throw std::runtime_error("Index count must be a multiple of 3");
+        }
+
+        auto position = [&](uint32_t vertex)
+        {
+            return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + static_cast<size_t>(vertex) * positionStride);
+        };
+
+        // Cell of every vertex and the summed positions of each cell
+        const float inverseCellSize = 1.0f / cellSize;
+        std::unordered_map<CellKey, uint32_t, CellKeyHash> cellIndices;
+        cellIndices.reserve(vertexCount);
+        std::vector<uint32_t> vertexCells(vertexCount);
+        std::vector<float> cellSums;
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            const float* p = position(vertex);
+            const CellKey key =
+            {
+                static_cast<int32_t>(std::floor(p[0] * inverseCellSize)),
+                static_cast<int32_t>(std::floor(p[1] * inverseCellSize)),
+                static_cast<int32_t>(std::floor(p[2] * inverseCellSize)),
+            };
+            const auto [it, inserted] = cellIndices.try_emplace(key, static_cast<uint32_t>(cellSums.size() / 4));
+            if (inserted)
+            {
+                cellSums.insert(cellSums.end(), { 0.0f, 0.0f, 0.0f, 0.0f });
+            }
+            float* sum = &cellSums[it->second * 4];
+            sum[0] += p[0];
+            sum[1] += p[1];
+            sum[2] += p[2];
+            sum[3] += 1.0f;
+            vertexCells[vertex] = it->second;
+        }
+
+        // Each cell keeps the vertex nearest its average, attributes and all
+        const uint32_t cellCount = static_cast<uint32_t>(cellSums.size() / 4);
+        std::vector<uint32_t> representatives(cellCount, UINT32_MAX);
+        std::vector<float> representativeDistances(cellCount, FLT_MAX);
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            const uint32_t cell = vertexCells[vertex];
+            const float* sum = &cellSums[cell * 4];
+            const float* p = position(vertex);
+            const float dx = p[0] - sum[0] / sum[3];
+            const float dy = p[1] - sum[1] / sum[3];
+            const float dz = p[2] - sum[2] / sum[3];
+            const float distanceSq = dx * dx + dy * dy + dz * dz;
+            if (distanceSq < representativeDistances[cell])
+            {
+                representativeDistances[cell] = distanceSq;
+                representatives[cell] = vertex;
+            }
+        }
+
+        float maxDistanceSq = 0.0f;
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            const float* p = position(vertex);
+            const float* q = position(representatives[vertexCells[vertex]]);
+            const float dx = p[0] - q[0];
+            const float dy = p[1] - q[1];
+            const float dz = p[2] - q[2];
+            maxDistanceSq = std::max(maxDistanceSq, dx * dx + dy * dy + dz * dz);
+        }
+
+        outIndices.clear();
+        for (uint32_t i = 0; i < indexCount; i += 3)
+        {
+            if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+            {
+                throw std::runtime_error("Index out of range");
+            }
+            const uint32_t a = representatives[vertexCells[indices[i]]];
+            const uint32_t b = representatives[vertexCells[indices[i + 1]]];
+            const uint32_t c = representatives[vertexCells[indices[i + 2]]];
+            if (a != b && b != c && a != c)
+            {
+                outIndices.insert(outIndices.end(), { a, b, c });
+            }
+        }
+        return std::sqrt(maxDistanceSq);
+    }
+} // namespace raphael
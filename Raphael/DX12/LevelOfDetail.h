@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace raphael
+{
+    class JobSystem;
+
+    // Levels a mesh can have, level 0 is full detail
+    constexpr uint32_t MaxLodLevels = 8;
+    // Instances one parallel selection job handles, a multiple of the 8-wide SIMD step
+    constexpr uint32_t LodBlockSize = 4096;
+
+    // Geometric error of each level of one mesh: how far, in object units, its surface strays from full detail.
+    // Errors must not decrease from one level to the next.
+    struct LodTable
+    {
+        uint32_t levelCount = 1;
+        float geometricError[MaxLodLevels] = {};
+    };
+
+    // Camera terms the projected error needs. projectionScale turns an error at distance 1 into pixels.
+    struct LodView
+    {
+        float eye[3] = {};
+        float projectionScale = 1.0f;
+    };
+
+    // eye in the space of the instance bounds. projection is a row-vector matrix given as 16 floats in
+    // XMFLOAT4X4 order, only its vertical scale is read.
+    LodView makeLodView(const float eye[3], const float* projection, float viewportHeight);
+
+    struct LodSettings
+    {
+        float pixelError = 1.0f;  // Largest projected error a level may show
+        float hysteresis = 0.25f; // A coarser level must fit pixelError * (1 - hysteresis) before it is taken
+        float fadeSeconds = 0.25f; // Length of the cross-fade after a switch, 0 switches at once
+    };
+
+    struct LodSelectorStats
+    {
+        uint32_t instanceCount = 0; // Last select
+        uint32_t switchCount = 0;   // Instances that changed level
+        uint32_t fadingCount = 0;   // Instances still cross-fading afterwards
+    };
+
+    // Picks a level of detail per instance from the screen space error of each level. An instance's distance is
+    // taken to its bounding sphere, so the error is never underestimated while the camera is close.
+    // An instance refines as soon as its level's error exceeds the limit but coarsens only once the coarser level
+    // fits with the hysteresis margin, so instances near a threshold do not flip back and forth.
+    // After a switch the previous level stays around for fadeSeconds: getFades() is the new level's weight, the
+    // previous level draws with the rest. Switching back mid-fade reverses the fade instead of restarting it.
+    // Uses AVX2 when the CPU supports it, 8 instances per iteration, and a scalar loop with identical results
+    // otherwise. The job system overload selects LodBlockSize blocks in parallel. Steady-state selections do not
+    // allocate.
+    // Backend independent.
+    class LodSelector
+    {
+    public:
+        LodSelector();
+        ~LodSelector() = default;
+
+        LodSelector(const LodSelector& rhs) = delete;
+        LodSelector& operator=(const LodSelector& rhs) = delete;
+
+        // Returns the table index
+        uint32_t addTable(const LodTable& table);
+        void reserve(uint32_t instanceCount);
+        void clear();
+        // Returns the instance index, instances are numbered in the order they are added. New instances take
+        // their level on the next select without fading.
+        uint32_t addInstance(uint32_t tableIndex, const float center[3], float radius);
+        void setInstance(uint32_t index, const float center[3], float radius);
+
+        void select(const LodView& view, float deltaSeconds);
+        void select(JobSystem& jobSystem, const LodView& view, float deltaSeconds);
+
+        uint32_t getInstanceCount() const { return static_cast<uint32_t>(m_radius.size()); }
+        const uint8_t* getLevels() const { return m_level.data(); }
+        const uint8_t* getPreviousLevels() const { return m_previousLevel.data(); } // Equal to the level once the fade is over
+        const float* getFades() const { return m_fade.data(); }
+
+        void setSettings(const LodSettings& settings) { m_settings = settings; }
+        const LodSettings& getSettings() const { return m_settings; }
+        // Falls back to the scalar loop even on AVX2 hardware, to compare the two
+        void setSimdEnabled(bool enabled) { m_useAvx2 = enabled && m_hasAvx2; }
+        bool isUsingSimd() const { return m_useAvx2; }
+        const LodSelectorStats& getStats() const { return m_stats; }
+
+    private:
+        struct SelectionParameters;
+        void selectAll(JobSystem* jobSystem, const LodView& view, float deltaSeconds);
+        LodSelectorStats selectRange(const SelectionParameters& parameters, uint32_t begin, uint32_t end);
+
+    private:
+        std::vector<float> m_tableErrors;  // MaxLodLevels per table, levels past the count never fit
+        std::vector<float> m_centerX;
+        std::vector<float> m_centerY;
+        std::vector<float> m_centerZ;
+        std::vector<float> m_radius;
+        std::vector<int32_t> m_tableOffset; // First entry of the instance's table in m_tableErrors
+        std::vector<uint8_t> m_level;
+        std::vector<uint8_t> m_previousLevel;
+        std::vector<float> m_fade;
+        std::vector<LodSelectorStats> m_blockStats;
+        uint32_t m_maxLevelCount = 1;
+        LodSettings m_settings;
+        bool m_hasAvx2 = false;
+        bool m_useAvx2 = false;
+        LodSelectorStats m_stats;
+    };
+
+    // Builds a coarser level by vertex clustering: positions snap to a grid of cellSize, the vertices of a cell
+    // collapse onto the one nearest their average, and triangles left with fewer than three distinct corners are
+    // dropped. The result indexes the same vertices, so a level is just another index range over the mesh.
+    // positionStride is the byte distance between positions. Returns the geometric error, the farthest any vertex moved.
+    // Backend independent.
+    float simplifyByClustering(const float* positions, uint32_t positionStride, uint32_t vertexCount, const uint32_t* indices,
+        uint32_t indexCount, float cellSize, std::vector<uint32_t>& outIndices);
+} // namespace raphael
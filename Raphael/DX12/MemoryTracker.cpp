@@ -0,0 +1,250 @@
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+namespace raphael
+{
+    const char* getMemoryCategoryName(MemoryCategory category)
+    {
+        switch (category)
+        {
+        case MemoryCategory::Unknown: return "Unknown";
+        case MemoryCategory::Geometry: return "Geometry";
+        case MemoryCategory::Texture: return "Texture";
+        case MemoryCategory::RenderTarget: return "RenderTarget";
+        case MemoryCategory::DepthStencil: return "DepthStencil";
+        case MemoryCategory::ConstantBuffer: return "ConstantBuffer";
+        case MemoryCategory::Staging: return "Staging";
+        case MemoryCategory::DescriptorHeap: return "DescriptorHeap";
+        case MemoryCategory::SwapChain: return "SwapChain";
+        case MemoryCategory::Other: return "Other";
+        default: return "Invalid";
+        }
+    }
+
+    static void addAllocation(MemoryCategoryStats& stats, MemoryFrameChurn& churn, uint64_t sizeInBytes)
+    {
+        stats.liveBytes += sizeInBytes;
+        stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+        stats.liveCount++;
+        stats.totalAllocationCount++;
+        churn.allocationCount++;
+        churn.allocatedBytes += sizeInBytes;
+    }
+
+    static void removeAllocation(MemoryCategoryStats& stats, MemoryFrameChurn& churn, uint64_t sizeInBytes)
+    {
+        stats.liveBytes -= sizeInBytes;
+        stats.liveCount--;
+        churn.freeCount++;
+        churn.freedBytes += sizeInBytes;
+    }
+
+    uint32_t MemoryTracker::track(MemoryCategory category, uint64_t sizeInBytes, const char* debugName)
+    {
+        if (category >= MemoryCategory::Count)
+        {
+            category = MemoryCategory::Other;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        uint32_t index = 0;
+        if (!m_freeHandles.empty())
+        {
+            index = m_freeHandles.back();
+            m_freeHandles.pop_back();
+        }
+        else
+        {
+            if (m_allocations.size() >= MaxAllocationCount)
+            {
+                throw std::runtime_error("Too many tracked allocations");
+            }
+            index = static_cast<uint32_t>(m_allocations.size());
+            m_allocations.emplace_back();
+        }
+
+        Allocation& allocation = m_allocations[index];
+        allocation.debugName = debugName ? debugName : "";
+        allocation.sizeInBytes = sizeInBytes;
+        allocation.frameIndex = m_frameIndex;
+        allocation.category = category;
+        allocation.isLive = true;
+
+        CategoryState& state = m_categories[static_cast<size_t>(category)];
+        addAllocation(state.stats, state.currentFrame, sizeInBytes);
+        addAllocation(m_total.stats, m_total.currentFrame, sizeInBytes);
+        return (allocation.generation << HandleIndexBits) | index;
+    }
+
+    void MemoryTracker::untrack(uint32_t handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Stale handles name a slot that was freed since, and maybe reused under a newer generation
+        const uint32_t index = handle & MaxAllocationCount;
+        if (index >= m_allocations.size() || !m_allocations[index].isLive ||
+            m_allocations[index].generation != handle >> HandleIndexBits)
+        {
+            return;
+        }
+
+        Allocation& allocation = m_allocations[index];
+        CategoryState& state = m_categories[static_cast<size_t>(allocation.category)];
+        removeAllocation(state.stats, state.currentFrame, allocation.sizeInBytes);
+        removeAllocation(m_total.stats, m_total.currentFrame, allocation.sizeInBytes);
+
+        const uint32_t generation = (allocation.generation + 1) & (~0u >> HandleIndexBits);
+        allocation = {};
+        allocation.generation = generation;
+        m_freeHandles.push_back(index);
+    }
+
+    void MemoryTracker::endFrame()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (CategoryState& state : m_categories)
+        {
+            state.stats.lastFrame = state.currentFrame;
+            state.currentFrame = {};
+        }
+        m_total.stats.lastFrame = m_total.currentFrame;
+        m_total.currentFrame = {};
+        m_frameIndex++;
+    }
+
+    void MemoryTracker::setBudget(uint64_t budgetBytes, uint64_t usageBytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budgetBytes = budgetBytes;
+        m_osUsageBytes = usageBytes;
+    }
+
+    MemoryCategoryStats MemoryTracker::getCategoryStats(MemoryCategory category) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return category < MemoryCategory::Count ? m_categories[static_cast<size_t>(category)].stats : MemoryCategoryStats{};
+    }
+
+    MemoryCategoryStats MemoryTracker::getTotalStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_total.stats;
+    }
+
+    uint64_t MemoryTracker::getBudget() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_budgetBytes;
+    }
+
+    uint64_t MemoryTracker::getOsUsage() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_osUsageBytes;
+    }
+
+    uint64_t MemoryTracker::getFrameIndex() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_frameIndex;
+    }
+
+    bool MemoryTracker::isOverBudget() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_budgetBytes != 0 && std::max(m_osUsageBytes, m_total.stats.liveBytes) > m_budgetBytes;
+    }
+
+    static void writeJsonString(std::ostringstream& out, const std::string& value)
+    {
+        out << '"';
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out << escaped;
+                }
+                else
+                {
+                    out << c;
+                }
+            }
+        }
+        out << '"';
+    }
+
+    static void writeJsonStats(std::ostringstream& out, const MemoryCategoryStats& stats)
+    {
+        out << "{\"liveBytes\":" << stats.liveBytes
+            << ",\"peakBytes\":" << stats.peakBytes
+            << ",\"liveCount\":" << stats.liveCount
+            << ",\"totalAllocations\":" << stats.totalAllocationCount
+            << ",\"lastFrame\":{\"allocations\":" << stats.lastFrame.allocationCount
+            << ",\"frees\":" << stats.lastFrame.freeCount
+            << ",\"allocatedBytes\":" << stats.lastFrame.allocatedBytes
+            << ",\"freedBytes\":" << stats.lastFrame.freedBytes << "}}";
+    }
+
+    std::string MemoryTracker::buildJson(bool includeAllocations) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::ostringstream out;
+        out << "{\"frame\":" << m_frameIndex
+            << ",\"budgetBytes\":" << m_budgetBytes
+            << ",\"osUsageBytes\":" << m_osUsageBytes
+            << ",\"total\":";
+        writeJsonStats(out, m_total.stats);
+
+        out << ",\"categories\":{";
+        for (size_t i = 0; i < CategoryCount; ++i)
+        {
+            out << (i ? "," : "") << '"' << getMemoryCategoryName(static_cast<MemoryCategory>(i)) << "\":";
+            writeJsonStats(out, m_categories[i].stats);
+        }
+        out << '}';
+
+        if (includeAllocations)
+        {
+            std::vector<const Allocation*> live;
+            for (const Allocation& allocation : m_allocations)
+            {
+                if (allocation.isLive)
+                {
+                    live.push_back(&allocation);
+                }
+            }
+            std::stable_sort(live.begin(), live.end(),
+                [](const Allocation* a, const Allocation* b) { return a->sizeInBytes > b->sizeInBytes; });
+
+            out << ",\"allocations\":[";
+            for (size_t i = 0; i < live.size(); ++i)
+            {
+                out << (i ? "," : "") << "{\"name\":";
+                writeJsonString(out, live[i]->debugName);
+                out << ",\"category\":\"" << getMemoryCategoryName(live[i]->category) << '"'
+                    << ",\"sizeInBytes\":" << live[i]->sizeInBytes
+                    << ",\"frame\":" << live[i]->frameIndex << '}';
+            }
+            out << ']';
+        }
+
+        out << '}';
+        return out.str();
+    }
+} // namespace raphael
@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace raphael
+{
+    enum class MemoryCategory : uint8_t
+    {
+        Unknown, // Resolved from the resource description when a resource is created
+        Geometry,
+        Texture,
+        RenderTarget,
+        DepthStencil,
+        ConstantBuffer,
+        Staging,
+        DescriptorHeap,
+        SwapChain,
+        Other,
+        Count
+    };
+
+    const char* getMemoryCategoryName(MemoryCategory category);
+
+    struct MemoryFrameChurn
+    {
+        uint32_t allocationCount = 0;
+        uint32_t freeCount = 0;
+        uint64_t allocatedBytes = 0;
+        uint64_t freedBytes = 0;
+    };
+
+    struct MemoryCategoryStats
+    {
+        uint64_t liveBytes = 0;
+        uint64_t peakBytes = 0;
+        uint32_t liveCount = 0;
+        uint64_t totalAllocationCount = 0;
+        MemoryFrameChurn lastFrame = {}; // Churn of the last completed frame
+    };
+
+    // Accounts for GPU memory by category: live bytes, peaks and per-frame allocation churn, plus the OS budget
+    // when the backend provides one. Objects register with track() and hand the returned handle back to untrack().
+    // Handles carry the generation of their slot in the upper bits, so untracking a handle twice or after its slot
+    // was reused is ignored instead of removing the allocation that lives there now.
+    // Backend independent and thread safe, resources can be created from any thread.
+    class MemoryTracker
+    {
+    public:
+        static constexpr uint32_t InvalidHandle = ~0u;
+        // Slot index in the low bits, the slot's generation above, wrapping after 256 reuses of a slot
+        static constexpr uint32_t HandleIndexBits = 24;
+        static constexpr uint32_t MaxAllocationCount = (1u << HandleIndexBits) - 1; // Keeps every handle below InvalidHandle
+
+        MemoryTracker() = default;
+        ~MemoryTracker() = default;
+
+        MemoryTracker(const MemoryTracker& rhs) = delete;
+        MemoryTracker& operator=(const MemoryTracker& rhs) = delete;
+
+        // debugName is copied, it may be null
+        uint32_t track(MemoryCategory category, uint64_t sizeInBytes, const char* debugName);
+        void untrack(uint32_t handle);
+
+        // Closes the churn window of the current frame
+        void endFrame();
+
+        // Budget and current usage as reported by the OS for the whole process, zero when unknown
+        void setBudget(uint64_t budgetBytes, uint64_t usageBytes);
+
+        MemoryCategoryStats getCategoryStats(MemoryCategory category) const;
+        MemoryCategoryStats getTotalStats() const;
+        uint64_t getBudget() const;
+        uint64_t getOsUsage() const;
+        uint64_t getFrameIndex() const;
+        bool isOverBudget() const;
+
+        // Per-category stats, budget and (optionally) every live allocation sorted by size
+        std::string buildJson(bool includeAllocations = true) const;
+
+    private:
+        struct Allocation
+        {
+            std::string debugName;
+            uint64_t sizeInBytes = 0;
+            uint64_t frameIndex = 0; // Frame the allocation was made in
+            MemoryCategory category = MemoryCategory::Unknown;
+            uint32_t generation = 0; // Bumped when the slot is freed
+            bool isLive = false;
+        };
+
+        static constexpr size_t CategoryCount = static_cast<size_t>(MemoryCategory::Count);
+
+        struct CategoryState
+        {
+            MemoryCategoryStats stats = {};
+            MemoryFrameChurn currentFrame = {};
+        };
+
+    private:
+        mutable std::mutex m_mutex;
+        std::vector<Allocation> m_allocations; // Indexed by handle
+        std::vector<uint32_t> m_freeHandles;
+        std::array<CategoryState, CategoryCount> m_categories = {};
+        CategoryState m_total = {};
+        uint64_t m_frameIndex = 0;
+        uint64_t m_budgetBytes = 0;
+        uint64_t m_osUsageBytes = 0;
+    };
+} // namespace raphael
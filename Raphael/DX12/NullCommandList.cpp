@@ -0,0 +1,176 @@
+#include "NullCommandList.h"
+#include <stdexcept>
+
+namespace raphael
+{
+    namespace
+    {
+        constexpr uint32_t TriangleListTopology = 4; // D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, as CommandList draws
+    } // namespace
+
+    void NullCommandList::begin()
+    {
+        if (m_isRecording)
+        {
+            throw std::runtime_error("Command list is already recording");
+        }
+
+        m_stateTracker.reset();
+        m_stateCache.reset();
+        m_isRecording = true;
+    }
+
+    void NullCommandList::end()
+    {
+        if (!m_isRecording)
+        {
+            throw std::runtime_error("Command list is not recording");
+        }
+
+        m_stateTracker.finish();
+        flushBarriers();
+        m_isRecording = false;
+    }
+
+    void NullCommandList::setPipeline(NullPipeline* pipeline)
+    {
+        checkRecording();
+        if (m_stateCache.setPipeline(pipeline) && m_recordStream != nullptr)
+        {
+            m_recordStream->setPipeline(pipeline->getHandle());
+        }
+    }
+
+    void NullCommandList::setDescriptorHeaps(NullDescriptorHeap* heap)
+    {
+        checkRecording();
+        const void* heaps[] = { heap };
+        if (m_stateCache.setDescriptorHeaps(heaps, 1) && m_recordStream != nullptr)
+        {
+            m_recordStream->setDescriptorHeap(heap->getHandle());
+        }
+    }
+
+    void NullCommandList::setGraphicsRootSignature(NullRootSignature* rootSignature)
+    {
+        checkRecording();
+        if (m_stateCache.setRootSignature(rootSignature) && m_recordStream != nullptr)
+        {
+            m_recordStream->setRootSignature(rootSignature->getHandle());
+        }
+    }
+
+    void NullCommandList::setGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint64_t gpuHandle)
+    {
+        checkRecording();
+        if (m_stateCache.setRootDescriptorTable(rootParameterIndex, gpuHandle) && m_recordStream != nullptr)
+        {
+            m_recordStream->setRootDescriptorTable(rootParameterIndex, gpuHandle);
+        }
+    }
+
+    void NullCommandList::setConstantBufferView(uint32_t rootParameterIndex, uint64_t gpuAddress)
+    {
+        checkRecording();
+        if (m_stateCache.setRootConstantBuffer(rootParameterIndex, gpuAddress) && m_recordStream != nullptr)
+        {
+            m_recordStream->setRootConstantBuffer(rootParameterIndex, gpuAddress);
+        }
+    }
+
+    void NullCommandList::setVertexBuffer(uint32_t slot, NullResource* buffer, uint32_t sizeInBytes, uint32_t strideInBytes)
+    {
+        checkRecording();
+        if (m_stateCache.setVertexBuffer(slot, { buffer->getGpuAddress(), sizeInBytes, strideInBytes }) && m_recordStream != nullptr)
+        {
+            m_recordStream->setVertexBuffer(slot, buffer->getHandle());
+        }
+    }
+
+    void NullCommandList::setIndexBuffer(NullResource* buffer, uint32_t sizeInBytes, uint32_t indexSizeInBytes)
+    {
+        checkRecording();
+        if (m_stateCache.setIndexBuffer({ buffer->getGpuAddress(), sizeInBytes, indexSizeInBytes }) && m_recordStream != nullptr)
+        {
+            m_recordStream->setIndexBuffer(buffer->getHandle());
+        }
+    }
+
+    void NullCommandList::transitionResource(NullResource* resource, ResourceState state)
+    {
+        checkRecording();
+        m_stateTracker.require(resource->getTrackedState(), state);
+    }
+
+    void NullCommandList::assumeResourceState(NullResource* resource, ResourceState state)
+    {
+        checkRecording();
+        m_stateTracker.assume(resource->getTrackedState(), state);
+    }
+
+    void NullCommandList::beginResourceTransition(NullResource* resource, ResourceState state)
+    {
+        checkRecording();
+        m_stateTracker.beginSplit(resource->getTrackedState(), state);
+    }
+
+    void NullCommandList::flushBarriers()
+    {
+        const std::span<const ResourceTransition> pending = m_stateTracker.getPendingBarriers();
+        if (pending.empty())
+        {
+            return;
+        }
+
+        m_stats.barrierBatchCount++;
+        if (m_recordStream != nullptr)
+        {
+            for (const ResourceTransition& transition : pending)
+            {
+                // Begin halves only announce the transition, the end half is where the state changes
+                if (transition.flags != ResourceTransitionFlags::BeginOnly)
+                {
+                    m_recordStream->transition(static_cast<NullResource*>(transition.resource->owner)->getHandle(), transition.after);
+                }
+            }
+        }
+        m_stateTracker.clearPendingBarriers();
+    }
+
+    void NullCommandList::drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation)
+    {
+        checkRecording();
+        flushBarriers();
+        // Counted like CommandList does, the stream format has no topology command
+        m_stateCache.setPrimitiveTopology(TriangleListTopology);
+
+        m_stats.drawCount++;
+        m_stats.vertexCount += static_cast<uint64_t>(vertexCountPerInstance) * instanceCount;
+        if (m_recordStream != nullptr)
+        {
+            m_recordStream->draw(vertexCountPerInstance, instanceCount, startVertexLocation, startInstanceLocation);
+        }
+    }
+
+    void NullCommandList::drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+    {
+        checkRecording();
+        flushBarriers();
+        m_stateCache.setPrimitiveTopology(TriangleListTopology);
+
+        m_stats.drawCount++;
+        m_stats.vertexCount += static_cast<uint64_t>(indexCountPerInstance) * instanceCount;
+        if (m_recordStream != nullptr)
+        {
+            m_recordStream->drawIndexed(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+        }
+    }
+
+    void NullCommandList::checkRecording() const
+    {
+        if (!m_isRecording)
+        {
+            throw std::runtime_error("Command list is not recording");
+        }
+    }
+} // namespace raphael
@@ -0,0 +1,62 @@
+#pragma once
+#include "NullDevice.h"
+#include "CommandStateCache.h"
+
+namespace raphael
+{
+    struct NullCommandListStats
+    {
+        uint64_t drawCount = 0;         // Draw calls, indexed or not
+        uint64_t vertexCount = 0;       // Vertices or indices times instances
+        uint64_t barrierBatchCount = 0; // Barrier calls a GPU backend would record
+    };
+
+    // Command list of the null backend, the CommandList surface without a GPU.
+    // State calls go through the same CommandStateCache and transitions through the same ResourceStateTracker
+    // as CommandList, so the issued call and barrier counts are the ones the D3D12 backend would record.
+    // A list can also write what it issues to a CommandStream, with object handles, to inspect or replay it.
+    class NullCommandList : public NullObject
+    {
+    public:
+        NullCommandList(NullDevice* device, const char* name) : NullObject(device, NullObjectType::CommandList, name) {}
+
+        void begin();
+        void end();
+        bool isRecording() const { return m_isRecording; }
+
+        void setPipeline(NullPipeline* pipeline);
+        void setDescriptorHeaps(NullDescriptorHeap* heap);
+        void setGraphicsRootSignature(NullRootSignature* rootSignature);
+        void setGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint64_t gpuHandle);
+        void setConstantBufferView(uint32_t rootParameterIndex, uint64_t gpuAddress);
+        void setVertexBuffer(uint32_t slot, NullResource* buffer, uint32_t sizeInBytes, uint32_t strideInBytes);
+        void setIndexBuffer(NullResource* buffer, uint32_t sizeInBytes, uint32_t indexSizeInBytes);
+
+        void transitionResource(NullResource* resource, ResourceState state);
+        void assumeResourceState(NullResource* resource, ResourceState state);
+        void beginResourceTransition(NullResource* resource, ResourceState state);
+        void flushBarriers();
+
+        void drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation);
+        void drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation);
+
+        // Issued calls are appended to stream until it is set back to null. Vertex and index buffers are
+        // written with the buffer's handle, transitions with the state they leave the resource in.
+        void setRecordStream(CommandStream* stream) { m_recordStream = stream; }
+
+        uint32_t resolveResourceStates(std::vector<ResourceTransition>& fixups) { return m_stateTracker.resolve(fixups); }
+        const NullCommandListStats& getStats() const { return m_stats; }
+        const CommandStateCacheStats& getStateCacheStats() const { return m_stateCache.getStats(); }
+        const ResourceStateTrackerStats& getStateTrackerStats() const { return m_stateTracker.getStats(); }
+
+    private:
+        void checkRecording() const;
+
+    private:
+        bool m_isRecording = false;
+        ResourceStateTracker m_stateTracker;
+        CommandStateCache m_stateCache;
+        CommandStream* m_recordStream = nullptr;
+        NullCommandListStats m_stats;
+    };
+} // namespace raphael
@@ -0,0 +1,275 @@
+#include "NullDevice.h"
+#include "NullCommandList.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace raphael
+{
+    namespace
+    {
+        // Spacing of fake GPU addresses, keeps every resource on its own placement boundary
+        constexpr uint64_t GpuAddressAlignment = 64 * 1024;
+        constexpr uint64_t DescriptorSize = 32;
+    } // namespace
+
+    const char* getNullObjectTypeName(NullObjectType type)
+    {
+        switch (type)
+        {
+        case NullObjectType::Resource:       return "Resource";
+        case NullObjectType::Pipeline:       return "Pipeline";
+        case NullObjectType::RootSignature:  return "RootSignature";
+        case NullObjectType::DescriptorHeap: return "DescriptorHeap";
+        case NullObjectType::CommandList:    return "CommandList";
+        default:                             return "Unknown";
+        }
+    }
+
+    NullObject::NullObject(NullDevice* device, NullObjectType type, const char* name)
+        : m_device(device), m_type(type), m_name(name != nullptr ? name : "")
+    {
+        m_handle = m_device->registerObject(this);
+    }
+
+    NullObject::~NullObject()
+    {
+        m_device->unregisterObject(this);
+    }
+
+    NullResource::NullResource(NullDevice* device, const NullResourceDesc& desc)
+        : NullObject(device, NullObjectType::Resource, desc.name), m_desc(desc)
+    {
+        m_desc.name = getName().c_str();
+        m_gpuAddress = device->allocateGpuRange(desc.sizeInBytes);
+        m_memoryHandle = device->getMemoryTracker().track(desc.category, desc.sizeInBytes, desc.name);
+        m_trackedState.state = desc.initialState;
+        m_trackedState.owner = this;
+    }
+
+    NullResource::~NullResource()
+    {
+        getDevice()->getMemoryTracker().untrack(m_memoryHandle);
+    }
+
+    NullDescriptorHeap::NullDescriptorHeap(NullDevice* device, const NullDescriptorHeapDesc& desc)
+        : NullObject(device, NullObjectType::DescriptorHeap, desc.name), m_desc(desc)
+    {
+        m_desc.name = getName().c_str();
+        const uint64_t sizeInBytes = static_cast<uint64_t>(desc.descriptorCount) * DescriptorSize;
+        m_gpuBase = desc.shaderVisible ? device->allocateGpuRange(sizeInBytes) : 0;
+        m_memoryHandle = device->getMemoryTracker().track(MemoryCategory::DescriptorHeap, sizeInBytes, desc.name);
+    }
+
+    NullDescriptorHeap::~NullDescriptorHeap()
+    {
+        getDevice()->getMemoryTracker().untrack(m_memoryHandle);
+    }
+
+    uint64_t NullDescriptorHeap::getGpuHandle(uint32_t index) const
+    {
+        if (!m_desc.shaderVisible)
+        {
+            throw std::runtime_error("Descriptor heap is not shader visible");
+        }
+        if (index >= m_desc.descriptorCount)
+        {
+            throw std::runtime_error("Descriptor index out of range");
+        }
+        return m_gpuBase + index * DescriptorSize;
+    }
+
+    NullDevice::NullDevice(const NullDeviceDesc& desc)
+        : m_desc(desc)
+    {
+        // Destroying an object never allocates unless more than this many are alive
+        m_objects.reserve(256);
+        m_freeHandles.reserve(256);
+        m_fixupTransitions.reserve(64);
+    }
+
+    NullDevice::~NullDevice()
+    {
+        // Retired objects unregister themselves, release them while the registry is still alive
+        m_releaseQueue.releaseAll();
+    }
+
+    std::unique_ptr<NullResource> NullDevice::createResource(const NullResourceDesc& desc)
+    {
+        return std::make_unique<NullResource>(this, desc);
+    }
+
+    std::unique_ptr<NullPipeline> NullDevice::createPipeline(const char* name)
+    {
+        return std::make_unique<NullPipeline>(this, name);
+    }
+
+    std::unique_ptr<NullRootSignature> NullDevice::createRootSignature(const char* name)
+    {
+        return std::make_unique<NullRootSignature>(this, name);
+    }
+
+    std::unique_ptr<NullDescriptorHeap> NullDevice::createDescriptorHeap(const NullDescriptorHeapDesc& desc)
+    {
+        return std::make_unique<NullDescriptorHeap>(this, desc);
+    }
+
+    std::unique_ptr<NullCommandList> NullDevice::createCommandList(const char* name)
+    {
+        return std::make_unique<NullCommandList>(this, name);
+    }
+
+    void NullDevice::executeCommandList(NullCommandList* commandList)
+    {
+        executeCommandLists(&commandList, 1);
+    }
+
+    void NullDevice::executeCommandLists(NullCommandList* const* commandLists, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (commandLists[i]->isRecording())
+            {
+                throw std::runtime_error("Command list executed while still recording");
+            }
+        }
+
+        // Same order as DeviceDx12: every list is checked against the states the lists before it leave behind
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_fixupTransitions.clear();
+            const uint32_t fixupCount = commandLists[i]->resolveResourceStates(m_fixupTransitions);
+            if (fixupCount > 0)
+            {
+                m_stats.fixupCount += fixupCount;
+                m_stats.fixupListCount++;
+            }
+        }
+
+        m_stats.executeCount++;
+        m_stats.executedListCount += count;
+    }
+
+    void NullDevice::signalFence(uint64_t value)
+    {
+        m_fenceLastSignaled = std::max(m_fenceLastSignaled, value);
+        m_stats.signalCount++;
+
+        // The simulated GPU finishes the work fenceLatency signals behind the CPU
+        if (value > m_desc.fenceLatency)
+        {
+            completeFence(value - m_desc.fenceLatency);
+        }
+    }
+
+    void NullDevice::waitForFence(uint64_t value)
+    {
+        if (value > m_fenceLastSignaled)
+        {
+            throw std::runtime_error("Waiting for a fence value that was never signaled");
+        }
+        if (value > m_fenceCompleted)
+        {
+            m_stats.blockingWaitCount++;
+            completeFence(value);
+        }
+    }
+
+    void NullDevice::completeFence(uint64_t value)
+    {
+        if (value <= m_fenceCompleted)
+        {
+            return;
+        }
+        m_fenceCompleted = value;
+        m_releaseQueue.releaseCompleted(m_fenceCompleted);
+    }
+
+    NullObject* NullDevice::getObject(CommandHandle handle) const
+    {
+        std::lock_guard<std::mutex> lock(m_objectMutex);
+        return handle < m_objects.size() ? m_objects[handle] : nullptr;
+    }
+
+    NullObjectStats NullDevice::getObjectStats(NullObjectType type) const
+    {
+        std::lock_guard<std::mutex> lock(m_objectMutex);
+        return m_objectStats[static_cast<size_t>(type)];
+    }
+
+    uint32_t NullDevice::getLiveObjectCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_objectMutex);
+        uint32_t liveCount = 0;
+        for (const NullObjectStats& stats : m_objectStats)
+        {
+            liveCount += stats.liveCount;
+        }
+        return liveCount;
+    }
+
+    std::string NullDevice::buildLeakReport() const
+    {
+        std::lock_guard<std::mutex> lock(m_objectMutex);
+        std::string report;
+        for (const NullObject* object : m_objects)
+        {
+            if (object == nullptr)
+            {
+                continue;
+            }
+            report += getNullObjectTypeName(object->getType());
+            report += " #";
+            report += std::to_string(object->getHandle());
+            report += " '";
+            report += object->getName();
+            report += "'\n";
+        }
+        return report;
+    }
+
+    CommandHandle NullDevice::registerObject(NullObject* object)
+    {
+        std::lock_guard<std::mutex> lock(m_objectMutex);
+
+        CommandHandle handle = 0;
+        if (!m_freeHandles.empty())
+        {
+            handle = m_freeHandles.back();
+            m_freeHandles.pop_back();
+            m_objects[handle] = object;
+        }
+        else
+        {
+            handle = static_cast<CommandHandle>(m_objects.size());
+            m_objects.push_back(object);
+        }
+
+        NullObjectStats& stats = m_objectStats[static_cast<size_t>(object->getType())];
+        stats.createdCount++;
+        stats.liveCount++;
+        stats.peakCount = std::max(stats.peakCount, stats.liveCount);
+        return handle;
+    }
+
+    void NullDevice::unregisterObject(const NullObject* object)
+    {
+        std::lock_guard<std::mutex> lock(m_objectMutex);
+
+        m_objects[object->getHandle()] = nullptr;
+        m_freeHandles.push_back(object->getHandle());
+
+        NullObjectStats& stats = m_objectStats[static_cast<size_t>(object->getType())];
+        stats.destroyedCount++;
+        stats.liveCount--;
+    }
+
+    uint64_t NullDevice::allocateGpuRange(uint64_t sizeInBytes)
+    {
+        std::lock_guard<std::mutex> lock(m_objectMutex);
+
+        // Address 0 stays invalid, as on a GPU
+        const uint64_t address = m_nextGpuAddress + GpuAddressAlignment;
+        m_nextGpuAddress += (std::max<uint64_t>(sizeInBytes, 1) + GpuAddressAlignment - 1) / GpuAddressAlignment * GpuAddressAlignment;
+        return address;
+    }
+} // namespace raphael
@@ -0,0 +1,214 @@
+#pragma once
+#include "ResourceStateTracker.h"
+#include "CommandStream.h"
+#include "DeferredReleaseQueue.h"
+#include "MemoryTracker.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace raphael
+{
+    class NullDevice;
+    class NullCommandList;
+
+    enum class NullObjectType : uint8_t
+    {
+        Resource,
+        Pipeline,
+        RootSignature,
+        DescriptorHeap,
+        CommandList,
+        Count
+    };
+
+    const char* getNullObjectTypeName(NullObjectType type);
+
+    struct NullObjectStats
+    {
+        uint64_t createdCount = 0;
+        uint64_t destroyedCount = 0;
+        uint32_t liveCount = 0;
+        uint32_t peakCount = 0;
+    };
+
+    struct NullDeviceStats
+    {
+        uint64_t executeCount = 0;      // executeCommandLists() calls
+        uint64_t executedListCount = 0;
+        uint64_t fixupCount = 0;        // Transitions a GPU backend would insert in front of a list at submit
+        uint64_t fixupListCount = 0;    // Lists that needed them
+        uint64_t signalCount = 0;
+        uint64_t blockingWaitCount = 0; // waitForFence() calls that had to wait for the simulated GPU
+    };
+
+    struct NullDeviceDesc
+    {
+        // Fence values the simulated GPU trails the last signal by, waits catch it up. 0 completes work on signal.
+        uint32_t fenceLatency = 0;
+    };
+
+    struct NullResourceDesc
+    {
+        const char* name = nullptr;
+        uint64_t sizeInBytes = 0;
+        MemoryCategory category = MemoryCategory::Other;
+        ResourceState initialState = ResourceState::Common;
+    };
+
+    struct NullDescriptorHeapDesc
+    {
+        const char* name = nullptr;
+        uint32_t descriptorCount = 0;
+        bool shaderVisible = false;
+    };
+
+    // Every null object is registered with its device from construction to destruction, under a handle
+    // that doubles as its command stream handle
+    class NullObject
+    {
+    public:
+        NullObject(NullDevice* device, NullObjectType type, const char* name);
+        virtual ~NullObject();
+
+        NullObject(const NullObject& rhs) = delete;
+        NullObject& operator=(const NullObject& rhs) = delete;
+
+        NullObjectType getType() const { return m_type; }
+        CommandHandle getHandle() const { return m_handle; }
+        const std::string& getName() const { return m_name; }
+        NullDevice* getDevice() const { return m_device; }
+
+    private:
+        NullDevice* m_device = nullptr;
+        NullObjectType m_type = NullObjectType::Count;
+        CommandHandle m_handle = 0;
+        std::string m_name;
+    };
+
+    // Buffer or texture without memory. It gets a fake GPU address range and is accounted in the device's
+    // MemoryTracker, so frame logic that binds, transitions and budgets it runs unchanged.
+    class NullResource : public NullObject
+    {
+    public:
+        NullResource(NullDevice* device, const NullResourceDesc& desc);
+        ~NullResource() override;
+
+        const NullResourceDesc& getDesc() const { return m_desc; }
+        uint64_t getGpuAddress() const { return m_gpuAddress; }
+        TrackedResourceState* getTrackedState() { return &m_trackedState; }
+
+    private:
+        NullResourceDesc m_desc = {};
+        uint64_t m_gpuAddress = 0;
+        uint32_t m_memoryHandle = MemoryTracker::InvalidHandle;
+        TrackedResourceState m_trackedState;
+    };
+
+    class NullPipeline : public NullObject
+    {
+    public:
+        NullPipeline(NullDevice* device, const char* name) : NullObject(device, NullObjectType::Pipeline, name) {}
+    };
+
+    class NullRootSignature : public NullObject
+    {
+    public:
+        NullRootSignature(NullDevice* device, const char* name) : NullObject(device, NullObjectType::RootSignature, name) {}
+    };
+
+    class NullDescriptorHeap : public NullObject
+    {
+    public:
+        NullDescriptorHeap(NullDevice* device, const NullDescriptorHeapDesc& desc);
+        ~NullDescriptorHeap() override;
+
+        const NullDescriptorHeapDesc& getDesc() const { return m_desc; }
+        // Fake GPU descriptor handle of a slot, distinct per heap and slot
+        uint64_t getGpuHandle(uint32_t index) const;
+
+    private:
+        NullDescriptorHeapDesc m_desc = {};
+        uint64_t m_gpuBase = 0;
+        uint32_t m_memoryHandle = MemoryTracker::InvalidHandle;
+    };
+
+    // Device without a GPU for running the CPU side of a frame headless: profiling, benchmarks and leak checks
+    // on machines without D3D12. It mirrors DeviceDx12: objects are created through it, command lists filter
+    // redundant state and track resource states with the same code as CommandList, executeCommandLists()
+    // resolves the lists' states in submission order and counts the fix-ups a GPU backend would insert, and
+    // fences and deferred releases follow a simulated GPU that trails the CPU by a configurable number of
+    // fence values. Every live object is registered, buildLeakReport() names the ones still alive.
+    // Backend independent. Objects may be created and destroyed from any thread.
+    class NullDevice
+    {
+    public:
+        explicit NullDevice(const NullDeviceDesc& desc = {});
+        ~NullDevice();
+
+        NullDevice(const NullDevice& rhs) = delete;
+        NullDevice& operator=(const NullDevice& rhs) = delete;
+
+        std::unique_ptr<NullResource> createResource(const NullResourceDesc& desc);
+        std::unique_ptr<NullPipeline> createPipeline(const char* name);
+        std::unique_ptr<NullRootSignature> createRootSignature(const char* name);
+        std::unique_ptr<NullDescriptorHeap> createDescriptorHeap(const NullDescriptorHeapDesc& desc);
+        std::unique_ptr<NullCommandList> createCommandList(const char* name);
+
+        void executeCommandList(NullCommandList* commandList);
+        // Lists must be closed. Resolves each list's resource states in order, as DeviceDx12 does
+        void executeCommandLists(NullCommandList* const* commandLists, uint32_t count);
+
+        void signalFence(uint64_t value);
+        void waitForFence(uint64_t value);
+        uint64_t getNextFenceValue() { return ++m_fenceLastSignaled; }
+        uint64_t getCompletedFenceValue() const { return m_fenceCompleted; }
+
+        // Destroys object once the simulated GPU passes the next fence signal
+        template<typename T>
+        void retire(std::unique_ptr<T> object)
+        {
+            m_releaseQueue.retire(std::move(object), m_fenceLastSignaled + 1);
+        }
+        const DeferredReleaseQueue& getReleaseQueue() const { return m_releaseQueue; }
+
+        // Object registered under handle, null once it is destroyed
+        NullObject* getObject(CommandHandle handle) const;
+        NullObjectStats getObjectStats(NullObjectType type) const;
+        uint32_t getLiveObjectCount() const;
+        // One line per live object, empty when nothing leaked
+        std::string buildLeakReport() const;
+
+        const NullDeviceStats& getStats() const { return m_stats; }
+        MemoryTracker& getMemoryTracker() { return m_memoryTracker; }
+        const MemoryTracker& getMemoryTracker() const { return m_memoryTracker; }
+
+    private:
+        friend class NullObject;
+        friend class NullResource;
+        friend class NullDescriptorHeap;
+
+        CommandHandle registerObject(NullObject* object);
+        void unregisterObject(const NullObject* object);
+        uint64_t allocateGpuRange(uint64_t sizeInBytes);
+        void completeFence(uint64_t value);
+
+    private:
+        NullDeviceDesc m_desc = {};
+        MemoryTracker m_memoryTracker; // Declared first so it outlives every tracked object the device owns
+
+        mutable std::mutex m_objectMutex;
+        std::vector<NullObject*> m_objects; // Indexed by handle
+        std::vector<CommandHandle> m_freeHandles;
+        NullObjectStats m_objectStats[static_cast<size_t>(NullObjectType::Count)] = {};
+        uint64_t m_nextGpuAddress = 0;
+
+        uint64_t m_fenceLastSignaled = 0;
+        uint64_t m_fenceCompleted = 0;
+        DeferredReleaseQueue m_releaseQueue;
+        std::vector<ResourceTransition> m_fixupTransitions;
+        NullDeviceStats m_stats;
+    };
+} // namespace raphael
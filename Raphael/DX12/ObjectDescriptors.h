@@ -1,14 +1,18 @@
 #pragma once
 #include "Constants.h"
 #include "D3D12CommonHeaders.h"
+#include "MemoryTracker.h"
 
 namespace raphael
 {
+    class ResourceDx12;
 
     // Device initialization
     struct DeviceDesc {
         const char* applicationName = nullptr;
         bool enableDebugLayer = false;
+        UINT64 uploadRingSize = 4 * 1024 * 1024; // Size of the per-frame constant upload ring in bytes
+        UINT64 heapBlockSize = 64 * 1024 * 1024; // Size of each heap that placed resources are sub-allocated from
     };
 
     struct ResourceDesc {
@@ -30,6 +34,10 @@ namespace raphael
 
         ResourceFormat format = ResourceFormat::Unknown; // TODO: make this generic not tied to DXGI
         ResourceBindFlags bindFlags = ResourceBindFlags::None;
+
+        // Memory accounting. Unknown picks a category from the usage and bind flags
+        MemoryCategory memoryCategory = MemoryCategory::Unknown;
+        const char* debugName = nullptr;
     };
 
     struct ResourceView {
@@ -224,7 +232,7 @@ namespace raphael
         // Render targets
         ResourceView rtvHandles[8] = {}; // Support up to 8 render targets
         UINT numRenderTargets = 0;
-        ID3D12Resource* renderTargetResources[8] = {}; // Corresponding resources for the render targets
+        ResourceDx12* renderTargetResources[8] = {}; // Corresponding resources, their states are tracked by the command list
 
         // Depth stencil
         ResourceView dsvHandle = {};
@@ -245,7 +253,7 @@ namespace raphael
         // Builder for a single render target with depth stencil
         static RenderPassDesc buildAsSingleRenderTarget(
             ResourceView& rtvHandle,
-            ID3D12Resource* rtvResource,
+            ResourceDx12* rtvResource,
             ResourceView& dsvHandle,
             UINT width, UINT height,
             const float clearColor[4] = nullptr,
@@ -0,0 +1,633 @@
+#include "OcclusionCulling.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+// MSVC accepts AVX2 intrinsics in any function, the path only runs after the CPU check
+#define RAPHAEL_TARGET_AVX2
+#else
+#define RAPHAEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#define RAPHAEL_OCCLUSION_AVX2 1
+#endif
+
+namespace raphael
+{
+    namespace
+    {
+        constexpr uint32_t TilePixelCount = OcclusionTileWidth * OcclusionTileHeight;
+        // Triangles are clipped where they leave the screen by this factor in NDC, so edge functions keep their
+        // precision without clipping most of the triangles that merely cross the border
+        constexpr float GuardBand = 2.0f;
+        // Near plane and the four guard band planes, a triangle gains at most one vertex per plane
+        constexpr uint32_t ClipPlaneCount = 5;
+        constexpr uint32_t MaxClippedVertices = 3 + ClipPlaneCount;
+
+        // Corners are numbered by bits: 1 selects max x, 2 max y, 4 max z. Each face is wound clockwise seen
+        // from outside the box.
+        constexpr uint32_t BoxTriangleIndices[36] =
+        {
+            2, 3, 1, 2, 1, 0, // -z
+            7, 6, 4, 7, 4, 5, // +z
+            6, 2, 0, 6, 0, 4, // -x
+            3, 7, 5, 3, 5, 1, // +x
+            5, 4, 0, 5, 0, 1, // -y
+            6, 7, 3, 6, 3, 2, // +y
+        };
+
+        struct ClipVertex
+        {
+            float x, y, z, w;
+        };
+
+        void transformPoint(const float* matrix, const float* point, float* outClip)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                outClip[column] = point[0] * matrix[column] + point[1] * matrix[4 + column] + point[2] * matrix[8 + column] + matrix[12 + column];
+            }
+        }
+
+        // Row-vector product, a then b
+        void multiplyMatrices(const float* a, const float* b, float* outMatrix)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    outMatrix[row * 4 + column] = a[row * 4] * b[column] + a[row * 4 + 1] * b[4 + column] + a[row * 4 + 2] * b[8 + column] + a[row * 4 + 3] * b[12 + column];
+                }
+            }
+        }
+
+        // Signed distance to clip plane p, inside when >= 0
+        float clipDistance(const ClipVertex& vertex, uint32_t plane)
+        {
+            switch (plane)
+            {
+            case 0: return vertex.z;
+            case 1: return GuardBand * vertex.w + vertex.x;
+            case 2: return GuardBand * vertex.w - vertex.x;
+            case 3: return GuardBand * vertex.w + vertex.y;
+            default: return GuardBand * vertex.w - vertex.y;
+            }
+        }
+
+        uint32_t clipPolygon(const ClipVertex* vertices, uint32_t count, uint32_t plane, ClipVertex* outVertices)
+        {
+            uint32_t outCount = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const ClipVertex& current = vertices[i];
+                const ClipVertex& next = vertices[(i + 1) % count];
+                const float currentDistance = clipDistance(current, plane);
+                const float nextDistance = clipDistance(next, plane);
+                if (currentDistance >= 0.0f)
+                {
+                    outVertices[outCount++] = current;
+                }
+                if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+                {
+                    const float t = currentDistance / (currentDistance - nextDistance);
+                    outVertices[outCount++] =
+                    {
+                        current.x + (next.x - current.x) * t,
+                        current.y + (next.y - current.y) * t,
+                        current.z + (next.z - current.z) * t,
+                        current.w + (next.w - current.w) * t,
+                    };
+                }
+            }
+            return outCount;
+        }
+
+        // Tile (tileX, tileY) lies outside one of the triangle's edges, judged at the pixel center that edge
+        // favours most. Shared by both rasterizers so they skip the same tiles.
+        bool tileOutsideTriangle(const OccluderTriangle& triangle, uint32_t tileX, uint32_t tileY)
+        {
+            const float left = static_cast<float>(tileX * OcclusionTileWidth) + 0.5f;
+            const float top = static_cast<float>(tileY * OcclusionTileHeight) + 0.5f;
+            const float right = left + static_cast<float>(OcclusionTileWidth - 1);
+            const float bottom = top + static_cast<float>(OcclusionTileHeight - 1);
+            for (int edge = 0; edge < 3; ++edge)
+            {
+                const float x = triangle.edgeA[edge] > 0.0f ? right : left;
+                const float y = triangle.edgeB[edge] > 0.0f ? bottom : top;
+                if (triangle.edgeA[edge] * (x - triangle.vertexX[edge]) + triangle.edgeB[edge] * (y - triangle.vertexY[edge]) < 0.0f)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Writes the triangle into one tile and returns the tile's new farthest depth
+        float rasterizeTileScalar(const OccluderTriangle& triangle, uint32_t tileX, uint32_t tileY, float* tileDepth)
+        {
+            float maxDepth = 0.0f;
+            for (uint32_t row = 0; row < OcclusionTileHeight; ++row)
+            {
+                const float y = static_cast<float>(tileY * OcclusionTileHeight + row) + 0.5f;
+                for (uint32_t lane = 0; lane < OcclusionTileWidth; ++lane)
+                {
+                    // Same operation order as the SIMD path, so both round alike
+                    const float x = static_cast<float>(tileX * OcclusionTileWidth) + (static_cast<float>(lane) + 0.5f);
+                    bool covered = true;
+                    for (int edge = 0; edge < 3; ++edge)
+                    {
+                        covered &= triangle.edgeA[edge] * (x - triangle.vertexX[edge]) + triangle.edgeB[edge] * (y - triangle.vertexY[edge]) >= 0.0f;
+                    }
+                    const float depth = triangle.depthDx * (x - triangle.vertexX[0]) + triangle.depthDy * (y - triangle.vertexY[0]) + triangle.depth0;
+                    float& pixel = tileDepth[row * OcclusionTileWidth + lane];
+                    if (covered && depth < pixel)
+                    {
+                        pixel = depth;
+                    }
+                    maxDepth = std::max(maxDepth, pixel);
+                }
+            }
+            return maxDepth;
+        }
+
+        // Any pixel of the tile inside columns [firstX, lastX] and rows [firstY, lastY], tile relative, at or beyond depth
+        bool tileReachesDepthScalar(const float* tileDepth, uint32_t firstX, uint32_t lastX, uint32_t firstY, uint32_t lastY, float depth)
+        {
+            for (uint32_t row = firstY; row <= lastY; ++row)
+            {
+                for (uint32_t lane = firstX; lane <= lastX; ++lane)
+                {
+                    if (tileDepth[row * OcclusionTileWidth + lane] >= depth)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+#if RAPHAEL_OCCLUSION_AVX2
+        RAPHAEL_TARGET_AVX2
+        float rasterizeTileAvx2(const OccluderTriangle& triangle, uint32_t tileX, uint32_t tileY, float* tileDepth)
+        {
+            const __m256 laneCenters = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+            const __m256 x = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(tileX * OcclusionTileWidth)), laneCenters);
+
+            __m256 edgeA[3], edgeB[3], offsetX[3];
+            for (int edge = 0; edge < 3; ++edge)
+            {
+                edgeA[edge] = _mm256_set1_ps(triangle.edgeA[edge]);
+                edgeB[edge] = _mm256_set1_ps(triangle.edgeB[edge]);
+                offsetX[edge] = _mm256_sub_ps(x, _mm256_set1_ps(triangle.vertexX[edge]));
+            }
+            const __m256 depthX = _mm256_mul_ps(_mm256_set1_ps(triangle.depthDx), offsetX[0]);
+            const __m256 depthDy = _mm256_set1_ps(triangle.depthDy);
+            const __m256 depth0 = _mm256_set1_ps(triangle.depth0);
+            const __m256 zero = _mm256_setzero_ps();
+
+            __m256 maxDepth = zero;
+            for (uint32_t row = 0; row < OcclusionTileHeight; ++row)
+            {
+                const float y = static_cast<float>(tileY * OcclusionTileHeight + row) + 0.5f;
+                __m256 covered = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int edge = 0; edge < 3; ++edge)
+                {
+                    const __m256 offsetY = _mm256_set1_ps(y - triangle.vertexY[edge]);
+                    const __m256 distance = _mm256_add_ps(_mm256_mul_ps(edgeA[edge], offsetX[edge]), _mm256_mul_ps(edgeB[edge], offsetY));
+                    covered = _mm256_and_ps(covered, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+                }
+                const __m256 depth = _mm256_add_ps(_mm256_add_ps(depthX, _mm256_mul_ps(depthDy, _mm256_set1_ps(y - triangle.vertexY[0]))), depth0);
+
+                float* pixels = tileDepth + row * OcclusionTileWidth;
+                const __m256 current = _mm256_loadu_ps(pixels);
+                const __m256 nearer = _mm256_and_ps(covered, _mm256_cmp_ps(depth, current, _CMP_LT_OQ));
+                const __m256 updated = _mm256_blendv_ps(current, depth, nearer);
+                _mm256_storeu_ps(pixels, updated);
+                maxDepth = _mm256_max_ps(maxDepth, updated);
+            }
+
+            __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(maxDepth), _mm256_extractf128_ps(maxDepth, 1));
+            max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+            max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 1));
+            return _mm_cvtss_f32(max4);
+        }
+
+        RAPHAEL_TARGET_AVX2
+        bool tileReachesDepthAvx2(const float* tileDepth, uint32_t firstX, uint32_t lastX, uint32_t firstY, uint32_t lastY, float depth)
+        {
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256i inColumns = _mm256_and_si256(
+                _mm256_cmpgt_epi32(lanes, _mm256_set1_epi32(static_cast<int>(firstX) - 1)),
+                _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(lastX) + 1), lanes));
+            const __m256 threshold = _mm256_set1_ps(depth);
+
+            __m256 reached = _mm256_setzero_ps();
+            for (uint32_t row = firstY; row <= lastY; ++row)
+            {
+                reached = _mm256_or_ps(reached, _mm256_cmp_ps(_mm256_loadu_ps(tileDepth + row * OcclusionTileWidth), threshold, _CMP_GE_OQ));
+            }
+            return _mm256_movemask_ps(_mm256_and_ps(reached, _mm256_castsi256_ps(inColumns))) != 0;
+        }
+#endif
+    } // namespace
+
+    OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+    {
+        m_hasAvx2 = cpuSupportsAvx2();
+        m_useAvx2 = m_hasAvx2;
+        resize(width, height);
+    }
+
+    void OcclusionCuller::resize(uint32_t width, uint32_t height)
+    {
+        if (width == 0 || height == 0)
+        {
+            throw std::runtime_error("Occlusion buffer size must be non-zero");
+        }
+
+        m_tilesX = (width + OcclusionTileWidth - 1) / OcclusionTileWidth;
+        m_tilesY = (height + OcclusionTileHeight - 1) / OcclusionTileHeight;
+        m_width = m_tilesX * OcclusionTileWidth;
+        m_height = m_tilesY * OcclusionTileHeight;
+        m_depth.assign(static_cast<size_t>(m_tilesX) * m_tilesY * TilePixelCount, 1.0f);
+        m_tileMaxDepth.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 1.0f);
+        m_triangles.clear();
+    }
+
+    void OcclusionCuller::beginFrame(const float* viewProjection)
+    {
+        std::memcpy(m_viewProjection, viewProjection, sizeof(m_viewProjection));
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+        std::fill(m_tileMaxDepth.begin(), m_tileMaxDepth.end(), 1.0f);
+        m_triangles.clear();
+        m_stats.occluderTriangleCount = 0;
+        m_stats.rasterizedTriangleCount = 0;
+    }
+
+    void OcclusionCuller::addOccluderMesh(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+        const float* world, bool cullBackFaces)
+    {
+        if (indexCount % 3 != 0)
+        {
+            throw std::runtime_error("Occluder index count must be a multiple of 3");
+        }
+
+        float worldViewProjection[16];
+        if (world)
+        {
+            multiplyMatrices(world, m_viewProjection, worldViewProjection);
+        }
+        const float* matrix = world ? worldViewProjection : m_viewProjection;
+
+        // Every vertex is transformed once, triangles share them through the indices
+        m_clipVertices.resize(static_cast<size_t>(vertexCount) * 4);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            transformPoint(matrix, positions + i * 3, &m_clipVertices[i * 4]);
+        }
+
+        for (uint32_t i = 0; i < indexCount; i += 3)
+        {
+            if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+            {
+                throw std::runtime_error("Occluder index out of range");
+            }
+            addTriangle(&m_clipVertices[indices[i] * 4], &m_clipVertices[indices[i + 1] * 4], &m_clipVertices[indices[i + 2] * 4], cullBackFaces);
+        }
+        m_stats.occluderTriangleCount += indexCount / 3;
+    }
+
+    void OcclusionCuller::addOccluderBox(const float boundsMin[3], const float boundsMax[3])
+    {
+        float corners[8][4];
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            const float position[3] =
+            {
+                (corner & 1) ? boundsMax[0] : boundsMin[0],
+                (corner & 2) ? boundsMax[1] : boundsMin[1],
+                (corner & 4) ? boundsMax[2] : boundsMin[2],
+            };
+            transformPoint(m_viewProjection, position, corners[corner]);
+        }
+
+        for (uint32_t i = 0; i < 36; i += 3)
+        {
+            addTriangle(corners[BoxTriangleIndices[i]], corners[BoxTriangleIndices[i + 1]], corners[BoxTriangleIndices[i + 2]], true);
+        }
+        m_stats.occluderTriangleCount += 12;
+    }
+
+    void OcclusionCuller::addTriangle(const float* clip0, const float* clip1, const float* clip2, bool cullBackFaces)
+    {
+        ClipVertex polygon[2][MaxClippedVertices] =
+        {
+            { { clip0[0], clip0[1], clip0[2], clip0[3] }, { clip1[0], clip1[1], clip1[2], clip1[3] }, { clip2[0], clip2[1], clip2[2], clip2[3] } },
+        };
+        uint32_t vertexCount = 3;
+        uint32_t current = 0;
+        for (uint32_t plane = 0; plane < ClipPlaneCount; ++plane)
+        {
+            const float distance0 = clipDistance(polygon[current][0], plane);
+            const float distance1 = clipDistance(polygon[current][1], plane);
+            const float distance2 = clipDistance(polygon[current][2], plane);
+            if (vertexCount == 3 && distance0 >= 0.0f && distance1 >= 0.0f && distance2 >= 0.0f)
+            {
+                continue;
+            }
+            vertexCount = clipPolygon(polygon[current], vertexCount, plane, polygon[current ^ 1]);
+            current ^= 1;
+            if (vertexCount < 3)
+            {
+                return;
+            }
+        }
+
+        // The near plane keeps w positive, the guard band keeps the screen coordinates small
+        const float width = static_cast<float>(m_width);
+        const float height = static_cast<float>(m_height);
+        float screenX[MaxClippedVertices];
+        float screenY[MaxClippedVertices];
+        float screenZ[MaxClippedVertices];
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            const ClipVertex& vertex = polygon[current][i];
+            const float inverseW = 1.0f / vertex.w;
+            screenX[i] = (vertex.x * inverseW * 0.5f + 0.5f) * width;
+            screenY[i] = (0.5f - vertex.y * inverseW * 0.5f) * height;
+            screenZ[i] = vertex.z * inverseW;
+        }
+
+        // Clipping keeps the polygon convex and its winding, a fan splits it back into triangles
+        for (uint32_t i = 1; i + 1 < vertexCount; ++i)
+        {
+            uint32_t v[3] = { 0, i, i + 1 };
+            float area = (screenX[v[1]] - screenX[v[0]]) * (screenY[v[2]] - screenY[v[0]]) - (screenX[v[2]] - screenX[v[0]]) * (screenY[v[1]] - screenY[v[0]]);
+            if (!(area != 0.0f) || (cullBackFaces && area < 0.0f))
+            {
+                continue;
+            }
+            if (area < 0.0f)
+            {
+                std::swap(v[1], v[2]);
+                area = -area;
+            }
+
+            const float minX = std::min({ screenX[v[0]], screenX[v[1]], screenX[v[2]] });
+            const float maxX = std::max({ screenX[v[0]], screenX[v[1]], screenX[v[2]] });
+            const float minY = std::min({ screenY[v[0]], screenY[v[1]], screenY[v[2]] });
+            const float maxY = std::max({ screenY[v[0]], screenY[v[1]], screenY[v[2]] });
+            // Pixels whose centers fall inside the bounding box
+            const float firstPixelX = std::max(std::ceil(minX - 0.5f), 0.0f);
+            const float lastPixelX = std::min(std::floor(maxX - 0.5f), width - 1.0f);
+            const float firstPixelY = std::max(std::ceil(minY - 0.5f), 0.0f);
+            const float lastPixelY = std::min(std::floor(maxY - 0.5f), height - 1.0f);
+            if (firstPixelX > lastPixelX || firstPixelY > lastPixelY)
+            {
+                continue;
+            }
+
+            OccluderTriangle triangle;
+            for (int edge = 0; edge < 3; ++edge)
+            {
+                const uint32_t start = v[edge];
+                const uint32_t end = v[(edge + 1) % 3];
+                triangle.vertexX[edge] = screenX[start];
+                triangle.vertexY[edge] = screenY[start];
+                triangle.edgeA[edge] = screenY[start] - screenY[end];
+                triangle.edgeB[edge] = screenX[end] - screenX[start];
+            }
+
+            const float deltaX1 = screenX[v[1]] - screenX[v[0]];
+            const float deltaY1 = screenY[v[1]] - screenY[v[0]];
+            const float deltaX2 = screenX[v[2]] - screenX[v[0]];
+            const float deltaY2 = screenY[v[2]] - screenY[v[0]];
+            const float deltaZ1 = screenZ[v[1]] - screenZ[v[0]];
+            const float deltaZ2 = screenZ[v[2]] - screenZ[v[0]];
+            triangle.depth0 = screenZ[v[0]];
+            triangle.depthDx = (deltaZ1 * deltaY2 - deltaZ2 * deltaY1) / area;
+            triangle.depthDy = (deltaX1 * deltaZ2 - deltaX2 * deltaZ1) / area;
+            triangle.minDepth = std::min({ screenZ[v[0]], screenZ[v[1]], screenZ[v[2]] });
+            triangle.firstTileX = static_cast<uint32_t>(firstPixelX) / OcclusionTileWidth;
+            triangle.lastTileX = static_cast<uint32_t>(lastPixelX) / OcclusionTileWidth;
+            triangle.firstTileY = static_cast<uint32_t>(firstPixelY) / OcclusionTileHeight;
+            triangle.lastTileY = static_cast<uint32_t>(lastPixelY) / OcclusionTileHeight;
+            m_triangles.push_back(triangle);
+        }
+    }
+
+    void OcclusionCuller::rasterizeOccluders()
+    {
+        rasterizeBand(0, m_tilesY);
+        m_stats.rasterizedTriangleCount = static_cast<uint32_t>(m_triangles.size());
+    }
+
+    void OcclusionCuller::rasterizeOccluders(JobSystem& jobSystem)
+    {
+        const uint32_t bandCount = (m_tilesY + OcclusionBandTileRows - 1) / OcclusionBandTileRows;
+        jobSystem.parallelFor(bandCount, 1, [this](uint32_t firstBand, uint32_t lastBand)
+        {
+            rasterizeBand(firstBand * OcclusionBandTileRows, std::min(lastBand * OcclusionBandTileRows, m_tilesY));
+        });
+        m_stats.rasterizedTriangleCount = static_cast<uint32_t>(m_triangles.size());
+    }
+
+    void OcclusionCuller::rasterizeBand(uint32_t firstTileRow, uint32_t lastTileRow)
+    {
+        for (const OccluderTriangle& triangle : m_triangles)
+        {
+            const uint32_t firstTileY = std::max(triangle.firstTileY, firstTileRow);
+            const uint32_t lastTileY = std::min(triangle.lastTileY + 1, lastTileRow);
+            for (uint32_t tileY = firstTileY; tileY < lastTileY; ++tileY)
+            {
+                for (uint32_t tileX = triangle.firstTileX; tileX <= triangle.lastTileX; ++tileX)
+                {
+                    // Nothing to write when the whole tile is already nearer than the triangle
+                    const uint32_t tile = tileY * m_tilesX + tileX;
+                    if (m_tileMaxDepth[tile] <= triangle.minDepth || tileOutsideTriangle(triangle, tileX, tileY))
+                    {
+                        continue;
+                    }
+
+                    float* tileDepth = &m_depth[static_cast<size_t>(tile) * TilePixelCount];
+#if RAPHAEL_OCCLUSION_AVX2
+                    if (m_useAvx2)
+                    {
+                        m_tileMaxDepth[tile] = rasterizeTileAvx2(triangle, tileX, tileY, tileDepth);
+                        continue;
+                    }
+#endif
+                    m_tileMaxDepth[tile] = rasterizeTileScalar(triangle, tileX, tileY, tileDepth);
+                }
+            }
+        }
+    }
+
+    bool OcclusionCuller::isVisible(const float boundsMin[3], const float boundsMax[3]) const
+    {
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minDepth = FLT_MAX;
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            const float position[3] =
+            {
+                (corner & 1) ? boundsMax[0] : boundsMin[0],
+                (corner & 2) ? boundsMax[1] : boundsMin[1],
+                (corner & 4) ? boundsMax[2] : boundsMin[2],
+            };
+            float clip[4];
+            transformPoint(m_viewProjection, position, clip);
+            if (!(clip[2] > 0.0f))
+            {
+                return true;
+            }
+            const float inverseW = 1.0f / clip[3];
+            const float x = (clip[0] * inverseW * 0.5f + 0.5f) * static_cast<float>(m_width);
+            const float y = (0.5f - clip[1] * inverseW * 0.5f) * static_cast<float>(m_height);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            minDepth = std::min(minDepth, clip[2] * inverseW);
+        }
+
+        // Every pixel the rectangle touches, even partly
+        const float firstPixelX = std::max(std::floor(minX), 0.0f);
+        const float lastPixelX = std::min(std::floor(maxX), static_cast<float>(m_width - 1));
+        const float firstPixelY = std::max(std::floor(minY), 0.0f);
+        const float lastPixelY = std::min(std::floor(maxY), static_cast<float>(m_height - 1));
+        if (firstPixelX > lastPixelX || firstPixelY > lastPixelY)
+        {
+            return false;
+        }
+
+        const uint32_t firstX = static_cast<uint32_t>(firstPixelX);
+        const uint32_t lastX = static_cast<uint32_t>(lastPixelX);
+        const uint32_t firstY = static_cast<uint32_t>(firstPixelY);
+        const uint32_t lastY = static_cast<uint32_t>(lastPixelY);
+        for (uint32_t tileY = firstY / OcclusionTileHeight; tileY <= lastY / OcclusionTileHeight; ++tileY)
+        {
+            for (uint32_t tileX = firstX / OcclusionTileWidth; tileX <= lastX / OcclusionTileWidth; ++tileX)
+            {
+                // Occluders nearer than the box everywhere in the tile
+                const uint32_t tile = tileY * m_tilesX + tileX;
+                if (m_tileMaxDepth[tile] < minDepth)
+                {
+                    continue;
+                }
+
+                const uint32_t tileLeft = tileX * OcclusionTileWidth;
+                const uint32_t tileTop = tileY * OcclusionTileHeight;
+                const uint32_t columnFirst = std::max(firstX, tileLeft) - tileLeft;
+                const uint32_t columnLast = std::min(lastX, tileLeft + OcclusionTileWidth - 1) - tileLeft;
+                const uint32_t rowFirst = std::max(firstY, tileTop) - tileTop;
+                const uint32_t rowLast = std::min(lastY, tileTop + OcclusionTileHeight - 1) - tileTop;
+                const float* tileDepth = &m_depth[static_cast<size_t>(tile) * TilePixelCount];
+#if RAPHAEL_OCCLUSION_AVX2
+                if (m_useAvx2)
+                {
+                    if (tileReachesDepthAvx2(tileDepth, columnFirst, columnLast, rowFirst, rowLast, minDepth))
+                    {
+                        return true;
+                    }
+                    continue;
+                }
+#endif
+                if (tileReachesDepthScalar(tileDepth, columnFirst, columnLast, rowFirst, rowLast, minDepth))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    uint32_t OcclusionCuller::cullOccluded(const CullingBounds& bounds, const uint32_t* candidateIndices, uint32_t candidateCount, uint32_t* outVisibleIndices)
+    {
+        m_stats.testedCount = candidateCount;
+        m_stats.visibleCount = cullRange(bounds, candidateIndices, 0, candidateCount, outVisibleIndices);
+        return m_stats.visibleCount;
+    }
+
+    uint32_t OcclusionCuller::cullOccluded(JobSystem& jobSystem, const CullingBounds& bounds, const uint32_t* candidateIndices, uint32_t candidateCount,
+        uint32_t* outVisibleIndices)
+    {
+        const uint32_t blockCount = (candidateCount + OcclusionBlockSize - 1) / OcclusionBlockSize;
+        if (blockCount <= 1)
+        {
+            return cullOccluded(bounds, candidateIndices, candidateCount, outVisibleIndices);
+        }
+
+        // Grows to the largest block count seen, then stays
+        if (m_blockVisibleCounts.size() < blockCount)
+        {
+            m_blockVisibleCounts.resize(blockCount);
+        }
+
+        uint32_t* blockVisibleCounts = m_blockVisibleCounts.data();
+        jobSystem.parallelFor(blockCount, 1, [&](uint32_t firstBlock, uint32_t lastBlock)
+        {
+            for (uint32_t block = firstBlock; block < lastBlock; ++block)
+            {
+                const uint32_t begin = block * OcclusionBlockSize;
+                const uint32_t end = std::min(begin + OcclusionBlockSize, candidateCount);
+                blockVisibleCounts[block] = cullRange(bounds, candidateIndices, begin, end, outVisibleIndices + begin);
+            }
+        });
+
+        // Same compaction as FrustumCuller: every block starts at or after the compacted end
+        uint32_t visibleCount = 0;
+        for (uint32_t block = 0; block < blockCount; ++block)
+        {
+            const uint32_t begin = block * OcclusionBlockSize;
+            if (visibleCount != begin)
+            {
+                std::memmove(outVisibleIndices + visibleCount, outVisibleIndices + begin, blockVisibleCounts[block] * sizeof(uint32_t));
+            }
+            visibleCount += blockVisibleCounts[block];
+        }
+
+        m_stats.testedCount = candidateCount;
+        m_stats.visibleCount = visibleCount;
+        return visibleCount;
+    }
+
+    uint32_t OcclusionCuller::cullRange(const CullingBounds& bounds, const uint32_t* candidateIndices, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices) const
+    {
+        // Writes never pass the candidate being read, so the output may alias the candidates
+        uint32_t visibleCount = 0;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const uint32_t object = candidateIndices[i];
+            const float radius = bounds.getRadius()[object];
+            const float extentX = bounds.getExtentX()[object] + radius;
+            const float extentY = bounds.getExtentY()[object] + radius;
+            const float extentZ = bounds.getExtentZ()[object] + radius;
+            const float centerX = bounds.getCenterX()[object];
+            const float centerY = bounds.getCenterY()[object];
+            const float centerZ = bounds.getCenterZ()[object];
+            const float boundsMin[3] = { centerX - extentX, centerY - extentY, centerZ - extentZ };
+            const float boundsMax[3] = { centerX + extentX, centerY + extentY, centerZ + extentZ };
+            if (isVisible(boundsMin, boundsMax))
+            {
+                outVisibleIndices[visibleCount++] = object;
+            }
+        }
+        return visibleCount;
+    }
+
+    float OcclusionCuller::getDepth(uint32_t x, uint32_t y) const
+    {
+        if (x >= m_width || y >= m_height)
+        {
+            throw std::runtime_error("Occlusion buffer pixel out of range");
+        }
+
+        const uint32_t tile = (y / OcclusionTileHeight) * m_tilesX + x / OcclusionTileWidth;
+        return m_depth[static_cast<size_t>(tile) * TilePixelCount + (y % OcclusionTileHeight) * OcclusionTileWidth + x % OcclusionTileWidth];
+    }
+} // namespace raphael
@@ -0,0 +1,121 @@
+#pragma once
+#include "FrustumCulling.h"
+#include <cstdint>
+#include <vector>
+
+namespace raphael
+{
+    class JobSystem;
+
+    // Depth buffer tiles, one 8-wide SIMD row per line of pixels
+    constexpr uint32_t OcclusionTileWidth = 8;
+    constexpr uint32_t OcclusionTileHeight = 4;
+    // Tile rows one parallel rasterization job owns
+    constexpr uint32_t OcclusionBandTileRows = 4;
+    // Occludees one parallel test job checks
+    constexpr uint32_t OcclusionBlockSize = 256;
+
+    // Occluder triangle in screen space, wound clockwise and ready to rasterize.
+    // Pixel (x, y) is covered when edgeA[i] * (x - vertexX[i]) + edgeB[i] * (y - vertexY[i]) >= 0 for every edge i,
+    // its depth is the plane through vertex 0.
+    struct OccluderTriangle
+    {
+        float vertexX[3] = {};
+        float vertexY[3] = {};
+        float edgeA[3] = {};
+        float edgeB[3] = {};
+        float depth0 = 0.0f;
+        float depthDx = 0.0f;
+        float depthDy = 0.0f;
+        float minDepth = 0.0f;
+        uint32_t firstTileX = 0; // Tiles the bounding box touches, inclusive
+        uint32_t firstTileY = 0;
+        uint32_t lastTileX = 0;
+        uint32_t lastTileY = 0;
+    };
+
+    struct OcclusionCullerStats
+    {
+        uint32_t occluderTriangleCount = 0;   // Submitted since beginFrame
+        uint32_t rasterizedTriangleCount = 0; // Left after clipping and back face culling
+        uint32_t testedCount = 0;             // Last cullOccluded
+        uint32_t visibleCount = 0;
+    };
+
+    // Software occlusion culling on the CPU. Occluders, simplified meshes or boxes that lie inside the geometry
+    // they stand for, are rasterized into a low resolution depth buffer of 8x4 pixel tiles. Every tile also keeps
+    // the farthest depth it holds, the coarse level of the hierarchy. Occludee bounds are projected to a screen
+    // rectangle at their nearest depth: tiles whose farthest depth is nearer hide that part wholesale, the others
+    // are checked pixel by pixel.
+    // Coverage is sampled at pixel centers, so an object showing less than a buffer pixel next to an occluder's
+    // silhouette can be culled. Depth follows the projection, 0 near and 1 far, and clears to 1.
+    // Uses AVX2 when the CPU supports it, 8 pixels per instruction, and scalar loops with identical results
+    // otherwise. The job system overloads rasterize bands of OcclusionBandTileRows tile rows in parallel, each
+    // band owning its rows, and test OcclusionBlockSize occludee blocks in parallel. Steady-state frames do not
+    // allocate.
+    // Backend independent.
+    class OcclusionCuller
+    {
+    public:
+        OcclusionCuller(uint32_t width = 320, uint32_t height = 180);
+        ~OcclusionCuller() = default;
+
+        OcclusionCuller(const OcclusionCuller& rhs) = delete;
+        OcclusionCuller& operator=(const OcclusionCuller& rhs) = delete;
+
+        // Rounded up to whole tiles, clears the buffer and the occluders
+        void resize(uint32_t width, uint32_t height);
+
+        // Clears the depth buffer and the occluders. viewProjection is a row-vector matrix given as 16 floats in
+        // XMFLOAT4X4 order, as for extractFrustum.
+        void beginFrame(const float* viewProjection);
+        // Triangle list over positions (x y z per vertex), placed by a row-vector world matrix in the same layout or
+        // as is when world is null. Back faces are the ones wound counterclockwise on screen, the Direct3D default.
+        void addOccluderMesh(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+            const float* world, bool cullBackFaces);
+        // World space box, drawn without its back faces
+        void addOccluderBox(const float boundsMin[3], const float boundsMax[3]);
+        void rasterizeOccluders();
+        void rasterizeOccluders(JobSystem& jobSystem);
+
+        // False when the box is hidden behind the rasterized occluders or entirely off screen.
+        // Boxes reaching in front of the near plane are always visible.
+        bool isVisible(const float boundsMin[3], const float boundsMax[3]) const;
+        // Keeps the candidates whose bounds are visible, in order, and returns how many are left.
+        // outVisibleIndices needs candidateCount entries and may be candidateIndices itself.
+        uint32_t cullOccluded(const CullingBounds& bounds, const uint32_t* candidateIndices, uint32_t candidateCount, uint32_t* outVisibleIndices);
+        uint32_t cullOccluded(JobSystem& jobSystem, const CullingBounds& bounds, const uint32_t* candidateIndices, uint32_t candidateCount,
+            uint32_t* outVisibleIndices);
+
+        uint32_t getWidth() const { return m_width; }
+        uint32_t getHeight() const { return m_height; }
+        float getDepth(uint32_t x, uint32_t y) const;
+        const std::vector<OccluderTriangle>& getTriangles() const { return m_triangles; }
+
+        // Falls back to the scalar loops even on AVX2 hardware, to compare the two
+        void setSimdEnabled(bool enabled) { m_useAvx2 = enabled && m_hasAvx2; }
+        bool isUsingSimd() const { return m_useAvx2; }
+        const OcclusionCullerStats& getStats() const { return m_stats; }
+
+    private:
+        // Clip space vertices (x y z w), clipped against the near plane and a guard band around the screen
+        void addTriangle(const float* clip0, const float* clip1, const float* clip2, bool cullBackFaces);
+        void rasterizeBand(uint32_t firstTileRow, uint32_t lastTileRow);
+        uint32_t cullRange(const CullingBounds& bounds, const uint32_t* candidateIndices, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices) const;
+
+    private:
+        std::vector<float> m_depth;        // Tile after tile, each OcclusionTileHeight rows of OcclusionTileWidth pixels
+        std::vector<float> m_tileMaxDepth; // Farthest depth in each tile
+        std::vector<OccluderTriangle> m_triangles;
+        std::vector<float> m_clipVertices; // Scratch for addOccluderMesh
+        std::vector<uint32_t> m_blockVisibleCounts;
+        float m_viewProjection[16] = {};
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_tilesX = 0;
+        uint32_t m_tilesY = 0;
+        bool m_hasAvx2 = false;
+        bool m_useAvx2 = false;
+        OcclusionCullerStats m_stats;
+    };
+} // namespace raphael
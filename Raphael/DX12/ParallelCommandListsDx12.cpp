@@ -0,0 +1,84 @@
+#include "ParallelCommandListsDx12.h"
+#include "DeviceDx12.h"
+#include "CommandList.h"
+
+namespace raphael
+{
+    ParallelCommandListsDx12::ParallelCommandListsDx12(DeviceDx12* device, uint32_t maxListCount)
+        : m_device(device)
+    {
+        m_commandLists.resize(maxListCount);
+        m_submitLists.resize(maxListCount);
+        m_allocatorPools.resize(maxListCount);
+        m_activeAllocators.resize(maxListCount);
+    }
+
+    ParallelCommandListsDx12::~ParallelCommandListsDx12() = default;
+
+    void ParallelCommandListsDx12::begin(uint32_t listCount)
+    {
+        if (listCount > getMaxListCount())
+        {
+            throw std::runtime_error("Too many parallel command lists requested");
+        }
+
+        const UINT64 completedFenceValue = m_device->getCompletedFenceValue();
+        for (uint32_t i = 0; i < listCount; ++i)
+        {
+            m_activeAllocators[i] = m_allocatorPools[i].acquire(completedFenceValue, [this]
+            {
+                return m_device->createCommandAllocator();
+            });
+
+            if (!m_commandLists[i])
+            {
+                m_commandLists[i] = m_device->createCommandList(CommandListDesc{});
+                m_commandLists[i]->createCommandList(m_activeAllocators[i].Get());
+                m_submitLists[i] = m_commandLists[i].get();
+            }
+            m_commandLists[i]->begin(m_activeAllocators[i].Get());
+        }
+        m_listCount = listCount;
+    }
+
+    void ParallelCommandListsDx12::execute()
+    {
+        for (uint32_t i = 0; i < m_listCount; ++i)
+        {
+            if (m_commandLists[i]->isRecording())
+            {
+                m_commandLists[i]->end();
+            }
+        }
+
+        m_device->executeCommandLists(m_submitLists.data(), m_listCount);
+    }
+
+    void ParallelCommandListsDx12::finishFrame(UINT64 fenceValue)
+    {
+        for (uint32_t i = 0; i < m_listCount; ++i)
+        {
+            if (m_activeAllocators[i])
+            {
+                m_allocatorPools[i].release(std::move(m_activeAllocators[i]), fenceValue);
+            }
+        }
+    }
+
+    ParallelCommandListsStats ParallelCommandListsDx12::getStats() const
+    {
+        ParallelCommandListsStats stats = {};
+        stats.listCount = m_listCount;
+        for (const auto& pool : m_allocatorPools)
+        {
+            stats.allocatorCount += pool.getCreatedCount();
+            stats.allocatorReuseCount += pool.getReusedCount();
+        }
+        for (const auto& commandList : m_commandLists)
+        {
+            stats.stateCacheStats.issuedCount += commandList->getStateCacheStats().issuedCount;
+            stats.stateCacheStats.elidedCount += commandList->getStateCacheStats().elidedCount;
+        }
+        return stats;
+    }
+} // namespace raphael
@@ -0,0 +1,54 @@
+#pragma once
+#include "D3D12CommonHeaders.h"
+#include "FencedObjectPool.h"
+#include "CommandStateCache.h"
+
+namespace raphael
+{
+    class DeviceDx12;
+    class CommandList;
+
+    struct ParallelCommandListsStats
+    {
+        uint32_t listCount = 0;      // Lists opened by the last begin()
+        uint64_t allocatorCount = 0; // Command allocators created over the lifetime, flat once warmed up
+        uint64_t allocatorReuseCount = 0;
+        CommandStateCacheStats stateCacheStats; // Summed over every list slot, grows over the lifetime
+    };
+
+    // A set of direct command lists recorded by different threads and submitted in index order with one
+    // ExecuteCommandLists call. Every list slot owns a FencedObjectPool of command allocators: begin() takes
+    // an allocator the GPU is done with for each list, finishFrame() hands them back tagged with the fence
+    // that follows the frame. The thread recording a slot is the only one touching it between begin() and
+    // execute(), so no lock is needed.
+    class ParallelCommandListsDx12
+    {
+    public:
+        ParallelCommandListsDx12(DeviceDx12* device, uint32_t maxListCount);
+        ~ParallelCommandListsDx12();
+
+        ParallelCommandListsDx12(const ParallelCommandListsDx12& rhs) = delete;
+        ParallelCommandListsDx12& operator=(const ParallelCommandListsDx12& rhs) = delete;
+
+        // Opens listCount lists for recording, main thread only
+        void begin(uint32_t listCount);
+        CommandList* getCommandList(uint32_t index) const { return m_commandLists[index].get(); }
+        uint32_t getListCount() const { return m_listCount; }
+        uint32_t getMaxListCount() const { return static_cast<uint32_t>(m_commandLists.size()); }
+
+        // Closes the lists that are still open and submits all of them in index order
+        void execute();
+        // Call with the fence value signaled right after execute()
+        void finishFrame(UINT64 fenceValue);
+
+        ParallelCommandListsStats getStats() const;
+
+    private:
+        DeviceDx12* m_device = nullptr;
+        std::vector<std::unique_ptr<CommandList>> m_commandLists;
+        std::vector<CommandList*> m_submitLists; // Same lists as raw pointers for executeCommandLists
+        std::vector<FencedObjectPool<ComPtr<ID3D12CommandAllocator>>> m_allocatorPools;
+        std::vector<ComPtr<ID3D12CommandAllocator>> m_activeAllocators; // Allocators recorded into this frame, per slot
+        uint32_t m_listCount = 0;
+    };
+} // namespace raphael
@@ -0,0 +1,64 @@
+#include "RecordPartition.h"
+#include <algorithm>
+
+namespace raphael
+{
+    uint32_t partitionRecording(const uint32_t* costs, uint32_t itemCount, uint32_t maxRanges, uint32_t minItemsPerRange, RecordRange* outRanges)
+    {
+        if (itemCount == 0 || maxRanges == 0)
+        {
+            return 0;
+        }
+
+        const uint32_t minItems = std::max(minItemsPerRange, 1u);
+        const uint32_t rangeCount = std::clamp(itemCount / minItems, 1u, maxRanges);
+
+        uint64_t totalCost = 0;
+        if (costs != nullptr)
+        {
+            for (uint32_t i = 0; i < itemCount; ++i)
+            {
+                totalCost += costs[i];
+            }
+        }
+        // All-zero costs carry no information, balance by count instead
+        const bool uniform = (costs == nullptr || totalCost == 0);
+        if (uniform)
+        {
+            totalCost = itemCount;
+        }
+
+        uint32_t begin = 0;
+        uint64_t prefixCost = 0;
+        for (uint32_t range = 0; range < rangeCount; ++range)
+        {
+            const uint32_t rangesAfter = rangeCount - range - 1;
+            uint32_t end = itemCount;
+            if (rangesAfter > 0)
+            {
+                // Every later range still needs its minimum, every range gets at least its own
+                const uint32_t minEnd = begin + minItems;
+                const uint32_t maxEnd = itemCount - rangesAfter * minItems;
+                // Split what is left evenly, so an early heavy draw does not starve the ranges after it
+                const uint64_t targetCost = prefixCost + (totalCost - prefixCost) / (rangesAfter + 1);
+
+                end = begin;
+                while (end < maxEnd)
+                {
+                    const uint64_t cost = uniform ? 1 : costs[end];
+                    // An item goes to the range holding most of it, so one heavy draw does not drag the cut too far
+                    if (end >= minEnd && prefixCost + cost / 2 >= targetCost)
+                    {
+                        break;
+                    }
+                    prefixCost += cost;
+                    ++end;
+                }
+            }
+
+            outRanges[range] = { begin, end };
+            begin = end;
+        }
+        return rangeCount;
+    }
+} // namespace raphael
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+namespace raphael
+{
+    // Half-open range of draws [begin, end) recorded into one command list
+    struct RecordRange
+    {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+
+        uint32_t getCount() const { return end - begin; }
+    };
+
+    // Splits [0, itemCount) into at most maxRanges contiguous ranges of roughly equal cost, so command lists
+    // recorded in parallel and executed in range order keep the serial draw order.
+    // costs may be null for uniform cost (e.g. pass index counts to balance by triangle submission).
+    // No range holds fewer than minItemsPerRange items, small passes are not worth a command list.
+    // Returns the number of ranges written to outRanges, 0 only when itemCount is 0.
+    uint32_t partitionRecording(const uint32_t* costs, uint32_t itemCount, uint32_t maxRanges, uint32_t minItemsPerRange, RecordRange* outRanges);
+} // namespace raphael
@@ -0,0 +1,386 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace raphael
+{
+    uint32_t RenderGraph::createResource(const char* name)
+    {
+        Resource resource = {};
+        resource.name = name;
+        m_resources.push_back(resource);
+        return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::importResource(const char* name, ResourceState initialState, ResourceState finalState)
+    {
+        Resource resource = {};
+        resource.name = name;
+        resource.imported = true;
+        resource.initialState = initialState;
+        resource.finalState = finalState;
+        resource.firstState = initialState;
+        m_resources.push_back(resource);
+        return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::addPass(const char* name, RenderGraphPassFlags flags)
+    {
+        Pass pass = {};
+        pass.name = name;
+        pass.flags = flags;
+        m_passes.push_back(pass);
+        return static_cast<uint32_t>(m_passes.size() - 1);
+    }
+
+    void RenderGraph::read(uint32_t pass, uint32_t resource, ResourceState state)
+    {
+        addAccess(pass, resource, state, false);
+    }
+
+    void RenderGraph::write(uint32_t pass, uint32_t resource, ResourceState state)
+    {
+        addAccess(pass, resource, state, true);
+    }
+
+    void RenderGraph::addAccess(uint32_t pass, uint32_t resource, ResourceState state, bool write)
+    {
+        if (pass >= m_passes.size() || resource >= m_resources.size())
+        {
+            throw std::runtime_error("Render graph access to an unknown pass or resource");
+        }
+        m_accesses.push_back({ pass, resource, state, write });
+    }
+
+    void RenderGraph::clear()
+    {
+        m_resources.clear();
+        m_passes.clear();
+        m_accesses.clear();
+        m_executionOrder.clear();
+        m_levelStart.clear();
+        m_barriers.clear();
+        m_finalBarrierStart = 0;
+        m_stats = {};
+    }
+
+    std::span<const uint32_t> RenderGraph::getLevelPasses(uint32_t level) const
+    {
+        return std::span<const uint32_t>(m_executionOrder.data() + m_levelStart[level], m_levelStart[level + 1] - m_levelStart[level]);
+    }
+
+    std::span<const RenderGraphBarrier> RenderGraph::getPassBarriers(uint32_t pass) const
+    {
+        const Pass& entry = m_passes[pass];
+        return std::span<const RenderGraphBarrier>(m_barriers.data() + entry.barrierStart, entry.barrierCount);
+    }
+
+    std::span<const RenderGraphBarrier> RenderGraph::getFinalBarriers() const
+    {
+        return std::span<const RenderGraphBarrier>(m_barriers.data() + m_finalBarrierStart, m_barriers.size() - m_finalBarrierStart);
+    }
+
+    void RenderGraph::compile()
+    {
+        buildEdges();
+        cullPasses();
+        assignLevels();
+        computeBarriers();
+
+        m_stats.passCount = static_cast<uint32_t>(m_passes.size());
+        m_stats.culledPassCount = m_stats.passCount - static_cast<uint32_t>(m_executionOrder.size());
+        m_stats.levelCount = getLevelCount();
+        m_stats.edgeCount = static_cast<uint32_t>(m_edges.size());
+        m_stats.barrierCount = static_cast<uint32_t>(m_barriers.size());
+    }
+
+    void RenderGraph::buildEdges()
+    {
+        const uint32_t passCount = static_cast<uint32_t>(m_passes.size());
+        const uint32_t resourceCount = static_cast<uint32_t>(m_resources.size());
+
+        // Group the accesses by pass, keeping their declaration order within a pass
+        m_passAccessStart.assign(passCount + 1, 0);
+        for (const Access& access : m_accesses)
+        {
+            m_passAccessStart[access.pass + 1]++;
+        }
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            m_passAccessStart[pass + 1] += m_passAccessStart[pass];
+        }
+        m_passAccesses.resize(m_accesses.size());
+        m_stack.assign(m_passAccessStart.begin(), m_passAccessStart.end() - 1);
+        for (const Access& access : m_accesses)
+        {
+            m_passAccesses[m_stack[access.pass]++] = access;
+        }
+
+        // Walk the passes in declaration order, edges come out grouped by the pass they lead to
+        m_lastWriter.assign(resourceCount, NoPass);
+        m_readerHead.assign(resourceCount, NoPass);
+        m_readerNext.clear();
+        m_readerPass.clear();
+        m_edges.clear();
+        m_passEdgeStart.resize(passCount + 1);
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            m_passEdgeStart[pass] = static_cast<uint32_t>(m_edges.size());
+            for (uint32_t i = m_passAccessStart[pass]; i < m_passAccessStart[pass + 1]; ++i)
+            {
+                const Access& access = m_passAccesses[i];
+                const uint32_t resource = access.resource;
+                const uint32_t lastWriter = m_lastWriter[resource];
+
+                if (!access.write)
+                {
+                    if (lastWriter == NoPass && !m_resources[resource].imported)
+                    {
+                        throw std::runtime_error("Render graph pass reads a transient resource nothing wrote");
+                    }
+                    if (lastWriter != NoPass && lastWriter != pass)
+                    {
+                        m_edges.push_back({ lastWriter, true });
+                    }
+                    m_readerPass.push_back(pass);
+                    m_readerNext.push_back(m_readerHead[resource]);
+                    m_readerHead[resource] = static_cast<uint32_t>(m_readerPass.size() - 1);
+                    continue;
+                }
+
+                // Earlier readers must be done before the contents change
+                for (uint32_t reader = m_readerHead[resource]; reader != NoPass; reader = m_readerNext[reader])
+                {
+                    if (m_readerPass[reader] != pass)
+                    {
+                        m_edges.push_back({ m_readerPass[reader], false });
+                    }
+                }
+                if (lastWriter != NoPass && lastWriter != pass)
+                {
+                    // Conservatively a partial write, the previous contents are still needed
+                    m_edges.push_back({ lastWriter, true });
+                }
+                m_lastWriter[resource] = pass;
+                m_readerHead[resource] = NoPass;
+            }
+        }
+        m_passEdgeStart[passCount] = static_cast<uint32_t>(m_edges.size());
+    }
+
+    void RenderGraph::cullPasses()
+    {
+        const uint32_t passCount = static_cast<uint32_t>(m_passes.size());
+
+        // Roots: passes with outside effects and passes writing imported resources
+        m_stack.clear();
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            bool root = (static_cast<uint8_t>(m_passes[pass].flags) & static_cast<uint8_t>(RenderGraphPassFlags::NeverCull)) != 0;
+            for (uint32_t i = m_passAccessStart[pass]; i < m_passAccessStart[pass + 1] && !root; ++i)
+            {
+                root = m_passAccesses[i].write && m_resources[m_passAccesses[i].resource].imported;
+            }
+
+            m_passes[pass].level = root ? 0 : CulledLevel;
+            if (root)
+            {
+                m_stack.push_back(pass);
+            }
+        }
+
+        // Everything a live pass consumes is live
+        while (!m_stack.empty())
+        {
+            const uint32_t pass = m_stack.back();
+            m_stack.pop_back();
+            for (uint32_t i = m_passEdgeStart[pass]; i < m_passEdgeStart[pass + 1]; ++i)
+            {
+                const Edge& edge = m_edges[i];
+                if (edge.keepsAlive && m_passes[edge.from].level == CulledLevel)
+                {
+                    m_passes[edge.from].level = 0;
+                    m_stack.push_back(edge.from);
+                }
+            }
+        }
+    }
+
+    void RenderGraph::assignLevels()
+    {
+        const uint32_t passCount = static_cast<uint32_t>(m_passes.size());
+
+        // Edges always point from an earlier declared pass, so one forward sweep is a topological walk
+        uint32_t levelCount = 0;
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            if (m_passes[pass].level == CulledLevel)
+            {
+                continue;
+            }
+
+            uint32_t level = 0;
+            for (uint32_t i = m_passEdgeStart[pass]; i < m_passEdgeStart[pass + 1]; ++i)
+            {
+                const uint32_t fromLevel = m_passes[m_edges[i].from].level;
+                if (fromLevel != CulledLevel)
+                {
+                    level = std::max(level, fromLevel + 1);
+                }
+            }
+            m_passes[pass].level = level;
+            levelCount = std::max(levelCount, level + 1);
+        }
+
+        // Counting sort by level, stable so declaration order holds within a level
+        m_levelStart.assign(levelCount + 1, 0);
+        for (const Pass& pass : m_passes)
+        {
+            if (pass.level != CulledLevel)
+            {
+                m_levelStart[pass.level + 1]++;
+            }
+        }
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            m_levelStart[level + 1] += m_levelStart[level];
+        }
+        m_executionOrder.resize(m_levelStart[levelCount]);
+        m_stack.assign(m_levelStart.begin(), m_levelStart.end() - 1);
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            if (m_passes[pass].level != CulledLevel)
+            {
+                m_executionOrder[m_stack[m_passes[pass].level]++] = pass;
+            }
+        }
+    }
+
+    void RenderGraph::computeBarriers()
+    {
+        const uint32_t resourceCount = static_cast<uint32_t>(m_resources.size());
+
+        m_currentState.resize(resourceCount);
+        for (uint32_t resource = 0; resource < resourceCount; ++resource)
+        {
+            m_resources[resource].lifetime = {};
+            m_currentState[resource] = m_resources[resource].initialState;
+        }
+        m_levelReadState.resize(resourceCount);
+        m_levelReadStamp.assign(resourceCount, 0);
+        m_barriers.clear();
+
+        for (uint32_t level = 0; level < getLevelCount(); ++level)
+        {
+            const std::span<const uint32_t> levelPasses = getLevelPasses(level);
+
+            // Reads of one level never race a write of it, combine them so one transition covers them all
+            for (uint32_t pass : levelPasses)
+            {
+                for (uint32_t i = m_passAccessStart[pass]; i < m_passAccessStart[pass + 1]; ++i)
+                {
+                    const Access& access = m_passAccesses[i];
+                    if (access.write)
+                    {
+                        continue;
+                    }
+                    if (m_levelReadStamp[access.resource] != level + 1)
+                    {
+                        m_levelReadStamp[access.resource] = level + 1;
+                        m_levelReadState[access.resource] = access.state;
+                    }
+                    else
+                    {
+                        m_levelReadState[access.resource] = m_levelReadState[access.resource] | access.state;
+                    }
+                }
+            }
+
+            uint32_t position = m_levelStart[level];
+            for (uint32_t pass : levelPasses)
+            {
+                m_passes[pass].barrierStart = static_cast<uint32_t>(m_barriers.size());
+                for (uint32_t i = m_passAccessStart[pass]; i < m_passAccessStart[pass + 1]; ++i)
+                {
+                    const Access& access = m_passAccesses[i];
+                    Resource& resource = m_resources[access.resource];
+                    const ResourceState wanted = access.write ? access.state : m_levelReadState[access.resource];
+
+                    const bool firstUse = resource.lifetime.firstPass == UINT32_MAX;
+                    if (firstUse)
+                    {
+                        resource.lifetime.firstPass = position;
+                    }
+                    resource.lifetime.lastPass = position;
+
+                    if (firstUse && !resource.imported)
+                    {
+                        // Transient: created or aliased straight into the state it is first used in
+                        resource.firstState = wanted;
+                        m_currentState[access.resource] = wanted;
+                        continue;
+                    }
+
+                    ResourceState& current = m_currentState[access.resource];
+                    if (!isStateCompatible(current, access.state))
+                    {
+                        m_barriers.push_back({ access.resource, current, wanted });
+                        current = wanted;
+                    }
+                }
+                m_passes[pass].barrierCount = static_cast<uint32_t>(m_barriers.size()) - m_passes[pass].barrierStart;
+                position++;
+            }
+        }
+
+        // Imported resources are handed back in the state the rest of the frame expects
+        m_finalBarrierStart = static_cast<uint32_t>(m_barriers.size());
+        for (uint32_t resource = 0; resource < resourceCount; ++resource)
+        {
+            if (m_resources[resource].imported && m_currentState[resource] != m_resources[resource].finalState)
+            {
+                m_barriers.push_back({ resource, m_currentState[resource], m_resources[resource].finalState });
+            }
+        }
+
+        for (Pass& pass : m_passes)
+        {
+            if (pass.level == CulledLevel)
+            {
+                pass.barrierStart = 0;
+                pass.barrierCount = 0;
+            }
+        }
+    }
+
+    std::string RenderGraph::buildReport() const
+    {
+        std::ostringstream report;
+        report << "Render graph: " << m_stats.passCount << " passes, " << m_stats.culledPassCount << " culled, "
+            << m_stats.levelCount << " levels, " << m_stats.barrierCount << " barriers\n";
+
+        for (uint32_t level = 0; level < getLevelCount(); ++level)
+        {
+            report << "Level " << level << ":";
+            for (uint32_t pass : getLevelPasses(level))
+            {
+                report << " " << (m_passes[pass].name ? m_passes[pass].name : "unnamed");
+                if (m_passes[pass].barrierCount > 0)
+                {
+                    report << " (" << m_passes[pass].barrierCount << " barriers)";
+                }
+            }
+            report << "\n";
+        }
+
+        for (uint32_t pass = 0; pass < m_passes.size(); ++pass)
+        {
+            if (isPassCulled(pass))
+            {
+                report << "Culled: " << (m_passes[pass].name ? m_passes[pass].name : "unnamed") << "\n";
+            }
+        }
+        return report.str();
+    }
+} // namespace raphael
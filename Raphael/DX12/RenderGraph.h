@@ -0,0 +1,161 @@
+#pragma once
+#include "ResourceStateTracker.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace raphael
+{
+    enum class RenderGraphPassFlags : uint8_t
+    {
+        None = 0,
+        NeverCull = 1, // Has effects the graph cannot see, e.g. readbacks or UI
+    };
+
+    // Transition recorded before a pass, or after the last one for imported resources
+    struct RenderGraphBarrier
+    {
+        uint32_t resource = 0;
+        ResourceState before = ResourceState::Common;
+        ResourceState after = ResourceState::Common;
+    };
+
+    // Execution positions of the first and last pass using a resource, both inclusive
+    struct RenderGraphLifetime
+    {
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+    };
+
+    struct RenderGraphStats
+    {
+        uint32_t passCount = 0;
+        uint32_t culledPassCount = 0;
+        uint32_t levelCount = 0;
+        uint32_t edgeCount = 0;
+        uint32_t barrierCount = 0; // Including the final transitions of imported resources
+    };
+
+    // Frame graph compiler.
+    // Passes declare the resources they read and write with the state they need, in the order the frame
+    // would record them. compile() links every read to the latest earlier write (and orders writes after
+    // earlier reads and writes), culls passes nothing alive consumes, and gives each remaining pass a
+    // dependency level: passes on the same level do not depend on each other and may be recorded in
+    // parallel. Execution runs level by level, declaration order within a level. Barriers are computed
+    // along that order, the reads of one level that need the same resource in different read states share
+    // a single transition to the combined state.
+    // Writing an imported resource keeps a pass alive, imported resources start in their initial state and
+    // end in their final one. Transient resources start in the state of their first use, the owner creates or
+    // aliases them over the reported lifetime.
+    // Build once and compile when the frame's shape changes, compiling reuses the capacity of the last run.
+    // Backend independent.
+    class RenderGraph
+    {
+    public:
+        RenderGraph() = default;
+        ~RenderGraph() = default;
+
+        RenderGraph(const RenderGraph& rhs) = delete;
+        RenderGraph& operator=(const RenderGraph& rhs) = delete;
+
+        // Resources and passes are identified by the index returned here
+        uint32_t createResource(const char* name);
+        uint32_t importResource(const char* name, ResourceState initialState, ResourceState finalState);
+        uint32_t addPass(const char* name, RenderGraphPassFlags flags = RenderGraphPassFlags::None);
+        void read(uint32_t pass, uint32_t resource, ResourceState state);
+        void write(uint32_t pass, uint32_t resource, ResourceState state);
+        void clear();
+
+        void compile();
+
+        // Alive passes in execution order
+        std::span<const uint32_t> getExecutionOrder() const { return m_executionOrder; }
+        bool isPassCulled(uint32_t pass) const { return m_passes[pass].level == CulledLevel; }
+        uint32_t getPassLevel(uint32_t pass) const { return m_passes[pass].level; }
+        uint32_t getLevelCount() const { return m_levelStart.empty() ? 0 : static_cast<uint32_t>(m_levelStart.size()) - 1; }
+        // Alive passes of a level, a contiguous slice of the execution order
+        std::span<const uint32_t> getLevelPasses(uint32_t level) const;
+        std::span<const RenderGraphBarrier> getPassBarriers(uint32_t pass) const;
+        std::span<const RenderGraphBarrier> getFinalBarriers() const;
+        // Undefined for culled-only resources (firstPass stays UINT32_MAX)
+        const RenderGraphLifetime& getResourceLifetime(uint32_t resource) const { return m_resources[resource].lifetime; }
+        // State of a transient resource at its first use
+        ResourceState getResourceFirstState(uint32_t resource) const { return m_resources[resource].firstState; }
+
+        uint32_t getPassCount() const { return static_cast<uint32_t>(m_passes.size()); }
+        uint32_t getResourceCount() const { return static_cast<uint32_t>(m_resources.size()); }
+        const char* getPassName(uint32_t pass) const { return m_passes[pass].name; }
+        const char* getResourceName(uint32_t resource) const { return m_resources[resource].name; }
+        const RenderGraphStats& getStats() const { return m_stats; }
+
+        std::string buildReport() const;
+
+    private:
+        static constexpr uint32_t CulledLevel = UINT32_MAX;
+        static constexpr uint32_t NoPass = UINT32_MAX;
+
+        struct Resource
+        {
+            const char* name = nullptr;
+            bool imported = false;
+            ResourceState initialState = ResourceState::Common;
+            ResourceState finalState = ResourceState::Common;
+            ResourceState firstState = ResourceState::Common;
+            RenderGraphLifetime lifetime = {};
+        };
+
+        struct Pass
+        {
+            const char* name = nullptr;
+            RenderGraphPassFlags flags = RenderGraphPassFlags::None;
+            uint32_t level = 0;
+            uint32_t barrierStart = 0;
+            uint32_t barrierCount = 0;
+        };
+
+        struct Access
+        {
+            uint32_t pass = 0;
+            uint32_t resource = 0;
+            ResourceState state = ResourceState::Common;
+            bool write = false;
+        };
+
+        struct Edge
+        {
+            uint32_t from = 0;
+            bool keepsAlive = false; // Read after write or write after write, a write after read only orders
+        };
+
+        void addAccess(uint32_t pass, uint32_t resource, ResourceState state, bool write);
+        void buildEdges();
+        void cullPasses();
+        void assignLevels();
+        void computeBarriers();
+
+    private:
+        std::vector<Resource> m_resources;
+        std::vector<Pass> m_passes;
+        std::vector<Access> m_accesses; // In declaration order
+
+        // Compile results and scratch, all reused between compiles
+        std::vector<uint32_t> m_passAccessStart;  // Accesses grouped by pass: [start[p], start[p + 1])
+        std::vector<Access> m_passAccesses;
+        std::vector<uint32_t> m_passEdgeStart;    // Incoming edges grouped by pass
+        std::vector<Edge> m_edges;
+        std::vector<uint32_t> m_lastWriter;       // Per resource
+        std::vector<uint32_t> m_readerHead;       // Per resource: readers since the last write, linked through m_readerNext
+        std::vector<uint32_t> m_readerNext;
+        std::vector<uint32_t> m_readerPass;
+        std::vector<uint32_t> m_stack;
+        std::vector<uint32_t> m_executionOrder;
+        std::vector<uint32_t> m_levelStart;       // Levels grouped in the execution order
+        std::vector<ResourceState> m_currentState;
+        std::vector<ResourceState> m_levelReadState;
+        std::vector<uint32_t> m_levelReadStamp;
+        std::vector<RenderGraphBarrier> m_barriers;
+        uint32_t m_finalBarrierStart = 0;
+        RenderGraphStats m_stats;
+    };
+} // namespace raphael
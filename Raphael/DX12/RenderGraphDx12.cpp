@@ -0,0 +1,48 @@
+#include "RenderGraphDx12.h"
+#include "CommandList.h"
+#include "ResourceDx12.h"
+#include <stdexcept>
+
+namespace raphael
+{
+    void RenderGraphDx12::clear()
+    {
+        m_graph.clear();
+        m_resources.clear();
+        m_passes.clear();
+    }
+
+    uint32_t RenderGraphDx12::importResource(const char* name, ResourceDx12* resource, ResourceState initialState, ResourceState finalState)
+    {
+        if (resource == nullptr)
+        {
+            throw std::runtime_error("Render graph resource imported without a resource");
+        }
+
+        m_resources.push_back(resource);
+        return m_graph.importResource(name, initialState, finalState);
+    }
+
+    void RenderGraphDx12::execute(RenderGraphPassContext& context)
+    {
+        for (uint32_t pass : m_graph.getExecutionOrder())
+        {
+            recordBarriers(context.commandList, m_graph.getPassBarriers(pass));
+            context.pass = pass;
+            m_passes[pass].invoke(m_passes[pass].callable, context);
+        }
+
+        // Queued on the last list, they leave with its next command or when it is closed
+        recordBarriers(context.commandList, m_graph.getFinalBarriers());
+    }
+
+    void RenderGraphDx12::recordBarriers(CommandList* commandList, std::span<const RenderGraphBarrier> barriers)
+    {
+        for (const RenderGraphBarrier& barrier : barriers)
+        {
+            ResourceDx12* resource = m_resources[barrier.resource];
+            commandList->assumeResourceState(resource, barrier.before);
+            commandList->transitionResource(resource, barrier.after);
+        }
+    }
+} // namespace raphael
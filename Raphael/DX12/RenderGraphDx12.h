@@ -0,0 +1,71 @@
+#pragma once
+#include "RenderGraph.h"
+#include <vector>
+
+namespace raphael
+{
+    class CommandList;
+    class ResourceDx12;
+
+    // Where a pass records. A pass that spreads its work over several command lists leaves commandList on the
+    // last one it used, the passes after it continue there so submission order follows execution order.
+    struct RenderGraphPassContext
+    {
+        CommandList* commandList = nullptr;
+        uint32_t pass = 0;
+    };
+
+    // Records a RenderGraph with D3D12 resources and command lists.
+    // Imported resources are bound to ResourceDx12 objects, passes to a record callable. execute() walks the
+    // compiled order and hands each pass's barriers to the command list's state tracker with the state the
+    // graph knows the resource is in, so they leave in one barrier call in front of the pass and need no
+    // submit-time fix-up. Meant to be rebuilt every frame: clear() keeps all capacity, so building, compiling
+    // and executing a graph of the same shape does not allocate.
+    // Passes only reference their callable, it must outlive execute(). Build and execute in the same scope.
+    class RenderGraphDx12
+    {
+    public:
+        RenderGraphDx12() = default;
+        ~RenderGraphDx12() = default;
+
+        RenderGraphDx12(const RenderGraphDx12& rhs) = delete;
+        RenderGraphDx12& operator=(const RenderGraphDx12& rhs) = delete;
+
+        void clear();
+
+        uint32_t importResource(const char* name, ResourceDx12* resource, ResourceState initialState, ResourceState finalState);
+
+        template<typename Function>
+        uint32_t addPass(const char* name, Function& record, RenderGraphPassFlags flags = RenderGraphPassFlags::None)
+        {
+            PassRecord pass = {};
+            pass.callable = &record;
+            pass.invoke = [](void* callable, RenderGraphPassContext& context) { (*static_cast<Function*>(callable))(context); };
+            m_passes.push_back(pass);
+            return m_graph.addPass(name, flags);
+        }
+
+        void read(uint32_t pass, uint32_t resource, ResourceState state) { m_graph.read(pass, resource, state); }
+        void write(uint32_t pass, uint32_t resource, ResourceState state) { m_graph.write(pass, resource, state); }
+
+        void compile() { m_graph.compile(); }
+        // Records every pass that survived culling, starting on context.commandList, then the final transitions
+        void execute(RenderGraphPassContext& context);
+
+        const RenderGraph& getGraph() const { return m_graph; }
+
+    private:
+        struct PassRecord
+        {
+            void* callable = nullptr;
+            void (*invoke)(void* callable, RenderGraphPassContext& context) = nullptr;
+        };
+
+        void recordBarriers(CommandList* commandList, std::span<const RenderGraphBarrier> barriers);
+
+    private:
+        RenderGraph m_graph;
+        std::vector<ResourceDx12*> m_resources;
+        std::vector<PassRecord> m_passes;
+    };
+} // namespace raphael
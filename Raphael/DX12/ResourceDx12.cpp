@@ -6,6 +6,19 @@ namespace raphael
 {
     ResourceDx12::ResourceDx12(DeviceDx12* device, const ResourceDesc& desc)
         : m_device(device), m_desc(desc)
+    {
+        m_trackedState.owner = this;
+        create(desc);
+    }
+
+    ResourceDx12::ResourceDx12(DeviceDx12* device, const ResourceDesc& desc, ID3D12Heap* heap, UINT64 heapOffset)
+        : m_device(device), m_desc(desc), m_placementHeap(heap), m_placementOffset(heapOffset)
+    {
+        m_trackedState.owner = this;
+        create(desc);
+    }
+
+    void ResourceDx12::create(const ResourceDesc& desc)
     {
         switch (desc.type)
         {
@@ -18,11 +31,34 @@ namespace raphael
         default:
             throw std::runtime_error("Unsupported resource type");
         }
+
+        if (m_placementHeap != nullptr)
+        {
+            return;
+        }
+
+        trackMemory(resolveMemoryCategory(desc), desc.debugName);
+    }
+
+    MemoryCategory ResourceDx12::resolveMemoryCategory(const ResourceDesc& desc)
+    {
+        if (desc.memoryCategory != MemoryCategory::Unknown)
+            return desc.memoryCategory;
+        if (desc.usage == ResourceDesc::Usage::Upload)
+            return MemoryCategory::Staging;
+        if (hasFlag(desc.bindFlags, ResourceBindFlags::DepthStencil))
+            return MemoryCategory::DepthStencil;
+        if (hasFlag(desc.bindFlags, ResourceBindFlags::RenderTarget))
+            return MemoryCategory::RenderTarget;
+        if (desc.type == ResourceDesc::ResourceType::Texture2D)
+            return MemoryCategory::Texture;
+        return MemoryCategory::Other;
     }
 
     ResourceDx12::ResourceDx12(DeviceDx12* device, ID3D12Resource* resource)
         : m_device(device)
     {
+        m_trackedState.owner = this;
         // ComPtr will automatically AddRef the resource, so we can just assign it
         m_resource.Attach(resource);
         // Retrieve resource description to fill m_desc
@@ -36,6 +72,7 @@ namespace raphael
     ResourceDx12::ResourceDx12(DeviceDx12* device, ComPtr<ID3D12Resource> resource)
         : m_device(device), m_resource(std::move(resource))
     {
+        m_trackedState.owner = this;
         // Retrieve resource description to fill m_desc
         D3D12_RESOURCE_DESC resDesc = m_resource->GetDesc();
         m_desc.width = static_cast<uint32_t>(resDesc.Width);
@@ -43,6 +80,40 @@ namespace raphael
         m_desc.type = ResourceDesc::ResourceType::Texture2D; // TODO: Assuming only swapchain use for now. Determine resource type based on dimension in the future (switch case)
     }
 
+    ResourceDx12::~ResourceDx12()
+    {
+        if (m_memoryHandle != MemoryTracker::InvalidHandle)
+        {
+            m_device->getMemoryTracker().untrack(m_memoryHandle);
+        }
+
+        // Drop the resource before handing its heap region back for reuse
+        m_resource.Reset();
+        if (m_allocation.isValid())
+        {
+            m_device->getMemoryAllocator()->free(m_allocation);
+        }
+    }
+
+    void ResourceDx12::trackMemory(MemoryCategory category, const char* debugName)
+    {
+        if (m_memoryHandle != MemoryTracker::InvalidHandle)
+        {
+            m_device->getMemoryTracker().untrack(m_memoryHandle);
+        }
+
+        // Placed resources already know their footprint, everything else asks the device
+        UINT64 sizeInBytes = m_allocation.isValid() ? m_allocation.size : 0;
+        if (sizeInBytes == 0)
+        {
+            const D3D12_RESOURCE_DESC resDesc = m_resource->GetDesc();
+            const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = m_device->getNativeDevice()->GetResourceAllocationInfo(0, 1, &resDesc);
+            sizeInBytes = (allocationInfo.SizeInBytes != UINT64_MAX) ? allocationInfo.SizeInBytes : 0;
+        }
+
+        m_memoryHandle = m_device->getMemoryTracker().track(category, sizeInBytes, debugName);
+    }
+
     bool ResourceDx12::map(void** data)
     {
         if (FAILED(m_resource->Map(0, nullptr, data)))
@@ -112,18 +183,18 @@ namespace raphael
 
     void ResourceDx12::createBuffer(const ResourceDesc& desc)
     {
-        CD3DX12_HEAP_PROPERTIES heapProp;
-        D3D12_RESOURCE_STATES initialState;
+        D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+        D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;
 
-        // Determine heap properties based on usage
+        // Determine heap type based on usage
         switch (desc.usage)
         {
         case ResourceDesc::Usage::Default:
-            heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+            heapType = D3D12_HEAP_TYPE_DEFAULT;
             initialState = D3D12_RESOURCE_STATE_COMMON; // Default state for buffers
             break;
         case ResourceDesc::Usage::Upload:
-            heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+            heapType = D3D12_HEAP_TYPE_UPLOAD;
             initialState = D3D12_RESOURCE_STATE_GENERIC_READ; // Upload buffers are typically in this state
             break;
         }
@@ -135,23 +206,14 @@ namespace raphael
             resourceFlags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
         CD3DX12_RESOURCE_DESC resDesc = CD3DX12_RESOURCE_DESC::Buffer(desc.width, resourceFlags);
-        if (FAILED(m_device->getNativeDevice()->CreateCommittedResource(
-            &heapProp,
-            D3D12_HEAP_FLAG_NONE,
-            &resDesc,
-            initialState,
-            nullptr,
-            IID_PPV_ARGS(&m_resource)
-        )))
+        if (!createNativeResource(heapType, GpuHeapCategory::Buffer, resDesc, initialState, nullptr))
         {
             throw std::runtime_error("Failed to create buffer resource");
         }
     }
 
-    void ResourceDx12::createTexture2D(const ResourceDesc& desc)
+    D3D12_RESOURCE_DESC ResourceDx12::buildTexture2DDesc(const ResourceDesc& desc)
     {
-        CD3DX12_HEAP_PROPERTIES heapProp(D3D12_HEAP_TYPE_DEFAULT);
-
         // Translate bind flags to D3D12 resource flags
         D3D12_RESOURCE_FLAGS resourceFlags = D3D12_RESOURCE_FLAG_NONE;
         if (hasFlag(desc.bindFlags, ResourceBindFlags::RenderTarget))
@@ -161,7 +223,7 @@ namespace raphael
         if (hasFlag(desc.bindFlags, ResourceBindFlags::UnorderedAccess))
             resourceFlags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-        CD3DX12_RESOURCE_DESC resDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+        return CD3DX12_RESOURCE_DESC::Tex2D(
             convertFormatToDXGI(desc.format),
             desc.width,
             desc.height,
@@ -169,6 +231,12 @@ namespace raphael
             desc.mipLevels, 1, 0,
             resourceFlags
         ); // Default values for other fields like MipLevels, SampleDesc, etc. can be set as needed. For now, no mipmaps
+    }
+
+    void ResourceDx12::createTexture2D(const ResourceDesc& desc)
+    {
+        const D3D12_RESOURCE_DESC resDesc = buildTexture2DDesc(desc);
+        const D3D12_RESOURCE_FLAGS resourceFlags = resDesc.Flags;
 
         // For textures that will be used as render targets or depth stencils, we should specify an optimized clear value. 
         // This is optional but can improve performance when clearing these resources.
@@ -198,17 +266,69 @@ namespace raphael
         if (hasFlag(desc.bindFlags, ResourceBindFlags::DepthStencil))
             initialState = D3D12_RESOURCE_STATE_DEPTH_WRITE;
 
-        if (FAILED(m_device->getNativeDevice()->CreateCommittedResource(
+        // Render targets and depth buffers live in their own heaps (required on resource heap tier 1)
+        GpuHeapCategory category = GpuHeapCategory::Texture;
+        if (resourceFlags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+            category = GpuHeapCategory::RenderTarget;
+
+        if (!createNativeResource(D3D12_HEAP_TYPE_DEFAULT, category, resDesc, initialState, pOptClear))
+        {
+            throw std::runtime_error("Failed to create texture resource");
+        }
+    }
+
+    bool ResourceDx12::createNativeResource(D3D12_HEAP_TYPE heapType, GpuHeapCategory category, const D3D12_RESOURCE_DESC& resDesc,
+        D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue)
+    {
+        ID3D12Device* nativeDevice = m_device->getNativeDevice();
+        GpuMemoryAllocatorDx12* allocator = m_device->getMemoryAllocator();
+        m_trackedState.state = convertResourceStateFromD3D12(initialState);
+
+        // The caller picked the heap and offset, there is nothing to fall back to
+        if (m_placementHeap != nullptr)
+        {
+            return SUCCEEDED(nativeDevice->CreatePlacedResource(
+                m_placementHeap,
+                m_placementOffset,
+                &resDesc,
+                initialState,
+                clearValue,
+                IID_PPV_ARGS(&m_resource)
+            ));
+        }
+
+        if (allocator != nullptr)
+        {
+            D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = nativeDevice->GetResourceAllocationInfo(0, 1, &resDesc);
+            if (allocationInfo.SizeInBytes != UINT64_MAX && allocator->allocate(heapType, category, allocationInfo, &m_allocation))
+            {
+                if (SUCCEEDED(nativeDevice->CreatePlacedResource(
+                    m_allocation.heap,
+                    m_allocation.offset,
+                    &resDesc,
+                    initialState,
+                    clearValue,
+                    IID_PPV_ARGS(&m_resource)
+                )))
+                {
+                    return true;
+                }
+
+                allocator->free(m_allocation);
+                m_allocation = {};
+            }
+        }
+
+        // Too large for a heap block (or placement failed): give the resource its own implicit heap
+        CD3DX12_HEAP_PROPERTIES heapProp(heapType);
+        return SUCCEEDED(nativeDevice->CreateCommittedResource(
             &heapProp,
             D3D12_HEAP_FLAG_NONE,
             &resDesc,
             initialState,
-            pOptClear,
+            clearValue,
             IID_PPV_ARGS(&m_resource)
-        )))
-        {
-            throw std::runtime_error("Failed to create texture resource");
-        }
+        ));
     }
 
     void ResourceDx12::initAsCbv(D3D12_CPU_DESCRIPTOR_HANDLE handle)
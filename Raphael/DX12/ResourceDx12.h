@@ -2,6 +2,8 @@
 #include "ObjectDescriptors.h"
 #include "Interfaces.h"
 #include "DescriptorHeapDx12.h"
+#include "GpuMemoryAllocatorDx12.h"
+#include "ResourceStateTracker.h"
 
 namespace raphael
 {
@@ -13,13 +15,21 @@ namespace raphael
         ResourceDx12(DeviceDx12* device, const ResourceDesc& desc);
         ResourceDx12(DeviceDx12* device, ID3D12Resource* resource);
         ResourceDx12(DeviceDx12* device, ComPtr<ID3D12Resource> resource);
-        ~ResourceDx12() = default;
+        // Places the resource at a fixed offset of a heap owned by the caller, used for aliased transient targets.
+        // The heap owner accounts for the memory, so the resource is not tracked on its own.
+        ResourceDx12(DeviceDx12* device, const ResourceDesc& desc, ID3D12Heap* heap, UINT64 heapOffset);
+        ~ResourceDx12();
+
+        ResourceDx12(const ResourceDx12& rhs) = delete;
+        ResourceDx12& operator=(const ResourceDx12& rhs) = delete;
 
         // IResource interface
         const ResourceDesc& getDesc() const override { return m_desc; }
 
         // DX12 specific methods
         ID3D12Resource* getNativeResource() const { return m_resource.Get(); }
+        // Queue-level state, updated when command lists using the resource are submitted
+        TrackedResourceState* getTrackedState() { return &m_trackedState; }
         bool map(void** data);
         void unmap();
 
@@ -30,13 +40,30 @@ namespace raphael
         void initAsRtv(D3D12_CPU_DESCRIPTOR_HANDLE handle);
         void initAsDsv(D3D12_CPU_DESCRIPTOR_HANDLE handle);
 
+        // Registers the resource with the device memory tracker. Resources created from a ResourceDesc do this
+        // themselves, wrapped native resources (swap chain buffers, loader textures) opt in with this call.
+        void trackMemory(MemoryCategory category, const char* debugName);
+
+        static D3D12_RESOURCE_DESC buildTexture2DDesc(const ResourceDesc& desc);
+        // desc.memoryCategory, or the one its usage and bind flags imply when it is Unknown
+        static MemoryCategory resolveMemoryCategory(const ResourceDesc& desc);
+
     private:
+        void create(const ResourceDesc& desc);
         void createBuffer(const ResourceDesc& desc);
         void createTexture2D(const ResourceDesc& desc);
+        // Places the resource in a shared heap, falling back to a committed resource when it does not fit one
+        bool createNativeResource(D3D12_HEAP_TYPE heapType, GpuHeapCategory category, const D3D12_RESOURCE_DESC& resDesc,
+            D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue);
 
     private:
         DeviceDx12* m_device = nullptr;
         ResourceDesc m_desc = {};
         ComPtr<ID3D12Resource> m_resource;
+        GpuAllocation m_allocation = {}; // Invalid for committed and externally created resources
+        ID3D12Heap* m_placementHeap = nullptr; // Caller owned heap for resources placed at a fixed offset
+        UINT64 m_placementOffset = 0;
+        uint32_t m_memoryHandle = MemoryTracker::InvalidHandle;
+        TrackedResourceState m_trackedState = {}; // Wrapped resources start in COMMON, which is also PRESENT
     };
 } // namespace raphael
@@ -0,0 +1,243 @@
+#include "ResourceStateTracker.h"
+
+namespace raphael
+{
+    ResourceStateTracker::ResourceStateTracker()
+    {
+        // Enough for any list the demos record, keeps steady-state recording free of allocations
+        m_entries.reserve(64);
+        m_pending.reserve(64);
+        m_pendingEntries.reserve(64);
+    }
+
+    void ResourceStateTracker::reset()
+    {
+        m_entries.clear();
+        m_pending.clear();
+        m_pendingEntries.clear();
+    }
+
+    void ResourceStateTracker::require(TrackedResourceState* resource, ResourceState state)
+    {
+        m_stats.requestCount++;
+
+        bool added = false;
+        const uint32_t entryIndex = findOrAddEntry(resource, state, added);
+        if (added)
+        {
+            // First use, checked against the global state at submit
+            return;
+        }
+
+        Entry& entry = m_entries[entryIndex];
+        const bool wasSplit = entry.splitOpen;
+        if (wasSplit)
+        {
+            endSplit(entryIndex);
+        }
+
+        if (isStateCompatible(entry.currentState, state))
+        {
+            if (!wasSplit)
+            {
+                m_stats.skippedCount++;
+            }
+            return;
+        }
+        queueTransition(entryIndex, state);
+    }
+
+    void ResourceStateTracker::assume(TrackedResourceState* resource, ResourceState state)
+    {
+        // Already tracked: the list knows better than the caller
+        bool added = false;
+        findOrAddEntry(resource, state, added);
+    }
+
+    void ResourceStateTracker::beginSplit(TrackedResourceState* resource, ResourceState state)
+    {
+        m_stats.requestCount++;
+
+        bool added = false;
+        const uint32_t entryIndex = findOrAddEntry(resource, state, added);
+        if (added)
+        {
+            // Nothing to start early from an unknown state, the submit-time fix-up does the whole transition
+            return;
+        }
+
+        Entry& entry = m_entries[entryIndex];
+        if (entry.splitOpen)
+        {
+            endSplit(entryIndex);
+        }
+
+        if (isStateCompatible(entry.currentState, state))
+        {
+            m_stats.skippedCount++;
+            return;
+        }
+
+        if (entry.pendingIndex != NoPending)
+        {
+            // A transition of the resource is waiting for the next command anyway, splitting gains nothing
+            queueTransition(entryIndex, state);
+            return;
+        }
+
+        entry.pendingIndex = static_cast<uint32_t>(m_pending.size());
+        entry.splitOpen = true;
+        entry.splitState = state;
+        m_pending.push_back({ resource, entry.currentState, state, ResourceTransitionFlags::BeginOnly });
+        m_pendingEntries.push_back(entryIndex);
+    }
+
+    void ResourceStateTracker::finish()
+    {
+        for (uint32_t i = 0; i < m_entries.size(); ++i)
+        {
+            if (m_entries[i].splitOpen)
+            {
+                endSplit(i);
+            }
+        }
+    }
+
+    void ResourceStateTracker::clearPendingBarriers()
+    {
+        if (m_pending.empty())
+        {
+            return;
+        }
+
+        for (uint32_t entryIndex : m_pendingEntries)
+        {
+            m_entries[entryIndex].pendingIndex = NoPending;
+            m_entries[entryIndex].transitioned = true;
+        }
+        m_stats.barrierCount += m_pending.size();
+        m_stats.batchCount++;
+        m_pending.clear();
+        m_pendingEntries.clear();
+    }
+
+    uint32_t ResourceStateTracker::resolve(std::vector<ResourceTransition>& fixups)
+    {
+        uint32_t fixupCount = 0;
+        for (const Entry& entry : m_entries)
+        {
+            const ResourceState globalState = entry.resource->state;
+
+            // Barriers recorded in the list name firstState as their 'before', so it must then match exactly.
+            // A list that only reads may use a combined read state as it is.
+            const bool needsFixup = entry.transitioned
+                ? globalState != entry.firstState
+                : !isStateCompatible(globalState, entry.firstState);
+            if (needsFixup)
+            {
+                fixups.push_back({ entry.resource, globalState, entry.firstState, ResourceTransitionFlags::None });
+                fixupCount++;
+            }
+
+            if (entry.transitioned)
+            {
+                entry.resource->state = entry.currentState;
+            }
+            else if (needsFixup)
+            {
+                entry.resource->state = entry.firstState;
+            }
+        }
+
+        m_stats.fixupCount += fixupCount;
+        return fixupCount;
+    }
+
+    ResourceState ResourceStateTracker::getCurrentState(const TrackedResourceState* resource) const
+    {
+        for (const Entry& entry : m_entries)
+        {
+            if (entry.resource == resource)
+            {
+                return entry.currentState;
+            }
+        }
+        return ResourceState::Common;
+    }
+
+    uint32_t ResourceStateTracker::findOrAddEntry(TrackedResourceState* resource, ResourceState state, bool& added)
+    {
+        for (uint32_t i = 0; i < m_entries.size(); ++i)
+        {
+            if (m_entries[i].resource == resource)
+            {
+                added = false;
+                return i;
+            }
+        }
+
+        Entry entry = {};
+        entry.resource = resource;
+        entry.firstState = state;
+        entry.currentState = state;
+        m_entries.push_back(entry);
+        added = true;
+        return static_cast<uint32_t>(m_entries.size() - 1);
+    }
+
+    void ResourceStateTracker::endSplit(uint32_t entryIndex)
+    {
+        Entry& entry = m_entries[entryIndex];
+        entry.splitOpen = false;
+
+        if (entry.pendingIndex != NoPending)
+        {
+            // The begin half has not been recorded yet, both halves collapse into a plain transition
+            m_pending[entry.pendingIndex].flags = ResourceTransitionFlags::None;
+            m_stats.mergedCount++;
+        }
+        else
+        {
+            m_pending.push_back({ entry.resource, entry.currentState, entry.splitState, ResourceTransitionFlags::EndOnly });
+            m_pendingEntries.push_back(entryIndex);
+        }
+        entry.currentState = entry.splitState;
+    }
+
+    void ResourceStateTracker::queueTransition(uint32_t entryIndex, ResourceState state)
+    {
+        Entry& entry = m_entries[entryIndex];
+        if (entry.pendingIndex == NoPending)
+        {
+            entry.pendingIndex = static_cast<uint32_t>(m_pending.size());
+            m_pending.push_back({ entry.resource, entry.currentState, state, ResourceTransitionFlags::None });
+            m_pendingEntries.push_back(entryIndex);
+            entry.currentState = state;
+            return;
+        }
+
+        // No command used the resource since the queued transition, retarget it
+        m_stats.mergedCount++;
+        entry.currentState = state;
+        ResourceTransition& transition = m_pending[entry.pendingIndex];
+        if (transition.before != state)
+        {
+            transition.after = state;
+            return;
+        }
+
+        // Back where it started: drop the transition, keeping the order of the others
+        const uint32_t removed = entry.pendingIndex;
+        entry.pendingIndex = NoPending;
+        m_pending.erase(m_pending.begin() + removed);
+        m_pendingEntries.erase(m_pendingEntries.begin() + removed);
+        for (uint32_t i = removed; i < m_pendingEntries.size(); ++i)
+        {
+            Entry& moved = m_entries[m_pendingEntries[i]];
+            if (moved.pendingIndex == i + 1)
+            {
+                moved.pendingIndex = i;
+            }
+        }
+    }
+} // namespace raphael
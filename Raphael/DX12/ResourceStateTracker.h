@@ -0,0 +1,156 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace raphael
+{
+    // Resource usage states. The values are the matching D3D12_RESOURCE_STATES bits so the backend converts with a cast.
+    enum class ResourceState : uint32_t
+    {
+        Common = 0,
+        Present = 0,
+        VertexAndConstantBuffer = 0x1,
+        IndexBuffer = 0x2,
+        RenderTarget = 0x4,
+        UnorderedAccess = 0x8,
+        DepthWrite = 0x10,
+        DepthRead = 0x20,
+        NonPixelShaderResource = 0x40,
+        PixelShaderResource = 0x80,
+        IndirectArgument = 0x200,
+        CopyDest = 0x400,
+        CopySource = 0x800,
+        GenericRead = 0xAC3, // Every read state above combined, required for upload heaps
+    };
+
+    inline ResourceState operator|(ResourceState a, ResourceState b)
+    {
+        return static_cast<ResourceState>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    // True when the state only contains read bits, several of which may be combined
+    inline bool isReadOnlyState(ResourceState state)
+    {
+        constexpr uint32_t ReadBits = 0x1 | 0x2 | 0x20 | 0x40 | 0x80 | 0x200 | 0x800;
+        const uint32_t bits = static_cast<uint32_t>(state);
+        return bits != 0 && (bits & ~ReadBits) == 0;
+    }
+
+    // True when a resource in 'current' can be used as 'required' without a barrier
+    inline bool isStateCompatible(ResourceState current, ResourceState required)
+    {
+        if (current == required)
+        {
+            return true;
+        }
+        const uint32_t currentBits = static_cast<uint32_t>(current);
+        const uint32_t requiredBits = static_cast<uint32_t>(required);
+        return isReadOnlyState(current) && isReadOnlyState(required) && (currentBits & requiredBits) == requiredBits;
+    }
+
+    // State of a resource as seen by the queue: where the last submitted command list left it.
+    // Lives in the resource, only read and written while command lists are submitted.
+    struct TrackedResourceState
+    {
+        ResourceState state = ResourceState::Common;
+        void* owner = nullptr; // Backend resource, handed back in transitions
+    };
+
+    enum class ResourceTransitionFlags : uint8_t
+    {
+        None,
+        BeginOnly, // First half of a split barrier, the GPU may start the transition early
+        EndOnly,   // Second half, the resource is usable in 'after' once it executes
+    };
+
+    struct ResourceTransition
+    {
+        TrackedResourceState* resource = nullptr;
+        ResourceState before = ResourceState::Common;
+        ResourceState after = ResourceState::Common;
+        ResourceTransitionFlags flags = ResourceTransitionFlags::None;
+    };
+
+    struct ResourceStateTrackerStats
+    {
+        uint64_t requestCount = 0;  // require() and beginSplit() calls
+        uint64_t skippedCount = 0;  // Requests the resource already satisfied
+        uint64_t mergedCount = 0;   // Requests folded into, or cancelling, a transition not yet flushed
+        uint64_t barrierCount = 0;  // Transitions recorded in command lists, split halves counted separately
+        uint64_t batchCount = 0;    // Flushes that recorded at least one transition
+        uint64_t fixupCount = 0;    // Transitions inserted at submit because a list's first use did not match
+    };
+
+    // Per command list resource state tracking.
+    // Commands declare the state they need with require(); the tracker compares it with the state the list
+    // last left the resource in and queues only the transitions actually needed. Queued transitions are
+    // batched until the list records its next command and leave in one barrier call, and a transition
+    // requested back to the state it started from before the flush is dropped. A resource's first use in a
+    // list cannot be checked while recording, other lists may move it first, so it is remembered and
+    // resolve() checks it against the resource's global state when the list is submitted, returning the
+    // fix-up transitions to execute right before it and committing the states the list leaves behind.
+    // Split barriers: beginSplit() starts a transition early, the next require() on the resource ends it.
+    // One tracker per command list, recording threads never share one. Lookups are linear, lists touch
+    // a handful of resources each.
+    // Backend independent.
+    class ResourceStateTracker
+    {
+    public:
+        ResourceStateTracker();
+        ~ResourceStateTracker() = default;
+
+        ResourceStateTracker(const ResourceStateTracker& rhs) = delete;
+        ResourceStateTracker& operator=(const ResourceStateTracker& rhs) = delete;
+
+        // Forgets everything recorded, keeps the capacity. Called when the list starts recording.
+        void reset();
+
+        // The resource is about to be used in state
+        void require(TrackedResourceState* resource, ResourceState state);
+        // The resource is known to be in state at this point, e.g. from a render graph. Only takes effect before
+        // the list's first use of it, and lets the list record its first transition instead of a submit-time fix-up.
+        void assume(TrackedResourceState* resource, ResourceState state);
+        // Starts moving the resource to state, it must not be used until require() is called with it
+        void beginSplit(TrackedResourceState* resource, ResourceState state);
+        // Ends the split barriers still open, called before the list is closed
+        void finish();
+
+        // Transitions to record before the next command, then clearPendingBarriers()
+        std::span<const ResourceTransition> getPendingBarriers() const { return m_pending; }
+        void clearPendingBarriers();
+
+        // Submit time, in queue order: appends the transitions needed before the list to fixups and updates
+        // the global states. Returns the number appended.
+        uint32_t resolve(std::vector<ResourceTransition>& fixups);
+
+        // State the list leaves the resource in so far, Common if it never touched it
+        ResourceState getCurrentState(const TrackedResourceState* resource) const;
+        uint32_t getTrackedCount() const { return static_cast<uint32_t>(m_entries.size()); }
+        const ResourceStateTrackerStats& getStats() const { return m_stats; }
+
+    private:
+        static constexpr uint32_t NoPending = UINT32_MAX;
+
+        struct Entry
+        {
+            TrackedResourceState* resource = nullptr;
+            ResourceState firstState = ResourceState::Common;   // Needed before the list's first command on it
+            ResourceState currentState = ResourceState::Common; // After the commands recorded so far
+            ResourceState splitState = ResourceState::Common;   // Target of the open split barrier
+            uint32_t pendingIndex = NoPending;                  // Unflushed full transition of the resource
+            bool splitOpen = false;
+            bool transitioned = false; // The list moved the resource away from firstState
+        };
+
+        uint32_t findOrAddEntry(TrackedResourceState* resource, ResourceState state, bool& added);
+        void endSplit(uint32_t entryIndex);
+        void queueTransition(uint32_t entryIndex, ResourceState state);
+
+    private:
+        std::vector<Entry> m_entries;
+        std::vector<ResourceTransition> m_pending;
+        std::vector<uint32_t> m_pendingEntries; // Entry index of every pending transition
+        ResourceStateTrackerStats m_stats;
+    };
+} // namespace raphael
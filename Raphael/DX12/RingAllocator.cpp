@@ -0,0 +1,127 @@
+#include "RingAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+namespace raphael
+{
+    static uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    RingAllocator::RingAllocator(uint64_t capacity)
+        : m_capacity(capacity)
+    {
+        assert(capacity > 0 && "Ring allocator capacity must be greater than zero");
+    }
+
+    uint64_t RingAllocator::allocate(uint64_t size, uint64_t alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+        if (size == 0 || size > m_capacity)
+        {
+            return InvalidOffset;
+        }
+
+        // Head and tail meet both when the ring is empty and when it is full, used size tells them apart
+        if (m_head == m_tail && m_usedSize == m_capacity)
+        {
+            return InvalidOffset;
+        }
+
+        uint64_t offset = InvalidOffset;
+        uint64_t consumed = 0;
+        const uint64_t alignedHead = alignUp(m_head, alignment);
+
+        if (m_head >= m_tail)
+        {
+            // Free space is [head, capacity) followed by [0, tail)
+            if (alignedHead + size <= m_capacity)
+            {
+                offset = alignedHead;
+                consumed = (alignedHead - m_head) + size;
+            }
+            else if (size <= m_tail)
+            {
+                // Skip the remainder at the end of the ring and restart at zero (always aligned)
+                offset = 0;
+                consumed = (m_capacity - m_head) + size;
+            }
+        }
+        else
+        {
+            // Free space is [head, tail)
+            if (alignedHead + size <= m_tail)
+            {
+                offset = alignedHead;
+                consumed = (alignedHead - m_head) + size;
+            }
+        }
+
+        if (offset == InvalidOffset)
+        {
+            return InvalidOffset;
+        }
+
+        m_head = offset + size;
+        if (m_head == m_capacity)
+        {
+            m_head = 0;
+        }
+
+        m_usedSize += consumed;
+        m_currentFrameSize += consumed;
+        m_peakUsedSize = std::max(m_peakUsedSize, m_usedSize);
+        return offset;
+    }
+
+    void RingAllocator::finishFrame(uint64_t fenceValue)
+    {
+        // Nothing was allocated since the last fence, no region to track
+        if (m_currentFrameSize == 0)
+        {
+            return;
+        }
+
+        assert((m_frameCount == 0 || m_frames[(m_firstFrame + m_frameCount - 1) % m_frames.size()].fenceValue <= fenceValue) && "Fence values must be monotonic");
+
+        if (m_frameCount == m_frames.size())
+        {
+            // Unroll the queue into a bigger array so the oldest region sits at index zero again
+            std::vector<FrameRegion> frames(std::max<size_t>(4, m_frames.size() * 2));
+            for (size_t i = 0; i < m_frameCount; ++i)
+            {
+                frames[i] = m_frames[(m_firstFrame + i) % m_frames.size()];
+            }
+            m_frames.swap(frames);
+            m_firstFrame = 0;
+        }
+
+        FrameRegion& region = m_frames[(m_firstFrame + m_frameCount) % m_frames.size()];
+        region.fenceValue = fenceValue;
+        region.endOffset = m_head;
+        region.size = m_currentFrameSize;
+        m_frameCount++;
+
+        m_currentFrameSize = 0;
+    }
+
+    void RingAllocator::releaseCompleted(uint64_t completedFenceValue)
+    {
+        while (m_frameCount != 0 && m_frames[m_firstFrame].fenceValue <= completedFenceValue)
+        {
+            m_tail = m_frames[m_firstFrame].endOffset;
+            m_usedSize -= m_frames[m_firstFrame].size;
+            m_firstFrame = (m_firstFrame + 1) % m_frames.size();
+            m_frameCount--;
+        }
+
+        // Once everything is retired, restart from the beginning to avoid needless wrapping
+        if (m_usedSize == 0)
+        {
+            m_head = 0;
+            m_tail = 0;
+        }
+    }
+} // namespace raphael
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace raphael
+{
+    // Fence-retired linear ring allocator.
+    // Hands out offsets into a fixed-size range [0, capacity). Allocations made between two
+    // calls to finishFrame() form one region that is tagged with the fence value passed to
+    // finishFrame() and released as a whole once releaseCompleted() sees that value.
+    // Backend independent: it only tracks offsets, the owner maps them to real memory.
+    class RingAllocator
+    {
+    public:
+        static constexpr uint64_t InvalidOffset = ~0ull;
+
+        explicit RingAllocator(uint64_t capacity);
+        ~RingAllocator() = default;
+
+        // Returns the aligned offset of the allocation or InvalidOffset if the ring is full.
+        // Alignment must be a power of two.
+        uint64_t allocate(uint64_t size, uint64_t alignment);
+
+        // Tag everything allocated since the previous call with the given fence value
+        void finishFrame(uint64_t fenceValue);
+
+        // Release every region whose fence value is less than or equal to completedFenceValue
+        void releaseCompleted(uint64_t completedFenceValue);
+
+        bool hasPendingFrames() const { return m_frameCount != 0; }
+        uint64_t getOldestPendingFence() const { return m_frameCount == 0 ? 0 : m_frames[m_firstFrame].fenceValue; }
+
+        uint64_t getCapacity() const { return m_capacity; }
+        uint64_t getUsedSize() const { return m_usedSize; }
+        uint64_t getPeakUsedSize() const { return m_peakUsedSize; }
+
+    private:
+        struct FrameRegion
+        {
+            uint64_t fenceValue = 0;
+            uint64_t endOffset = 0; // Head position when the region was closed
+            uint64_t size = 0;      // Bytes consumed by the region, including alignment padding and wrap waste
+        };
+
+        uint64_t m_capacity = 0;
+        uint64_t m_head = 0; // Next free byte
+        uint64_t m_tail = 0; // First byte still in use by the GPU
+        uint64_t m_usedSize = 0;
+        uint64_t m_peakUsedSize = 0;
+        uint64_t m_currentFrameSize = 0;
+        // Circular queue of pending regions. Only grows when more frames are in flight than ever before,
+        // so finishing a frame does not allocate (a deque would allocate a node per frame on some STLs).
+        std::vector<FrameRegion> m_frames;
+        size_t m_firstFrame = 0;
+        size_t m_frameCount = 0;
+    };
+} // namespace raphael
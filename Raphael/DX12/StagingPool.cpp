@@ -0,0 +1,214 @@
+#include "StagingPool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace raphael
+{
+    StagingPool::StagingPool(const StagingPoolDesc& desc)
+        : m_desc(desc)
+    {
+        if (m_desc.minChunkSize == 0 || m_desc.sizeClassCount == 0 || m_desc.sizeClassCount > 32)
+        {
+            throw std::runtime_error("Invalid staging pool description");
+        }
+
+        m_freeLists.resize(m_desc.sizeClassCount);
+    }
+
+    uint32_t StagingPool::getSizeClass(uint64_t size) const
+    {
+        for (uint32_t sizeClass = 0; sizeClass < m_desc.sizeClassCount; ++sizeClass)
+        {
+            if (size <= getSizeClassSize(sizeClass))
+            {
+                return sizeClass;
+            }
+        }
+        return DedicatedClass;
+    }
+
+    StagingPool::Allocation StagingPool::acquire(uint64_t minSize)
+    {
+        const uint32_t sizeClass = getSizeClass(minSize);
+
+        // Cheapest case: an idle chunk of the right class
+        if (sizeClass != DedicatedClass && !m_freeLists[sizeClass].empty())
+        {
+            return reuse(sizeClass);
+        }
+
+        const uint64_t size = (sizeClass != DedicatedClass)
+            ? getSizeClassSize(sizeClass)
+            : (minSize + m_desc.minChunkSize - 1) / m_desc.minChunkSize * m_desc.minChunkSize;
+
+        if (m_liveBytes + size > m_desc.highWaterMark)
+        {
+            // Wasting part of a bigger idle chunk is better than growing past the budget
+            if (sizeClass != DedicatedClass)
+            {
+                for (uint32_t larger = sizeClass + 1; larger < m_desc.sizeClassCount; ++larger)
+                {
+                    if (!m_freeLists[larger].empty())
+                    {
+                        return reuse(larger);
+                    }
+                }
+            }
+
+            while (m_liveBytes + size > m_desc.highWaterMark && evictOne())
+            {
+            }
+
+            if (m_liveBytes + size > m_desc.highWaterMark)
+            {
+                if (m_liveBytes > 0)
+                {
+                    // Memory comes back when the GPU retires a pending chunk, the owner waits and retries
+                    m_counters.stallCount++;
+                    return {};
+                }
+
+                // A single request above the high-water mark can only be served by going over it
+                m_counters.overBudgetCount++;
+            }
+        }
+
+        return create(size, sizeClass);
+    }
+
+    StagingPool::Allocation StagingPool::reuse(uint32_t sizeClass)
+    {
+        const uint32_t chunk = m_freeLists[sizeClass].back();
+        m_freeLists[sizeClass].pop_back();
+        m_chunks[chunk].state = ChunkState::InUse;
+        m_counters.reusedCount++;
+
+        Allocation allocation = {};
+        allocation.chunk = chunk;
+        allocation.size = m_chunks[chunk].size;
+        return allocation;
+    }
+
+    StagingPool::Allocation StagingPool::create(uint64_t size, uint32_t sizeClass)
+    {
+        uint32_t chunk = InvalidChunk;
+        if (!m_unusedIds.empty())
+        {
+            chunk = m_unusedIds.back();
+            m_unusedIds.pop_back();
+        }
+        else
+        {
+            chunk = static_cast<uint32_t>(m_chunks.size());
+            m_chunks.emplace_back();
+        }
+
+        m_chunks[chunk].size = size;
+        m_chunks[chunk].sizeClass = sizeClass;
+        m_chunks[chunk].state = ChunkState::InUse;
+
+        m_liveBytes += size;
+        m_counters.peakLiveBytes = std::max(m_counters.peakLiveBytes, m_liveBytes);
+        m_counters.createdCount++;
+
+        Allocation allocation = {};
+        allocation.chunk = chunk;
+        allocation.size = size;
+        allocation.isNew = true;
+        return allocation;
+    }
+
+    void StagingPool::release(uint32_t chunk, uint64_t fenceValue)
+    {
+        if (chunk >= m_chunks.size() || m_chunks[chunk].state != ChunkState::InUse)
+        {
+            throw std::runtime_error("Releasing a staging chunk that is not in use");
+        }
+
+        m_chunks[chunk].state = ChunkState::InFlight;
+
+        auto position = std::upper_bound(m_inFlight.begin(), m_inFlight.end(), fenceValue,
+            [](uint64_t value, const PendingChunk& pending) { return value < pending.fenceValue; });
+        m_inFlight.insert(position, PendingChunk{ fenceValue, chunk });
+    }
+
+    void StagingPool::releaseCompleted(uint64_t completedFenceValue)
+    {
+        while (!m_inFlight.empty() && m_inFlight.front().fenceValue <= completedFenceValue)
+        {
+            const uint32_t chunk = m_inFlight.front().chunk;
+            m_inFlight.pop_front();
+
+            if (m_chunks[chunk].sizeClass == DedicatedClass)
+            {
+                evict(chunk);
+            }
+            else
+            {
+                m_chunks[chunk].state = ChunkState::Free;
+                m_freeLists[m_chunks[chunk].sizeClass].push_back(chunk);
+            }
+        }
+
+        // Shrink back under the budget after an over-budget request
+        while (m_liveBytes > m_desc.highWaterMark && evictOne())
+        {
+        }
+    }
+
+    void StagingPool::trim()
+    {
+        while (evictOne())
+        {
+        }
+    }
+
+    bool StagingPool::evictOne()
+    {
+        // Largest idle chunks first, they free the most memory per eviction
+        for (uint32_t sizeClass = m_desc.sizeClassCount; sizeClass-- > 0;)
+        {
+            if (!m_freeLists[sizeClass].empty())
+            {
+                const uint32_t chunk = m_freeLists[sizeClass].back();
+                m_freeLists[sizeClass].pop_back();
+                evict(chunk);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void StagingPool::evict(uint32_t chunk)
+    {
+        m_liveBytes -= m_chunks[chunk].size;
+        m_chunks[chunk] = {};
+        m_evictedChunks.push_back(chunk);
+        m_counters.evictedCount++;
+    }
+
+    void StagingPool::takeEvictedChunks(std::vector<uint32_t>& outChunks)
+    {
+        outChunks.insert(outChunks.end(), m_evictedChunks.begin(), m_evictedChunks.end());
+        m_unusedIds.insert(m_unusedIds.end(), m_evictedChunks.begin(), m_evictedChunks.end());
+        m_evictedChunks.clear();
+    }
+
+    StagingPoolStats StagingPool::getStats() const
+    {
+        StagingPoolStats stats = m_counters;
+        stats.liveBytes = m_liveBytes;
+        for (const Chunk& chunk : m_chunks)
+        {
+            switch (chunk.state)
+            {
+            case ChunkState::Free: stats.freeBytes += chunk.size; break;
+            case ChunkState::InUse: stats.inUseBytes += chunk.size; break;
+            case ChunkState::InFlight: stats.inFlightBytes += chunk.size; break;
+            default: continue;
+            }
+            stats.liveChunkCount++;
+        }
+        return stats;
+    }
+} // namespace raphael
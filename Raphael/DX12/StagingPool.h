@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace raphael
+{
+    struct StagingPoolDesc
+    {
+        uint64_t minChunkSize = 1024 * 1024;         // Size of the smallest class, every class doubles the previous one
+        uint32_t sizeClassCount = 5;                 // 1, 2, 4, 8 and 16 MB with the defaults
+        uint64_t highWaterMark = 128 * 1024 * 1024;  // Upper bound on staging memory, free chunks are evicted to stay under it
+    };
+
+    struct StagingPoolStats
+    {
+        uint64_t liveBytes = 0;      // Every chunk that currently has backing memory
+        uint64_t peakLiveBytes = 0;
+        uint64_t freeBytes = 0;      // Idle chunks waiting in a free list
+        uint64_t inUseBytes = 0;     // Chunks handed out and not yet released
+        uint64_t inFlightBytes = 0;  // Chunks released with a fence the GPU has not passed yet
+        uint32_t liveChunkCount = 0;
+        uint64_t createdCount = 0;
+        uint64_t reusedCount = 0;
+        uint64_t evictedCount = 0;
+        uint64_t stallCount = 0;       // Acquires refused because of the high-water mark
+        uint64_t overBudgetCount = 0;  // Acquires allowed past the high-water mark because nothing could be reclaimed
+    };
+
+    // Fence-retired pool of staging chunks grouped in power-of-two size classes.
+    // A chunk is acquired, filled, released with the fence value of the submission that reads it and goes
+    // back to the free list of its class once releaseCompleted() sees that value. Requests larger than the
+    // biggest class get a dedicated chunk that is destroyed instead of pooled.
+    // The pool never lets live memory grow past the high-water mark: it reuses a larger free chunk or evicts
+    // idle ones first, and when that is not enough acquire() fails so the owner can wait for the oldest fence.
+    // Backend independent: it only hands out chunk ids, the owner creates and destroys the memory behind them.
+    class StagingPool
+    {
+    public:
+        static constexpr uint32_t InvalidChunk = ~0u;
+
+        struct Allocation
+        {
+            uint32_t chunk = InvalidChunk;
+            uint64_t size = 0;
+            bool isNew = false; // The owner has to create backing memory for this chunk id
+
+            bool isValid() const { return chunk != InvalidChunk; }
+        };
+
+        explicit StagingPool(const StagingPoolDesc& desc = {});
+        ~StagingPool() = default;
+
+        StagingPool(const StagingPool& rhs) = delete;
+        StagingPool& operator=(const StagingPool& rhs) = delete;
+
+        // Returns a chunk of at least minSize bytes, or an invalid allocation if the high-water mark is reached
+        Allocation acquire(uint64_t minSize);
+
+        // Hand a chunk back, it becomes reusable once the GPU has passed fenceValue
+        void release(uint32_t chunk, uint64_t fenceValue);
+        void releaseCompleted(uint64_t completedFenceValue);
+
+        // Evict every idle chunk
+        void trim();
+
+        // Chunk ids whose backing memory must be destroyed. An id is only reused after it has been taken here.
+        void takeEvictedChunks(std::vector<uint32_t>& outChunks);
+
+        bool hasPendingChunks() const { return !m_inFlight.empty(); }
+        uint64_t getOldestPendingFence() const { return m_inFlight.empty() ? 0 : m_inFlight.front().fenceValue; }
+
+        uint64_t getSizeClassSize(uint32_t sizeClass) const { return m_desc.minChunkSize << sizeClass; }
+        uint32_t getSizeClassCount() const { return m_desc.sizeClassCount; }
+        const StagingPoolDesc& getDesc() const { return m_desc; }
+        StagingPoolStats getStats() const;
+
+    private:
+        static constexpr uint32_t DedicatedClass = ~0u;
+
+        enum class ChunkState : uint8_t
+        {
+            Unused, // Slot without backing memory
+            Free,
+            InUse,
+            InFlight
+        };
+
+        struct Chunk
+        {
+            uint64_t size = 0;
+            uint32_t sizeClass = DedicatedClass;
+            ChunkState state = ChunkState::Unused;
+        };
+
+        struct PendingChunk
+        {
+            uint64_t fenceValue = 0;
+            uint32_t chunk = InvalidChunk;
+        };
+
+        uint32_t getSizeClass(uint64_t size) const;
+        Allocation reuse(uint32_t sizeClass);
+        Allocation create(uint64_t size, uint32_t sizeClass);
+        bool evictOne();
+        void evict(uint32_t chunk);
+
+    private:
+        StagingPoolDesc m_desc;
+        std::vector<Chunk> m_chunks;                   // Indexed by chunk id
+        std::vector<std::vector<uint32_t>> m_freeLists; // Idle chunk ids per size class
+        std::deque<PendingChunk> m_inFlight;           // Sorted by fence value
+        std::vector<uint32_t> m_evictedChunks;         // Evicted, backing memory not destroyed yet
+        std::vector<uint32_t> m_unusedIds;             // Slots the owner has cleaned up
+
+        uint64_t m_liveBytes = 0;
+        StagingPoolStats m_counters = {};
+    };
+} // namespace raphael
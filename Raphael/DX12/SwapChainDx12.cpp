@@ -79,6 +79,9 @@ namespace raphael
             return false;
         }
 
+        // Present closes the frame for the memory telemetry
+        m_device->updateMemoryTelemetry();
+
         // Update the back buffer index after presenting
         m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
 
@@ -121,6 +124,7 @@ namespace raphael
             }
             // Wrap the back buffer in our ResourceDx12 class, no need to release the raw resource since ResourceDx12 will manage its lifetime
             m_backBuffers[i] = std::make_unique<ResourceDx12>(m_device, backBuffer);
+            m_backBuffers[i]->trackMemory(MemoryCategory::SwapChain, m_desc.debugName ? m_desc.debugName : "Swap chain back buffer");
             DescriptorHandle handle = {};
             rtvHeap->getDescriptorHandle(i, &handle);
             m_rtvViews[i] = m_backBuffers[i]->getResourceView(ResourceBindFlags::RenderTarget, handle);
@@ -0,0 +1,322 @@
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace raphael
+{
+    static uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    TlsfAllocator::TlsfAllocator(uint64_t capacity)
+        : m_capacity(capacity)
+    {
+        assert(capacity > 0 && "TLSF allocator capacity must be greater than zero");
+
+        for (uint32_t fl = 0; fl < FirstLevelCount; ++fl)
+        {
+            for (uint32_t sl = 0; sl < SecondLevelCount; ++sl)
+            {
+                m_freeHeads[fl][sl] = InvalidNode;
+            }
+        }
+
+        // The whole range starts as a single free block
+        insertFreeNode(createNode(0, capacity));
+    }
+
+    // Sizes below SecondLevelCount map linearly to the first row, larger sizes map to
+    // [2^n, 2^(n+1)) split into SecondLevelCount equal sub-ranges
+    void TlsfAllocator::mapping(uint64_t size, uint32_t* firstLevel, uint32_t* secondLevel)
+    {
+        if (size < SecondLevelCount)
+        {
+            *firstLevel = 0;
+            *secondLevel = static_cast<uint32_t>(size);
+            return;
+        }
+
+        const uint32_t msb = static_cast<uint32_t>(std::bit_width(size)) - 1;
+        *secondLevel = static_cast<uint32_t>(size >> (msb - SecondLevelBits)) ^ SecondLevelCount;
+        *firstLevel = msb - SecondLevelBits + 1;
+    }
+
+    bool TlsfAllocator::findFreeBlock(uint64_t size, uint32_t* firstLevel, uint32_t* secondLevel) const
+    {
+        // Round the request up to the next bin boundary so any block in the found bin is large enough
+        if (size >= SecondLevelCount)
+        {
+            const uint32_t msb = static_cast<uint32_t>(std::bit_width(size)) - 1;
+            size += (1ull << (msb - SecondLevelBits)) - 1;
+        }
+
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+        mapping(size, &fl, &sl);
+        if (fl >= FirstLevelCount)
+        {
+            return false;
+        }
+
+        uint32_t secondLevelMap = m_secondLevelBitmaps[fl] & (~0u << sl);
+        if (secondLevelMap == 0)
+        {
+            const uint64_t firstLevelMap = (fl + 1 < 64) ? (m_firstLevelBitmap & (~0ull << (fl + 1))) : 0;
+            if (firstLevelMap == 0)
+            {
+                return false;
+            }
+
+            fl = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+            secondLevelMap = m_secondLevelBitmaps[fl];
+        }
+
+        *firstLevel = fl;
+        *secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+        return true;
+    }
+
+    TlsfAllocator::Allocation TlsfAllocator::allocate(uint64_t size, uint64_t alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+        if (size == 0 || size > m_capacity)
+        {
+            return {};
+        }
+
+        // Worst case padding needed to reach an aligned offset inside the block
+        const uint64_t searchSize = size + alignment - 1;
+
+        uint32_t node = InvalidNode;
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+        if (findFreeBlock(searchSize, &fl, &sl))
+        {
+            node = m_freeHeads[fl][sl];
+        }
+        else
+        {
+            // The rounded search skips the request's own bin, which may still hold a block that fits
+            mapping(searchSize, &fl, &sl);
+            if (fl < FirstLevelCount)
+            {
+                for (uint32_t candidate = m_freeHeads[fl][sl]; candidate != InvalidNode; candidate = m_nodes[candidate].nextFree)
+                {
+                    const uint64_t padding = alignUp(m_nodes[candidate].offset, alignment) - m_nodes[candidate].offset;
+                    if (padding + size <= m_nodes[candidate].size)
+                    {
+                        node = candidate;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (node == InvalidNode)
+        {
+            return {};
+        }
+
+        removeFreeNode(node);
+
+        // Give the leading padding back as a free block
+        const uint64_t alignedOffset = alignUp(m_nodes[node].offset, alignment);
+        const uint64_t padding = alignedOffset - m_nodes[node].offset;
+        if (padding > 0)
+        {
+            const uint32_t front = createNode(m_nodes[node].offset, padding);
+            m_nodes[front].prevPhysical = m_nodes[node].prevPhysical;
+            m_nodes[front].nextPhysical = node;
+            if (m_nodes[node].prevPhysical != InvalidNode)
+            {
+                m_nodes[m_nodes[node].prevPhysical].nextPhysical = front;
+            }
+            m_nodes[node].prevPhysical = front;
+            m_nodes[node].offset = alignedOffset;
+            m_nodes[node].size -= padding;
+            insertFreeNode(front);
+        }
+
+        // Give the trailing remainder back as a free block
+        if (m_nodes[node].size > size)
+        {
+            const uint32_t back = createNode(m_nodes[node].offset + size, m_nodes[node].size - size);
+            m_nodes[back].prevPhysical = node;
+            m_nodes[back].nextPhysical = m_nodes[node].nextPhysical;
+            if (m_nodes[node].nextPhysical != InvalidNode)
+            {
+                m_nodes[m_nodes[node].nextPhysical].prevPhysical = back;
+            }
+            m_nodes[node].nextPhysical = back;
+            m_nodes[node].size = size;
+            insertFreeNode(back);
+        }
+
+        m_nodes[node].used = true;
+        m_usedSize += size;
+        m_allocationCount++;
+
+        Allocation allocation = {};
+        allocation.offset = m_nodes[node].offset;
+        allocation.node = node;
+        return allocation;
+    }
+
+    void TlsfAllocator::free(const Allocation& allocation)
+    {
+        if (!allocation.isValid())
+        {
+            return;
+        }
+
+        uint32_t node = allocation.node;
+        assert(node < m_nodes.size() && m_nodes[node].used && "Freeing an allocation that is not live");
+
+        m_nodes[node].used = false;
+        m_usedSize -= m_nodes[node].size;
+        m_allocationCount--;
+
+        // Merge with the previous physical block
+        const uint32_t prev = m_nodes[node].prevPhysical;
+        if (prev != InvalidNode && !m_nodes[prev].used)
+        {
+            removeFreeNode(prev);
+            m_nodes[prev].size += m_nodes[node].size;
+            m_nodes[prev].nextPhysical = m_nodes[node].nextPhysical;
+            if (m_nodes[node].nextPhysical != InvalidNode)
+            {
+                m_nodes[m_nodes[node].nextPhysical].prevPhysical = prev;
+            }
+            releaseNode(node);
+            node = prev;
+        }
+
+        // Merge with the next physical block
+        const uint32_t next = m_nodes[node].nextPhysical;
+        if (next != InvalidNode && !m_nodes[next].used)
+        {
+            removeFreeNode(next);
+            m_nodes[node].size += m_nodes[next].size;
+            m_nodes[node].nextPhysical = m_nodes[next].nextPhysical;
+            if (m_nodes[next].nextPhysical != InvalidNode)
+            {
+                m_nodes[m_nodes[next].nextPhysical].prevPhysical = node;
+            }
+            releaseNode(next);
+        }
+
+        insertFreeNode(node);
+    }
+
+    uint64_t TlsfAllocator::getAllocationSize(const Allocation& allocation) const
+    {
+        if (!allocation.isValid())
+        {
+            return 0;
+        }
+        return m_nodes[allocation.node].size;
+    }
+
+    TlsfAllocator::Stats TlsfAllocator::getStats() const
+    {
+        Stats stats = {};
+        stats.capacity = m_capacity;
+        stats.usedSize = m_usedSize;
+        stats.freeSize = m_capacity - m_usedSize;
+        stats.allocationCount = m_allocationCount;
+
+        for (uint32_t fl = 0; fl < FirstLevelCount; ++fl)
+        {
+            for (uint32_t sl = 0; sl < SecondLevelCount; ++sl)
+            {
+                for (uint32_t node = m_freeHeads[fl][sl]; node != InvalidNode; node = m_nodes[node].nextFree)
+                {
+                    stats.freeBlockCount++;
+                    stats.largestFreeBlock = std::max(stats.largestFreeBlock, m_nodes[node].size);
+                }
+            }
+        }
+        return stats;
+    }
+
+    uint32_t TlsfAllocator::createNode(uint64_t offset, uint64_t size)
+    {
+        uint32_t node = 0;
+        if (!m_unusedNodes.empty())
+        {
+            node = m_unusedNodes.back();
+            m_unusedNodes.pop_back();
+            m_nodes[node] = {};
+        }
+        else
+        {
+            node = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+        }
+
+        m_nodes[node].offset = offset;
+        m_nodes[node].size = size;
+        return node;
+    }
+
+    void TlsfAllocator::releaseNode(uint32_t node)
+    {
+        m_unusedNodes.push_back(node);
+    }
+
+    void TlsfAllocator::insertFreeNode(uint32_t node)
+    {
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+        mapping(m_nodes[node].size, &fl, &sl);
+
+        const uint32_t head = m_freeHeads[fl][sl];
+        m_nodes[node].prevFree = InvalidNode;
+        m_nodes[node].nextFree = head;
+        if (head != InvalidNode)
+        {
+            m_nodes[head].prevFree = node;
+        }
+        m_freeHeads[fl][sl] = node;
+
+        m_firstLevelBitmap |= 1ull << fl;
+        m_secondLevelBitmaps[fl] |= 1u << sl;
+    }
+
+    void TlsfAllocator::removeFreeNode(uint32_t node)
+    {
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+        mapping(m_nodes[node].size, &fl, &sl);
+
+        const uint32_t prev = m_nodes[node].prevFree;
+        const uint32_t next = m_nodes[node].nextFree;
+        if (prev != InvalidNode)
+        {
+            m_nodes[prev].nextFree = next;
+        }
+        if (next != InvalidNode)
+        {
+            m_nodes[next].prevFree = prev;
+        }
+
+        if (m_freeHeads[fl][sl] == node)
+        {
+            m_freeHeads[fl][sl] = next;
+            if (next == InvalidNode)
+            {
+                m_secondLevelBitmaps[fl] &= ~(1u << sl);
+                if (m_secondLevelBitmaps[fl] == 0)
+                {
+                    m_firstLevelBitmap &= ~(1ull << fl);
+                }
+            }
+        }
+
+        m_nodes[node].prevFree = InvalidNode;
+        m_nodes[node].nextFree = InvalidNode;
+    }
+} // namespace raphael
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace raphael
+{
+    // Two-level segregated fit (TLSF) offset allocator.
+    // Manages a range [0, capacity) without touching the memory it describes, so it can back GPU heaps,
+    // descriptor heaps or anything else addressed by offsets. Allocation and free are O(1):
+    // a first-level bitmap selects the power-of-two class and a second-level bitmap one of
+    // SecondLevelCount linear subdivisions. Freed blocks are merged with their physical neighbours.
+    class TlsfAllocator
+    {
+    public:
+        static constexpr uint64_t InvalidOffset = ~0ull;
+        static constexpr uint32_t InvalidNode = ~0u;
+
+        struct Allocation
+        {
+            uint64_t offset = InvalidOffset;
+            uint32_t node = InvalidNode; // Internal block handle, needed to free the allocation
+
+            bool isValid() const { return offset != InvalidOffset; }
+        };
+
+        struct Stats
+        {
+            uint64_t capacity = 0;
+            uint64_t usedSize = 0;
+            uint64_t freeSize = 0;
+            uint64_t largestFreeBlock = 0;
+            uint32_t allocationCount = 0;
+            uint32_t freeBlockCount = 0;
+
+            // 0 when all free space is one contiguous block, approaching 1 as it gets scattered
+            float fragmentation() const
+            {
+                return freeSize == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeSize);
+            }
+        };
+
+        explicit TlsfAllocator(uint64_t capacity);
+        ~TlsfAllocator() = default;
+
+        // Alignment must be a power of two. Returns an invalid allocation when no free block fits.
+        Allocation allocate(uint64_t size, uint64_t alignment = 1);
+        void free(const Allocation& allocation);
+
+        // Size of a live allocation
+        uint64_t getAllocationSize(const Allocation& allocation) const;
+
+        bool isEmpty() const { return m_usedSize == 0; }
+        uint64_t getCapacity() const { return m_capacity; }
+        uint64_t getUsedSize() const { return m_usedSize; }
+        Stats getStats() const;
+
+    private:
+        static constexpr uint32_t SecondLevelBits = 4;
+        static constexpr uint32_t SecondLevelCount = 1u << SecondLevelBits;
+        static constexpr uint32_t FirstLevelCount = 64 - SecondLevelBits + 1;
+
+        struct Node
+        {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t prevPhysical = InvalidNode;
+            uint32_t nextPhysical = InvalidNode;
+            uint32_t prevFree = InvalidNode;
+            uint32_t nextFree = InvalidNode;
+            bool used = false;
+        };
+
+        static void mapping(uint64_t size, uint32_t* firstLevel, uint32_t* secondLevel);
+        bool findFreeBlock(uint64_t size, uint32_t* firstLevel, uint32_t* secondLevel) const;
+
+        uint32_t createNode(uint64_t offset, uint64_t size);
+        void releaseNode(uint32_t node);
+        void insertFreeNode(uint32_t node);
+        void removeFreeNode(uint32_t node);
+
+    private:
+        uint64_t m_capacity = 0;
+        uint64_t m_usedSize = 0;
+        uint32_t m_allocationCount = 0;
+
+        uint64_t m_firstLevelBitmap = 0;
+        uint32_t m_secondLevelBitmaps[FirstLevelCount] = {};
+        uint32_t m_freeHeads[FirstLevelCount][SecondLevelCount];
+
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_unusedNodes; // Recycled node slots
+    };
+} // namespace raphael
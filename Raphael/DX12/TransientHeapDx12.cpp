@@ -0,0 +1,147 @@
+#include "TransientHeapDx12.h"
+#include "DeviceDx12.h"
+#include "ResourceDx12.h"
+#include "CommandList.h"
+
+namespace raphael
+{
+    TransientHeapDx12::TransientHeapDx12(DeviceDx12* device)
+        : m_device(device)
+    {
+        m_memoryHandles.fill(MemoryTracker::InvalidHandle);
+    }
+
+    TransientHeapDx12::~TransientHeapDx12()
+    {
+        reset();
+    }
+
+    uint32_t TransientHeapDx12::addTexture(const ResourceDesc& desc, uint32_t firstPass, uint32_t lastPass)
+    {
+        if (desc.type != ResourceDesc::ResourceType::Texture2D ||
+            !(hasFlag(desc.bindFlags, ResourceBindFlags::RenderTarget) || hasFlag(desc.bindFlags, ResourceBindFlags::DepthStencil)))
+        {
+            throw std::runtime_error("Transient heap only holds render target and depth stencil textures");
+        }
+
+        const D3D12_RESOURCE_DESC resDesc = ResourceDx12::buildTexture2DDesc(desc);
+        const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = m_device->getNativeDevice()->GetResourceAllocationInfo(0, 1, &resDesc);
+        if (allocationInfo.SizeInBytes == UINT64_MAX)
+        {
+            throw std::runtime_error("Invalid transient texture description");
+        }
+
+        TransientResourceDesc transientDesc = {};
+        transientDesc.name = desc.debugName;
+        transientDesc.size = allocationInfo.SizeInBytes;
+        transientDesc.alignment = allocationInfo.Alignment;
+        transientDesc.firstPass = firstPass;
+        transientDesc.lastPass = lastPass;
+
+        m_descs.push_back(desc);
+        return m_planner.addResource(transientDesc);
+    }
+
+    void TransientHeapDx12::build()
+    {
+        releaseHeap();
+
+        m_planner.compile();
+        if (m_planner.getResourceCount() == 0)
+        {
+            return;
+        }
+
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = m_planner.getHeapSize();
+        heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        heapDesc.Alignment = m_planner.getHeapAlignment();
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        if (FAILED(m_device->getNativeDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heap))))
+        {
+            throw std::runtime_error("Failed to create transient heap");
+        }
+        trackHeapMemory();
+
+        m_resources.reserve(m_descs.size());
+        for (uint32_t i = 0; i < m_descs.size(); ++i)
+        {
+            m_resources.push_back(std::make_unique<ResourceDx12>(m_device, m_descs[i], m_heap.Get(), m_planner.getPlacement(i).offset));
+        }
+    }
+
+    void TransientHeapDx12::reset()
+    {
+        releaseHeap();
+        m_descs.clear();
+        m_planner.clear();
+    }
+
+    void TransientHeapDx12::releaseHeap()
+    {
+        // Placed resources go before the heap they live in
+        m_resources.clear();
+        m_heap.Reset();
+        for (uint32_t& handle : m_memoryHandles)
+        {
+            if (handle != MemoryTracker::InvalidHandle)
+            {
+                m_device->getMemoryTracker().untrack(handle);
+                handle = MemoryTracker::InvalidHandle;
+            }
+        }
+    }
+
+    void TransientHeapDx12::trackHeapMemory()
+    {
+        // Each region counts toward the category of its largest occupant, the one that sized it. Alignment padding
+        // between regions goes to the category holding the most of the heap.
+        std::array<uint64_t, static_cast<size_t>(MemoryCategory::Count)> categoryBytes = {};
+        uint64_t regionBytes = 0;
+        for (const TransientRegion& region : m_planner.getRegions())
+        {
+            uint32_t largest = region.resources.front();
+            for (uint32_t resource : region.resources)
+            {
+                largest = m_planner.getResourceDesc(resource).size > m_planner.getResourceDesc(largest).size ? resource : largest;
+            }
+            categoryBytes[static_cast<size_t>(ResourceDx12::resolveMemoryCategory(m_descs[largest]))] += region.size;
+            regionBytes += region.size;
+        }
+        const auto mostBytes = std::max_element(categoryBytes.begin(), categoryBytes.end());
+        *mostBytes += m_planner.getHeapSize() - regionBytes;
+
+        for (size_t category = 0; category < categoryBytes.size(); ++category)
+        {
+            if (categoryBytes[category] > 0)
+            {
+                m_memoryHandles[category] = m_device->getMemoryTracker().track(static_cast<MemoryCategory>(category), categoryBytes[category],
+                    "Transient heap");
+            }
+        }
+    }
+
+    void TransientHeapDx12::recordAliasingBarriers(CommandList* commandList, uint32_t pass) const
+    {
+        // Submitted in small fixed batches so recording a frame stays free of heap allocations
+        constexpr uint32_t BatchSize = 16;
+        D3D12_RESOURCE_BARRIER barriers[BatchSize] = {};
+        uint32_t barrierCount = 0;
+        for (const TransientAliasingBarrier& aliasing : m_planner.getAliasingBarriers(pass))
+        {
+            barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Aliasing(
+                m_resources[aliasing.before]->getNativeResource(),
+                m_resources[aliasing.after]->getNativeResource());
+            if (barrierCount == BatchSize)
+            {
+                commandList->resourceBarrier(barriers, barrierCount);
+                barrierCount = 0;
+            }
+        }
+
+        if (barrierCount > 0)
+        {
+            commandList->resourceBarrier(barriers, barrierCount);
+        }
+    }
+} // namespace raphael
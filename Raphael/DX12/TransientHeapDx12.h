@@ -0,0 +1,52 @@
+#pragma once
+#include "D3D12CommonHeaders.h"
+#include "ObjectDescriptors.h"
+#include "TransientResourcePlanner.h"
+
+namespace raphael
+{
+    class DeviceDx12;
+    class ResourceDx12;
+    class CommandList;
+
+    // Render targets and depth buffers that only live for part of the frame, placed in one heap sized by a
+    // TransientResourcePlanner so targets with disjoint pass ranges share memory.
+    // Usage: addTexture() for every target with the passes that touch it, build(), then recordAliasingBarriers()
+    // at the start of each pass. Aliased targets hold garbage on first use, their pass must clear or discard them.
+    // The memory tracker sees the heap split by category, each aliased region under its largest target's category.
+    class TransientHeapDx12
+    {
+    public:
+        explicit TransientHeapDx12(DeviceDx12* device);
+        ~TransientHeapDx12();
+
+        TransientHeapDx12(const TransientHeapDx12& rhs) = delete;
+        TransientHeapDx12& operator=(const TransientHeapDx12& rhs) = delete;
+
+        // Only render target and depth stencil textures: they share the heap category on every resource heap tier
+        uint32_t addTexture(const ResourceDesc& desc, uint32_t firstPass, uint32_t lastPass);
+
+        // Creates the heap and places every target. The GPU must be done with the previous build.
+        void build();
+        // Releases the targets and the heap so a new set can be added, e.g. after a resize
+        void reset();
+
+        void recordAliasingBarriers(CommandList* commandList, uint32_t pass) const;
+
+        ResourceDx12* getResource(uint32_t index) const { return m_resources[index].get(); }
+        const TransientResourcePlanner& getPlanner() const { return m_planner; }
+
+    private:
+        void releaseHeap();
+        void trackHeapMemory();
+
+    private:
+        DeviceDx12* m_device = nullptr;
+        TransientResourcePlanner m_planner;
+        std::vector<ResourceDesc> m_descs;
+        std::vector<std::unique_ptr<ResourceDx12>> m_resources;
+        ComPtr<ID3D12Heap> m_heap;
+        // One per memory category, InvalidHandle for the ones the heap holds nothing of
+        std::array<uint32_t, static_cast<size_t>(MemoryCategory::Count)> m_memoryHandles;
+    };
+} // namespace raphael
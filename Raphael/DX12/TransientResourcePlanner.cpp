@@ -0,0 +1,185 @@
+#include "TransientResourcePlanner.h"
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace raphael
+{
+    static uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    uint32_t TransientResourcePlanner::addResource(const TransientResourceDesc& desc)
+    {
+        if (desc.size == 0 || desc.alignment == 0 || (desc.alignment & (desc.alignment - 1)) != 0 || desc.firstPass > desc.lastPass)
+        {
+            throw std::runtime_error("Invalid transient resource description");
+        }
+
+        m_resources.push_back(desc);
+        return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    void TransientResourcePlanner::clear()
+    {
+        m_resources.clear();
+        m_placements.clear();
+        m_regions.clear();
+        m_barriers.clear();
+        m_passBarrierStart.clear();
+        m_passCount = 0;
+        m_heapSize = 0;
+        m_heapAlignment = 0;
+        m_unaliasedSize = 0;
+    }
+
+    bool TransientResourcePlanner::isRegionFree(const TransientRegion& region, const TransientResourceDesc& desc) const
+    {
+        for (uint32_t occupant : region.resources)
+        {
+            const TransientResourceDesc& other = m_resources[occupant];
+            if (desc.firstPass <= other.lastPass && other.firstPass <= desc.lastPass)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void TransientResourcePlanner::compile()
+    {
+        const uint32_t resourceCount = getResourceCount();
+        m_placements.assign(resourceCount, {});
+        m_regions.clear();
+        m_barriers.clear();
+        m_passCount = 0;
+        m_heapSize = 0;
+        m_heapAlignment = 0;
+        m_unaliasedSize = 0;
+
+        // Largest first, so a region is always as big as its first occupant and never has to grow
+        std::vector<uint32_t> order(resourceCount);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+        {
+            return m_resources[a].size > m_resources[b].size;
+        });
+
+        for (uint32_t resource : order)
+        {
+            const TransientResourceDesc& desc = m_resources[resource];
+            m_passCount = std::max(m_passCount, desc.lastPass + 1);
+            m_unaliasedSize = alignUp(m_unaliasedSize, desc.alignment) + desc.size;
+
+            // Tightest fit wastes the least of the bigger regions for later, smaller resources
+            uint32_t bestRegion = static_cast<uint32_t>(m_regions.size());
+            for (uint32_t regionIndex = 0; regionIndex < m_regions.size(); ++regionIndex)
+            {
+                if (isRegionFree(m_regions[regionIndex], desc) &&
+                    (bestRegion == m_regions.size() || m_regions[regionIndex].size < m_regions[bestRegion].size))
+                {
+                    bestRegion = regionIndex;
+                }
+            }
+
+            if (bestRegion == m_regions.size())
+            {
+                TransientRegion region = {};
+                region.size = desc.size;
+                m_regions.push_back(region);
+            }
+
+            TransientRegion& region = m_regions[bestRegion];
+            region.alignment = std::max(region.alignment, desc.alignment);
+            region.resources.push_back(resource);
+            m_placements[resource].region = bestRegion;
+        }
+
+        // Lay the regions out back to back and order their occupants by first use
+        for (TransientRegion& region : m_regions)
+        {
+            region.offset = alignUp(m_heapSize, region.alignment);
+            m_heapSize = region.offset + region.size;
+            m_heapAlignment = std::max(m_heapAlignment, region.alignment);
+
+            std::sort(region.resources.begin(), region.resources.end(), [this](uint32_t a, uint32_t b)
+            {
+                return m_resources[a].firstPass < m_resources[b].firstPass;
+            });
+
+            const bool aliased = region.resources.size() > 1;
+            for (uint32_t occupant : region.resources)
+            {
+                m_placements[occupant].offset = region.offset;
+                m_placements[occupant].aliased = aliased;
+            }
+
+            if (aliased)
+            {
+                for (size_t i = 0; i < region.resources.size(); ++i)
+                {
+                    const uint32_t before = region.resources[(i + region.resources.size() - 1) % region.resources.size()];
+                    m_barriers.push_back({ before, region.resources[i] });
+                }
+            }
+        }
+        m_heapSize = alignUp(m_heapSize, std::max<uint64_t>(m_heapAlignment, 1));
+        m_unaliasedSize = alignUp(m_unaliasedSize, std::max<uint64_t>(m_heapAlignment, 1));
+
+        // Bucket the barriers by the pass that has to record them
+        std::stable_sort(m_barriers.begin(), m_barriers.end(), [this](const TransientAliasingBarrier& a, const TransientAliasingBarrier& b)
+        {
+            return m_resources[a.after].firstPass < m_resources[b.after].firstPass;
+        });
+
+        m_passBarrierStart.assign(m_passCount + 1, 0);
+        for (const TransientAliasingBarrier& barrier : m_barriers)
+        {
+            ++m_passBarrierStart[m_resources[barrier.after].firstPass + 1];
+        }
+        for (uint32_t pass = 0; pass < m_passCount; ++pass)
+        {
+            m_passBarrierStart[pass + 1] += m_passBarrierStart[pass];
+        }
+    }
+
+    std::span<const TransientAliasingBarrier> TransientResourcePlanner::getAliasingBarriers(uint32_t pass) const
+    {
+        if (pass >= m_passCount)
+        {
+            return {};
+        }
+
+        return std::span<const TransientAliasingBarrier>(m_barriers.data() + m_passBarrierStart[pass],
+            m_passBarrierStart[pass + 1] - m_passBarrierStart[pass]);
+    }
+
+    std::string TransientResourcePlanner::buildReport() const
+    {
+        std::ostringstream report;
+        report << "Transient resources: " << m_resources.size() << " in " << m_regions.size() << " regions over "
+            << m_passCount << " passes\n";
+        report << "Heap " << (m_heapSize >> 10) << " KB, unaliased " << (m_unaliasedSize >> 10) << " KB, saved "
+            << (getSavedBytes() >> 10) << " KB";
+        if (m_unaliasedSize > 0)
+        {
+            report << " (" << static_cast<int>(getSavedBytes() * 100 / m_unaliasedSize) << "%)";
+        }
+        report << ", " << m_barriers.size() << " aliasing barriers\n";
+
+        for (uint32_t regionIndex = 0; regionIndex < m_regions.size(); ++regionIndex)
+        {
+            const TransientRegion& region = m_regions[regionIndex];
+            report << "Region #" << regionIndex << " @" << (region.offset >> 10) << " KB, " << (region.size >> 10) << " KB:";
+            for (uint32_t occupant : region.resources)
+            {
+                const TransientResourceDesc& desc = m_resources[occupant];
+                report << " " << (desc.name ? desc.name : "unnamed") << " [" << desc.firstPass << "-" << desc.lastPass << "]";
+            }
+            report << "\n";
+        }
+        return report.str();
+    }
+} // namespace raphael
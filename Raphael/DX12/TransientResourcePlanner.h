@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace raphael
+{
+    // A transient resource only holds data between its first and last pass of the frame (both inclusive)
+    struct TransientResourceDesc
+    {
+        const char* name = nullptr;
+        uint64_t size = 0;
+        uint64_t alignment = 64 * 1024; // Must be a power of two
+        uint32_t firstPass = 0;
+        uint32_t lastPass = 0;
+    };
+
+    // Where a resource lives once the plan is compiled
+    struct TransientPlacement
+    {
+        uint32_t region = 0;
+        uint64_t offset = 0;  // Byte offset in the shared heap
+        bool aliased = false; // The region is shared: contents are undefined on first use and must be cleared or discarded
+    };
+
+    // A span of the heap shared by resources whose lifetimes never overlap
+    struct TransientRegion
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint64_t alignment = 0;
+        std::vector<uint32_t> resources; // Occupants in order of first use
+    };
+
+    // Recorded at the start of a pass: 'after' takes over the memory last used by 'before'
+    struct TransientAliasingBarrier
+    {
+        uint32_t before = 0;
+        uint32_t after = 0;
+    };
+
+    // Packs frame-transient resources into one heap by colouring their lifetime interval graph.
+    // Resources are visited largest first and each goes to the tightest existing region none of whose
+    // occupants is alive in the same passes, or opens a new region. Regions are then laid out back to back
+    // with their strictest alignment, and every hand-over inside a region becomes an aliasing barrier on the
+    // pass that first uses the new occupant. The frame loops, so the first occupant of a shared region gets
+    // a barrier from the last one.
+    // Backend independent: the owner measures sizes and alignments and creates the placed resources.
+    class TransientResourcePlanner
+    {
+    public:
+        TransientResourcePlanner() = default;
+        ~TransientResourcePlanner() = default;
+
+        TransientResourcePlanner(const TransientResourcePlanner& rhs) = delete;
+        TransientResourcePlanner& operator=(const TransientResourcePlanner& rhs) = delete;
+
+        // Returns the resource index used by every query below
+        uint32_t addResource(const TransientResourceDesc& desc);
+        void clear();
+
+        // Assigns regions and offsets and builds the per-pass barrier lists
+        void compile();
+
+        uint32_t getResourceCount() const { return static_cast<uint32_t>(m_resources.size()); }
+        uint32_t getPassCount() const { return m_passCount; }
+        const TransientResourceDesc& getResourceDesc(uint32_t resource) const { return m_resources[resource]; }
+        const TransientPlacement& getPlacement(uint32_t resource) const { return m_placements[resource]; }
+        const std::vector<TransientRegion>& getRegions() const { return m_regions; }
+        std::span<const TransientAliasingBarrier> getAliasingBarriers(uint32_t pass) const;
+
+        uint64_t getHeapSize() const { return m_heapSize; }
+        uint64_t getHeapAlignment() const { return m_heapAlignment; }
+        uint64_t getUnaliasedSize() const { return m_unaliasedSize; } // Heap size with one region per resource
+        uint64_t getSavedBytes() const { return m_unaliasedSize - m_heapSize; }
+
+        std::string buildReport() const;
+
+    private:
+        bool isRegionFree(const TransientRegion& region, const TransientResourceDesc& desc) const;
+
+    private:
+        std::vector<TransientResourceDesc> m_resources;
+        std::vector<TransientPlacement> m_placements;
+        std::vector<TransientRegion> m_regions;
+        std::vector<TransientAliasingBarrier> m_barriers; // Sorted by pass
+        std::vector<uint32_t> m_passBarrierStart;          // m_passCount + 1 entries into m_barriers
+        uint32_t m_passCount = 0;
+        uint64_t m_heapSize = 0;
+        uint64_t m_heapAlignment = 0;
+        uint64_t m_unaliasedSize = 0;
+    };
+} // namespace raphael
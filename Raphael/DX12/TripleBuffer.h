@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace raphael
+{
+    // Lock-free single producer, single consumer triple buffer.
+    // The writer fills the back slot and publishes it by swapping it with the middle slot, the reader swaps
+    // the middle slot with its front slot when something new was published. Neither side ever waits for the
+    // other and the reader always sees the latest complete value, older unread values are overwritten.
+    // Backend independent.
+    template<typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+
+        TripleBuffer(const TripleBuffer& rhs) = delete;
+        TripleBuffer& operator=(const TripleBuffer& rhs) = delete;
+
+        // Calls function on every slot, e.g. to reserve capacity. Only before the buffer is shared between threads.
+        template<typename Function>
+        void initialize(Function&& function)
+        {
+            for (T& slot : m_slots)
+            {
+                function(slot);
+            }
+        }
+
+        // Writer only: the slot being filled, keeps whatever it held two publishes ago
+        T& getWriteBuffer() { return m_slots[m_backIndex]; }
+
+        // Writer only: hands the write buffer to the reader. Returns false when the previous publish
+        // was never read and got dropped.
+        bool publish()
+        {
+            const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_backIndex | FreshBit), std::memory_order_acq_rel);
+            m_backIndex = previous & IndexMask;
+            return (previous & FreshBit) == 0;
+        }
+
+        // Reader only: moves the latest published value to the front, returns false if nothing new arrived
+        bool acquire()
+        {
+            if ((m_middle.load(std::memory_order_relaxed) & FreshBit) == 0)
+            {
+                return false;
+            }
+
+            const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_frontIndex), std::memory_order_acq_rel);
+            m_frontIndex = previous & IndexMask;
+            return true;
+        }
+
+        // Reader only: the value returned by the last successful acquire()
+        const T& getReadBuffer() const { return m_slots[m_frontIndex]; }
+
+        bool hasFreshValue() const { return (m_middle.load(std::memory_order_acquire) & FreshBit) != 0; }
+
+    private:
+        static constexpr uint8_t IndexMask = 0x3;
+        static constexpr uint8_t FreshBit = 0x4; // Middle slot holds a publish the reader has not taken yet
+
+        T m_slots[3] = {};
+        // Writer and reader indices sit on separate cache lines, the middle one is the only shared state
+        alignas(64) uint8_t m_backIndex = 0;
+        alignas(64) std::atomic<uint8_t> m_middle{ 1 };
+        alignas(64) uint8_t m_frontIndex = 2;
+    };
+} // namespace raphael
@@ -0,0 +1,244 @@
+#include "UploadBatchDx12.h"
+#include "DeviceDx12.h"
+#include "ResourceDx12.h"
+#include "CommandList.h"
+
+namespace raphael
+{
+    UploadBatchDx12::UploadBatchDx12(DeviceDx12* device, const StagingPoolDesc& stagingDesc)
+        : m_device(device), m_stagingPool(stagingDesc)
+    {
+        CommandListDesc desc = {};
+        desc.debugName = "Upload Batch";
+        desc.type = CommandListType::Copy;
+        m_commandList = m_device->createCommandList(desc);
+
+        ComPtr<ID3D12CommandAllocator> allocator = m_device->createCommandAllocator(CommandListType::Copy);
+        m_commandList->createCommandList(allocator.Get());
+        m_freeAllocators.push_back(std::move(allocator));
+    }
+
+    UploadBatchDx12::~UploadBatchDx12()
+    {
+        if (m_isRecording)
+        {
+            submit();
+        }
+
+        // Staging memory must stay alive until the copy queue is done with it
+        if (!m_inFlight.empty())
+        {
+            m_device->waitForCopyFence(m_inFlight.back().fenceValue);
+        }
+    }
+
+    void UploadBatchDx12::beginRecording()
+    {
+        if (m_isRecording)
+        {
+            return;
+        }
+
+        releaseCompleted();
+
+        if (!m_freeAllocators.empty())
+        {
+            m_allocator = std::move(m_freeAllocators.back());
+            m_freeAllocators.pop_back();
+        }
+        else
+        {
+            m_allocator = m_device->createCommandAllocator(CommandListType::Copy);
+        }
+
+        m_commandList->begin(m_allocator.Get());
+        m_isRecording = true;
+    }
+
+    void UploadBatchDx12::releaseCompleted()
+    {
+        const UINT64 completedValue = m_device->getCompletedCopyFenceValue();
+        while (!m_inFlight.empty() && m_inFlight.front().fenceValue <= completedValue)
+        {
+            m_freeAllocators.push_back(std::move(m_inFlight.front().allocator));
+            m_inFlight.pop_front();
+        }
+
+        m_stagingPool.releaseCompleted(completedValue);
+        destroyEvictedChunks();
+    }
+
+    void UploadBatchDx12::destroyEvictedChunks()
+    {
+        // Evicted chunks are idle, the copy queue is done with them
+        m_evictedChunks.clear();
+        m_stagingPool.takeEvictedChunks(m_evictedChunks);
+        for (uint32_t chunk : m_evictedChunks)
+        {
+            m_chunkStorage[chunk].reset();
+        }
+    }
+
+    UploadBatchDx12::StagingChunk* UploadBatchDx12::getCurrentChunk() const
+    {
+        return m_chunks.empty() ? nullptr : m_chunkStorage[m_chunks.back()].get();
+    }
+
+    UploadBatchDx12::StagingChunk* UploadBatchDx12::acquireChunk(UINT64 minCapacity)
+    {
+        StagingPool::Allocation allocation = m_stagingPool.acquire(minCapacity);
+        while (!allocation.isValid())
+        {
+            // Over the high-water mark. If this batch holds all the staging memory it has to go to the GPU
+            // before anything can be reclaimed; the copy queue is in order, so the final token still covers it.
+            if (!m_stagingPool.hasPendingChunks())
+            {
+                submit();
+                beginRecording();
+            }
+
+            m_device->waitForCopyFence(m_stagingPool.getOldestPendingFence());
+            releaseCompleted();
+            allocation = m_stagingPool.acquire(minCapacity);
+        }
+        destroyEvictedChunks();
+
+        if (allocation.chunk >= m_chunkStorage.size())
+        {
+            m_chunkStorage.resize(allocation.chunk + 1);
+        }
+
+        if (allocation.isNew)
+        {
+            auto chunk = std::make_unique<StagingChunk>(allocation.size);
+
+            ResourceDesc desc = {};
+            desc.type = ResourceDesc::ResourceType::Buffer;
+            desc.usage = ResourceDesc::Usage::Upload;
+            desc.width = allocation.size;
+            desc.memoryCategory = MemoryCategory::Staging;
+            desc.debugName = "Upload batch staging chunk";
+            chunk->buffer = m_device->createResource(desc);
+
+            // Staging chunks stay mapped for their whole lifetime
+            if (!chunk->buffer->map(reinterpret_cast<void**>(&chunk->mappedData)))
+            {
+                throw std::runtime_error("Failed to map upload batch staging buffer");
+            }
+
+            m_chunkStorage[allocation.chunk] = std::move(chunk);
+        }
+        else
+        {
+            m_chunkStorage[allocation.chunk]->packer.reset();
+        }
+
+        m_chunks.push_back(allocation.chunk);
+        return m_chunkStorage[allocation.chunk].get();
+    }
+
+    void UploadBatchDx12::addBuffer(ResourceDx12* dst, const void* data, UINT64 sizeInBytes, UINT64 dstOffset)
+    {
+        memcpy(allocateBuffer(dst, sizeInBytes, dstOffset), data, sizeInBytes);
+    }
+
+    void* UploadBatchDx12::allocateBuffer(ResourceDx12* dst, UINT64 sizeInBytes, UINT64 dstOffset)
+    {
+        beginRecording();
+
+        StagingChunk* chunk = getCurrentChunk();
+        UINT64 offset = chunk ? chunk->packer.packBuffer(sizeInBytes) : UploadPacker::InvalidOffset;
+        if (offset == UploadPacker::InvalidOffset)
+        {
+            chunk = acquireChunk(sizeInBytes + UploadPacker::BufferAlignment);
+            offset = chunk->packer.packBuffer(sizeInBytes);
+        }
+
+        // Buffers start in COMMON and are implicitly promoted to COPY_DEST on the copy queue
+        m_commandList->getNativeCommandList()->CopyBufferRegion(
+            dst->getNativeResource(), dstOffset,
+            chunk->buffer->getNativeResource(), offset,
+            sizeInBytes);
+
+        m_stats.uploadCount++;
+        return chunk->mappedData + offset;
+    }
+
+    void UploadBatchDx12::addTexture(ResourceDx12* dst, const D3D12_SUBRESOURCE_DATA* subresources, UINT firstSubresource, UINT numSubresources)
+    {
+        beginRecording();
+
+        const D3D12_RESOURCE_DESC dstDesc = dst->getNativeResource()->GetDesc();
+
+        for (UINT i = 0; i < numSubresources; ++i)
+        {
+            // Only the per-row size and row count are taken from the device, placement and pitch come from the packer
+            D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout = {};
+            UINT numRows = 0;
+            UINT64 rowSizeInBytes = 0;
+            m_device->getNativeDevice()->GetCopyableFootprints(&dstDesc, firstSubresource + i, 1, 0, &layout, &numRows, &rowSizeInBytes, nullptr);
+
+            const UINT rowSize = static_cast<UINT>(rowSizeInBytes);
+            const UINT depth = layout.Footprint.Depth;
+
+            StagingChunk* chunk = getCurrentChunk();
+            TextureFootprint footprint = {};
+            if (chunk == nullptr || !chunk->packer.packTexture(rowSize, numRows, depth, &footprint))
+            {
+                const UINT64 needed = UploadPacker::getTextureSize(rowSize, numRows, depth) + UploadPacker::TexturePlacementAlignment;
+                chunk = acquireChunk(needed);
+                chunk->packer.packTexture(rowSize, numRows, depth, &footprint);
+            }
+
+            // Copy row by row: the source pitch is arbitrary, the staging pitch is 256-byte aligned
+            const D3D12_SUBRESOURCE_DATA& src = subresources[i];
+            for (UINT z = 0; z < depth; ++z)
+            {
+                const BYTE* srcSlice = static_cast<const BYTE*>(src.pData) + src.SlicePitch * z;
+                BYTE* dstSlice = chunk->mappedData + footprint.offset + static_cast<UINT64>(footprint.rowPitch) * numRows * z;
+                for (UINT row = 0; row < numRows; ++row)
+                {
+                    memcpy(dstSlice + static_cast<UINT64>(footprint.rowPitch) * row, srcSlice + src.RowPitch * row, rowSize);
+                }
+            }
+
+            layout.Offset = footprint.offset;
+            layout.Footprint.RowPitch = footprint.rowPitch;
+
+            CD3DX12_TEXTURE_COPY_LOCATION dstLocation(dst->getNativeResource(), firstSubresource + i);
+            CD3DX12_TEXTURE_COPY_LOCATION srcLocation(chunk->buffer->getNativeResource(), layout);
+            m_commandList->getNativeCommandList()->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+
+            m_stats.uploadCount++;
+        }
+    }
+
+    UploadToken UploadBatchDx12::submit()
+    {
+        if (!m_isRecording)
+        {
+            return {};
+        }
+
+        m_commandList->end();
+        m_isRecording = false;
+
+        UploadToken token = m_device->executeCopyCommandList(m_commandList.get());
+
+        InFlightBatch batch = {};
+        batch.fenceValue = token.copyFenceValue;
+        batch.allocator = std::move(m_allocator);
+        m_inFlight.push_back(std::move(batch));
+
+        for (uint32_t chunk : m_chunks)
+        {
+            m_stats.payloadBytes += m_chunkStorage[chunk]->packer.getPayloadSize();
+            m_stats.stagingBytes += m_chunkStorage[chunk]->packer.getUsedSize();
+            m_stagingPool.release(chunk, token.copyFenceValue);
+        }
+        m_chunks.clear();
+
+        m_stats.submitCount++;
+        return token;
+    }
+} // namespace raphael
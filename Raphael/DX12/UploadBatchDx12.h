@@ -0,0 +1,96 @@
+#pragma once
+#include "D3D12CommonHeaders.h"
+#include "UploadPacker.h"
+#include "StagingPool.h"
+
+namespace raphael
+{
+    class DeviceDx12;
+    class ResourceDx12;
+    class CommandList;
+
+    // Copy queue fence value of a submitted batch. Pass it to DeviceDx12::waitForUpload before the first
+    // command list that reads the uploaded data, the wait happens on the GPU timeline
+    struct UploadToken
+    {
+        UINT64 copyFenceValue = 0;
+
+        bool isValid() const { return copyFenceValue != 0; }
+    };
+
+    struct UploadBatchStats
+    {
+        uint64_t submitCount = 0;
+        uint64_t uploadCount = 0;
+        uint64_t payloadBytes = 0; // Bytes of source data
+        uint64_t stagingBytes = 0; // Bytes of staging memory including alignment and row pitch padding
+    };
+
+    // Gathers buffer and texture uploads into large staging chunks and records the copies on a
+    // COPY command list. submit() sends everything to the copy queue with a single ExecuteCommandLists.
+    // Source data is copied into staging memory immediately, so callers may free it right after add*().
+    // Staging chunks come from a size-classed StagingPool and go back to it once the copy queue fence
+    // passes their batch. When the pool reaches its high-water mark the batch waits for the oldest
+    // submission, flushing itself first if it is the one holding the memory, so staging memory stays
+    // bounded however much data streams through.
+    class UploadBatchDx12
+    {
+    public:
+        UploadBatchDx12(DeviceDx12* device, const StagingPoolDesc& stagingDesc = {});
+        ~UploadBatchDx12();
+
+        UploadBatchDx12(const UploadBatchDx12& rhs) = delete;
+        UploadBatchDx12& operator=(const UploadBatchDx12& rhs) = delete;
+
+        void addBuffer(ResourceDx12* dst, const void* data, UINT64 sizeInBytes, UINT64 dstOffset = 0);
+        // Records the copy and returns the mapped staging memory for the caller to fill in place, skipping the
+        // intermediate CPU copy. The pointer is write-combined and only valid until the next call on the batch.
+        void* allocateBuffer(ResourceDx12* dst, UINT64 sizeInBytes, UINT64 dstOffset = 0);
+        void addTexture(ResourceDx12* dst, const D3D12_SUBRESOURCE_DATA* subresources, UINT firstSubresource, UINT numSubresources);
+
+        // Returns an invalid token when nothing was added since the last submit
+        UploadToken submit();
+
+        bool isEmpty() const { return !m_isRecording; }
+        const UploadBatchStats& getStats() const { return m_stats; }
+        StagingPoolStats getStagingStats() const { return m_stagingPool.getStats(); }
+
+    private:
+        struct StagingChunk
+        {
+            std::unique_ptr<ResourceDx12> buffer;
+            BYTE* mappedData = nullptr;
+            UploadPacker packer;
+
+            explicit StagingChunk(UINT64 capacity) : packer(capacity) {}
+        };
+
+        struct InFlightBatch
+        {
+            UINT64 fenceValue = 0;
+            ComPtr<ID3D12CommandAllocator> allocator;
+        };
+
+        void beginRecording();
+        void releaseCompleted();
+        void destroyEvictedChunks();
+        StagingChunk* acquireChunk(UINT64 minCapacity);
+        StagingChunk* getCurrentChunk() const;
+
+    private:
+        DeviceDx12* m_device = nullptr;
+
+        std::unique_ptr<CommandList> m_commandList;
+        ComPtr<ID3D12CommandAllocator> m_allocator;
+        bool m_isRecording = false;
+
+        StagingPool m_stagingPool;
+        std::vector<std::unique_ptr<StagingChunk>> m_chunkStorage; // Indexed by staging pool chunk id
+        std::vector<uint32_t> m_chunks;                            // Chunks filled by the batch being recorded
+        std::vector<uint32_t> m_evictedChunks;
+        std::vector<ComPtr<ID3D12CommandAllocator>> m_freeAllocators;
+        std::deque<InFlightBatch> m_inFlight;
+
+        UploadBatchStats m_stats = {};
+    };
+} // namespace raphael
@@ -32,6 +32,8 @@ namespace raphael
             desc.type = ResourceDesc::ResourceType::Buffer;
             desc.usage = ResourceDesc::Usage::Upload;
             desc.width = m_byteSize * elementCount;
+            desc.memoryCategory = isConstantBuffer ? MemoryCategory::ConstantBuffer : MemoryCategory::Staging;
+            desc.debugName = "Upload buffer";
 
             m_uploadBuffer = std::make_unique<ResourceDx12>(device, desc);
 
@@ -0,0 +1,81 @@
+#include "UploadPacker.h"
+
+namespace raphael
+{
+    static uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    UploadPacker::UploadPacker(uint64_t capacity)
+        : m_capacity(capacity)
+    {
+    }
+
+    uint64_t UploadPacker::reserve(uint64_t sizeInBytes, uint64_t alignment)
+    {
+        const uint64_t offset = alignUp(m_usedSize, alignment);
+        if (sizeInBytes == 0 || offset + sizeInBytes > m_capacity)
+        {
+            return InvalidOffset;
+        }
+
+        m_usedSize = offset + sizeInBytes;
+        m_uploadCount++;
+        return offset;
+    }
+
+    uint64_t UploadPacker::packBuffer(uint64_t sizeInBytes)
+    {
+        const uint64_t offset = reserve(sizeInBytes, BufferAlignment);
+        if (offset != InvalidOffset)
+        {
+            m_payloadSize += sizeInBytes;
+        }
+        return offset;
+    }
+
+    bool UploadPacker::packTexture(uint32_t rowSizeInBytes, uint32_t numRows, uint32_t depth, TextureFootprint* outFootprint)
+    {
+        const uint64_t totalSize = getTextureSize(rowSizeInBytes, numRows, depth);
+        const uint64_t offset = reserve(totalSize, TexturePlacementAlignment);
+        if (offset == InvalidOffset)
+        {
+            return false;
+        }
+
+        outFootprint->offset = offset;
+        outFootprint->rowPitch = getRowPitch(rowSizeInBytes);
+        outFootprint->rowSizeInBytes = rowSizeInBytes;
+        outFootprint->numRows = numRows;
+        outFootprint->depth = depth;
+        outFootprint->totalSize = totalSize;
+
+        m_payloadSize += static_cast<uint64_t>(rowSizeInBytes) * numRows * depth;
+        return true;
+    }
+
+    uint64_t UploadPacker::getTextureSize(uint32_t rowSizeInBytes, uint32_t numRows, uint32_t depth)
+    {
+        const uint64_t rowCount = static_cast<uint64_t>(numRows) * depth;
+        if (rowCount == 0 || rowSizeInBytes == 0)
+        {
+            return 0;
+        }
+
+        // Same rule as GetCopyableFootprints: every row but the last is padded to the pitch
+        return static_cast<uint64_t>(getRowPitch(rowSizeInBytes)) * (rowCount - 1) + rowSizeInBytes;
+    }
+
+    uint32_t UploadPacker::getRowPitch(uint32_t rowSizeInBytes)
+    {
+        return static_cast<uint32_t>(alignUp(rowSizeInBytes, TextureRowPitchAlignment));
+    }
+
+    void UploadPacker::reset()
+    {
+        m_usedSize = 0;
+        m_payloadSize = 0;
+        m_uploadCount = 0;
+    }
+} // namespace raphael
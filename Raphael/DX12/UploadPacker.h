@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+namespace raphael
+{
+    // Placement of one texture subresource inside a staging buffer, matches D3D12_PLACED_SUBRESOURCE_FOOTPRINT
+    struct TextureFootprint
+    {
+        uint64_t offset = 0;
+        uint32_t rowPitch = 0;       // Source row stride, padded to TextureRowPitchAlignment
+        uint32_t rowSizeInBytes = 0; // Bytes of real data in each row
+        uint32_t numRows = 0;        // Rows per slice (block rows for compressed formats)
+        uint32_t depth = 1;
+        uint64_t totalSize = 0;      // Staging bytes covered, the last row is not padded
+    };
+
+    // Linear packer that lays out buffer and texture uploads back to back in one staging allocation,
+    // applying the copy alignment rules (placement and row pitch) of the D3D12 copy engine.
+    // Backend independent so offsets and pitches can be validated without a device.
+    class UploadPacker
+    {
+    public:
+        static constexpr uint64_t InvalidOffset = ~0ull;
+        static constexpr uint64_t BufferAlignment = 16;              // Keeps memcpy destinations SIMD friendly
+        static constexpr uint64_t TextureRowPitchAlignment = 256;    // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+        static constexpr uint64_t TexturePlacementAlignment = 512;   // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+        explicit UploadPacker(uint64_t capacity);
+        ~UploadPacker() = default;
+
+        // Returns the offset of the buffer data or InvalidOffset if it does not fit
+        uint64_t packBuffer(uint64_t sizeInBytes);
+
+        // Returns false if the subresource does not fit
+        bool packTexture(uint32_t rowSizeInBytes, uint32_t numRows, uint32_t depth, TextureFootprint* outFootprint);
+
+        // Staging bytes a subresource needs, not counting placement padding
+        static uint64_t getTextureSize(uint32_t rowSizeInBytes, uint32_t numRows, uint32_t depth);
+        static uint32_t getRowPitch(uint32_t rowSizeInBytes);
+
+        void reset();
+
+        uint64_t getCapacity() const { return m_capacity; }
+        uint64_t getUsedSize() const { return m_usedSize; }
+        uint64_t getPayloadSize() const { return m_payloadSize; } // Used size minus alignment and pitch padding
+        uint32_t getUploadCount() const { return m_uploadCount; }
+
+    private:
+        uint64_t reserve(uint64_t sizeInBytes, uint64_t alignment);
+
+    private:
+        uint64_t m_capacity = 0;
+        uint64_t m_usedSize = 0;
+        uint64_t m_payloadSize = 0;
+        uint32_t m_uploadCount = 0;
+    };
+} // namespace raphael
@@ -0,0 +1,61 @@
+#include "UploadRingBufferDx12.h"
+#include "DeviceDx12.h"
+#include "ResourceDx12.h"
+
+namespace raphael
+{
+    UploadRingBufferDx12::UploadRingBufferDx12(DeviceDx12* device, UINT64 sizeInBytes)
+        : m_device(device), m_ring(sizeInBytes)
+    {
+        ResourceDesc desc = {};
+        desc.type = ResourceDesc::ResourceType::Buffer;
+        desc.usage = ResourceDesc::Usage::Upload;
+        desc.width = sizeInBytes;
+        desc.memoryCategory = MemoryCategory::ConstantBuffer;
+        desc.debugName = "Upload ring";
+
+        m_buffer = std::make_unique<ResourceDx12>(device, desc);
+
+        // Upload heaps can stay mapped for their whole lifetime, the fence guarantees we never
+        // overwrite a region the GPU is still reading from
+        if (!m_buffer->map(reinterpret_cast<void**>(&m_mappedData)))
+        {
+            throw std::runtime_error("Failed to map upload ring buffer");
+        }
+        m_gpuAddress = m_buffer->getNativeResource()->GetGPUVirtualAddress();
+    }
+
+    UploadRingBufferDx12::~UploadRingBufferDx12()
+    {
+        m_buffer->unmap();
+        m_mappedData = nullptr;
+    }
+
+    UploadAllocation UploadRingBufferDx12::allocate(UINT64 sizeInBytes, UINT64 alignment)
+    {
+        m_ring.releaseCompleted(m_device->getCompletedFenceValue());
+
+        UINT64 offset = m_ring.allocate(sizeInBytes, alignment);
+        while (offset == RingAllocator::InvalidOffset)
+        {
+            if (!m_ring.hasPendingFrames())
+            {
+                throw std::runtime_error("Upload ring buffer is too small for the requested allocation");
+            }
+
+            // Ring is exhausted: wait for the oldest in-flight region and try again
+            UINT64 oldestFence = m_ring.getOldestPendingFence();
+            m_device->waitForFence(oldestFence);
+            m_ring.releaseCompleted(oldestFence);
+            offset = m_ring.allocate(sizeInBytes, alignment);
+        }
+
+        UploadAllocation allocation = {};
+        allocation.cpuAddress = m_mappedData + offset;
+        allocation.gpuAddress = m_gpuAddress + offset;
+        allocation.resource = m_buffer->getNativeResource();
+        allocation.offset = offset;
+        allocation.size = sizeInBytes;
+        return allocation;
+    }
+} // namespace raphael
@@ -0,0 +1,46 @@
+#pragma once
+#include "D3D12CommonHeaders.h"
+#include "RingAllocator.h"
+
+namespace raphael
+{
+    class DeviceDx12;
+    class ResourceDx12;
+
+    // Slice of a persistently mapped upload heap, valid until the fence it was tagged with completes
+    struct UploadAllocation
+    {
+        void* cpuAddress = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+        ID3D12Resource* resource = nullptr;
+        UINT64 offset = 0;
+        UINT64 size = 0;
+    };
+
+    // Large persistently mapped upload buffer sub-allocated through a RingAllocator.
+    // Regions are tagged every time the device signals its fence and recycled once the fence completes.
+    class UploadRingBufferDx12
+    {
+    public:
+        UploadRingBufferDx12(DeviceDx12* device, UINT64 sizeInBytes);
+        ~UploadRingBufferDx12();
+
+        UploadRingBufferDx12(const UploadRingBufferDx12& rhs) = delete;
+        UploadRingBufferDx12& operator=(const UploadRingBufferDx12& rhs) = delete;
+
+        // Blocks on the oldest in-flight region only when the ring is exhausted
+        UploadAllocation allocate(UINT64 sizeInBytes, UINT64 alignment);
+
+        void finishFrame(UINT64 fenceValue) { m_ring.finishFrame(fenceValue); }
+        void releaseCompleted(UINT64 completedFenceValue) { m_ring.releaseCompleted(completedFenceValue); }
+
+        const RingAllocator& getRing() const { return m_ring; }
+
+    private:
+        DeviceDx12* m_device = nullptr;
+        std::unique_ptr<ResourceDx12> m_buffer;
+        BYTE* m_mappedData = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS m_gpuAddress = 0;
+        RingAllocator m_ring;
+    };
+} // namespace raphael
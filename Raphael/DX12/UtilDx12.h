@@ -1,6 +1,7 @@
 #pragma once
 #include "D3D12CommonHeaders.h"
 #include "Constants.h"
+#include "ResourceStateTracker.h"
 
 namespace raphael
 {
@@ -85,4 +86,49 @@ namespace raphael
             return D3D12_CULL_MODE_BACK;
         }
 	 }
-}
\ No newline at end of file
+
+    inline D3D12_COMMAND_LIST_TYPE convertCommandListTypeToD3D12(CommandListType type)
+    {
+        switch (type)
+        {
+        case CommandListType::Direct:
+            return D3D12_COMMAND_LIST_TYPE_DIRECT;
+        case CommandListType::Copy:
+            return D3D12_COMMAND_LIST_TYPE_COPY;
+        default:
+            return D3D12_COMMAND_LIST_TYPE_DIRECT;
+        }
+    }
+
+    // ResourceState mirrors the D3D12 bits, the casts below rely on it
+    static_assert(static_cast<uint32_t>(ResourceState::RenderTarget) == D3D12_RESOURCE_STATE_RENDER_TARGET);
+    static_assert(static_cast<uint32_t>(ResourceState::DepthWrite) == D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    static_assert(static_cast<uint32_t>(ResourceState::PixelShaderResource) == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    static_assert(static_cast<uint32_t>(ResourceState::CopyDest) == D3D12_RESOURCE_STATE_COPY_DEST);
+    static_assert(static_cast<uint32_t>(ResourceState::GenericRead) == D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    inline D3D12_RESOURCE_STATES convertResourceStateToD3D12(ResourceState state)
+    {
+        return static_cast<D3D12_RESOURCE_STATES>(state);
+    }
+
+    inline ResourceState convertResourceStateFromD3D12(D3D12_RESOURCE_STATES state)
+    {
+        return static_cast<ResourceState>(state);
+    }
+
+    inline D3D12_RESOURCE_BARRIER convertTransitionToD3D12(const ResourceTransition& transition, ID3D12Resource* resource)
+    {
+        D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        if (transition.flags == ResourceTransitionFlags::BeginOnly)
+            flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+        else if (transition.flags == ResourceTransitionFlags::EndOnly)
+            flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+
+        return CD3DX12_RESOURCE_BARRIER::Transition(resource,
+            convertResourceStateToD3D12(transition.before),
+            convertResourceStateToD3D12(transition.after),
+            D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+            flags);
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace raphael
+{
+    // Chase-Lev work-stealing deque of pointers with a fixed power-of-two capacity, following the
+    // weak-memory formulation of Le, Pop, Cohen and Zappa Nardelli (PPoPP 2013).
+    // The owning thread pushes and pops at the bottom (LIFO, cache friendly), any other thread steals
+    // from the top (FIFO, takes the oldest and usually largest piece of work).
+    // push() fails instead of growing when the deque is full, the owner then runs the work itself.
+    template<typename T>
+    class WorkStealingDeque
+    {
+        static_assert(std::is_pointer_v<T>, "WorkStealingDeque stores pointers");
+
+    public:
+        explicit WorkStealingDeque(uint32_t capacity)
+            : m_capacity(capacity), m_mask(capacity - 1), m_buffer(std::make_unique<std::atomic<T>[]>(capacity))
+        {
+            if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+            {
+                throw std::runtime_error("Work-stealing deque capacity must be a power of two");
+            }
+        }
+
+        WorkStealingDeque(const WorkStealingDeque& rhs) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque& rhs) = delete;
+
+        // Owner only
+        bool push(T item)
+        {
+            const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            const int64_t top = m_top.load(std::memory_order_acquire);
+            if (bottom - top >= static_cast<int64_t>(m_capacity))
+            {
+                return false;
+            }
+
+            m_buffer[bottom & m_mask].store(item, std::memory_order_relaxed);
+            // Publishes the item to thieves, pairs with the acquire load of m_bottom in steal()
+            m_bottom.store(bottom + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Owner only, returns nullptr when empty or when a thief won the last item
+        T pop()
+        {
+            const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T item = m_buffer[bottom & m_mask].load(std::memory_order_relaxed);
+            if (top == bottom)
+            {
+                // Last item: race the thieves for it
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        // Any thread, returns nullptr when empty or when it lost a race
+        T steal()
+        {
+            int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom)
+            {
+                return nullptr;
+            }
+
+            T item = m_buffer[top & m_mask].load(std::memory_order_relaxed);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return item;
+        }
+
+        // Approximate when other threads are active
+        bool isEmpty() const
+        {
+            return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+        }
+
+        uint32_t getCapacity() const { return m_capacity; }
+
+    private:
+        // Thieves hammer m_top, keep it off the owner's cache line
+        alignas(64) std::atomic<int64_t> m_top{ 0 };
+        alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+        uint32_t m_capacity = 0;
+        int64_t m_mask = 0;
+        std::unique_ptr<std::atomic<T>[]> m_buffer;
+    };
+} // namespace raphael
@@ -146,6 +146,8 @@ void BoxDemo::CreateSwapChainAndDepthBuffer(WindowInfo windowInfo)
     depthDesc.height = windowInfo.height;
     depthDesc.format = ResourceFormat::D24_UNORM_S8_UINT;
     depthDesc.bindFlags = ResourceBindFlags::DepthStencil;
+    depthDesc.memoryCategory = MemoryCategory::DepthStencil;
+    depthDesc.debugName = "Depth buffer";
 
     m_depthBuffer = m_device->createResource(depthDesc);
 
@@ -200,6 +202,8 @@ void BoxDemo::CreateGeometry()
     vertexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     vertexBufferDesc.usage = ResourceDesc::Usage::Upload;
     vertexBufferDesc.width = vertexBufferSize;
+    vertexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    vertexBufferDesc.debugName = "Vertex buffer";
 
     m_vertexBuffer = m_device->createResource(vertexBufferDesc);
 
@@ -224,6 +228,8 @@ void BoxDemo::CreateGeometry()
     indexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     indexBufferDesc.usage = ResourceDesc::Usage::Upload;
     indexBufferDesc.width = indexBufferSize;
+    indexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    indexBufferDesc.debugName = "Index buffer";
 
     m_indexBuffer = m_device->createResource(indexBufferDesc);
 
@@ -246,11 +252,8 @@ void BoxDemo::CreateGeometry()
 
 void BoxDemo::CreateConstantBuffers()
 {
-    for (UINT i = 0; i < g_frameCount; i++)
-    {
-        m_frameCBs[i] = std::make_unique<UploadBuffer<FrameConstants>>(m_device.get(), 1, true);
-        m_objectCBs[i] = std::make_unique<UploadBuffer<BasicObjectConstants>>(m_device.get(), 1, true);
-    }
+    m_frameCBs.create(g_frameCount, [&](uint32_t) { return std::make_unique<UploadBuffer<FrameConstants>>(m_device.get(), 1, true); });
+    m_objectCBs.create(g_frameCount, [&](uint32_t) { return std::make_unique<UploadBuffer<BasicObjectConstants>>(m_device.get(), 1, true); });
 }
 
 void BoxDemo::CreateRootSignature()
@@ -407,7 +410,7 @@ void BoxDemo::Render()
     const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
     RenderPassDesc renderPassDesc = RenderPassDesc::buildAsSingleRenderTarget(
         currentRtView,
-        currentBackBuffer->getNativeResource(),
+        currentBackBuffer,
         m_depthStencilView,
         WINDOW_WIDTH, WINDOW_HEIGHT,
         clearColor);
@@ -498,6 +501,8 @@ void BoxDemo::Resize(unsigned int width, unsigned int height)
         depthDesc.height = newHeight;
         depthDesc.format = ResourceFormat::D24_UNORM_S8_UINT;
         depthDesc.bindFlags = ResourceBindFlags::DepthStencil;
+        depthDesc.memoryCategory = MemoryCategory::DepthStencil;
+        depthDesc.debugName = "Depth buffer";
 
         m_depthBuffer = m_device->createResource(depthDesc);
 
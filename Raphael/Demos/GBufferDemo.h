@@ -6,21 +6,50 @@
 #include "ShaderDx12.h"
 #include "RootSignatureDx12.h"
 #include "DescriptorHeapDx12.h"
+#include "DescriptorRingDx12.h"
 #include "PipelineDx12.h"
 #include "SwapChainDx12.h"
 #include "FrameContext.h"
+#include "FrameScheduler.h"
+#include "FrameResource.h"
+#include "FrameArena.h"
+#include "HeapAllocationCounter.h"
 #include "UploadBufferDx12.h"
+#include "TransientHeapDx12.h"
+#include "ParallelCommandListsDx12.h"
+#include "RecordPartition.h"
+#include "JobSystem.h"
+#include "RenderGraphDx12.h"
+#include "CommandStreamDx12.h"
+#include "FramePipeline.h"
+#include "FrustumCulling.h"
 #include "GPUStructs.h"
 #include "ImGuiLoader.h"
 #include "Window.h"
+#include "GltfGeometryImporter.h"
 
 #include "tinygltf/tiny_gltf.h"
+#include <atomic>
 
 using namespace raphael;
 
-static constexpr uint32_t g_frameCount = 2;
+static constexpr uint32_t g_backBufferCount = MaxFramesInFlight; // Present never caps the frames in flight
+static constexpr uint32_t g_descriptorRingSize = 1024; // Transient shader visible descriptors shared by all frames in flight
+static constexpr uint32_t g_maxRecordThreads = 8; // Upper bound on draw ranges recorded in parallel
+static constexpr uint32_t g_minDrawsPerList = 4;  // Fewer draws are not worth their own command list
+static constexpr uint32_t g_lodLevelCount = 4;    // Full detail and three clustered levels per primitive
 static constexpr int g_numRenderTargets = 3;
 
+// One simulation step as the render thread sees it, written by the simulation thread only
+struct GBufferFrameSnapshot
+{
+    BasicObjectConstants objectConstants;
+    XMFLOAT4X4 view = XM4x4Identity();
+    XMFLOAT3 eyePosition = { 0.0f, 0.0f, 0.0f };
+    std::vector<uint32_t> visibleDraws; // Draw indices that pass frustum culling, reserved for every draw up front
+    std::vector<uint8_t> visibleDrawLevels; // Level of detail of each visible draw, reserved the same way
+};
+
 class GBufferImGui : public ImGuiLoader
 {
 public:
@@ -30,6 +59,25 @@ public:
     bool showShaderError = false;
 
     bool wireframe = false;
+    uint64_t frameHeapAllocations = 0;
+    size_t frameArenaBytes = 0;
+    uint64_t transientHeapBytes = 0;
+    uint64_t transientSavedBytes = 0;
+    bool parallelRecording = true;
+    uint32_t recordListCount = 0;
+    uint64_t recordAllocatorCount = 0;
+    uint64_t stateCallsIssued = 0; // Last frame
+    uint64_t stateCallsElided = 0;
+    int framesInFlight = 2;
+    uint64_t frameWaitCount = 0; // Frames that waited for the GPU to free their slot
+    uint64_t frameCount = 0;
+    uint32_t visibleDrawCount = 0;
+    uint32_t totalDrawCount = 0;
+    bool levelOfDetail = true;
+    uint32_t lodDrawCounts[g_lodLevelCount] = {}; // Visible draws at each level
+    bool simulationThread = true;
+    double simulateMs = 0.0;
+    double snapshotLatencyMs = 0.0;
 };
 
 class GBufferDemo : public IDemo
@@ -41,6 +89,12 @@ class GBufferDemo : public IDemo
         Depth = 2
 	};
 
+    // Passes of the frame in recording order, transient target lifetimes are expressed in them
+    enum FramePass : uint32_t
+    {
+        BasePass = 0
+    };
+
 public:
     bool Initialize(WindowInfo windowInfo) override;
     void Shutdown() override;
@@ -51,18 +105,19 @@ private:
     // ---- Initialization helpers (one per logical step) ----
     void CreateGltfModel();
     void CreateDescriptorHeaps();
-	void CreateGBufferRenderTargets();
-    void CreateSwapChainAndDepthBuffer(WindowInfo windowInfo);
+    void CreateSwapChain(WindowInfo windowInfo);
+    void CreateTransientTargets(UINT width, UINT height);
     void CreateGeometry();
     void CreateTexture();
     void CreateDummyTexture();
-    void CreateConstantBuffers();
     void CreateRootSignature();
     void CreatePipeline();
     void CreateCommandObjects();
+    void RecordDrawStateStream();
 
     // ---- Per-frame helpers ----
-    void UpdateConstantBuffers();
+    void Simulate(GBufferFrameSnapshot& snapshot, double deltaSeconds);
+    void UpdateConstantBuffers(const GBufferFrameSnapshot& snapshot);
 
     // ---- Process input ----
     void ProcessInput();
@@ -72,10 +127,20 @@ private:
     std::unique_ptr<DeviceDx12> m_device;
     std::unique_ptr<SwapChainDx12> m_swapChain;
     std::unique_ptr<CommandList> m_commandList;
+    std::unique_ptr<JobSystem> m_jobSystem;
+    std::unique_ptr<ParallelCommandListsDx12> m_parallelLists; // Per-range lists with fence-recycled allocators
+    std::unique_ptr<RenderGraphDx12> m_renderGraph; // Rebuilt every frame, keeps its capacity
+    std::unique_ptr<CommandStreamDx12> m_streamTranslator; // Object tables of the recorded streams
+    CommandStream m_drawStateStream; // Heaps, root signature, pipeline and geometry, recorded once
+    CommandStateCacheStats m_stateCacheTotals = {}; // Command list counters at the end of the last frame
+    std::unique_ptr<FramePipeline<GBufferFrameSnapshot>> m_framePipeline; // Simulation thread feeding Render() with snapshots
+    std::unique_ptr<UploadBatchDx12> m_uploadBatch;
+    UploadToken m_uploadToken = {}; // Copy queue fence of the initial geometry and texture uploads
     std::unique_ptr<DescriptorHeapDx12> m_dsvHeap;
     std::unique_ptr<DescriptorHeapDx12> m_rtvHeap;
-    std::unique_ptr<DescriptorHeapDx12> m_textureSrvHeap;
-    std::unique_ptr<ResourceDx12> m_depthBuffer;
+    std::unique_ptr<DescriptorHeapDx12> m_textureSrvHeap; // Shader visible: ImGui font + transient descriptor ring
+    std::unique_ptr<DescriptorHeapDx12> m_stagingSrvHeap; // CPU only: persistent texture SRVs copied into the ring
+    std::unique_ptr<DescriptorRingDx12> m_descriptorRing;
 
     // Geometry resources
     std::unique_ptr<ResourceDx12> m_vertexBuffer;
@@ -87,7 +152,6 @@ private:
     // Texture resources
     struct TextureData {
         std::unique_ptr<ResourceDx12> m_textureDefaultBuffer;
-        std::unique_ptr<ResourceDx12> m_textureUploadBuffer;
     };
     std::vector<TextureData> m_textures;
 
@@ -95,9 +159,9 @@ private:
     TextureData m_whiteTexture;
     ResourceView m_whiteTextureSrv;
 
-    // Constant buffers (one per frame for double buffering)
-    std::array<std::unique_ptr<UploadBuffer<FrameConstants>>, g_frameCount> m_frameCBs;
-    std::array<std::unique_ptr<UploadBuffer<BasicObjectConstants>>, g_frameCount> m_objectCBs;
+    // Constant buffers for the current frame (sub-allocated from the device upload ring)
+    D3D12_GPU_VIRTUAL_ADDRESS m_frameCBAddress = 0;
+    D3D12_GPU_VIRTUAL_ADDRESS m_objectCBAddress = 0;
 
     // Pipeline resources
     std::unique_ptr<ShaderDx12> m_shader;
@@ -110,8 +174,11 @@ private:
     // Render state
     ResourceView m_depthStencilView = {};
     std::vector<ResourceView> m_textureSrvs;
-    // Per-frame resources for double buffering
-    std::array<FrameContext, g_frameCount> m_frameContexts;
+    // Transient CPU memory for per-frame lists, one arena per frame in flight
+    FrameArenaPool m_frameArenas{ MaxFramesInFlight, 1 };
+    // Picks the frame slot and waits only when the CPU is framesInFlight frames ahead of the GPU
+    FrameScheduler m_frameScheduler;
+    FrameResource<FrameContext> m_frameContexts;
 
     // GLTF model data
     std::unique_ptr<tinygltf::Model> m_gltfModel;
@@ -122,13 +189,24 @@ private:
         int textureIndex = -1; // Index of the texture used by this mesh
     };
     std::vector<MeshData> m_meshes;
+    std::vector<GltfPrimitiveLods> m_meshLods; // Parallel to m_meshes
     
-	// GBuffer texture resources
-	std::array<std::unique_ptr<ResourceDx12>, g_numRenderTargets> m_gbufferTextures;
+	// GBuffer render targets and depth buffer, placed in a shared transient heap
+    std::unique_ptr<TransientHeapDx12> m_transientTargets;
+    std::array<uint32_t, g_numRenderTargets> m_gbufferTargets = {};
+    uint32_t m_depthTarget = 0;
     std::unique_ptr<DescriptorHeapDx12> m_gbufferRtvHeap;
 
-    // Camera and transform state
+    // Camera and transform state, owned by the simulation thread
     float m_rotationAngle = 0.0f;
+    // Object space bounds of every draw, culled on the simulation thread against the model space frustum
+    CullingBounds m_cullingBounds;
+    FrustumCuller m_frustumCuller;
+    std::atomic<float> m_cullAspectRatio{ 1.0f }; // Written by Initialize() and Resize()
+    std::atomic<float> m_viewportHeight{ 1.0f };  // Same
+    // Level of detail of every draw from its projected error, with hysteresis. The demo shaders do not
+    // cross-fade, so levels switch at once.
+    LodSelector m_lodSelector;
 
     // ImGui support
     GBufferImGui m_imguiLoader;
@@ -14,7 +14,29 @@ void GltfImGui::Display()
     ImGui::Begin("GLTF Demo");
     ImGui::Text("GLTF render");
     ImGui::Checkbox("Wireframe", &wireframe);
+    if (isHeapAllocationCountingEnabled())
+    {
+        ImGui::Text("Heap allocations last frame: %llu", static_cast<unsigned long long>(frameHeapAllocations));
+    }
+    else
+    {
+        ImGui::Text("Heap allocations last frame: not counted in this build");
+    }
+    ImGui::Text("Frame arena: %.1f KB", frameArenaBytes / 1024.0);
+    ImGui::Checkbox("Parallel recording", &parallelRecording);
+    ImGui::Text("Command lists: %u, pooled allocators: %llu", recordListCount, static_cast<unsigned long long>(recordAllocatorCount));
+    ImGui::Text("State calls: %llu issued, %llu skipped as redundant",
+        static_cast<unsigned long long>(stateCallsIssued), static_cast<unsigned long long>(stateCallsElided));
+    ImGui::SliderInt("Frames in flight", &framesInFlight, 1, static_cast<int>(MaxFramesInFlight));
+    ImGui::Text("GPU waits: %llu of %llu frames", static_cast<unsigned long long>(frameWaitCount), static_cast<unsigned long long>(frameCount));
+    ImGui::Text("Frustum culling: %u of %u draws visible", visibleDrawCount, totalDrawCount);
+    ImGui::Checkbox("Level of detail", &levelOfDetail);
+    ImGui::Text("Draws per level: %u / %u / %u / %u", lodDrawCounts[0], lodDrawCounts[1], lodDrawCounts[2], lodDrawCounts[3]);
+    ImGui::Checkbox("Simulation thread", &simulationThread);
+    ImGui::Text("Simulation: %.2f ms, snapshot age at render: %.2f ms", simulateMs, snapshotLatencyMs);
     ImGui::End();
+
+    DisplayMemoryTracker();
 }
 
 // Forward declare message handler from imgui_impl_win32.cpp
@@ -27,7 +49,7 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 // 4. Create swap chain + depth buffer
 // 5. Create command objects (command allocators, command lists)
 // 6. Create geometry resources (vertex/index buffers, views)
-// 7. Constant buffers (per-frame upload buffers)
+// 7. Constant buffers (per-frame slices of the device upload ring)
 // 8. Create root signature (define shader resource bindings)
 // 9. Create pipeline state (compile shaders, create PSO)
 // 10. Create texture resources (load texture, create SRV)
@@ -38,6 +60,8 @@ bool GltfDemo::Initialize(WindowInfo windowInfo)
 
     // Store the window handle for input processing (sad thing)
     m_windowHandle = windowInfo.hWnd;
+    m_cullAspectRatio = static_cast<float>(windowInfo.width) / static_cast<float>(windowInfo.height);
+    m_viewportHeight = static_cast<float>(windowInfo.height);
 
     // -- 2. Create device --
     DeviceDesc deviceDesc = {};
@@ -52,7 +76,7 @@ bool GltfDemo::Initialize(WindowInfo windowInfo)
     CreateDescriptorHeaps();
 
     // -- 4. Initialize ImGui --
-    if (!m_imguiLoader.Initialize(windowInfo.hWnd, m_device.get(), m_textureSrvHeap.get(), g_frameCount))
+    if (!m_imguiLoader.Initialize(windowInfo.hWnd, m_device.get(), m_textureSrvHeap.get(), MaxFramesInFlight))
         return false;
 
     // -- 4. Create swap chain and depth buffer --
@@ -64,8 +88,7 @@ bool GltfDemo::Initialize(WindowInfo windowInfo)
     // -- 6. Create geometry resources --
     CreateGeometry();
 
-    // -- 7. Create constant buffers --
-    CreateConstantBuffers();
+    // -- 7. Constant buffers are sub-allocated per frame from the device upload ring --
 
     // -- 8. Create root signature --
     CreateRootSignature();
@@ -77,6 +100,21 @@ bool GltfDemo::Initialize(WindowInfo windowInfo)
     CreateTexture();
 	CreateDummyTexture();
 
+    // Geometry and texture uploads were gathered into one batch: submit it to the copy queue without
+    // waiting, the first frame makes the direct queue wait on the returned token
+    m_uploadToken = m_uploadBatch->submit();
+
+    // -- 11. Start the simulation thread, it works on the next snapshot while Render() records the current one --
+    const uint32_t drawCount = m_cullingBounds.getPaddedCount(); // The culler writes whole SIMD groups
+    m_framePipeline = std::make_unique<FramePipeline<GltfFrameSnapshot>>(
+        [this](GltfFrameSnapshot& snapshot, double deltaSeconds) { Simulate(snapshot, deltaSeconds); },
+        [drawCount](GltfFrameSnapshot& snapshot)
+        {
+            snapshot.visibleDraws.reserve(drawCount);
+            snapshot.visibleDrawLevels.reserve(drawCount);
+        });
+    m_framePipeline->start();
+
     return true;
 }
 
@@ -94,7 +132,7 @@ void GltfDemo::CreateGltfModel()
 
 // 3. Create descriptor heaps 
 // For this simple app, we only need 2 non-shader visible heaps and 1 shader visible heap:
-// - RTV  heap: g_frameCount descriptors for the back buffer RTVs (one per frame in the swap chain)
+// - RTV  heap: g_backBufferCount descriptors for the back buffer RTVs (one per frame in the swap chain)
 // - DSV heaps: 1 descriptor for the depth buffer DSV
 // - CBV/SRV/UAV heap: 1 descriptor for the texture SRV
 void GltfDemo::CreateDescriptorHeaps()
@@ -111,20 +149,32 @@ void GltfDemo::CreateDescriptorHeaps()
     // Create RTV descriptor heap
     DescriptorHeapDesc rtvHeapDesc = {};
     rtvHeapDesc.type = DescriptorHeapDesc::DescriptorHeapType::RTV;
-    rtvHeapDesc.numDescriptors = g_frameCount; // One RTV for each back buffer
+    rtvHeapDesc.numDescriptors = g_backBufferCount; // One RTV for each back buffer
     rtvHeapDesc.shaderVisible = false; // RTV heap does not need to be shader visible
 
     m_rtvHeap = m_device->createDescriptorHeap(rtvHeapDesc);
     m_rtvHeap->createDescriptorHeap();
 
+    // Persistent texture SRVs live in a CPU-only staging heap and are copied into the shader visible ring per frame
+    DescriptorHeapDesc stagingSrvHeapDesc = {};
+    stagingSrvHeapDesc.type = DescriptorHeapDesc::DescriptorHeapType::CBV_SRV_UAV;
+    // One SRV for each texture in the model + 1 for dummy white texture
+    stagingSrvHeapDesc.numDescriptors = static_cast<UINT>(m_gltfModel->textures.size() + 1);
+    stagingSrvHeapDesc.shaderVisible = false;
+
+    m_stagingSrvHeap = m_device->createDescriptorHeap(stagingSrvHeapDesc);
+    m_stagingSrvHeap->createDescriptorHeap();
+
     DescriptorHeapDesc textureSrvHeapDesc = {};
     textureSrvHeapDesc.type = DescriptorHeapDesc::DescriptorHeapType::CBV_SRV_UAV;
-    // One SRV for each texture in the model + 1 for ImGui font texture + 1 for dummy white texture
-	textureSrvHeapDesc.numDescriptors = static_cast<UINT>(m_gltfModel->textures.size() + 2); 
+    // 1 for ImGui font texture + the transient descriptor ring
+    textureSrvHeapDesc.numDescriptors = 1 + g_descriptorRingSize;
     textureSrvHeapDesc.shaderVisible = true; // This heap needs to be shader visible since we'll bind the texture SRV to the pipeline
 
     m_textureSrvHeap = m_device->createDescriptorHeap(textureSrvHeapDesc);
     m_textureSrvHeap->createDescriptorHeap();
+
+    m_descriptorRing = std::make_unique<DescriptorRingDx12>(m_device.get(), m_textureSrvHeap.get(), g_descriptorRingSize);
 }
 
 // 4. Create swap chain and depth buffer
@@ -137,7 +187,7 @@ void GltfDemo::CreateSwapChainAndDepthBuffer(WindowInfo windowInfo)
     SwapChainDesc swapChainDesc = {};
     swapChainDesc.width = windowInfo.width;
     swapChainDesc.height = windowInfo.height;
-    swapChainDesc.bufferCount = g_frameCount;
+    swapChainDesc.bufferCount = g_backBufferCount;
     swapChainDesc.windowHandle = windowInfo.hWnd;
 
     m_swapChain = m_device->createSwapChain(m_rtvHeap.get(), swapChainDesc);
@@ -149,6 +199,8 @@ void GltfDemo::CreateSwapChainAndDepthBuffer(WindowInfo windowInfo)
     depthDesc.height = windowInfo.height;
     depthDesc.format = ResourceFormat::D24_UNORM_S8_UINT;
     depthDesc.bindFlags = ResourceBindFlags::DepthStencil;
+    depthDesc.memoryCategory = MemoryCategory::DepthStencil;
+    depthDesc.debugName = "Depth buffer";
 
     m_depthBuffer = m_device->createResource(depthDesc);
 
@@ -159,269 +211,115 @@ void GltfDemo::CreateSwapChainAndDepthBuffer(WindowInfo windowInfo)
 }
 
 // 5. Create command allocators and command list
-// Each frame in the swap chain gets its own command allocator, 
+// Each frame slot gets its own command allocator, 
 // which we will reset at the beginning of each frame when we record commands for that frame. 
 // We only need one command list since we will execute it and wait for it to finish 
 // before recording commands for the next frame.
 void GltfDemo::CreateCommandObjects()
 {
-    // Create per frame command allocators
-    for (UINT i = 0; i < g_frameCount; i++)
+    // Create command allocators for every frame slot, the frames in flight can change at runtime
+    m_frameContexts.create(MaxFramesInFlight, [&](uint32_t)
     {
-        m_frameContexts[i].commandAllocator = m_device->createCommandAllocator();
-        m_frameContexts[i].fenceValue = 0;
-    }
+        FrameContext frameContext;
+        frameContext.commandAllocator = m_device->createCommandAllocator();
+        return frameContext;
+    });
 
     // Create command list (use the first frame's command allocator for now, we will reset it each frame before recording commands)
     CommandListDesc cmdListDesc = {};
     m_commandList = m_device->createCommandList(cmdListDesc);
     m_commandList->createCommandList(m_frameContexts[0].commandAllocator.Get());
+
+    // Parallel recording: worker threads plus this one, each draw range gets its own list and pooled allocators.
+    // Two extra lists open and close the render pass around the draw ranges.
+    const uint32_t workerCount = std::clamp(std::thread::hardware_concurrency(), 2u, g_maxRecordThreads) - 1;
+    m_jobSystem = std::make_unique<JobSystem>(workerCount);
+    m_parallelLists = std::make_unique<ParallelCommandListsDx12>(m_device.get(), g_maxRecordThreads + 2);
+    m_renderGraph = std::make_unique<RenderGraphDx12>();
+    m_streamTranslator = std::make_unique<CommandStreamDx12>();
+
+    // Uploads are recorded on their own COPY command list and executed on the copy queue
+    m_uploadBatch = std::make_unique<UploadBatchDx12>(m_device.get());
 }
 
 // 6. Create geometry resources (vertex/index buffers, views)
 void GltfDemo::CreateGeometry()
 {
-    // TODO: Add warning handling
-
-    // Step 3: Extract vertex positions
-    std::vector<VertexWithTexCoord> totalVertices;
-    std::vector<std::uint16_t> totalIndices;
-
-    UINT vertexOffset = 0;
-    UINT indexOffset = 0;
+    // Step 1: Size every mesh primitive from the accessor counts, no vertex or index data is read yet
+    GltfGeometryImporter importer(*m_gltfModel);
+    const GltfGeometryLayout& layout = importer.getLayout();
 
-    for (const tinygltf::Mesh& mesh : m_gltfModel->meshes)
+    for (const GltfPrimitiveRange& primitive : layout.primitives)
     {
-        // Process the loaded model data and create vertex/index buffers
-        // Step 1: Get meshes
-        OutputDebugStringA(("Loading mesh: " + mesh.name + "\n").c_str());
-
-        size_t primitiveIndex = 0;
-        size_t primitiveCount = mesh.primitives.size();
-        for (const tinygltf::Primitive& primitive : mesh.primitives)
+        MeshData meshData = {};
+        meshData.vertexBufferOffset = primitive.vertexOffset;
+        meshData.indexBufferOffset = primitive.indexOffset;
+        meshData.indexCount = primitive.indexCount;
+        // m_textureSrvs follows the model's texture order, primitives without a base color texture sample white
+        if (primitive.materialIndex >= 0 && primitive.materialIndex < static_cast<int>(m_gltfModel->materials.size()))
         {
-            std::string primitiveName = mesh.name + "_primitive_" + std::to_string(primitiveIndex);
-            OutputDebugStringA(("Loading primitive: " + primitiveName + "\n").c_str());
-
-            std::vector<VertexWithTexCoord> vertices;
-
-            // Find the POSITION attribute
-            auto positionAttrIt = primitive.attributes.find("POSITION");
-            if (positionAttrIt == primitive.attributes.end())
-            {
-                throw std::runtime_error("Mesh primitive does not contain POSITION attribute");
-            }
-
-            int positionAccessorIndex = positionAttrIt->second;
-            // This accessor describes how to read the position data (e.g., type, count, etc.)
-            const tinygltf::Accessor& positionAccessor = m_gltfModel->accessors[positionAccessorIndex];
-            // This buffer view describes the layout of the buffer (e.g., byte offset, stride, etc.)
-            const tinygltf::BufferView& positionBufferView = m_gltfModel->bufferViews[positionAccessor.bufferView];
-            // This buffer contains the actual binary data for the positions
-            const tinygltf::Buffer& positionBuffer = m_gltfModel->buffers[positionBufferView.buffer];
-            // Calculate the pointer to the position data
-            const float* positionData = reinterpret_cast<const float*>(&positionBuffer.data[positionBufferView.byteOffset + positionAccessor.byteOffset]);
-
-            size_t vertexCount = positionAccessor.count;
-            OutputDebugStringA(("Vertex count: " + std::to_string(vertexCount) + "\n").c_str());
-
-            // Step 4: Extract vertex normals (if available)
-            auto normalAttrIt = primitive.attributes.find("NORMAL");
-            if (normalAttrIt == primitive.attributes.end())
-            {
-                throw std::runtime_error("Mesh primitive does not contain POSITION attribute");
-            }
-
-            int normalAccessorIndex = normalAttrIt->second;
-            // This accessor describes how to read the normal data (e.g., type, count, etc.)
-            const tinygltf::Accessor& normalAccessor = m_gltfModel->accessors[normalAccessorIndex];
-            // This buffer view describes the layout of the buffer (e.g., byte offset, stride, etc.)
-            const tinygltf::BufferView& normalBufferView = m_gltfModel->bufferViews[normalAccessor.bufferView];
-            // This buffer contains the actual binary data for the normals
-            const tinygltf::Buffer& normalBuffer = m_gltfModel->buffers[normalBufferView.buffer];
-
-            // Calculate the pointer to the normal data
-            const float* normalData = reinterpret_cast<const float*>(&normalBuffer.data[normalBufferView.byteOffset + normalAccessor.byteOffset]);
-
-            // Step 5: Extract texture coordinates (if available)
-            auto texCoordAttrIt = primitive.attributes.find("TEXCOORD_0");
-            if (texCoordAttrIt == primitive.attributes.end())
-            {
-                throw std::runtime_error("Mesh primitive does not contain POSITION attribute");
-            }
-
-            int textureAccessorIndex = texCoordAttrIt->second;
-            // This accessor describes how to read the texture data (e.g., type, count, etc.)
-            const tinygltf::Accessor& textureAccessor = m_gltfModel->accessors[textureAccessorIndex];
-            // This buffer view describes the layout of the buffer (e.g., byte offset, stride, etc.)
-            const tinygltf::BufferView& textureBufferView = m_gltfModel->bufferViews[textureAccessor.bufferView];
-            // This buffer contains the actual binary data for the textures
-            const tinygltf::Buffer& textureBuffer = m_gltfModel->buffers[textureBufferView.buffer];
-
-            // Calculate the pointer to the position data
-            const float* textureData = reinterpret_cast<const float*>(&textureBuffer.data[textureBufferView.byteOffset + textureAccessor.byteOffset]);
-
-            // Step 6: Create vertex array
-            vertices.resize(vertexCount);
-            for (size_t i = 0; i < vertexCount; ++i)
-            {
-                vertices[i].Pos = XMFLOAT3(positionData[i * 3], positionData[i * 3 + 1], positionData[i * 3 + 2]);
-
-                // TODO: Set normals and texture coordinates if available
-                vertices[i].Normal = XMFLOAT3(normalData[i * 3], normalData[i * 3 + 1], normalData[i * 3 + 2]);
-                vertices[i].TexC = XMFLOAT2(textureData[i * 2], textureData[i * 2 + 1]);
-            }
+            meshData.textureIndex = m_gltfModel->materials[primitive.materialIndex].pbrMetallicRoughness.baseColorTexture.index;
+        }
+        m_meshes.push_back(meshData);
+
+        const float center[3] = { (primitive.boundsMin[0] + primitive.boundsMax[0]) * 0.5f,
+                                  (primitive.boundsMin[1] + primitive.boundsMax[1]) * 0.5f,
+                                  (primitive.boundsMin[2] + primitive.boundsMax[2]) * 0.5f };
+        const float extents[3] = { (primitive.boundsMax[0] - primitive.boundsMin[0]) * 0.5f,
+                                   (primitive.boundsMax[1] - primitive.boundsMin[1]) * 0.5f,
+                                   (primitive.boundsMax[2] - primitive.boundsMin[2]) * 0.5f };
+        m_cullingBounds.addBox(center, extents);
+    }
 
-            // Step 7: Extract indices
-            std::vector<std::uint16_t> indices;
+    // Step 2: Plan the coarser levels of detail, clustered from the accessors. Only their sizes and errors are kept,
+    // their indices follow the full detail ones in the index buffer and are written while decoding
+    importer.planLevelsOfDetail(g_lodLevelCount);
+    m_meshLods = importer.getLevelsOfDetail();
 
-            if (primitive.indices >= 0)
-            {
-                // This accessor describes how to read the index data (e.g., type, count, etc.)
-                const tinygltf::Accessor& indexAccessor = m_gltfModel->accessors[primitive.indices];
-                // This buffer view describes the layout of the buffer (e.g., byte offset, stride, etc.)
-                const tinygltf::BufferView& indexBufferView = m_gltfModel->bufferViews[indexAccessor.bufferView];
-                // This buffer contains the actual binary data for the indices
-                const tinygltf::Buffer& indexBuffer = m_gltfModel->buffers[indexBufferView.buffer];
-                size_t indexCount = indexAccessor.count;
-                OutputDebugStringA(("Index count: " + std::to_string(indexCount) + "\n").c_str());
-
-                indices.resize(indexCount);
-
-                // Calculate a pointer to the index data 
-                // glTF uses a hierarchical data structure:
-                // Buffer : Contains all binary data
-                // BufferView : Describes a slice of that buffer(like "indices start at byte 1000")
-                // Accessor : Describes how to interpret that view(like "skip 20 more bytes, then read as uint16")
-                // 
-                // Visual example of indexBuffer.data layout:
-                // 
-                // |------------------| <- Start of buffer
-                // |   ...            |
-                // |------------------| <- indexBufferView.byteOffset (Buffer view starts here)
-                // |   ...            |
-                // |------------------| <- indexAccessor.byteOffset (Accessor offset within view)
-                // |   ...            |
-                // |   Index Data     | <- Actual index data starts here
-                // |   ...            |
-                // |------------------| <- End of buffer    
-
-
-                // gltf supports different index types (e.g. unsigned byte, unsigned short, unsigned int). Need to handle them accordingly
-                // we use void* to cast to the correct type based on indexAccessor.componentType
-                const void* indexDataPtr = &indexBuffer.data[
-                    indexBufferView.byteOffset + // How many bytes into the buffer the view starts
-                        indexAccessor.byteOffset // Additional offset within the view to reach index data
-                ];
-
-                if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-                {
-                    const std::uint16_t* indexData = reinterpret_cast<const std::uint16_t*>(indexDataPtr);
-                    for (size_t i = 0; i < indexCount; ++i)
-                    {
-                        indices[i] = indexData[i];
-                    }
-                }
-                else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-                {
-                    const std::uint32_t* indexData = reinterpret_cast<const std::uint32_t*>(indexDataPtr);
-                    for (size_t i = 0; i < indexCount; ++i)
-                    {
-                        indices[i] = static_cast<std::uint16_t>(indexData[i]);
-                    }
-                }
-                else
-                {
-                    throw std::runtime_error("Unsupported index component type in glTF model");
-                }
-            }
-            else
-            {
-                throw std::runtime_error("Mesh primitive does not contain indices");
-            }
-
-            // Append this primitive's vertices and indices to the total vertex/index arrays
-            MeshData meshData = {};
-            meshData.vertexBufferOffset = vertexOffset;
-            meshData.indexBufferOffset = indexOffset;
-            meshData.indexCount = indices.size();
-
-            m_meshes.push_back(meshData);
-            totalVertices.insert(totalVertices.end(), vertices.begin(), vertices.end());
-            totalIndices.insert(totalIndices.end(), indices.begin(), indices.end());
-            vertexOffset += vertexCount;
-            indexOffset += indices.size();
-            primitiveIndex++;
-        }
+    LodSettings lodSettings;
+    lodSettings.fadeSeconds = 0.0f;
+    m_lodSelector.setSettings(lodSettings);
+    m_lodSelector.reserve(static_cast<uint32_t>(layout.primitives.size()));
+    for (size_t i = 0; i < layout.primitives.size(); ++i)
+    {
+        const GltfPrimitiveRange& primitive = layout.primitives[i];
+        const float center[3] = { (primitive.boundsMin[0] + primitive.boundsMax[0]) * 0.5f,
+                                  (primitive.boundsMin[1] + primitive.boundsMax[1]) * 0.5f,
+                                  (primitive.boundsMin[2] + primitive.boundsMax[2]) * 0.5f };
+        const XMVECTOR extents = XMVectorSet((primitive.boundsMax[0] - primitive.boundsMin[0]) * 0.5f,
+            (primitive.boundsMax[1] - primitive.boundsMin[1]) * 0.5f, (primitive.boundsMax[2] - primitive.boundsMin[2]) * 0.5f, 0.0f);
+        m_lodSelector.addInstance(m_lodSelector.addTable(m_meshLods[i].table), center, XMVectorGetX(XMVector3Length(extents)));
     }
 
-    // Step 8: Create MeshGeometry object and upload vertex/index data to GPU
-    const UINT vertexBufferSize = static_cast<UINT>(totalVertices.size() * sizeof(VertexWithTexCoord));
-    const UINT indexBufferSize = static_cast<UINT>(totalIndices.size() * sizeof(std::uint16_t));
-    m_indexCount = totalIndices.size();
+    const UINT vertexBufferSize = static_cast<UINT>(layout.getVertexBufferSize());
+    const UINT indexBufferSize = static_cast<UINT>(layout.getIndexBufferSize());
+    m_indexCount = layout.indexCount + layout.lodIndexCount;
+    OutputDebugStringA(("glTF primitives: " + std::to_string(layout.primitives.size()) +
+        ", vertices: " + std::to_string(layout.vertexCount) + ", indices: " + std::to_string(layout.indexCount) + "\n").c_str());
 
-    // Create default vertex buffer resource
+    // Step 3: Create the default buffers now that the totals are known
     ResourceDesc vertexBufferDesc = {};
     vertexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     vertexBufferDesc.usage = ResourceDesc::Usage::Default;
     vertexBufferDesc.width = vertexBufferSize;
+    vertexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    vertexBufferDesc.debugName = "Vertex buffer";
 
     m_vertexBuffer = m_device->createResource(vertexBufferDesc);
 
-    // Create upload vertex buffer resource
-    ResourceDesc vertexUploadDesc = vertexBufferDesc;
-    vertexUploadDesc.usage = ResourceDesc::Usage::Upload;
-    std::unique_ptr<ResourceDx12> vertexUploadBuffer = m_device->createResource(vertexUploadDesc);
-
-    // Copy vertex data to vertex buffer
-    void* vertexData = nullptr;
-    if (vertexUploadBuffer->map(&vertexData))
-    {
-        memcpy(vertexData, totalVertices.data(), vertexBufferSize);
-        vertexUploadBuffer->unmap();
-    }
-    else
-    {
-        throw std::runtime_error("Failed to map vertex buffer resource.\n");
-    }
-
-    // Create index buffer resource
     ResourceDesc indexBufferDesc = {};
     indexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     indexBufferDesc.usage = ResourceDesc::Usage::Default;
     indexBufferDesc.width = indexBufferSize;
+    indexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    indexBufferDesc.debugName = "Index buffer";
 
     m_indexBuffer = m_device->createResource(indexBufferDesc);
 
-    // Create upload index buffer resource
-    ResourceDesc indexUploadDesc = indexBufferDesc;
-    indexUploadDesc.usage = ResourceDesc::Usage::Upload;
-    std::unique_ptr<ResourceDx12> indexUploadBuffer = m_device->createResource(indexUploadDesc);
-
-    // Copy index data to index buffer
-    void* indexData = nullptr;
-    if (indexUploadBuffer->map(&indexData))
-    {
-        memcpy(indexData, totalIndices.data(), indexBufferSize);
-        indexUploadBuffer->unmap();
-    }
-    else
-    {
-        throw std::runtime_error("Failed to map index buffer resource.\n");
-    }
-
-    // Copy data from upload buffers to default buffers using command list
-    // (since default buffers are not CPU accessible)
-    m_commandList->begin(m_frameContexts[0].commandAllocator.Get());
-    m_commandList->copyResource(m_vertexBuffer.get(), vertexUploadBuffer.get(), totalVertices.data(), vertexBufferSize);
-    m_commandList->copyResource(m_indexBuffer.get(), indexUploadBuffer.get(), totalIndices.data(), indexBufferSize);
-    m_commandList->end();
-    m_device->executeCommandList(m_commandList.get());
-
-    // Wait for GPU to finish copying before we release the upload buffers
-    UINT64 fenceValue = m_device->getNextFenceValue();
-    m_device->signalFence(fenceValue);
-    m_device->waitForFence(fenceValue);
+    // Step 4: Decode straight into mapped staging memory, each pointer is filled before the next batch call
+    static_assert(sizeof(ImportedVertex) == sizeof(VertexWithTexCoord), "Importer vertex layout must match VertexWithTexCoord");
+    importer.decodeVertices(static_cast<ImportedVertex*>(m_uploadBatch->allocateBuffer(m_vertexBuffer.get(), vertexBufferSize)));
+    importer.decodeIndices(static_cast<std::uint16_t*>(m_uploadBatch->allocateBuffer(m_indexBuffer.get(), indexBufferSize)));
 
     // Create vertex buffer view
     m_vertexBufferView = m_vertexBuffer->getResourceView(
@@ -434,20 +332,6 @@ void GltfDemo::CreateGeometry()
     OutputDebugStringA("glTF model loaded successfully!\n");
 }
 
-// 7. Create constant buffers (per-frame upload buffers)
-// Each frame gets its own constant buffers to avoid GPU/CPU synchronization issues.
-// We have two constant buffers: one for per-object data (world matrix) 
-// and one for per-frame data (view/projection matrices, eye position).
-// Layout matches cubeTexturedShader.hlsl's FrameConstants and BasicObjectConstants structs.
-void GltfDemo::CreateConstantBuffers()
-{
-    for (UINT i = 0; i < g_frameCount; i++)
-    {
-        m_frameCBs[i] = std::make_unique<UploadBuffer<FrameConstants>>(m_device.get(), 1, true);
-        m_objectCBs[i] = std::make_unique<UploadBuffer<BasicObjectConstants>>(m_device.get(), 1, true);
-    }
-}
-
 // 8. Create root signature
 // The root signature defines how shader resources are bound to the pipeline.
 // Root parameter  0: inline CBV at b0 for per-object constants (world matrix)  
@@ -535,6 +419,20 @@ void GltfDemo::CreatePipeline()
 
     m_pipeline = m_device->createPipeline(m_pipelineDesc);
     m_pipeline->createPipelineState(m_shader.get(), m_rootSignature.get());
+
+    RecordDrawStateStream();
+}
+
+// The draw state only changes with the pipeline: record it once, every list that draws replays it
+void GltfDemo::RecordDrawStateStream()
+{
+    m_streamTranslator->clear();
+    m_drawStateStream.clear();
+    m_drawStateStream.setDescriptorHeap(m_streamTranslator->addDescriptorHeap(m_textureSrvHeap.get()));
+    m_drawStateStream.setRootSignature(m_streamTranslator->addRootSignature(m_rootSignature.get()));
+    m_drawStateStream.setPipeline(m_streamTranslator->addPipeline(m_pipeline.get()));
+    m_drawStateStream.setVertexBuffer(0, m_streamTranslator->addBufferView(m_vertexBufferView));
+    m_drawStateStream.setIndexBuffer(m_streamTranslator->addBufferView(m_indexBufferView));
 }
 
 // 10. Create texture resources
@@ -543,9 +441,6 @@ void GltfDemo::CreatePipeline()
 // and records the necessary copy commands to upload the texture data to the GPU.
 void GltfDemo::CreateTexture()
 {   
-    // Reset the command list to record texture upload commands
-    m_commandList->begin(m_frameContexts[0].commandAllocator.Get());
-
     for (const tinygltf::Texture& texture : m_gltfModel->textures)
     {
         if (texture.source < 0 || texture.source >= m_gltfModel->images.size())
@@ -578,47 +473,21 @@ void GltfDemo::CreateTexture()
                 throw std::runtime_error("Failed to load texture " + std::string(imageUri.begin(), imageUri.end()));
             }
 
-        // Query the texture resource to calculate how many bytes the staging buffer needs
-        const UINT64 textureBufferSize = GetRequiredIntermediateSize(
-            textureResource.Get(), 0, 1);
-
-        // Create texture buffer resource
-        ResourceDesc textureUploadDesc = {};
-        textureUploadDesc.type = ResourceDesc::ResourceType::Buffer;
-        textureUploadDesc.usage = ResourceDesc::Usage::Upload;
-        textureUploadDesc.width = textureBufferSize;
-        
-        std::unique_ptr<ResourceDx12> textureUploadBuffer = m_device->createResource(textureUploadDesc);
-        auto textureResourceBuffer = std::make_unique<ResourceDx12>(m_device.get(), textureResource);
-
-        m_commandList->copyTextureResource(
-            textureResourceBuffer.get(), textureUploadBuffer.get(), &subresource);
-        // Wrap the native D3D12 resource in our ResourceDx12 class
-        TextureData textureData = { 
-            std::make_unique<ResourceDx12>(m_device.get(), textureResource), 
-            std::move(textureUploadBuffer) };
+        // Wrap the native D3D12 resource in our ResourceDx12 class and stage its pixels in the upload batch
+        TextureData textureData = { std::make_unique<ResourceDx12>(m_device.get(), textureResource) };
+        textureData.m_textureDefaultBuffer->trackMemory(MemoryCategory::Texture, image.uri.c_str());
+        m_uploadBatch->addTexture(textureData.m_textureDefaultBuffer.get(), &subresource, 0, 1);
 
         m_textures.push_back(std::move(textureData));
 
         DescriptorHandle srvHandle = {};
-        m_textureSrvHeap->AllocateHeap(&srvHandle);
+        m_stagingSrvHeap->AllocateHeap(&srvHandle);
         m_textureSrvs.push_back(m_textures.back().m_textureDefaultBuffer->getResourceView(ResourceBindFlags::ShaderResource, srvHandle));
     }
-
-    // Close and execute the command list to perform the texture upload
-    m_commandList->end();
-    m_device->executeCommandList(m_commandList.get());
-
-    // Wait for the GPU to finish uploading the texture before proceeding
-    UINT64 fenceValue = m_device->getNextFenceValue();
-    m_device->signalFence(fenceValue);
-    m_device->waitForFence(fenceValue);
 }
 
 void GltfDemo::CreateDummyTexture()
 {
-    m_commandList->begin(m_frameContexts[0].commandAllocator.Get());
-
     static const uint32_t whitePixel = 0xFFFFFFFF;
     D3D12_SUBRESOURCE_DATA subresource = {};
     subresource.pData = &whitePixel;
@@ -632,80 +501,120 @@ void GltfDemo::CreateDummyTexture()
     textureDesc.mipLevels = 1;
     textureDesc.format = ResourceFormat::R8G8B8A8_UNORM;
     textureDesc.bindFlags = ResourceBindFlags::ShaderResource;
+    textureDesc.memoryCategory = MemoryCategory::Texture;
+    textureDesc.debugName = "White texture";
 
+    // Keep the owning wrapper alive: the texture is placed in a shared heap and its region is released with it
     auto whiteTextureResource = m_device->createResource(textureDesc);
-    ComPtr<ID3D12Resource> nativeResource = whiteTextureResource->getNativeResource();
-
-    const UINT64 textureBufferSize = GetRequiredIntermediateSize(nativeResource.Get(), 0, 1);
-
-    ResourceDesc textureUploadDesc = {};
-    textureUploadDesc.type = ResourceDesc::ResourceType::Buffer;
-    textureUploadDesc.usage = ResourceDesc::Usage::Upload;
-    textureUploadDesc.width = textureBufferSize;
 
-    std::unique_ptr<ResourceDx12> textureUploadBuffer = m_device->createResource(textureUploadDesc);
-    auto textureResourceBuffer = std::make_unique<ResourceDx12>(m_device.get(), nativeResource);
+    m_uploadBatch->addTexture(whiteTextureResource.get(), &subresource, 0, 1);
 
-    m_commandList->copyTextureResource(textureResourceBuffer.get(), textureUploadBuffer.get(), &subresource);
-
-    m_whiteTexture = {
-        std::make_unique<ResourceDx12>(m_device.get(), nativeResource),
-        std::move(textureUploadBuffer) };
+    m_whiteTexture = { std::move(whiteTextureResource) };
 
     DescriptorHandle srvHandle = {};
-    m_textureSrvHeap->AllocateHeap(&srvHandle);
+    m_stagingSrvHeap->AllocateHeap(&srvHandle);
     m_whiteTextureSrv = m_whiteTexture.m_textureDefaultBuffer->getResourceView(ResourceBindFlags::ShaderResource, srvHandle);
-
-    m_commandList->end();
-    m_device->executeCommandList(m_commandList.get());
-
-    UINT64 fenceValue = m_device->getNextFenceValue();
-    m_device->signalFence(fenceValue);
-    m_device->waitForFence(fenceValue);
 }
 
-void GltfDemo::UpdateConstantBuffers()
+// Runs on the simulation thread: only simulation state and the snapshot may be touched here
+void GltfDemo::Simulate(GltfFrameSnapshot& snapshot, double deltaSeconds)
 {
-    // Rotate the cube slowly around Y axis
-    m_rotationAngle += 0.01f;
+    // Rotate the model slowly around Y axis
+    m_rotationAngle += static_cast<float>(0.6 * deltaSeconds);
 
     // Object constant (b0) - World matrix
     XMMATRIX worldMatrix = XMMatrixRotationY(m_rotationAngle);
+    XMStoreFloat4x4(&snapshot.objectConstants.World, XMMatrixTranspose(worldMatrix));
 
-    // Object: world matrix with rotation
-    BasicObjectConstants objConstants = {};
-    XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(worldMatrix));
-
-    // Frame constant (b1) - ViewProj matrix + eye position
+    // Camera
     XMVECTOR eyePos = XMVectorSet(0.0f, 0.7f, -2.0f, 1.0f);
     XMVECTOR lookAt = XMVectorSet(0.0f, 0.7f, 0.0f, 1.0f);
     XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-    XMMATRIX view = XMMatrixLookAtLH(eyePos, lookAt, up);
+    XMStoreFloat4x4(&snapshot.view, XMMatrixLookAtLH(eyePos, lookAt, up));
+    XMStoreFloat3(&snapshot.eyePosition, eyePos);
+
+    // Cull in object space: every draw shares the world matrix, so the planes of world * viewProj test the
+    // static bounds directly. Serial, jobs can only be created from the render thread.
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, m_cullAspectRatio.load(), 0.1f, 100.0f);
+    XMFLOAT4X4 worldViewProj;
+    XMStoreFloat4x4(&worldViewProj, worldMatrix * XMLoadFloat4x4(&snapshot.view) * proj);
+    const Frustum frustum = extractFrustum(&worldViewProj._11);
+
+    // Resizing within the capacity reserved up front does not allocate
+    snapshot.visibleDraws.resize(m_cullingBounds.getPaddedCount());
+    const uint32_t visibleCount = m_frustumCuller.cull(frustum, m_cullingBounds, snapshot.visibleDraws.data());
+    snapshot.visibleDraws.resize(visibleCount);
+
+    // Levels of detail in object space as well, with the eye brought into it. The few primitives select serially.
+    XMFLOAT3 objectEye;
+    XMStoreFloat3(&objectEye, XMVector3TransformCoord(eyePos, XMMatrixInverse(nullptr, worldMatrix)));
+    XMFLOAT4X4 projection;
+    XMStoreFloat4x4(&projection, proj);
+    m_lodSelector.select(makeLodView(&objectEye.x, &projection._11, m_viewportHeight.load()), static_cast<float>(deltaSeconds));
+    const uint8_t* levels = m_lodSelector.getLevels();
+    snapshot.visibleDrawLevels.resize(visibleCount);
+    for (uint32_t i = 0; i < visibleCount; ++i)
+    {
+        snapshot.visibleDrawLevels[i] = levels[snapshot.visibleDraws[i]];
+    }
+}
 
+void GltfDemo::UpdateConstantBuffers(const GltfFrameSnapshot& snapshot)
+{
+    // Frame constant (b1) - ViewProj matrix + eye position.
+    // The projection follows the swap chain size, which belongs to the render thread.
     float aspectRatio = static_cast<float>(WINDOW_WIDTH) / static_cast<float>(WINDOW_HEIGHT);
     XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, aspectRatio, 0.1f, 100.0f);
-    XMMATRIX viewProj = view * proj;
+    XMMATRIX viewProj = XMLoadFloat4x4(&snapshot.view) * proj;
 
-    // Frame: identity viewproj (renders in NDC space directly)
     FrameConstants frameConstants = {};
     XMStoreFloat4x4(&frameConstants.ViewProj, XMMatrixTranspose(viewProj));
+    frameConstants.EyePosW = snapshot.eyePosition;
 
-    // Copy data to the current back buffer's constant buffers
-    UINT backBufferIndex = m_swapChain->getCurrentBackBufferIndex();
-    m_objectCBs[backBufferIndex]->CopyData(0, objConstants);
-    m_frameCBs[backBufferIndex]->CopyData(0, frameConstants);
+    // Copy data to this frame's slices of the upload ring. They are recycled once the frame fence completes.
+    m_objectCBAddress = m_commandList->allocConstants(snapshot.objectConstants).gpuAddress;
+    m_frameCBAddress = m_commandList->allocConstants(frameConstants).gpuAddress;
 }
 
 void GltfDemo::Render()
 {
-    // Get the current back buffer index from the swap chain
-    UINT backBufferIndex = m_swapChain->getCurrentBackBufferIndex();
-    // Wait for GPU to finish with the resources from the previous frame
-    FrameContext& currentFrameContext = m_frameContexts[backBufferIndex];
-    m_device->waitForFence(currentFrameContext.fenceValue);
+    // Changing the frames in flight drains the GPU once, every slot starts out free
+    const uint32_t framesInFlight = static_cast<uint32_t>(m_imguiLoader.framesInFlight);
+    if (framesInFlight != m_frameScheduler.getFramesInFlight())
+    {
+        m_device->waitForFence(m_frameScheduler.getLastFenceValue());
+        m_frameScheduler.setFramesInFlight(framesInFlight, m_device->getCompletedFenceValue());
+    }
+
+    // Wait only if the GPU still uses this frame slot, i.e. the CPU is framesInFlight frames ahead
+    const uint64_t slotFenceValue = m_frameScheduler.beginFrame(m_device->getCompletedFenceValue());
+    if (slotFenceValue != 0)
+    {
+        m_device->waitForFence(slotFenceValue);
+    }
+    FrameContext& currentFrameContext = m_frameContexts.get(m_frameScheduler);
+
+    // Switching between threaded and inline simulation starts or joins a thread, keep it out of the steady state
+    if (m_imguiLoader.simulationThread && !m_framePipeline->isThreaded())
+    {
+        m_framePipeline->start();
+    }
+    else if (!m_imguiLoader.simulationThread && m_framePipeline->isThreaded())
+    {
+        m_framePipeline->stop();
+    }
+
+    // Everything below is steady-state work: count the heap allocations it makes and give it this frame's arena.
+    // Counted process wide, recording runs on job system workers and the simulation thread should not allocate either
+    HeapAllocationScope heapAllocationScope(HeapAllocationSource::Process);
+    m_frameArenas.beginFrame(m_frameScheduler.getCurrentSlot());
+    FrameArenaResource& frameMemory = m_frameArenas.getResource();
+
+    // Take the simulation's latest snapshot, the next one is simulated while this frame records
+    const GltfFrameSnapshot& snapshot = m_framePipeline->acquire();
 
     // Update constant buffers with current frame's data
-    UpdateConstantBuffers();
+    UpdateConstantBuffers(snapshot);
 
     // Start ImGui frame
     m_imguiLoader.NewFrame();
@@ -723,77 +632,211 @@ void GltfDemo::Render()
     const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
     RenderPassDesc renderPassDesc = RenderPassDesc::buildAsSingleRenderTarget(
         currentRtView,
-        currentBackBuffer->getNativeResource(),
+        currentBackBuffer,
         m_depthStencilView,
         WINDOW_WIDTH, WINDOW_HEIGHT,
         clearColor);
     renderPassDesc.debugName = "Textured Box Render Pass";
 
-    // Test command list recording
-    m_commandList->begin(currentFrameContext.commandAllocator.Get());
-    m_commandList->beginRenderPass(renderPassDesc);
-
+    // Build this frame's texture tables in the descriptor ring with a single CopyDescriptors call.
+    // Done up front on this thread: the ring is not thread safe and every recording thread reads the tables.
+    // The per-draw lists live in the frame arena, they are dropped wholesale when this frame slot comes around again
+    const uint32_t drawCount = static_cast<uint32_t>(snapshot.visibleDraws.size());
+    const bool useLod = m_imguiLoader.levelOfDetail;
+    // Consecutive draws sampling the same texture share one table, so the command list can skip rebinding it
+    std::pmr::vector<D3D12_CPU_DESCRIPTOR_HANDLE> tableSrvHandles(&frameMemory);
+    std::pmr::vector<uint32_t> drawTableIndices(&frameMemory);
+    tableSrvHandles.reserve(drawCount);
+    drawTableIndices.reserve(drawCount);
+    for (uint32_t drawIndex : snapshot.visibleDraws)
     {
-        // Set descriptor heaps (for the texture shader resource descriptor heaps)
-        m_commandList->setDescriptorHeaps(m_textureSrvHeap.get(), 1);
+        const int textureIndex = m_meshes[drawIndex].textureIndex;
+        const bool hasTexture = textureIndex >= 0 && textureIndex < static_cast<int>(m_textureSrvs.size());
+        const D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = m_imguiLoader.wireframe || !hasTexture
+            ? m_whiteTextureSrv.cpuHandle
+            : m_textureSrvs[textureIndex].cpuHandle;
+        if (tableSrvHandles.empty() || tableSrvHandles.back().ptr != srvHandle.ptr)
+        {
+            tableSrvHandles.push_back(srvHandle);
+        }
+        drawTableIndices.push_back(static_cast<uint32_t>(tableSrvHandles.size()) - 1);
+    }
+    const uint32_t tableCount = static_cast<uint32_t>(tableSrvHandles.size());
+    std::pmr::vector<UINT> tableSizes(tableCount, 1, &frameMemory);
+    std::pmr::vector<DescriptorHandle> tables(tableCount, &frameMemory);
+    m_descriptorRing->copyTables(tableSrvHandles.data(), tableSizes.data(), tableCount, tables.data());
 
-        // Bind root signature and pipeline state
-        m_commandList->setGraphicsRootSignature(m_rootSignature.get());
-        m_commandList->setPipeline(m_pipeline.get());
+    // Command lists start without state, so every list that draws binds the whole pipeline first
+    auto bindDrawState = [&](CommandList* commandList)
+    {
+        // Descriptor heap, root signature, pipeline state and geometry come from the stream recorded at startup
+        m_streamTranslator->replay(m_drawStateStream, commandList);
 
         // Bind constant buffers to root parameters (descriptor tables or root descriptors 
         // depending on how we set up the root signature)
-        m_commandList->setConstantBufferView(
-            0,
-            m_objectCBs[backBufferIndex]->getResource()->GetGPUVirtualAddress());
-        m_commandList->setConstantBufferView(
-            1,
-            m_frameCBs[backBufferIndex]->getResource()->GetGPUVirtualAddress());
-
-        // Bind geometry
-        m_commandList->setVertexBuffer(0, m_vertexBufferView);
-        m_commandList->setIndexBuffer(m_indexBufferView);
-
-        // TODO: Match each primitive to its corresponding texture/material for multiple meshes
-        for (size_t i = 0; i < m_textureSrvs.size(); i++)
+        commandList->setConstantBufferView(0, m_objectCBAddress);
+        commandList->setConstantBufferView(1, m_frameCBAddress);
+    };
+
+    auto recordDraws = [&](CommandList* commandList, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
         {
-            if (m_imguiLoader.wireframe)
-            {
-                m_commandList->setGraphicsRootDescriptorTable(2, m_whiteTextureSrv.gpuHandle);
-            }
-            else
+            const MeshData& mesh = m_meshes[snapshot.visibleDraws[i]];
+            const GltfPrimitiveLods& lods = m_meshLods[snapshot.visibleDraws[i]];
+            const uint32_t level = useLod ? snapshot.visibleDrawLevels[i] : 0;
+            if (lods.indexCount[level] == 0)
             {
-                m_commandList->setGraphicsRootDescriptorTable(2, m_textureSrvs[i].gpuHandle);
+                continue;
             }
-            m_commandList->drawIndexedInstanced(m_meshes[i].indexCount, 1, m_meshes[i].indexBufferOffset, m_meshes[i].vertexBufferOffset, 0);
+            commandList->setGraphicsRootDescriptorTable(2, tables[drawTableIndices[i]].gpuHandle);
+            commandList->drawIndexedInstanced(lods.indexCount[level], 1, lods.indexOffset[level], mesh.vertexBufferOffset, 0);
         }
+    };
 
-        m_imguiLoader.Render(m_commandList.get());
+    // The first frame also makes the direct queue wait for the initial uploads
+    m_device->waitForUpload(m_uploadToken);
 
+    // Balance the draw ranges by index count, one range per thread
+    std::array<RecordRange, g_maxRecordThreads> drawRanges;
+    uint32_t rangeCount = 0;
+    if (m_imguiLoader.parallelRecording)
+    {
+        std::pmr::vector<uint32_t> drawCosts(drawCount, &frameMemory);
+        for (uint32_t i = 0; i < drawCount; i++)
+        {
+            drawCosts[i] = m_meshLods[snapshot.visibleDraws[i]].indexCount[useLod ? snapshot.visibleDrawLevels[i] : 0];
+        }
+        rangeCount = partitionRecording(drawCosts.data(), drawCount,
+            std::min(m_jobSystem->getThreadCount(), g_maxRecordThreads), g_minDrawsPerList, drawRanges.data());
     }
 
-    m_commandList->endRenderPass();
+    // The scene pass opens the render pass and draws, in parallel it records on list 0 and one list per draw range
+    // and leaves the graph on the list after them
+    auto scenePass = [&](RenderGraphPassContext& context)
+    {
+        CommandList* openList = context.commandList;
+        openList->beginRenderPass(renderPassDesc);
+        if (!m_imguiLoader.parallelRecording)
+        {
+            bindDrawState(openList);
+            recordDraws(openList, 0, drawCount);
+            openList->suspendRenderPass();
+            return;
+        }
+        openList->suspendRenderPass();
+
+        // One job per range, this thread records its share while it waits
+        m_jobSystem->parallelFor(rangeCount, 1, [&](uint32_t firstRange, uint32_t lastRange)
+        {
+            for (uint32_t rangeIndex = firstRange; rangeIndex < lastRange; rangeIndex++)
+            {
+                CommandList* commandList = m_parallelLists->getCommandList(rangeIndex + 1);
+                commandList->resumeRenderPass(renderPassDesc);
+                bindDrawState(commandList);
+                recordDraws(commandList, drawRanges[rangeIndex].begin, drawRanges[rangeIndex].end);
+                commandList->suspendRenderPass();
+                commandList->end();
+            }
+        });
+
+        context.commandList = m_parallelLists->getCommandList(rangeCount + 1);
+    };
+
+    auto imguiPass = [&](RenderGraphPassContext& context)
+    {
+        CommandList* closeList = context.commandList;
+        closeList->resumeRenderPass(renderPassDesc);
+        closeList->setDescriptorHeaps(m_textureSrvHeap.get(), 1);
+        m_imguiLoader.Render(closeList);
+        closeList->endRenderPass();
+    };
+
+    // Describe the frame: the graph orders the passes and records the back buffer transitions in front of them
+    m_renderGraph->clear();
+    const uint32_t backBuffer = m_renderGraph->importResource("Back buffer", currentBackBuffer,
+        ResourceState::Present, ResourceState::Present);
+    const uint32_t depthBuffer = m_renderGraph->importResource("Depth", m_depthBuffer.get(),
+        ResourceState::DepthWrite, ResourceState::DepthWrite);
+
+    const uint32_t scene = m_renderGraph->addPass("Scene", scenePass);
+    m_renderGraph->write(scene, backBuffer, ResourceState::RenderTarget);
+    m_renderGraph->write(scene, depthBuffer, ResourceState::DepthWrite);
 
-    m_commandList->end();
+    // ImGui draws what the graph cannot see, keep it even if nothing reads its output
+    const uint32_t ui = m_renderGraph->addPass("ImGui", imguiPass, RenderGraphPassFlags::NeverCull);
+    m_renderGraph->write(ui, backBuffer, ResourceState::RenderTarget);
+    m_renderGraph->compile();
+
+    RenderGraphPassContext passContext = {};
+    if (m_imguiLoader.parallelRecording)
+    {
+        // List 0 opens the pass, one list per draw range follows and the last one draws ImGui and closes the pass
+        m_parallelLists->begin(rangeCount + 2);
+        passContext.commandList = m_parallelLists->getCommandList(0);
+        m_renderGraph->execute(passContext);
+
+        // Every list goes to the queue in order with a single ExecuteCommandLists
+        m_parallelLists->execute();
+    }
+    else
+    {
+        m_commandList->begin(currentFrameContext.commandAllocator.Get());
+        passContext.commandList = m_commandList.get();
+        m_renderGraph->execute(passContext);
+        m_commandList->end();
+
+        m_device->executeCommandList(m_commandList.get());
+    }
 
-    // Execute command list
-    m_device->executeCommandList(m_commandList.get());
     // Present the frame
     m_swapChain->present(true);
 
     // Signal and increment the fence value for the current frame
     currentFrameContext.fenceValue = m_device->getNextFenceValue();
     m_device->signalFence(currentFrameContext.fenceValue);
+    m_frameScheduler.endFrame(currentFrameContext.fenceValue);
+    m_descriptorRing->finishFrame(currentFrameContext.fenceValue);
+    // Allocators recorded this frame become reusable once the GPU passes the same fence
+    m_parallelLists->finishFrame(currentFrameContext.fenceValue);
+
+    const ParallelCommandListsStats recordStats = m_parallelLists->getStats();
+    m_imguiLoader.recordListCount = m_imguiLoader.parallelRecording ? recordStats.listCount : 1;
+    m_imguiLoader.recordAllocatorCount = recordStats.allocatorCount;
+    m_imguiLoader.visibleDrawCount = static_cast<uint32_t>(snapshot.visibleDraws.size());
+    m_imguiLoader.totalDrawCount = m_cullingBounds.getCount();
+    std::fill(std::begin(m_imguiLoader.lodDrawCounts), std::end(m_imguiLoader.lodDrawCounts), 0u);
+    for (uint8_t level : snapshot.visibleDrawLevels)
+    {
+        m_imguiLoader.lodDrawCounts[useLod ? level : 0]++;
+    }
+    // The list counters only grow, the frame's share is the difference to the last frame
+    CommandStateCacheStats stateCacheTotals = recordStats.stateCacheStats;
+    stateCacheTotals.issuedCount += m_commandList->getStateCacheStats().issuedCount;
+    stateCacheTotals.elidedCount += m_commandList->getStateCacheStats().elidedCount;
+    m_imguiLoader.stateCallsIssued = stateCacheTotals.issuedCount - m_stateCacheTotals.issuedCount;
+    m_imguiLoader.stateCallsElided = stateCacheTotals.elidedCount - m_stateCacheTotals.elidedCount;
+    m_stateCacheTotals = stateCacheTotals;
+    const FramePipelineStats pipelineStats = m_framePipeline->getStats();
+    m_imguiLoader.simulateMs = pipelineStats.simulateMs;
+    m_imguiLoader.snapshotLatencyMs = pipelineStats.latencyMs;
+    m_imguiLoader.frameHeapAllocations = heapAllocationScope.getAllocationCount();
+    m_imguiLoader.frameArenaBytes = m_frameArenas.getUsedSize();
+    m_imguiLoader.frameWaitCount = m_frameScheduler.getStats().waitCount;
+    m_imguiLoader.frameCount = m_frameScheduler.getStats().frameCount;
 }
 
 void GltfDemo::Shutdown()
 {
-    // Ensure GPU is finished with all resources before shutting down
-    for (UINT i = 0; i < g_frameCount; i++)
+    // Stop the simulation before anything it reads goes away
+    if (m_framePipeline)
     {
-        m_device->waitForFence(m_frameContexts[i].fenceValue);
+        m_framePipeline->stop();
     }
 
+    // Ensure GPU is finished with all resources before shutting down
+    m_device->waitForFence(m_frameScheduler.getLastFenceValue());
+
     // Shutdown ImGui
     m_imguiLoader.Shutdown();
 
@@ -805,11 +848,8 @@ void GltfDemo::Resize(unsigned int width, unsigned int height)
 {
     if (m_device->getNativeDevice() != nullptr)
     {
-        // Wait for GPU to finish with resources before resizing
-        for (UINT i = 0; i < g_frameCount; i++)
-        {
-            m_device->waitForFence(m_frameContexts[i].fenceValue);
-        }
+        // ResizeBuffers requires every back buffer to be idle, so this is the one place a full wait remains
+        m_device->waitForFence(m_frameScheduler.getLastFenceValue());
 
         // TODO: Move this to a separate method since we will need to call it from other places (e.g., when changing display modes)
         UINT newWidth = width;
@@ -818,6 +858,8 @@ void GltfDemo::Resize(unsigned int width, unsigned int height)
         // Update global window size variables (used for viewport/scissor rect setup in command list recording, etc.)
         WINDOW_WIDTH = newWidth;
         WINDOW_HEIGHT = newHeight;
+        m_cullAspectRatio = static_cast<float>(newWidth) / static_cast<float>(newHeight);
+        m_viewportHeight = static_cast<float>(newHeight);
 
         m_swapChain->resize(newWidth, newHeight);
 
@@ -828,6 +870,8 @@ void GltfDemo::Resize(unsigned int width, unsigned int height)
         depthDesc.height = newHeight;
         depthDesc.format = ResourceFormat::D24_UNORM_S8_UINT;
         depthDesc.bindFlags = ResourceBindFlags::DepthStencil;
+        depthDesc.memoryCategory = MemoryCategory::DepthStencil;
+        depthDesc.debugName = "Depth buffer";
 
         m_depthBuffer = m_device->createResource(depthDesc);
 
@@ -847,14 +891,12 @@ void GltfDemo::ProcessInput()
     {
         m_pipelineDesc.rasterizerFillMode = newFillMode;
 
-        // Wait for ALL frames to finish before destroying the old PSO
-        for (UINT i = 0; i < g_frameCount; i++)
-        {
-            m_device->waitForFence(m_frameContexts[i].fenceValue);
-        }
+        // Frames in flight may still reference the old PSO, let the device destroy it once they retire
+        m_device->retire(std::move(m_pipeline));
 
         // Recreate pipeline with new rasterizer state
         m_pipeline = m_device->createPipeline(m_pipelineDesc);
         m_pipeline->createPipelineState(m_shader.get(), m_rootSignature.get());
+        RecordDrawStateStream();
     }
 }
@@ -0,0 +1,252 @@
+#include "GltfGeometryImporter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace raphael
+{
+    GltfGeometryImporter::GltfGeometryImporter(const tinygltf::Model& model)
+        : m_model(model)
+    {
+        // First pass: only accessor counts are read, no vertex or index data is touched
+        for (const tinygltf::Mesh& mesh : m_model.meshes)
+        {
+            for (const tinygltf::Primitive& primitive : mesh.primitives)
+            {
+                if (primitive.indices < 0)
+                {
+                    throw std::runtime_error("Mesh primitive does not contain indices");
+                }
+
+                PrimitiveSource source = {};
+                source.position = &getAccessor(primitive, "POSITION");
+                source.normal = &getAccessor(primitive, "NORMAL");
+                source.texCoord = &getAccessor(primitive, "TEXCOORD_0");
+                source.indices = &m_model.accessors[primitive.indices];
+
+                if (source.normal->count < source.position->count || source.texCoord->count < source.position->count)
+                {
+                    throw std::runtime_error("Mesh primitive attributes have mismatched counts");
+                }
+
+                GltfPrimitiveRange range = {};
+                range.vertexOffset = m_layout.vertexCount;
+                range.indexOffset = m_layout.indexCount;
+                range.vertexCount = static_cast<uint32_t>(source.position->count);
+                range.indexCount = static_cast<uint32_t>(source.indices->count);
+                range.materialIndex = primitive.material;
+                if (source.position->minValues.size() < 3 || source.position->maxValues.size() < 3)
+                {
+                    throw std::runtime_error("Mesh primitive POSITION accessor has no bounds");
+                }
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    range.boundsMin[axis] = static_cast<float>(source.position->minValues[axis]);
+                    range.boundsMax[axis] = static_cast<float>(source.position->maxValues[axis]);
+                }
+
+                m_layout.vertexCount += range.vertexCount;
+                m_layout.indexCount += range.indexCount;
+                m_maxPrimitiveIndexCount = std::max(m_maxPrimitiveIndexCount, range.indexCount);
+                m_layout.primitives.push_back(range);
+                m_sources.push_back(source);
+            }
+        }
+    }
+
+    const tinygltf::Accessor& GltfGeometryImporter::getAccessor(const tinygltf::Primitive& primitive, const char* attribute) const
+    {
+        auto attributeIt = primitive.attributes.find(attribute);
+        if (attributeIt == primitive.attributes.end())
+        {
+            throw std::runtime_error(std::string("Mesh primitive does not contain ") + attribute + " attribute");
+        }
+        return m_model.accessors[attributeIt->second];
+    }
+
+    const uint8_t* GltfGeometryImporter::getAccessorData(const tinygltf::Accessor& accessor, size_t* outStride) const
+    {
+        // Buffer : Contains all binary data
+        // BufferView : Describes a slice of that buffer (like "indices start at byte 1000")
+        // Accessor : Describes how to interpret that view (like "skip 20 more bytes, then read as uint16")
+        const tinygltf::BufferView& bufferView = m_model.bufferViews[accessor.bufferView];
+        const tinygltf::Buffer& buffer = m_model.buffers[bufferView.buffer];
+
+        // Interleaved views carry a byte stride, tightly packed ones report the element size
+        const int stride = accessor.ByteStride(bufferView);
+        if (stride <= 0)
+        {
+            throw std::runtime_error("Invalid glTF accessor stride");
+        }
+        *outStride = static_cast<size_t>(stride);
+
+        return buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
+    }
+
+    void GltfGeometryImporter::decodeVertices(ImportedVertex* destination) const
+    {
+        for (size_t p = 0; p < m_sources.size(); ++p)
+        {
+            const PrimitiveSource& source = m_sources[p];
+            size_t positionStride = 0;
+            size_t normalStride = 0;
+            size_t texCoordStride = 0;
+            const uint8_t* positionData = getAccessorData(*source.position, &positionStride);
+            const uint8_t* normalData = getAccessorData(*source.normal, &normalStride);
+            const uint8_t* texCoordData = getAccessorData(*source.texCoord, &texCoordStride);
+
+            ImportedVertex* vertices = destination + m_layout.primitives[p].vertexOffset;
+            const uint32_t vertexCount = m_layout.primitives[p].vertexCount;
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                // Build the vertex locally and store it whole, the destination may be write-combined memory
+                ImportedVertex vertex;
+                memcpy(vertex.position, positionData + positionStride * i, sizeof(vertex.position));
+                memcpy(vertex.normal, normalData + normalStride * i, sizeof(vertex.normal));
+                memcpy(vertex.texCoord, texCoordData + texCoordStride * i, sizeof(vertex.texCoord));
+                vertices[i] = vertex;
+            }
+        }
+    }
+
+    template<typename Index>
+    void GltfGeometryImporter::decodePrimitiveIndices(size_t primitiveIndex, Index* destination) const
+    {
+        const tinygltf::Accessor& accessor = *m_sources[primitiveIndex].indices;
+        size_t stride = 0;
+        const uint8_t* indexData = getAccessorData(accessor, &stride);
+        const uint32_t indexCount = m_layout.primitives[primitiveIndex].indexCount;
+
+        // gltf supports different index types (unsigned byte, unsigned short, unsigned int)
+        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT && sizeof(Index) == sizeof(uint16_t) && stride == sizeof(uint16_t))
+        {
+            memcpy(destination, indexData, indexCount * sizeof(Index));
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+        {
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                destination[i] = *reinterpret_cast<const uint16_t*>(indexData + stride * i);
+            }
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
+        {
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                destination[i] = static_cast<Index>(*reinterpret_cast<const uint32_t*>(indexData + stride * i));
+            }
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+        {
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                destination[i] = indexData[stride * i];
+            }
+        }
+        else
+        {
+            throw std::runtime_error("Unsupported index component type in glTF model");
+        }
+    }
+
+    float GltfGeometryImporter::clusterLevel(size_t primitiveIndex, uint32_t level, const uint32_t* primitiveIndices,
+        std::vector<uint32_t>& outIndices) const
+    {
+        const GltfPrimitiveRange& primitive = m_layout.primitives[primitiveIndex];
+        const tinygltf::Accessor& positions = *m_sources[primitiveIndex].position;
+        if (positions.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || positions.type != TINYGLTF_TYPE_VEC3)
+        {
+            throw std::runtime_error("Mesh primitive POSITION accessor is not float3");
+        }
+        size_t positionStride = 0;
+        const uint8_t* positionData = getAccessorData(positions, &positionStride);
+
+        const float dx = primitive.boundsMax[0] - primitive.boundsMin[0];
+        const float dy = primitive.boundsMax[1] - primitive.boundsMin[1];
+        const float dz = primitive.boundsMax[2] - primitive.boundsMin[2];
+        const float radius = std::max(0.5f * std::sqrt(dx * dx + dy * dy + dz * dz), 1e-6f);
+        const float cellSize = radius * static_cast<float>(1u << level) / 64.0f;
+
+        // The source buffer's floats are read in place, nothing of the vertex stream is copied
+        return simplifyByClustering(reinterpret_cast<const float*>(positionData), static_cast<uint32_t>(positionStride),
+            primitive.vertexCount, primitiveIndices, primitive.indexCount, cellSize, outIndices);
+    }
+
+    void GltfGeometryImporter::planLevelsOfDetail(uint32_t levelCount)
+    {
+        if (levelCount == 0 || levelCount > MaxLodLevels)
+        {
+            throw std::runtime_error("LOD level count out of range");
+        }
+
+        // Scratch sized for the largest primitive, reused by every primitive and level
+        std::vector<uint32_t> primitiveIndices(m_maxPrimitiveIndexCount);
+        std::vector<uint32_t> lodIndices;
+        lodIndices.reserve(m_maxPrimitiveIndexCount);
+
+        m_lods.assign(m_layout.primitives.size(), {});
+        m_layout.lodIndexCount = 0;
+        for (size_t p = 0; p < m_layout.primitives.size(); ++p)
+        {
+            const GltfPrimitiveRange& primitive = m_layout.primitives[p];
+            GltfPrimitiveLods& lods = m_lods[p];
+            lods.table.levelCount = levelCount;
+            lods.indexOffset[0] = primitive.indexOffset;
+            lods.indexCount[0] = primitive.indexCount;
+
+            if (levelCount > 1)
+            {
+                decodePrimitiveIndices(p, primitiveIndices.data());
+            }
+            for (uint32_t level = 1; level < levelCount; ++level)
+            {
+                const float error = clusterLevel(p, level, primitiveIndices.data(), lodIndices);
+                lods.table.geometricError[level] = std::max(error, lods.table.geometricError[level - 1]);
+                lods.indexOffset[level] = m_layout.indexCount + m_layout.lodIndexCount;
+                lods.indexCount[level] = static_cast<uint32_t>(lodIndices.size());
+                m_layout.lodIndexCount += lods.indexCount[level];
+            }
+        }
+    }
+
+    void GltfGeometryImporter::decodeIndices(uint16_t* destination) const
+    {
+        for (size_t p = 0; p < m_sources.size(); ++p)
+        {
+            decodePrimitiveIndices(p, destination + m_layout.primitives[p].indexOffset);
+        }
+
+        if (m_lods.empty())
+        {
+            return;
+        }
+
+        // Clustering is deterministic, so running it again reproduces the planned ranges without keeping them around
+        std::vector<uint32_t> primitiveIndices(m_maxPrimitiveIndexCount);
+        std::vector<uint32_t> lodIndices;
+        lodIndices.reserve(m_maxPrimitiveIndexCount);
+        for (size_t p = 0; p < m_sources.size(); ++p)
+        {
+            const GltfPrimitiveLods& lods = m_lods[p];
+            if (lods.table.levelCount > 1)
+            {
+                decodePrimitiveIndices(p, primitiveIndices.data());
+            }
+            for (uint32_t level = 1; level < lods.table.levelCount; ++level)
+            {
+                clusterLevel(p, level, primitiveIndices.data(), lodIndices);
+                if (lodIndices.size() != lods.indexCount[level])
+                {
+                    throw std::runtime_error("glTF level of detail does not match its planned size");
+                }
+
+                uint16_t* indices = destination + lods.indexOffset[level];
+                for (size_t i = 0; i < lodIndices.size(); ++i)
+                {
+                    indices[i] = static_cast<uint16_t>(lodIndices[i]);
+                }
+            }
+        }
+    }
+} // namespace raphael
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "LevelOfDetail.h"
+#include "tinygltf/tiny_gltf.h"
+
+namespace raphael
+{
+    // Vertex layout written by the importer, matches VertexWithTexCoord without depending on DirectXMath
+    struct ImportedVertex
+    {
+        float position[3];
+        float normal[3];
+        float texCoord[2];
+    };
+
+    struct GltfPrimitiveRange
+    {
+        uint32_t vertexOffset = 0; // Base vertex inside the shared vertex buffer
+        uint32_t indexOffset = 0;  // First index inside the shared index buffer
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        int materialIndex = -1;
+        float boundsMin[3] = {}; // Object space box of the positions, from the POSITION accessor's min and max
+        float boundsMax[3] = {};
+    };
+
+    struct GltfGeometryLayout
+    {
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;    // Full detail indices of every primitive
+        uint32_t lodIndexCount = 0; // Coarser level indices, stored after the full detail ones
+        std::vector<GltfPrimitiveRange> primitives; // In mesh order, then primitive order
+
+        uint64_t getVertexBufferSize() const { return static_cast<uint64_t>(vertexCount) * sizeof(ImportedVertex); }
+        uint64_t getIndexBufferSize() const { return static_cast<uint64_t>(indexCount + lodIndexCount) * sizeof(uint16_t); }
+    };
+
+    // Index ranges of one primitive's levels of detail over its full detail vertices, level 0 is the primitive itself
+    struct GltfPrimitiveLods
+    {
+        LodTable table;
+        uint32_t indexOffset[MaxLodLevels] = {};
+        uint32_t indexCount[MaxLodLevels] = {};
+    };
+
+    // Converts every mesh primitive of a glTF model into one shared vertex buffer and one shared index buffer.
+    // The layout is computed from accessor counts alone, so the caller can size and allocate the destination
+    // before any data is touched, and decoding then writes each element exactly once straight into it.
+    // Destinations can be mapped upload memory: writes are sequential and nothing is read back, which keeps
+    // write-combined pages happy. Knows nothing about D3D12, so it can decode into plain memory as well.
+    class GltfGeometryImporter
+    {
+    public:
+        // Validates the required attributes (POSITION, NORMAL, TEXCOORD_0 and indices) and builds the layout
+        explicit GltfGeometryImporter(const tinygltf::Model& model);
+        ~GltfGeometryImporter() = default;
+
+        const GltfGeometryLayout& getLayout() const { return m_layout; }
+
+        // Builds levelCount - 1 coarser levels of every primitive by vertex clustering, the cell starting at 1/32 of
+        // the primitive's bounding radius and doubling per level. Clusters straight from the POSITION and index
+        // accessors and keeps only the level sizes and errors, which grow layout.lodIndexCount: decodeIndices
+        // clusters again to write the indices, so the index buffer can be sized before anything is stored.
+        // Errors are kept from decreasing between levels, as LodSelector requires.
+        void planLevelsOfDetail(uint32_t levelCount);
+        // One entry per primitive once planLevelsOfDetail ran, empty before
+        const std::vector<GltfPrimitiveLods>& getLevelsOfDetail() const { return m_lods; }
+
+        // Write layout.vertexCount vertices to destination
+        void decodeVertices(ImportedVertex* destination) const;
+        // Write layout.indexCount + layout.lodIndexCount indices to destination, full detail first and then the
+        // planned levels, indices stay relative to their primitive's base vertex
+        void decodeIndices(uint16_t* destination) const;
+
+    private:
+        struct PrimitiveSource
+        {
+            const tinygltf::Accessor* position = nullptr;
+            const tinygltf::Accessor* normal = nullptr;
+            const tinygltf::Accessor* texCoord = nullptr;
+            const tinygltf::Accessor* indices = nullptr;
+        };
+
+        const tinygltf::Accessor& getAccessor(const tinygltf::Primitive& primitive, const char* attribute) const;
+        const uint8_t* getAccessorData(const tinygltf::Accessor& accessor, size_t* outStride) const;
+        template<typename Index>
+        void decodePrimitiveIndices(size_t primitiveIndex, Index* destination) const;
+        // Writes one coarser level of a primitive to outIndices and returns its geometric error
+        float clusterLevel(size_t primitiveIndex, uint32_t level, const uint32_t* primitiveIndices, std::vector<uint32_t>& outIndices) const;
+
+    private:
+        const tinygltf::Model& m_model;
+        GltfGeometryLayout m_layout;
+        std::vector<PrimitiveSource> m_sources; // Parallel to m_layout.primitives
+        std::vector<GltfPrimitiveLods> m_lods; // Parallel to m_layout.primitives once planned
+        uint32_t m_maxPrimitiveIndexCount = 0; // Sizes the per-primitive scratch used while clustering
+    };
+} // namespace raphael
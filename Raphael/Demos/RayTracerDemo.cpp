@@ -107,6 +107,8 @@ void RayTracerDemo::CreateGeometry()
     vertexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     vertexBufferDesc.usage = ResourceDesc::Usage::Upload;
     vertexBufferDesc.width = vertexBufferSize;
+    vertexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    vertexBufferDesc.debugName = "Vertex buffer";
 
     m_vertexBuffer = m_device->createResource(vertexBufferDesc);
 
@@ -131,6 +133,8 @@ void RayTracerDemo::CreateGeometry()
     indexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     indexBufferDesc.usage = ResourceDesc::Usage::Upload;
     indexBufferDesc.width = indexBufferSize;
+    indexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    indexBufferDesc.debugName = "Index buffer";
 
     m_indexBuffer = m_device->createResource(indexBufferDesc);
 
@@ -153,10 +157,7 @@ void RayTracerDemo::CreateGeometry()
 
 void RayTracerDemo::CreateConstantBuffers()
 {
-    for (UINT i = 0; i < g_frameCount; i++)
-    {
-        m_sceneCBs[i] = std::make_unique<UploadBuffer<RayTracingSceneConstants>>(m_device.get(), 1, true);
-    }
+    m_sceneCBs.create(g_frameCount, [&](uint32_t) { return std::make_unique<UploadBuffer<RayTracingSceneConstants>>(m_device.get(), 1, true); });
 }
 
 void RayTracerDemo::CreateRootSignature()
@@ -287,7 +288,7 @@ void RayTracerDemo::Render()
     ResourceView dsvHandle = {};
     RenderPassDesc renderPassDesc = RenderPassDesc::buildAsSingleRenderTarget(
         currentRtView,
-        currentBackBuffer->getNativeResource(),
+        currentBackBuffer,
         dsvHandle,
         WINDOW_WIDTH, WINDOW_HEIGHT,
         clearColor,
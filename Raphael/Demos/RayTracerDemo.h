@@ -10,6 +10,7 @@
 #include "SwapChainDx12.h"
 #include "FrameContext.h"
 #include "UploadBufferDx12.h"
+#include "FrameResource.h"
 #include "GPUStructs.h"
 #include "Window.h"
 
@@ -53,7 +54,7 @@ private:
     UINT m_indexCount = 0;
 
     // Constant buffers (one per frame for double buffering)
-    std::array<std::unique_ptr<UploadBuffer<RayTracingSceneConstants>>, g_frameCount> m_sceneCBs;
+    FrameResource<std::unique_ptr<UploadBuffer<RayTracingSceneConstants>>> m_sceneCBs;
 
     // Pipeline resources
     std::unique_ptr<ShaderDx12> m_shader;
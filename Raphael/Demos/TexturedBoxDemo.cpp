@@ -126,6 +126,8 @@ void TexturedBoxDemo::CreateSwapChainAndDepthBuffer(WindowInfo windowInfo)
     depthDesc.height = windowInfo.height;
     depthDesc.format = ResourceFormat::D24_UNORM_S8_UINT;
     depthDesc.bindFlags = ResourceBindFlags::DepthStencil;
+    depthDesc.memoryCategory = MemoryCategory::DepthStencil;
+    depthDesc.debugName = "Depth buffer";
 
     m_depthBuffer = m_device->createResource(depthDesc);
 
@@ -237,12 +239,16 @@ void TexturedBoxDemo::CreateGeometry()
     vertexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     vertexBufferDesc.usage = ResourceDesc::Usage::Default;
     vertexBufferDesc.width = vertexBufferSize;
+    vertexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    vertexBufferDesc.debugName = "Vertex buffer";
 
     m_vertexBuffer = m_device->createResource(vertexBufferDesc);
 
     // Create upload vertex buffer resource
     ResourceDesc vertexUploadDesc = vertexBufferDesc;
     vertexUploadDesc.usage = ResourceDesc::Usage::Upload;
+    vertexUploadDesc.memoryCategory = MemoryCategory::Staging;
+    vertexUploadDesc.debugName = "Vertex upload buffer";
     std::unique_ptr<ResourceDx12> vertexUploadBuffer = m_device->createResource(vertexUploadDesc);
 
     // Copy vertex data to vertex buffer
@@ -262,12 +268,16 @@ void TexturedBoxDemo::CreateGeometry()
     indexBufferDesc.type = ResourceDesc::ResourceType::Buffer;
     indexBufferDesc.usage = ResourceDesc::Usage::Default;
     indexBufferDesc.width = indexBufferSize;
+    indexBufferDesc.memoryCategory = MemoryCategory::Geometry;
+    indexBufferDesc.debugName = "Index buffer";
 
     m_indexBuffer = m_device->createResource(indexBufferDesc);
 
     // Create upload index buffer resource
     ResourceDesc indexUploadDesc = indexBufferDesc;
     indexUploadDesc.usage = ResourceDesc::Usage::Upload;
+    indexUploadDesc.memoryCategory = MemoryCategory::Staging;
+    indexUploadDesc.debugName = "Index upload buffer";
     std::unique_ptr<ResourceDx12> indexUploadBuffer = m_device->createResource(indexUploadDesc);
 
     // Copy index data to index buffer
@@ -311,11 +321,8 @@ void TexturedBoxDemo::CreateGeometry()
 // Layout matches cubeTexturedShader.hlsl's FrameConstants and BasicObjectConstants structs.
 void TexturedBoxDemo::CreateConstantBuffers()
 {
-    for (UINT i = 0; i < g_frameCount; i++)
-    {
-        m_frameCBs[i] = std::make_unique<UploadBuffer<FrameConstants>>(m_device.get(), 1, true);
-        m_objectCBs[i] = std::make_unique<UploadBuffer<BasicObjectConstants>>(m_device.get(), 1, true);
-    }
+    m_frameCBs.create(g_frameCount, [&](uint32_t) { return std::make_unique<UploadBuffer<FrameConstants>>(m_device.get(), 1, true); });
+    m_objectCBs.create(g_frameCount, [&](uint32_t) { return std::make_unique<UploadBuffer<BasicObjectConstants>>(m_device.get(), 1, true); });
 }
 
 // 8. Create root signature
@@ -443,6 +450,8 @@ void TexturedBoxDemo::CreateTexture()
     // Wrap the native D3D12 resource in our ResourceDx12 class
     m_texture = std::make_unique<ResourceDx12>(m_device.get(), textureResource);
     m_textureUploadBuffer = std::make_unique<ResourceDx12>(m_device.get(), uploadResource);
+    m_texture->trackMemory(MemoryCategory::Texture, "Box texture");
+    m_textureUploadBuffer->trackMemory(MemoryCategory::Staging, "Box texture upload buffer");
 
     DescriptorHandle srvHandle = {};
     m_textureSrvHeap->AllocateHeap(&srvHandle);
@@ -505,7 +514,7 @@ void TexturedBoxDemo::Render()
     const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
     RenderPassDesc renderPassDesc = RenderPassDesc::buildAsSingleRenderTarget(
         currentRtView,
-        currentBackBuffer->getNativeResource(),
+        currentBackBuffer,
         m_depthStencilView,
         WINDOW_WIDTH, WINDOW_HEIGHT,
         clearColor);
@@ -600,6 +609,8 @@ void TexturedBoxDemo::Resize(unsigned int width, unsigned int height)
         depthDesc.height = newHeight;
         depthDesc.format = ResourceFormat::D24_UNORM_S8_UINT;
         depthDesc.bindFlags = ResourceBindFlags::DepthStencil;
+        depthDesc.memoryCategory = MemoryCategory::DepthStencil;
+        depthDesc.debugName = "Depth buffer";
 
         m_depthBuffer = m_device->createResource(depthDesc);
 
@@ -10,6 +10,7 @@
 #include "SwapChainDx12.h"
 #include "FrameContext.h"
 #include "UploadBufferDx12.h"
+#include "FrameResource.h"
 #include "GPUStructs.h"
 #include "ImGuiLoader.h"
 #include "Window.h"
@@ -68,8 +69,8 @@ private:
     std::unique_ptr<ResourceDx12> m_textureUploadBuffer;
 
     // Constant buffers (one per frame for double buffering)
-    std::array<std::unique_ptr<UploadBuffer<FrameConstants>>, g_frameCount> m_frameCBs;
-    std::array<std::unique_ptr<UploadBuffer<BasicObjectConstants>>, g_frameCount> m_objectCBs;
+    FrameResource<std::unique_ptr<UploadBuffer<FrameConstants>>> m_frameCBs;
+    FrameResource<std::unique_ptr<UploadBuffer<BasicObjectConstants>>> m_objectCBs;
 
     // Pipeline resources
     std::unique_ptr<ShaderDx12> m_shader;
@@ -12,6 +12,7 @@ namespace raphael
     bool ImGuiLoader::Initialize(HWND hwnd, DeviceDx12* device, DescriptorHeapDx12* srvHeap, int numBackBuffers)
     {
         m_srvHeap = srvHeap;
+        m_device = device;
 
         // Make process DPI aware and obtain main monitor scale
         ImGui_ImplWin32_EnableDpiAwareness();
@@ -75,11 +76,78 @@ namespace raphael
         // This will be called every frame after NewFrame() and before Render().
     }
 
+    void ImGuiLoader::DisplayMemoryTracker()
+    {
+        if (m_device == nullptr)
+        {
+            return;
+        }
+
+        const MemoryTracker& tracker = m_device->getMemoryTracker();
+        const MemoryCategoryStats total = tracker.getTotalStats();
+        const uint64_t budget = tracker.getBudget();
+        const float toMB = 1.0f / (1024.0f * 1024.0f);
+
+        ImGui::Begin("GPU Memory");
+
+        if (budget != 0)
+        {
+            const uint64_t usage = tracker.getOsUsage();
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "%.1f / %.1f MB", usage * toMB, budget * toMB);
+            ImGui::ProgressBar(static_cast<float>(usage) / static_cast<float>(budget), ImVec2(-FLT_MIN, 0), overlay);
+            if (tracker.isOverBudget())
+            {
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Over budget!");
+            }
+        }
+        ImGui::Text("Tracked: %.1f MB (peak %.1f MB), %u objects", total.liveBytes * toMB, total.peakBytes * toMB, total.liveCount);
+        ImGui::Text("Last frame: +%u / -%u allocations", total.lastFrame.allocationCount, total.lastFrame.freeCount);
+
+        if (ImGui::BeginTable("MemoryCategories", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Category");
+            ImGui::TableSetupColumn("Live MB");
+            ImGui::TableSetupColumn("Peak MB");
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Churn +/-");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); ++i)
+            {
+                const MemoryCategory category = static_cast<MemoryCategory>(i);
+                const MemoryCategoryStats stats = tracker.getCategoryStats(category);
+                if (stats.peakBytes == 0)
+                {
+                    continue;
+                }
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(getMemoryCategoryName(category));
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", stats.liveBytes * toMB);
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", stats.peakBytes * toMB);
+                ImGui::TableNextColumn(); ImGui::Text("%u", stats.liveCount);
+                ImGui::TableNextColumn(); ImGui::Text("%u / %u", stats.lastFrame.allocationCount, stats.lastFrame.freeCount);
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::Button("Dump JSON"))
+        {
+            std::ofstream file("memory_report.json");
+            file << tracker.buildJson();
+        }
+
+        ImGui::End();
+    }
+
     void ImGuiLoader::Render(CommandList* cmdList)
     {
         ImGui::Render();
         // Render ImGui
         ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), cmdList->getNativeCommandList());
+        // The backend binds its own pipeline, root signature and buffers
+        cmdList->invalidateState();
     }
 
     void ImGuiLoader::Shutdown()
@@ -33,10 +33,14 @@ namespace raphael
         bool WantsCaptureMouse() const;
         bool WantsCaptureKeyboard() const;
 
+        // GPU memory panel fed by the device memory tracker, call from Display()
+        void DisplayMemoryTracker();
+
     private:
         static void SrvDescriptorAllocFn(ImGui_ImplDX12_InitInfo* info, D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle);
         static void SrvDescriptorFreeFn(ImGui_ImplDX12_InitInfo* info, D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle);
 
         DescriptorHeapDx12* m_srvHeap = nullptr;
+        DeviceDx12* m_device = nullptr;
     };
 }
@@ -7,10 +7,19 @@
 #include "Light.h"
 #include "Texture.h"
 #include "PoissonDiskDistribution.h"
+#include "InstancePacking.h"
+#include "FrustumCulling.h"
+#include "BoundingVolumeHierarchy.h"
+#include "OcclusionCulling.h"
+#include "LevelOfDetail.h"
+#include "FrameResource.h"
+#include "JobSystem.h"
 #include "tinygltf/tiny_gltf.h"
 
 // Config constants
 static constexpr int MAX_NUM_BOXES = 100;
+static constexpr int MAX_NUM_OCCLUDERS = 8;
+static constexpr int NUM_BOX_LODS = 4;
 
 class BoxRenderer : public Renderer
 {
@@ -30,6 +39,7 @@ public:
     void BuildPSO(D3D12Device& device);
     void BuildRenderItems();
     void BuildFrameContexts(D3D12Device& device);
+    void BuildInstanceBuffers(D3D12Device& device);
     void BuildMaterials();
     void BuildLights();
     
@@ -47,8 +57,10 @@ private:
     ComPtr<ID3D12DescriptorHeap> m_cbvHeap = nullptr;
     ComPtr<ID3D12RootSignature> m_rootSignature = nullptr;
     ComPtr<ID3D12PipelineState> m_pso = nullptr;
+    ComPtr<ID3D12PipelineState> m_instancedPso = nullptr;
 
     ComPtr<ID3DBlob> m_vsByteCode = nullptr;
+    ComPtr<ID3DBlob> m_vsInstancedByteCode = nullptr;
     ComPtr<ID3DBlob> m_psByteCode = nullptr;
 
     std::vector<D3D12_INPUT_ELEMENT_DESC> m_inputLayout;
@@ -72,5 +84,40 @@ private:
     
     // Rendering mode toggle
     bool m_usePoissonDisk = false;
+    // Poisson boxes as one instanced draw per submesh, transforms packed into a structured buffer per frame
+    bool m_useInstancing = true;
+    raphael::FrameResource<std::unique_ptr<UploadBuffer<raphael::InstanceTransform>>> m_instanceBuffers;
+    std::unique_ptr<raphael::JobSystem> m_jobSystem;
+    UINT m_drawCallCount = 0;
+    // Poisson boxes are frustum culled every frame, only the visible ones get constants, transforms and draws
+    DirectX::XMFLOAT3 m_meshCenter = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 m_meshExtents = { 0.0f, 0.0f, 0.0f };
+    raphael::CullingBounds m_boxBounds;
+    raphael::FrustumCuller m_frustumCuller;
+    std::vector<uint32_t> m_visibleBoxes;
+    // Same boxes in a BVH, grown as the Poisson disk spawns them. Culls hierarchically and answers the picking
+    // queries shown in the settings window.
+    raphael::BoundingVolumeHierarchy m_boxTree;
+    bool m_useBoxTree = true;
+    uint32_t m_centerBox = raphael::BoundingVolumeHierarchy::InvalidIndex;  // Hit by the view ray
+    uint32_t m_nearestBox = raphael::BoundingVolumeHierarchy::InvalidIndex; // Closest to the camera
+    // Boxes left after frustum culling are tested against a CPU depth buffer holding the nearest few of them.
+    // The model is no box, so occluders are drawn with its own triangles rather than its bounds.
+    raphael::OcclusionCuller m_occlusionCuller;
+    bool m_useOcclusionCulling = true;
+    std::vector<float> m_occluderPositions;
+    std::vector<uint32_t> m_occluderIndices;
+    std::vector<uint32_t> m_occluderBoxes;
+    uint32_t m_occludedBoxCount = 0;
+    // Coarser copies of the model, clustered index ranges over the same vertices, picked per box by screen space
+    // error. Submeshes of a level follow DrawArgs order, level 0 is DrawArgs itself. Instanced boxes that just
+    // switched are drawn at both levels, dithered against each other until the fade is over.
+    std::vector<std::vector<SubmeshGeometry>> m_boxLodSubmeshes;
+    uint32_t m_boxLodTable = 0;
+    raphael::LodSelector m_lodSelector;
+    bool m_useLod = true;
+    std::vector<uint32_t> m_lodInstances;                // Visible boxes grouped by level, fading ones in two groups
+    std::array<uint32_t, NUM_BOX_LODS + 1> m_lodGroupStarts = {};
+    raphael::FrameResource<std::unique_ptr<UploadBuffer<float>>> m_fadeBuffers;
     DirectX::XMVECTOR m_singleBoxPosition = { 0.0f, 0.0f, 0.0f, 0.0f };
 };
@@ -2,6 +2,7 @@
 
 #include "D3D12CommonHeaders.h"
 #include "imgui/imgui.h"
+#include "DescriptorRangeAllocator.h"
 
 // Descriptor heap allocator class
 class DescriptorHeapAllocator
@@ -13,6 +14,10 @@ public:
 
     void Alloc(D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle);
 
+    // Allocates count contiguous descriptors, the handles point at the first one
+    void AllocRange(UINT count, D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle);
+
+    // Frees a single descriptor or the whole range starting at the handles
     void Free(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle);
 
 private:
@@ -21,5 +26,5 @@ private:
     D3D12_CPU_DESCRIPTOR_HANDLE m_heapStartCpu{};
     D3D12_GPU_DESCRIPTOR_HANDLE m_heapStartGpu{};
     UINT m_handleIncrement = 0;
-    ImVector<int> m_freeIndices;
+    std::unique_ptr<raphael::DescriptorRangeAllocator> m_rangeAllocator;
 };
@@ -70,6 +70,7 @@ public:
     void WaitForGpu();
 
     void IncrementFrameIndex() { m_frameIndex++; }
+    UINT GetCurrentFrameIndex() const { return m_frameIndex % NUM_FRAMES_IN_FLIGHT; }
 
     D3D12_CPU_DESCRIPTOR_HANDLE CurrentBackBufferView() const;
     D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView() const;
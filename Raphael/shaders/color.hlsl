@@ -17,6 +17,17 @@
 Texture2D gDiffuseMap : register(t0);
 SamplerState gSampler : register(s0);
 
+// Instanced path: one transform per instance, the first three rows of the transposed world matrix
+struct InstanceTransform
+{
+    float4 Rows[3];
+};
+StructuredBuffer<InstanceTransform> gInstances : register(t1);
+// Level of detail cross-fade weight of each instance. The incoming level gets the weight w and keeps the pixels whose
+// dither threshold is below it, the outgoing level gets -w, sign bit set even for 0, and keeps the others. Both
+// compare the same w, so the outgoing level fills exactly the pixels the incoming one leaves out.
+StructuredBuffer<float> gInstanceFades : register(t2);
+
 cbuffer cbPerObject : register(b0)
 {
     float4x4 gWorld;
@@ -58,6 +69,7 @@ struct VertexOut
     float3 PosW : POSITION;
     float3 Normal : NORMAL;
     float2 TexC : TEXCOORD0;
+    nointerpolation float Fade : FADE;
 };
 
 VertexOut VS(VertexIn vin)
@@ -75,12 +87,52 @@ VertexOut VS(VertexIn vin)
     vout.PosH = mul(posW, gViewProj);
 
     vout.TexC = mul(float4(vin.TexC, 0.0f, 1.0f), gTextureTransform);
+    vout.Fade = 1.0f;
     
     return vout;
 }
 
+VertexOut VSInstanced(VertexIn vin, uint instanceID : SV_InstanceID)
+{
+    VertexOut vout;
+
+    InstanceTransform instance = gInstances[instanceID];
+    float4 posL = float4(vin.PosL, 1.0f);
+    float3 posW = float3(dot(instance.Rows[0], posL), dot(instance.Rows[1], posL), dot(instance.Rows[2], posL));
+    vout.PosW = posW;
+
+    // Instances are translated and uniformly scaled, the upper 3x3 keeps normals perpendicular
+    float4 normalL = float4(vin.NormalL, 0.0f);
+    vout.Normal = float3(dot(instance.Rows[0], normalL), dot(instance.Rows[1], normalL), dot(instance.Rows[2], normalL));
+
+    vout.PosH = mul(float4(posW, 1.0f), gViewProj);
+
+    vout.TexC = mul(float4(vin.TexC, 0.0f, 1.0f), gTextureTransform);
+    vout.Fade = gInstanceFades[instanceID];
+
+    return vout;
+}
+
+// 4x4 ordered dither thresholds, evenly spread over [0, 1)
+static const float gDitherThresholds[16] =
+{
+     0.0f / 16.0f,  8.0f / 16.0f,  2.0f / 16.0f, 10.0f / 16.0f,
+    12.0f / 16.0f,  4.0f / 16.0f, 14.0f / 16.0f,  6.0f / 16.0f,
+     3.0f / 16.0f, 11.0f / 16.0f,  1.0f / 16.0f,  9.0f / 16.0f,
+    15.0f / 16.0f,  7.0f / 16.0f, 13.0f / 16.0f,  5.0f / 16.0f
+};
+
 float4 PS(VertexOut pin) : SV_Target
 {
+    // Screen-door cross-fade between two levels of detail, both stay opaque and depth tested
+    if (pin.Fade < 1.0f)
+    {
+        uint2 pixel = uint2(pin.PosH.xy) % 4;
+        float threshold = gDitherThresholds[pixel.y * 4 + pixel.x];
+        bool isOutgoing = (asuint(pin.Fade) >> 31) != 0;
+        clip((isOutgoing ? threshold >= -pin.Fade : threshold < pin.Fade) ? 1.0f : -1.0f);
+    }
+
     // Sample the diffuse texture.
     float4 diffuseAlbedo = gDiffuseMap.Sample(gSampler, pin.TexC) * gDiffuseAlbedo;
 
@@ -5,6 +5,7 @@
 #include "TextureLoader/WICTextureLoader12.h"
 #include "backends/imgui_impl_win32.h"
 #include "backends/imgui_impl_dx12.h"
+#include <cfloat>
 
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -19,6 +20,9 @@ bool BoxRenderer::Initialize(D3D12Device& device, SwapChain& swapChain, HWND hwn
     // Init COM
     CoInitializeEx(nullptr, COINIT_MULTITHREADED);
 
+    // Workers for packing per-instance data
+    m_jobSystem = std::make_unique<raphael::JobSystem>();
+
     // Initialize Poisson disk distribution
     m_poissonDisk = std::make_unique<PoissonDiskDistribution>(m_spawnRadius, m_minExtent, m_maxExtent, m_singleBoxPosition);
 
@@ -70,6 +74,16 @@ void BoxRenderer::Shutdown()
 {
     m_boxGeo.reset();
     m_pso.Reset();
+    m_instancedPso.Reset();
+    for (auto& instanceBuffer : m_instanceBuffers.getAll())
+    {
+        instanceBuffer.reset();
+    }
+    for (auto& fadeBuffer : m_fadeBuffers.getAll())
+    {
+        fadeBuffer.reset();
+    }
+    m_jobSystem.reset();
     m_rootSignature.Reset();
     m_cbvHeap.Reset();
     for (auto& texture : m_boxTexture)
@@ -275,6 +289,58 @@ void BoxRenderer::BuildBoxGeometry(D3D12Device& device)
         meshIndex++;
     }
 
+    // Model space box around every submesh, the culling bounds of each placed copy
+    XMVECTOR boundsMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR boundsMax = XMVectorReplicate(-FLT_MAX);
+    for (const VertexShaderInput& vertex : totalVertices)
+    {
+        const XMVECTOR position = XMLoadFloat3(&vertex.Pos);
+        boundsMin = XMVectorMin(boundsMin, position);
+        boundsMax = XMVectorMax(boundsMax, position);
+    }
+    XMStoreFloat3(&m_meshCenter, (boundsMin + boundsMax) * 0.5f);
+    XMStoreFloat3(&m_meshExtents, (boundsMax - boundsMin) * 0.5f);
+
+    // Coarser levels cluster each submesh on a grid that doubles per level, relative to the model size. Their
+    // indices go after the full detail ones in the same buffer. A level's error is the worst of its submeshes,
+    // raised where needed so it never drops below the previous level's.
+    const float meshRadius = XMVectorGetX(XMVector3Length((boundsMax - boundsMin) * 0.5f));
+    raphael::LodTable lodTable;
+    lodTable.levelCount = NUM_BOX_LODS;
+    m_boxLodSubmeshes.assign(NUM_BOX_LODS, {});
+    for (const auto& drawArg : m_boxGeo->DrawArgs)
+    {
+        m_boxLodSubmeshes[0].push_back(drawArg.second);
+    }
+    std::vector<uint32_t> submeshIndices;
+    std::vector<uint32_t> lodIndices;
+    for (uint32_t level = 1; level < NUM_BOX_LODS; ++level)
+    {
+        const float cellSize = meshRadius / static_cast<float>(64 >> level);
+        float levelError = lodTable.geometricError[level - 1];
+        for (const SubmeshGeometry& submesh : m_boxLodSubmeshes[0])
+        {
+            submeshIndices.assign(totalIndices.begin() + submesh.StartIndexLocation,
+                totalIndices.begin() + submesh.StartIndexLocation + submesh.IndexCount);
+            const uint32_t vertexCount = submeshIndices.empty() ? 0 : *std::max_element(submeshIndices.begin(), submeshIndices.end()) + 1;
+            const float error = raphael::simplifyByClustering(&totalVertices[submesh.BaseVertexLocation].Pos.x, sizeof(VertexShaderInput),
+                vertexCount, submeshIndices.data(), static_cast<uint32_t>(submeshIndices.size()), cellSize, lodIndices);
+            levelError = std::max(levelError, error);
+
+            SubmeshGeometry lodSubmesh;
+            lodSubmesh.IndexCount = static_cast<UINT>(lodIndices.size());
+            lodSubmesh.StartIndexLocation = static_cast<UINT>(totalIndices.size());
+            lodSubmesh.BaseVertexLocation = submesh.BaseVertexLocation;
+            m_boxLodSubmeshes[level].push_back(lodSubmesh);
+            for (uint32_t index : lodIndices)
+            {
+                totalIndices.push_back(static_cast<std::uint16_t>(index));
+            }
+        }
+        lodTable.geometricError[level] = levelError;
+    }
+    m_boxLodTable = m_lodSelector.addTable(lodTable);
+
     const UINT vbByteSize = static_cast<UINT>(totalVertices.size() * sizeof(VertexShaderInput));
     const UINT ibByteSize = static_cast<UINT>(totalIndices.size() * sizeof(std::uint16_t));
 
@@ -295,6 +361,22 @@ void BoxRenderer::BuildBoxGeometry(D3D12Device& device)
     m_boxGeo->IndexFormat = DXGI_FORMAT_R16_UINT;
     m_boxGeo->IndexBufferByteSize = ibByteSize;
 
+    // Model space triangle list the occlusion culler draws the nearest copies with, submesh indices rebased
+    m_occluderPositions.clear();
+    for (const VertexShaderInput& vertex : totalVertices)
+    {
+        m_occluderPositions.insert(m_occluderPositions.end(), { vertex.Pos.x, vertex.Pos.y, vertex.Pos.z });
+    }
+    m_occluderIndices.clear();
+    for (const auto& drawArg : m_boxGeo->DrawArgs)
+    {
+        const SubmeshGeometry& submesh = drawArg.second;
+        for (UINT i = 0; i < submesh.IndexCount; ++i)
+        {
+            m_occluderIndices.push_back(totalIndices[submesh.StartIndexLocation + i] + submesh.BaseVertexLocation);
+        }
+    }
+
     OutputDebugStringA("glTF model loaded successfully!\n");
 }
 
@@ -381,7 +463,7 @@ void BoxRenderer::BuildRootSignature(D3D12Device& device)
     textureTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
 
     // Implementation for creating root signature 
-    CD3DX12_ROOT_PARAMETER slotRootParameter[4];
+    CD3DX12_ROOT_PARAMETER slotRootParameter[6];
 
     // Create root parameters to bind the descriptor table & constant buffer views to the pipeline
     // As a performance tip, order from most frequent to least frequent.
@@ -389,10 +471,14 @@ void BoxRenderer::BuildRootSignature(D3D12Device& device)
     slotRootParameter[1].InitAsConstantBufferView(1);
     slotRootParameter[2].InitAsConstantBufferView(2);
     slotRootParameter[3].InitAsDescriptorTable(1, &textureTable, D3D12_SHADER_VISIBILITY_PIXEL);
+    // Instance transforms of the instanced path, a root SRV needs no descriptor
+    slotRootParameter[4].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+    // Their level of detail cross-fade weights
+    slotRootParameter[5].InitAsShaderResourceView(2, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
     auto staticSamplers = GetStaticSamplers();
 
-    CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter, (UINT)staticSamplers.size(), staticSamplers.data(),
+    CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(6, slotRootParameter, (UINT)staticSamplers.size(), staticSamplers.data(),
         D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
     ComPtr<ID3DBlob> serializedRootSig = nullptr;
@@ -444,6 +530,7 @@ void BoxRenderer::BuildShadersAndInputLayout()
 {
     // Implementation for compiling shaders and defining input layout
     m_vsByteCode = D3D12Util::CompileShader(L"Shaders\\color.hlsl", nullptr, "VS", "vs_5_0");
+    m_vsInstancedByteCode = D3D12Util::CompileShader(L"Shaders\\color.hlsl", nullptr, "VSInstanced", "vs_5_0");
     m_psByteCode = D3D12Util::CompileShader(L"Shaders\\color.hlsl", nullptr, "PS", "ps_5_0");
 
     m_inputLayout =
@@ -592,15 +679,53 @@ void BoxRenderer::BuildPSO(D3D12Device& device)
 
     if (FAILED(device.GetDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso))))
         throw std::runtime_error("Failed to create pipeline state object");
+
+    // Same state, vertex shader reads the world transform from the instance buffer
+    psoDesc.VS = { reinterpret_cast<BYTE*>(m_vsInstancedByteCode->GetBufferPointer()), m_vsInstancedByteCode->GetBufferSize() };
+    if (FAILED(device.GetDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_instancedPso))))
+        throw std::runtime_error("Failed to create instanced pipeline state object");
 }
 
 void BoxRenderer::BuildRenderItems()
 {
-    // Generate the boxes to be rendered
+    // Generate the boxes to be rendered, the tree takes in each batch as it spawns
+    const auto& cubes = m_poissonDisk->GetSamples();
+    auto insertSpawnedBoxes = [&]()
+    {
+        for (uint32_t i = m_boxTree.getObjectCount(); i < cubes.size(); ++i)
+        {
+            const XMVECTOR center = cubes[i] + XMLoadFloat3(&m_meshCenter);
+            const XMVECTOR extents = XMLoadFloat3(&m_meshExtents);
+            XMFLOAT3 boundsMin;
+            XMFLOAT3 boundsMax;
+            XMStoreFloat3(&boundsMin, center - extents);
+            XMStoreFloat3(&boundsMax, center + extents);
+            m_boxTree.insert({ { boundsMin.x, boundsMin.y, boundsMin.z }, { boundsMax.x, boundsMax.y, boundsMax.z } });
+        }
+    };
+    insertSpawnedBoxes();
     while (m_poissonDisk->HasActiveSamples() && m_poissonDisk->GetSampleCount() < MAX_NUM_BOXES)
     {
         m_poissonDisk->SpawnNewSamples(10);
+        insertSpawnedBoxes();
+    }
+
+    // The boxes never move, their bounds and level of detail spheres are built once
+    const float extents[3] = { m_meshExtents.x, m_meshExtents.y, m_meshExtents.z };
+    const float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&m_meshExtents)));
+    m_boxBounds.clear();
+    m_boxBounds.reserve(static_cast<uint32_t>(cubes.size()));
+    m_lodSelector.clear();
+    m_lodSelector.reserve(static_cast<uint32_t>(cubes.size()));
+    for (const XMVECTOR& cube : cubes)
+    {
+        const float center[3] = { XMVectorGetX(cube) + m_meshCenter.x, XMVectorGetY(cube) + m_meshCenter.y, XMVectorGetZ(cube) + m_meshCenter.z };
+        m_boxBounds.addBox(center, extents);
+        m_lodSelector.addInstance(m_boxLodTable, center, radius);
     }
+    m_visibleBoxes.reserve(m_boxBounds.getPaddedCount());
+    m_occluderBoxes.reserve(m_boxBounds.getPaddedCount());
+    m_lodInstances.reserve(cubes.size() * 2);
 }
 
 void BoxRenderer::BuildFrameContexts(D3D12Device& device)
@@ -608,6 +733,23 @@ void BoxRenderer::BuildFrameContexts(D3D12Device& device)
     // Create frame contexts based on current mode
     int numObjects = m_usePoissonDisk ? static_cast<int>(m_poissonDisk->GetSampleCount()) : 1;
     device.CreateFrameContexts(1, numObjects);
+
+    BuildInstanceBuffers(device);
+}
+
+void BoxRenderer::BuildInstanceBuffers(D3D12Device& device)
+{
+    // One transform per Poisson sample and frame in flight, 48 bytes each instead of two 256-byte CBV slots.
+    // Room for two per sample, a box cross-fading between levels of detail is drawn in both.
+    UINT instanceCount = std::max<UINT>(static_cast<UINT>(m_poissonDisk->GetSampleCount()) * 2, 1);
+    m_instanceBuffers.create(NUM_FRAMES_IN_FLIGHT, [&](uint32_t)
+    {
+        return std::make_unique<UploadBuffer<raphael::InstanceTransform>>(device.GetDevice(), instanceCount, false);
+    });
+    m_fadeBuffers.create(NUM_FRAMES_IN_FLIGHT, [&](uint32_t)
+    {
+        return std::make_unique<UploadBuffer<float>>(device.GetDevice(), instanceCount, false);
+    });
 }
 
 void BoxRenderer::BuildMaterials()
@@ -670,6 +812,36 @@ void BoxRenderer::RenderUI()
     {
         ImGui::Text("Rendering Mode: Multiple Random Boxes");
         ImGui::Text("Number of boxes: %zu", m_poissonDisk->GetSampleCount());
+        ImGui::Checkbox("Instanced draws", &m_useInstancing);
+        ImGui::Text("Draw calls: %u", m_drawCallCount);
+        ImGui::Checkbox("Hierarchical culling (BVH)", &m_useBoxTree);
+        ImGui::Text("Frustum culling: %zu of %u boxes visible", m_visibleBoxes.size() + m_occludedBoxCount, m_boxBounds.getCount());
+        ImGui::Checkbox("Occlusion culling (CPU)", &m_useOcclusionCulling);
+        ImGui::Text("Occlusion culling: %u boxes hidden, %u occluder triangles", m_occludedBoxCount,
+            m_occlusionCuller.getStats().rasterizedTriangleCount);
+        ImGui::Checkbox("Level of detail", &m_useLod);
+        raphael::LodSettings lodSettings = m_lodSelector.getSettings();
+        bool lodSettingsChanged = ImGui::SliderFloat("LOD pixel error", &lodSettings.pixelError, 0.25f, 16.0f, "%.2f");
+        lodSettingsChanged |= ImGui::SliderFloat("LOD fade seconds", &lodSettings.fadeSeconds, 0.0f, 1.0f, "%.2f");
+        if (lodSettingsChanged)
+        {
+            m_lodSelector.setSettings(lodSettings);
+        }
+        uint32_t levelCounts[NUM_BOX_LODS] = {};
+        uint32_t fadingCount = 0;
+        for (uint32_t box : m_visibleBoxes)
+        {
+            const uint32_t level = m_useLod ? m_lodSelector.getLevels()[box] : 0;
+            levelCounts[level]++;
+            fadingCount += m_useLod && m_lodSelector.getPreviousLevels()[box] != level ? 1 : 0;
+        }
+        ImGui::Text("Visible boxes per level: %u / %u / %u / %u, %u fading", levelCounts[0], levelCounts[1], levelCounts[2], levelCounts[3],
+            fadingCount);
+        const raphael::BvhStats treeStats = m_boxTree.getStats();
+        ImGui::Text("BVH: %u nodes, depth %u, %u builds", treeStats.nodeCount, treeStats.depth, treeStats.buildCount);
+        ImGui::Text("Box at view center: %d, nearest box: %d",
+            m_centerBox == raphael::BoundingVolumeHierarchy::InvalidIndex ? -1 : static_cast<int>(m_centerBox),
+            m_nearestBox == raphael::BoundingVolumeHierarchy::InvalidIndex ? -1 : static_cast<int>(m_nearestBox));
     }
     else
     {
@@ -759,11 +931,50 @@ void BoxRenderer::Render(const ImVec4& clearColor)
     auto objCbvHandle = frameContext->ObjectCB->Resource();
     auto matCbvHandle = frameContext->MaterialCB->Resource();
 
-    if (m_usePoissonDisk)
+    m_drawCallCount = 0;
+    if (m_usePoissonDisk && m_useInstancing)
     {
-        // Render Poisson disk distribution
-        const auto& cubes = m_poissonDisk->GetSamples();
-        for (size_t i = 0; i < cubes.size(); ++i)
+        // Every visible box of a level in one draw per submesh, the shared material and texture transform sit
+        // in slot 0. Each level's instances start further into the transform and fade buffers.
+        cmdList->SetPipelineState(m_instancedPso.Get());
+        cmdList->SetGraphicsRootConstantBufferView(0, objCbvHandle->GetGPUVirtualAddress());
+        cmdList->SetGraphicsRootConstantBufferView(1, matCbvHandle->GetGPUVirtualAddress());
+        const D3D12_GPU_VIRTUAL_ADDRESS transformAddress = m_instanceBuffers[m_device->GetCurrentFrameIndex()]->Resource()->GetGPUVirtualAddress();
+        const D3D12_GPU_VIRTUAL_ADDRESS fadeAddress = m_fadeBuffers[m_device->GetCurrentFrameIndex()]->Resource()->GetGPUVirtualAddress();
+
+        D3D12_VERTEX_BUFFER_VIEW vbView = m_boxGeo->VertexBufferView();
+        D3D12_INDEX_BUFFER_VIEW ibView = m_boxGeo->IndexBufferView();
+        cmdList->IASetVertexBuffers(0, 1, &vbView);
+        cmdList->IASetIndexBuffer(&ibView);
+        cmdList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        for (uint32_t level = 0; level < NUM_BOX_LODS; ++level)
+        {
+            const UINT firstInstance = m_lodGroupStarts[level];
+            const UINT instanceCount = m_lodGroupStarts[level + 1] - firstInstance;
+            if (instanceCount == 0)
+            {
+                continue;
+            }
+            cmdList->SetGraphicsRootShaderResourceView(4, transformAddress + firstInstance * sizeof(raphael::InstanceTransform));
+            cmdList->SetGraphicsRootShaderResourceView(5, fadeAddress + firstInstance * sizeof(float));
+
+            auto texture_it = m_boxTexture.begin();
+            for (const SubmeshGeometry& submesh : m_boxLodSubmeshes[level])
+            {
+                cmdList->SetGraphicsRootDescriptorTable(3, (texture_it++)->second->SrvGpuHandle);
+                if (submesh.IndexCount == 0)
+                {
+                    continue;
+                }
+                cmdList->DrawIndexedInstanced(submesh.IndexCount, instanceCount, submesh.StartIndexLocation, submesh.BaseVertexLocation, 0);
+                m_drawCallCount++;
+            }
+        }
+    }
+    else if (m_usePoissonDisk)
+    {
+        // Render the visible boxes of the Poisson disk distribution, their constants are packed in visible order
+        for (size_t i = 0; i < m_visibleBoxes.size(); ++i)
         {
             // Set the object constant buffer view
             D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objCbvHandle->GetGPUVirtualAddress() + i * objCbvByteSize;
@@ -779,14 +990,19 @@ void BoxRenderer::Render(const ImVec4& clearColor)
             cmdList->IASetIndexBuffer(&ibView);
             cmdList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
             // TODO: Match each primitive to its corresponding texture/material for multiple meshes
+            // Only the selected level, the per-object shader does not cross-fade
+            const uint32_t level = m_useLod ? m_lodSelector.getLevels()[m_visibleBoxes[i]] : 0;
             auto texture_it = m_boxTexture.begin();
-            for (const auto& [name, submesh] : m_boxGeo->DrawArgs)
+            for (const SubmeshGeometry& submesh : m_boxLodSubmeshes[level])
             {
                 // Bind texture
                 cmdList->SetGraphicsRootDescriptorTable(3, (texture_it++)->second->SrvGpuHandle);
-                cmdList->DrawIndexedInstanced(
-                    m_boxGeo->DrawArgs[name].IndexCount,
-                    1, m_boxGeo->DrawArgs[name].StartIndexLocation, m_boxGeo->DrawArgs[name].BaseVertexLocation, 0);
+                if (submesh.IndexCount == 0)
+                {
+                    continue;
+                }
+                cmdList->DrawIndexedInstanced(submesh.IndexCount, 1, submesh.StartIndexLocation, submesh.BaseVertexLocation, 0);
+                m_drawCallCount++;
             }
         }
     }
@@ -813,6 +1029,7 @@ void BoxRenderer::Render(const ImVec4& clearColor)
             cmdList->DrawIndexedInstanced(
                 m_boxGeo->DrawArgs[name].IndexCount,
                 1, m_boxGeo->DrawArgs[name].StartIndexLocation, m_boxGeo->DrawArgs[name].BaseVertexLocation, 0);
+            m_drawCallCount++;
         }
     }
 
@@ -868,11 +1085,122 @@ void BoxRenderer::Update(float deltaTime)
 
     if (m_usePoissonDisk)
     {
-        // Update object constants for Poisson disk distribution
+        // Cull the boxes against the camera, their bounds are in world space
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, m_camera->GetViewProjectionMatrix());
+        const raphael::Frustum frustum = raphael::extractFrustum(&viewProj._11);
+        m_visibleBoxes.resize(m_boxBounds.getPaddedCount());
+        const uint32_t visibleCount = m_useBoxTree
+            ? m_boxTree.cullFrustum(frustum, m_visibleBoxes.data())
+            : m_frustumCuller.cull(*m_jobSystem, frustum, m_boxBounds, m_visibleBoxes.data());
+        m_visibleBoxes.resize(visibleCount);
+
+        // The nearest visible boxes occlude the rest. Both use the job system: bands of the depth buffer are
+        // rasterized in parallel, then blocks of the visible boxes are tested against it.
+        m_occludedBoxCount = 0;
+        if (m_useOcclusionCulling && visibleCount > 0)
+        {
+            const auto& cubes = m_poissonDisk->GetSamples();
+            const XMVECTOR eyePosition = m_camera->GetPosition();
+            const uint32_t occluderCount = std::min(static_cast<uint32_t>(MAX_NUM_OCCLUDERS), visibleCount);
+            m_occluderBoxes.assign(m_visibleBoxes.begin(), m_visibleBoxes.end());
+            std::partial_sort(m_occluderBoxes.begin(), m_occluderBoxes.begin() + occluderCount, m_occluderBoxes.end(),
+                [&](uint32_t lhs, uint32_t rhs)
+                {
+                    return XMVectorGetX(XMVector3LengthSq(cubes[lhs] - eyePosition)) < XMVectorGetX(XMVector3LengthSq(cubes[rhs] - eyePosition));
+                });
+
+            m_occlusionCuller.beginFrame(&viewProj._11);
+            for (uint32_t i = 0; i < occluderCount; ++i)
+            {
+                const XMVECTOR& cube = cubes[m_occluderBoxes[i]];
+                XMFLOAT4X4 world;
+                XMStoreFloat4x4(&world, XMMatrixTranslation(XMVectorGetX(cube), XMVectorGetY(cube), XMVectorGetZ(cube)));
+                // The glTF winding is not known to match the Direct3D one, draw both sides
+                m_occlusionCuller.addOccluderMesh(m_occluderPositions.data(), static_cast<uint32_t>(m_occluderPositions.size() / 3),
+                    m_occluderIndices.data(), static_cast<uint32_t>(m_occluderIndices.size()), &world._11, false);
+            }
+            m_occlusionCuller.rasterizeOccluders(*m_jobSystem);
+
+            const uint32_t unoccludedCount = m_occlusionCuller.cullOccluded(*m_jobSystem, m_boxBounds, m_visibleBoxes.data(), visibleCount, m_visibleBoxes.data());
+            m_occludedBoxCount = visibleCount - unoccludedCount;
+            m_visibleBoxes.resize(unoccludedCount);
+        }
+
+        // Box under the crosshair and the one closest to the camera
+        XMFLOAT3 eye;
+        XMFLOAT3 look;
+        XMStoreFloat3(&eye, m_camera->GetPosition());
+        XMStoreFloat3(&look, m_camera->GetLook());
+        raphael::BvhRayHit hit;
+        m_centerBox = m_boxTree.raycast(&eye.x, &look.x, 1000.0f, hit) ? hit.objectIndex : raphael::BoundingVolumeHierarchy::InvalidIndex;
+        m_nearestBox = m_boxTree.findNearest(&eye.x, FLT_MAX);
+
+        // Level of detail of every box from its projected error. Selection runs even while the levels are not
+        // used, so they are valid whenever the toggle flips.
+        XMFLOAT4X4 proj;
+        XMStoreFloat4x4(&proj, m_camera->GetProjectionMatrix());
+        const float viewportHeight = static_cast<float>(m_swapChain->GetBackBuffer(m_swapChain->GetCurrentBackBufferIndex())->GetDesc().Height);
+        m_lodSelector.select(*m_jobSystem, raphael::makeLodView(&eye.x, &proj._11, viewportHeight), deltaTime);
+    }
+
+    if (m_usePoissonDisk && m_useInstancing)
+    {
+        // Slot 0 holds the identity world and texture transform the instanced shader reads
+        frameContext->ObjectCB->CopyData(0, ObjectConstants());
+        frameContext->MaterialCB->CopyData(0, matConstants);
+
+        // Visible boxes grouped by level, one instanced draw per level and submesh. A box still fading also goes
+        // to its previous level's group with its weight negated.
+        const uint8_t* levels = m_lodSelector.getLevels();
+        const uint8_t* previousLevels = m_lodSelector.getPreviousLevels();
+        const float* lodFades = m_lodSelector.getFades();
+        m_lodGroupStarts.fill(0);
+        for (uint32_t box : m_visibleBoxes)
+        {
+            const uint32_t level = m_useLod ? levels[box] : 0;
+            m_lodGroupStarts[level + 1]++;
+            if (m_useLod && previousLevels[box] != level)
+            {
+                m_lodGroupStarts[previousLevels[box] + 1]++;
+            }
+        }
+        for (uint32_t level = 0; level < NUM_BOX_LODS; ++level)
+        {
+            m_lodGroupStarts[level + 1] += m_lodGroupStarts[level];
+        }
+
+        std::array<uint32_t, NUM_BOX_LODS> groupEnds;
+        std::copy(m_lodGroupStarts.begin(), m_lodGroupStarts.begin() + NUM_BOX_LODS, groupEnds.begin());
+        m_lodInstances.resize(m_lodGroupStarts[NUM_BOX_LODS]);
+        float* fades = m_fadeBuffers[m_device->GetCurrentFrameIndex()]->MappedData();
+        for (uint32_t box : m_visibleBoxes)
+        {
+            const uint32_t level = m_useLod ? levels[box] : 0;
+            const uint32_t slot = groupEnds[level]++;
+            m_lodInstances[slot] = box;
+            fades[slot] = m_useLod ? lodFades[box] : 1.0f;
+            if (m_useLod && previousLevels[box] != level)
+            {
+                const uint32_t previousSlot = groupEnds[previousLevels[box]]++;
+                m_lodInstances[previousSlot] = box;
+                fades[previousSlot] = -lodFades[box]; // Negated weight, the shader keeps the complementary pixels
+            }
+        }
+
+        // Samples are XMVECTORs, x y z w each. The packing streams straight into the mapped upload buffer.
+        const auto& cubes = m_poissonDisk->GetSamples();
+        raphael::packInstanceTranslations(*m_jobSystem, reinterpret_cast<const float*>(cubes.data()), m_lodInstances.data(),
+            static_cast<uint32_t>(m_lodInstances.size()), 1.0f, m_instanceBuffers[m_device->GetCurrentFrameIndex()]->MappedData());
+    }
+    else if (m_usePoissonDisk)
+    {
+        // Update object constants for the visible boxes of the Poisson disk distribution
         const auto& cubes = m_poissonDisk->GetSamples();
         size_t index = 0;
-        for (auto& cube : cubes)
+        for (uint32_t cubeIndex : m_visibleBoxes)
         {
+            const XMVECTOR& cube = cubes[cubeIndex];
             XMMATRIX world = XMLoadFloat4x4(&m_world);
             world = XMMatrixTranslation(XMVectorGetX(cube), XMVectorGetY(cube), XMVectorGetZ(cube));
 
@@ -3,7 +3,7 @@
 // Descriptor heap allocator class
 void DescriptorHeapAllocator::Initialize(ID3D12Device* device, ID3D12DescriptorHeap* heap)
 {
-    IM_ASSERT(m_heap == nullptr && m_freeIndices.empty());
+    IM_ASSERT(m_heap == nullptr && m_rangeAllocator == nullptr);
 
     m_heap = heap;
     D3D12_DESCRIPTOR_HEAP_DESC desc = heap->GetDesc();
@@ -12,22 +12,24 @@ void DescriptorHeapAllocator::Initialize(ID3D12Device* device, ID3D12DescriptorH
     m_heapStartGpu = m_heap->GetGPUDescriptorHandleForHeapStart();
     m_handleIncrement = device->GetDescriptorHandleIncrementSize(m_heapType);
 
-    m_freeIndices.reserve(static_cast<int>(desc.NumDescriptors));
-    for (int n = desc.NumDescriptors; n > 0; n--)
-        m_freeIndices.push_back(n - 1);
+    m_rangeAllocator = std::make_unique<raphael::DescriptorRangeAllocator>(desc.NumDescriptors);
 }
 
 void DescriptorHeapAllocator::Shutdown()
 {
     m_heap = nullptr;
-    m_freeIndices.clear();
+    m_rangeAllocator.reset();
 }
 
 void DescriptorHeapAllocator::Alloc(D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle)
 {
-    IM_ASSERT(m_freeIndices.Size > 0);
-    int idx = m_freeIndices.back();
-    m_freeIndices.pop_back();
+    AllocRange(1, outCpuHandle, outGpuHandle);
+}
+
+void DescriptorHeapAllocator::AllocRange(UINT count, D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle)
+{
+    uint32_t idx = m_rangeAllocator->allocate(count);
+    IM_ASSERT(idx != raphael::DescriptorRangeAllocator::InvalidIndex);
     outCpuHandle->ptr = m_heapStartCpu.ptr + (idx * m_handleIncrement);
     outGpuHandle->ptr = m_heapStartGpu.ptr + (idx * m_handleIncrement);
 }
@@ -37,5 +39,5 @@ void DescriptorHeapAllocator::Free(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle, D3D12_
     int cpuIdx = static_cast<int>((cpuHandle.ptr - m_heapStartCpu.ptr) / m_handleIncrement);
     int gpuIdx = static_cast<int>((gpuHandle.ptr - m_heapStartGpu.ptr) / m_handleIncrement);
     IM_ASSERT(cpuIdx == gpuIdx);
-    m_freeIndices.push_back(cpuIdx);
+    m_rangeAllocator->free(static_cast<uint32_t>(cpuIdx));
 }
\ No newline at end of file
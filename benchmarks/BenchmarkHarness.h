@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Shared helpers for the benchmarks. --quick shrinks every problem to a smoke run, which is how
+// ctest runs them; the numbers only mean something from a full run of an optimized build.
+namespace raphael::bench
+{
+    struct Timing
+    {
+        double medianMs = 0.0;
+        double minMs = 0.0;
+    };
+
+    inline bool& quickMode()
+    {
+        static bool quick = false;
+        return quick;
+    }
+
+    inline void parseArguments(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--quick") == 0)
+            {
+                quickMode() = true;
+            }
+        }
+    }
+
+    inline bool isQuick() { return quickMode(); }
+
+    // Full size, or the smoke size under --quick
+    template<typename T>
+    T pick(T full, T quick) { return isQuick() ? quick : full; }
+
+    // Times repetitions calls of function, the median and the fastest run
+    template<typename Function>
+    Timing measure(uint32_t repetitions, Function&& function)
+    {
+        std::vector<double> times;
+        times.reserve(repetitions);
+        for (uint32_t i = 0; i < repetitions; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+
+        Timing timing;
+        timing.medianMs = times[times.size() / 2];
+        timing.minMs = times.front();
+        return timing;
+    }
+
+    // Keeps the optimizer from dropping a result nobody reads
+    template<typename T>
+    void doNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static const void* volatile sink;
+        sink = &value;
+#endif
+    }
+} // namespace raphael::bench
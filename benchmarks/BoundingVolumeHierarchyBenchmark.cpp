@@ -0,0 +1,142 @@
+#include "BenchmarkHarness.h"
+#include "BoundingVolumeHierarchy.h"
+#include "CameraMath.h"
+#include "JobSystem.h"
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    std::vector<BvhBounds> makeBoxes(uint32_t count, float worldSize)
+    {
+        std::mt19937 random(count);
+        std::uniform_real_distribution<float> position(-worldSize, worldSize);
+        std::uniform_real_distribution<float> size(0.1f, 4.0f);
+        std::vector<BvhBounds> boxes(count);
+        for (BvhBounds& box : boxes)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float center = position(random);
+                const float extent = size(random);
+                box.min[axis] = center - extent;
+                box.max[axis] = center + extent;
+            }
+        }
+        return boxes;
+    }
+
+    double millionsPerSecond(uint32_t queries, const Timing& timing)
+    {
+        return queries / (timing.minMs * 1e3);
+    }
+}
+
+// Builds a BVH over 10K to 1M scattered boxes serially, over the job system and by incremental insertion, then
+// compares a frustum cull through the tree with the flat FrustumCuller and times raycasts, nearest object and
+// box queries.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const float worldSize = 1000.0f;
+    const float eye[3] = { 0.0f, 5.0f, -300.0f };
+    const float target[3] = { 0.0f, 0.0f, 0.0f };
+    const Frustum frustum = extractFrustum(test::makeViewProjection(eye, target).m);
+    JobSystem jobs(3);
+    const int reps = pick(5, 1);
+    const uint32_t queryCount = pick(100000u, 10000u);
+    std::printf("job system threads: %u\n", jobs.getThreadCount());
+
+    std::printf("%-10s %10s %10s %10s %7s %10s\n", "objects", "build ms", "jobs ms", "insert ms", "depth", "sah");
+    std::vector<std::vector<BvhBounds>> scenes;
+    for (uint32_t count : { 10000u, 100000u, pick(1000000u, 200000u) })
+    {
+        scenes.push_back(makeBoxes(count, worldSize));
+        const std::vector<BvhBounds>& boxes = scenes.back();
+        BoundingVolumeHierarchy bvh;
+        const Timing serial = measure(reps, [&] { bvh.build(boxes.data(), count); });
+        const Timing parallel = measure(reps, [&] { bvh.build(jobs, boxes.data(), count); });
+        const Timing inserted = measure(1, [&]
+        {
+            BoundingVolumeHierarchy incremental;
+            for (const BvhBounds& box : boxes)
+            {
+                incremental.insert(box);
+            }
+            doNotOptimize(incremental.getStats());
+        });
+        const BvhStats stats = bvh.getStats();
+        std::printf("%-10u %10.2f %10.2f %10.2f %7u %10.1f\n", count, serial.minMs, parallel.minMs, inserted.minMs, stats.depth,
+            stats.sahCost);
+    }
+
+    std::printf("\n%-10s %10s %12s %12s %10s %12s %10s\n", "objects", "visible", "tree cull ms", "flat cull ms", "rays M/s",
+        "nearest M/s", "boxes M/s");
+    for (const std::vector<BvhBounds>& boxes : scenes)
+    {
+        const uint32_t count = static_cast<uint32_t>(boxes.size());
+        BoundingVolumeHierarchy bvh;
+        bvh.build(jobs, boxes.data(), count);
+        CullingBounds flatBounds;
+        flatBounds.reserve(count);
+        for (const BvhBounds& box : boxes)
+        {
+            const float center[3] = { (box.min[0] + box.max[0]) * 0.5f, (box.min[1] + box.max[1]) * 0.5f, (box.min[2] + box.max[2]) * 0.5f };
+            const float extents[3] = { (box.max[0] - box.min[0]) * 0.5f, (box.max[1] - box.min[1]) * 0.5f, (box.max[2] - box.min[2]) * 0.5f };
+            flatBounds.addBox(center, extents);
+        }
+        FrustumCuller flatCuller;
+        std::vector<uint32_t> indices(flatBounds.getPaddedCount());
+        uint32_t visible = 0;
+        const Timing tree = measure(reps, [&] { visible = bvh.cullFrustum(frustum, indices.data()); });
+        const Timing flat = measure(reps, [&] { doNotOptimize(flatCuller.cull(frustum, flatBounds, indices.data())); });
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> position(-worldSize, worldSize);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        std::vector<float> points(queryCount * 3);
+        std::vector<float> directions(queryCount * 3);
+        for (uint32_t i = 0; i < queryCount * 3; ++i)
+        {
+            points[i] = position(random);
+            directions[i] = direction(random);
+        }
+        const Timing rays = measure(reps, [&]
+        {
+            uint32_t hits = 0;
+            BvhRayHit hit;
+            for (uint32_t i = 0; i < queryCount; ++i)
+            {
+                hits += bvh.raycast(&points[i * 3], &directions[i * 3], 200.0f, hit) ? 1 : 0;
+            }
+            doNotOptimize(hits);
+        });
+        const Timing nearest = measure(reps, [&]
+        {
+            uint32_t sum = 0;
+            for (uint32_t i = 0; i < queryCount; ++i)
+            {
+                sum += bvh.findNearest(&points[i * 3], 100.0f);
+            }
+            doNotOptimize(sum);
+        });
+        const Timing boxQueries = measure(reps, [&]
+        {
+            uint32_t found = 0;
+            for (uint32_t i = 0; i < queryCount; ++i)
+            {
+                const float* p = &points[i * 3];
+                const BvhBounds box = { { p[0] - 10.0f, p[1] - 10.0f, p[2] - 10.0f }, { p[0] + 10.0f, p[1] + 10.0f, p[2] + 10.0f } };
+                found += bvh.queryBox(box, indices.data());
+            }
+            doNotOptimize(found);
+        });
+
+        std::printf("%-10u %10u %12.3f %12.3f %10.2f %12.2f %10.2f\n", count, visible, tree.minMs, flat.minMs,
+            millionsPerSecond(queryCount, rays), millionsPerSecond(queryCount, nearest), millionsPerSecond(queryCount, boxQueries));
+    }
+    return 0;
+}
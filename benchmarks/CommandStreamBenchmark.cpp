@@ -0,0 +1,76 @@
+#include "BenchmarkHarness.h"
+#include "CommandStream.h"
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    // Folds every decoded call into a checksum, so replay cost is the decoding alone
+    struct ChecksumTranslator
+    {
+        uint64_t sum = 0;
+
+        void setPipeline(CommandHandle pipeline) { sum += pipeline; }
+        void setRootSignature(CommandHandle rootSignature) { sum += rootSignature; }
+        void setDescriptorHeap(CommandHandle heap) { sum += heap; }
+        void setVertexBuffer(uint32_t slot, CommandHandle view) { sum += slot + view; }
+        void setIndexBuffer(CommandHandle view) { sum += view; }
+        void setRootConstantBuffer(uint32_t parameter, uint64_t address) { sum += parameter + address; }
+        void setRootDescriptorTable(uint32_t parameter, uint64_t handle) { sum += parameter + handle; }
+        void transition(CommandHandle resource, ResourceState state) { sum += resource + static_cast<uint32_t>(state); }
+        void draw(const CommandDraw& draw) { sum += draw.vertexCount + draw.instanceCount; }
+        void drawIndexed(const CommandDrawIndexed& draw) { sum += draw.indexCount + draw.startIndex + draw.baseVertex; }
+    };
+
+    // The demos' base pass: shared state once, then a texture table, a constant buffer and an indexed draw per draw
+    void recordBasePass(CommandStream& stream, uint32_t drawCount)
+    {
+        stream.clear();
+        stream.setDescriptorHeap(0);
+        stream.setRootSignature(0);
+        stream.setPipeline(0);
+        stream.setVertexBuffer(0, 0);
+        stream.setIndexBuffer(1);
+        for (uint32_t draw = 0; draw < drawCount; ++draw)
+        {
+            stream.setRootDescriptorTable(2, 0x10000 + draw * 32ull);
+            stream.setRootConstantBuffer(0, 0x200000000ull + draw * 256ull);
+            stream.drawIndexed(36 + draw % 7, 1, draw * 36, 0, 0);
+        }
+    }
+}
+
+// Recording a base pass into a CommandStream and replaying it into a translator that only checksums the
+// calls: the cost the stream adds over recording straight into a command list.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const int reps = pick(20, 2);
+    std::printf("%-10s %-10s %12s %14s %14s %14s\n", "draws", "commands", "bytes/cmd", "record cmd/us", "replay cmd/us", "record ns/draw");
+    for (uint32_t drawCount : { 1000u, 10000u, pick(100000u, 20000u) })
+    {
+        CommandStream stream;
+        stream.reserve(drawCount * 64ull);
+        const Timing record = measure(reps, [&]
+        {
+            recordBasePass(stream, drawCount);
+            doNotOptimize(stream.getBytes().data());
+        });
+
+        uint64_t checksum = 0;
+        const Timing replay = measure(reps, [&]
+        {
+            ChecksumTranslator translator;
+            replayCommandStream(stream.getBytes(), translator);
+            checksum += translator.sum;
+        });
+        doNotOptimize(&checksum);
+
+        const double commandCount = stream.getCommandCount();
+        std::printf("%-10u %-10u %12.1f %14.1f %14.1f %14.1f\n", drawCount, stream.getCommandCount(), stream.getSize() / commandCount,
+            commandCount / (record.minMs * 1000.0), commandCount / (replay.minMs * 1000.0), record.minMs * 1e6 / drawCount);
+    }
+    return 0;
+}
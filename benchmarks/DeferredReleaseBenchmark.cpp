@@ -0,0 +1,168 @@
+#include "BenchmarkHarness.h"
+#include "DeferredReleaseQueue.h"
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <thread>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // GPU timeline in wall-clock time: frames execute back to back, each taking frameDuration
+    class SimulatedGpu
+    {
+    public:
+        explicit SimulatedGpu(Clock::duration frameDuration) : m_frameDuration(frameDuration) {}
+
+        void submit(uint64_t fenceValue)
+        {
+            const Clock::time_point start = std::max(Clock::now(), m_lastEnd);
+            m_lastEnd = start + m_frameDuration;
+            m_pending.push_back({ fenceValue, m_lastEnd });
+        }
+
+        uint64_t getCompletedFenceValue()
+        {
+            const Clock::time_point now = Clock::now();
+            while (!m_pending.empty() && m_pending.front().end <= now)
+            {
+                m_completed = m_pending.front().fenceValue;
+                m_pending.pop_front();
+            }
+            return m_completed;
+        }
+
+        void waitForFence(uint64_t fenceValue)
+        {
+            if (getCompletedFenceValue() >= fenceValue)
+            {
+                return;
+            }
+            for (const Submission& submission : m_pending)
+            {
+                if (submission.fenceValue >= fenceValue)
+                {
+                    std::this_thread::sleep_until(submission.end);
+                    break;
+                }
+            }
+            getCompletedFenceValue();
+        }
+
+    private:
+        struct Submission
+        {
+            uint64_t fenceValue = 0;
+            Clock::time_point end;
+        };
+
+        Clock::duration m_frameDuration;
+        Clock::time_point m_lastEnd;
+        std::deque<Submission> m_pending;
+        uint64_t m_completed = 0;
+    };
+
+    struct Pipeline
+    {
+        std::vector<uint8_t> state = std::vector<uint8_t>(64 * 1024);
+    };
+
+    struct FrameTimes
+    {
+        double medianMs = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        double toggleMs = 0.0; // Mean of the frames that toggled
+    };
+
+    // A GPU-bound loop with three frames in flight that recreates its pipeline every toggleInterval frames,
+    // like the wireframe toggle. The old pipeline is either destroyed after a full GPU wait or retired.
+    FrameTimes runFrames(bool deferred, uint32_t frameCount, uint32_t toggleInterval)
+    {
+        const uint64_t framesInFlight = 3;
+        const auto cpuWork = std::chrono::microseconds(1000);
+        SimulatedGpu gpu(std::chrono::microseconds(4000));
+        DeferredReleaseQueue releaseQueue;
+        auto pipeline = std::make_unique<Pipeline>();
+
+        std::vector<double> frameMs;
+        double toggleMsSum = 0.0;
+        uint32_t toggleCount = 0;
+        uint64_t fence = 0;
+        Clock::time_point frameStart = Clock::now();
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            // Frame pacing: the slot being reused must be done
+            if (fence >= framesInFlight)
+            {
+                gpu.waitForFence(fence - framesInFlight + 1);
+            }
+            releaseQueue.releaseCompleted(gpu.getCompletedFenceValue());
+
+            const Clock::time_point workEnd = Clock::now() + cpuWork;
+            while (Clock::now() < workEnd)
+            {
+            }
+
+            if (frame % toggleInterval == toggleInterval - 1)
+            {
+                auto replacement = std::make_unique<Pipeline>();
+                if (deferred)
+                {
+                    releaseQueue.retire(std::move(pipeline), fence + 1);
+                }
+                else
+                {
+                    // Before: flush the GPU so the old pipeline can be destroyed right away
+                    gpu.waitForFence(fence);
+                    pipeline.reset();
+                }
+                pipeline = std::move(replacement);
+            }
+
+            gpu.submit(++fence);
+
+            const Clock::time_point frameEnd = Clock::now();
+            frameMs.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+            frameStart = frameEnd;
+            if (frame % toggleInterval == toggleInterval - 1)
+            {
+                toggleMsSum += frameMs.back();
+                toggleCount++;
+            }
+        }
+        gpu.waitForFence(fence);
+        releaseQueue.releaseAll();
+
+        // The first frames fill the pipeline and are not representative
+        frameMs.erase(frameMs.begin(), frameMs.begin() + std::min<size_t>(framesInFlight + 1, frameMs.size()));
+        std::sort(frameMs.begin(), frameMs.end());
+        FrameTimes times;
+        times.medianMs = frameMs[frameMs.size() / 2];
+        times.p99Ms = frameMs[std::min(frameMs.size() - 1, frameMs.size() * 99 / 100)];
+        times.maxMs = frameMs.back();
+        times.toggleMs = toggleMsSum / std::max(toggleCount, 1u);
+        return times;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+    const uint32_t frameCount = pick(600u, 24u);
+    const uint32_t toggleInterval = pick(20u, 8u);
+
+    std::printf("%u frames, GPU 4 ms and CPU 1 ms per frame, pipeline toggled every %u frames\n", frameCount, toggleInterval);
+    std::printf("%-22s %10s %10s %10s %10s\n", "destruction", "median ms", "p99 ms", "max ms", "toggle ms");
+    const FrameTimes waitTimes = runFrames(false, frameCount, toggleInterval);
+    std::printf("%-22s %10.2f %10.2f %10.2f %10.2f\n", "wait for GPU, destroy", waitTimes.medianMs, waitTimes.p99Ms, waitTimes.maxMs,
+        waitTimes.toggleMs);
+    const FrameTimes deferredTimes = runFrames(true, frameCount, toggleInterval);
+    std::printf("%-22s %10.2f %10.2f %10.2f %10.2f\n", "deferred release", deferredTimes.medianMs, deferredTimes.p99Ms, deferredTimes.maxMs,
+        deferredTimes.toggleMs);
+    return 0;
+}
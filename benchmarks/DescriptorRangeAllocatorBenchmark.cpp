@@ -0,0 +1,127 @@
+#include "BenchmarkHarness.h"
+#include "DescriptorRangeAllocator.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    // The previous free-list heap could only hand out single descriptors. The reference here finds a
+    // contiguous range by scanning an occupancy map first-fit, the simplest way to get tables without TLSF.
+    class LinearScanAllocator
+    {
+    public:
+        explicit LinearScanAllocator(uint32_t capacity) : m_used(capacity, 0), m_sizes(capacity, 0) {}
+
+        uint32_t allocate(uint32_t count)
+        {
+            uint32_t run = 0;
+            for (uint32_t i = 0; i < m_used.size(); ++i)
+            {
+                run = m_used[i] ? 0 : run + 1;
+                if (run == count)
+                {
+                    const uint32_t first = i + 1 - count;
+                    std::fill(m_used.begin() + first, m_used.begin() + first + count, 1);
+                    m_sizes[first] = count;
+                    return first;
+                }
+            }
+            return DescriptorRangeAllocator::InvalidIndex;
+        }
+
+        void free(uint32_t first)
+        {
+            std::fill(m_used.begin() + first, m_used.begin() + first + m_sizes[first], 0);
+        }
+
+    private:
+        std::vector<uint8_t> m_used;
+        std::vector<uint32_t> m_sizes;
+    };
+
+    struct Workload
+    {
+        std::vector<uint32_t> counts;  // Range size of each operation, 0 frees instead
+        std::vector<uint32_t> victims;
+    };
+
+    // Mostly single SRVs with occasional material and G-buffer tables, about 70 % occupancy
+    Workload makeWorkload(uint32_t operationCount, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        Workload workload;
+        workload.counts.resize(operationCount);
+        workload.victims.resize(operationCount);
+        for (uint32_t i = 0; i < operationCount; ++i)
+        {
+            const uint32_t kind = random() % 10;
+            workload.counts[i] = kind < 4 ? 0 : kind < 8 ? 1 : kind < 9 ? 4 + random() % 5 : 16 + random() % 48;
+            workload.victims[i] = random();
+        }
+        return workload;
+    }
+
+    template<typename Allocator>
+    double run(Allocator& allocator, uint32_t capacity, const Workload& workload, uint32_t* outFailed)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> live; // First index and count
+        live.reserve(workload.counts.size());
+        uint32_t usedCount = 0;
+        uint32_t failed = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < workload.counts.size(); ++i)
+        {
+            if (workload.counts[i] == 0 || usedCount > capacity * 7 / 10)
+            {
+                if (!live.empty())
+                {
+                    const size_t index = workload.victims[i] % live.size();
+                    allocator.free(live[index].first);
+                    usedCount -= live[index].second;
+                    live[index] = live.back();
+                    live.pop_back();
+                }
+                continue;
+            }
+
+            const uint32_t first = allocator.allocate(workload.counts[i]);
+            if (first == DescriptorRangeAllocator::InvalidIndex)
+            {
+                failed++;
+            }
+            else
+            {
+                live.push_back({ first, workload.counts[i] });
+                usedCount += workload.counts[i];
+            }
+        }
+        *outFailed = failed;
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / workload.counts.size();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+    const uint32_t capacity = 16384;
+    const uint32_t operationCount = pick(1000000u, 10000u);
+    const Workload workload = makeWorkload(operationCount, 5);
+
+    std::printf("%u randomised alloc/free operations on a %u descriptor heap\n", operationCount, capacity);
+    std::printf("%-14s %10s %10s %12s %14s\n", "allocator", "ns/op", "failed", "free blocks", "fragmentation");
+
+    DescriptorRangeAllocator rangeAllocator(capacity);
+    uint32_t failed = 0;
+    const double rangeNs = run(rangeAllocator, capacity, workload, &failed);
+    const TlsfAllocator::Stats stats = rangeAllocator.getStats();
+    std::printf("%-14s %10.1f %10u %12u %14.3f\n", "tlsf ranges", rangeNs, failed, stats.freeBlockCount, stats.fragmentation());
+
+    LinearScanAllocator scanAllocator(capacity);
+    const double scanNs = run(scanAllocator, capacity, workload, &failed);
+    std::printf("%-14s %10.1f %10u %12s %14s\n", "linear scan", scanNs, failed, "-", "-");
+    return 0;
+}
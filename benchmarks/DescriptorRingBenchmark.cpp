@@ -0,0 +1,64 @@
+#include "BenchmarkHarness.h"
+#include "DescriptorRingAllocator.h"
+#include "NullDevice.h"
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+// Transient descriptor tables per frame on the null device, the GPU trailing two frames behind.
+// Measures the ring's allocation and recycling throughput and how often an undersized ring stalls.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+    const uint32_t frameCount = pick(500u, 10u);
+
+    std::printf("%-10s %-12s %14s %14s %12s\n", "tables", "ring size", "ns/table", "tables/us", "waits/frame");
+    for (uint32_t tablesPerFrame : { 1000u, 10000u, 50000u })
+    {
+        // Table sizes of a mixed scene: mostly one texture, some material sets and G-buffer tables
+        std::mt19937 random(tablesPerFrame);
+        std::vector<uint32_t> tableSizes(tablesPerFrame);
+        uint32_t descriptorsPerFrame = 0;
+        for (uint32_t& size : tableSizes)
+        {
+            const uint32_t kind = random() % 8;
+            size = kind < 5 ? 1 : kind < 7 ? 4 : 5;
+            descriptorsPerFrame += size;
+        }
+
+        // Sized for three frames in flight, and undersized so the ring has to wait for the GPU
+        for (uint32_t framesOfSpace : { 3u, 2u })
+        {
+            NullDeviceDesc desc;
+            desc.fenceLatency = 2;
+            NullDevice device(desc);
+            DescriptorRingAllocator ring(descriptorsPerFrame * framesOfSpace);
+            NullDescriptorHeapDesc heapDesc;
+            heapDesc.name = "Descriptor ring";
+            heapDesc.descriptorCount = descriptorsPerFrame * framesOfSpace;
+            heapDesc.shaderVisible = true;
+            std::unique_ptr<NullDescriptorHeap> heap = device.createDescriptorHeap(heapDesc);
+
+            uint64_t checksum = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                for (uint32_t size : tableSizes)
+                {
+                    checksum += heap->getGpuHandle(ring.allocate(device, size));
+                }
+                const uint64_t fence = device.getNextFenceValue();
+                ring.finishFrame(fence);
+                device.signalFence(fence);
+            }
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            doNotOptimize(checksum);
+
+            const double tables = static_cast<double>(frameCount) * tablesPerFrame;
+            std::printf("%-10u %-12u %14.2f %14.1f %12.2f\n", tablesPerFrame, descriptorsPerFrame * framesOfSpace, ns / tables,
+                tables / (ns / 1000.0), static_cast<double>(ring.getWaitCount()) / frameCount);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "BenchmarkHarness.h"
+#include "FrameArena.h"
+#include "HeapAllocationCounter.h"
+#include <cstdlib>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    struct DrawItem
+    {
+        uint64_t sortKey = 0;
+        uint64_t constants = 0;
+        uint32_t drawIndex = 0;
+    };
+}
+
+// Two views of the same per-frame work. Raw small allocations: a bump pointer against malloc/free.
+// Draw lists: per-thread std::pmr::vectors in a FrameArenaPool against std::vector on the global heap,
+// with the heap allocations per frame. Growing a list in the arena leaves every outgrown buffer behind
+// until reset, so large lists should be reserved.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const uint32_t allocationCount = pick(1000000u, 10000u);
+    std::printf("%-26s %14s\n", "48 byte allocations", "ns/allocation");
+    {
+        FrameArena arena(static_cast<size_t>(allocationCount) * 64);
+        const Timing arenaTiming = measure(10, [&]
+        {
+            arena.reset();
+            for (uint32_t i = 0; i < allocationCount; ++i)
+            {
+                doNotOptimize(arena.allocate(48, 16));
+            }
+        });
+
+        std::vector<void*> pointers(allocationCount);
+        const Timing mallocTiming = measure(10, [&]
+        {
+            for (uint32_t i = 0; i < allocationCount; ++i)
+            {
+                pointers[i] = std::malloc(48);
+            }
+            for (uint32_t i = 0; i < allocationCount; ++i)
+            {
+                std::free(pointers[i]);
+            }
+        });
+
+        std::printf("%-26s %14.2f\n", "frame arena", arenaTiming.medianMs * 1e6 / allocationCount);
+        std::printf("%-26s %14.2f\n", "malloc/free", mallocTiming.medianMs * 1e6 / allocationCount);
+    }
+
+    const uint32_t frameCount = pick(2000u, 20u);
+    const uint32_t threadCount = 4;
+    std::printf("\n%-26s %8s %14s %18s\n", "draw lists, 4 threads", "draws", "us/frame", "heap allocs/frame");
+    for (uint32_t drawCount : { 100u, 1000u, 10000u })
+    {
+        // Lists grown by push_back, and lists reserved up front as the demos do for their draw lists
+        auto runArena = [&](bool reserve, uint64_t& outAllocations)
+        {
+            FrameArenaPool pool(3, threadCount, 1024);
+            uint32_t frame = 0;
+            return measure(5, [&]
+            {
+                for (uint32_t i = 0; i < frameCount; ++i, ++frame)
+                {
+                    pool.beginFrame(frame % pool.getFrameCount());
+                    HeapAllocationScope scope(HeapAllocationSource::CurrentThread);
+                    for (uint32_t thread = 0; thread < threadCount; ++thread)
+                    {
+                        std::pmr::vector<DrawItem> drawList(&pool.getResource(thread));
+                        if (reserve)
+                        {
+                            drawList.reserve(drawCount);
+                        }
+                        for (uint32_t draw = 0; draw < drawCount; ++draw)
+                        {
+                            drawList.push_back({ draw * 31ull, draw, draw });
+                        }
+                        std::pmr::vector<uint32_t> order(drawList.size(), 0u, &pool.getResource(thread));
+                        doNotOptimize(order.data());
+                    }
+                    outAllocations += scope.getAllocationCount();
+                }
+            });
+        };
+        uint64_t arenaAllocations = 0;
+        uint64_t reservedAllocations = 0;
+        const Timing arenaTiming = runArena(false, arenaAllocations);
+        const Timing reservedTiming = runArena(true, reservedAllocations);
+
+        uint64_t heapAllocations = 0;
+        const Timing heapTiming = measure(5, [&]
+        {
+            for (uint32_t i = 0; i < frameCount; ++i)
+            {
+                HeapAllocationScope scope(HeapAllocationSource::CurrentThread);
+                for (uint32_t thread = 0; thread < threadCount; ++thread)
+                {
+                    std::vector<DrawItem> drawList;
+                    for (uint32_t draw = 0; draw < drawCount; ++draw)
+                    {
+                        drawList.push_back({ draw * 31ull, draw, draw });
+                    }
+                    std::vector<uint32_t> order(drawList.size(), 0u);
+                    doNotOptimize(order.data());
+                }
+                heapAllocations += scope.getAllocationCount();
+            }
+        });
+
+        // The first frame of every slot grows its arena, averaged over every measured frame
+        const double frames = 5.0 * frameCount;
+        std::printf("%-26s %8u %14.2f %18.2f\n", "frame arena pool", drawCount, arenaTiming.medianMs * 1e3 / frameCount, arenaAllocations / frames);
+        std::printf("%-26s %8u %14.2f %18.2f\n", "frame arena pool, reserved", drawCount, reservedTiming.medianMs * 1e3 / frameCount, reservedAllocations / frames);
+        std::printf("%-26s %8u %14.2f %18.2f\n", "std::vector", drawCount, heapTiming.medianMs * 1e3 / frameCount, heapAllocations / frames);
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "BenchmarkHarness.h"
+#include "FramePipeline.h"
+#include <thread>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    void spin(double ms)
+    {
+        const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+        while (Clock::now() < end) {}
+    }
+}
+
+// Headless frame loop: the simulation is CPU work, the render thread records on the CPU and then waits for
+// present / the GPU. Serial runs both on one thread, pipelined overlaps the simulation of the next snapshot
+// with recording and presenting the current one. Reports frame time and the snapshot age at pickup.
+// The overlap needs a second hardware thread for the CPU parts, sleeping in present overlaps regardless.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    const double simulateMs = 4.0;
+    const double recordMs = 2.0;
+    const double presentMs = 6.0;
+    const int frameCount = pick(300, 20);
+
+    std::printf("%-12s %12s %10s %14s %12s\n", "loop", "ms/frame", "fps", "latency ms", "simulated");
+    for (bool threaded : { false, true })
+    {
+        FramePipeline<uint64_t> pipeline([&](uint64_t& snapshot, double)
+        {
+            spin(simulateMs);
+            snapshot++;
+        });
+        if (threaded)
+        {
+            pipeline.start();
+        }
+
+        double latencyMs = 0.0;
+        const Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            doNotOptimize(&pipeline.acquire());
+            latencyMs += pipeline.getStats().latencyMs;
+            spin(recordMs);
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(presentMs));
+        }
+        const double frameMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frameCount;
+        pipeline.stop();
+
+        std::printf("%-12s %12.2f %10.1f %14.2f %12llu\n", threaded ? "pipelined" : "serial", frameMs, 1000.0 / frameMs,
+            latencyMs / frameCount, static_cast<unsigned long long>(pipeline.getStats().simulatedCount));
+    }
+    return 0;
+}
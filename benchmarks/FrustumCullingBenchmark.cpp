@@ -0,0 +1,57 @@
+#include "BenchmarkHarness.h"
+#include "CameraMath.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+// Frustum culling 10K to 1M scattered boxes and spheres with the scalar loop, AVX2 and AVX2 split over the
+// job system. The camera sees a few percent of them, as in the demos' Poisson scenes.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const float eye[3] = { 0.0f, 5.0f, -300.0f };
+    const float target[3] = { 0.0f, 0.0f, 0.0f };
+    const Frustum frustum = extractFrustum(test::makeViewProjection(eye, target).m);
+    FrustumCuller culler;
+    JobSystem jobs(3);
+    const int reps = pick(9, 1);
+    std::printf("AVX2: %s, job system threads: %u\n", culler.isUsingSimd() ? "yes" : "no", jobs.getThreadCount());
+
+    std::printf("%-10s %10s %12s %12s %12s %14s\n", "objects", "visible", "scalar ms", "simd ms", "jobs ms", "simd ns/obj");
+    for (uint32_t count : { 10000u, 100000u, pick(1000000u, 200000u) })
+    {
+        std::mt19937 random(count);
+        std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> size(0.1f, 4.0f);
+        CullingBounds bounds;
+        bounds.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float center[3] = { position(random), position(random), position(random) };
+            if (i & 1)
+            {
+                bounds.addSphere(center, size(random));
+            }
+            else
+            {
+                const float extents[3] = { size(random), size(random), size(random) };
+                bounds.addBox(center, extents);
+            }
+        }
+        std::vector<uint32_t> indices(bounds.getPaddedCount());
+
+        culler.setSimdEnabled(false);
+        const Timing scalar = measure(reps, [&] { doNotOptimize(culler.cull(frustum, bounds, indices.data())); });
+        culler.setSimdEnabled(true);
+        const Timing simd = measure(reps, [&] { doNotOptimize(culler.cull(frustum, bounds, indices.data())); });
+        const Timing parallel = measure(reps, [&] { doNotOptimize(culler.cull(jobs, frustum, bounds, indices.data())); });
+
+        std::printf("%-10u %10u %12.3f %12.3f %12.3f %14.2f\n", count, culler.getStats().visibleCount, scalar.minMs, simd.minMs,
+            parallel.minMs, simd.minMs * 1e6 / count);
+    }
+    return 0;
+}
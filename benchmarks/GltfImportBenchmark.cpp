@@ -0,0 +1,155 @@
+#include "BenchmarkHarness.h"
+#include "GltfGeometryImporter.h"
+#include "HeapAllocationCounter.h"
+#include <cstdlib>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    struct ImportResult
+    {
+        Timing timing;
+        uint64_t heapBytes = 0; // Allocated through operator new during one import, staging excluded
+        uint64_t heapAllocations = 0;
+    };
+
+    int addAccessor(tinygltf::Model& model, size_t sizeInBytes, size_t count, int componentType, int type, uint32_t seed)
+    {
+        std::vector<unsigned char>& buffer = model.buffers[0].data;
+        tinygltf::BufferView view;
+        view.buffer = 0;
+        view.byteOffset = buffer.size();
+        view.byteLength = sizeInBytes;
+        buffer.resize(buffer.size() + sizeInBytes);
+        for (size_t i = view.byteOffset; i < buffer.size(); ++i)
+        {
+            buffer[i] = static_cast<unsigned char>(i * 31 + seed);
+        }
+        model.bufferViews.push_back(view);
+
+        tinygltf::Accessor accessor;
+        accessor.bufferView = static_cast<int>(model.bufferViews.size()) - 1;
+        accessor.count = count;
+        accessor.componentType = componentType;
+        accessor.type = type;
+        model.accessors.push_back(accessor);
+        return static_cast<int>(model.accessors.size()) - 1;
+    }
+
+    tinygltf::Model makeModel(uint32_t primitiveCount, uint32_t vertexCount, uint32_t indexCount)
+    {
+        tinygltf::Model model;
+        model.buffers.resize(1);
+        tinygltf::Mesh mesh;
+        for (uint32_t p = 0; p < primitiveCount; ++p)
+        {
+            tinygltf::Primitive primitive;
+            primitive.attributes["POSITION"] = addAccessor(model, vertexCount * 12, vertexCount, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, p);
+            model.accessors.back().minValues = { -1.0, -1.0, -1.0 };
+            model.accessors.back().maxValues = { 1.0, 1.0, 1.0 };
+            primitive.attributes["NORMAL"] = addAccessor(model, vertexCount * 12, vertexCount, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, p);
+            primitive.attributes["TEXCOORD_0"] = addAccessor(model, vertexCount * 8, vertexCount, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC2, p);
+            primitive.indices = addAccessor(model, indexCount * 2, indexCount, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_TYPE_SCALAR, p);
+            mesh.primitives.push_back(primitive);
+        }
+        model.meshes.push_back(mesh);
+        return model;
+    }
+
+    const float* getFloats(const tinygltf::Model& model, const tinygltf::Primitive& primitive, const char* attribute)
+    {
+        const tinygltf::Accessor& accessor = model.accessors[primitive.attributes.at(attribute)];
+        const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+        return reinterpret_cast<const float*>(model.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset);
+    }
+
+    // The import before the importer: a vector per primitive, appended to model-wide vectors, then copied into staging
+    void importThroughVectors(const tinygltf::Model& model, std::vector<unsigned char>& staging)
+    {
+        std::vector<ImportedVertex> totalVertices;
+        std::vector<uint16_t> totalIndices;
+        for (const tinygltf::Primitive& primitive : model.meshes[0].primitives)
+        {
+            const float* positions = getFloats(model, primitive, "POSITION");
+            const float* normals = getFloats(model, primitive, "NORMAL");
+            const float* texCoords = getFloats(model, primitive, "TEXCOORD_0");
+            const size_t vertexCount = model.accessors[primitive.attributes.at("POSITION")].count;
+
+            std::vector<ImportedVertex> vertices(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                std::memcpy(vertices[i].position, positions + i * 3, sizeof(vertices[i].position));
+                std::memcpy(vertices[i].normal, normals + i * 3, sizeof(vertices[i].normal));
+                std::memcpy(vertices[i].texCoord, texCoords + i * 2, sizeof(vertices[i].texCoord));
+            }
+
+            const tinygltf::Accessor& indexAccessor = model.accessors[primitive.indices];
+            const tinygltf::BufferView& indexView = model.bufferViews[indexAccessor.bufferView];
+            const uint16_t* source = reinterpret_cast<const uint16_t*>(model.buffers[0].data.data() + indexView.byteOffset);
+            std::vector<uint16_t> indices(source, source + indexAccessor.count);
+
+            totalVertices.insert(totalVertices.end(), vertices.begin(), vertices.end());
+            totalIndices.insert(totalIndices.end(), indices.begin(), indices.end());
+        }
+
+        const size_t vertexBytes = totalVertices.size() * sizeof(ImportedVertex);
+        std::memcpy(staging.data(), totalVertices.data(), vertexBytes);
+        std::memcpy(staging.data() + vertexBytes, totalIndices.data(), totalIndices.size() * sizeof(uint16_t));
+    }
+
+    void importDirect(const tinygltf::Model& model, std::vector<unsigned char>& staging)
+    {
+        GltfGeometryImporter importer(model);
+        const GltfGeometryLayout& layout = importer.getLayout();
+        importer.decodeVertices(reinterpret_cast<ImportedVertex*>(staging.data()));
+        importer.decodeIndices(reinterpret_cast<uint16_t*>(staging.data() + layout.getVertexBufferSize()));
+    }
+
+    template<typename Import>
+    ImportResult run(const tinygltf::Model& model, std::vector<unsigned char>& staging, uint32_t repetitions, Import&& import)
+    {
+        ImportResult result;
+        const HeapAllocationStats before = getGlobalHeapAllocationStats();
+        import(model, staging);
+        const HeapAllocationStats after = getGlobalHeapAllocationStats();
+        result.heapBytes = after.allocatedBytes - before.allocatedBytes;
+        result.heapAllocations = after.allocationCount - before.allocationCount;
+        result.timing = measure(repetitions, [&] { import(model, staging); });
+        doNotOptimize(staging.data());
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+    const uint32_t primitiveCount = pick(50u, 4u);
+    const uint32_t vertexCount = 20000;
+    const uint32_t indexCount = 60000;
+    const uint32_t repetitions = pick(20u, 2u);
+
+    const tinygltf::Model model = makeModel(primitiveCount, vertexCount, indexCount);
+    const size_t geometryBytes = static_cast<size_t>(primitiveCount) * (vertexCount * sizeof(ImportedVertex) + indexCount * sizeof(uint16_t));
+    // Stands in for the mapped upload memory, allocated once outside the measured imports
+    std::vector<unsigned char> staging(geometryBytes);
+    std::vector<unsigned char> reference(geometryBytes);
+
+    const ImportResult vectors = run(model, reference, repetitions, importThroughVectors);
+    const ImportResult direct = run(model, staging, repetitions, importDirect);
+
+    std::printf("Geometry: %u primitives, %.1f MB\n", primitiveCount, geometryBytes / 1048576.0);
+    std::printf("%-22s %12s %12s %14s %12s\n", "import", "median ms", "min ms", "allocated MB", "allocations");
+    std::printf("%-22s %12.2f %12.2f %14.2f %12llu\n", "vectors then memcpy", vectors.timing.medianMs, vectors.timing.minMs,
+        vectors.heapBytes / 1048576.0, static_cast<unsigned long long>(vectors.heapAllocations));
+    std::printf("%-22s %12.2f %12.2f %14.2f %12llu\n", "decode into staging", direct.timing.medianMs, direct.timing.minMs,
+        direct.heapBytes / 1048576.0, static_cast<unsigned long long>(direct.heapAllocations));
+
+    if (staging != reference)
+    {
+        std::printf("Imports differ\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "BenchmarkHarness.h"
+#include "InstancePacking.h"
+#include "JobSystem.h"
+#include <memory>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    void packScalar(const float* positions, uint32_t count, float scale, InstanceTransform* outTransforms)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float* position = positions + i * 4ull;
+            outTransforms[i] = { { { scale, 0.0f, 0.0f, position[0] }, { 0.0f, scale, 0.0f, position[1] }, { 0.0f, 0.0f, scale, position[2] } } };
+        }
+    }
+
+    // The demos before instancing: object constants (two float4x4) and material constants, each in its own
+    // 256-byte constant buffer slot per object
+    void writeObjectConstants(const float* positions, uint32_t count, std::byte* constants)
+    {
+        const float material[8] = { 1.0f, 1.0f, 1.0f, 1.0f, 0.2f, 0.2f, 0.2f, 0.9f };
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float object[32] = {};
+            object[0] = object[5] = object[10] = object[15] = 1.0f;
+            object[3] = positions[i * 4ull];
+            object[7] = positions[i * 4ull + 1];
+            object[11] = positions[i * 4ull + 2];
+            object[16] = object[21] = object[26] = object[31] = 1.0f;
+            std::memcpy(constants + i * 256ull, object, sizeof(object));
+            std::memcpy(constants + (count + i) * 256ull, material, sizeof(material));
+        }
+    }
+}
+
+// Writing per-instance transforms for up to a million instances: per-object constant buffer slots as the
+// demos wrote them before instancing, a scalar 3x4 loop, the SSE packer with streaming stores into aligned
+// output, its gathering variant over every other instance, and the packer split over the job system.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const uint32_t count = pick(1000000u, 50000u);
+    const int reps = pick(7, 1);
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+    std::vector<float> positions(count * 4ull);
+    for (float& value : positions)
+    {
+        value = distribution(random);
+    }
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        indices.push_back(i);
+    }
+
+    // 64-byte aligned output, as a mapped upload heap is
+    std::unique_ptr<InstanceTransform[]> transforms(new InstanceTransform[count + 4]);
+    InstanceTransform* output = reinterpret_cast<InstanceTransform*>((reinterpret_cast<uintptr_t>(transforms.get()) + 63) & ~uintptr_t(63));
+    std::vector<std::byte> constants(count * 512ull);
+    JobSystem jobs(3);
+
+    const Timing objectConstants = measure(reps, [&] { writeObjectConstants(positions.data(), count, constants.data()); doNotOptimize(constants.data()); });
+    const Timing scalar = measure(reps, [&] { packScalar(positions.data(), count, 1.5f, output); doNotOptimize(output); });
+    const Timing packed = measure(reps, [&] { packInstanceTranslations(positions.data(), count, 1.5f, output); doNotOptimize(output); });
+    const Timing gathered = measure(reps, [&]
+    {
+        packInstanceTranslations(positions.data(), indices.data(), static_cast<uint32_t>(indices.size()), 1.5f, output);
+        doNotOptimize(output);
+    });
+    const Timing parallel = measure(reps, [&] { packInstanceTranslations(jobs, positions.data(), count, 1.5f, output); doNotOptimize(output); });
+
+    const double transformMb = count * double(sizeof(InstanceTransform)) / (1 << 20);
+    std::printf("%u instances\n", count);
+    std::printf("%-28s %10s %10s %10s\n", "path", "ms", "MB", "ns/inst");
+    auto printRow = [&](const char* name, const Timing& timing, double megabytes, uint32_t instances)
+    {
+        std::printf("%-28s %10.2f %10.1f %10.2f\n", name, timing.minMs, megabytes, timing.minMs * 1e6 / instances);
+    };
+    printRow("per-object constants", objectConstants, constants.size() / double(1 << 20), count);
+    printRow("scalar 3x4", scalar, transformMb, count);
+    printRow("packed", packed, transformMb, count);
+    printRow("packed, gathered 1 in 2", gathered, transformMb / 2, static_cast<uint32_t>(indices.size()));
+    char name[32];
+    std::snprintf(name, sizeof(name), "packed, %u threads", jobs.getThreadCount());
+    printRow(name, parallel, transformMb, count);
+    return 0;
+}
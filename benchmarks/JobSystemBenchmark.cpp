@@ -0,0 +1,66 @@
+#include "BenchmarkHarness.h"
+#include "JobSystem.h"
+#include <cmath>
+#include <memory>
+#include <thread>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    void transform(float* values, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            values[i] = std::sqrt(values[i] * 1.0001f + 0.5f);
+        }
+    }
+}
+
+// Cost of an empty job through run + wait, and parallelFor over a float transform against a serial loop,
+// on 1 + workers threads. Scaling past the hardware thread count only shows the cost of oversubscription.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    const uint32_t jobCount = pick(100000u, 5000u);
+    const uint32_t valueCount = pick(1u << 22, 1u << 16);
+    const int reps = pick(5, 1);
+    std::vector<float> values(valueCount, 1.0f);
+
+    const Timing serial = measure(reps, [&]
+    {
+        transform(values.data(), 0, valueCount);
+        doNotOptimize(values.data());
+    });
+
+    std::printf("%-10s %14s %16s %10s %12s\n", "threads", "ns/empty job", "parallelFor ms", "speedup", "stolen");
+    std::printf("%-10s %14s %16.2f %10s %12s\n", "serial", "-", serial.medianMs, "1.00", "-");
+    for (uint32_t threadCount : { 2u, 4u, 8u })
+    {
+        JobSystem jobs(threadCount - 1);
+
+        const Timing empty = measure(reps, [&]
+        {
+            JobCounter counter;
+            for (uint32_t i = 0; i < jobCount; ++i)
+            {
+                jobs.run([] {}, &counter);
+            }
+            jobs.wait(counter);
+        });
+
+        const Timing parallel = measure(reps, [&]
+        {
+            float* data = values.data();
+            jobs.parallelFor(valueCount, 4096, [data](uint32_t begin, uint32_t end) { transform(data, begin, end); });
+            doNotOptimize(data);
+        });
+
+        std::printf("%-10u %14.1f %16.2f %10.2f %12llu\n", threadCount, empty.medianMs * 1e6 / jobCount,
+            parallel.medianMs, serial.medianMs / parallel.medianMs, static_cast<unsigned long long>(jobs.getStats().stolenCount));
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "BenchmarkHarness.h"
+#include "CameraMath.h"
+#include "JobSystem.h"
+#include "LevelOfDetail.h"
+#include <cmath>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    void fillSelector(LodSelector& selector, uint32_t count)
+    {
+        LodTable fourLevels;
+        fourLevels.levelCount = 4;
+        fourLevels.geometricError[1] = 0.01f;
+        fourLevels.geometricError[2] = 0.04f;
+        fourLevels.geometricError[3] = 0.2f;
+        LodTable threeLevels;
+        threeLevels.levelCount = 3;
+        threeLevels.geometricError[1] = 0.05f;
+        threeLevels.geometricError[2] = 0.05f;
+        selector.addTable(fourLevels);
+        selector.addTable(threeLevels);
+        selector.addTable(LodTable());
+
+        std::mt19937 random(11);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> radius(0.1f, 3.0f);
+        selector.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float center[3] = { position(random), position(random) * 0.1f, position(random) };
+            const uint32_t table = random() % 10 < 6 ? 0 : (random() % 4 != 0 ? 1 : 2);
+            selector.addInstance(table, center, radius(random));
+        }
+    }
+
+    LodView makeView(int frame)
+    {
+        const test::Matrix4 projection = test::perspectiveFovLH(0.785398f, 16.0f / 9.0f, 1.0f, 1000.0f);
+        const float t = frame * 0.02f;
+        const float eye[3] = { 400.0f * std::cos(t), 5.0f + 20.0f * std::sin(t * 3.0f), 400.0f * std::sin(t * 0.7f) };
+        return makeLodView(eye, projection.m, 720.0f);
+    }
+}
+
+// LOD selection for 1M instances spread over a 1000 unit square, the camera sweeping around them at 60 Hz,
+// with the scalar loop and AVX2, serially and over the job system. Each frame's time is one sample.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    JobSystem jobs(3);
+    const uint32_t count = pick(1000000u, 100000u);
+    const int frames = pick(60, 5);
+    std::printf("job system threads: %u, instances: %u\n", jobs.getThreadCount(), count);
+
+    std::printf("%-8s %-8s %10s %10s %10s %10s\n", "mode", "threads", "median ms", "min ms", "ns/inst", "switches");
+    for (bool useJobs : { false, true })
+    {
+        for (bool useSimd : { false, true })
+        {
+            LodSelector selector;
+            fillSelector(selector, count);
+            selector.setSimdEnabled(useSimd);
+            if (useSimd && !selector.isUsingSimd())
+            {
+                continue;
+            }
+            selector.select(makeView(0), 0.016f);
+
+            int frame = 1;
+            const Timing timing = measure(frames, [&]
+            {
+                if (useJobs)
+                {
+                    selector.select(jobs, makeView(frame++), 0.016f);
+                }
+                else
+                {
+                    selector.select(makeView(frame++), 0.016f);
+                }
+            });
+            std::printf("%-8s %-8s %10.3f %10.3f %10.2f %10u\n", useSimd ? "avx2" : "scalar", useJobs ? "jobs" : "serial", timing.medianMs,
+                timing.minMs, timing.minMs * 1e6 / count, selector.getStats().switchCount);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include "BenchmarkHarness.h"
+#include "CameraMath.h"
+#include "JobSystem.h"
+#include "OcclusionCulling.h"
+#include <cmath>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    struct Box
+    {
+        float min[3];
+        float max[3];
+    };
+
+    struct Camera
+    {
+        float eye[3];
+        float target[3];
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsedMs(Clock::time_point begin, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+
+    // Grid of buildings with streets in between
+    std::vector<Box> makeCity(int blocks, float spacing, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> height(2.0f, 14.0f);
+        std::uniform_real_distribution<float> halfWidth(1.5f, 3.5f);
+        std::vector<Box> boxes;
+        for (int i = 0; i < blocks; ++i)
+        {
+            for (int j = 0; j < blocks; ++j)
+            {
+                const float x = (i - blocks / 2) * spacing;
+                const float z = (j - blocks / 2) * spacing;
+                const float halfX = halfWidth(random);
+                const float halfZ = halfWidth(random);
+                boxes.push_back({ { x - halfX, 0.0f, z - halfZ }, { x + halfX, height(random), z + halfZ } });
+            }
+        }
+        return boxes;
+    }
+
+    // Small boxes at least 10 apart, like the box renderer's Poisson field
+    std::vector<Box> makeField(uint32_t count, float spread, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> position(-spread, spread);
+        std::vector<Box> boxes;
+        while (boxes.size() < count)
+        {
+            const float x = position(random);
+            const float y = position(random);
+            const float z = position(random);
+            const bool isFree = std::none_of(boxes.begin(), boxes.end(), [&](const Box& box)
+            {
+                const float dx = box.min[0] - x;
+                const float dy = box.min[1] - y;
+                const float dz = box.min[2] - z;
+                return dx * dx + dy * dy + dz * dz < 100.0f;
+            });
+            if (isFree)
+            {
+                boxes.push_back({ { x - 0.56f, y, z - 0.25f }, { x + 0.56f, y + 1.22f, z + 0.25f } });
+            }
+        }
+        return boxes;
+    }
+
+    std::vector<Camera> makeStreetPath(uint32_t frames)
+    {
+        std::vector<Camera> cameras;
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            const float t = static_cast<float>(i) / frames;
+            const float z = -150.0f + 300.0f * t;
+            const float yaw = std::sin(t * 6.283f) * 0.6f;
+            cameras.push_back({ { 4.0f, 1.8f, z }, { 4.0f + std::sin(yaw) * 10.0f, 1.8f, z + std::cos(yaw) * 10.0f } });
+        }
+        return cameras;
+    }
+
+    std::vector<Camera> makeOrbitPath(uint32_t frames)
+    {
+        std::vector<Camera> cameras;
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            const float angle = 6.283f * i / frames;
+            cameras.push_back({ { std::cos(angle) * 120.0f, 8.0f, std::sin(angle) * 120.0f }, { 0.0f, 4.0f, 0.0f } });
+        }
+        return cameras;
+    }
+
+    std::vector<Camera> makeFieldPath(uint32_t frames)
+    {
+        std::vector<Camera> cameras;
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            const float angle = 6.283f * i / frames;
+            cameras.push_back({ { std::cos(angle) * 20.0f, 0.0f, -20.0f + std::sin(angle) * 20.0f }, { 0.0f, 0.0f, 0.0f } });
+        }
+        return cameras;
+    }
+
+    // Frustum culls, picks the nearest visible objects as occluders, then occlusion culls the rest, every frame
+    void runPath(const char* name, const std::vector<Box>& boxes, const std::vector<Camera>& cameras, JobSystem& jobs,
+        uint32_t maxOccluders, bool useSimd, bool useJobs)
+    {
+        CullingBounds bounds;
+        bounds.reserve(static_cast<uint32_t>(boxes.size()));
+        for (const Box& box : boxes)
+        {
+            const float center[3] = { (box.min[0] + box.max[0]) * 0.5f, (box.min[1] + box.max[1]) * 0.5f, (box.min[2] + box.max[2]) * 0.5f };
+            const float extents[3] = { (box.max[0] - box.min[0]) * 0.5f, (box.max[1] - box.min[1]) * 0.5f, (box.max[2] - box.min[2]) * 0.5f };
+            bounds.addBox(center, extents);
+        }
+        FrustumCuller frustumCuller;
+        OcclusionCuller occlusionCuller;
+        occlusionCuller.setSimdEnabled(useSimd);
+        std::vector<uint32_t> visible(bounds.getPaddedCount());
+        std::vector<uint32_t> order;
+        double frustumMs = 0.0;
+        double setupMs = 0.0;
+        double rasterMs = 0.0;
+        double testMs = 0.0;
+        uint64_t frustumVisible = 0;
+        uint64_t occlusionVisible = 0;
+        uint64_t triangles = 0;
+        for (const Camera& camera : cameras)
+        {
+            const test::Matrix4 viewProjection = test::makeViewProjection(camera.eye, camera.target, 1.0f);
+            const Clock::time_point start = Clock::now();
+            const uint32_t count = frustumCuller.cull(extractFrustum(viewProjection.m), bounds, visible.data());
+            const Clock::time_point culled = Clock::now();
+
+            auto distance = [&](uint32_t index)
+            {
+                const Box& box = boxes[index];
+                float squared = 0.0f;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float delta = (box.min[axis] + box.max[axis]) * 0.5f - camera.eye[axis];
+                    squared += delta * delta;
+                }
+                return squared;
+            };
+            order.assign(visible.begin(), visible.begin() + count);
+            const uint32_t occluderCount = std::min(maxOccluders, count);
+            std::partial_sort(order.begin(), order.begin() + occluderCount, order.end(),
+                [&](uint32_t a, uint32_t b) { return distance(a) < distance(b); });
+            occlusionCuller.beginFrame(viewProjection.m);
+            for (uint32_t i = 0; i < occluderCount; ++i)
+            {
+                occlusionCuller.addOccluderBox(boxes[order[i]].min, boxes[order[i]].max);
+            }
+            const Clock::time_point setUp = Clock::now();
+
+            if (useJobs)
+            {
+                occlusionCuller.rasterizeOccluders(jobs);
+            }
+            else
+            {
+                occlusionCuller.rasterizeOccluders();
+            }
+            const Clock::time_point rasterized = Clock::now();
+            const uint32_t kept = useJobs ? occlusionCuller.cullOccluded(jobs, bounds, visible.data(), count, visible.data())
+                                          : occlusionCuller.cullOccluded(bounds, visible.data(), count, visible.data());
+            const Clock::time_point tested = Clock::now();
+
+            frustumMs += elapsedMs(start, culled);
+            setupMs += elapsedMs(culled, setUp);
+            rasterMs += elapsedMs(setUp, rasterized);
+            testMs += elapsedMs(rasterized, tested);
+            frustumVisible += count;
+            occlusionVisible += kept;
+            triangles += occlusionCuller.getStats().rasterizedTriangleCount;
+        }
+
+        const double frames = static_cast<double>(cameras.size());
+        std::printf("%-7s %-7s %-7s %9u %9.1f %9.1f %9.1f %9.3f %9.3f %9.3f %9.3f %9.3f %7.0f\n", name, useSimd ? "avx2" : "scalar",
+            useJobs ? "jobs" : "serial", maxOccluders, frustumVisible / frames, occlusionVisible / frames,
+            100.0 * (frustumVisible - occlusionVisible) / std::max<uint64_t>(1, frustumVisible), frustumMs / frames, setupMs / frames,
+            rasterMs / frames, testMs / frames, (frustumMs + setupMs + rasterMs + testMs) / frames, triangles / frames);
+    }
+}
+
+// Occlusion culling along camera paths at 320x180: down the streets and around a 3600 building city, and through
+// a field of 1000 small boxes. Per frame averages of what the frustum keeps, what occlusion keeps of that, and
+// the time spent culling, choosing occluders, rasterizing and testing.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    JobSystem jobs(3);
+    std::mt19937 random(11);
+    const std::vector<Box> city = makeCity(60, 10.0f, random);
+    const std::vector<Box> field = makeField(1000, 100.0f, random);
+    const uint32_t frames = pick(240u, 30u);
+    const std::vector<Camera> street = makeStreetPath(frames);
+    const std::vector<Camera> orbit = makeOrbitPath(frames);
+    const std::vector<Camera> fieldPath = makeFieldPath(frames);
+    std::printf("job system threads: %u, frames per path: %u\n", jobs.getThreadCount(), frames);
+
+    std::printf("%-7s %-7s %-7s %9s %9s %9s %9s %9s %9s %9s %9s %9s %7s\n", "path", "mode", "threads", "occluders", "frustum",
+        "kept", "reject %", "cull ms", "setup ms", "raster ms", "test ms", "total ms", "tris");
+    for (uint32_t occluders : { 16u, 64u })
+    {
+        for (bool useSimd : { false, true })
+        {
+            for (bool useJobs : { false, true })
+            {
+                runPath("street", city, street, jobs, occluders, useSimd, useJobs);
+            }
+        }
+    }
+    for (bool useSimd : { false, true })
+    {
+        runPath("orbit", city, orbit, jobs, 64, useSimd, false);
+    }
+    for (bool useSimd : { false, true })
+    {
+        runPath("field", field, fieldPath, jobs, 16, useSimd, false);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "BenchmarkHarness.h"
+#include "FencedObjectPool.h"
+#include "JobSystem.h"
+#include "NullCommandList.h"
+#include "RecordPartition.h"
+#include <memory>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    constexpr uint32_t MaterialCount = 16;
+
+    struct Scene
+    {
+        std::vector<std::unique_ptr<NullPipeline>> pipelines;
+        std::unique_ptr<NullRootSignature> rootSignature;
+        std::unique_ptr<NullDescriptorHeap> heap;
+        std::unique_ptr<NullResource> vertices;
+        std::unique_ptr<NullResource> indices;
+    };
+
+    // The per-draw work of the demos' base pass: sorted by material, a constant buffer and a texture table per draw
+    void recordRange(const Scene& scene, NullCommandList& list, RecordRange range, uint32_t drawCount)
+    {
+        list.setGraphicsRootSignature(scene.rootSignature.get());
+        list.setDescriptorHeaps(scene.heap.get());
+        list.setVertexBuffer(0, scene.vertices.get(), 1 << 24, 32);
+        list.setIndexBuffer(scene.indices.get(), 1 << 24, 2);
+        for (uint32_t draw = range.begin; draw < range.end; ++draw)
+        {
+            list.setPipeline(scene.pipelines[draw * MaterialCount / drawCount].get());
+            list.setConstantBufferView(0, 0x100000 + draw * 256ull);
+            list.setGraphicsRootDescriptorTable(1, scene.heap->getGpuHandle(draw % 64));
+            list.drawIndexedInstanced(36 + draw % 7 * 3, 1, draw * 36, 0, 0);
+        }
+        list.end();
+    }
+}
+
+// Recording one pass into 1 to 2 x threads command lists, each slot recycling its lists through a
+// FencedObjectPool, submitted with one execute on the null backend. Records the same calls the D3D12
+// backend would filter and issue, so it measures the CPU side of recording and its scaling.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    NullDeviceDesc desc;
+    desc.fenceLatency = 2;
+    NullDevice device(desc);
+
+    Scene scene;
+    for (uint32_t i = 0; i < MaterialCount; ++i)
+    {
+        scene.pipelines.push_back(device.createPipeline("Material"));
+    }
+    scene.rootSignature = device.createRootSignature("Root signature");
+    scene.heap = device.createDescriptorHeap({ "Textures", 64, true });
+    scene.vertices = device.createResource({ "Vertices", 1 << 24, MemoryCategory::Geometry, ResourceState::Common });
+    scene.indices = device.createResource({ "Indices", 1 << 24, MemoryCategory::Geometry, ResourceState::Common });
+
+    const uint32_t frameCount = pick(50u, 3u);
+    std::printf("%-10s %-10s %-8s %12s %12s\n", "draws", "threads", "lists", "ms/frame", "ns/draw");
+    for (uint32_t drawCount : { 10000u, 100000u })
+    {
+        for (uint32_t threadCount : { 1u, 2u, 4u, 8u })
+        {
+            // One thread records serially, a JobSystem always has at least one worker
+            std::unique_ptr<JobSystem> jobs = threadCount > 1 ? std::make_unique<JobSystem>(threadCount - 1) : nullptr;
+            const uint32_t maxLists = threadCount == 1 ? 1 : threadCount * 2;
+            std::vector<FencedObjectPool<std::unique_ptr<NullCommandList>>> pools(maxLists);
+            std::vector<std::unique_ptr<NullCommandList>> lists(maxLists);
+            std::vector<NullCommandList*> submitLists(maxLists);
+            std::vector<RecordRange> ranges(maxLists);
+
+            struct RecordContext
+            {
+                const Scene* scene;
+                std::vector<std::unique_ptr<NullCommandList>>* lists;
+                RecordRange* ranges;
+                uint32_t drawCount;
+            } context{ &scene, &lists, ranges.data(), drawCount };
+
+            const Timing timing = measure(frameCount, [&]
+            {
+                const uint32_t listCount = partitionRecording(nullptr, drawCount, maxLists, 256, ranges.data());
+                const uint64_t completed = device.getCompletedFenceValue();
+                for (uint32_t i = 0; i < listCount; ++i)
+                {
+                    lists[i] = pools[i].acquire(completed, [&] { return device.createCommandList("Parallel list"); });
+                    lists[i]->begin();
+                    submitLists[i] = lists[i].get();
+                }
+
+                if (jobs)
+                {
+                    JobCounter counter;
+                    for (uint32_t i = 0; i < listCount; ++i)
+                    {
+                        jobs->run([&context, i]
+                        {
+                            recordRange(*context.scene, *(*context.lists)[i], context.ranges[i], context.drawCount);
+                        }, &counter);
+                    }
+                    jobs->wait(counter);
+                }
+                else
+                {
+                    recordRange(scene, *lists[0], ranges[0], drawCount);
+                }
+
+                device.executeCommandLists(submitLists.data(), listCount);
+                const uint64_t fence = device.getNextFenceValue();
+                device.signalFence(fence);
+                for (uint32_t i = 0; i < listCount; ++i)
+                {
+                    pools[i].release(std::move(lists[i]), fence);
+                }
+            });
+
+            std::printf("%-10u %-10u %-8u %12.3f %12.1f\n", drawCount, threadCount, maxLists, timing.medianMs,
+                timing.medianMs * 1e6 / drawCount);
+        }
+    }
+    std::printf("Hardware threads: %u\n", std::thread::hardware_concurrency());
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "BenchmarkHarness.h"
+#include "RenderGraph.h"
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    // Random passes reading one to three earlier outputs and writing one or two resources, the back
+    // buffer now and then, about one pass in fifty never culled
+    void buildRandomGraph(RenderGraph& graph, uint32_t passCount)
+    {
+        const ResourceState writeStates[] = { ResourceState::RenderTarget, ResourceState::UnorderedAccess, ResourceState::DepthWrite, ResourceState::CopyDest };
+        const ResourceState readStates[] = { ResourceState::PixelShaderResource, ResourceState::NonPixelShaderResource, ResourceState::CopySource, ResourceState::DepthRead };
+
+        std::mt19937 random(passCount);
+        const uint32_t resourceCount = passCount / 2 + 4;
+        graph.importResource("Back buffer", ResourceState::Present, ResourceState::Present);
+        for (uint32_t i = 1; i < resourceCount; ++i)
+        {
+            graph.createResource("Transient");
+        }
+
+        std::vector<bool> written(resourceCount, false);
+        written[0] = true;
+        for (uint32_t i = 0; i < passCount; ++i)
+        {
+            const uint32_t pass = graph.addPass("Pass", random() % 50 == 0 ? RenderGraphPassFlags::NeverCull : RenderGraphPassFlags::None);
+            const uint32_t readCount = random() % 4;
+            uint32_t used[6] = {};
+            uint32_t usedCount = 0;
+            auto isUsed = [&](uint32_t resource) { return std::find(used, used + usedCount, resource) != used + usedCount; };
+            for (uint32_t k = 0; k < readCount; ++k)
+            {
+                const uint32_t resource = random() % resourceCount;
+                if (written[resource] && !isUsed(resource))
+                {
+                    used[usedCount++] = resource;
+                    graph.read(pass, resource, readStates[random() % 4]);
+                }
+            }
+            const uint32_t writeCount = 1 + random() % 2;
+            for (uint32_t k = 0; k < writeCount; ++k)
+            {
+                const uint32_t resource = random() % 20 == 0 ? 0 : random() % resourceCount;
+                if (!isUsed(resource))
+                {
+                    used[usedCount++] = resource;
+                    graph.write(pass, resource, writeStates[random() % 4]);
+                    written[resource] = true;
+                }
+            }
+        }
+    }
+}
+
+// Compile time of random frame graphs from tens to a thousand passes: dependency edges, culling, levels
+// and barriers. Recompiling an unchanged graph is what a frame pays when it rebuilds the same graph.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const int reps = pick(200, 5);
+    std::printf("%-8s %-10s %8s %8s %8s %10s %12s\n", "passes", "resources", "culled", "levels", "edges", "barriers", "compile us");
+    for (uint32_t passCount : { 30u, 100u, 300u, 1000u })
+    {
+        RenderGraph graph;
+        buildRandomGraph(graph, passCount);
+        const Timing timing = measure(reps, [&] { graph.compile(); });
+
+        const RenderGraphStats& stats = graph.getStats();
+        std::printf("%-8u %-10u %8u %8u %8u %10u %12.1f\n", passCount, graph.getResourceCount(), stats.culledPassCount,
+            stats.levelCount, stats.edgeCount, stats.barrierCount, timing.medianMs * 1000.0);
+    }
+    return 0;
+}
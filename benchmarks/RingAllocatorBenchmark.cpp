@@ -0,0 +1,63 @@
+#include "BenchmarkHarness.h"
+#include "RingAllocator.h"
+#include <cstdlib>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+// Per-frame constant data: a few thousand 256-byte aligned blocks per frame, three frames in flight.
+// The ring is compared against malloc/free of the same blocks, which is what a per-draw upload buffer costs at best.
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const uint32_t frameCount = pick(2000u, 20u);
+    const uint32_t framesInFlight = 3;
+    std::printf("%-12s %-10s %14s %14s\n", "allocator", "blocks", "ns/allocation", "peak KB");
+
+    for (uint32_t blocksPerFrame : { 256u, 1024u, 4096u })
+    {
+        const uint64_t blockSize = 256;
+        RingAllocator ring(blockSize * blocksPerFrame * (framesInFlight + 1));
+        uint64_t fence = 0;
+        uint64_t checksum = 0;
+        const Timing ringTiming = measure(5, [&]
+        {
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                ring.releaseCompleted(fence >= framesInFlight ? fence - framesInFlight : 0);
+                for (uint32_t block = 0; block < blocksPerFrame; ++block)
+                {
+                    // Constant buffers come in varying sizes, aligned to 256 bytes
+                    checksum += ring.allocate(64 + (block & 3) * 48, 256);
+                }
+                ring.finishFrame(++fence);
+            }
+        });
+        doNotOptimize(checksum);
+
+        std::vector<void*> blocks(static_cast<size_t>(blocksPerFrame) * framesInFlight, nullptr);
+        const Timing mallocTiming = measure(5, [&]
+        {
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                void** frameBlocks = blocks.data() + static_cast<size_t>(frame % framesInFlight) * blocksPerFrame;
+                for (uint32_t block = 0; block < blocksPerFrame; ++block)
+                {
+                    std::free(frameBlocks[block]);
+                    frameBlocks[block] = std::malloc(64 + (block & 3) * 48);
+                }
+            }
+        });
+        for (void* block : blocks)
+        {
+            std::free(block);
+        }
+
+        const double allocations = static_cast<double>(frameCount) * blocksPerFrame;
+        std::printf("%-12s %-10u %14.2f %14.1f\n", "ring", blocksPerFrame, ringTiming.medianMs * 1e6 / allocations,
+            ring.getPeakUsedSize() / 1024.0);
+        std::printf("%-12s %-10u %14.2f %14s\n", "malloc/free", blocksPerFrame, mallocTiming.medianMs * 1e6 / allocations, "-");
+    }
+    return 0;
+}
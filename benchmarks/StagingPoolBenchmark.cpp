@@ -0,0 +1,157 @@
+#include "BenchmarkHarness.h"
+#include "StagingPool.h"
+#include <deque>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    constexpr uint64_t MB = 1024 * 1024;
+
+    struct TraceResult
+    {
+        uint64_t streamedBytes = 0;
+        uint64_t peakBytes = 0;
+        uint64_t allocationCount = 0; // Upload buffers created
+        uint64_t stallCount = 0;
+        double nsPerAcquire = 0.0;
+    };
+
+    // Asset sizes of a streaming level: mostly small buffers and mips, some whole textures and a few
+    // large meshes. Every batch of uploads is submitted and the GPU retires it framesInFlight batches later.
+    std::vector<uint64_t> makeStreamingTrace(uint32_t uploadCount)
+    {
+        std::mt19937 random(32);
+        std::vector<uint64_t> sizes(uploadCount);
+        for (uint64_t& size : sizes)
+        {
+            const uint32_t kind = random() % 100;
+            size = kind < 70 ? 1 + random() % (256 * 1024)
+                : kind < 98 ? MB + random() % (6 * MB)
+                : 16 * MB + random() % (16 * MB);
+        }
+        return sizes;
+    }
+
+    constexpr uint32_t UploadsPerBatch = 16;
+    constexpr uint64_t FramesInFlight = 3;
+
+    TraceResult replayPooled(const std::vector<uint64_t>& trace, uint64_t highWaterMark)
+    {
+        StagingPoolDesc desc;
+        desc.highWaterMark = highWaterMark;
+        StagingPool pool(desc);
+        std::vector<uint32_t> batch;
+        std::vector<uint32_t> evicted;
+        uint64_t fence = 0;
+        TraceResult result;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t size : trace)
+        {
+            StagingPool::Allocation allocation = pool.acquire(size);
+            while (!allocation.isValid())
+            {
+                if (!pool.hasPendingChunks())
+                {
+                    ++fence;
+                    for (uint32_t chunk : batch)
+                    {
+                        pool.release(chunk, fence);
+                    }
+                    batch.clear();
+                }
+                pool.releaseCompleted(pool.getOldestPendingFence());
+                allocation = pool.acquire(size);
+            }
+            batch.push_back(allocation.chunk);
+            result.streamedBytes += size;
+
+            if (batch.size() == UploadsPerBatch)
+            {
+                ++fence;
+                for (uint32_t chunk : batch)
+                {
+                    pool.release(chunk, fence);
+                }
+                batch.clear();
+                if (fence > FramesInFlight)
+                {
+                    pool.releaseCompleted(fence - FramesInFlight);
+                }
+            }
+            pool.takeEvictedChunks(evicted);
+            evicted.clear();
+        }
+        result.nsPerAcquire = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / trace.size();
+
+        const StagingPoolStats stats = pool.getStats();
+        result.peakBytes = stats.peakLiveBytes;
+        result.allocationCount = stats.createdCount;
+        result.stallCount = stats.stallCount;
+        return result;
+    }
+
+    // Before the pool: one upload buffer per resource, destroyed once its batch retires
+    TraceResult replayPerResource(const std::vector<uint64_t>& trace)
+    {
+        TraceResult result;
+        std::deque<uint64_t> batchBytes;
+        uint64_t liveBytes = 0;
+        uint64_t currentBatch = 0;
+        uint32_t uploadsInBatch = 0;
+        for (uint64_t size : trace)
+        {
+            const uint64_t committed = (size + 65535) / 65536 * 65536;
+            liveBytes += committed;
+            currentBatch += committed;
+            result.streamedBytes += size;
+            result.allocationCount++;
+            result.peakBytes = std::max(result.peakBytes, liveBytes);
+
+            if (++uploadsInBatch == UploadsPerBatch)
+            {
+                batchBytes.push_back(currentBatch);
+                currentBatch = 0;
+                uploadsInBatch = 0;
+                if (batchBytes.size() > FramesInFlight)
+                {
+                    liveBytes -= batchBytes.front();
+                    batchBytes.pop_front();
+                }
+            }
+        }
+        return result;
+    }
+
+    void print(const char* name, const TraceResult& result)
+    {
+        std::printf("%-22s %12.2f %12.1f %12llu %8llu ", name, result.streamedBytes / 1073741824.0, result.peakBytes / double(MB),
+            static_cast<unsigned long long>(result.allocationCount), static_cast<unsigned long long>(result.stallCount));
+        if (result.nsPerAcquire > 0.0)
+        {
+            std::printf("%12.1f\n", result.nsPerAcquire);
+        }
+        else
+        {
+            std::printf("%12s\n", "-");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const std::vector<uint64_t> trace = makeStreamingTrace(pick(200000u, 2000u));
+    std::printf("Streaming trace: %zu uploads, %u per batch, retired %llu batches later\n", trace.size(), UploadsPerBatch,
+        static_cast<unsigned long long>(FramesInFlight));
+    std::printf("%-22s %12s %12s %12s %8s %12s\n", "policy", "streamed GB", "peak MB", "buffers", "stalls", "ns/acquire");
+    print("per-resource buffers", replayPerResource(trace));
+    print("pool, 256 MB budget", replayPooled(trace, 256 * MB));
+    print("pool, 128 MB budget", replayPooled(trace, 128 * MB));
+    print("pool, 64 MB budget", replayPooled(trace, 64 * MB));
+    return 0;
+}
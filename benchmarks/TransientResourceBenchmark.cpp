@@ -0,0 +1,84 @@
+#include "BenchmarkHarness.h"
+#include "TransientResourcePlanner.h"
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    constexpr uint64_t TargetAlignment = 64 * 1024;
+
+    uint64_t targetSize(uint32_t width, uint32_t height, uint64_t bytesPerPixel, uint64_t scale = 1)
+    {
+        const uint64_t size = static_cast<uint64_t>(width) * height * bytesPerPixel / scale;
+        return (size + TargetAlignment - 1) / TargetAlignment * TargetAlignment;
+    }
+
+    // GBufferDemo as it is built: every target lives in the base pass only
+    void addBasePassTargets(TransientResourcePlanner& planner, uint32_t width, uint32_t height)
+    {
+        planner.addResource({ "GBuffer albedo", targetSize(width, height, 4), TargetAlignment, 0, 0 });
+        planner.addResource({ "GBuffer normal", targetSize(width, height, 8), TargetAlignment, 0, 0 });
+        planner.addResource({ "GBuffer depth", targetSize(width, height, 4), TargetAlignment, 0, 0 });
+        planner.addResource({ "Depth buffer", targetSize(width, height, 4), TargetAlignment, 0, 0 });
+    }
+
+    // The same G-buffer read by the deferred passes a full pipeline adds:
+    // 0 G-buffer, 1 SSAO, 2 SSAO blur, 3 lighting, 4 bloom down, 5 bloom up, 6 tonemap
+    void addDeferredPipelineTargets(TransientResourcePlanner& planner, uint32_t width, uint32_t height)
+    {
+        planner.addResource({ "Depth buffer", targetSize(width, height, 4), TargetAlignment, 0, 3 });
+        planner.addResource({ "GBuffer albedo", targetSize(width, height, 4), TargetAlignment, 0, 3 });
+        planner.addResource({ "GBuffer normal", targetSize(width, height, 8), TargetAlignment, 0, 3 });
+        planner.addResource({ "GBuffer depth", targetSize(width, height, 4), TargetAlignment, 0, 3 });
+        planner.addResource({ "SSAO", targetSize(width, height, 1), TargetAlignment, 1, 2 });
+        planner.addResource({ "SSAO blurred", targetSize(width, height, 1), TargetAlignment, 2, 3 });
+        planner.addResource({ "HDR lighting", targetSize(width, height, 8), TargetAlignment, 3, 6 });
+        planner.addResource({ "Bloom half", targetSize(width, height, 8, 4), TargetAlignment, 4, 5 });
+        planner.addResource({ "Bloom quarter", targetSize(width, height, 8, 16), TargetAlignment, 4, 5 });
+        planner.addResource({ "Bloom result", targetSize(width, height, 8, 4), TargetAlignment, 5, 6 });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+
+    const std::pair<uint32_t, uint32_t> resolutions[] = { { 1920, 1080 }, { 3840, 2160 } };
+    for (const auto& [width, height] : resolutions)
+    {
+        TransientResourcePlanner basePass;
+        addBasePassTargets(basePass, width, height);
+        basePass.compile();
+        std::printf("G-buffer base pass at %ux%u\n%s\n", width, height, basePass.buildReport().c_str());
+
+        TransientResourcePlanner deferred;
+        addDeferredPipelineTargets(deferred, width, height);
+        deferred.compile();
+        std::printf("Deferred pipeline at %ux%u\n%s\n", width, height, deferred.buildReport().c_str());
+    }
+
+    // Planning cost for render graphs far larger than the demos'
+    std::printf("%-12s %12s %12s %12s\n", "resources", "compile us", "regions", "saved %");
+    for (uint32_t resourceCount : { 16u, 64u, 256u, 1024u })
+    {
+        std::mt19937 random(resourceCount);
+        TransientResourcePlanner planner;
+        const uint32_t passCount = resourceCount / 2 + 4;
+        for (uint32_t i = 0; i < resourceCount; ++i)
+        {
+            TransientResourceDesc desc;
+            desc.size = TargetAlignment * (1 + random() % 128);
+            desc.alignment = TargetAlignment;
+            desc.firstPass = random() % passCount;
+            desc.lastPass = desc.firstPass + random() % 8;
+            planner.addResource(desc);
+        }
+
+        const Timing timing = measure(pick(20u, 2u), [&] { planner.compile(); });
+        std::printf("%-12u %12.1f %12zu %12.1f\n", resourceCount, timing.medianMs * 1e3, planner.getRegions().size(),
+            100.0 * planner.getSavedBytes() / planner.getUnaliasedSize());
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include "BenchmarkHarness.h"
+#include "StagingPool.h"
+#include "UploadPacker.h"
+#include <memory>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::bench;
+
+namespace
+{
+    struct Upload
+    {
+        uint64_t bufferSize = 0;    // Buffers
+        uint32_t rowSizeInBytes = 0; // Texture subresources
+        uint32_t numRows = 0;
+    };
+
+    struct BatchStats
+    {
+        uint64_t submitCount = 0;
+        uint64_t chunkCount = 0;
+        uint64_t payloadBytes = 0;
+        uint64_t stagingBytes = 0;
+        double nsPerUpload = 0.0;
+    };
+
+    // Loading a model: vertex and index buffers per mesh and full mip chains of RGBA8 textures
+    std::vector<Upload> makeSceneTrace(uint32_t meshCount, uint32_t textureCount, uint32_t textureSize)
+    {
+        std::mt19937 random(31);
+        std::vector<Upload> trace;
+        for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+        {
+            const uint64_t vertexCount = 500 + random() % 60000;
+            trace.push_back({ vertexCount * 32, 0, 0 });
+            trace.push_back({ vertexCount * 3 * 2, 0, 0 });
+        }
+        for (uint32_t texture = 0; texture < textureCount; ++texture)
+        {
+            for (uint32_t size = textureSize; size >= 1; size /= 2)
+            {
+                trace.push_back({ 0, size * 4, size });
+            }
+        }
+        return trace;
+    }
+
+    // The UploadBatchDx12 policy without the copies: uploads are packed into the current staging chunk,
+    // a new chunk is acquired from the pool when it is full, and submit() hands every chunk to one fence.
+    // The copy queue keeps up, so after a submit every earlier batch is complete.
+    class BatchReplay
+    {
+    public:
+        explicit BatchReplay(BatchStats& stats) : m_stats(stats) {}
+
+        void add(const Upload& upload)
+        {
+            if (m_current == nullptr || !pack(*m_current, upload))
+            {
+                const uint64_t minCapacity = upload.bufferSize != 0
+                    ? upload.bufferSize + UploadPacker::BufferAlignment
+                    : UploadPacker::getTextureSize(upload.rowSizeInBytes, upload.numRows, 1) + UploadPacker::TexturePlacementAlignment;
+                m_current = acquireChunk(minCapacity);
+                pack(*m_current, upload);
+            }
+        }
+
+        void submit()
+        {
+            if (m_batchChunks.empty())
+            {
+                return;
+            }
+
+            ++m_fence;
+            for (uint32_t chunk : m_batchChunks)
+            {
+                m_stats.payloadBytes += m_packers[chunk]->getPayloadSize();
+                m_stats.stagingBytes += m_packers[chunk]->getUsedSize();
+                m_pool.release(chunk, m_fence);
+            }
+            m_batchChunks.clear();
+            m_current = nullptr;
+            m_stats.submitCount++;
+            m_pool.releaseCompleted(m_fence - 1);
+        }
+
+    private:
+        static bool pack(UploadPacker& packer, const Upload& upload)
+        {
+            if (upload.bufferSize != 0)
+            {
+                return packer.packBuffer(upload.bufferSize) != UploadPacker::InvalidOffset;
+            }
+            TextureFootprint footprint;
+            return packer.packTexture(upload.rowSizeInBytes, upload.numRows, 1, &footprint);
+        }
+
+        UploadPacker* acquireChunk(uint64_t minCapacity)
+        {
+            StagingPool::Allocation allocation = m_pool.acquire(minCapacity);
+            while (!allocation.isValid())
+            {
+                // Over the high-water mark: flush this batch if it holds everything, then wait for the oldest fence
+                if (!m_pool.hasPendingChunks())
+                {
+                    submit();
+                }
+                m_pool.releaseCompleted(m_pool.getOldestPendingFence());
+                allocation = m_pool.acquire(minCapacity);
+            }
+
+            m_pool.takeEvictedChunks(m_evictedChunks);
+            for (uint32_t chunk : m_evictedChunks)
+            {
+                m_packers[chunk].reset();
+            }
+            m_evictedChunks.clear();
+
+            if (allocation.chunk >= m_packers.size())
+            {
+                m_packers.resize(allocation.chunk + 1);
+            }
+            if (allocation.isNew)
+            {
+                m_packers[allocation.chunk] = std::make_unique<UploadPacker>(allocation.size);
+            }
+
+            UploadPacker* packer = m_packers[allocation.chunk].get();
+            packer->reset();
+            m_batchChunks.push_back(allocation.chunk);
+            m_stats.chunkCount++;
+            return packer;
+        }
+
+    private:
+        BatchStats& m_stats;
+        StagingPool m_pool;
+        std::vector<std::unique_ptr<UploadPacker>> m_packers; // Indexed by chunk id
+        std::vector<uint32_t> m_batchChunks;
+        std::vector<uint32_t> m_evictedChunks;
+        UploadPacker* m_current = nullptr;
+        uint64_t m_fence = 0;
+    };
+
+    BatchStats replayBatched(const std::vector<Upload>& trace, uint32_t uploadsPerSubmit, uint32_t repetitions)
+    {
+        BatchStats stats;
+        BatchReplay replay(stats);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            uint32_t uploadsInBatch = 0;
+            for (const Upload& upload : trace)
+            {
+                replay.add(upload);
+                if (++uploadsInBatch == uploadsPerSubmit)
+                {
+                    replay.submit();
+                    uploadsInBatch = 0;
+                }
+            }
+            replay.submit();
+        }
+        stats.nsPerUpload = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+            / (static_cast<double>(trace.size()) * repetitions);
+        return stats;
+    }
+
+    // Before batching: a committed upload buffer and a submit per resource, each rounded to the 64 KB
+    // resource placement granularity
+    BatchStats replayPerResource(const std::vector<Upload>& trace)
+    {
+        BatchStats stats;
+        for (const Upload& upload : trace)
+        {
+            const uint64_t size = upload.bufferSize != 0 ? upload.bufferSize : UploadPacker::getTextureSize(upload.rowSizeInBytes, upload.numRows, 1);
+            stats.payloadBytes += upload.bufferSize != 0 ? upload.bufferSize : static_cast<uint64_t>(upload.rowSizeInBytes) * upload.numRows;
+            stats.stagingBytes += (size + 65535) / 65536 * 65536;
+            stats.chunkCount++;
+            stats.submitCount++;
+        }
+        return stats;
+    }
+
+    void print(const char* name, const BatchStats& stats, uint32_t repetitions)
+    {
+        const double submits = static_cast<double>(stats.submitCount) / repetitions;
+        std::printf("%-26s %9.0f %9.0f %14.2f %10.2f ", name, submits, static_cast<double>(stats.chunkCount) / repetitions,
+            stats.payloadBytes / static_cast<double>(stats.submitCount) / 1048576.0,
+            100.0 * (stats.stagingBytes - stats.payloadBytes) / static_cast<double>(stats.stagingBytes));
+        if (stats.nsPerUpload > 0.0)
+        {
+            std::printf("%12.1f\n", stats.nsPerUpload);
+        }
+        else
+        {
+            std::printf("%12s\n", "-");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    parseArguments(argc, argv);
+    const uint32_t repetitions = pick(200u, 2u);
+
+    const std::vector<Upload> scene = makeSceneTrace(pick(64u, 8u), pick(24u, 2u), 2048);
+    std::printf("Scene load trace: %zu uploads\n", scene.size());
+    std::printf("%-26s %9s %9s %14s %10s %12s\n", "policy", "submits", "chunks", "MB per submit", "padding %", "ns/upload");
+    print("per-resource buffers", replayPerResource(scene), 1);
+    print("one batch", replayBatched(scene, ~0u, repetitions), repetitions);
+    print("batch per 32 uploads", replayBatched(scene, 32, repetitions), repetitions);
+    return 0;
+}
@@ -0,0 +1,7 @@
+// tinygltf implementation for the portable build. The demos compile it into BoxRenderer.cpp; the
+// importer only needs the model structures, so images are neither decoded nor written.
+#define TINYGLTF_IMPLEMENTATION
+#define TINYGLTF_NO_STB_IMAGE
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#define TINYGLTF_NO_EXTERNAL_IMAGE
+#include "tinygltf/tiny_gltf.h"
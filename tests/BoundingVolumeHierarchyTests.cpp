@@ -0,0 +1,351 @@
+#include "TestHarness.h"
+#include "BoundingVolumeHierarchy.h"
+#include "CameraMath.h"
+#include "HeapAllocationCounter.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::test;
+
+namespace
+{
+    constexpr float WorldSize = 100.0f;
+
+    // Boxes spread uniformly or gathered around 16 cluster centers
+    std::vector<BvhBounds> makeBoxes(uint32_t count, uint32_t seed, bool clustered)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-WorldSize, WorldSize);
+        std::uniform_real_distribution<float> size(0.1f, 2.0f);
+        std::normal_distribution<float> spread(0.0f, WorldSize * 0.05f);
+        std::array<std::array<float, 3>, 16> clusters;
+        for (std::array<float, 3>& cluster : clusters)
+        {
+            cluster = { position(random), position(random), position(random) };
+        }
+
+        std::vector<BvhBounds> boxes(count);
+        for (BvhBounds& box : boxes)
+        {
+            const std::array<float, 3>& cluster = clusters[random() % clusters.size()];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float center = clustered ? cluster[axis] + spread(random) : position(random);
+                const float extent = size(random);
+                box.min[axis] = center - extent;
+                box.max[axis] = center + extent;
+            }
+        }
+        return boxes;
+    }
+
+    // Parent links, heights, child bounds inside their parent, the depth stat, and every object in exactly one leaf
+    uint32_t countStructureErrors(const BoundingVolumeHierarchy& bvh)
+    {
+        const std::vector<BvhNode>& nodes = bvh.getNodes();
+        const uint32_t objectCount = bvh.getObjectCount();
+        if (objectCount == 0)
+        {
+            return bvh.getRoot() == BoundingVolumeHierarchy::InvalidIndex ? 0 : 1;
+        }
+
+        uint32_t errors = nodes[bvh.getRoot()].parent == BoundingVolumeHierarchy::InvalidIndex ? 0 : 1;
+        uint32_t maxDepth = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> stack = { { bvh.getRoot(), 1 } };
+        while (!stack.empty())
+        {
+            const auto [nodeIndex, depth] = stack.back();
+            stack.pop_back();
+            const BvhNode& node = nodes[nodeIndex];
+            maxDepth = std::max(maxDepth, depth);
+            if (node.objectCount > 0)
+            {
+                errors += node.height == 0 ? 0 : 1;
+                continue;
+            }
+
+            errors += node.height == 1 + std::max(nodes[node.left].height, nodes[node.right].height) ? 0 : 1;
+            for (uint32_t child : { node.left, node.right })
+            {
+                errors += nodes[child].parent == nodeIndex ? 0 : 1;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    errors += nodes[child].bounds.min[axis] >= node.bounds.min[axis] ? 0 : 1;
+                    errors += nodes[child].bounds.max[axis] <= node.bounds.max[axis] ? 0 : 1;
+                }
+                stack.push_back({ child, depth + 1 });
+            }
+        }
+        errors += maxDepth == bvh.getStats().depth ? 0 : 1;
+        errors += maxDepth <= BvhMaxDepth ? 0 : 1;
+
+        std::vector<uint32_t> found(objectCount);
+        const BvhBounds everything = { { -1e30f, -1e30f, -1e30f }, { 1e30f, 1e30f, 1e30f } };
+        const uint32_t foundCount = bvh.queryBox(everything, found.data());
+        errors += foundCount == objectCount ? 0 : 1;
+        std::vector<uint32_t> seen(objectCount, 0);
+        for (uint32_t i = 0; i < foundCount; ++i)
+        {
+            seen[found[i]]++;
+        }
+        errors += static_cast<uint32_t>(std::count_if(seen.begin(), seen.end(), [](uint32_t count) { return count != 1; }));
+        return errors;
+    }
+
+    std::vector<uint32_t> sorted(const std::vector<uint32_t>& indices, uint32_t count)
+    {
+        std::vector<uint32_t> result(indices.begin(), indices.begin() + count);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Frustum culls against the flat FrustumCuller, box queries, raycasts and nearest queries against brute force
+    uint32_t countQueryErrors(const BoundingVolumeHierarchy& bvh, const std::vector<BvhBounds>& boxes, uint32_t seed)
+    {
+        const uint32_t count = static_cast<uint32_t>(boxes.size());
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-WorldSize, WorldSize);
+        std::uniform_real_distribution<float> angle(0.0f, 6.283f);
+        uint32_t errors = 0;
+
+        CullingBounds flatBounds;
+        for (const BvhBounds& box : boxes)
+        {
+            const float center[3] = { (box.min[0] + box.max[0]) * 0.5f, (box.min[1] + box.max[1]) * 0.5f, (box.min[2] + box.max[2]) * 0.5f };
+            const float extents[3] = { (box.max[0] - box.min[0]) * 0.5f, (box.max[1] - box.min[1]) * 0.5f, (box.max[2] - box.min[2]) * 0.5f };
+            flatBounds.addBox(center, extents);
+        }
+        FrustumCuller flatCuller;
+        std::vector<uint32_t> flat(flatBounds.getPaddedCount());
+        std::vector<uint32_t> tree(count + 1);
+        for (int query = 0; query < 20; ++query)
+        {
+            const float eye[3] = { position(random) * 0.5f, position(random) * 0.5f, position(random) * 0.5f };
+            const float yaw = angle(random);
+            const float target[3] = { eye[0] + std::sin(yaw), eye[1], eye[2] + std::cos(yaw) };
+            const Frustum frustum = extractFrustum(makeViewProjection(eye, target).m);
+            const uint32_t flatCount = flatCuller.cull(frustum, flatBounds, flat.data());
+            const uint32_t treeCount = bvh.cullFrustum(frustum, tree.data());
+            errors += sorted(flat, flatCount) == sorted(tree, treeCount) ? 0 : 1;
+        }
+
+        for (int query = 0; query < 50; ++query)
+        {
+            BvhBounds box;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float center = position(random);
+                box.min[axis] = center - WorldSize * 0.05f;
+                box.max[axis] = center + WorldSize * 0.05f;
+            }
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                bool overlaps = true;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    overlaps &= boxes[i].min[axis] <= box.max[axis] && boxes[i].max[axis] >= box.min[axis];
+                }
+                if (overlaps)
+                {
+                    expected.push_back(i);
+                }
+            }
+            errors += sorted(tree, bvh.queryBox(box, tree.data())) == expected ? 0 : 1;
+        }
+
+        for (int query = 0; query < 100; ++query)
+        {
+            const float origin[3] = { position(random), position(random), position(random) };
+            float direction[3] = { position(random), position(random), position(random) };
+            if (query % 10 == 0)
+            {
+                direction[1] = 0.0f; // Parallel to a slab
+            }
+            const float maxDistance = 10.0f;
+            BvhRayHit hit;
+            const bool isHit = bvh.raycast(origin, direction, maxDistance, hit);
+
+            // Same slab test as the tree: entry clamped to 0, exit to the closest hit so far
+            float best = maxDistance;
+            uint32_t bestIndex = UINT32_MAX;
+            const float inverse[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                float entry = 0.0f;
+                float exit = best;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float t0 = (boxes[i].min[axis] - origin[axis]) * inverse[axis];
+                    const float t1 = (boxes[i].max[axis] - origin[axis]) * inverse[axis];
+                    entry = std::fmax(entry, std::fmin(t0, t1));
+                    exit = std::fmin(exit, std::fmax(t0, t1));
+                }
+                if (entry <= exit && (bestIndex == UINT32_MAX || entry < best))
+                {
+                    best = entry;
+                    bestIndex = i;
+                }
+            }
+            errors += isHit == (bestIndex != UINT32_MAX) ? 0 : 1;
+            errors += isHit && bestIndex != UINT32_MAX && hit.distance != best ? 1 : 0;
+        }
+
+        for (int query = 0; query < 100; ++query)
+        {
+            const float point[3] = { position(random), position(random), position(random) };
+            float distance = -1.0f;
+            const uint32_t nearest = bvh.findNearest(point, WorldSize, &distance);
+            float bestSquared = INFINITY;
+            for (const BvhBounds& box : boxes)
+            {
+                float squared = 0.0f;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float gap = std::max({ box.min[axis] - point[axis], point[axis] - box.max[axis], 0.0f });
+                    squared += gap * gap;
+                }
+                bestSquared = std::min(bestSquared, squared);
+            }
+            if (bestSquared <= WorldSize * WorldSize)
+            {
+                errors += nearest != BoundingVolumeHierarchy::InvalidIndex && distance == std::sqrt(bestSquared) ? 0 : 1;
+            }
+            else
+            {
+                errors += nearest == BoundingVolumeHierarchy::InvalidIndex ? 0 : 1;
+            }
+        }
+        return errors;
+    }
+}
+
+TEST(BuiltTreesMatchBruteForce)
+{
+    JobSystem jobs(3);
+    for (bool clustered : { false, true })
+    {
+        for (uint32_t count : { 0u, 1u, 2u, 5u, 17u, 1000u, 20000u })
+        {
+            const std::vector<BvhBounds> boxes = makeBoxes(count, count + 7, clustered);
+            BoundingVolumeHierarchy serial;
+            BoundingVolumeHierarchy parallel;
+            serial.build(boxes.data(), count);
+            parallel.build(jobs, boxes.data(), count);
+            CHECK(countStructureErrors(serial) == 0);
+            CHECK(countStructureErrors(parallel) == 0);
+
+            const BvhStats serialStats = serial.getStats();
+            const BvhStats parallelStats = parallel.getStats();
+            CHECK(serialStats.nodeCount == parallelStats.nodeCount);
+            CHECK(serialStats.depth == parallelStats.depth);
+            CHECK(std::fabs(serialStats.sahCost - parallelStats.sahCost) <= 1e-3f * serialStats.sahCost + 1e-6f);
+            if (count > 0)
+            {
+                CHECK(countQueryErrors(serial, boxes, count) == 0);
+                CHECK(countQueryErrors(parallel, boxes, count + 1) == 0);
+            }
+        }
+    }
+}
+
+TEST(InsertedTreesMatchBruteForce)
+{
+    for (uint32_t count : { 1u, 17u, 1000u, 20000u })
+    {
+        const std::vector<BvhBounds> boxes = makeBoxes(count, count + 11, count % 2 == 0);
+        BoundingVolumeHierarchy bvh;
+        for (const BvhBounds& box : boxes)
+        {
+            bvh.insert(box);
+        }
+        CHECK(countStructureErrors(bvh) == 0);
+        CHECK(countQueryErrors(bvh, boxes, count + 2) == 0);
+        // Rebuilds once insertions outnumber the built objects, so the count since the last build stays bounded
+        const BvhStats stats = bvh.getStats();
+        CHECK(stats.buildCount >= 1 || count == 1);
+        CHECK(stats.insertedCount <= count);
+    }
+}
+
+TEST(MovedObjectsAreFoundAfterRefit)
+{
+    std::vector<BvhBounds> boxes = makeBoxes(5000, 3, false);
+    BoundingVolumeHierarchy bvh;
+    bvh.build(boxes.data(), static_cast<uint32_t>(boxes.size()));
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    for (uint32_t i = 0; i < boxes.size(); ++i)
+    {
+        const float move = offset(random);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            boxes[i].min[axis] += move;
+            boxes[i].max[axis] += move;
+        }
+        bvh.setBounds(i, boxes[i]);
+    }
+    bvh.refit();
+    CHECK(countStructureErrors(bvh) == 0);
+    CHECK(countQueryErrors(bvh, boxes, 4) == 0);
+
+    bvh.clear();
+    CHECK(bvh.getObjectCount() == 0);
+    CHECK(countStructureErrors(bvh) == 0);
+}
+
+TEST(DegenerateInputsStayWithinTheDepthLimit)
+{
+    BoundingVolumeHierarchy bvh;
+    const std::vector<BvhBounds> identical(1000, BvhBounds{ { 1.0f, 1.0f, 1.0f }, { 2.0f, 2.0f, 2.0f } });
+    bvh.build(identical.data(), 1000);
+    CHECK(countStructureErrors(bvh) == 0);
+
+    // Points on a line, zero volume
+    std::vector<BvhBounds> points(5000);
+    for (uint32_t i = 0; i < points.size(); ++i)
+    {
+        const float x = static_cast<float>(i) * 0.04f - WorldSize;
+        points[i] = { { x, 0.0f, 0.0f }, { x, 0.0f, 0.0f } };
+    }
+    bvh.build(points.data(), 5000);
+    CHECK(countStructureErrors(bvh) == 0);
+    CHECK(countQueryErrors(bvh, points, 9) == 0);
+
+    // Exponentially spread positions, where SAH splits would run deep
+    for (uint32_t i = 0; i < points.size(); ++i)
+    {
+        const float x = std::ldexp(1.0f, static_cast<int>(i % 120) - 60);
+        points[i] = { { x, 0.0f, 0.0f }, { x * 1.0001f, 1.0f, 1.0f } };
+    }
+    bvh.build(points.data(), 5000);
+    CHECK(countStructureErrors(bvh) == 0);
+}
+
+TEST(QueriesDoNotAllocate)
+{
+    const std::vector<BvhBounds> boxes = makeBoxes(10000, 1, false);
+    BoundingVolumeHierarchy bvh;
+    bvh.build(boxes.data(), 10000);
+    std::vector<uint32_t> indices(10000);
+    const float eye[3] = { 0.0f, 0.0f, 0.0f };
+    const float target[3] = { 1.0f, 0.0f, 3.0f };
+    const Frustum frustum = extractFrustum(makeViewProjection(eye, target).m);
+    const float origin[3] = { 0.0f, 0.0f, 0.0f };
+    const float direction[3] = { 1.0f, 0.2f, 0.1f };
+
+    HeapAllocationScope scope(HeapAllocationSource::CurrentThread);
+    for (int i = 0; i < 10; ++i)
+    {
+        bvh.cullFrustum(frustum, indices.data());
+        BvhRayHit hit;
+        bvh.raycast(origin, direction, 100.0f, hit);
+        bvh.findNearest(origin, 50.0f);
+        bvh.queryBox(boxes[5], indices.data());
+    }
+    CHECK(scope.getAllocationCount() == 0);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cmath>
+
+// Row-vector camera matrices in the DirectXMath convention (left handed, depth in [0, 1], XMFLOAT4X4 order),
+// for the culling and LOD tests and benchmarks, which build without DirectXMath
+namespace raphael::test
+{
+    struct Matrix4
+    {
+        float m[16] = {};
+    };
+
+    inline Matrix4 multiply(const Matrix4& a, const Matrix4& b)
+    {
+        Matrix4 result;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    result.m[row * 4 + column] += a.m[row * 4 + k] * b.m[k * 4 + column];
+                }
+            }
+        }
+        return result;
+    }
+
+    inline Matrix4 perspectiveFovLH(float fovY, float aspect, float nearZ, float farZ)
+    {
+        const float height = 1.0f / std::tan(fovY * 0.5f);
+        const float range = farZ / (farZ - nearZ);
+        Matrix4 result;
+        result.m[0] = height / aspect;
+        result.m[5] = height;
+        result.m[10] = range;
+        result.m[11] = 1.0f;
+        result.m[14] = -nearZ * range;
+        return result;
+    }
+
+    inline Matrix4 lookAtLH(const float eye[3], const float target[3])
+    {
+        auto normalize = [](float* v)
+        {
+            const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+            v[0] /= length;
+            v[1] /= length;
+            v[2] /= length;
+        };
+
+        float z[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+        normalize(z);
+        float x[3] = { z[2], 0.0f, -z[0] }; // up (0, 1, 0) cross z
+        normalize(x);
+        const float y[3] = { z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0] };
+
+        Matrix4 result;
+        for (int i = 0; i < 3; ++i)
+        {
+            result.m[i * 4 + 0] = x[i];
+            result.m[i * 4 + 1] = y[i];
+            result.m[i * 4 + 2] = z[i];
+        }
+        result.m[12] = -(x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2]);
+        result.m[13] = -(y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2]);
+        result.m[14] = -(z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2]);
+        result.m[15] = 1.0f;
+        return result;
+    }
+
+    // 45 degree, 16:9 camera at eye looking at target
+    inline Matrix4 makeViewProjection(const float eye[3], const float target[3], float nearZ = 0.1f, float farZ = 1000.0f)
+    {
+        return multiply(lookAtLH(eye, target), perspectiveFovLH(0.785398f, 16.0f / 9.0f, nearZ, farZ));
+    }
+
+    // Clip space position of a point, in double so reference checks do not share the culler's rounding
+    inline void transformToClip(const Matrix4& viewProjection, const float point[3], double clip[4])
+    {
+        const float* m = viewProjection.m;
+        for (int j = 0; j < 4; ++j)
+        {
+            clip[j] = double(point[0]) * m[j] + double(point[1]) * m[4 + j] + double(point[2]) * m[8 + j] + double(m[12 + j]);
+        }
+    }
+} // namespace raphael::test
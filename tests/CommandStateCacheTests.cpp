@@ -0,0 +1,282 @@
+#include "TestHarness.h"
+#include "CommandStateCache.h"
+#include <map>
+#include <optional>
+#include <random>
+
+using namespace raphael;
+
+namespace
+{
+    // Command list state as the API keeps it: binding a root signature drops every root argument and
+    // binding other descriptor heaps drops the descriptor tables. Records every call it receives.
+    struct ReferenceList
+    {
+        enum class RootKind
+        {
+            ConstantBuffer,
+            DescriptorTable,
+        };
+
+        std::optional<uint64_t> pipeline;
+        std::optional<uint64_t> rootSignature;
+        std::optional<std::vector<uint64_t>> heaps;
+        std::optional<uint64_t> indexBuffer;
+        std::optional<uint32_t> topology;
+        std::map<uint32_t, uint64_t> vertexBuffers;
+        std::map<uint32_t, std::pair<RootKind, uint64_t>> rootArguments;
+        uint64_t callCount = 0;
+
+        void setPipeline(uint64_t value)
+        {
+            callCount++;
+            pipeline = value;
+        }
+
+        void setRootSignature(uint64_t value)
+        {
+            callCount++;
+            if (rootSignature != value)
+            {
+                rootArguments.clear();
+            }
+            rootSignature = value;
+        }
+
+        void setHeaps(const std::vector<uint64_t>& value)
+        {
+            callCount++;
+            if (heaps != value)
+            {
+                std::erase_if(rootArguments, [](const auto& argument) { return argument.second.first == RootKind::DescriptorTable; });
+            }
+            heaps = value;
+        }
+
+        void setVertexBuffer(uint32_t slot, uint64_t address)
+        {
+            callCount++;
+            vertexBuffers[slot] = address;
+        }
+
+        void setIndexBuffer(uint64_t address)
+        {
+            callCount++;
+            indexBuffer = address;
+        }
+
+        void setTopology(uint32_t value)
+        {
+            callCount++;
+            topology = value;
+        }
+
+        void setRootArgument(uint32_t parameter, RootKind kind, uint64_t value)
+        {
+            callCount++;
+            rootArguments[parameter] = { kind, value };
+        }
+
+        bool operator==(const ReferenceList& rhs) const
+        {
+            return pipeline == rhs.pipeline && rootSignature == rhs.rootSignature && heaps == rhs.heaps && indexBuffer == rhs.indexBuffer
+                && topology == rhs.topology && vertexBuffers == rhs.vertexBuffers && rootArguments == rhs.rootArguments;
+        }
+    };
+
+    uint64_t toValue(const void* pointer) { return reinterpret_cast<uint64_t>(pointer); }
+}
+
+TEST(RepeatedDrawStateIsElided)
+{
+    // 1000 cubes sharing geometry and material, only the per-draw constant buffer changes
+    CommandStateCache cache;
+    cache.reset();
+    const int pipeline = 0;
+    const int rootSignature = 0;
+    uint32_t issued = 0;
+    for (uint32_t draw = 0; draw < 1000; ++draw)
+    {
+        issued += cache.setPipeline(&pipeline) ? 1 : 0;
+        issued += cache.setRootSignature(&rootSignature) ? 1 : 0;
+        issued += cache.setVertexBuffer(0, { 0x1000, 64, 32 }) ? 1 : 0;
+        issued += cache.setIndexBuffer({ 0x2000, 36, 42 }) ? 1 : 0;
+        issued += cache.setPrimitiveTopology(4) ? 1 : 0;
+        issued += cache.setRootConstantBuffer(0, 0x3000 + 256ull * draw) ? 1 : 0;
+        issued += cache.setRootDescriptorTable(2, 0x9000) ? 1 : 0;
+    }
+    CHECK(issued == 1000 + 6);
+    CHECK(cache.getStats().issuedCount == issued);
+    CHECK(cache.getStats().elidedCount == 7000 - issued);
+}
+
+TEST(InvalidationFollowsTheApi)
+{
+    CommandStateCache cache;
+    cache.reset();
+    const int objects[4] = {};
+    const void* heaps[2] = { &objects[0], &objects[1] };
+    const void* otherHeaps[2] = { &objects[2], &objects[1] };
+
+    CHECK(cache.setRootSignature(&objects[0]));
+    CHECK(cache.setDescriptorHeaps(heaps, 2));
+    CHECK(cache.setRootConstantBuffer(0, 0x100));
+    CHECK(cache.setRootDescriptorTable(1, 0x200));
+    CHECK(!cache.setRootConstantBuffer(0, 0x100));
+    CHECK(!cache.setRootDescriptorTable(1, 0x200));
+
+    // Other heaps drop the tables, not the constant buffers
+    CHECK(cache.setDescriptorHeaps(otherHeaps, 2));
+    CHECK(!cache.setRootConstantBuffer(0, 0x100));
+    CHECK(cache.setRootDescriptorTable(1, 0x200));
+    CHECK(!cache.setDescriptorHeaps(otherHeaps, 2));
+    CHECK(cache.setDescriptorHeaps(otherHeaps, 1));
+
+    // Another root signature drops every root argument, binding the same one again keeps them
+    CHECK(!cache.setRootSignature(&objects[0]));
+    CHECK(!cache.setRootConstantBuffer(0, 0x100));
+    CHECK(cache.setRootSignature(&objects[1]));
+    CHECK(cache.setRootConstantBuffer(0, 0x100));
+    CHECK(cache.setRootDescriptorTable(1, 0x200));
+
+    // The same value as a different kind of argument is still a change
+    CHECK(cache.setRootDescriptorTable(0, 0x100));
+
+    // Slots and parameters past the cached ranges are always issued
+    CHECK(cache.setVertexBuffer(CommandStateCache::MaxVertexBufferSlots, { 0x10, 64, 32 }));
+    CHECK(cache.setVertexBuffer(CommandStateCache::MaxVertexBufferSlots, { 0x10, 64, 32 }));
+    CHECK(cache.setRootConstantBuffer(CommandStateCache::MaxRootParameters, 0x10));
+    CHECK(cache.setRootConstantBuffer(CommandStateCache::MaxRootParameters, 0x10));
+
+    // A vertex buffer differing only in stride is a change
+    CHECK(cache.setVertexBuffer(0, { 0x10, 64, 32 }));
+    CHECK(cache.setVertexBuffer(0, { 0x10, 64, 16 }));
+
+    cache.reset();
+    CHECK(cache.setRootSignature(&objects[1]));
+    CHECK(cache.setPrimitiveTopology(4));
+}
+
+// Random call streams, filtered through the cache into one list and sent unfiltered to another: at every
+// draw both lists must hold the same state. Includes native recording behind the cache's back
+// followed by reset(), and slots and parameters past the cached ranges.
+TEST(FilteredListMatchesUnfilteredReference)
+{
+    std::mt19937 random(7);
+    const int objects[4] = {};
+    uint32_t mismatchCount = 0;
+    uint64_t referenceCalls = 0;
+    uint64_t filteredCalls = 0;
+    for (int trial = 0; trial < 500; ++trial)
+    {
+        CommandStateCache cache;
+        cache.reset();
+        ReferenceList filtered;
+        ReferenceList reference;
+        for (int step = 0; step < 400; ++step)
+        {
+            switch (random() % 10)
+            {
+            case 0:
+            {
+                const void* pipeline = &objects[random() % 3];
+                reference.setPipeline(toValue(pipeline));
+                if (cache.setPipeline(pipeline))
+                {
+                    filtered.setPipeline(toValue(pipeline));
+                }
+                break;
+            }
+            case 1:
+            {
+                const void* rootSignature = &objects[random() % 2];
+                reference.setRootSignature(toValue(rootSignature));
+                if (cache.setRootSignature(rootSignature))
+                {
+                    filtered.setRootSignature(toValue(rootSignature));
+                }
+                break;
+            }
+            case 2:
+            {
+                const uint32_t count = 1 + random() % 2;
+                const void* heaps[2] = { &objects[random() % 2], &objects[2 + random() % 2] };
+                std::vector<uint64_t> values;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    values.push_back(toValue(heaps[i]));
+                }
+                reference.setHeaps(values);
+                if (cache.setDescriptorHeaps(heaps, count))
+                {
+                    filtered.setHeaps(values);
+                }
+                break;
+            }
+            case 3:
+            {
+                const uint32_t slot = random() % (CommandStateCache::MaxVertexBufferSlots + 2);
+                const VertexBufferBinding binding = { 0x100ull * (random() % 3), 64, 32 };
+                reference.setVertexBuffer(slot, binding.address);
+                if (cache.setVertexBuffer(slot, binding))
+                {
+                    filtered.setVertexBuffer(slot, binding.address);
+                }
+                break;
+            }
+            case 4:
+            {
+                const IndexBufferBinding binding = { 0x100ull * (random() % 2), 36, 42 };
+                reference.setIndexBuffer(binding.address);
+                if (cache.setIndexBuffer(binding))
+                {
+                    filtered.setIndexBuffer(binding.address);
+                }
+                break;
+            }
+            case 5:
+            {
+                const uint32_t topology = 4 + random() % 2;
+                reference.setTopology(topology);
+                if (cache.setPrimitiveTopology(topology))
+                {
+                    filtered.setTopology(topology);
+                }
+                break;
+            }
+            case 6:
+            case 7:
+            {
+                const bool table = random() % 2 == 0;
+                const uint32_t parameter = random() % (CommandStateCache::MaxRootParameters + 2);
+                const uint64_t value = random() % 3;
+                const ReferenceList::RootKind kind = table ? ReferenceList::RootKind::DescriptorTable : ReferenceList::RootKind::ConstantBuffer;
+                reference.setRootArgument(parameter, kind, value);
+                if (table ? cache.setRootDescriptorTable(parameter, value) : cache.setRootConstantBuffer(parameter, value))
+                {
+                    filtered.setRootArgument(parameter, kind, value);
+                }
+                break;
+            }
+            case 8:
+                // Something recorded on the native list directly, then told the cache
+                if (random() % 2 == 0)
+                {
+                    reference.setPipeline(999);
+                    filtered.setPipeline(999);
+                    reference.setRootSignature(998);
+                    filtered.setRootSignature(998);
+                }
+                cache.reset();
+                break;
+            case 9:
+                mismatchCount += filtered == reference ? 0 : 1;
+                break;
+            }
+        }
+        referenceCalls += reference.callCount;
+        filteredCalls += filtered.callCount;
+    }
+    CHECK(mismatchCount == 0);
+    CHECK(filteredCalls < referenceCalls);
+}
@@ -0,0 +1,138 @@
+#include "TestHarness.h"
+#include "CommandStream.h"
+#include <random>
+#include <string>
+
+using namespace raphael;
+
+namespace
+{
+    // Translator writing every call as text, so recorded and expected call sequences compare directly
+    struct LogTranslator
+    {
+        std::vector<std::string> calls;
+
+        void log(const char* format, auto... arguments)
+        {
+            char line[128];
+            std::snprintf(line, sizeof(line), format, arguments...);
+            calls.push_back(line);
+        }
+
+        void setPipeline(CommandHandle pipeline) { log("pipeline %u", pipeline); }
+        void setRootSignature(CommandHandle rootSignature) { log("root signature %u", rootSignature); }
+        void setDescriptorHeap(CommandHandle heap) { log("heap %u", heap); }
+        void setVertexBuffer(uint32_t slot, CommandHandle view) { log("vertex buffer %u %u", slot, view); }
+        void setIndexBuffer(CommandHandle view) { log("index buffer %u", view); }
+        void setRootConstantBuffer(uint32_t parameter, uint64_t address) { log("constant buffer %u %llx", parameter, static_cast<unsigned long long>(address)); }
+        void setRootDescriptorTable(uint32_t parameter, uint64_t handle) { log("table %u %llx", parameter, static_cast<unsigned long long>(handle)); }
+        void transition(CommandHandle resource, ResourceState state) { log("transition %u %x", resource, static_cast<uint32_t>(state)); }
+        void draw(const CommandDraw& draw) { log("draw %u %u %u %u", draw.vertexCount, draw.instanceCount, draw.startVertex, draw.startInstance); }
+        void drawIndexed(const CommandDrawIndexed& draw)
+        {
+            log("draw indexed %u %u %u %d %u", draw.indexCount, draw.instanceCount, draw.startIndex, draw.baseVertex, draw.startInstance);
+        }
+    };
+
+    bool replayRejects(std::vector<std::byte> bytes)
+    {
+        LogTranslator translator;
+        try
+        {
+            replayCommandStream(std::span<const std::byte>(bytes), translator);
+        }
+        catch (const std::runtime_error&)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+TEST(RandomStreamsRoundTrip)
+{
+    std::mt19937_64 random(3);
+    for (int trial = 0; trial < 200; ++trial)
+    {
+        // The second half goes to another stream and is appended, as streams recorded on other threads are
+        CommandStream stream;
+        CommandStream tail;
+        LogTranslator expected;
+        for (int i = 0; i < 300; ++i)
+        {
+            CommandStream& target = i < 150 ? stream : tail;
+            const uint32_t handle = random() % 1000;
+            const uint32_t slot = random() % 8;
+            const uint64_t value = random();
+            const int32_t baseVertex = -static_cast<int32_t>(random() % 100);
+            switch (random() % 10)
+            {
+            case 0: target.setPipeline(handle); expected.setPipeline(handle); break;
+            case 1: target.setRootSignature(handle); expected.setRootSignature(handle); break;
+            case 2: target.setDescriptorHeap(handle); expected.setDescriptorHeap(handle); break;
+            case 3: target.setVertexBuffer(slot, handle); expected.setVertexBuffer(slot, handle); break;
+            case 4: target.setIndexBuffer(handle); expected.setIndexBuffer(handle); break;
+            case 5: target.setRootConstantBuffer(slot, value); expected.setRootConstantBuffer(slot, value); break;
+            case 6: target.setRootDescriptorTable(slot, value); expected.setRootDescriptorTable(slot, value); break;
+            case 7: target.transition(handle, ResourceState::PixelShaderResource); expected.transition(handle, ResourceState::PixelShaderResource); break;
+            case 8: target.draw(handle, slot, handle + 1, slot + 2); expected.draw({ handle, slot, handle + 1, slot + 2 }); break;
+            case 9: target.drawIndexed(handle, slot, handle + 3, baseVertex, slot); expected.drawIndexed({ handle, slot, handle + 3, baseVertex, slot }); break;
+            }
+        }
+        stream.append(tail);
+
+        LogTranslator replayed;
+        replayCommandStream(stream.getBytes(), replayed);
+        CHECK(replayed.calls == expected.calls);
+        CHECK(stream.getCommandCount() == 300);
+        CHECK(stream.getSize() % 4 == 0);
+    }
+}
+
+TEST(ClearKeepsCapacity)
+{
+    CommandStream stream;
+    CHECK(stream.isEmpty());
+    stream.reserve(1024);
+    stream.drawIndexed(36, 1, 0, 0, 0);
+    CHECK(!stream.isEmpty());
+    const std::byte* data = stream.getBytes().data();
+    stream.clear();
+    CHECK(stream.isEmpty());
+    CHECK(stream.getSize() == 0);
+    stream.drawIndexed(36, 1, 0, 0, 0);
+    CHECK(stream.getBytes().data() == data);
+
+    // A stream that does not change replays the same calls every time
+    LogTranslator first;
+    LogTranslator second;
+    replayCommandStream(stream.getBytes(), first);
+    replayCommandStream(stream.getBytes(), second);
+    CHECK(first.calls.size() == 1);
+    CHECK(first.calls == second.calls);
+}
+
+TEST(CorruptStreamsAreRejected)
+{
+    CommandStream stream;
+    stream.drawIndexed(1, 1, 0, 0, 0);
+    const std::vector<std::byte> bytes(stream.getBytes().begin(), stream.getBytes().end());
+    CHECK(!replayRejects(bytes));
+
+    std::vector<std::byte> unknownType = bytes;
+    unknownType[0] = std::byte{ 200 };
+    CHECK(replayRejects(unknownType));
+
+    std::vector<std::byte> wrongSize = bytes;
+    wrongSize[2] = std::byte{ 8 };
+    wrongSize[3] = std::byte{ 0 };
+    CHECK(replayRejects(wrongSize));
+
+    std::vector<std::byte> truncatedPayload = bytes;
+    truncatedPayload.pop_back();
+    CHECK(replayRejects(truncatedPayload));
+
+    std::vector<std::byte> truncatedHeader = bytes;
+    truncatedHeader.resize(2);
+    CHECK(replayRejects(truncatedHeader));
+}
@@ -0,0 +1,118 @@
+#include "TestHarness.h"
+#include "DeferredReleaseQueue.h"
+#include "NullDevice.h"
+#include <random>
+#include <vector>
+
+using namespace raphael;
+
+namespace
+{
+    // Records the fence its owner had completed when it was destroyed
+    struct Tracked
+    {
+        Tracked(std::vector<uint64_t>* destroyed, uint64_t fence, const uint64_t* completed)
+            : m_destroyed(destroyed), m_fence(fence), m_completed(completed) {}
+        ~Tracked()
+        {
+            CHECK(*m_completed >= m_fence);
+            m_destroyed->push_back(m_fence);
+        }
+
+        std::vector<uint64_t>* m_destroyed;
+        uint64_t m_fence;
+        const uint64_t* m_completed;
+    };
+}
+
+TEST(ReleasesOnlyCompletedFences)
+{
+    std::vector<uint64_t> destroyed;
+    uint64_t completed = 0;
+    DeferredReleaseQueue queue;
+    for (uint64_t fence = 1; fence <= 10; ++fence)
+    {
+        queue.retire(std::make_unique<Tracked>(&destroyed, fence, &completed), fence);
+    }
+    CHECK(queue.getPendingCount() == 10);
+
+    completed = 4;
+    queue.releaseCompleted(completed);
+    CHECK(destroyed == (std::vector<uint64_t>{ 1, 2, 3, 4 }));
+    CHECK(queue.getPendingCount() == 6);
+    CHECK(queue.getReleasedCount() == 4);
+
+    // Releasing an older value again does nothing
+    queue.releaseCompleted(2);
+    CHECK(queue.getPendingCount() == 6);
+    completed = ~0ull; // The queue's destructor drops the rest
+}
+
+TEST(KeepsFenceOrderForLateOlderTags)
+{
+    std::vector<uint64_t> destroyed;
+    uint64_t completed = 0;
+    DeferredReleaseQueue queue;
+    queue.retire(std::make_unique<Tracked>(&destroyed, 5, &completed), 5);
+    queue.retire(std::make_unique<Tracked>(&destroyed, 9, &completed), 9);
+    queue.retire(std::make_unique<Tracked>(&destroyed, 3, &completed), 3);
+    queue.retire(std::make_unique<Tracked>(&destroyed, 5, &completed), 5);
+
+    completed = 5;
+    queue.releaseCompleted(completed);
+    CHECK(destroyed == (std::vector<uint64_t>{ 3, 5, 5 }));
+    CHECK(queue.getPendingCount() == 1);
+    completed = ~0ull;
+}
+
+TEST(IgnoresNullAndReleasesEverythingOnIdle)
+{
+    std::vector<uint64_t> destroyed;
+    uint64_t completed = 0;
+    DeferredReleaseQueue queue;
+    queue.retire(std::unique_ptr<Tracked>(), 1);
+    queue.retire(std::shared_ptr<void>(), 1);
+    CHECK(queue.getPendingCount() == 0);
+
+    queue.retire(std::make_unique<Tracked>(&destroyed, 7, &completed), 7);
+    queue.retire(std::make_unique<int>(42), 8);
+    completed = 8; // The GPU is idle
+    queue.releaseAll();
+    CHECK(queue.getPendingCount() == 0);
+    CHECK(queue.getReleasedCount() == 2);
+    CHECK(destroyed.size() == 1);
+}
+
+TEST(FollowsASimulatedFenceTimeline)
+{
+    // The null device retires through its own queue, the simulated GPU trails three fences behind
+    NullDeviceDesc desc;
+    desc.fenceLatency = 3;
+    NullDevice device(desc);
+    std::mt19937 random(30);
+
+    uint64_t retiredCount = 0;
+    for (int frame = 0; frame < 1000; ++frame)
+    {
+        const int toggles = random() % 4 == 0 ? 1 + random() % 3 : 0;
+        for (int i = 0; i < toggles; ++i)
+        {
+            NullResourceDesc resourceDesc;
+            resourceDesc.name = "Toggled buffer";
+            resourceDesc.sizeInBytes = 4096;
+            device.retire(device.createResource(resourceDesc));
+            retiredCount++;
+        }
+
+        device.signalFence(device.getNextFenceValue());
+
+        // Nothing tagged after the completed fence may be gone, nothing at or before it may remain
+        const DeferredReleaseQueue& queue = device.getReleaseQueue();
+        CHECK(queue.getReleasedCount() + queue.getPendingCount() == retiredCount);
+        CHECK(device.getObjectStats(NullObjectType::Resource).liveCount == queue.getPendingCount());
+    }
+
+    device.waitForFence(device.getNextFenceValue() - 1);
+    CHECK(device.getReleaseQueue().getPendingCount() == 0);
+    CHECK(device.getLiveObjectCount() == 0);
+}
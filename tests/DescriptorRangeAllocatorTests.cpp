@@ -0,0 +1,123 @@
+#include "TestHarness.h"
+#include "DescriptorRangeAllocator.h"
+#include <random>
+#include <vector>
+
+using namespace raphael;
+
+TEST(SingleDescriptorsAreRangesOfOne)
+{
+    DescriptorRangeAllocator allocator(16);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        CHECK(allocator.allocate(1) == i);
+    }
+    CHECK(allocator.allocate(1) == DescriptorRangeAllocator::InvalidIndex);
+    CHECK(allocator.getUsedCount() == 16);
+
+    allocator.free(7);
+    CHECK(allocator.allocate(1) == 7);
+}
+
+TEST(TablesAreContiguous)
+{
+    DescriptorRangeAllocator allocator(64);
+    const uint32_t table = allocator.allocate(8);
+    const uint32_t single = allocator.allocate(1);
+    const uint32_t gbuffer = allocator.allocate(5);
+    CHECK(table == 0 && single == 8 && gbuffer == 9);
+    CHECK(allocator.getRangeSize(table) == 8);
+    CHECK(allocator.getRangeSize(gbuffer) == 5);
+    CHECK(allocator.getRangeSize(1) == 0); // Inside a range, not the start of one
+    CHECK(allocator.getRangeSize(1000) == 0);
+
+    allocator.free(table);
+    CHECK(allocator.getRangeSize(table) == 0);
+    CHECK(allocator.getUsedCount() == 6);
+}
+
+TEST(FreedRangesCoalesceIntoLargerTables)
+{
+    DescriptorRangeAllocator allocator(32);
+    uint32_t ranges[4];
+    for (uint32_t& range : ranges)
+    {
+        range = allocator.allocate(8);
+    }
+    CHECK(allocator.allocate(1) == DescriptorRangeAllocator::InvalidIndex);
+
+    allocator.free(ranges[1]);
+    allocator.free(ranges[2]);
+    // Two adjacent holes of 8 merged into one of 16
+    CHECK(allocator.allocate(16) == 8);
+    CHECK(allocator.getStats().freeBlockCount == 0);
+}
+
+TEST(FragmentedHeapRejectsLargeTables)
+{
+    DescriptorRangeAllocator allocator(32);
+    std::vector<uint32_t> singles;
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        singles.push_back(allocator.allocate(1));
+    }
+    for (uint32_t i = 0; i < 32; i += 2)
+    {
+        allocator.free(singles[i]);
+    }
+
+    CHECK(allocator.getCapacity() - allocator.getUsedCount() == 16);
+    CHECK(allocator.allocate(2) == DescriptorRangeAllocator::InvalidIndex);
+    CHECK(allocator.getStats().largestFreeBlock == 1);
+}
+
+TEST(RandomTablesMatchAnOccupancyMap)
+{
+    const uint32_t capacity = 4096;
+    DescriptorRangeAllocator allocator(capacity);
+    std::vector<uint8_t> owned(capacity, 0);
+    std::vector<uint32_t> live;
+    std::mt19937 random(11);
+
+    for (int step = 0; step < 50000; ++step)
+    {
+        if (live.empty() || random() % 5 < 3)
+        {
+            const uint32_t count = random() % 4 == 0 ? 1 + random() % 32 : 1;
+            const uint32_t first = allocator.allocate(count);
+            if (first == DescriptorRangeAllocator::InvalidIndex)
+            {
+                continue;
+            }
+
+            CHECK(first + count <= capacity);
+            CHECK(allocator.getRangeSize(first) == count);
+            for (uint32_t index = first; index < first + count; ++index)
+            {
+                CHECK(owned[index] == 0);
+                owned[index] = 1;
+            }
+            live.push_back(first);
+        }
+        else
+        {
+            const size_t pick = random() % live.size();
+            const uint32_t first = live[pick];
+            const uint32_t count = allocator.getRangeSize(first);
+            for (uint32_t index = first; index < first + count; ++index)
+            {
+                owned[index] = 0;
+            }
+            allocator.free(first);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (uint32_t first : live)
+    {
+        allocator.free(first);
+    }
+    CHECK(allocator.getUsedCount() == 0);
+    CHECK(allocator.getStats().largestFreeBlock == capacity);
+}
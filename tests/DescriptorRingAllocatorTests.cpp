@@ -0,0 +1,117 @@
+#include "TestHarness.h"
+#include "DescriptorRingAllocator.h"
+#include "NullDevice.h"
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace raphael;
+
+namespace
+{
+    // One frame of the demos' pattern: allocate tables, tag them with the frame's fence, signal it
+    uint64_t finishFrame(NullDevice& device, DescriptorRingAllocator& ring)
+    {
+        const uint64_t fence = device.getNextFenceValue();
+        ring.finishFrame(fence);
+        device.signalFence(fence);
+        return fence;
+    }
+}
+
+TEST(RecyclesTablesWithoutWaitingWhenFramesFit)
+{
+    NullDeviceDesc desc;
+    desc.fenceLatency = 2;
+    NullDevice device(desc);
+    DescriptorRingAllocator ring(300);
+
+    // Three frames of 100 descriptors fit exactly while the GPU trails by two
+    for (int frame = 0; frame < 50; ++frame)
+    {
+        for (int table = 0; table < 20; ++table)
+        {
+            CHECK(ring.allocate(device, 5) != DescriptorRingAllocator::InvalidOffset);
+        }
+        finishFrame(device, ring);
+    }
+    CHECK(ring.getWaitCount() == 0);
+    CHECK(device.getStats().blockingWaitCount == 0);
+    CHECK(ring.getRing().getPeakUsedSize() == 300);
+}
+
+TEST(WaitsForTheOldestFrameWhenExhausted)
+{
+    NullDeviceDesc desc;
+    desc.fenceLatency = 3;
+    NullDevice device(desc);
+    DescriptorRingAllocator ring(256);
+
+    CHECK(ring.allocate(device, 200) == 0);
+    const uint64_t first = finishFrame(device, ring);
+    CHECK(device.getCompletedFenceValue() < first);
+
+    // Only 56 descriptors left: the ring waits for the first frame and reuses its range
+    CHECK(ring.allocate(device, 100) == 0);
+    CHECK(ring.getWaitCount() == 1);
+    CHECK(device.getCompletedFenceValue() >= first);
+    CHECK(device.getStats().blockingWaitCount == 1);
+}
+
+TEST(ThrowsForTablesLargerThanTheRing)
+{
+    NullDevice device;
+    DescriptorRingAllocator ring(64);
+    CHECK_THROWS(ring.allocate(device, 65));
+    CHECK(ring.allocate(device, 64) == 0);
+}
+
+TEST(NeverHandsOutDescriptorsOfFramesInFlight)
+{
+    NullDeviceDesc desc;
+    desc.fenceLatency = 2;
+    NullDevice device(desc);
+    const uint32_t capacity = 1024;
+    DescriptorRingAllocator ring(capacity);
+    std::map<uint64_t, std::vector<std::pair<uint32_t, uint32_t>>> tablesByFence;
+    std::vector<std::pair<uint32_t, uint32_t>> frameTables;
+    std::mt19937 random(29);
+
+    for (int frame = 0; frame < 5000; ++frame)
+    {
+        frameTables.clear();
+        const int tableCount = 1 + random() % 40;
+        for (int table = 0; table < tableCount; ++table)
+        {
+            const uint32_t count = 1 + random() % 16;
+            const uint32_t offset = ring.allocate(device, count);
+            CHECK(offset + count <= capacity);
+
+            // Everything still pending on the GPU must be disjoint from the new table
+            for (const auto& [fence, tables] : tablesByFence)
+            {
+                if (fence <= device.getCompletedFenceValue())
+                {
+                    continue;
+                }
+                for (const auto& [otherOffset, otherCount] : tables)
+                {
+                    CHECK(offset + count <= otherOffset || otherOffset + otherCount <= offset);
+                }
+            }
+            for (const auto& [otherOffset, otherCount] : frameTables)
+            {
+                CHECK(offset + count <= otherOffset || otherOffset + otherCount <= offset);
+            }
+            frameTables.push_back({ offset, count });
+        }
+
+        tablesByFence[finishFrame(device, ring)] = frameTables;
+        while (!tablesByFence.empty() && tablesByFence.begin()->first <= device.getCompletedFenceValue())
+        {
+            tablesByFence.erase(tablesByFence.begin());
+        }
+    }
+    CHECK(ring.getWaitCount() > 0);
+}
@@ -0,0 +1,196 @@
+#include "TestHarness.h"
+#include "FrameArena.h"
+#include "HeapAllocationCounter.h"
+#include <cstring>
+#include <thread>
+
+using namespace raphael;
+
+namespace
+{
+    bool isAligned(const void* pointer, size_t alignment)
+    {
+        return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+    }
+
+    struct DrawItem
+    {
+        uint64_t sortKey = 0;
+        uint32_t drawIndex = 0;
+    };
+}
+
+TEST(AllocationsAreAlignedAndAdjacent)
+{
+    FrameArena arena(1024);
+
+    char* first = static_cast<char*>(arena.allocate(3, 1));
+    char* second = static_cast<char*>(arena.allocate(5, 1));
+    CHECK(second == first + 3);
+
+    void* aligned = arena.allocate(8, 64);
+    CHECK(isAligned(aligned, 64));
+    CHECK(isAligned(arena.allocateArray<double>(3), alignof(double)));
+    CHECK(arena.getAllocationCount() == 4);
+    CHECK(arena.getUsedSize() <= 3 + 5 + 63 + 8 + 7 + 24);
+    CHECK(arena.getOverflowCount() == 0);
+}
+
+TEST(ResetReusesTheBlock)
+{
+    FrameArena arena(1024);
+
+    void* first = arena.allocate(100);
+    arena.allocate(200);
+    const size_t usedSize = arena.getUsedSize();
+    arena.reset();
+
+    CHECK(arena.getUsedSize() == 0);
+    CHECK(arena.getAllocationCount() == 0);
+    CHECK(arena.getPeakUsedSize() == usedSize);
+    CHECK(arena.allocate(100) == first);
+    CHECK(arena.getCapacity() == 1024);
+}
+
+TEST(OverflowGrowsTheBlockOnReset)
+{
+    FrameArena arena(256);
+
+    std::vector<void*> pointers;
+    for (int i = 0; i < 10; ++i)
+    {
+        pointers.push_back(arena.allocate(100, 16));
+        CHECK(isAligned(pointers.back(), 16));
+    }
+    CHECK(arena.getOverflowCount() > 0);
+    CHECK(arena.getUsedSize() > 256);
+
+    // Overflow memory stays valid until reset
+    for (void* pointer : pointers)
+    {
+        std::memset(pointer, 0xAB, 100);
+    }
+
+    const uint64_t overflowCount = arena.getOverflowCount();
+    arena.reset();
+    CHECK(arena.getCapacity() >= arena.getPeakUsedSize());
+
+    // The same frame fits in one block now
+    for (int i = 0; i < 10; ++i)
+    {
+        arena.allocate(100, 16);
+    }
+    CHECK(arena.getOverflowCount() == overflowCount);
+}
+
+TEST(PmrContainersLiveInTheArena)
+{
+    FrameArena arena(64 * 1024);
+    FrameArenaResource resource(arena);
+
+    std::pmr::vector<DrawItem> drawList(&resource);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        drawList.push_back({ i * 7ull, i });
+    }
+    CHECK(drawList.size() == 1000);
+    CHECK(drawList[999].drawIndex == 999);
+    CHECK(arena.getUsedSize() >= 1000 * sizeof(DrawItem));
+    CHECK(arena.getAllocationCount() > 1); // Growth reallocates inside the arena
+
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(drawList.data());
+    CHECK(arena.getOverflowCount() == 0 && begin != 0);
+}
+
+TEST(PoolResetsOnlyTheFrameBeingStarted)
+{
+    FrameArenaPool pool(3, 2, 1024);
+    CHECK(pool.getFrameCount() == 3);
+    CHECK(pool.getThreadCount() == 2);
+
+    pool.beginFrame(0);
+    pool.getArena(0).allocate(100);
+    pool.getArena(1).allocate(50);
+    CHECK(&pool.getArena(0) != &pool.getArena(1));
+    CHECK(&pool.getResource(1).getArena() == &pool.getArena(1));
+    const size_t frameZeroSize = pool.getUsedSize();
+    CHECK(frameZeroSize >= 150);
+
+    pool.beginFrame(1);
+    CHECK(pool.getUsedSize() == 0);
+    pool.getArena(0).allocate(10);
+
+    // Frame 0 is still untouched until it is started again
+    pool.beginFrame(2);
+    CHECK(pool.getUsedSize() == 0);
+    pool.beginFrame(0);
+    CHECK(pool.getUsedSize() == 0);
+
+    CHECK_THROWS(FrameArenaPool(0, 1));
+    CHECK_THROWS(FrameArenaPool(1, 0));
+}
+
+TEST(CounterSeesHeapAllocations)
+{
+    CHECK(isHeapAllocationCountingEnabled());
+
+    HeapAllocationScope scope(HeapAllocationSource::CurrentThread);
+    const HeapAllocationStats before = getGlobalHeapAllocationStats();
+    int* volatile pointer = new int(5);
+    delete pointer;
+    const HeapAllocationStats after = getGlobalHeapAllocationStats();
+
+    CHECK(scope.getAllocationCount() == 1);
+    CHECK(after.allocationCount - before.allocationCount == 1);
+    CHECK(after.freeCount - before.freeCount == 1);
+    CHECK(after.allocatedBytes - before.allocatedBytes == sizeof(int));
+}
+
+TEST(ThreadCounterIgnoresOtherThreads)
+{
+    HeapAllocationScope threadScope(HeapAllocationSource::CurrentThread);
+    HeapAllocationScope processScope(HeapAllocationSource::Process);
+
+    // Starting the thread allocates on this thread too, only the worker's own allocations must be missing
+    std::thread worker([]
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            int* volatile pointer = new int(i);
+            delete pointer;
+        }
+    });
+    worker.join();
+
+    CHECK(processScope.getAllocationCount() >= threadScope.getAllocationCount() + 10);
+}
+
+TEST(SteadyStateFramesDoNotTouchTheHeap)
+{
+    // Per-thread draw lists and sort keys rebuilt every frame, sized by growth as the demos do
+    FrameArenaPool pool(3, 4, 1024);
+    uint64_t steadyStateAllocations = 0;
+    for (uint32_t frame = 0; frame < 100; ++frame)
+    {
+        pool.beginFrame(frame % pool.getFrameCount());
+
+        HeapAllocationScope scope(HeapAllocationSource::CurrentThread);
+        for (uint32_t thread = 0; thread < pool.getThreadCount(); ++thread)
+        {
+            std::pmr::vector<DrawItem> drawList(&pool.getResource(thread));
+            for (uint32_t i = 0; i < 500; ++i)
+            {
+                drawList.push_back({ i, i });
+            }
+            std::pmr::vector<uint32_t> keys(drawList.size(), 0u, &pool.getResource(thread));
+            CHECK(keys.size() == 500);
+        }
+
+        // The first round of every slot grows its block
+        if (frame >= pool.getFrameCount())
+        {
+            steadyStateAllocations += scope.getAllocationCount();
+        }
+    }
+    CHECK(steadyStateAllocations == 0);
+}
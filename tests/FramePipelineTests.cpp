@@ -0,0 +1,194 @@
+#include "TestHarness.h"
+#include "FramePipeline.h"
+#include <stdexcept>
+#include <vector>
+
+using namespace raphael;
+
+namespace
+{
+    struct Snapshot
+    {
+        uint64_t step = 0;
+        std::vector<uint32_t> visible;
+        double check = 0.0;
+    };
+}
+
+TEST(TripleBufferReaderSeesLatestPublish)
+{
+    TripleBuffer<int> buffer;
+    CHECK(!buffer.acquire());
+    CHECK(!buffer.hasFreshValue());
+
+    buffer.getWriteBuffer() = 1;
+    CHECK(buffer.publish());
+    CHECK(buffer.hasFreshValue());
+    buffer.getWriteBuffer() = 2;
+    CHECK(!buffer.publish()); // 1 was never read
+
+    CHECK(buffer.acquire());
+    CHECK(buffer.getReadBuffer() == 2);
+    CHECK(!buffer.acquire());
+    CHECK(buffer.getReadBuffer() == 2);
+
+    buffer.getWriteBuffer() = 3;
+    CHECK(buffer.publish());
+    CHECK(buffer.acquire());
+    CHECK(buffer.getReadBuffer() == 3);
+}
+
+TEST(TripleBufferInitializeTouchesEverySlot)
+{
+    TripleBuffer<std::vector<int>> buffer;
+    buffer.initialize([](std::vector<int>& slot) { slot.reserve(64); });
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(buffer.getWriteBuffer().capacity() >= 64);
+        buffer.publish();
+        buffer.acquire();
+        CHECK(buffer.getReadBuffer().capacity() >= 64);
+    }
+}
+
+TEST(TripleBufferReaderNeverSeesTornOrOlderValues)
+{
+    struct Pair
+    {
+        uint64_t a = 0;
+        uint64_t b = ~0ull;
+    };
+
+    const uint64_t publishCount = 200000;
+    TripleBuffer<Pair> buffer;
+    std::atomic<bool> done{ false };
+    std::thread writer([&]
+    {
+        for (uint64_t i = 1; i <= publishCount; ++i)
+        {
+            Pair& pair = buffer.getWriteBuffer();
+            pair.a = i;
+            pair.b = ~i;
+            buffer.publish();
+        }
+        done = true;
+    });
+
+    uint64_t last = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    while (!done || buffer.hasFreshValue())
+    {
+        if (buffer.acquire())
+        {
+            const Pair& pair = buffer.getReadBuffer();
+            torn += pair.b != ~pair.a ? 1 : 0;
+            backwards += pair.a <= last ? 1 : 0;
+            last = pair.a;
+        }
+    }
+    writer.join();
+    CHECK(torn == 0);
+    CHECK(backwards == 0);
+    CHECK(last == publishCount);
+}
+
+TEST(PipelineHandsOverEverySnapshotInOrder)
+{
+    uint64_t counter = 0;
+    FramePipeline<Snapshot> pipeline([&counter](Snapshot& snapshot, double)
+    {
+        snapshot.step = ++counter;
+        snapshot.visible.clear();
+        for (uint32_t i = 0; i < counter % 1000; ++i)
+        {
+            snapshot.visible.push_back(i);
+        }
+        snapshot.check = static_cast<double>(snapshot.step) * 2.0;
+    }, [](Snapshot& snapshot) { snapshot.visible.reserve(1024); });
+
+    pipeline.start();
+    CHECK(pipeline.isThreaded());
+    uint64_t last = 0;
+    uint32_t wrong = 0;
+    for (int frame = 0; frame < 5000; ++frame)
+    {
+        // Switches to the serial loop and back halfway, the sequence continues across both
+        if (frame == 2000)
+        {
+            pipeline.stop();
+            CHECK(!pipeline.isThreaded());
+        }
+        if (frame == 3000)
+        {
+            pipeline.start();
+        }
+
+        const Snapshot& snapshot = pipeline.acquire();
+        wrong += snapshot.step != last + 1 ? 1 : 0;
+        wrong += snapshot.visible.size() != snapshot.step % 1000 ? 1 : 0;
+        wrong += snapshot.check != static_cast<double>(snapshot.step) * 2.0 ? 1 : 0;
+        wrong += snapshot.visible.capacity() < 1024 ? 1 : 0;
+        last = snapshot.step;
+    }
+    pipeline.stop();
+    CHECK(wrong == 0);
+
+    const FramePipelineStats stats = pipeline.getStats();
+    CHECK(stats.renderedCount == 5000);
+    CHECK(stats.repeatedCount == 0);
+    // The simulation runs at most one snapshot ahead
+    CHECK(stats.simulatedCount >= 5000 && stats.simulatedCount <= 5002);
+}
+
+TEST(PipelineWithoutWaitingRepeatsTheLastSnapshot)
+{
+    FramePipeline<int> pipeline([](int& snapshot, double) { snapshot++; });
+    CHECK(pipeline.acquire(false) == 1); // Serial, always simulates
+    pipeline.start();
+    const int first = pipeline.acquire(true);
+    CHECK(first >= 1);
+    while (pipeline.acquire(false) == first) {}
+    pipeline.stop();
+    CHECK(pipeline.getStats().renderedCount >= 3);
+}
+
+TEST(PipelineRethrowsSimulationErrors)
+{
+    for (bool threaded : { false, true })
+    {
+        for (int round = 0; round < 50; ++round)
+        {
+            int steps = 0;
+            FramePipeline<int> pipeline([&steps](int& snapshot, double)
+            {
+                if (++steps == 5)
+                {
+                    throw std::runtime_error("Simulation failed");
+                }
+                snapshot = steps;
+            });
+            if (threaded)
+            {
+                pipeline.start();
+            }
+
+            bool threw = false;
+            int lastSeen = 0;
+            try
+            {
+                for (int frame = 0; frame < 100; ++frame)
+                {
+                    lastSeen = pipeline.acquire(frame % 2 == 0);
+                }
+            }
+            catch (const std::runtime_error&)
+            {
+                threw = true;
+            }
+            CHECK(threw);
+            CHECK(lastSeen < 5);
+            CHECK(!pipeline.isThreaded());
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include "TestHarness.h"
+#include "FrameResource.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+using namespace raphael;
+
+namespace
+{
+    // GPU running submitted frames in order, gpuMs each, on a millisecond timeline. Fence value n
+    // completes when frame n finishes.
+    struct SimulatedGpu
+    {
+        double busyUntil = 0.0;
+        std::vector<double> completionTimes; // Indexed by fence value - 1
+
+        uint64_t submit(double submitTime, double gpuMs)
+        {
+            busyUntil = std::max(busyUntil, submitTime) + gpuMs;
+            completionTimes.push_back(busyUntil);
+            return completionTimes.size();
+        }
+
+        uint64_t getCompletedValue(double time) const
+        {
+            uint64_t completed = 0;
+            while (completed < completionTimes.size() && completionTimes[completed] <= time)
+            {
+                completed++;
+            }
+            return completed;
+        }
+
+        double getCompletionTime(uint64_t fenceValue) const { return completionTimes[fenceValue - 1]; }
+    };
+
+    struct SimulationResult
+    {
+        double frameMs = 0.0;
+        double latencyMs = 0.0; // From the start of recording to the GPU finishing the frame
+        uint64_t waitCount = 0;
+        uint32_t unsafeReuseCount = 0; // Slots recorded into while the GPU still used them
+    };
+
+    SimulationResult simulate(uint32_t framesInFlight, double cpuMs, double gpuMs, uint32_t frameCount)
+    {
+        FrameScheduler scheduler(framesInFlight);
+        SimulatedGpu gpu;
+        std::array<uint64_t, MaxFramesInFlight> slotFences = {};
+        SimulationResult result;
+        double time = 0.0;
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            const uint64_t waitValue = scheduler.beginFrame(gpu.getCompletedValue(time));
+            if (waitValue != 0)
+            {
+                time = std::max(time, gpu.getCompletionTime(waitValue));
+            }
+            const uint32_t slot = scheduler.getCurrentSlot();
+            result.unsafeReuseCount += slotFences[slot] > gpu.getCompletedValue(time) ? 1 : 0;
+
+            const double start = time;
+            time += cpuMs;
+            const uint64_t fence = gpu.submit(time, gpuMs);
+            slotFences[slot] = fence;
+            scheduler.endFrame(fence);
+            result.latencyMs += gpu.getCompletionTime(fence) - start;
+        }
+        result.frameMs = time / frameCount;
+        result.latencyMs /= frameCount;
+        result.waitCount = scheduler.getStats().waitCount;
+        return result;
+    }
+
+    bool isNear(double value, double expected) { return value > expected - 0.1 && value < expected + 0.1; }
+}
+
+TEST(SlotsAreNeverReusedWhileTheGpuUsesThem)
+{
+    for (double cpuMs : { 4.0, 10.0, 16.0 })
+    {
+        for (uint32_t framesInFlight = 1; framesInFlight <= MaxFramesInFlight; ++framesInFlight)
+        {
+            const SimulationResult result = simulate(framesInFlight, cpuMs, 10.0, 200);
+            CHECK(result.unsafeReuseCount == 0);
+        }
+    }
+}
+
+TEST(FramesInFlightTradeLatencyForThroughput)
+{
+    // GPU bound: one frame in flight serialises CPU and GPU, two overlap them and the GPU sets the pace
+    const SimulationResult serial = simulate(1, 4.0, 10.0, 200);
+    const SimulationResult overlapped = simulate(2, 4.0, 10.0, 200);
+    const SimulationResult deep = simulate(4, 4.0, 10.0, 200);
+    CHECK(isNear(serial.frameMs, 14.0));
+    CHECK(serial.waitCount >= 199);
+    CHECK(overlapped.frameMs < 10.5);
+    CHECK(deep.frameMs < 10.5);
+    // Deeper queues only add latency once the GPU is the bottleneck
+    CHECK(overlapped.latencyMs < deep.latencyMs);
+
+    // CPU bound: the GPU always catches up, nothing waits past the first frames
+    const SimulationResult cpuBound = simulate(2, 16.0, 10.0, 200);
+    CHECK(isNear(cpuBound.frameMs, 16.0));
+    CHECK(cpuBound.waitCount == 0);
+}
+
+TEST(SchedulerRejectsMisuse)
+{
+    CHECK_THROWS(FrameScheduler(0));
+    CHECK_THROWS(FrameScheduler(MaxFramesInFlight + 1));
+
+    FrameScheduler scheduler(2);
+    scheduler.beginFrame(0);
+    CHECK(scheduler.isInFrame());
+    CHECK_THROWS(scheduler.beginFrame(0));
+    scheduler.endFrame(1);
+    CHECK(!scheduler.isInFrame());
+    CHECK(scheduler.getLastFenceValue() == 1);
+
+    // Only once the GPU has drained every frame
+    CHECK_THROWS(scheduler.setFramesInFlight(3, 0));
+    scheduler.setFramesInFlight(3, 1);
+    CHECK(scheduler.getFramesInFlight() == 3);
+    CHECK(scheduler.beginFrame(1) == 0);
+    CHECK(scheduler.getCurrentSlot() == 0);
+    scheduler.endFrame(2);
+    CHECK(scheduler.getSlotFenceValue(0) == 2);
+}
+
+TEST(FrameResourceFollowsTheCurrentSlot)
+{
+    FrameScheduler scheduler(3);
+    FrameResource<std::unique_ptr<int>> resource;
+    CHECK_THROWS(resource.create(0, [](uint32_t) { return std::make_unique<int>(0); }));
+    CHECK_THROWS(resource.create(MaxFramesInFlight + 1, [](uint32_t) { return std::make_unique<int>(0); }));
+    resource.create(3, [](uint32_t slot) { return std::make_unique<int>(static_cast<int>(slot)); });
+    CHECK(resource.getCount() == 3);
+    CHECK(resource.getAll().size() == 3);
+    CHECK(*resource[2] == 2);
+    CHECK_THROWS(resource[3]);
+
+    uint64_t fence = 0;
+    for (int frame = 0; frame < 7; ++frame)
+    {
+        scheduler.beginFrame(fence);
+        CHECK(*resource.get(scheduler) == frame % 3);
+        scheduler.endFrame(++fence);
+    }
+
+    // Recreating with fewer copies resets the rest
+    resource.create(1, [](uint32_t) { return std::make_unique<int>(7); });
+    CHECK(resource.getCount() == 1);
+    CHECK_THROWS(resource[1]);
+}
@@ -0,0 +1,202 @@
+#include "TestHarness.h"
+#include "CameraMath.h"
+#include "FrustumCulling.h"
+#include "HeapAllocationCounter.h"
+#include "JobSystem.h"
+#include <cstring>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::test;
+
+namespace
+{
+    const float Eye[3] = { 0.0f, 5.0f, -300.0f };
+    const float Target[3] = { 0.0f, 0.0f, 0.0f };
+
+    // Alternating boxes and spheres scattered around the camera, most of them outside the frustum
+    void fillBounds(CullingBounds& bounds, uint32_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> size(0.1f, 4.0f);
+        bounds.clear();
+        bounds.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float center[3] = { position(random), position(random), position(random) };
+            if (i & 1)
+            {
+                bounds.addSphere(center, size(random));
+            }
+            else
+            {
+                const float extents[3] = { size(random), size(random), size(random) };
+                bounds.addBox(center, extents);
+            }
+        }
+    }
+
+    bool isAscending(const std::vector<uint32_t>& indices, uint32_t visibleCount, uint32_t objectCount)
+    {
+        for (uint32_t i = 0; i < visibleCount; ++i)
+        {
+            if (indices[i] >= objectCount || (i > 0 && indices[i] <= indices[i - 1]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST(ExtractedPlanesAreNormalizedAndPointInside)
+{
+    const Matrix4 viewProjection = makeViewProjection(Eye, Target);
+    const Frustum frustum = extractFrustum(viewProjection.m);
+    for (const float* plane : frustum.planes)
+    {
+        const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        CHECK(std::fabs(length - 1.0f) < 1e-4f);
+        // The target sits in front of the camera, inside every plane
+        CHECK(plane[0] * Target[0] + plane[1] * Target[1] + plane[2] * Target[2] + plane[3] > 0.0f);
+    }
+    CHECK(cpuSupportsAvx2() == FrustumCuller().isUsingSimd());
+}
+
+TEST(SimdScalarAndParallelCullsAreIdentical)
+{
+    const Frustum frustum = extractFrustum(makeViewProjection(Eye, Target).m);
+    FrustumCuller culler;
+    JobSystem jobs(3);
+    CullingBounds bounds;
+    for (uint32_t count : { 0u, 1u, 7u, 8u, 1003u, CullingBlockSize + 1, 100000u })
+    {
+        fillBounds(bounds, count, count);
+        CHECK(bounds.getPaddedCount() % 8 == 0);
+        CHECK(bounds.getPaddedCount() >= count);
+        std::vector<uint32_t> scalar(bounds.getPaddedCount() + 1);
+        std::vector<uint32_t> simd(bounds.getPaddedCount() + 1);
+        std::vector<uint32_t> parallel(bounds.getPaddedCount() + 1);
+
+        culler.setSimdEnabled(false);
+        CHECK(!culler.isUsingSimd());
+        const uint32_t scalarCount = culler.cull(frustum, bounds, scalar.data());
+        culler.setSimdEnabled(true);
+        const uint32_t simdCount = culler.cull(frustum, bounds, simd.data());
+        const uint32_t parallelCount = culler.cull(jobs, frustum, bounds, parallel.data());
+
+        CHECK(scalarCount == simdCount);
+        CHECK(scalarCount == parallelCount);
+        CHECK(std::memcmp(scalar.data(), simd.data(), scalarCount * sizeof(uint32_t)) == 0);
+        CHECK(std::memcmp(scalar.data(), parallel.data(), scalarCount * sizeof(uint32_t)) == 0);
+        CHECK(isAscending(scalar, scalarCount, count));
+        CHECK(culler.getStats().testedCount == count);
+        CHECK(culler.getStats().visibleCount == parallelCount);
+        if (count >= 1000)
+        {
+            CHECK(scalarCount > 0 && scalarCount < count);
+        }
+    }
+}
+
+// Checked in clip space against the matrix itself: an object whose center projects inside the view volume
+// must be kept, one whose eight corners are all outside the same clip plane must be culled
+TEST(CullMatchesAClipSpaceReference)
+{
+    const Matrix4 viewProjection = makeViewProjection(Eye, Target);
+    const Frustum frustum = extractFrustum(viewProjection.m);
+    FrustumCuller culler;
+    CullingBounds bounds;
+    const uint32_t count = 100000;
+    fillBounds(bounds, count, 5);
+    std::vector<uint32_t> indices(bounds.getPaddedCount());
+    const uint32_t visibleCount = culler.cull(frustum, bounds, indices.data());
+    std::vector<bool> visible(count, false);
+    for (uint32_t i = 0; i < visibleCount; ++i)
+    {
+        visible[indices[i]] = true;
+    }
+
+    uint32_t mustKeepCount = 0;
+    uint32_t mustCullCount = 0;
+    uint32_t wrongCount = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float radius = bounds.getRadius()[i];
+        const float center[3] = { bounds.getCenterX()[i], bounds.getCenterY()[i], bounds.getCenterZ()[i] };
+        const float extents[3] = { bounds.getExtentX()[i] + radius, bounds.getExtentY()[i] + radius, bounds.getExtentZ()[i] + radius };
+
+        double clip[4];
+        transformToClip(viewProjection, center, clip);
+        if (std::fabs(clip[0]) <= clip[3] && std::fabs(clip[1]) <= clip[3] && clip[2] >= 0.0 && clip[2] <= clip[3])
+        {
+            mustKeepCount++;
+            wrongCount += visible[i] ? 0 : 1;
+        }
+
+        uint32_t outside[6] = {};
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            const float point[3] = {
+                center[0] + ((corner & 1) ? extents[0] : -extents[0]),
+                center[1] + ((corner & 2) ? extents[1] : -extents[1]),
+                center[2] + ((corner & 4) ? extents[2] : -extents[2]),
+            };
+            transformToClip(viewProjection, point, clip);
+            outside[0] += clip[0] < -clip[3] ? 1 : 0;
+            outside[1] += clip[0] > clip[3] ? 1 : 0;
+            outside[2] += clip[1] < -clip[3] ? 1 : 0;
+            outside[3] += clip[1] > clip[3] ? 1 : 0;
+            outside[4] += clip[2] < 0.0 ? 1 : 0;
+            outside[5] += clip[2] > clip[3] ? 1 : 0;
+        }
+        if (std::find(std::begin(outside), std::end(outside), 8u) != std::end(outside))
+        {
+            mustCullCount++;
+            wrongCount += visible[i] ? 1 : 0;
+        }
+    }
+    CHECK(wrongCount == 0);
+    CHECK(mustKeepCount > 0);
+    CHECK(mustCullCount > count / 2);
+}
+
+TEST(UpdatedBoundsAreCulledAgain)
+{
+    const Frustum frustum = extractFrustum(makeViewProjection(Eye, Target).m);
+    FrustumCuller culler;
+    CullingBounds bounds;
+    const float inside[3] = { 0.0f, 0.0f, 0.0f };
+    const float behind[3] = { 0.0f, 0.0f, -600.0f };
+    const float extents[3] = { 1.0f, 1.0f, 1.0f };
+    bounds.addSphere(inside, 1.0f);
+    bounds.addBox(behind, extents);
+    std::vector<uint32_t> indices(bounds.getPaddedCount());
+    CHECK(culler.cull(frustum, bounds, indices.data()) == 1);
+    CHECK(indices[0] == 0);
+
+    bounds.setSphere(0, behind, 1.0f);
+    bounds.setBox(1, inside, extents);
+    CHECK(culler.cull(frustum, bounds, indices.data()) == 1);
+    CHECK(indices[0] == 1);
+}
+
+TEST(SteadyStateCullsDoNotAllocate)
+{
+    const Frustum frustum = extractFrustum(makeViewProjection(Eye, Target).m);
+    FrustumCuller culler;
+    JobSystem jobs(3);
+    CullingBounds bounds;
+    fillBounds(bounds, 50000, 9);
+    std::vector<uint32_t> indices(bounds.getPaddedCount());
+    culler.cull(jobs, frustum, bounds, indices.data());
+
+    HeapAllocationScope scope(HeapAllocationSource::Process);
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        culler.cull(frustum, bounds, indices.data());
+        culler.cull(jobs, frustum, bounds, indices.data());
+    }
+    CHECK(scope.getAllocationCount() == 0);
+}
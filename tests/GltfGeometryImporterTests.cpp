@@ -0,0 +1,333 @@
+#include "TestHarness.h"
+#include "GltfGeometryImporter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+using namespace raphael;
+
+namespace
+{
+    // Builds glTF models in memory, one buffer holding every view
+    class ModelBuilder
+    {
+    public:
+        ModelBuilder() { m_model.buffers.resize(1); }
+
+        int addView(const void* data, size_t sizeInBytes, int byteStride = 0)
+        {
+            std::vector<unsigned char>& buffer = m_model.buffers[0].data;
+            tinygltf::BufferView view;
+            view.buffer = 0;
+            view.byteOffset = buffer.size();
+            view.byteLength = sizeInBytes;
+            view.byteStride = byteStride;
+            buffer.insert(buffer.end(), static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + sizeInBytes);
+            m_model.bufferViews.push_back(view);
+            return static_cast<int>(m_model.bufferViews.size()) - 1;
+        }
+
+        int addAccessor(int view, size_t byteOffset, size_t count, int componentType, int type)
+        {
+            tinygltf::Accessor accessor;
+            accessor.bufferView = view;
+            accessor.byteOffset = byteOffset;
+            accessor.count = count;
+            accessor.componentType = componentType;
+            accessor.type = type;
+            m_model.accessors.push_back(accessor);
+            return static_cast<int>(m_model.accessors.size()) - 1;
+        }
+
+        // Positions, normals and texture coordinates interleaved in one strided view
+        tinygltf::Primitive addInterleavedVertices(const std::vector<ImportedVertex>& vertices)
+        {
+            const int view = addView(vertices.data(), vertices.size() * sizeof(ImportedVertex), sizeof(ImportedVertex));
+            tinygltf::Primitive primitive;
+            primitive.attributes["POSITION"] = addAccessor(view, offsetof(ImportedVertex, position), vertices.size(), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3);
+            primitive.attributes["NORMAL"] = addAccessor(view, offsetof(ImportedVertex, normal), vertices.size(), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3);
+            primitive.attributes["TEXCOORD_0"] = addAccessor(view, offsetof(ImportedVertex, texCoord), vertices.size(), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC2);
+            setBounds(primitive.attributes["POSITION"], vertices);
+            return primitive;
+        }
+
+        // One tightly packed view per attribute
+        tinygltf::Primitive addSeparateVertices(const std::vector<ImportedVertex>& vertices)
+        {
+            std::vector<float> positions;
+            std::vector<float> normals;
+            std::vector<float> texCoords;
+            for (const ImportedVertex& vertex : vertices)
+            {
+                positions.insert(positions.end(), vertex.position, vertex.position + 3);
+                normals.insert(normals.end(), vertex.normal, vertex.normal + 3);
+                texCoords.insert(texCoords.end(), vertex.texCoord, vertex.texCoord + 2);
+            }
+            tinygltf::Primitive primitive;
+            primitive.attributes["POSITION"] = addAccessor(addView(positions.data(), positions.size() * sizeof(float)), 0, vertices.size(), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3);
+            primitive.attributes["NORMAL"] = addAccessor(addView(normals.data(), normals.size() * sizeof(float)), 0, vertices.size(), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3);
+            primitive.attributes["TEXCOORD_0"] = addAccessor(addView(texCoords.data(), texCoords.size() * sizeof(float)), 0, vertices.size(), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC2);
+            setBounds(primitive.attributes["POSITION"], vertices);
+            return primitive;
+        }
+
+        template<typename Index>
+        int addIndices(const std::vector<uint32_t>& indices, int componentType)
+        {
+            std::vector<Index> converted(indices.begin(), indices.end());
+            return addAccessor(addView(converted.data(), converted.size() * sizeof(Index)), 0, indices.size(), componentType, TINYGLTF_TYPE_SCALAR);
+        }
+
+        void addMesh(const std::vector<tinygltf::Primitive>& primitives)
+        {
+            tinygltf::Mesh mesh;
+            mesh.primitives = primitives;
+            m_model.meshes.push_back(mesh);
+        }
+
+        tinygltf::Model& getModel() { return m_model; }
+
+    private:
+        void setBounds(int accessor, const std::vector<ImportedVertex>& vertices)
+        {
+            std::vector<double>& minValues = m_model.accessors[accessor].minValues;
+            std::vector<double>& maxValues = m_model.accessors[accessor].maxValues;
+            minValues.assign(3, 1e30);
+            maxValues.assign(3, -1e30);
+            for (const ImportedVertex& vertex : vertices)
+            {
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    minValues[axis] = std::min<double>(minValues[axis], vertex.position[axis]);
+                    maxValues[axis] = std::max<double>(maxValues[axis], vertex.position[axis]);
+                }
+            }
+        }
+
+    private:
+        tinygltf::Model m_model;
+    };
+
+    // Unit sphere of (rows + 1) * (columns + 1) vertices
+    void makeSphere(uint32_t rows, uint32_t columns, std::vector<ImportedVertex>& outVertices, std::vector<uint32_t>& outIndices)
+    {
+        outVertices.clear();
+        outIndices.clear();
+        for (uint32_t row = 0; row <= rows; ++row)
+        {
+            for (uint32_t column = 0; column <= columns; ++column)
+            {
+                const float theta = 3.14159265f * row / rows;
+                const float phi = 6.2831853f * column / columns;
+                ImportedVertex vertex;
+                vertex.position[0] = std::sin(theta) * std::cos(phi);
+                vertex.position[1] = std::cos(theta);
+                vertex.position[2] = std::sin(theta) * std::sin(phi);
+                std::memcpy(vertex.normal, vertex.position, sizeof(vertex.normal));
+                vertex.texCoord[0] = static_cast<float>(column) / columns;
+                vertex.texCoord[1] = static_cast<float>(row) / rows;
+                outVertices.push_back(vertex);
+            }
+        }
+        for (uint32_t row = 0; row < rows; ++row)
+        {
+            for (uint32_t column = 0; column < columns; ++column)
+            {
+                const uint32_t a = row * (columns + 1) + column;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + columns + 1;
+                const uint32_t d = c + 1;
+                outIndices.insert(outIndices.end(), { a, c, b, b, c, d });
+            }
+        }
+    }
+
+    bool sameVertex(const ImportedVertex& a, const ImportedVertex& b)
+    {
+        return std::memcmp(&a, &b, sizeof(ImportedVertex)) == 0;
+    }
+}
+
+TEST(LayoutComesFromAccessorCounts)
+{
+    std::vector<ImportedVertex> sphere;
+    std::vector<uint32_t> sphereIndices;
+    makeSphere(4, 8, sphere, sphereIndices);
+
+    ModelBuilder builder;
+    tinygltf::Primitive first = builder.addInterleavedVertices(sphere);
+    first.indices = builder.addIndices<uint16_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+    first.material = 3;
+    tinygltf::Primitive second = builder.addSeparateVertices(sphere);
+    second.indices = builder.addIndices<uint16_t>(std::vector<uint32_t>(sphereIndices.begin(), sphereIndices.begin() + 12), TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+    builder.addMesh({ first });
+    builder.addMesh({ second });
+
+    GltfGeometryImporter importer(builder.getModel());
+    const GltfGeometryLayout& layout = importer.getLayout();
+    CHECK(layout.primitives.size() == 2);
+    CHECK(layout.vertexCount == 2 * sphere.size());
+    CHECK(layout.indexCount == sphereIndices.size() + 12);
+    CHECK(layout.lodIndexCount == 0);
+    CHECK(layout.primitives[1].vertexOffset == sphere.size());
+    CHECK(layout.primitives[1].indexOffset == sphereIndices.size());
+    CHECK(layout.primitives[0].materialIndex == 3);
+    CHECK(layout.primitives[1].materialIndex == -1);
+    CHECK(layout.primitives[0].boundsMin[1] == -1.0f);
+    CHECK(layout.primitives[0].boundsMax[1] == 1.0f);
+    CHECK(layout.getVertexBufferSize() == layout.vertexCount * sizeof(ImportedVertex));
+    CHECK(layout.getIndexBufferSize() == layout.indexCount * sizeof(uint16_t));
+    CHECK(importer.getLevelsOfDetail().empty());
+}
+
+TEST(DecodeMatchesThePerAttributeCopy)
+{
+    // Every index type and both vertex layouts, against copying each attribute element by element
+    std::vector<ImportedVertex> sphere;
+    std::vector<uint32_t> sphereIndices;
+    makeSphere(6, 12, sphere, sphereIndices);
+
+    ModelBuilder builder;
+    std::vector<tinygltf::Primitive> primitives;
+    primitives.push_back(builder.addInterleavedVertices(sphere));
+    primitives.back().indices = builder.addIndices<uint8_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE);
+    primitives.push_back(builder.addSeparateVertices(sphere));
+    primitives.back().indices = builder.addIndices<uint16_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+    primitives.push_back(builder.addInterleavedVertices(sphere));
+    primitives.back().indices = builder.addIndices<uint32_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT);
+    builder.addMesh(primitives);
+
+    GltfGeometryImporter importer(builder.getModel());
+    const GltfGeometryLayout& layout = importer.getLayout();
+    std::vector<ImportedVertex> vertices(layout.vertexCount);
+    std::vector<uint16_t> indices(layout.getIndexBufferSize() / sizeof(uint16_t));
+    importer.decodeVertices(vertices.data());
+    importer.decodeIndices(indices.data());
+
+    for (size_t p = 0; p < layout.primitives.size(); ++p)
+    {
+        const GltfPrimitiveRange& range = layout.primitives[p];
+        for (uint32_t i = 0; i < range.vertexCount; ++i)
+        {
+            CHECK(sameVertex(vertices[range.vertexOffset + i], sphere[i]));
+        }
+        for (uint32_t i = 0; i < range.indexCount; ++i)
+        {
+            CHECK(indices[range.indexOffset + i] == sphereIndices[i]);
+        }
+    }
+}
+
+TEST(InvalidPrimitivesThrow)
+{
+    std::vector<ImportedVertex> sphere;
+    std::vector<uint32_t> sphereIndices;
+    makeSphere(2, 4, sphere, sphereIndices);
+
+    {
+        ModelBuilder builder;
+        builder.addMesh({ builder.addSeparateVertices(sphere) }); // No indices
+        CHECK_THROWS(GltfGeometryImporter(builder.getModel()));
+    }
+    {
+        ModelBuilder builder;
+        tinygltf::Primitive primitive = builder.addSeparateVertices(sphere);
+        primitive.indices = builder.addIndices<uint16_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+        primitive.attributes.erase("NORMAL");
+        builder.addMesh({ primitive });
+        CHECK_THROWS(GltfGeometryImporter(builder.getModel()));
+    }
+    {
+        ModelBuilder builder;
+        tinygltf::Primitive primitive = builder.addSeparateVertices(sphere);
+        primitive.indices = builder.addIndices<uint16_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+        builder.getModel().accessors[primitive.attributes["POSITION"]].minValues.clear();
+        builder.addMesh({ primitive });
+        CHECK_THROWS(GltfGeometryImporter(builder.getModel()));
+    }
+    {
+        ModelBuilder builder;
+        tinygltf::Primitive primitive = builder.addSeparateVertices(sphere);
+        primitive.indices = builder.addIndices<uint16_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+        builder.getModel().accessors[primitive.attributes["TEXCOORD_0"]].count = sphere.size() - 1;
+        builder.addMesh({ primitive });
+        CHECK_THROWS(GltfGeometryImporter(builder.getModel()));
+    }
+    {
+        ModelBuilder builder;
+        tinygltf::Primitive primitive = builder.addSeparateVertices(sphere);
+        primitive.indices = builder.addIndices<float>(sphereIndices, TINYGLTF_COMPONENT_TYPE_FLOAT);
+        builder.addMesh({ primitive });
+        GltfGeometryImporter importer(builder.getModel());
+        std::vector<uint16_t> indices(importer.getLayout().indexCount);
+        CHECK_THROWS(importer.decodeIndices(indices.data()));
+        CHECK_THROWS(importer.planLevelsOfDetail(0));
+        CHECK_THROWS(importer.planLevelsOfDetail(MaxLodLevels + 1));
+    }
+}
+
+TEST(LevelsOfDetailMatchClusteringTheDecodedVertices)
+{
+    std::vector<ImportedVertex> sphere;
+    std::vector<uint32_t> sphereIndices;
+    makeSphere(64, 128, sphere, sphereIndices);
+
+    ModelBuilder builder;
+    tinygltf::Primitive interleaved = builder.addInterleavedVertices(sphere);
+    interleaved.indices = builder.addIndices<uint16_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+    tinygltf::Primitive separate = builder.addSeparateVertices(sphere);
+    separate.indices = builder.addIndices<uint32_t>(sphereIndices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT);
+    builder.addMesh({ interleaved, separate });
+
+    const uint32_t levelCount = 4;
+    GltfGeometryImporter importer(builder.getModel());
+    importer.planLevelsOfDetail(levelCount);
+    const GltfGeometryLayout& layout = importer.getLayout();
+    CHECK(layout.lodIndexCount > 0);
+
+    const uint16_t unwritten = 0xDEAD;
+    std::vector<ImportedVertex> vertices(layout.vertexCount);
+    std::vector<uint16_t> indices(layout.getIndexBufferSize() / sizeof(uint16_t), unwritten);
+    importer.decodeVertices(vertices.data());
+    importer.decodeIndices(indices.data());
+    for (uint16_t index : indices)
+    {
+        CHECK(index != unwritten);
+    }
+
+    const std::vector<GltfPrimitiveLods>& lods = importer.getLevelsOfDetail();
+    CHECK(lods.size() == layout.primitives.size());
+    for (size_t p = 0; p < lods.size(); ++p)
+    {
+        const GltfPrimitiveRange& range = layout.primitives[p];
+        CHECK(lods[p].table.levelCount == levelCount);
+        CHECK(lods[p].indexOffset[0] == range.indexOffset);
+        CHECK(lods[p].indexCount[0] == range.indexCount);
+
+        const std::vector<uint32_t> fullDetail(indices.begin() + range.indexOffset, indices.begin() + range.indexOffset + range.indexCount);
+        std::vector<uint32_t> reference;
+        for (uint32_t level = 1; level < levelCount; ++level)
+        {
+            CHECK(lods[p].indexCount[level] < lods[p].indexCount[level - 1]);
+            CHECK(lods[p].table.geometricError[level] >= lods[p].table.geometricError[level - 1]);
+
+            // The same cell size as the importer: 1/64 of the bounding radius, doubling per level
+            const float cellSize = std::sqrt(3.0f) * static_cast<float>(1u << level) / 64.0f;
+            simplifyByClustering(vertices[range.vertexOffset].position, sizeof(ImportedVertex), range.vertexCount,
+                fullDetail.data(), static_cast<uint32_t>(fullDetail.size()), cellSize, reference);
+            CHECK(reference.size() == lods[p].indexCount[level]);
+            if (reference.size() == lods[p].indexCount[level])
+            {
+                CHECK(std::equal(reference.begin(), reference.end(), indices.begin() + lods[p].indexOffset[level]));
+            }
+        }
+    }
+
+    // Valid tables for the selector
+    LodSelector selector;
+    for (const GltfPrimitiveLods& primitiveLods : lods)
+    {
+        selector.addTable(primitiveLods.table);
+    }
+}
@@ -0,0 +1,151 @@
+#include "TestHarness.h"
+#include "InstancePacking.h"
+#include "JobSystem.h"
+#include <cstring>
+#include <random>
+
+using namespace raphael;
+
+namespace
+{
+    std::vector<float> makePositions(uint32_t count)
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+        std::vector<float> positions(count * 4ull);
+        for (float& value : positions)
+        {
+            value = distribution(random);
+        }
+        return positions;
+    }
+
+    InstanceTransform makeTranslation(const float* position, float scale)
+    {
+        return { { { scale, 0.0f, 0.0f, position[0] }, { 0.0f, scale, 0.0f, position[1] }, { 0.0f, 0.0f, scale, position[2] } } };
+    }
+
+    // count transforms at offset bytes past a 64-byte boundary, to cover both the streaming and the unaligned path
+    InstanceTransform* getOutput(std::vector<std::byte>& storage, uint32_t count, size_t offset)
+    {
+        storage.assign(count * sizeof(InstanceTransform) + 64 + offset, std::byte{ 0 });
+        const uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+        return reinterpret_cast<InstanceTransform*>(((address + 63) & ~uintptr_t(63)) + offset);
+    }
+
+    bool matches(const InstanceTransform* transforms, const std::vector<InstanceTransform>& expected)
+    {
+        return std::memcmp(transforms, expected.data(), expected.size() * sizeof(InstanceTransform)) == 0;
+    }
+}
+
+TEST(TranslationsMatchTheScalarLayout)
+{
+    const std::vector<float> positions = makePositions(1000);
+    std::vector<std::byte> storage;
+    for (uint32_t count : { 0u, 1u, 3u, 7u, 64u, 1000u })
+    {
+        std::vector<InstanceTransform> expected(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            expected[i] = makeTranslation(&positions[i * 4ull], 1.5f);
+        }
+        for (size_t offset : { size_t(0), size_t(4), size_t(16) })
+        {
+            InstanceTransform* output = getOutput(storage, count, offset);
+            packInstanceTranslations(positions.data(), count, 1.5f, output);
+            CHECK(matches(output, expected));
+        }
+    }
+}
+
+TEST(GatheredTranslationsFollowTheIndices)
+{
+    const std::vector<float> positions = makePositions(1000);
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 1000; i += 3)
+    {
+        indices.push_back(999 - i);
+    }
+    std::vector<InstanceTransform> expected;
+    for (uint32_t index : indices)
+    {
+        expected.push_back(makeTranslation(&positions[index * 4ull], 2.0f));
+    }
+
+    std::vector<std::byte> storage;
+    const uint32_t count = static_cast<uint32_t>(indices.size());
+    for (size_t offset : { size_t(0), size_t(4) })
+    {
+        InstanceTransform* output = getOutput(storage, count, offset);
+        packInstanceTranslations(positions.data(), indices.data(), count, 2.0f, output);
+        CHECK(matches(output, expected));
+    }
+}
+
+TEST(MatricesAreTransposedToRows)
+{
+    // Row-vector matrices with the translation in the last row and one off-diagonal term
+    const std::vector<float> positions = makePositions(1000);
+    std::vector<float> matrices(16 * 1000, 0.0f);
+    std::vector<InstanceTransform> expected(1000);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        float* matrix = &matrices[i * 16];
+        matrix[0] = matrix[5] = matrix[10] = 1.5f;
+        matrix[1] = 0.25f;
+        matrix[15] = 1.0f;
+        matrix[12] = positions[i * 4];
+        matrix[13] = positions[i * 4 + 1];
+        matrix[14] = positions[i * 4 + 2];
+        expected[i] = makeTranslation(&positions[i * 4], 1.5f);
+        expected[i].rows[1][0] = 0.25f;
+    }
+
+    std::vector<std::byte> storage;
+    for (size_t offset : { size_t(0), size_t(4) })
+    {
+        InstanceTransform* output = getOutput(storage, 1000, offset);
+        packInstanceMatrices(matrices.data(), 1000, output);
+        CHECK(matches(output, expected));
+    }
+}
+
+TEST(JobSystemVariantsMatchTheSerialOnes)
+{
+    // Several grains plus a partial one
+    const uint32_t count = InstancePackingGrain * 5 + 123;
+    const std::vector<float> positions = makePositions(count);
+    std::vector<uint32_t> indices(count);
+    std::vector<float> matrices(count * 16ull, 0.0f);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        indices[i] = (i * 7919) % count;
+        float* matrix = &matrices[i * 16ull];
+        matrix[0] = matrix[5] = matrix[10] = matrix[15] = 1.0f;
+        matrix[12] = positions[i * 4ull];
+    }
+
+    JobSystem jobs(3);
+    std::vector<std::byte> serialStorage;
+    std::vector<std::byte> parallelStorage;
+    InstanceTransform* serial = getOutput(serialStorage, count, 0);
+    InstanceTransform* parallel = getOutput(parallelStorage, count, 0);
+    const size_t size = count * sizeof(InstanceTransform);
+
+    packInstanceTranslations(positions.data(), count, 1.5f, serial);
+    packInstanceTranslations(jobs, positions.data(), count, 1.5f, parallel);
+    CHECK(std::memcmp(serial, parallel, size) == 0);
+
+    packInstanceTranslations(positions.data(), indices.data(), count, 1.5f, serial);
+    packInstanceTranslations(jobs, positions.data(), indices.data(), count, 1.5f, parallel);
+    CHECK(std::memcmp(serial, parallel, size) == 0);
+
+    packInstanceMatrices(matrices.data(), count, serial);
+    packInstanceMatrices(jobs, matrices.data(), count, parallel);
+    CHECK(std::memcmp(serial, parallel, size) == 0);
+
+    // Nothing to pack is not an error
+    packInstanceTranslations(jobs, positions.data(), 0, 1.5f, parallel);
+    packInstanceMatrices(jobs, matrices.data(), 0, parallel);
+}
@@ -0,0 +1,335 @@
+#include "TestHarness.h"
+#include "HeapAllocationCounter.h"
+#include "JobSystem.h"
+#include <memory>
+
+using namespace raphael;
+
+namespace
+{
+    // Worker counts that cover a lone worker and more threads than this machine may have
+    constexpr uint32_t WorkerCounts[] = { 1, 3, 7 };
+}
+
+TEST(DequeOwnerIsLifoAndThievesAreFifo)
+{
+    int items[4] = { 0, 1, 2, 3 };
+    WorkStealingDeque<int*> deque(4);
+    CHECK(deque.isEmpty());
+    for (int& item : items)
+    {
+        CHECK(deque.push(&item));
+    }
+    CHECK(!deque.push(&items[0])); // Full
+
+    CHECK(deque.steal() == &items[0]);
+    CHECK(deque.pop() == &items[3]);
+    CHECK(deque.steal() == &items[1]);
+    CHECK(deque.pop() == &items[2]);
+    CHECK(deque.pop() == nullptr);
+    CHECK(deque.steal() == nullptr);
+    CHECK(deque.isEmpty());
+
+    // Indices keep growing past the capacity
+    for (int round = 0; round < 10; ++round)
+    {
+        CHECK(deque.push(&items[round % 4]));
+        CHECK(deque.pop() == &items[round % 4]);
+    }
+
+    CHECK_THROWS(WorkStealingDeque<int*>(3));
+    CHECK_THROWS(WorkStealingDeque<int*>(0));
+}
+
+TEST(DequeHandsOutEveryItemOnceUnderContention)
+{
+    const uint32_t itemCount = 200000;
+    std::vector<uint32_t> items(itemCount);
+    std::unique_ptr<std::atomic<uint32_t>[]> taken(new std::atomic<uint32_t>[itemCount]);
+    for (uint32_t i = 0; i < itemCount; ++i)
+    {
+        items[i] = i;
+        taken[i] = 0;
+    }
+
+    WorkStealingDeque<uint32_t*> deque(1024);
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t)
+    {
+        thieves.emplace_back([&]
+        {
+            while (!done.load())
+            {
+                if (uint32_t* item = deque.steal())
+                {
+                    taken[*item]++;
+                }
+            }
+        });
+    }
+
+    for (uint32_t i = 0; i < itemCount; ++i)
+    {
+        while (!deque.push(&items[i]))
+        {
+            if (uint32_t* item = deque.pop())
+            {
+                taken[*item]++;
+            }
+        }
+        if (i % 3 == 0)
+        {
+            if (uint32_t* item = deque.pop())
+            {
+                taken[*item]++;
+            }
+        }
+    }
+    while (uint32_t* item = deque.pop())
+    {
+        taken[*item]++;
+    }
+    // The owner can lose the last item to a thief and see an empty deque, wait for the thieves to settle
+    done = true;
+    for (std::thread& thief : thieves)
+    {
+        thief.join();
+    }
+    while (uint32_t* item = deque.steal())
+    {
+        taken[*item]++;
+    }
+
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < itemCount; ++i)
+    {
+        wrong += taken[i] != 1 ? 1 : 0;
+    }
+    CHECK(wrong == 0);
+}
+
+TEST(CountersWaitForEveryJob)
+{
+    for (uint32_t workerCount : WorkerCounts)
+    {
+        JobSystem jobs(workerCount, 256);
+        CHECK(jobs.getWorkerCount() == workerCount);
+        CHECK(jobs.getThreadCount() == workerCount + 1);
+
+        std::atomic<int> count{ 0 };
+        JobCounter counter;
+        CHECK(counter.isDone());
+        for (int i = 0; i < 10000; ++i)
+        {
+            jobs.run([&count] { count.fetch_add(1); }, &counter);
+        }
+        jobs.wait(counter);
+        CHECK(count == 10000);
+        CHECK(counter.isDone());
+
+        // Reusable once back at zero
+        jobs.run([&count] { count.fetch_add(1); }, &counter);
+        jobs.wait(counter);
+        CHECK(count == 10001);
+    }
+}
+
+TEST(DependentJobsStartAfterTheirCounter)
+{
+    for (uint32_t workerCount : WorkerCounts)
+    {
+        JobSystem jobs(workerCount, 256);
+        std::atomic<int> stage{ 0 };
+        std::atomic<int> fanned{ 0 };
+        std::atomic<int> early{ 0 };
+        JobCounter first;
+        JobCounter fan;
+        JobCounter last;
+
+        jobs.run([&stage]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            stage = 1;
+        }, &first);
+        for (int i = 0; i < 200; ++i)
+        {
+            jobs.runAfter(first, [&]
+            {
+                early += stage.load() < 1 ? 1 : 0;
+                fanned.fetch_add(1);
+            }, &fan);
+        }
+        jobs.runAfter(fan, [&]
+        {
+            early += fanned.load() != 200 ? 1 : 0;
+            stage = 2;
+        }, &last);
+        jobs.wait(last);
+        CHECK(stage == 2);
+        CHECK(early == 0);
+
+        // A dependency that is already done starts the job right away
+        JobCounter idle;
+        jobs.runAfter(idle, [&stage] { stage = 3; }, &last);
+        jobs.wait(last);
+        CHECK(stage == 3);
+    }
+}
+
+// Each round's counters take the same stack slots as the last round's, which may still be finishing on a
+// worker. A dependent must never start because an earlier counter at its dependency's address reached zero.
+TEST(ReusedCountersOnlyReleaseTheirOwnDependents)
+{
+    for (uint32_t workerCount : WorkerCounts)
+    {
+        JobSystem jobs(workerCount, 256);
+        std::atomic<int> done{ 0 };
+        std::atomic<int> early{ 0 };
+        for (int round = 0; round < 10000; ++round)
+        {
+            JobCounter dependency;
+            JobCounter dependents;
+            done = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                jobs.run([&done, round]
+                {
+                    if (round % 3 == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    done.fetch_add(1);
+                }, &dependency);
+            }
+            for (int i = 0; i < 2; ++i)
+            {
+                jobs.runAfter(dependency, [&done, &early] { early += done.load() != 4 ? 1 : 0; }, &dependents);
+            }
+            jobs.wait(dependents);
+        }
+        CHECK(early == 0);
+    }
+}
+
+TEST(ParallelForCoversTheRangeOnce)
+{
+    for (uint32_t workerCount : WorkerCounts)
+    {
+        JobSystem jobs(workerCount, 256);
+        std::vector<uint32_t> values(100000, 0);
+        jobs.parallelFor(static_cast<uint32_t>(values.size()), 16, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                values[i] += i % 7;
+            }
+        });
+
+        // Nested: each outer item runs its own parallelFor over 100 values
+        jobs.parallelFor(64, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t outer = begin; outer < end; ++outer)
+            {
+                jobs.parallelFor(100, 4, [&values, outer](uint32_t innerBegin, uint32_t innerEnd)
+                {
+                    for (uint32_t i = innerBegin; i < innerEnd; ++i)
+                    {
+                        values[outer * 100 + i] += 1;
+                    }
+                });
+            }
+        });
+
+        uint32_t wrong = 0;
+        for (uint32_t i = 0; i < values.size(); ++i)
+        {
+            wrong += values[i] != i % 7 + (i < 6400 ? 1 : 0) ? 1 : 0;
+        }
+        CHECK(wrong == 0);
+
+        bool calledForEmpty = false;
+        jobs.parallelFor(0, 1, [&](uint32_t, uint32_t) { calledForEmpty = true; });
+        CHECK(!calledForEmpty);
+    }
+}
+
+TEST(ThreadIndicesAndOwnership)
+{
+    JobSystem jobs(3, 256);
+    CHECK(jobs.getCurrentThreadIndex() == 0);
+
+    std::vector<std::atomic<int>> perThread(jobs.getThreadCount());
+    std::atomic<int> outOfRange{ 0 };
+    jobs.parallelFor(1000, 1, [&](uint32_t begin, uint32_t end)
+    {
+        const uint32_t index = jobs.getCurrentThreadIndex();
+        if (index < perThread.size())
+        {
+            perThread[index] += static_cast<int>(end - begin);
+        }
+        else
+        {
+            outOfRange++;
+        }
+    });
+    int total = 0;
+    for (const std::atomic<int>& count : perThread)
+    {
+        total += count;
+    }
+    CHECK(total == 1000);
+    CHECK(outOfRange == 0);
+
+    bool threw = false;
+    std::thread([&]
+    {
+        try
+        {
+            jobs.run([] {});
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+    }).join();
+    CHECK(threw);
+    CHECK_THROWS(JobSystem(1, 100));
+}
+
+TEST(FullRingRunsJobsInline)
+{
+    JobSystem jobs(1, 16);
+    std::atomic<int> count{ 0 };
+    JobCounter counter;
+    for (int i = 0; i < 1000; ++i)
+    {
+        jobs.run([&count]
+        {
+            count.fetch_add(1);
+        }, &counter);
+    }
+    jobs.wait(counter);
+    CHECK(count == 1000);
+    CHECK(jobs.getStats().executedCount + jobs.getStats().inlineCount >= 1000);
+}
+
+TEST(RunningJobsDoesNotAllocate)
+{
+    JobSystem jobs(3, 1024);
+    std::atomic<uint64_t> sum{ 0 };
+    jobs.parallelFor(1000, 1, [&](uint32_t begin, uint32_t) { sum += begin; });
+
+    HeapAllocationScope scope(HeapAllocationSource::Process);
+    for (int round = 0; round < 100; ++round)
+    {
+        JobCounter counter;
+        for (int i = 0; i < 100; ++i)
+        {
+            jobs.run([&sum, i] { sum += i; }, &counter);
+        }
+        jobs.wait(counter);
+        jobs.parallelFor(1000, 8, [&](uint32_t begin, uint32_t end) { sum += end - begin; });
+    }
+    CHECK(scope.getAllocationCount() == 0);
+}
@@ -0,0 +1,242 @@
+#include "TestHarness.h"
+#include "CameraMath.h"
+#include "HeapAllocationCounter.h"
+#include "JobSystem.h"
+#include "LevelOfDetail.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::test;
+
+namespace
+{
+    // Three tables, four levels, three with a duplicated error and a single level, used 60/30/10
+    void fillSelector(LodSelector& selector, uint32_t count, uint32_t seed)
+    {
+        LodTable fourLevels;
+        fourLevels.levelCount = 4;
+        fourLevels.geometricError[1] = 0.01f;
+        fourLevels.geometricError[2] = 0.04f;
+        fourLevels.geometricError[3] = 0.2f;
+        LodTable threeLevels;
+        threeLevels.levelCount = 3;
+        threeLevels.geometricError[1] = 0.05f;
+        threeLevels.geometricError[2] = 0.05f;
+        selector.addTable(fourLevels);
+        selector.addTable(threeLevels);
+        selector.addTable(LodTable());
+
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> radius(0.1f, 3.0f);
+        selector.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float center[3] = { position(random), position(random) * 0.1f, position(random) };
+            const uint32_t table = random() % 10 < 6 ? 0 : (random() % 4 != 0 ? 1 : 2);
+            selector.addInstance(table, center, radius(random));
+        }
+    }
+
+    bool isSameSelection(const LodSelector& a, const LodSelector& b)
+    {
+        const uint32_t count = a.getInstanceCount();
+        return std::memcmp(a.getLevels(), b.getLevels(), count) == 0 && std::memcmp(a.getPreviousLevels(), b.getPreviousLevels(), count) == 0 &&
+            std::memcmp(a.getFades(), b.getFades(), count * sizeof(float)) == 0 && a.getStats().switchCount == b.getStats().switchCount &&
+            a.getStats().fadingCount == b.getStats().fadingCount;
+    }
+
+    // Camera sweeping around and through the instances
+    LodView makeView(int frame)
+    {
+        const Matrix4 projection = perspectiveFovLH(0.785398f, 16.0f / 9.0f, 1.0f, 1000.0f);
+        const float t = frame * 0.02f;
+        const float eye[3] = { 400.0f * std::cos(t), 5.0f + 20.0f * std::sin(t * 3.0f), 400.0f * std::sin(t * 0.7f) };
+        return makeLodView(eye, projection.m, 720.0f);
+    }
+
+    LodView makeViewAt(float distance)
+    {
+        LodView view;
+        view.eye[0] = distance;
+        view.projectionScale = 1.0f;
+        return view;
+    }
+}
+
+TEST(SelectionFollowsErrorHysteresisAndFades)
+{
+    LodSelector selector;
+    LodTable table;
+    table.levelCount = 3;
+    table.geometricError[1] = 1.0f;
+    table.geometricError[2] = 4.0f;
+    selector.addTable(table);
+    const float center[3] = { 0.0f, 0.0f, 0.0f };
+    selector.addInstance(0, center, 0.0f);
+    LodSettings settings;
+    settings.pixelError = 1.0f;
+    settings.hysteresis = 0.25f;
+    settings.fadeSeconds = 1.0f;
+    selector.setSettings(settings);
+
+    // A new instance takes its level without fading
+    selector.select(makeViewAt(2.0f), 0.1f);
+    CHECK(selector.getLevels()[0] == 1);
+    CHECK(selector.getFades()[0] == 1.0f);
+    CHECK(selector.getPreviousLevels()[0] == 1);
+    CHECK(selector.getStats().switchCount == 0);
+
+    // Level 2 fits at 4.5 but not within the hysteresis band, 4 > 4.5 * 0.75
+    selector.select(makeViewAt(4.5f), 0.1f);
+    CHECK(selector.getLevels()[0] == 1);
+
+    // Coarsens at 5.5, the fade starts one step in
+    selector.select(makeViewAt(5.5f), 0.25f);
+    CHECK(selector.getLevels()[0] == 2);
+    CHECK(selector.getPreviousLevels()[0] == 1);
+    CHECK(std::fabs(selector.getFades()[0] - 0.25f) < 1e-6f);
+    CHECK(selector.getStats().switchCount == 1);
+    selector.select(makeViewAt(5.5f), 0.25f);
+    CHECK(std::fabs(selector.getFades()[0] - 0.5f) < 1e-6f);
+    CHECK(selector.getStats().fadingCount == 1);
+
+    // Refining mid fade reverses it from where it was
+    selector.select(makeViewAt(3.5f), 0.25f);
+    CHECK(selector.getLevels()[0] == 1);
+    CHECK(selector.getPreviousLevels()[0] == 2);
+    CHECK(std::fabs(selector.getFades()[0] - 0.75f) < 1e-6f);
+    selector.select(makeViewAt(3.5f), 0.25f);
+    CHECK(selector.getFades()[0] == 1.0f);
+    CHECK(selector.getPreviousLevels()[0] == 1);
+    CHECK(selector.getStats().fadingCount == 0);
+
+    // Refines as soon as the error shows, coarsens only past the band
+    selector.select(makeViewAt(0.9f), 0.25f);
+    CHECK(selector.getLevels()[0] == 0);
+    selector.select(makeViewAt(1.2f), 1.0f);
+    CHECK(selector.getLevels()[0] == 0);
+    selector.select(makeViewAt(1.4f), 1.0f);
+    CHECK(selector.getLevels()[0] == 1);
+
+    // Full detail with the camera inside the bounds
+    selector.select(makeViewAt(0.0f), 1.0f);
+    CHECK(selector.getLevels()[0] == 0);
+
+    LodTable decreasing;
+    decreasing.levelCount = 2;
+    decreasing.geometricError[0] = 1.0f;
+    decreasing.geometricError[1] = 0.5f;
+    CHECK_THROWS(selector.addTable(decreasing));
+    CHECK_THROWS(selector.addInstance(5, center, 1.0f));
+}
+
+TEST(ClusteringStaysWithinItsErrorBound)
+{
+    // Unit sphere grid, 20 byte vertices
+    const uint32_t rows = 64;
+    const uint32_t columns = 128;
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    for (uint32_t row = 0; row <= rows; ++row)
+    {
+        for (uint32_t column = 0; column <= columns; ++column)
+        {
+            const float theta = 3.14159265f * row / rows;
+            const float phi = 6.2831853f * column / columns;
+            positions.insert(positions.end(), { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi), 0.0f, 0.0f });
+        }
+    }
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        for (uint32_t column = 0; column < columns; ++column)
+        {
+            const uint32_t a = row * (columns + 1) + column;
+            const uint32_t below = a + columns + 1;
+            indices.insert(indices.end(), { a, below, a + 1, a + 1, below, below + 1 });
+        }
+    }
+    const uint32_t vertexCount = (rows + 1) * (columns + 1);
+    const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+    size_t previousCount = indices.size();
+    std::vector<uint32_t> simplified;
+    for (float cellSize : { 1.0f / 32, 1.0f / 16, 1.0f / 8, 1.0f / 4 })
+    {
+        const float error = simplifyByClustering(positions.data(), 20, vertexCount, indices.data(), indexCount, cellSize, simplified);
+        CHECK(error <= cellSize * std::sqrt(3.0f) + 1e-5f);
+        CHECK(simplified.size() % 3 == 0);
+        CHECK(simplified.size() < previousCount);
+        uint32_t badTriangles = 0;
+        for (size_t i = 0; i < simplified.size(); i += 3)
+        {
+            const bool isDegenerate = simplified[i] == simplified[i + 1] || simplified[i + 1] == simplified[i + 2] || simplified[i] == simplified[i + 2];
+            const bool isOutOfRange = std::max({ simplified[i], simplified[i + 1], simplified[i + 2] }) >= vertexCount;
+            badTriangles += isDegenerate || isOutOfRange ? 1 : 0;
+        }
+        CHECK(badTriangles == 0);
+        previousCount = simplified.size();
+    }
+
+    CHECK_THROWS(simplifyByClustering(positions.data(), 20, vertexCount, indices.data(), 4, 0.1f, simplified));
+    CHECK_THROWS(simplifyByClustering(positions.data(), 20, vertexCount, indices.data(), 3, 0.0f, simplified));
+    const uint32_t outOfRange[3] = { 0, 1, vertexCount };
+    CHECK_THROWS(simplifyByClustering(positions.data(), 20, vertexCount, outOfRange, 3, 0.1f, simplified));
+}
+
+TEST(SimdScalarAndParallelSelectionsMatch)
+{
+    JobSystem jobs(3);
+    const uint32_t count = 100003; // Not a multiple of 8 or of the job block size
+    LodSelector scalar;
+    LodSelector simd;
+    LodSelector parallel;
+    fillSelector(scalar, count, 7);
+    fillSelector(simd, count, 7);
+    fillSelector(parallel, count, 7);
+    scalar.setSimdEnabled(false);
+
+    uint32_t mismatches = 0;
+    uint32_t switchCount = 0;
+    for (int frame = 0; frame < 300; ++frame)
+    {
+        if (frame == 150 || frame == 200)
+        {
+            LodSettings settings;
+            settings.fadeSeconds = frame == 150 ? 0.0f : settings.fadeSeconds;
+            settings.pixelError = frame == 200 ? 3.0f : settings.pixelError;
+            settings.hysteresis = frame == 200 ? 0.5f : settings.hysteresis;
+            scalar.setSettings(settings);
+            simd.setSettings(settings);
+            parallel.setSettings(settings);
+        }
+        const LodView view = makeView(frame);
+        const float deltaSeconds = frame % 7 == 0 ? 0.1f : 1.0f / 60.0f;
+        scalar.select(view, deltaSeconds);
+        simd.select(view, deltaSeconds);
+        parallel.select(jobs, view, deltaSeconds);
+        mismatches += isSameSelection(scalar, simd) && isSameSelection(scalar, parallel) ? 0 : 1;
+        mismatches += parallel.getStats().instanceCount == count ? 0 : 1;
+        switchCount += scalar.getStats().switchCount;
+    }
+    CHECK(mismatches == 0);
+    CHECK(switchCount > 1000);
+}
+
+TEST(SelectionDoesNotAllocate)
+{
+    JobSystem jobs(3);
+    LodSelector selector;
+    fillSelector(selector, 50000, 3);
+    selector.select(jobs, makeView(0), 0.016f);
+
+    HeapAllocationScope scope(HeapAllocationSource::Process);
+    for (int frame = 1; frame < 50; ++frame)
+    {
+        selector.select(makeView(frame), 0.016f);
+        selector.select(jobs, makeView(frame), 0.016f);
+    }
+    CHECK(scope.getAllocationCount() == 0);
+}
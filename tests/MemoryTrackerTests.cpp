@@ -0,0 +1,217 @@
+#include "TestHarness.h"
+#include "MemoryTracker.h"
+#include <thread>
+
+using namespace raphael;
+
+namespace
+{
+    bool contains(const std::string& text, const char* part)
+    {
+        return text.find(part) != std::string::npos;
+    }
+}
+
+TEST(LiveBytesAndPeaksPerCategory)
+{
+    MemoryTracker tracker;
+    const uint32_t vertices = tracker.track(MemoryCategory::Geometry, 1000, "Vertices");
+    const uint32_t indices = tracker.track(MemoryCategory::Geometry, 500, "Indices");
+    const uint32_t albedo = tracker.track(MemoryCategory::Texture, 4096, "Albedo");
+
+    MemoryCategoryStats geometry = tracker.getCategoryStats(MemoryCategory::Geometry);
+    CHECK(geometry.liveBytes == 1500);
+    CHECK(geometry.liveCount == 2);
+    CHECK(tracker.getCategoryStats(MemoryCategory::Texture).liveBytes == 4096);
+    CHECK(tracker.getTotalStats().liveBytes == 5596);
+
+    tracker.untrack(vertices);
+    geometry = tracker.getCategoryStats(MemoryCategory::Geometry);
+    CHECK(geometry.liveBytes == 500);
+    CHECK(geometry.peakBytes == 1500);
+    CHECK(geometry.liveCount == 1);
+    CHECK(geometry.totalAllocationCount == 2);
+    CHECK(tracker.getTotalStats().peakBytes == 5596);
+
+    tracker.untrack(indices);
+    tracker.untrack(albedo);
+    CHECK(tracker.getTotalStats().liveBytes == 0);
+    CHECK(tracker.getTotalStats().liveCount == 0);
+    CHECK(tracker.getCategoryStats(MemoryCategory::Count).liveBytes == 0);
+}
+
+TEST(HandlesAreReusedAndStaleUntracksIgnored)
+{
+    MemoryTracker tracker;
+    const uint32_t first = tracker.track(MemoryCategory::Staging, 100, nullptr);
+    tracker.untrack(first);
+    tracker.untrack(first);
+    tracker.untrack(MemoryTracker::InvalidHandle);
+    CHECK(tracker.getTotalStats().liveCount == 0);
+    CHECK(tracker.getCategoryStats(MemoryCategory::Staging).lastFrame.freeCount == 0); // Window still open
+
+    // Same slot, new generation
+    const uint32_t second = tracker.track(MemoryCategory::Staging, 200, "Reused");
+    CHECK(second != first);
+    CHECK((second & MemoryTracker::MaxAllocationCount) == (first & MemoryTracker::MaxAllocationCount));
+    CHECK(tracker.getCategoryStats(MemoryCategory::Staging).liveBytes == 200);
+
+    // Out of range categories are accounted as Other
+    tracker.track(static_cast<MemoryCategory>(200), 7, "Bad category");
+    CHECK(tracker.getCategoryStats(MemoryCategory::Other).liveBytes == 7);
+}
+
+TEST(StaleUntrackAfterReuseKeepsTheLiveAllocation)
+{
+    MemoryTracker tracker;
+    const uint32_t stale = tracker.track(MemoryCategory::Texture, 100, "Freed");
+    tracker.untrack(stale);
+    const uint32_t live = tracker.track(MemoryCategory::Geometry, 300, "Live");
+    tracker.untrack(stale);
+    tracker.untrack(stale);
+    CHECK(tracker.getCategoryStats(MemoryCategory::Geometry).liveBytes == 300);
+    CHECK(tracker.getCategoryStats(MemoryCategory::Texture).liveBytes == 0);
+    CHECK(tracker.getTotalStats().liveCount == 1);
+
+    // Every reuse of the slot hands out a handle no earlier one matches, until the generation wraps
+    tracker.untrack(live);
+    std::vector<uint32_t> handles = { stale, live };
+    for (int i = 0; i < 200; ++i)
+    {
+        handles.push_back(tracker.track(MemoryCategory::Other, 1, nullptr));
+        tracker.untrack(handles.back());
+    }
+    const uint32_t current = tracker.track(MemoryCategory::Other, 50, "Current");
+    for (uint32_t handle : handles)
+    {
+        CHECK(handle != current);
+        tracker.untrack(handle);
+    }
+    CHECK(tracker.getCategoryStats(MemoryCategory::Other).liveBytes == 50);
+    CHECK(tracker.getTotalStats().liveCount == 1);
+    tracker.untrack(current);
+    CHECK(tracker.getTotalStats().liveCount == 0);
+}
+
+TEST(ChurnIsReportedPerFrame)
+{
+    MemoryTracker tracker;
+    CHECK(tracker.getFrameIndex() == 0);
+
+    const uint32_t persistent = tracker.track(MemoryCategory::RenderTarget, 1000, "GBuffer");
+    const uint32_t transient = tracker.track(MemoryCategory::ConstantBuffer, 64, "Per draw");
+    tracker.endFrame();
+
+    MemoryCategoryStats total = tracker.getTotalStats();
+    CHECK(tracker.getFrameIndex() == 1);
+    CHECK(total.lastFrame.allocationCount == 2);
+    CHECK(total.lastFrame.allocatedBytes == 1064);
+    CHECK(total.lastFrame.freeCount == 0);
+
+    tracker.untrack(transient);
+    tracker.track(MemoryCategory::ConstantBuffer, 64, "Per draw");
+    tracker.endFrame();
+
+    const MemoryCategoryStats constants = tracker.getCategoryStats(MemoryCategory::ConstantBuffer);
+    CHECK(constants.lastFrame.allocationCount == 1);
+    CHECK(constants.lastFrame.freeCount == 1);
+    CHECK(constants.lastFrame.allocatedBytes == 64);
+    CHECK(constants.lastFrame.freedBytes == 64);
+    CHECK(tracker.getCategoryStats(MemoryCategory::RenderTarget).lastFrame.allocationCount == 0);
+
+    // A quiet frame clears the churn
+    tracker.endFrame();
+    total = tracker.getTotalStats();
+    CHECK(total.lastFrame.allocationCount == 0 && total.lastFrame.freeCount == 0);
+    CHECK(total.liveBytes == 1064);
+    tracker.untrack(persistent);
+}
+
+TEST(BudgetUsesTheLargerOfOsAndTrackedUsage)
+{
+    MemoryTracker tracker;
+    CHECK(!tracker.isOverBudget()); // Unknown budget
+
+    tracker.setBudget(1000, 200);
+    CHECK(tracker.getBudget() == 1000);
+    CHECK(tracker.getOsUsage() == 200);
+    CHECK(!tracker.isOverBudget());
+
+    const uint32_t big = tracker.track(MemoryCategory::Texture, 1500, "Big");
+    CHECK(tracker.isOverBudget());
+    tracker.untrack(big);
+
+    tracker.setBudget(1000, 1001);
+    CHECK(tracker.isOverBudget());
+}
+
+TEST(JsonDumpListsCategoriesAndLiveAllocations)
+{
+    MemoryTracker tracker;
+    tracker.setBudget(4096, 1024);
+    tracker.track(MemoryCategory::Texture, 300, "Small \"quoted\"\n");
+    tracker.track(MemoryCategory::SwapChain, 900, "Back buffer");
+    const uint32_t freed = tracker.track(MemoryCategory::Geometry, 50, "Freed");
+    tracker.untrack(freed);
+    tracker.endFrame();
+
+    const std::string json = tracker.buildJson();
+    CHECK(json.front() == '{' && json.back() == '}');
+    CHECK(contains(json, "\"frame\":1"));
+    CHECK(contains(json, "\"budgetBytes\":4096"));
+    CHECK(contains(json, "\"osUsageBytes\":1024"));
+    CHECK(contains(json, "\"total\":{\"liveBytes\":1200,\"peakBytes\":1250,\"liveCount\":2,\"totalAllocations\":3"));
+    CHECK(contains(json, "\"SwapChain\":{\"liveBytes\":900"));
+    CHECK(contains(json, "\"Texture\":{\"liveBytes\":300"));
+    CHECK(contains(json, "\"Small \\\"quoted\\\"\\n\""));
+    CHECK(!contains(json, "Freed"));
+
+    // Largest allocation first
+    CHECK(json.find("Back buffer") < json.find("Small"));
+
+    const std::string summary = tracker.buildJson(false);
+    CHECK(!contains(summary, "allocations\":["));
+    CHECK(contains(summary, "\"categories\":{\"Unknown\":"));
+
+    CHECK(std::string(getMemoryCategoryName(MemoryCategory::DescriptorHeap)) == "DescriptorHeap");
+    CHECK(std::string(getMemoryCategoryName(MemoryCategory::Count)) == "Invalid");
+}
+
+TEST(ConcurrentTrackingKeepsTotalsExact)
+{
+    MemoryTracker tracker;
+    const uint32_t threadCount = 4;
+    const uint32_t iterations = 5000;
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&tracker, t]
+        {
+            const MemoryCategory category = static_cast<MemoryCategory>(1 + t);
+            std::vector<uint32_t> handles;
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                handles.push_back(tracker.track(category, 16, "Worker"));
+                if (i % 2 == 1)
+                {
+                    tracker.untrack(handles[i / 2]);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Every thread freed half of what it made
+    const MemoryCategoryStats total = tracker.getTotalStats();
+    CHECK(total.liveCount == threadCount * iterations / 2);
+    CHECK(total.liveBytes == 16ull * threadCount * iterations / 2);
+    CHECK(total.totalAllocationCount == threadCount * iterations);
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        CHECK(tracker.getCategoryStats(static_cast<MemoryCategory>(1 + t)).liveCount == iterations / 2);
+    }
+}
@@ -0,0 +1,299 @@
+#include "TestHarness.h"
+#include "FrameArena.h"
+#include "HeapAllocationCounter.h"
+#include "JobSystem.h"
+#include "NullCommandList.h"
+#include "RecordPartition.h"
+#include <array>
+#include <random>
+
+using namespace raphael;
+
+TEST(ObjectsAreRegisteredUntilDestroyed)
+{
+    NullDevice device;
+    std::unique_ptr<NullPipeline> pipeline = device.createPipeline("Opaque");
+    std::unique_ptr<NullResource> texture = device.createResource({ "Albedo", 1 << 20, MemoryCategory::Texture, ResourceState::Common });
+    CHECK(device.getLiveObjectCount() == 2);
+    CHECK(device.getObject(pipeline->getHandle()) == pipeline.get());
+    CHECK(device.getObject(texture->getHandle()) == texture.get());
+    CHECK(pipeline->getHandle() != texture->getHandle());
+    CHECK(texture->getGpuAddress() != 0);
+    CHECK(device.getMemoryTracker().getTotalStats().liveBytes == 1 << 20);
+
+    const CommandHandle handle = pipeline->getHandle();
+    pipeline.reset();
+    CHECK(device.getObject(handle) == nullptr);
+    CHECK(device.getObjectStats(NullObjectType::Pipeline).createdCount == 1);
+    CHECK(device.getObjectStats(NullObjectType::Pipeline).destroyedCount == 1);
+    CHECK(device.getObjectStats(NullObjectType::Pipeline).liveCount == 0);
+
+    // Freed handles are reused
+    std::unique_ptr<NullRootSignature> rootSignature = device.createRootSignature("Root");
+    CHECK(rootSignature->getHandle() == handle);
+
+    texture.reset();
+    CHECK(device.getMemoryTracker().getTotalStats().liveBytes == 0);
+}
+
+TEST(LeakReportNamesLiveObjects)
+{
+    NullDevice device;
+    std::unique_ptr<NullResource> vertices = device.createResource({ "Vertices", 1 << 16, MemoryCategory::Geometry, ResourceState::Common });
+    std::unique_ptr<NullResource> leaked = device.createResource({ "Leaked texture", 1 << 20, MemoryCategory::Texture, ResourceState::Common });
+    vertices.reset();
+
+    const std::string report = device.buildLeakReport();
+    CHECK(report.find("Leaked texture") != std::string::npos);
+    CHECK(report.find("Vertices") == std::string::npos);
+
+    leaked.reset();
+    CHECK(device.buildLeakReport().empty());
+    CHECK(device.getLiveObjectCount() == 0);
+}
+
+TEST(DescriptorHeapHandlesAreChecked)
+{
+    NullDevice device;
+    std::unique_ptr<NullDescriptorHeap> heap = device.createDescriptorHeap({ "Textures", 64, true });
+    std::unique_ptr<NullDescriptorHeap> staging = device.createDescriptorHeap({ "Staging", 64, false });
+    CHECK(heap->getGpuHandle(1) != heap->getGpuHandle(0));
+    CHECK_THROWS(heap->getGpuHandle(64));
+    CHECK_THROWS(staging->getGpuHandle(0));
+}
+
+TEST(FencesTrailByTheConfiguredLatency)
+{
+    NullDevice device(NullDeviceDesc{ 2 });
+    uint64_t fence = 0;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        fence = device.getNextFenceValue();
+        device.signalFence(fence);
+    }
+    CHECK(fence == 3);
+    CHECK(device.getCompletedFenceValue() == 1);
+
+    device.waitForFence(1); // Already complete
+    CHECK(device.getStats().blockingWaitCount == 0);
+    device.waitForFence(3);
+    CHECK(device.getStats().blockingWaitCount == 1);
+    CHECK(device.getCompletedFenceValue() == 3);
+    CHECK_THROWS(device.waitForFence(4));
+}
+
+TEST(RetiredObjectsLiveUntilTheGpuPassesTheirFence)
+{
+    NullDevice device(NullDeviceDesc{ 1 });
+    std::unique_ptr<NullPipeline> pipeline = device.createPipeline("Rebuilt");
+    device.retire(std::move(pipeline));
+    CHECK(device.getReleaseQueue().getPendingCount() == 1);
+
+    device.signalFence(device.getNextFenceValue()); // Fence 1, the GPU is still on 0
+    CHECK(device.getObjectStats(NullObjectType::Pipeline).liveCount == 1);
+    device.signalFence(device.getNextFenceValue());
+    CHECK(device.getObjectStats(NullObjectType::Pipeline).liveCount == 0);
+    CHECK(device.getReleaseQueue().getPendingCount() == 0);
+
+    // Still pending at destruction is released with the device
+    device.retire(device.createPipeline("Pending"));
+    CHECK(device.getLiveObjectCount() == 1);
+}
+
+TEST(SubmitCountsTheFixupsAGpuBackendWouldInsert)
+{
+    NullDevice device;
+    std::unique_ptr<NullResource> backBuffer = device.createResource({ "Back buffer", 8 << 20, MemoryCategory::SwapChain, ResourceState::Present });
+    std::unique_ptr<NullCommandList> first = device.createCommandList("First");
+    std::unique_ptr<NullCommandList> second = device.createCommandList("Second");
+
+    // Unknown state: resolved with a fix-up at submit
+    first->begin();
+    first->transitionResource(backBuffer.get(), ResourceState::RenderTarget);
+    first->drawInstanced(3, 1, 0, 0);
+    first->end();
+    // Continues in the state the first list leaves behind
+    second->begin();
+    second->transitionResource(backBuffer.get(), ResourceState::RenderTarget);
+    second->drawInstanced(3, 1, 0, 0);
+    second->transitionResource(backBuffer.get(), ResourceState::Present);
+    second->end();
+    NullCommandList* lists[] = { first.get(), second.get() };
+    device.executeCommandLists(lists, 2);
+    CHECK(device.getStats().fixupCount == 1);
+    CHECK(device.getStats().fixupListCount == 1);
+    CHECK(device.getStats().executedListCount == 2);
+    CHECK(backBuffer->getTrackedState()->state == ResourceState::Present);
+
+    // Known state: the list records the transition itself
+    first->begin();
+    first->assumeResourceState(backBuffer.get(), ResourceState::Present);
+    first->transitionResource(backBuffer.get(), ResourceState::RenderTarget);
+    first->drawInstanced(3, 1, 0, 0);
+    first->transitionResource(backBuffer.get(), ResourceState::Present);
+    first->end();
+    device.executeCommandList(first.get());
+    CHECK(device.getStats().fixupCount == 1);
+    CHECK(first->getStats().drawCount == 2);
+}
+
+TEST(ListsRecordIssuedCallsAndRejectMisuse)
+{
+    NullDevice device;
+    std::unique_ptr<NullPipeline> pipeline = device.createPipeline("Opaque");
+    std::unique_ptr<NullResource> depth = device.createResource({ "Depth", 8 << 20, MemoryCategory::DepthStencil, ResourceState::DepthWrite });
+    std::unique_ptr<NullCommandList> list = device.createCommandList("List");
+
+    // The repeated pipeline is filtered, the transition and draw are written with the pipeline
+    CommandStream stream;
+    list->setRecordStream(&stream);
+    list->begin();
+    list->setPipeline(pipeline.get());
+    list->setPipeline(pipeline.get());
+    list->assumeResourceState(depth.get(), ResourceState::DepthWrite);
+    list->transitionResource(depth.get(), ResourceState::DepthRead);
+    list->drawInstanced(3, 1, 0, 0);
+    list->end();
+    list->setRecordStream(nullptr);
+    CHECK(stream.getCommandCount() == 3);
+    CHECK(list->getStateCacheStats().elidedCount == 1);
+
+    CHECK_THROWS(list->drawInstanced(3, 1, 0, 0));
+    CHECK_THROWS(list->end());
+    list->begin();
+    CHECK_THROWS(list->begin());
+    CHECK_THROWS(device.executeCommandList(list.get()));
+    list->end();
+}
+
+// A GltfDemo-style frame recorded on the job system over three frames in flight: an opening list moves
+// the back buffer to render target, the draws are partitioned over parallel lists and a closing list
+// returns it to present. Steady state must need no fix-ups and no heap allocations.
+TEST(ParallelFramesNeedNoFixupsOrAllocations)
+{
+    constexpr uint32_t MaxRanges = 8;
+    constexpr uint32_t FramesInFlight = 3;
+
+    NullDevice device(NullDeviceDesc{ 2 });
+    JobSystem jobs(3);
+    std::unique_ptr<NullDescriptorHeap> heap = device.createDescriptorHeap({ "Textures", 4096, true });
+    std::unique_ptr<NullRootSignature> rootSignature = device.createRootSignature("Root");
+    std::unique_ptr<NullPipeline> pipeline = device.createPipeline("Textured");
+    std::unique_ptr<NullResource> vertices = device.createResource({ "Vertices", 64 << 20, MemoryCategory::Geometry, ResourceState::VertexAndConstantBuffer });
+    std::unique_ptr<NullResource> indices = device.createResource({ "Indices", 16 << 20, MemoryCategory::Geometry, ResourceState::IndexBuffer });
+    std::array<std::unique_ptr<NullResource>, FramesInFlight> backBuffers;
+    for (std::unique_ptr<NullResource>& backBuffer : backBuffers)
+    {
+        backBuffer = device.createResource({ "Back buffer", 8 << 20, MemoryCategory::SwapChain, ResourceState::Present });
+    }
+    std::vector<std::unique_ptr<NullCommandList>> lists;
+    std::vector<NullCommandList*> submitLists;
+    for (uint32_t i = 0; i < MaxRanges + 2; ++i)
+    {
+        lists.push_back(device.createCommandList("Frame list"));
+        submitLists.push_back(lists.back().get());
+    }
+
+    const uint32_t meshCount = 5000;
+    std::vector<uint32_t> indexCounts(meshCount);
+    std::vector<uint32_t> textures(meshCount);
+    std::mt19937 random(1);
+    for (uint32_t i = 0; i < meshCount; ++i)
+    {
+        indexCounts[i] = 36 + random() % 3000;
+        textures[i] = (i / 8) % 512;
+    }
+
+    std::array<uint64_t, FramesInFlight> frameFences = {};
+    FrameArena arena(1 << 20);
+    uint64_t steadyAllocationCount = 0;
+    const uint32_t frameCount = 60;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        const uint32_t slot = frame % FramesInFlight;
+        device.waitForFence(frameFences[slot]);
+        arena.reset();
+        HeapAllocationScope scope(HeapAllocationSource::Process);
+
+        uint32_t* costs = arena.allocateArray<uint32_t>(meshCount);
+        std::copy(indexCounts.begin(), indexCounts.end(), costs);
+        std::array<RecordRange, MaxRanges> ranges;
+        const uint32_t rangeCount = partitionRecording(costs, meshCount, std::min(jobs.getThreadCount(), MaxRanges), 64, ranges.data());
+
+        NullResource* backBuffer = backBuffers[slot].get();
+        NullCommandList* open = submitLists[0];
+        open->begin();
+        open->assumeResourceState(backBuffer, ResourceState::Present);
+        open->transitionResource(backBuffer, ResourceState::RenderTarget);
+        open->flushBarriers();
+        open->end();
+
+        const uint64_t constantsBase = 0x100000000ull + slot * 0x1000000ull;
+        jobs.parallelFor(rangeCount, 1, [&](uint32_t first, uint32_t last)
+        {
+            for (uint32_t range = first; range < last; ++range)
+            {
+                NullCommandList* list = submitLists[range + 1];
+                list->begin();
+                list->transitionResource(backBuffer, ResourceState::RenderTarget);
+                list->setDescriptorHeaps(heap.get());
+                list->setGraphicsRootSignature(rootSignature.get());
+                list->setPipeline(pipeline.get());
+                list->setVertexBuffer(0, vertices.get(), 64 << 20, 32);
+                list->setIndexBuffer(indices.get(), 16 << 20, 4);
+                list->setConstantBufferView(1, constantsBase);
+                for (uint32_t i = ranges[range].begin; i < ranges[range].end; ++i)
+                {
+                    list->setConstantBufferView(0, constantsBase + 256ull * (i + 1));
+                    list->setGraphicsRootDescriptorTable(2, heap->getGpuHandle(textures[i]));
+                    list->drawIndexedInstanced(indexCounts[i], 1, 0, 0, 0);
+                }
+                list->end();
+            }
+        });
+
+        NullCommandList* close = submitLists[rangeCount + 1];
+        close->begin();
+        close->transitionResource(backBuffer, ResourceState::RenderTarget);
+        close->transitionResource(backBuffer, ResourceState::Present);
+        close->end();
+        device.executeCommandLists(submitLists.data(), rangeCount + 2);
+        frameFences[slot] = device.getNextFenceValue();
+        device.signalFence(frameFences[slot]);
+
+        if (frame >= 10)
+        {
+            steadyAllocationCount += scope.getAllocationCount();
+        }
+        // A pipeline rebuilt mid-run goes once the GPU catches up
+        if (frame == frameCount / 2)
+        {
+            device.retire(std::move(pipeline));
+            pipeline = device.createPipeline("Textured (rebuilt)");
+        }
+    }
+
+    uint64_t drawCount = 0;
+    for (const std::unique_ptr<NullCommandList>& list : lists)
+    {
+        drawCount += list->getStats().drawCount;
+    }
+    CHECK(drawCount == uint64_t(meshCount) * frameCount);
+    CHECK(device.getStats().fixupCount == 0);
+    CHECK(steadyAllocationCount == 0);
+    CHECK(device.getObjectStats(NullObjectType::Pipeline).destroyedCount == 1);
+
+    pipeline.reset();
+    heap.reset();
+    rootSignature.reset();
+    vertices.reset();
+    indices.reset();
+    for (std::unique_ptr<NullResource>& backBuffer : backBuffers)
+    {
+        backBuffer.reset();
+    }
+    submitLists.clear();
+    lists.clear();
+    CHECK(device.getLiveObjectCount() == 0);
+    CHECK(device.getMemoryTracker().getTotalStats().liveBytes == 0);
+}
@@ -0,0 +1,459 @@
+#include "TestHarness.h"
+#include "CameraMath.h"
+#include "HeapAllocationCounter.h"
+#include "JobSystem.h"
+#include "OcclusionCulling.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace raphael;
+using namespace raphael::test;
+
+namespace
+{
+    struct Box
+    {
+        float min[3];
+        float max[3];
+    };
+
+    // World space ray, t = 0 on the near plane and t = 1 on the far plane
+    struct Ray
+    {
+        double origin[3];
+        double direction[3];
+    };
+
+    std::vector<Box> makeBoxes(std::mt19937& random, uint32_t count, float spread, float minSize, float maxSize)
+    {
+        std::uniform_real_distribution<float> position(-spread, spread);
+        std::uniform_real_distribution<float> size(minSize, maxSize);
+        std::vector<Box> boxes(count);
+        for (Box& box : boxes)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float center = position(random);
+                const float extent = size(random);
+                box.min[axis] = center - extent;
+                box.max[axis] = center + extent;
+            }
+        }
+        return boxes;
+    }
+
+    void fillBounds(CullingBounds& bounds, const std::vector<Box>& boxes)
+    {
+        for (const Box& box : boxes)
+        {
+            const float center[3] = { (box.min[0] + box.max[0]) * 0.5f, (box.min[1] + box.max[1]) * 0.5f, (box.min[2] + box.max[2]) * 0.5f };
+            const float extents[3] = { (box.max[0] - box.min[0]) * 0.5f, (box.max[1] - box.min[1]) * 0.5f, (box.max[2] - box.min[2]) * 0.5f };
+            bounds.addBox(center, extents);
+        }
+    }
+
+    // The box as 8 corners and 36 indices wound clockwise from outside
+    void appendBoxMesh(const Box& box, std::vector<float>& positions, std::vector<uint32_t>& indices)
+    {
+        static const uint32_t triangles[36] = { 2, 3, 1, 2, 1, 0, 7, 6, 4, 7, 4, 5, 6, 2, 0, 6, 0, 4, 3, 7, 5, 3, 5, 1, 5, 4, 0, 5, 0, 1, 6, 7, 3, 6, 3, 2 };
+        const uint32_t base = static_cast<uint32_t>(positions.size() / 3);
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            positions.push_back(corner & 1 ? box.max[0] : box.min[0]);
+            positions.push_back(corner & 2 ? box.max[1] : box.min[1]);
+            positions.push_back(corner & 4 ? box.max[2] : box.min[2]);
+        }
+        for (uint32_t index : triangles)
+        {
+            indices.push_back(base + index);
+        }
+    }
+
+    uint32_t countDepthDifferences(const OcclusionCuller& a, const OcclusionCuller& b)
+    {
+        uint32_t differences = 0;
+        for (uint32_t y = 0; y < a.getHeight(); ++y)
+        {
+            for (uint32_t x = 0; x < a.getWidth(); ++x)
+            {
+                differences += a.getDepth(x, y) != b.getDepth(x, y) ? 1 : 0;
+            }
+        }
+        return differences;
+    }
+
+    // Gauss-Jordan in double, the matrix is the float one the culler sees
+    void invert(const Matrix4& matrix, double inverse[16])
+    {
+        double rows[4][8];
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 8; ++column)
+            {
+                rows[row][column] = column < 4 ? matrix.m[row * 4 + column] : (column - 4 == row ? 1.0 : 0.0);
+            }
+        }
+        for (int column = 0; column < 4; ++column)
+        {
+            int pivot = column;
+            for (int row = column + 1; row < 4; ++row)
+            {
+                pivot = std::fabs(rows[row][column]) > std::fabs(rows[pivot][column]) ? row : pivot;
+            }
+            std::swap(rows[column], rows[pivot]);
+            const double divisor = rows[column][column];
+            for (double& value : rows[column])
+            {
+                value /= divisor;
+            }
+            for (int row = 0; row < 4; ++row)
+            {
+                const double factor = row == column ? 0.0 : rows[row][column];
+                for (int k = 0; k < 8; ++k)
+                {
+                    rows[row][k] -= factor * rows[column][k];
+                }
+            }
+        }
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                inverse[row * 4 + column] = rows[row][column + 4];
+            }
+        }
+    }
+
+    Ray makePixelRay(const double inverse[16], double x, double y, uint32_t width, uint32_t height)
+    {
+        const double ndc[2] = { x / width * 2.0 - 1.0, 1.0 - y / height * 2.0 };
+        double points[2][3];
+        for (int end = 0; end < 2; ++end)
+        {
+            const double clip[4] = { ndc[0], ndc[1], double(end), 1.0 };
+            double world[4] = {};
+            for (int column = 0; column < 4; ++column)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    world[column] += clip[k] * inverse[k * 4 + column];
+                }
+            }
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                points[end][axis] = world[axis] / world[3];
+            }
+        }
+        Ray ray;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            ray.origin[axis] = points[0][axis];
+            ray.direction[axis] = points[1][axis] - points[0][axis];
+        }
+        return ray;
+    }
+
+    bool intersect(const Ray& ray, const Box& box, double& distance)
+    {
+        double entry = 0.0;
+        double exit = 1e30;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (ray.direction[axis] == 0.0)
+            {
+                if (ray.origin[axis] < box.min[axis] || ray.origin[axis] > box.max[axis])
+                {
+                    return false;
+                }
+                continue;
+            }
+            const double t0 = (box.min[axis] - ray.origin[axis]) / ray.direction[axis];
+            const double t1 = (box.max[axis] - ray.origin[axis]) / ray.direction[axis];
+            entry = std::max(entry, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+            if (entry > exit)
+            {
+                return false;
+            }
+        }
+        distance = entry;
+        return true;
+    }
+
+    double nearestHit(const Ray& ray, const std::vector<Box>& boxes)
+    {
+        double nearest = 1e30;
+        double distance = 0.0;
+        for (const Box& box : boxes)
+        {
+            if (intersect(ray, box, distance))
+            {
+                nearest = std::min(nearest, distance);
+            }
+        }
+        return nearest;
+    }
+}
+
+TEST(BoxOccludersMatchTheirMeshes)
+{
+    const Box box = { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    appendBoxMesh(box, positions, indices);
+    const float eyes[][3] = { { 0, 0, -6 }, { 0, 0, 6 }, { -6, 0, 0 }, { 6, 0, 0 }, { 0.01f, -6, 0.3f }, { 0.01f, 6, 0.3f }, { 4, 3, -5 }, { -4, -3, 5 } };
+    const float target[3] = { 0.0f, 0.0f, 0.0f };
+    for (const float* eye : eyes)
+    {
+        const Matrix4 viewProjection = makeViewProjection(eye, target, 1.0f);
+        OcclusionCuller boxCuller(160, 90);
+        OcclusionCuller meshCuller(160, 90);
+        boxCuller.beginFrame(viewProjection.m);
+        boxCuller.addOccluderBox(box.min, box.max);
+        boxCuller.rasterizeOccluders();
+
+        uint32_t covered = 0;
+        for (uint32_t y = 0; y < boxCuller.getHeight(); ++y)
+        {
+            for (uint32_t x = 0; x < boxCuller.getWidth(); ++x)
+            {
+                covered += boxCuller.getDepth(x, y) < 1.0f ? 1 : 0;
+            }
+        }
+        CHECK(covered > 100);
+
+        // Without back face culling the front faces still win the depth test
+        for (bool cullBackFaces : { false, true })
+        {
+            meshCuller.beginFrame(viewProjection.m);
+            meshCuller.addOccluderMesh(positions.data(), 8, indices.data(), 36, nullptr, cullBackFaces);
+            meshCuller.rasterizeOccluders();
+            CHECK(countDepthDifferences(boxCuller, meshCuller) == 0);
+        }
+    }
+}
+
+TEST(EdgeCases)
+{
+    const float eye[3] = { 0.0f, 0.0f, -10.0f };
+    const float target[3] = { 0.0f, 0.0f, 0.0f };
+    const Matrix4 viewProjection = makeViewProjection(eye, target, 1.0f);
+    OcclusionCuller culler(64, 36);
+    CHECK(culler.getWidth() == 64 && culler.getHeight() == 36);
+    OcclusionCuller rounded(61, 33);
+    CHECK(rounded.getWidth() == 64 && rounded.getHeight() == 36);
+    CHECK_THROWS(OcclusionCuller(0, 4));
+
+    const float wallMin[3] = { -50.0f, -50.0f, 0.0f };
+    const float wallMax[3] = { 50.0f, 50.0f, 1.0f };
+    culler.beginFrame(viewProjection.m);
+    culler.addOccluderBox(wallMin, wallMax);
+    culler.rasterizeOccluders();
+    const float behindMin[3] = { -1.0f, -1.0f, 5.0f };
+    const float behindMax[3] = { 1.0f, 1.0f, 6.0f };
+    CHECK(!culler.isVisible(behindMin, behindMax));
+    const float frontMin[3] = { -1.0f, -1.0f, -3.0f };
+    const float frontMax[3] = { 1.0f, 1.0f, -2.0f };
+    CHECK(culler.isVisible(frontMin, frontMax));
+    const float nearMin[3] = { -1.0f, -1.0f, -10.5f };
+    const float nearMax[3] = { 1.0f, 1.0f, -5.0f };
+    CHECK(culler.isVisible(nearMin, nearMax));
+    const float offscreenMin[3] = { 100.0f, -1.0f, 5.0f };
+    const float offscreenMax[3] = { 101.0f, 1.0f, 6.0f };
+    CHECK(!culler.isVisible(offscreenMin, offscreenMax));
+
+    // A wall touching the box's front face ties, which counts as visible
+    const float touchingMin[3] = { -50.0f, -50.0f, 5.0f };
+    const float touchingMax[3] = { 50.0f, 50.0f, 6.0f };
+    culler.beginFrame(viewProjection.m);
+    culler.addOccluderBox(touchingMin, touchingMax);
+    culler.rasterizeOccluders();
+    CHECK(culler.isVisible(behindMin, behindMax));
+
+    // A tilted wall reaching behind the camera is clipped at the near plane, not dropped
+    const float quad[12] = { -50, -50, -20, 50, -50, -20, 50, 50, 20, -50, 50, 20 };
+    const uint32_t quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+    culler.beginFrame(viewProjection.m);
+    culler.addOccluderMesh(quad, 4, quadIndices, 6, nullptr, false);
+    culler.rasterizeOccluders();
+    CHECK(!culler.isVisible(behindMin, behindMax));
+    CHECK(culler.getStats().rasterizedTriangleCount >= 2);
+
+    // The world matrix moves the mesh
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    appendBoxMesh({ { -50.0f, -50.0f, 0.0f }, { 50.0f, 50.0f, 1.0f } }, positions, indices);
+    const float world[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 10, 1 };
+    culler.beginFrame(viewProjection.m);
+    culler.addOccluderMesh(positions.data(), 8, indices.data(), 36, world, true);
+    culler.rasterizeOccluders();
+    CHECK(culler.isVisible(behindMin, behindMax));
+    const float farMin[3] = { -1.0f, -1.0f, 12.0f };
+    const float farMax[3] = { 1.0f, 1.0f, 13.0f };
+    CHECK(!culler.isVisible(farMin, farMax));
+
+    const uint32_t badIndices[3] = { 0, 1, 9 };
+    CHECK_THROWS(culler.addOccluderMesh(positions.data(), 8, badIndices, 3, nullptr, false));
+}
+
+// Ray casts through every pixel center: the buffer must agree with the occluders, and an occludee that some
+// pixel center sees before every occluder must be kept. SIMD, scalar and parallel runs must be identical.
+TEST(MatchesRayCastReference)
+{
+    JobSystem jobs(3);
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    uint32_t bufferDifferences = 0;
+    uint32_t resultDifferences = 0;
+    uint32_t wronglyRejected = 0;
+    uint32_t rejected = 0;
+    uint32_t hidden = 0;
+    uint32_t coverageMismatches = 0;
+    uint32_t pixelCount = 0;
+    double maxDepthError = 0.0;
+    for (int scene = 0; scene < 24; ++scene)
+    {
+        const std::vector<Box> occluders = makeBoxes(random, 30, 20.0f, 0.5f, 4.0f);
+        const std::vector<Box> occludees = makeBoxes(random, 200, 25.0f, 0.1f, 1.5f);
+        float eye[3] = { offset(random) * 10.0f, offset(random) * 10.0f, -45.0f + offset(random) * 10.0f };
+        if (scene % 5 == 4)
+        {
+            // Inside the scene, so boxes cross the near plane
+            eye[0] = offset(random) * 5.0f;
+            eye[1] = offset(random) * 5.0f;
+            eye[2] = offset(random) * 5.0f;
+        }
+        const float target[3] = { offset(random) * 3.0f, offset(random) * 3.0f, 0.0f };
+        const Matrix4 viewProjection = makeViewProjection(eye, target, 1.0f);
+        double inverse[16];
+        invert(viewProjection, inverse);
+
+        OcclusionCuller simd(256, 144);
+        OcclusionCuller scalar(256, 144);
+        OcclusionCuller parallel(256, 144);
+        scalar.setSimdEnabled(false);
+        for (OcclusionCuller* culler : { &simd, &scalar, &parallel })
+        {
+            culler->beginFrame(viewProjection.m);
+            for (const Box& box : occluders)
+            {
+                culler->addOccluderBox(box.min, box.max);
+            }
+        }
+        simd.rasterizeOccluders();
+        scalar.rasterizeOccluders();
+        parallel.rasterizeOccluders(jobs);
+        bufferDifferences += countDepthDifferences(simd, scalar) + countDepthDifferences(simd, parallel);
+
+        const uint32_t width = simd.getWidth();
+        const uint32_t height = simd.getHeight();
+        std::vector<Ray> rays;
+        std::vector<double> occluderHits;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const Ray ray = makePixelRay(inverse, x + 0.5, y + 0.5, width, height);
+                const double hit = nearestHit(ray, occluders);
+                const bool isCovered = simd.getDepth(x, y) < 1.0f;
+                coverageMismatches += (hit <= 1.0) != isCovered ? 1 : 0;
+                if (hit <= 1.0 && isCovered)
+                {
+                    const float point[3] = { float(ray.origin[0] + ray.direction[0] * hit), float(ray.origin[1] + ray.direction[1] * hit),
+                        float(ray.origin[2] + ray.direction[2] * hit) };
+                    double clip[4];
+                    transformToClip(viewProjection, point, clip);
+                    maxDepthError = std::max(maxDepthError, std::fabs(clip[2] / clip[3] - simd.getDepth(x, y)));
+                }
+                rays.push_back(ray);
+                occluderHits.push_back(hit);
+                ++pixelCount;
+            }
+        }
+
+        CullingBounds bounds;
+        fillBounds(bounds, occludees);
+        const uint32_t count = static_cast<uint32_t>(occludees.size());
+        std::vector<uint32_t> candidates(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            candidates[i] = i;
+        }
+        std::vector<uint32_t> simdVisible(count);
+        std::vector<uint32_t> scalarVisible(count);
+        std::vector<uint32_t> parallelVisible = candidates;
+        const uint32_t simdCount = simd.cullOccluded(bounds, candidates.data(), count, simdVisible.data());
+        const uint32_t scalarCount = scalar.cullOccluded(bounds, candidates.data(), count, scalarVisible.data());
+        const uint32_t parallelCount = parallel.cullOccluded(jobs, bounds, parallelVisible.data(), count, parallelVisible.data());
+        simdVisible.resize(simdCount);
+        scalarVisible.resize(scalarCount);
+        parallelVisible.resize(parallelCount);
+        resultDifferences += simdVisible == scalarVisible && simdVisible == parallelVisible ? 0 : 1;
+
+        std::vector<bool> isKept(count, false);
+        for (uint32_t index : simdVisible)
+        {
+            isKept[index] = true;
+        }
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const Box& box = occludees[i];
+            bool isSeen = false;
+            for (uint32_t corner = 0; corner < 8 && !isSeen; ++corner)
+            {
+                const float point[3] = { corner & 1 ? box.max[0] : box.min[0], corner & 2 ? box.max[1] : box.min[1], corner & 4 ? box.max[2] : box.min[2] };
+                double clip[4];
+                transformToClip(viewProjection, point, clip);
+                isSeen = clip[2] <= 0.0;
+            }
+            for (size_t pixel = 0; pixel < rays.size() && !isSeen; ++pixel)
+            {
+                double distance = 0.0;
+                isSeen = intersect(rays[pixel], box, distance) && distance <= 1.0 && distance <= occluderHits[pixel];
+            }
+            wronglyRejected += isSeen && !isKept[i] ? 1 : 0;
+            rejected += isKept[i] ? 0 : 1;
+            hidden += isSeen ? 0 : 1;
+        }
+    }
+    CHECK(bufferDifferences == 0);
+    CHECK(resultDifferences == 0);
+    CHECK(wronglyRejected == 0);
+    // Conservative, but still finds nearly everything hidden at pixel centers
+    CHECK(rejected * 10 >= hidden * 9);
+    CHECK(coverageMismatches * 1000 <= pixelCount);
+    CHECK(maxDepthError < 1e-5);
+}
+
+TEST(SteadyStateDoesNotAllocate)
+{
+    JobSystem jobs(3);
+    std::mt19937 random(3);
+    const std::vector<Box> boxes = makeBoxes(random, 3000, 30.0f, 0.5f, 2.0f);
+    CullingBounds bounds;
+    fillBounds(bounds, boxes);
+    const float eye[3] = { 0.0f, 0.0f, -60.0f };
+    const float target[3] = { 0.0f, 0.0f, 0.0f };
+    const Matrix4 viewProjection = makeViewProjection(eye, target, 1.0f);
+    OcclusionCuller culler;
+    std::vector<uint32_t> indices(3000);
+    uint64_t allocationCount = 0;
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        for (uint32_t i = 0; i < 3000; ++i)
+        {
+            indices[i] = i;
+        }
+        HeapAllocationScope scope(HeapAllocationSource::Process);
+        culler.beginFrame(viewProjection.m);
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            culler.addOccluderBox(boxes[i].min, boxes[i].max);
+        }
+        culler.rasterizeOccluders(jobs);
+        culler.cullOccluded(jobs, bounds, indices.data(), 3000, indices.data());
+        allocationCount += frame > 0 ? scope.getAllocationCount() : 0;
+    }
+    CHECK(allocationCount == 0);
+}
@@ -0,0 +1,272 @@
+#include "TestHarness.h"
+#include "FencedObjectPool.h"
+#include "JobSystem.h"
+#include "NullCommandList.h"
+#include "RecordPartition.h"
+#include <memory>
+#include <random>
+
+using namespace raphael;
+
+namespace
+{
+    bool isPartitionValid(const RecordRange* ranges, uint32_t rangeCount, uint32_t itemCount, uint32_t maxRanges, uint32_t minItemsPerRange)
+    {
+        if (itemCount == 0 || maxRanges == 0)
+        {
+            return rangeCount == 0;
+        }
+        if (rangeCount < 1 || rangeCount > maxRanges)
+        {
+            return false;
+        }
+
+        uint32_t begin = 0;
+        for (uint32_t i = 0; i < rangeCount; ++i)
+        {
+            if (ranges[i].begin != begin || ranges[i].end <= ranges[i].begin)
+            {
+                return false;
+            }
+            if (rangeCount > 1 && ranges[i].getCount() < std::max(minItemsPerRange, 1u))
+            {
+                return false;
+            }
+            begin = ranges[i].end;
+        }
+        return begin == itemCount;
+    }
+
+    // Collects the startInstance of every draw, which the recording below sets to the draw index
+    struct DrawOrderCollector
+    {
+        std::vector<uint32_t> draws;
+
+        void setPipeline(CommandHandle) {}
+        void setRootSignature(CommandHandle) {}
+        void setDescriptorHeap(CommandHandle) {}
+        void setVertexBuffer(uint32_t, CommandHandle) {}
+        void setIndexBuffer(CommandHandle) {}
+        void setRootConstantBuffer(uint32_t, uint64_t) {}
+        void setRootDescriptorTable(uint32_t, uint64_t) {}
+        void transition(CommandHandle, ResourceState) {}
+        void draw(const CommandDraw&) {}
+        void drawIndexed(const CommandDrawIndexed& command) { draws.push_back(command.startInstance); }
+    };
+}
+
+TEST(RangesCoverTheItemsInOrder)
+{
+    std::mt19937 random(37);
+    RecordRange ranges[16];
+    for (int iteration = 0; iteration < 20000; ++iteration)
+    {
+        const uint32_t itemCount = random() % 300;
+        const uint32_t maxRanges = random() % 13;
+        const uint32_t minItemsPerRange = random() % 20;
+        std::vector<uint32_t> costs(itemCount);
+        for (uint32_t& cost : costs)
+        {
+            cost = random() % (iteration % 3 ? 1000 : 2);
+        }
+
+        const uint32_t rangeCount = partitionRecording(iteration % 5 ? costs.data() : nullptr, itemCount, maxRanges, minItemsPerRange, ranges);
+        CHECK(isPartitionValid(ranges, rangeCount, itemCount, maxRanges, minItemsPerRange));
+    }
+}
+
+TEST(UniformCostsSplitEvenly)
+{
+    RecordRange ranges[4];
+    const std::vector<uint32_t> costs(64, 100);
+    CHECK(partitionRecording(costs.data(), 64, 4, 8, ranges) == 4);
+    for (const RecordRange& range : ranges)
+    {
+        CHECK(range.getCount() == 16);
+    }
+
+    // Not enough items for four ranges of twenty
+    CHECK(partitionRecording(nullptr, 64, 4, 20, ranges) == 3);
+    CHECK(partitionRecording(nullptr, 10, 4, 20, ranges) == 1);
+    CHECK(ranges[0].begin == 0 && ranges[0].end == 10);
+
+    // All-zero costs balance by count
+    const std::vector<uint32_t> zeros(40, 0);
+    CHECK(partitionRecording(zeros.data(), 40, 4, 1, ranges) == 4);
+    CHECK(ranges[0].getCount() == 10 && ranges[3].getCount() == 10);
+}
+
+TEST(HeavyDrawGetsItsOwnRange)
+{
+    std::vector<uint32_t> costs(64, 1);
+    costs[0] = 1000;
+    RecordRange ranges[4];
+    CHECK(partitionRecording(costs.data(), 64, 4, 1, ranges) == 4);
+    CHECK(ranges[0].getCount() == 1);
+    // The rest is split evenly rather than left to the last range
+    for (uint32_t i = 1; i < 4; ++i)
+    {
+        CHECK(ranges[i].getCount() >= 20 && ranges[i].getCount() <= 22);
+    }
+}
+
+TEST(PoolReusesObjectsOnlyAfterTheirFence)
+{
+    FencedObjectPool<std::unique_ptr<int>> pool;
+    int created = 0;
+    auto create = [&] { return std::make_unique<int>(created++); };
+
+    std::unique_ptr<int> first = pool.acquire(0, create);
+    int* firstAddress = first.get();
+    pool.release(std::move(first), 5);
+    CHECK(pool.getPendingCount() == 1);
+
+    std::unique_ptr<int> second = pool.acquire(4, create);
+    CHECK(second.get() != firstAddress);
+    CHECK(pool.getCreatedCount() == 2);
+
+    std::unique_ptr<int> reused = pool.acquire(5, create);
+    CHECK(reused.get() == firstAddress);
+    CHECK(pool.getReusedCount() == 1);
+    CHECK(pool.getPendingCount() == 0);
+    CHECK(pool.getFreeCount() == 0);
+
+    pool.release(std::move(second), 6);
+    pool.release(std::move(reused), 7);
+    pool.releaseCompleted(7);
+    CHECK(pool.getFreeCount() == 2);
+}
+
+TEST(PoolStopsCreatingOnceWarm)
+{
+    // Per-slot allocators with the GPU trailing by up to two frames, sometimes catching up early
+    const uint32_t slotCount = 4;
+    const uint32_t framesInFlight = 2;
+    std::vector<FencedObjectPool<std::unique_ptr<uint64_t>>> pools(slotCount);
+    std::vector<uint64_t> frameFences(framesInFlight, 0);
+    std::mt19937 random(3);
+    uint64_t fence = 0;
+    uint64_t completed = 0;
+
+    for (uint32_t frame = 0; frame < 1000; ++frame)
+    {
+        completed = std::max(completed, frameFences[frame % framesInFlight]);
+        if (random() % 3 == 0)
+        {
+            completed = fence;
+        }
+
+        std::vector<std::unique_ptr<uint64_t>> active;
+        for (auto& pool : pools)
+        {
+            // The object holds the fence it was last submitted with
+            active.push_back(pool.acquire(completed, [] { return std::make_unique<uint64_t>(0); }));
+            CHECK(*active.back() <= completed);
+        }
+
+        frameFences[frame % framesInFlight] = ++fence;
+        for (uint32_t slot = 0; slot < slotCount; ++slot)
+        {
+            *active[slot] = fence;
+            pools[slot].release(std::move(active[slot]), fence);
+        }
+    }
+
+    for (const auto& pool : pools)
+    {
+        CHECK(pool.getCreatedCount() <= framesInFlight + 1);
+    }
+}
+
+TEST(ParallelListsKeepTheSerialDrawOrder)
+{
+    // A pass split over command lists recorded by jobs, each slot recycling its lists through a fence pool,
+    // submitted in range order with one execute on the null backend
+    NullDeviceDesc desc;
+    desc.fenceLatency = 2;
+    NullDevice device(desc);
+    JobSystem jobs(3);
+
+    std::unique_ptr<NullPipeline> pipeline = device.createPipeline("Pipeline");
+    std::unique_ptr<NullResource> vertices = device.createResource({ "Vertices", 1 << 20, MemoryCategory::Geometry, ResourceState::Common });
+    std::unique_ptr<NullResource> indices = device.createResource({ "Indices", 1 << 20, MemoryCategory::Geometry, ResourceState::Common });
+
+    const uint32_t maxLists = 8;
+    const uint32_t drawCount = 5000;
+    std::vector<FencedObjectPool<std::unique_ptr<NullCommandList>>> pools(maxLists);
+    std::vector<std::unique_ptr<NullCommandList>> lists(maxLists);
+    std::vector<NullCommandList*> submitLists(maxLists);
+    std::vector<CommandStream> streams(maxLists);
+    std::vector<uint64_t> drawsBefore(maxLists); // List stats add up over the list's lifetime
+    RecordRange ranges[maxLists];
+
+    struct RecordContext
+    {
+        std::vector<std::unique_ptr<NullCommandList>>* lists;
+        RecordRange* ranges;
+        NullPipeline* pipeline;
+        NullResource* vertices;
+        NullResource* indices;
+    } context{ &lists, ranges, pipeline.get(), vertices.get(), indices.get() };
+
+    for (uint32_t frame = 0; frame < 20; ++frame)
+    {
+        const uint32_t listCount = partitionRecording(nullptr, drawCount, 1 + frame % maxLists, 64, ranges);
+        const uint64_t completed = device.getCompletedFenceValue();
+        for (uint32_t i = 0; i < listCount; ++i)
+        {
+            lists[i] = pools[i].acquire(completed, [&] { return device.createCommandList("Parallel list"); });
+            streams[i].clear();
+            lists[i]->setRecordStream(&streams[i]);
+            lists[i]->begin();
+            drawsBefore[i] = lists[i]->getStats().drawCount;
+            submitLists[i] = lists[i].get();
+        }
+
+        JobCounter counter;
+        for (uint32_t i = 0; i < listCount; ++i)
+        {
+            jobs.run([&context, i]
+            {
+                NullCommandList& list = *(*context.lists)[i];
+                list.setPipeline(context.pipeline);
+                list.setVertexBuffer(0, context.vertices, 1 << 20, 32);
+                list.setIndexBuffer(context.indices, 1 << 20, 2);
+                for (uint32_t draw = context.ranges[i].begin; draw < context.ranges[i].end; ++draw)
+                {
+                    list.setConstantBufferView(0, 0x10000 + draw * 256ull);
+                    list.drawIndexedInstanced(36, 1, 0, 0, draw);
+                }
+                list.end();
+            }, &counter);
+        }
+        jobs.wait(counter);
+
+        device.executeCommandLists(submitLists.data(), listCount);
+        const uint64_t fence = device.getNextFenceValue();
+        device.signalFence(fence);
+
+        DrawOrderCollector collector;
+        uint64_t recordedDraws = 0;
+        for (uint32_t i = 0; i < listCount; ++i)
+        {
+            replayCommandStream(streams[i].getBytes(), collector);
+            recordedDraws += lists[i]->getStats().drawCount - drawsBefore[i];
+            lists[i]->setRecordStream(nullptr);
+            pools[i].release(std::move(lists[i]), fence);
+        }
+        CHECK(recordedDraws == drawCount);
+        CHECK(collector.draws.size() == drawCount);
+        for (uint32_t draw = 0; draw < collector.draws.size(); ++draw)
+        {
+            CHECK(collector.draws[draw] == draw);
+        }
+    }
+
+    CHECK(device.getStats().executeCount == 20);
+    // Three frames of lists in flight at most per slot with a two fence latency
+    for (const auto& pool : pools)
+    {
+        CHECK(pool.getCreatedCount() <= 3);
+    }
+}
@@ -0,0 +1,277 @@
+#include "TestHarness.h"
+#include "RenderGraph.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+using namespace raphael;
+
+namespace
+{
+    struct Access
+    {
+        uint32_t pass = 0;
+        uint32_t resource = 0;
+        ResourceState state = ResourceState::Common;
+        bool write = false;
+    };
+
+    // Random passes over a pool of transients plus an imported back buffer (resource 0), reading only
+    // resources an earlier pass wrote. Returns every access in declaration order.
+    std::vector<Access> buildRandomGraph(RenderGraph& graph, uint32_t passCount, uint32_t seed)
+    {
+        const ResourceState writeStates[] = { ResourceState::RenderTarget, ResourceState::UnorderedAccess, ResourceState::DepthWrite, ResourceState::CopyDest };
+        const ResourceState readStates[] = { ResourceState::PixelShaderResource, ResourceState::NonPixelShaderResource, ResourceState::CopySource, ResourceState::DepthRead };
+
+        std::mt19937 random(seed);
+        const uint32_t resourceCount = passCount / 2 + 4;
+        graph.importResource("Back buffer", ResourceState::Present, ResourceState::Present);
+        for (uint32_t i = 1; i < resourceCount; ++i)
+        {
+            graph.createResource("Transient");
+        }
+
+        std::vector<bool> written(resourceCount, false);
+        written[0] = true;
+        std::vector<Access> accesses;
+        std::vector<uint32_t> used;
+        for (uint32_t i = 0; i < passCount; ++i)
+        {
+            const uint32_t pass = graph.addPass("Pass", random() % 50 == 0 ? RenderGraphPassFlags::NeverCull : RenderGraphPassFlags::None);
+            const uint32_t readCount = random() % 4;
+            const uint32_t writeCount = 1 + random() % 2;
+            used.clear();
+            for (uint32_t k = 0; k < readCount; ++k)
+            {
+                const uint32_t resource = random() % resourceCount;
+                if (!written[resource] || std::find(used.begin(), used.end(), resource) != used.end())
+                {
+                    continue;
+                }
+                used.push_back(resource);
+                const ResourceState state = readStates[random() % 4];
+                graph.read(pass, resource, state);
+                accesses.push_back({ pass, resource, state, false });
+            }
+            for (uint32_t k = 0; k < writeCount; ++k)
+            {
+                const uint32_t resource = random() % 20 == 0 ? 0 : random() % resourceCount;
+                if (std::find(used.begin(), used.end(), resource) != used.end())
+                {
+                    continue;
+                }
+                used.push_back(resource);
+                const ResourceState state = writeStates[random() % 4];
+                graph.write(pass, resource, state);
+                written[resource] = true;
+                accesses.push_back({ pass, resource, state, true });
+            }
+        }
+        return accesses;
+    }
+}
+
+TEST(DeferredFrameIsCulledLevelledAndTransitioned)
+{
+    RenderGraph graph;
+    const uint32_t backBuffer = graph.importResource("Back buffer", ResourceState::Present, ResourceState::Present);
+    const uint32_t shadow = graph.createResource("Shadow");
+    const uint32_t albedo = graph.createResource("Albedo");
+    const uint32_t normal = graph.createResource("Normal");
+    const uint32_t depth = graph.createResource("Depth");
+    const uint32_t ao = graph.createResource("AO");
+    const uint32_t hdr = graph.createResource("HDR");
+    const uint32_t debug = graph.createResource("Debug");
+
+    const uint32_t shadowPass = graph.addPass("Shadow");
+    graph.write(shadowPass, shadow, ResourceState::DepthWrite);
+    const uint32_t gBufferPass = graph.addPass("GBuffer");
+    graph.write(gBufferPass, albedo, ResourceState::RenderTarget);
+    graph.write(gBufferPass, normal, ResourceState::RenderTarget);
+    graph.write(gBufferPass, depth, ResourceState::DepthWrite);
+    const uint32_t aoPass = graph.addPass("SSAO");
+    graph.read(aoPass, depth, ResourceState::NonPixelShaderResource);
+    graph.read(aoPass, normal, ResourceState::NonPixelShaderResource);
+    graph.write(aoPass, ao, ResourceState::UnorderedAccess);
+    const uint32_t lightingPass = graph.addPass("Lighting");
+    graph.read(lightingPass, albedo, ResourceState::PixelShaderResource);
+    graph.read(lightingPass, normal, ResourceState::PixelShaderResource);
+    graph.read(lightingPass, depth, ResourceState::PixelShaderResource);
+    graph.read(lightingPass, shadow, ResourceState::PixelShaderResource);
+    graph.write(lightingPass, hdr, ResourceState::RenderTarget);
+    const uint32_t debugPass = graph.addPass("Debug view");
+    graph.read(debugPass, normal, ResourceState::PixelShaderResource);
+    graph.write(debugPass, debug, ResourceState::RenderTarget);
+    const uint32_t postPass = graph.addPass("Post");
+    graph.read(postPass, hdr, ResourceState::PixelShaderResource);
+    graph.write(postPass, backBuffer, ResourceState::RenderTarget);
+    const uint32_t uiPass = graph.addPass("UI", RenderGraphPassFlags::NeverCull);
+    graph.write(uiPass, backBuffer, ResourceState::RenderTarget);
+    graph.compile();
+
+    // Nothing reads the AO or the debug view
+    CHECK(graph.isPassCulled(aoPass));
+    CHECK(graph.isPassCulled(debugPass));
+    CHECK(!graph.isPassCulled(shadowPass));
+    CHECK(graph.getStats().culledPassCount == 2);
+
+    CHECK(graph.getPassLevel(shadowPass) == 0);
+    CHECK(graph.getPassLevel(gBufferPass) == 0);
+    CHECK(graph.getPassLevel(lightingPass) == 1);
+    CHECK(graph.getPassLevel(postPass) == 2);
+    CHECK(graph.getPassLevel(uiPass) == 3);
+    CHECK(graph.getLevelCount() == 4);
+    CHECK(graph.getLevelPasses(0).size() == 2);
+    CHECK(graph.getExecutionOrder().size() == 5);
+
+    CHECK(graph.getPassBarriers(lightingPass).size() == 4); // Albedo, normal, depth and shadow to shader resources
+    CHECK(graph.getPassBarriers(postPass).size() == 2);     // HDR to shader resource, back buffer Present to render target
+    CHECK(graph.getPassBarriers(uiPass).empty());
+    const std::span<const RenderGraphBarrier> finalBarriers = graph.getFinalBarriers();
+    CHECK(finalBarriers.size() == 1);
+    CHECK(finalBarriers[0].resource == backBuffer);
+    CHECK(finalBarriers[0].before == ResourceState::RenderTarget && finalBarriers[0].after == ResourceState::Present);
+
+    CHECK(graph.getResourceFirstState(albedo) == ResourceState::RenderTarget);
+    CHECK(graph.getResourceLifetime(hdr).firstPass == 2);
+    CHECK(graph.getResourceLifetime(hdr).lastPass == 3);
+    CHECK(!graph.buildReport().empty());
+
+    // Reading the AO brings SSAO back, its normal read shares a level with lighting's and both combine into one transition
+    const uint32_t compositePass = graph.addPass("Composite");
+    graph.read(compositePass, ao, ResourceState::PixelShaderResource);
+    graph.write(compositePass, backBuffer, ResourceState::RenderTarget);
+    graph.compile();
+    CHECK(!graph.isPassCulled(aoPass));
+    CHECK(graph.getPassLevel(aoPass) == 1);
+    CHECK(graph.getPassLevel(lightingPass) == 1);
+
+    uint32_t normalBarrierCount = 0;
+    for (uint32_t pass : graph.getExecutionOrder())
+    {
+        for (const RenderGraphBarrier& barrier : graph.getPassBarriers(pass))
+        {
+            if (barrier.resource == normal)
+            {
+                normalBarrierCount++;
+                CHECK(barrier.after == (ResourceState::NonPixelShaderResource | ResourceState::PixelShaderResource));
+            }
+        }
+    }
+    CHECK(normalBarrierCount == 1);
+}
+
+TEST(ReadingAnUnwrittenTransientThrows)
+{
+    RenderGraph graph;
+    const uint32_t resource = graph.createResource("Never written");
+    const uint32_t pass = graph.addPass("Reader", RenderGraphPassFlags::NeverCull);
+    graph.read(pass, resource, ResourceState::PixelShaderResource);
+    CHECK_THROWS(graph.compile());
+}
+
+TEST(ClearAllowsReuse)
+{
+    RenderGraph graph;
+    buildRandomGraph(graph, 50, 7);
+    graph.compile();
+    graph.clear();
+    CHECK(graph.getPassCount() == 0);
+    CHECK(graph.getResourceCount() == 0);
+
+    const uint32_t backBuffer = graph.importResource("Back buffer", ResourceState::Present, ResourceState::Present);
+    const uint32_t pass = graph.addPass("Clear");
+    graph.write(pass, backBuffer, ResourceState::RenderTarget);
+    graph.compile();
+    CHECK(graph.getExecutionOrder().size() == 1);
+    CHECK(graph.getFinalBarriers().size() == 1);
+}
+
+// Every random graph is replayed in execution order: each barrier's before state must be the resource's
+// current state, each access must find its state, dependent passes must sit on later levels and every
+// alive reader must keep its writer alive
+TEST(RandomGraphsOrderCullAndTransitionCorrectly)
+{
+    for (uint32_t passCount : { 20u, 100u, 300u, 1000u })
+    {
+        for (uint32_t seed = 0; seed < 4; ++seed)
+        {
+            RenderGraph graph;
+            const std::vector<Access> accesses = buildRandomGraph(graph, passCount, passCount + seed);
+            graph.compile();
+
+            const uint32_t resourceCount = graph.getResourceCount();
+            std::vector<ResourceState> states(resourceCount, ResourceState::Common);
+            std::vector<bool> touched(resourceCount, false);
+            states[0] = ResourceState::Present;
+            touched[0] = true;
+
+            uint32_t stateErrors = 0;
+            for (uint32_t pass : graph.getExecutionOrder())
+            {
+                for (const RenderGraphBarrier& barrier : graph.getPassBarriers(pass))
+                {
+                    stateErrors += !touched[barrier.resource] || states[barrier.resource] != barrier.before ? 1 : 0;
+                    states[barrier.resource] = barrier.after;
+                }
+                for (const Access& access : accesses)
+                {
+                    if (access.pass != pass)
+                    {
+                        continue;
+                    }
+                    if (!touched[access.resource])
+                    {
+                        touched[access.resource] = true;
+                        states[access.resource] = graph.getResourceFirstState(access.resource);
+                    }
+                    stateErrors += isStateCompatible(states[access.resource], access.state) ? 0 : 1;
+                }
+            }
+            for (const RenderGraphBarrier& barrier : graph.getFinalBarriers())
+            {
+                stateErrors += states[barrier.resource] != barrier.before ? 1 : 0;
+                states[barrier.resource] = barrier.after;
+            }
+            stateErrors += states[0] != ResourceState::Present ? 1 : 0;
+
+            uint32_t orderErrors = 0;
+            for (size_t i = 0; i < accesses.size(); ++i)
+            {
+                for (size_t j = i + 1; j < accesses.size(); ++j)
+                {
+                    const Access& first = accesses[i];
+                    const Access& second = accesses[j];
+                    if (first.resource != second.resource || first.pass == second.pass || !(first.write || second.write)
+                        || graph.isPassCulled(first.pass) || graph.isPassCulled(second.pass))
+                    {
+                        continue;
+                    }
+                    orderErrors += graph.getPassLevel(first.pass) >= graph.getPassLevel(second.pass) ? 1 : 0;
+                }
+            }
+
+            uint32_t livenessErrors = 0;
+            for (size_t j = 0; j < accesses.size(); ++j)
+            {
+                if (accesses[j].write || graph.isPassCulled(accesses[j].pass))
+                {
+                    continue;
+                }
+                for (size_t i = j; i-- > 0;)
+                {
+                    if (accesses[i].resource == accesses[j].resource && accesses[i].write && accesses[i].pass != accesses[j].pass)
+                    {
+                        livenessErrors += graph.isPassCulled(accesses[i].pass) ? 1 : 0;
+                        break;
+                    }
+                }
+            }
+
+            CHECK(stateErrors == 0);
+            CHECK(orderErrors == 0);
+            CHECK(livenessErrors == 0);
+            CHECK(graph.getStats().passCount == passCount);
+        }
+    }
+}
@@ -0,0 +1,424 @@
+#include "TestHarness.h"
+#include "ResourceStateTracker.h"
+#include <random>
+
+using namespace raphael;
+
+namespace
+{
+    // Not a real state, a resource between the two halves of a split barrier
+    constexpr ResourceState Transitioning = static_cast<ResourceState>(0xFFFF);
+
+    // Stands in for a command list: records the barrier batches the tracker hands out and every command
+    // with the states it uses, in order
+    struct SimulatedList
+    {
+        struct Operation
+        {
+            bool isCommand = false;
+            ResourceTransition transition;
+            TrackedResourceState* resource = nullptr;
+            ResourceState required = ResourceState::Common;
+        };
+
+        ResourceStateTracker tracker;
+        std::vector<Operation> operations;
+        std::vector<std::pair<TrackedResourceState*, ResourceState>> uses;
+        uint32_t batchCount = 0;
+
+        void reset()
+        {
+            tracker.reset();
+            operations.clear();
+            uses.clear();
+            batchCount = 0;
+        }
+
+        void use(TrackedResourceState* resource, ResourceState state)
+        {
+            tracker.require(resource, state);
+            uses.push_back({ resource, state });
+        }
+
+        void flush()
+        {
+            const std::span<const ResourceTransition> pending = tracker.getPendingBarriers();
+            batchCount += pending.empty() ? 0 : 1;
+            for (const ResourceTransition& transition : pending)
+            {
+                operations.push_back({ false, transition });
+            }
+            tracker.clearPendingBarriers();
+        }
+
+        void command()
+        {
+            flush();
+            for (const auto& [resource, state] : uses)
+            {
+                operations.push_back({ true, {}, resource, state });
+            }
+            uses.clear();
+        }
+
+        void end()
+        {
+            tracker.finish();
+            flush();
+        }
+    };
+
+    // Executes submitted lists against the actual resource states and counts every barrier whose before
+    // state is wrong and every command that uses a resource in an incompatible state
+    struct SimulatedQueue
+    {
+        std::vector<TrackedResourceState>& resources;
+        std::vector<ResourceState> actual;
+        std::vector<ResourceState> splitTargets;
+        std::vector<ResourceTransition> fixups;
+        uint32_t errorCount = 0;
+
+        explicit SimulatedQueue(std::vector<TrackedResourceState>& trackedResources)
+            : resources(trackedResources), splitTargets(trackedResources.size(), Transitioning)
+        {
+            for (const TrackedResourceState& resource : resources)
+            {
+                actual.push_back(resource.state);
+            }
+        }
+
+        size_t indexOf(const TrackedResourceState* resource) const { return resource - resources.data(); }
+
+        void apply(const ResourceTransition& transition)
+        {
+            const size_t index = indexOf(transition.resource);
+            if (transition.flags == ResourceTransitionFlags::EndOnly)
+            {
+                errorCount += actual[index] != Transitioning || splitTargets[index] != transition.after ? 1 : 0;
+                actual[index] = transition.after;
+                return;
+            }
+
+            errorCount += actual[index] != transition.before ? 1 : 0;
+            if (transition.flags == ResourceTransitionFlags::BeginOnly)
+            {
+                splitTargets[index] = transition.after;
+                actual[index] = Transitioning;
+            }
+            else
+            {
+                actual[index] = transition.after;
+            }
+        }
+
+        void submit(SimulatedList& list)
+        {
+            fixups.clear();
+            list.tracker.resolve(fixups);
+            for (const ResourceTransition& fixup : fixups)
+            {
+                apply(fixup);
+            }
+            for (const SimulatedList::Operation& operation : list.operations)
+            {
+                if (operation.isCommand)
+                {
+                    errorCount += isStateCompatible(actual[indexOf(operation.resource)], operation.required) ? 0 : 1;
+                }
+                else
+                {
+                    apply(operation.transition);
+                }
+            }
+
+            // The committed global states must match what the queue actually left behind
+            for (size_t i = 0; i < resources.size(); ++i)
+            {
+                errorCount += resources[i].state != actual[i] ? 1 : 0;
+            }
+        }
+    };
+
+    uint32_t countFlags(const SimulatedList& list, ResourceTransitionFlags flags)
+    {
+        uint32_t count = 0;
+        for (const SimulatedList::Operation& operation : list.operations)
+        {
+            count += !operation.isCommand && operation.transition.flags == flags ? 1 : 0;
+        }
+        return count;
+    }
+}
+
+TEST(StateCompatibility)
+{
+    CHECK(isReadOnlyState(ResourceState::GenericRead));
+    CHECK(isReadOnlyState(ResourceState::PixelShaderResource | ResourceState::NonPixelShaderResource));
+    CHECK(!isReadOnlyState(ResourceState::Common));
+    CHECK(!isReadOnlyState(ResourceState::RenderTarget));
+    CHECK(!isReadOnlyState(ResourceState::CopySource | ResourceState::CopyDest));
+
+    CHECK(isStateCompatible(ResourceState::RenderTarget, ResourceState::RenderTarget));
+    CHECK(isStateCompatible(ResourceState::GenericRead, ResourceState::PixelShaderResource));
+    CHECK(!isStateCompatible(ResourceState::PixelShaderResource, ResourceState::GenericRead));
+    CHECK(!isStateCompatible(ResourceState::UnorderedAccess, ResourceState::PixelShaderResource));
+}
+
+TEST(RenderPassSplitOverListsNeedsOneFixup)
+{
+    std::vector<TrackedResourceState> resources(1);
+    resources[0].state = ResourceState::Present;
+    SimulatedQueue queue(resources);
+
+    SimulatedList open;
+    SimulatedList middle;
+    SimulatedList close;
+    open.use(&resources[0], ResourceState::RenderTarget);
+    open.command();
+    open.end();
+    middle.use(&resources[0], ResourceState::RenderTarget);
+    middle.command();
+    middle.end();
+    close.use(&resources[0], ResourceState::RenderTarget);
+    close.command();
+    close.tracker.require(&resources[0], ResourceState::Present);
+    close.end();
+
+    queue.submit(open);
+    CHECK(queue.fixups.size() == 1);
+    CHECK(queue.fixups[0].before == ResourceState::Present && queue.fixups[0].after == ResourceState::RenderTarget);
+    queue.submit(middle);
+    CHECK(queue.fixups.empty());
+    queue.submit(close);
+    CHECK(queue.fixups.empty());
+    CHECK(resources[0].state == ResourceState::Present);
+    CHECK(open.tracker.getStats().barrierCount == 0);
+    CHECK(close.tracker.getStats().barrierCount == 1);
+    CHECK(open.tracker.getStats().fixupCount == 1);
+
+    // Next frame in a single list: the fix-up to RenderTarget, then the list's own barrier back to Present
+    SimulatedList frame;
+    frame.use(&resources[0], ResourceState::RenderTarget);
+    frame.command();
+    frame.tracker.require(&resources[0], ResourceState::Present);
+    frame.end();
+    queue.submit(frame);
+    CHECK(queue.fixups.size() == 1);
+    CHECK(queue.errorCount == 0);
+}
+
+TEST(TransitionsAreBatchedAndRedundantOnesSkipped)
+{
+    std::vector<TrackedResourceState> resources(3);
+    SimulatedQueue queue(resources);
+    SimulatedList list;
+    for (TrackedResourceState& resource : resources)
+    {
+        list.use(&resource, ResourceState::PixelShaderResource);
+    }
+    list.command();
+    for (TrackedResourceState& resource : resources)
+    {
+        list.use(&resource, ResourceState::RenderTarget);
+        list.tracker.require(&resource, ResourceState::RenderTarget);
+    }
+    list.command();
+    list.end();
+
+    CHECK(list.batchCount == 1);
+    CHECK(list.tracker.getStats().barrierCount == 3);
+    CHECK(list.tracker.getStats().batchCount == 1);
+    CHECK(list.tracker.getStats().skippedCount == 3);
+    CHECK(list.tracker.getTrackedCount() == 3);
+    queue.submit(list);
+    CHECK(queue.fixups.size() == 3);
+    CHECK(queue.errorCount == 0);
+}
+
+TEST(UnflushedTransitionsCancelAndRetarget)
+{
+    std::vector<TrackedResourceState> resources(2);
+    resources[0].state = ResourceState::PixelShaderResource;
+    resources[1].state = ResourceState::PixelShaderResource;
+    SimulatedQueue queue(resources);
+    SimulatedList list;
+    list.use(&resources[0], ResourceState::PixelShaderResource);
+    list.use(&resources[1], ResourceState::PixelShaderResource);
+    list.command();
+
+    list.tracker.require(&resources[0], ResourceState::RenderTarget);
+    list.tracker.require(&resources[1], ResourceState::CopyDest);
+    list.tracker.require(&resources[0], ResourceState::PixelShaderResource); // Cancels
+    list.tracker.require(&resources[1], ResourceState::UnorderedAccess);     // Retargets
+    const std::span<const ResourceTransition> pending = list.tracker.getPendingBarriers();
+    CHECK(pending.size() == 1);
+    CHECK(pending[0].resource == &resources[1]);
+    CHECK(pending[0].before == ResourceState::PixelShaderResource && pending[0].after == ResourceState::UnorderedAccess);
+
+    list.uses.push_back({ &resources[1], ResourceState::UnorderedAccess });
+    list.command();
+    list.end();
+    queue.submit(list);
+    CHECK(queue.fixups.empty());
+    CHECK(queue.errorCount == 0);
+    CHECK(list.tracker.getStats().mergedCount == 2);
+}
+
+TEST(CombinedReadStatesNeedNoBarrier)
+{
+    std::vector<TrackedResourceState> resources(1);
+    resources[0].state = ResourceState::GenericRead;
+    SimulatedQueue queue(resources);
+
+    SimulatedList read;
+    read.use(&resources[0], ResourceState::PixelShaderResource);
+    read.command();
+    read.end();
+    queue.submit(read);
+    CHECK(queue.fixups.empty());
+    CHECK(resources[0].state == ResourceState::GenericRead); // The wider state survives
+
+    SimulatedList write;
+    write.use(&resources[0], ResourceState::PixelShaderResource);
+    write.command();
+    write.use(&resources[0], ResourceState::CopyDest);
+    write.command();
+    write.end();
+    queue.submit(write);
+    CHECK(queue.fixups.size() == 1);
+    CHECK(queue.fixups[0].after == ResourceState::PixelShaderResource);
+    CHECK(resources[0].state == ResourceState::CopyDest);
+    CHECK(queue.errorCount == 0);
+}
+
+TEST(SplitBarriers)
+{
+    std::vector<TrackedResourceState> resources(2);
+    SimulatedQueue queue(resources);
+
+    // Begin, unrelated work, end on use
+    SimulatedList list;
+    list.use(&resources[0], ResourceState::RenderTarget);
+    list.use(&resources[1], ResourceState::RenderTarget);
+    list.command();
+    list.tracker.beginSplit(&resources[0], ResourceState::PixelShaderResource);
+    list.command();
+    list.use(&resources[1], ResourceState::RenderTarget);
+    list.command();
+    list.use(&resources[0], ResourceState::PixelShaderResource);
+    list.command();
+    list.end();
+    CHECK(countFlags(list, ResourceTransitionFlags::BeginOnly) == 1);
+    CHECK(countFlags(list, ResourceTransitionFlags::EndOnly) == 1);
+    queue.submit(list);
+    CHECK(queue.errorCount == 0);
+
+    // Begin and end without a command in between collapse to one transition
+    SimulatedList collapsed;
+    collapsed.use(&resources[0], ResourceState::PixelShaderResource);
+    collapsed.command();
+    collapsed.tracker.beginSplit(&resources[0], ResourceState::CopyDest);
+    collapsed.use(&resources[0], ResourceState::CopyDest);
+    collapsed.command();
+    collapsed.end();
+    CHECK(collapsed.tracker.getStats().barrierCount == 1);
+    CHECK(countFlags(collapsed, ResourceTransitionFlags::BeginOnly) == 0);
+    queue.submit(collapsed);
+    CHECK(queue.errorCount == 0);
+
+    // A split left open is ended by finish()
+    SimulatedList open;
+    open.use(&resources[1], ResourceState::RenderTarget);
+    open.command();
+    open.tracker.beginSplit(&resources[1], ResourceState::Present);
+    open.command();
+    open.end();
+    CHECK(countFlags(open, ResourceTransitionFlags::EndOnly) == 1);
+    queue.submit(open);
+    CHECK(queue.errorCount == 0);
+    CHECK(resources[1].state == ResourceState::Present);
+}
+
+TEST(AssumedStatesMoveTheFirstTransitionIntoTheList)
+{
+    std::vector<ResourceTransition> fixups;
+    TrackedResourceState backBuffer;
+    backBuffer.state = ResourceState::Present;
+
+    // Known state, e.g. from a render graph: the list records the transition itself
+    ResourceStateTracker known;
+    known.assume(&backBuffer, ResourceState::Present);
+    known.require(&backBuffer, ResourceState::RenderTarget);
+    CHECK(known.getPendingBarriers().size() == 1);
+    CHECK(known.getPendingBarriers()[0].before == ResourceState::Present);
+    known.clearPendingBarriers();
+    known.finish();
+    CHECK(known.resolve(fixups) == 0);
+    CHECK(backBuffer.state == ResourceState::RenderTarget);
+
+    // A wrong assumption is corrected by a fix-up to the assumed state
+    ResourceStateTracker wrong;
+    wrong.assume(&backBuffer, ResourceState::Present);
+    wrong.require(&backBuffer, ResourceState::CopyDest);
+    wrong.clearPendingBarriers();
+    CHECK(wrong.resolve(fixups) == 1);
+    CHECK(fixups[0].before == ResourceState::RenderTarget && fixups[0].after == ResourceState::Present);
+    CHECK(backBuffer.state == ResourceState::CopyDest);
+
+    // Assuming after the first use is ignored
+    ResourceStateTracker late;
+    late.require(&backBuffer, ResourceState::RenderTarget);
+    late.assume(&backBuffer, ResourceState::Present);
+    CHECK(late.getCurrentState(&backBuffer) == ResourceState::RenderTarget);
+    TrackedResourceState untouched;
+    CHECK(late.getCurrentState(&untouched) == ResourceState::Common);
+}
+
+TEST(RandomListsValidateOnASimulatedQueue)
+{
+    const ResourceState states[] = {
+        ResourceState::Common, ResourceState::RenderTarget, ResourceState::PixelShaderResource,
+        ResourceState::NonPixelShaderResource, ResourceState::CopyDest, ResourceState::CopySource,
+        ResourceState::UnorderedAccess, ResourceState::GenericRead, ResourceState::DepthRead,
+    };
+
+    std::mt19937 random(42);
+    std::vector<TrackedResourceState> resources(8);
+    SimulatedQueue queue(resources);
+    SimulatedList list; // Reused like a pooled command list
+    uint64_t fixupCount = 0;
+    for (int iteration = 0; iteration < 20000; ++iteration)
+    {
+        list.reset();
+        const uint32_t commandCount = 1 + random() % 12;
+        for (uint32_t command = 0; command < commandCount; ++command)
+        {
+            const uint32_t touchCount = 1 + random() % 3;
+            const uint32_t first = random() % resources.size();
+            for (uint32_t touch = 0; touch < touchCount; ++touch)
+            {
+                TrackedResourceState* resource = &resources[(first + touch) % resources.size()];
+                const ResourceState state = states[random() % std::size(states)];
+                switch (random() % 6)
+                {
+                case 0: list.tracker.beginSplit(resource, state); break;
+                case 1:
+                    // State changes nothing uses, merged or cancelled before the flush
+                    list.tracker.require(resource, state);
+                    list.tracker.require(resource, states[random() % std::size(states)]);
+                    break;
+                default: list.use(resource, state); break;
+                }
+            }
+            list.command();
+        }
+        list.end();
+        queue.submit(list);
+        fixupCount += queue.fixups.size();
+    }
+    CHECK(queue.errorCount == 0);
+    CHECK(fixupCount > 0);
+    // Stats survive reset(), they cover every iteration
+    CHECK(list.tracker.getStats().skippedCount > 0);
+    CHECK(list.tracker.getStats().mergedCount > 0);
+}
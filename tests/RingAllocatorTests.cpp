@@ -0,0 +1,168 @@
+#include "TestHarness.h"
+#include "HeapAllocationCounter.h"
+#include "RingAllocator.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace raphael;
+
+TEST(AllocatesAlignedOffsetsInOrder)
+{
+    RingAllocator ring(1024);
+    CHECK(ring.allocate(10, 1) == 0);
+    CHECK(ring.allocate(16, 256) == 256);
+    CHECK(ring.allocate(1, 4) == 272);
+    CHECK(ring.getUsedSize() == 273); // Padding counts as used until the frame retires
+    CHECK(ring.getPeakUsedSize() == 273);
+}
+
+TEST(RejectsEmptyAndOversizedRequests)
+{
+    RingAllocator ring(256);
+    CHECK(ring.allocate(0, 1) == RingAllocator::InvalidOffset);
+    CHECK(ring.allocate(257, 1) == RingAllocator::InvalidOffset);
+    CHECK(ring.allocate(256, 1) == 0);
+    CHECK(ring.getUsedSize() == 256);
+}
+
+TEST(FullRingFailsUntilItsFenceCompletes)
+{
+    RingAllocator ring(512);
+    CHECK(ring.allocate(256, 256) == 0);
+    CHECK(ring.allocate(256, 256) == 256);
+    CHECK(ring.allocate(1, 1) == RingAllocator::InvalidOffset);
+    ring.finishFrame(1);
+    CHECK(ring.hasPendingFrames());
+    CHECK(ring.getOldestPendingFence() == 1);
+
+    ring.releaseCompleted(0);
+    CHECK(ring.allocate(1, 1) == RingAllocator::InvalidOffset);
+
+    ring.releaseCompleted(1);
+    CHECK(!ring.hasPendingFrames());
+    CHECK(ring.getUsedSize() == 0);
+    CHECK(ring.allocate(512, 1) == 0);
+}
+
+TEST(WrapsAroundAndWastesTheTail)
+{
+    RingAllocator ring(1000);
+    CHECK(ring.allocate(400, 1) == 0);
+    ring.finishFrame(1);
+    CHECK(ring.allocate(400, 1) == 400);
+    ring.finishFrame(2);
+    ring.releaseCompleted(1);
+    CHECK(ring.getUsedSize() == 400);
+
+    // 300 bytes do not fit in [800, 1000), the allocation restarts at zero and the 200 byte remainder is consumed
+    CHECK(ring.allocate(300, 1) == 0);
+    CHECK(ring.getUsedSize() == 400 + 200 + 300);
+    // Free space is now [300, 400)
+    CHECK(ring.allocate(101, 1) == RingAllocator::InvalidOffset);
+    CHECK(ring.allocate(100, 1) == 300);
+    ring.finishFrame(3);
+
+    ring.releaseCompleted(2);
+    CHECK(ring.getUsedSize() == 600);
+    ring.releaseCompleted(3);
+    CHECK(ring.getUsedSize() == 0);
+}
+
+TEST(RetiresFramesInFenceOrder)
+{
+    RingAllocator ring(4096);
+    for (uint64_t fence = 1; fence <= 6; ++fence)
+    {
+        CHECK(ring.allocate(100, 1) != RingAllocator::InvalidOffset);
+        ring.finishFrame(fence);
+    }
+    CHECK(ring.getUsedSize() == 600);
+
+    ring.releaseCompleted(2);
+    CHECK(ring.getUsedSize() == 400);
+    CHECK(ring.getOldestPendingFence() == 3);
+
+    // An empty frame leaves no region behind
+    ring.finishFrame(7);
+    ring.releaseCompleted(6);
+    CHECK(!ring.hasPendingFrames());
+    CHECK(ring.getPeakUsedSize() == 600);
+}
+
+TEST(LiveAllocationsNeverOverlapUnderRandomFrames)
+{
+    const uint64_t capacity = 5000;
+    RingAllocator ring(capacity);
+    std::vector<uint8_t> owned(capacity, 0);
+    std::map<uint64_t, std::vector<std::pair<uint64_t, uint64_t>>> liveByFence;
+    std::mt19937 random(7);
+
+    uint64_t fence = 0;
+    uint64_t completed = 0;
+    for (int frame = 0; frame < 20000; ++frame)
+    {
+        ring.releaseCompleted(completed);
+        for (auto it = liveByFence.begin(); it != liveByFence.end() && it->first <= completed; it = liveByFence.erase(it))
+        {
+            for (const auto& [offset, size] : it->second)
+            {
+                std::fill(owned.begin() + offset, owned.begin() + offset + size, 0);
+            }
+        }
+
+        const uint64_t frameFence = fence + 1;
+        const int allocationCount = random() % 8;
+        for (int i = 0; i < allocationCount; ++i)
+        {
+            const uint64_t size = 1 + random() % 900;
+            const uint64_t alignment = 1ull << (random() % 9);
+            const uint64_t offset = ring.allocate(size, alignment);
+            if (offset == RingAllocator::InvalidOffset)
+            {
+                continue;
+            }
+
+            CHECK(offset % alignment == 0);
+            CHECK(offset + size <= capacity);
+            for (uint64_t byte = offset; byte < offset + size; ++byte)
+            {
+                CHECK(owned[byte] == 0);
+                owned[byte] = 1;
+            }
+            liveByFence[frameFence].push_back({ offset, size });
+        }
+        ring.finishFrame(++fence);
+        CHECK(ring.getUsedSize() <= capacity);
+
+        // The GPU lags zero to two frames behind
+        const uint64_t lag = random() % 3;
+        completed = std::max(completed, fence > lag ? fence - lag : 0);
+    }
+
+    ring.releaseCompleted(fence);
+    CHECK(ring.getUsedSize() == 0);
+}
+
+TEST(SteadyStateFramesDoNotAllocate)
+{
+    RingAllocator ring(1 << 16);
+    // Let the region queue grow to three frames in flight first
+    for (uint64_t fence = 1; fence <= 8; ++fence)
+    {
+        ring.allocate(1000, 256);
+        ring.finishFrame(fence);
+        ring.releaseCompleted(fence > 3 ? fence - 3 : 0);
+    }
+
+    HeapAllocationScope scope(HeapAllocationSource::CurrentThread);
+    for (uint64_t fence = 9; fence < 1000; ++fence)
+    {
+        ring.allocate(1000, 256);
+        ring.finishFrame(fence);
+        ring.releaseCompleted(fence - 3);
+    }
+    CHECK(scope.getAllocationCount() == 0);
+}
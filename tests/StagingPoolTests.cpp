@@ -0,0 +1,252 @@
+#include "TestHarness.h"
+#include "StagingPool.h"
+#include <random>
+
+using namespace raphael;
+
+namespace
+{
+    constexpr uint64_t MB = 1024 * 1024;
+
+    StagingPoolDesc makeDesc(uint64_t highWaterMark)
+    {
+        StagingPoolDesc desc;
+        desc.minChunkSize = MB;
+        desc.sizeClassCount = 3; // 1, 2 and 4 MB
+        desc.highWaterMark = highWaterMark;
+        return desc;
+    }
+
+    bool statsAreConsistent(const StagingPool& pool)
+    {
+        const StagingPoolStats stats = pool.getStats();
+        return stats.liveBytes == stats.freeBytes + stats.inUseBytes + stats.inFlightBytes
+            && stats.peakLiveBytes >= stats.liveBytes;
+    }
+}
+
+TEST(RequestsRoundUpToTheirSizeClass)
+{
+    StagingPool pool(makeDesc(64 * MB));
+
+    const StagingPool::Allocation small = pool.acquire(1);
+    CHECK(small.isValid());
+    CHECK(small.isNew);
+    CHECK(small.size == MB);
+
+    const StagingPool::Allocation medium = pool.acquire(MB + 1);
+    CHECK(medium.size == 2 * MB);
+    CHECK(pool.acquire(4 * MB).size == 4 * MB);
+    CHECK(small.chunk != medium.chunk);
+
+    const StagingPoolStats stats = pool.getStats();
+    CHECK(stats.createdCount == 3);
+    CHECK(stats.inUseBytes == 7 * MB);
+    CHECK(stats.liveChunkCount == 3);
+}
+
+TEST(ChunksAreReusedOnlyAfterTheirFence)
+{
+    StagingPool pool(makeDesc(64 * MB));
+
+    const StagingPool::Allocation first = pool.acquire(MB);
+    pool.release(first.chunk, 5);
+    CHECK(pool.hasPendingChunks());
+    CHECK(pool.getOldestPendingFence() == 5);
+
+    // Still in flight: a second request gets a new chunk
+    const StagingPool::Allocation second = pool.acquire(MB);
+    CHECK(second.isNew);
+    CHECK(second.chunk != first.chunk);
+    CHECK(pool.getStats().inFlightBytes == MB);
+
+    pool.releaseCompleted(4);
+    CHECK(pool.getStats().inFlightBytes == MB);
+    pool.releaseCompleted(5);
+    CHECK(!pool.hasPendingChunks());
+    CHECK(pool.getStats().freeBytes == MB);
+
+    const StagingPool::Allocation reused = pool.acquire(100);
+    CHECK(reused.chunk == first.chunk);
+    CHECK(!reused.isNew);
+    CHECK(pool.getStats().reusedCount == 1);
+}
+
+TEST(PendingChunksRetireInFenceOrder)
+{
+    StagingPool pool(makeDesc(64 * MB));
+
+    const uint32_t late = pool.acquire(MB).chunk;
+    const uint32_t early = pool.acquire(MB).chunk;
+    pool.release(late, 9);
+    pool.release(early, 3);
+    CHECK(pool.getOldestPendingFence() == 3);
+
+    pool.releaseCompleted(3);
+    CHECK(pool.getOldestPendingFence() == 9);
+    CHECK(pool.acquire(MB).chunk == early);
+    CHECK(pool.acquire(MB).isNew);
+}
+
+TEST(ReleasingAChunkTwiceThrows)
+{
+    StagingPool pool(makeDesc(64 * MB));
+
+    const uint32_t chunk = pool.acquire(MB).chunk;
+    pool.release(chunk, 1);
+    CHECK_THROWS(pool.release(chunk, 2));
+    CHECK_THROWS(pool.release(1234, 2));
+
+    StagingPoolDesc invalid = makeDesc(64 * MB);
+    invalid.sizeClassCount = 0;
+    CHECK_THROWS(StagingPool(invalid));
+}
+
+TEST(OversizedRequestsGetDedicatedChunks)
+{
+    StagingPool pool(makeDesc(64 * MB));
+
+    // Above the biggest class: rounded to the minimum chunk size and never pooled
+    const StagingPool::Allocation dedicated = pool.acquire(5 * MB + 1);
+    CHECK(dedicated.isNew);
+    CHECK(dedicated.size == 6 * MB);
+
+    pool.release(dedicated.chunk, 1);
+    pool.releaseCompleted(1);
+
+    std::vector<uint32_t> evicted;
+    pool.takeEvictedChunks(evicted);
+    CHECK(evicted.size() == 1);
+    CHECK(evicted[0] == dedicated.chunk);
+
+    const StagingPoolStats stats = pool.getStats();
+    CHECK(stats.liveBytes == 0);
+    CHECK(stats.evictedCount == 1);
+    CHECK(stats.peakLiveBytes == 6 * MB);
+
+    // Ids come back only after the owner took them
+    CHECK(pool.acquire(MB).chunk == dedicated.chunk);
+}
+
+TEST(HighWaterMarkStallsUntilAFenceRetires)
+{
+    StagingPool pool(makeDesc(4 * MB));
+
+    const uint32_t a = pool.acquire(2 * MB).chunk;
+    const uint32_t b = pool.acquire(2 * MB).chunk;
+    CHECK(!pool.acquire(MB).isValid());
+    CHECK(pool.getStats().stallCount == 1);
+
+    pool.release(a, 1);
+    pool.release(b, 2);
+    CHECK(!pool.acquire(MB).isValid());
+
+    // The retired 2 MB chunk is handed out for a 1 MB request rather than growing past the budget
+    pool.releaseCompleted(1);
+    const StagingPool::Allocation allocation = pool.acquire(MB);
+    CHECK(allocation.chunk == a);
+    CHECK(allocation.size == 2 * MB);
+    CHECK(pool.getStats().liveBytes <= 4 * MB);
+}
+
+TEST(IdleChunksAreEvictedToStayUnderTheBudget)
+{
+    StagingPool pool(makeDesc(4 * MB));
+
+    const uint32_t small = pool.acquire(MB).chunk;
+    pool.release(small, 1);
+    pool.releaseCompleted(1);
+
+    // 1 MB idle plus 4 MB requested is over budget: the idle chunk goes
+    const StagingPool::Allocation big = pool.acquire(4 * MB);
+    CHECK(big.isValid());
+    CHECK(big.isNew);
+
+    std::vector<uint32_t> evicted;
+    pool.takeEvictedChunks(evicted);
+    CHECK(evicted.size() == 1);
+    CHECK(evicted[0] == small);
+    CHECK(pool.getStats().liveBytes == 4 * MB);
+    CHECK(pool.getStats().overBudgetCount == 0);
+
+    pool.release(big.chunk, 2);
+    pool.releaseCompleted(2);
+    pool.trim();
+    CHECK(pool.getStats().liveBytes == 0);
+    CHECK(pool.getStats().freeBytes == 0);
+}
+
+TEST(SingleRequestAboveTheBudgetIsServed)
+{
+    StagingPool pool(makeDesc(4 * MB));
+
+    const StagingPool::Allocation allocation = pool.acquire(10 * MB);
+    CHECK(allocation.isValid());
+    CHECK(pool.getStats().overBudgetCount == 1);
+
+    pool.release(allocation.chunk, 1);
+    pool.releaseCompleted(1);
+    CHECK(pool.getStats().liveBytes == 0);
+}
+
+TEST(StreamingTraceStaysBounded)
+{
+    // Assets of random sizes stream in batches, with the owner loop of UploadBatchDx12: submit the batch
+    // when it holds all the memory, otherwise wait for the oldest fence
+    const uint64_t highWaterMark = 24 * MB;
+    StagingPool pool(makeDesc(highWaterMark));
+    std::mt19937 random(32);
+    std::vector<uint32_t> batch;
+    std::vector<uint32_t> evicted;
+    uint64_t fence = 0;
+    uint64_t completed = 0;
+    uint64_t streamedBytes = 0;
+
+    auto submit = [&]
+    {
+        ++fence;
+        for (uint32_t chunk : batch)
+        {
+            pool.release(chunk, fence);
+        }
+        batch.clear();
+    };
+
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        const uint64_t size = (random() % 200 == 0) ? 12 * MB : 1 + random() % (3 * MB);
+        StagingPool::Allocation allocation = pool.acquire(size);
+        while (!allocation.isValid())
+        {
+            if (!pool.hasPendingChunks())
+            {
+                submit();
+            }
+            completed = pool.getOldestPendingFence();
+            pool.releaseCompleted(completed);
+            allocation = pool.acquire(size);
+        }
+        CHECK(allocation.size >= size);
+        batch.push_back(allocation.chunk);
+        streamedBytes += size;
+
+        if (random() % 4 == 0)
+        {
+            submit();
+        }
+        if (random() % 3 == 0 && completed < fence)
+        {
+            pool.releaseCompleted(++completed);
+        }
+        pool.takeEvictedChunks(evicted);
+        CHECK(statsAreConsistent(pool));
+        CHECK(pool.getStats().liveBytes <= highWaterMark);
+    }
+
+    const StagingPoolStats stats = pool.getStats();
+    CHECK(stats.peakLiveBytes <= highWaterMark);
+    CHECK(streamedBytes > 100 * highWaterMark);
+    CHECK(stats.reusedCount > stats.createdCount);
+    CHECK(stats.stallCount > 0);
+    CHECK(stats.overBudgetCount == 0);
+}
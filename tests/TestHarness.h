@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+
+// Minimal self-registering test harness: TEST defines a case, CHECK records a failure without
+// stopping the case, an exception escaping a case fails it. TestMain.cpp runs every registered case,
+// or only those whose name contains the first command line argument.
+namespace raphael::test
+{
+    struct TestCase
+    {
+        const char* name = nullptr;
+        void (*function)() = nullptr;
+    };
+
+    std::vector<TestCase>& getTestCases();
+    void reportFailure(const char* file, int line, const char* expression);
+
+    struct TestRegistrar
+    {
+        TestRegistrar(const char* name, void (*function)()) { getTestCases().push_back({ name, function }); }
+    };
+} // namespace raphael::test
+
+#define TEST(name)                                                               \
+    static void name();                                                          \
+    static const raphael::test::TestRegistrar name##Registrar(#name, &name);     \
+    static void name()
+
+#define CHECK(condition)                                                         \
+    do                                                                           \
+    {                                                                            \
+        if (!(condition))                                                        \
+        {                                                                        \
+            raphael::test::reportFailure(__FILE__, __LINE__, #condition);        \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_THROWS(expression)                                                 \
+    do                                                                           \
+    {                                                                            \
+        bool threw = false;                                                      \
+        try                                                                      \
+        {                                                                        \
+            (void)(expression);                                                  \
+        }                                                                        \
+        catch (...)                                                              \
+        {                                                                        \
+            threw = true;                                                        \
+        }                                                                        \
+        if (!threw)                                                              \
+        {                                                                        \
+            raphael::test::reportFailure(__FILE__, __LINE__, "throws " #expression); \
+        }                                                                        \
+    } while (0)
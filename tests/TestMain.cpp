@@ -0,0 +1,63 @@
+#include "TestHarness.h"
+#include <cstring>
+#include <exception>
+
+namespace raphael::test
+{
+    namespace
+    {
+        int g_failureCount = 0;
+    }
+
+    std::vector<TestCase>& getTestCases()
+    {
+        static std::vector<TestCase> testCases;
+        return testCases;
+    }
+
+    void reportFailure(const char* file, int line, const char* expression)
+    {
+        g_failureCount++;
+        std::printf("    %s:%d: CHECK failed: %s\n", file, line, expression);
+    }
+} // namespace raphael::test
+
+int main(int argc, char** argv)
+{
+    using namespace raphael::test;
+
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int failedCount = 0;
+    int runCount = 0;
+    for (const TestCase& testCase : getTestCases())
+    {
+        if (filter != nullptr && std::strstr(testCase.name, filter) == nullptr)
+        {
+            continue;
+        }
+
+        std::printf("[ RUN    ] %s\n", testCase.name);
+        std::fflush(stdout);
+        const int failuresBefore = g_failureCount;
+        try
+        {
+            testCase.function();
+        }
+        catch (const std::exception& exception)
+        {
+            reportFailure(__FILE__, __LINE__, exception.what());
+        }
+        catch (...)
+        {
+            reportFailure(__FILE__, __LINE__, "unknown exception");
+        }
+
+        const bool passed = g_failureCount == failuresBefore;
+        std::printf("[ %s ] %s\n", passed ? "    OK" : "FAILED", testCase.name);
+        failedCount += passed ? 0 : 1;
+        runCount++;
+    }
+
+    std::printf("%d of %d tests passed\n", runCount - failedCount, runCount);
+    return failedCount == 0 ? 0 : 1;
+}
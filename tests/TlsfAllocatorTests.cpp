@@ -0,0 +1,157 @@
+#include "TestHarness.h"
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace raphael;
+
+TEST(AllocatesExactSizesFromTheStart)
+{
+    TlsfAllocator allocator(1 << 20);
+    const TlsfAllocator::Allocation first = allocator.allocate(1000);
+    const TlsfAllocator::Allocation second = allocator.allocate(24);
+    CHECK(first.isValid() && second.isValid());
+    CHECK(first.offset == 0);
+    CHECK(second.offset == 1000);
+    CHECK(allocator.getAllocationSize(first) == 1000);
+    CHECK(allocator.getUsedSize() == 1024);
+    CHECK(allocator.getStats().allocationCount == 2);
+}
+
+TEST(HonoursAlignmentAndReturnsThePadding)
+{
+    TlsfAllocator allocator(1 << 20);
+    const TlsfAllocator::Allocation small = allocator.allocate(100);
+    const TlsfAllocator::Allocation aligned = allocator.allocate(4096, 65536);
+    CHECK(aligned.isValid());
+    CHECK(aligned.offset == 65536);
+    CHECK(allocator.getUsedSize() == 100 + 4096);
+
+    // The padding in front of the aligned block went back to the free lists, next to the tail
+    const TlsfAllocator::Stats stats = allocator.getStats();
+    CHECK(stats.freeBlockCount == 2);
+    CHECK(stats.freeSize == (1 << 20) - 100 - 4096);
+
+    allocator.free(small);
+    allocator.free(aligned);
+    CHECK(allocator.isEmpty());
+    CHECK(allocator.getStats().freeBlockCount == 1);
+}
+
+TEST(FailsWhenNoBlockFits)
+{
+    TlsfAllocator allocator(4096);
+    CHECK(!allocator.allocate(0).isValid());
+    CHECK(!allocator.allocate(4097).isValid());
+    const TlsfAllocator::Allocation all = allocator.allocate(4096);
+    CHECK(all.isValid());
+    CHECK(!allocator.allocate(1).isValid());
+    allocator.free(all);
+    CHECK(allocator.allocate(4096).isValid());
+}
+
+TEST(CoalescesNeighboursInAnyFreeOrder)
+{
+    const uint64_t capacity = 8 * 1024;
+    for (int order = 0; order < 6; ++order)
+    {
+        TlsfAllocator allocator(capacity);
+        TlsfAllocator::Allocation blocks[4];
+        for (TlsfAllocator::Allocation& block : blocks)
+        {
+            block = allocator.allocate(1024);
+        }
+
+        // Free the middle pair in every order first: a hole between two live blocks stays one free block
+        const int a = order % 2 == 0 ? 1 : 2;
+        const int b = order % 2 == 0 ? 2 : 1;
+        allocator.free(blocks[a]);
+        allocator.free(blocks[b]);
+        TlsfAllocator::Stats stats = allocator.getStats();
+        CHECK(stats.freeBlockCount == 2); // The hole and the tail after block 3
+        CHECK(stats.largestFreeBlock == capacity - 4 * 1024);
+
+        allocator.free(blocks[order < 3 ? 0 : 3]);
+        allocator.free(blocks[order < 3 ? 3 : 0]);
+        stats = allocator.getStats();
+        CHECK(stats.freeBlockCount == 1);
+        CHECK(stats.largestFreeBlock == capacity);
+        CHECK(stats.fragmentation() == 0.0f);
+    }
+}
+
+TEST(ReportsFragmentation)
+{
+    TlsfAllocator allocator(16 * 1024);
+    std::vector<TlsfAllocator::Allocation> blocks;
+    for (int i = 0; i < 16; ++i)
+    {
+        blocks.push_back(allocator.allocate(1024));
+    }
+    for (int i = 0; i < 16; i += 2)
+    {
+        allocator.free(blocks[i]);
+    }
+
+    // Eight separate 1 KB holes: half the capacity is free but nothing larger than 1 KB fits
+    const TlsfAllocator::Stats stats = allocator.getStats();
+    CHECK(stats.freeSize == 8 * 1024);
+    CHECK(stats.freeBlockCount == 8);
+    CHECK(stats.largestFreeBlock == 1024);
+    CHECK(stats.fragmentation() > 0.87f);
+    CHECK(!allocator.allocate(2048).isValid());
+    CHECK(allocator.allocate(1024).isValid());
+}
+
+TEST(RandomChurnNeverOverlapsAndFullyCoalesces)
+{
+    const uint64_t capacity = 1 << 20;
+    TlsfAllocator allocator(capacity);
+    std::vector<uint8_t> owned(capacity, 0);
+    std::vector<std::pair<TlsfAllocator::Allocation, uint64_t>> live;
+    std::mt19937 random(3);
+
+    for (int step = 0; step < 100000; ++step)
+    {
+        if (live.empty() || random() % 2 == 0)
+        {
+            const uint64_t size = 1 + random() % 5000;
+            const uint64_t alignment = 1ull << (random() % 13);
+            const TlsfAllocator::Allocation allocation = allocator.allocate(size, alignment);
+            if (!allocation.isValid())
+            {
+                continue;
+            }
+
+            CHECK(allocation.offset % alignment == 0);
+            CHECK(allocation.offset + size <= capacity);
+            CHECK(allocator.getAllocationSize(allocation) == size);
+            for (uint64_t byte = allocation.offset; byte < allocation.offset + size; ++byte)
+            {
+                CHECK(owned[byte] == 0);
+                owned[byte] = 1;
+            }
+            live.push_back({ allocation, size });
+        }
+        else
+        {
+            const size_t index = random() % live.size();
+            const auto [allocation, size] = live[index];
+            std::fill(owned.begin() + allocation.offset, owned.begin() + allocation.offset + size, 0);
+            allocator.free(allocation);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (const auto& [allocation, size] : live)
+    {
+        allocator.free(allocation);
+    }
+    const TlsfAllocator::Stats stats = allocator.getStats();
+    CHECK(stats.usedSize == 0);
+    CHECK(stats.freeBlockCount == 1);
+    CHECK(stats.largestFreeBlock == capacity);
+}
@@ -0,0 +1,218 @@
+#include "TestHarness.h"
+#include "TransientResourcePlanner.h"
+#include <random>
+
+using namespace raphael;
+
+namespace
+{
+    constexpr uint64_t KB = 1024;
+
+    bool livesOverlap(const TransientResourceDesc& a, const TransientResourceDesc& b)
+    {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+    }
+
+    // Brute force over every pair: aligned, inside the heap, no shared bytes while both are alive, and one
+    // barrier per aliased resource on its first pass between occupants of the same region
+    bool isPlanValid(const TransientResourcePlanner& planner)
+    {
+        const uint32_t resourceCount = planner.getResourceCount();
+        for (uint32_t a = 0; a < resourceCount; ++a)
+        {
+            const TransientResourceDesc& descA = planner.getResourceDesc(a);
+            const TransientPlacement& placementA = planner.getPlacement(a);
+            if (placementA.offset % descA.alignment != 0 || placementA.offset + descA.size > planner.getHeapSize())
+            {
+                return false;
+            }
+
+            for (uint32_t b = a + 1; b < resourceCount; ++b)
+            {
+                const TransientResourceDesc& descB = planner.getResourceDesc(b);
+                const TransientPlacement& placementB = planner.getPlacement(b);
+                const bool memoryOverlaps = placementA.offset < placementB.offset + descB.size && placementB.offset < placementA.offset + descA.size;
+                if (memoryOverlaps && livesOverlap(descA, descB))
+                {
+                    return false;
+                }
+            }
+        }
+
+        uint32_t barrierCount = 0;
+        for (uint32_t pass = 0; pass < planner.getPassCount(); ++pass)
+        {
+            for (const TransientAliasingBarrier& barrier : planner.getAliasingBarriers(pass))
+            {
+                if (planner.getResourceDesc(barrier.after).firstPass != pass ||
+                    planner.getPlacement(barrier.before).region != planner.getPlacement(barrier.after).region)
+                {
+                    return false;
+                }
+                ++barrierCount;
+            }
+        }
+
+        uint32_t aliasedCount = 0;
+        for (uint32_t resource = 0; resource < resourceCount; ++resource)
+        {
+            aliasedCount += planner.getPlacement(resource).aliased ? 1 : 0;
+        }
+        return barrierCount == aliasedCount && planner.getHeapSize() <= planner.getUnaliasedSize();
+    }
+}
+
+TEST(DisjointLifetimesShareARegion)
+{
+    TransientResourcePlanner planner;
+    const uint32_t first = planner.addResource({ "First", 256 * KB, 64 * KB, 0, 1 });
+    const uint32_t second = planner.addResource({ "Second", 128 * KB, 64 * KB, 2, 3 });
+    planner.compile();
+
+    CHECK(isPlanValid(planner));
+    CHECK(planner.getRegions().size() == 1);
+    CHECK(planner.getPlacement(first).offset == planner.getPlacement(second).offset);
+    CHECK(planner.getPlacement(first).aliased);
+    CHECK(planner.getHeapSize() == 256 * KB);
+    CHECK(planner.getUnaliasedSize() == 384 * KB);
+    CHECK(planner.getSavedBytes() == 128 * KB);
+    CHECK(planner.getPassCount() == 4);
+
+    // Second takes over on pass 2, and the looping frame hands the memory back to First on pass 0
+    const std::span<const TransientAliasingBarrier> passTwo = planner.getAliasingBarriers(2);
+    CHECK(passTwo.size() == 1);
+    CHECK(passTwo[0].before == first && passTwo[0].after == second);
+    const std::span<const TransientAliasingBarrier> passZero = planner.getAliasingBarriers(0);
+    CHECK(passZero.size() == 1);
+    CHECK(passZero[0].before == second && passZero[0].after == first);
+    CHECK(planner.getAliasingBarriers(1).empty());
+    CHECK(planner.getAliasingBarriers(99).empty());
+}
+
+TEST(OverlappingLifetimesGetTheirOwnRegions)
+{
+    TransientResourcePlanner planner;
+    const uint32_t a = planner.addResource({ "A", 100 * KB, 64 * KB, 0, 2 });
+    const uint32_t b = planner.addResource({ "B", 100 * KB, 64 * KB, 2, 4 }); // Shares pass 2 with A
+    planner.compile();
+
+    CHECK(isPlanValid(planner));
+    CHECK(planner.getRegions().size() == 2);
+    CHECK(planner.getPlacement(a).region != planner.getPlacement(b).region);
+    CHECK(!planner.getPlacement(a).aliased);
+    CHECK(planner.getSavedBytes() == 0);
+    for (uint32_t pass = 0; pass < planner.getPassCount(); ++pass)
+    {
+        CHECK(planner.getAliasingBarriers(pass).empty());
+    }
+}
+
+TEST(RegionsHonourTheirStrictestAlignment)
+{
+    TransientResourcePlanner planner;
+    planner.addResource({ "Buffer", 1000, 256, 0, 0 });
+    const uint32_t msaa = planner.addResource({ "MSAA target", 3000, 4 * 1024 * KB, 0, 0 });
+    const uint32_t late = planner.addResource({ "Late buffer", 500, 256, 1, 1 });
+    planner.compile();
+
+    CHECK(isPlanValid(planner));
+    CHECK(planner.getPlacement(msaa).offset % (4 * 1024 * KB) == 0);
+    CHECK(planner.getHeapAlignment() == 4 * 1024 * KB);
+    CHECK(planner.getHeapSize() % planner.getHeapAlignment() == 0);
+    // The tightest free region is the 1000 byte one
+    CHECK(planner.getPlacement(late).region != planner.getPlacement(msaa).region);
+}
+
+TEST(TightestFreeRegionIsChosen)
+{
+    TransientResourcePlanner planner;
+    planner.addResource({ "Big", 1024 * KB, 64 * KB, 0, 0 });
+    const uint32_t medium = planner.addResource({ "Medium", 256 * KB, 64 * KB, 0, 0 });
+    const uint32_t small = planner.addResource({ "Small", 128 * KB, 64 * KB, 1, 1 });
+    planner.compile();
+
+    CHECK(isPlanValid(planner));
+    CHECK(planner.getPlacement(small).region == planner.getPlacement(medium).region);
+}
+
+TEST(InvalidDescriptionsThrow)
+{
+    TransientResourcePlanner planner;
+    CHECK_THROWS(planner.addResource({ "Empty", 0, 64 * KB, 0, 0 }));
+    CHECK_THROWS(planner.addResource({ "Odd alignment", 16, 3, 0, 0 }));
+    CHECK_THROWS(planner.addResource({ "No alignment", 16, 0, 0, 0 }));
+    CHECK_THROWS(planner.addResource({ "Backwards", 16, 64, 3, 2 }));
+    CHECK(planner.getResourceCount() == 0);
+}
+
+TEST(ClearAndRecompile)
+{
+    TransientResourcePlanner planner;
+    planner.addResource({ "A", 64 * KB, 64 * KB, 0, 0 });
+    planner.addResource({ "B", 64 * KB, 64 * KB, 1, 1 });
+    planner.compile();
+    CHECK(planner.getHeapSize() == 64 * KB);
+
+    planner.clear();
+    CHECK(planner.getResourceCount() == 0);
+    CHECK(planner.getHeapSize() == 0);
+    CHECK(planner.getRegions().empty());
+
+    planner.addResource({ "C", 128 * KB, 64 * KB, 0, 0 });
+    planner.compile();
+    planner.compile(); // Compiling twice gives the same plan
+    CHECK(planner.getHeapSize() == 128 * KB);
+    CHECK(planner.getRegions().size() == 1);
+    CHECK(isPlanValid(planner));
+}
+
+TEST(GBufferPipelineAliasesIntermediateTargets)
+{
+    // Passes: 0 G-buffer, 1 SSAO, 2 SSAO blur, 3 lighting, 4 bloom down, 5 bloom up, 6 tonemap
+    const uint64_t width = 1920;
+    const uint64_t height = 1080;
+    auto target = [&](uint64_t bytesPerPixel, uint64_t scale) { return (width * height * bytesPerPixel / scale + 65535) / 65536 * 65536; };
+
+    TransientResourcePlanner planner;
+    planner.addResource({ "Depth buffer", target(4, 1), 64 * KB, 0, 3 });
+    planner.addResource({ "GBuffer albedo", target(4, 1), 64 * KB, 0, 3 });
+    planner.addResource({ "GBuffer normal", target(8, 1), 64 * KB, 0, 3 });
+    planner.addResource({ "GBuffer depth", target(4, 1), 64 * KB, 0, 3 });
+    planner.addResource({ "SSAO", target(1, 1), 64 * KB, 1, 2 });
+    planner.addResource({ "SSAO blurred", target(1, 1), 64 * KB, 2, 3 });
+    planner.addResource({ "HDR lighting", target(8, 1), 64 * KB, 3, 6 });
+    const uint32_t bloomHalf = planner.addResource({ "Bloom half", target(8, 4), 64 * KB, 4, 5 });
+    const uint32_t bloomQuarter = planner.addResource({ "Bloom quarter", target(8, 16), 64 * KB, 4, 5 });
+    const uint32_t bloomResult = planner.addResource({ "Bloom result", target(8, 4), 64 * KB, 5, 6 });
+    planner.compile();
+
+    CHECK(isPlanValid(planner));
+    // The G-buffer is dead once lighting has run, the bloom chain lives in its memory
+    CHECK(planner.getPlacement(bloomHalf).aliased);
+    CHECK(planner.getPlacement(bloomQuarter).aliased);
+    CHECK(planner.getPlacement(bloomResult).aliased);
+    CHECK(planner.getSavedBytes() >= target(8, 4) * 2 + target(8, 16));
+    CHECK(planner.buildReport().find("HDR lighting [3-6]") != std::string::npos);
+}
+
+TEST(RandomFramesMatchTheBruteForceCheck)
+{
+    std::mt19937 random(36);
+    for (int iteration = 0; iteration < 2000; ++iteration)
+    {
+        TransientResourcePlanner planner;
+        const uint32_t resourceCount = 1 + random() % 40;
+        for (uint32_t i = 0; i < resourceCount; ++i)
+        {
+            const uint32_t firstPass = random() % 12;
+            TransientResourceDesc desc;
+            desc.size = 1 + random() % (8 * 1024 * KB);
+            desc.alignment = uint64_t(1) << (8 + random() % 8);
+            desc.firstPass = firstPass;
+            desc.lastPass = firstPass + random() % 6;
+            planner.addResource(desc);
+        }
+        planner.compile();
+        CHECK(isPlanValid(planner));
+    }
+}
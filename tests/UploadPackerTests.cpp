@@ -0,0 +1,113 @@
+#include "TestHarness.h"
+#include "UploadPacker.h"
+
+using namespace raphael;
+
+TEST(BuffersAreSixteenByteAligned)
+{
+    UploadPacker packer(1024);
+    CHECK(packer.packBuffer(10) == 0);
+    CHECK(packer.packBuffer(1) == 16);
+    CHECK(packer.packBuffer(32) == 32);
+    CHECK(packer.getUsedSize() == 64);
+    CHECK(packer.getPayloadSize() == 43);
+    CHECK(packer.getUploadCount() == 3);
+}
+
+TEST(RowPitchFollowsTheCopyEngineRule)
+{
+    CHECK(UploadPacker::getRowPitch(1) == 256);
+    CHECK(UploadPacker::getRowPitch(256) == 256);
+    CHECK(UploadPacker::getRowPitch(257) == 512);
+    // 100x100 RGBA8: 99 padded rows plus an unpadded last row
+    CHECK(UploadPacker::getTextureSize(400, 100, 1) == 512 * 99 + 400);
+    // Depth slices are rows too
+    CHECK(UploadPacker::getTextureSize(64, 4, 3) == 256 * 11 + 64);
+    CHECK(UploadPacker::getTextureSize(0, 4, 1) == 0);
+    CHECK(UploadPacker::getTextureSize(64, 0, 1) == 0);
+}
+
+TEST(TexturesArePlacedAt512Bytes)
+{
+    UploadPacker packer(1 << 20);
+    CHECK(packer.packBuffer(100) == 0);
+
+    TextureFootprint footprint;
+    CHECK(packer.packTexture(400, 100, 1, &footprint));
+    CHECK(footprint.offset == 512);
+    CHECK(footprint.rowPitch == 512);
+    CHECK(footprint.rowSizeInBytes == 400);
+    CHECK(footprint.numRows == 100);
+    CHECK(footprint.depth == 1);
+    CHECK(footprint.totalSize == 512 * 99 + 400);
+    CHECK(packer.getUsedSize() == 512 + footprint.totalSize);
+    CHECK(packer.getPayloadSize() == 100 + 400 * 100);
+
+    // A 4x4 BC1 mip is one block row of 8 bytes
+    TextureFootprint block;
+    CHECK(packer.packTexture(8, 1, 1, &block));
+    CHECK(block.offset % UploadPacker::TexturePlacementAlignment == 0);
+    CHECK(block.offset >= footprint.offset + footprint.totalSize);
+    CHECK(block.totalSize == 8);
+
+    // Buffers after a texture only need their own alignment
+    const uint64_t buffer = packer.packBuffer(4);
+    CHECK(buffer == block.offset + 16);
+}
+
+TEST(FullPackerRejectsWithoutChangingState)
+{
+    UploadPacker packer(2048);
+    CHECK(packer.packBuffer(1000) == 0);
+    CHECK(packer.packBuffer(0) == UploadPacker::InvalidOffset);
+
+    TextureFootprint footprint;
+    // Placed at 1024, needs 256 * 4 + 256 bytes
+    CHECK(!packer.packTexture(256, 5, 1, &footprint));
+    CHECK(packer.getUsedSize() == 1000);
+    CHECK(packer.getUploadCount() == 1);
+    CHECK(packer.packTexture(256, 4, 1, &footprint));
+    CHECK(footprint.offset == 1024);
+    CHECK(packer.getUsedSize() == 2048);
+    CHECK(packer.packBuffer(1) == UploadPacker::InvalidOffset);
+
+    packer.reset();
+    CHECK(packer.getUsedSize() == 0 && packer.getPayloadSize() == 0 && packer.getUploadCount() == 0);
+    CHECK(packer.packBuffer(2048) == 0);
+}
+
+TEST(PackedUploadsNeverOverlap)
+{
+    UploadPacker packer(64 << 20);
+    uint64_t end = 0;
+    for (uint32_t i = 0; i < 2000; ++i)
+    {
+        if (i % 3 == 0)
+        {
+            TextureFootprint footprint;
+            const uint32_t width = 1u << (i % 11);
+            if (!packer.packTexture(width * 4, width, 1, &footprint))
+            {
+                break;
+            }
+            CHECK(footprint.offset >= end);
+            CHECK(footprint.offset % UploadPacker::TexturePlacementAlignment == 0);
+            CHECK(footprint.rowPitch % UploadPacker::TextureRowPitchAlignment == 0);
+            end = footprint.offset + footprint.totalSize;
+        }
+        else
+        {
+            const uint64_t size = 1 + (i * 7919) % 100000;
+            const uint64_t offset = packer.packBuffer(size);
+            if (offset == UploadPacker::InvalidOffset)
+            {
+                break;
+            }
+            CHECK(offset >= end);
+            CHECK(offset % UploadPacker::BufferAlignment == 0);
+            end = offset + size;
+        }
+        CHECK(packer.getUsedSize() == end);
+    }
+    CHECK(packer.getPayloadSize() <= packer.getUsedSize());
+}